@@ -0,0 +1,1159 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+/*
+ * Microbenchmark and stress test for the core data structures.
+ *
+ * By default, measures the throughput of insert, overwrite, find, iterate
+ * and truncate operations on the client segment tree (seg_tree) and the
+ * server extent tree (extent_tree) under several write patterns, along
+ * with the memory used by their nodes, and the reserve and release
+ * throughput of the slot map (slotmap).
+ *
+ * With -s, instead runs randomized operations on each structure and checks
+ * every result against a simple reference map that records, for each byte
+ * of a small file, where its data lives. Any difference is reported with
+ * the seed of the failing round, which reproduces it with -r.
+ */
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "extent_tree.h"
+#include "seg_tree.h"
+#include "slotmap.h"
+
+/* benchmark parameters */
+static size_t num_ops      = 100000;  /* operations per phase */
+static size_t xfer_size    = 4096;    /* bytes per write */
+static int    num_writers  = 16;      /* writers in the strided pattern */
+static size_t num_slots    = 65536;   /* slots in the benchmarked slot map */
+
+/* stress parameters */
+static size_t stress_rounds;          /* rounds of random operations */
+static size_t stress_ops   = 2000;    /* operations per round */
+static size_t stress_space = 65536;   /* logical file size in bytes */
+static uint64_t seed       = 12345;
+
+typedef enum {
+    PATTERN_APPEND = 0, /* one writer appending */
+    PATTERN_STRIDED,    /* writers interleaving blocks of one file */
+    PATTERN_RANDOM,     /* random overwrites of a small file */
+    PATTERN_MAX
+} bench_pattern_e;
+
+static const char* pattern_names[PATTERN_MAX] = {
+    "append",
+    "strided",
+    "random"
+};
+
+/* a write: logical range [start, start + len), log position and writer */
+typedef struct {
+    unsigned long start;
+    unsigned long len;
+    unsigned long pos;
+    int cli;
+} bench_write_t;
+
+static double now_secs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+/* xorshift PRNG */
+static inline uint64_t bench_rand(uint64_t* state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/* random value in [0, n) */
+static inline unsigned long rand_below(uint64_t* state, unsigned long n)
+{
+    return (n > 0) ? (unsigned long)(bench_rand(state) % n) : 0;
+}
+
+static void print_rate(const char* type, const char* pattern,
+                       const char* phase, size_t ops, double elapsed)
+{
+    double rate = 0.0;
+    if (elapsed > 0.0) {
+        rate = (double)ops / elapsed;
+    }
+    printf("%-12s %-8s %-14s ops=%-9zu time=%9.4f s rate=%12.0f ops/s\n",
+           type, pattern, phase, ops, elapsed, rate);
+}
+
+static void print_mem(const char* type, const char* pattern,
+                      unsigned long nodes, slab_cache_stats_t* stats)
+{
+    double per_node = 0.0;
+    if (nodes > 0) {
+        per_node = (double)stats->bytes_reserved / (double)nodes;
+    }
+    printf("%-12s %-8s %-14s nodes=%-9lu reserved=%zu B used=%zu B "
+           "(%.1f B/node)\n",
+           type, pattern, "memory", nodes, stats->bytes_reserved,
+           stats->bytes_used, per_node);
+}
+
+/* the i-th write of a pattern */
+static void pattern_write(bench_pattern_e pattern, size_t i,
+                          uint64_t* state, bench_write_t* w)
+{
+    size_t nblocks;
+    w->len = (unsigned long) xfer_size;
+    switch (pattern) {
+    case PATTERN_STRIDED: {
+        /* block k of writer c lands at (k * writers) + c, and each
+         * writer appends to its own log */
+        size_t c = i % (size_t)num_writers;
+        size_t k = i / (size_t)num_writers;
+        w->start = (unsigned long)(((k * (size_t)num_writers) + c) *
+                                   xfer_size);
+        w->pos = (unsigned long)(k * xfer_size);
+        w->cli = (int) c;
+        break;
+    }
+    case PATTERN_RANDOM:
+        /* unaligned writes into a file a quarter of the data written */
+        nblocks = (num_ops / 4) + 1;
+        w->start = rand_below(state, (unsigned long)(nblocks * xfer_size));
+        w->pos = (unsigned long)(i * xfer_size);
+        w->cli = 0;
+        break;
+    case PATTERN_APPEND:
+    default:
+        w->start = (unsigned long)(i * xfer_size);
+        w->pos = (unsigned long)(i * xfer_size);
+        w->cli = 0;
+        break;
+    }
+}
+
+/* ------------------------------------------------------------------------
+ * Benchmarks
+ * --------------------------------------------------------------------- */
+
+static int bench_seg_tree(bench_pattern_e pattern)
+{
+    const char* type = "seg_tree";
+    const char* pname = pattern_names[pattern];
+    struct seg_tree tree;
+    bench_write_t w;
+    uint64_t state = seed;
+    int errors = 0;
+
+    if (seg_tree_init(&tree) != 0) {
+        fprintf(stderr, "seg_tree_init() failed\n");
+        return 1;
+    }
+
+    /* insert */
+    double start = now_secs();
+    for (size_t i = 0; i < num_ops; i++) {
+        pattern_write(pattern, i, &state, &w);
+        if (seg_tree_add(&tree, w.start, w.start + w.len - 1, w.pos)) {
+            errors++;
+        }
+    }
+    print_rate(type, pname, "insert", num_ops, now_secs() - start);
+
+    /* overwrite random ranges of the file with new log data */
+    unsigned long max = seg_tree_max(&tree);
+    unsigned long log_end = (unsigned long)(num_ops * xfer_size);
+    start = now_secs();
+    for (size_t i = 0; i < num_ops; i++) {
+        unsigned long off = rand_below(&state, max + 1);
+        if (seg_tree_add(&tree, off, off + xfer_size - 1,
+                         log_end + (i * xfer_size))) {
+            errors++;
+        }
+    }
+    print_rate(type, pname, "overwrite", num_ops, now_secs() - start);
+
+    slab_cache_stats_t stats;
+    seg_tree_mem_stats(&tree, &stats);
+    print_mem(type, pname, seg_tree_count(&tree), &stats);
+
+    /* find */
+    max = seg_tree_max(&tree);
+    size_t found = 0;
+    start = now_secs();
+    for (size_t i = 0; i < num_ops; i++) {
+        unsigned long off = rand_below(&state, max + 1);
+        if (NULL != seg_tree_find(&tree, off, off + xfer_size - 1)) {
+            found++;
+        }
+    }
+    print_rate(type, pname, "find", num_ops, now_secs() - start);
+
+    /* iterate, making enough passes to visit num_ops nodes */
+    size_t visited = 0;
+    start = now_secs();
+    do {
+        struct seg_tree_node* node = NULL;
+        seg_tree_rdlock(&tree);
+        while ((node = seg_tree_iter(&tree, node))) {
+            visited++;
+        }
+        seg_tree_unlock(&tree);
+    } while ((visited < num_ops) && (seg_tree_count(&tree) > 0));
+    print_rate(type, pname, "iterate", visited, now_secs() - start);
+
+    /* truncate, in steps from the end of the file down to zero, by
+     * removing everything past the new size as the client does */
+    size_t steps = (num_ops < 1000) ? num_ops : 1000;
+    max = seg_tree_max(&tree);
+    start = now_secs();
+    for (size_t i = 1; i <= steps; i++) {
+        unsigned long size = max - ((max / steps) * i);
+        if (i == steps) {
+            size = 0;
+        }
+        if (seg_tree_remove(&tree, size, max)) {
+            errors++;
+        }
+    }
+    print_rate(type, pname, "truncate", steps, now_secs() - start);
+    if (seg_tree_count(&tree) != 0) {
+        errors++;
+    }
+
+    seg_tree_destroy(&tree);
+    if (errors) {
+        printf("WARNING: %d %s operations failed\n", errors, type);
+    }
+    return (errors ? 1 : 0);
+}
+
+/* add the writes of a pattern, followed by random overwrites */
+static int extent_tree_fill(struct extent_tree* tree,
+                            bench_pattern_e pattern,
+                            uint64_t* state,
+                            const char* pname)
+{
+    const char* type = "extent_tree";
+    bench_write_t w;
+    int errors = 0;
+
+    double start = now_secs();
+    for (size_t i = 0; i < num_ops; i++) {
+        pattern_write(pattern, i, state, &w);
+        if (extent_tree_add(tree, w.start, w.start + w.len - 1,
+                            0, 0, w.cli, w.pos)) {
+            errors++;
+        }
+    }
+    if (NULL != pname) {
+        print_rate(type, pname, "insert", num_ops, now_secs() - start);
+    }
+
+    unsigned long max = extent_tree_max_offset(tree);
+    unsigned long log_end = (unsigned long)(num_ops * xfer_size);
+    start = now_secs();
+    for (size_t i = 0; i < num_ops; i++) {
+        unsigned long off = rand_below(state, max + 1);
+        if (extent_tree_add(tree, off, off + xfer_size - 1,
+                            0, 0, num_writers, log_end + (i * xfer_size))) {
+            errors++;
+        }
+    }
+    if (NULL != pname) {
+        print_rate(type, pname, "overwrite", num_ops, now_secs() - start);
+    }
+    return errors;
+}
+
+/* find random ranges, then iterate over all extents */
+static void extent_tree_lookups(struct extent_tree* tree,
+                                uint64_t* state,
+                                const char* pname,
+                                const char* find_name,
+                                const char* iter_name)
+{
+    const char* type = "extent_tree";
+    unsigned long max = extent_tree_max_offset(tree);
+    size_t found = 0;
+
+    double start = now_secs();
+    extent_tree_rdlock(tree);
+    for (size_t i = 0; i < num_ops; i++) {
+        unsigned long off = rand_below(state, max + 1);
+        if (NULL != extent_tree_find(tree, off, off + xfer_size - 1)) {
+            found++;
+        }
+    }
+    extent_tree_unlock(tree);
+    print_rate(type, pname, find_name, num_ops, now_secs() - start);
+
+    size_t visited = 0;
+    start = now_secs();
+    do {
+        struct extent_tree_node* node = NULL;
+        extent_tree_rdlock(tree);
+        while ((node = extent_tree_iter(tree, node))) {
+            visited++;
+        }
+        extent_tree_unlock(tree);
+    } while ((visited < num_ops) && (extent_tree_count(tree) > 0));
+    print_rate(type, pname, iter_name, visited, now_secs() - start);
+}
+
+static int bench_extent_tree(bench_pattern_e pattern)
+{
+    const char* type = "extent_tree";
+    const char* pname = pattern_names[pattern];
+    struct extent_tree tree;
+    uint64_t state = seed;
+
+    if (extent_tree_init(&tree) != 0) {
+        fprintf(stderr, "extent_tree_init() failed\n");
+        return 1;
+    }
+
+    int errors = extent_tree_fill(&tree, pattern, &state, pname);
+
+    slab_cache_stats_t stats;
+    extent_tree_mem_stats(&tree, &stats);
+    print_mem(type, pname, extent_tree_count(&tree), &stats);
+
+    extent_tree_lookups(&tree, &state, pname, "find", "iterate");
+
+    /* truncate, in steps from the end of the file down to zero */
+    size_t steps = (num_ops < 1000) ? num_ops : 1000;
+    unsigned long max = extent_tree_max_offset(&tree);
+    double start = now_secs();
+    for (size_t i = 1; i <= steps; i++) {
+        unsigned long size = max - ((max / steps) * i);
+        if (i == steps) {
+            size = 0;
+        }
+        if (extent_tree_truncate(&tree, size)) {
+            errors++;
+        }
+    }
+    print_rate(type, pname, "truncate", steps, now_secs() - start);
+    if (extent_tree_count(&tree) != 0) {
+        errors++;
+    }
+
+    /* the same extents again, frozen as for a laminated file */
+    state = seed;
+    errors += extent_tree_fill(&tree, pattern, &state, NULL);
+    start = now_secs();
+    if (extent_tree_freeze(&tree)) {
+        errors++;
+    }
+    print_rate(type, pname, "freeze", 1, now_secs() - start);
+    extent_tree_lookups(&tree, &state, pname,
+                        "find_frozen", "iterate_frozen");
+
+    extent_tree_destroy(&tree);
+    if (errors) {
+        printf("WARNING: %d %s operations failed\n", errors, type);
+    }
+    return (errors ? 1 : 0);
+}
+
+static int bench_slotmap(void)
+{
+    const char* type = "slotmap";
+    uint64_t state = seed;
+    int errors = 0;
+
+    size_t region_sz = sizeof(slot_map) + (num_slots / 8) + 1;
+    void* region = malloc(region_sz);
+    size_t max_resv = num_slots;
+    ssize_t* resv_start = calloc(max_resv, sizeof(ssize_t));
+    size_t* resv_count = calloc(max_resv, sizeof(size_t));
+    if ((NULL == region) || (NULL == resv_start) || (NULL == resv_count)) {
+        fprintf(stderr, "failed to allocate slot map state\n");
+        free(region);
+        free(resv_start);
+        free(resv_count);
+        return 1;
+    }
+    slot_map* smap = slotmap_init(num_slots, region, region_sz);
+    if (NULL == smap) {
+        fprintf(stderr, "slotmap_init() failed\n");
+        free(region);
+        free(resv_start);
+        free(resv_count);
+        return 1;
+    }
+
+    /* fill with small reservations, like log chunks of small writes */
+    size_t n_resv = 0;
+    double start = now_secs();
+    while (n_resv < max_resv) {
+        size_t count = 1 + rand_below(&state, 8);
+        ssize_t slot = slotmap_reserve(smap, count);
+        if (slot < 0) {
+            break;
+        }
+        resv_start[n_resv] = slot;
+        resv_count[n_resv] = count;
+        n_resv++;
+    }
+    print_rate(type, "fill", "reserve", n_resv, now_secs() - start);
+
+    /* release a random half, leaving the map fragmented */
+    size_t n_released = 0;
+    start = now_secs();
+    for (size_t i = 0; i < n_resv; i++) {
+        if (bench_rand(&state) & 1) {
+            if (slotmap_release(smap, (size_t)resv_start[i],
+                                resv_count[i])) {
+                errors++;
+            }
+            resv_count[i] = 0;
+            n_released++;
+        }
+    }
+    print_rate(type, "fill", "release", n_released, now_secs() - start);
+
+    /* reserve into the holes until the map is full again */
+    size_t n_refill = 0;
+    start = now_secs();
+    for (size_t i = 0; i < n_released; i++) {
+        size_t count = 1 + rand_below(&state, 8);
+        if (slotmap_reserve(smap, count) < 0) {
+            break;
+        }
+        n_refill++;
+    }
+    print_rate(type, "frag", "reserve", n_refill, now_secs() - start);
+    printf("%-12s %-8s %-14s slots=%-9zu used=%zu region=%zu B\n",
+           type, "frag", "memory", smap->total_slots, smap->used_slots,
+           region_sz);
+
+    free(region);
+    free(resv_start);
+    free(resv_count);
+    if (errors) {
+        printf("WARNING: %d %s operations failed\n", errors, type);
+    }
+    return (errors ? 1 : 0);
+}
+
+/* ------------------------------------------------------------------------
+ * Differential stress tests
+ * --------------------------------------------------------------------- */
+
+#define REF_NONE ((unsigned long)-1)
+
+/* reference map of a file: the log position and writer of each byte */
+typedef struct {
+    size_t size;
+    unsigned long* pos;  /* log position, or REF_NONE if not written */
+    int* owner;          /* writer (server rank and client id) */
+} ref_map;
+
+static int ref_init(ref_map* ref, size_t size)
+{
+    ref->size = size;
+    ref->pos = malloc(size * sizeof(unsigned long));
+    ref->owner = calloc(size, sizeof(int));
+    if ((NULL == ref->pos) || (NULL == ref->owner)) {
+        free(ref->pos);
+        free(ref->owner);
+        return ENOMEM;
+    }
+    for (size_t i = 0; i < size; i++) {
+        ref->pos[i] = REF_NONE;
+    }
+    return 0;
+}
+
+static void ref_free(ref_map* ref)
+{
+    free(ref->pos);
+    free(ref->owner);
+}
+
+static void ref_add(ref_map* ref, unsigned long start, unsigned long end,
+                    unsigned long pos, int owner)
+{
+    for (unsigned long b = start; b <= end; b++) {
+        ref->pos[b] = pos + (b - start);
+        ref->owner[b] = owner;
+    }
+}
+
+static void ref_remove(ref_map* ref, unsigned long start, unsigned long end)
+{
+    for (unsigned long b = start; (b <= end) && (b < ref->size); b++) {
+        ref->pos[b] = REF_NONE;
+    }
+}
+
+/* the first written byte in [start, end], or REF_NONE */
+static unsigned long ref_first(ref_map* ref,
+                               unsigned long start, unsigned long end)
+{
+    for (unsigned long b = start; (b <= end) && (b < ref->size); b++) {
+        if (REF_NONE != ref->pos[b]) {
+            return b;
+        }
+    }
+    return REF_NONE;
+}
+
+/* the last written byte, or REF_NONE */
+static unsigned long ref_last(ref_map* ref)
+{
+    for (size_t b = ref->size; b > 0; b--) {
+        if (REF_NONE != ref->pos[b - 1]) {
+            return (unsigned long)(b - 1);
+        }
+    }
+    return REF_NONE;
+}
+
+static size_t ref_count(ref_map* ref, unsigned long start, unsigned long end)
+{
+    size_t n = 0;
+    for (unsigned long b = start; (b <= end) && (b < ref->size); b++) {
+        if (REF_NONE != ref->pos[b]) {
+            n++;
+        }
+    }
+    return n;
+}
+
+/* context of a failed check */
+static uint64_t round_seed;
+static size_t round_op;
+
+#define STRESS_CHECK(cond, ...) \
+do { \
+    if (!(cond)) { \
+        fprintf(stderr, "FAIL %s (seed=%llu op=%zu): ", __func__, \
+                (unsigned long long) round_seed, round_op); \
+        fprintf(stderr, __VA_ARGS__); \
+        fprintf(stderr, "\n"); \
+        return 1; \
+    } \
+} while (0)
+
+/* a random write within the file, which continues the previous write in
+ * the file and the log now and then so that ranges can coalesce */
+static void stress_write(uint64_t* state, bench_write_t* prev,
+                         unsigned long* log_end, bench_write_t* w)
+{
+    unsigned long max_len = (unsigned long)(stress_space / 16);
+    w->len = 1 + rand_below(state, max_len);
+    if ((prev->len > 0) && (0 == rand_below(state, 4)) &&
+        ((prev->start + prev->len + w->len) <= stress_space)) {
+        w->start = prev->start + prev->len;
+        w->pos = prev->pos + prev->len;
+        w->cli = prev->cli;
+    } else {
+        w->start = rand_below(state, stress_space - w->len + 1);
+        w->pos = *log_end;
+        w->cli = (int) rand_below(state, 4);
+    }
+    if ((w->pos + w->len) > *log_end) {
+        *log_end = w->pos + w->len;
+    }
+    *prev = *w;
+}
+
+/* check every segment of the tree against the reference */
+static int check_seg_tree(struct seg_tree* tree, ref_map* ref)
+{
+    unsigned long nodes = 0;
+    size_t bytes = 0;
+    unsigned long prev_end = 0;
+    int first = 1;
+    int rc = 0;
+
+    seg_tree_rdlock(tree);
+    struct seg_tree_node* node = NULL;
+    while ((0 == rc) && (node = seg_tree_iter(tree, node))) {
+        nodes++;
+        if ((node->start > node->end) || (node->end >= ref->size) ||
+            (!first && (node->start <= prev_end))) {
+            fprintf(stderr, "bad segment [%lu, %lu] after %lu\n",
+                    node->start, node->end, prev_end);
+            rc = 1;
+            break;
+        }
+        for (unsigned long b = node->start; b <= node->end; b++) {
+            unsigned long expect = node->ptr + (b - node->start);
+            if (ref->pos[b] != expect) {
+                fprintf(stderr, "byte %lu maps to %lu, expected %lu\n",
+                        b, expect, ref->pos[b]);
+                rc = 1;
+                break;
+            }
+        }
+        bytes += node->end - node->start + 1;
+        prev_end = node->end;
+        first = 0;
+    }
+    seg_tree_unlock(tree);
+    STRESS_CHECK(0 == rc, "segments differ from the reference");
+
+    STRESS_CHECK(nodes == seg_tree_count(tree),
+                 "iterated %lu segments, count is %lu",
+                 nodes, seg_tree_count(tree));
+    size_t expect = ref_count(ref, 0, (unsigned long)(ref->size - 1));
+    STRESS_CHECK(bytes == expect, "segments cover %zu bytes, expected %zu",
+                 bytes, expect);
+    unsigned long last = ref_last(ref);
+    STRESS_CHECK((REF_NONE == last) || (seg_tree_max(tree) >= last),
+                 "max %lu is below last byte %lu", seg_tree_max(tree), last);
+    return 0;
+}
+
+static int stress_seg_tree(uint64_t* state)
+{
+    struct seg_tree tree;
+    ref_map ref;
+    bench_write_t prev = { 0, 0, 0, 0 };
+    bench_write_t w;
+    unsigned long log_end = 0;
+    int rc = 0;
+
+    if (seg_tree_init(&tree) || ref_init(&ref, stress_space)) {
+        fprintf(stderr, "failed to initialize seg_tree stress test\n");
+        return 1;
+    }
+
+    for (round_op = 0; round_op < stress_ops; round_op++) {
+        unsigned long choice = rand_below(state, 100);
+        unsigned long start = rand_below(state, stress_space);
+        unsigned long len = 1 + rand_below(state, stress_space / 8);
+        unsigned long end = start + len - 1;
+        if (end >= stress_space) {
+            end = stress_space - 1;
+        }
+
+        if (choice < 60) {
+            stress_write(state, &prev, &log_end, &w);
+            unsigned long wend = w.start + w.len - 1;
+            if (seg_tree_add(&tree, w.start, wend, w.pos)) {
+                fprintf(stderr, "seg_tree_add() failed\n");
+                rc = 1;
+                break;
+            }
+            ref_add(&ref, w.start, wend, w.pos, 0);
+        } else if (choice < 75) {
+            if (seg_tree_remove(&tree, start, end)) {
+                fprintf(stderr, "seg_tree_remove() failed\n");
+                rc = 1;
+                break;
+            }
+            ref_remove(&ref, start, end);
+        } else if (choice < 98) {
+            struct seg_tree_node* node = seg_tree_find(&tree, start, end);
+            unsigned long b = ref_first(&ref, start, end);
+            if (REF_NONE == b) {
+                if (NULL != node) {
+                    fprintf(stderr, "find [%lu, %lu] returned [%lu, %lu], "
+                            "expected nothing\n",
+                            start, end, node->start, node->end);
+                    rc = 1;
+                }
+            } else if ((NULL == node) ||
+                       (node->start > b) || (node->end < b)) {
+                fprintf(stderr, "find [%lu, %lu] missed byte %lu\n",
+                        start, end, b);
+                rc = 1;
+            }
+        } else if (choice < 99) {
+            seg_tree_clear(&tree);
+            ref_remove(&ref, 0, (unsigned long)(stress_space - 1));
+        } else {
+            rc = check_seg_tree(&tree, &ref);
+        }
+        if (0 != rc) {
+            break;
+        }
+    }
+    if (0 == rc) {
+        rc = check_seg_tree(&tree, &ref);
+    } else {
+        fprintf(stderr, "FAIL stress_seg_tree (seed=%llu op=%zu)\n",
+                (unsigned long long) round_seed, round_op);
+    }
+
+    seg_tree_destroy(&tree);
+    ref_free(&ref);
+    return rc;
+}
+
+/* owner of extent data in the reference map */
+#define EXTENT_OWNER(rank, cli) (((rank) << 16) | (cli))
+
+/* check every extent of the tree against the reference */
+static int check_extent_tree(struct extent_tree* tree, ref_map* ref)
+{
+    unsigned long nodes = 0;
+    size_t bytes = 0;
+    unsigned long prev_end = 0;
+    int first = 1;
+    int rc = 0;
+
+    extent_tree_rdlock(tree);
+    struct extent_tree_node* node = NULL;
+    while ((0 == rc) && (node = extent_tree_iter(tree, node))) {
+        nodes++;
+        if ((node->start > node->end) || (node->end >= ref->size) ||
+            (!first && (node->start <= prev_end))) {
+            fprintf(stderr, "bad extent [%lu, %lu] after %lu\n",
+                    node->start, node->end, prev_end);
+            rc = 1;
+            break;
+        }
+        int owner = EXTENT_OWNER(node->svr_rank, node->cli_id);
+        for (unsigned long b = node->start; b <= node->end; b++) {
+            unsigned long expect = node->pos + (b - node->start);
+            if ((ref->pos[b] != expect) || (ref->owner[b] != owner)) {
+                fprintf(stderr, "byte %lu maps to %lu of %x, "
+                        "expected %lu of %x\n",
+                        b, expect, owner, ref->pos[b], ref->owner[b]);
+                rc = 1;
+                break;
+            }
+        }
+        bytes += node->end - node->start + 1;
+        prev_end = node->end;
+        first = 0;
+    }
+    extent_tree_unlock(tree);
+    STRESS_CHECK(0 == rc, "extents differ from the reference");
+
+    STRESS_CHECK(nodes == extent_tree_count(tree),
+                 "iterated %lu extents, count is %lu",
+                 nodes, extent_tree_count(tree));
+    size_t expect = ref_count(ref, 0, (unsigned long)(ref->size - 1));
+    STRESS_CHECK(bytes == expect, "extents cover %zu bytes, expected %zu",
+                 bytes, expect);
+    unsigned long last = ref_last(ref);
+    unsigned long max = extent_tree_max_offset(tree);
+    STRESS_CHECK(((REF_NONE == last) && (0 == max)) || (max == last),
+                 "max offset is %lu, last byte is %lu", max, last);
+    return 0;
+}
+
+/* check a chunk list lookup of [offset, offset + len) */
+static int check_chunk_list(struct extent_tree* tree, ref_map* ref,
+                            unsigned long offset, unsigned long len)
+{
+    unsigned int n_chunks = 0;
+    chunk_read_req_t* chunks = NULL;
+    int rc = extent_tree_get_chunk_list(tree, offset, len,
+                                        &n_chunks, &chunks);
+    STRESS_CHECK(0 == rc, "extent_tree_get_chunk_list() failed (rc=%d)", rc);
+
+    size_t bytes = 0;
+    size_t next = offset;
+    for (unsigned int i = 0; (0 == rc) && (i < n_chunks); i++) {
+        chunk_read_req_t* c = chunks + i;
+        if ((c->offset < next) || (0 == c->nbytes) ||
+            ((c->offset + c->nbytes) > (offset + len))) {
+            fprintf(stderr, "chunk [%zu, +%zu) outside [%zu, +%lu)\n",
+                    c->offset, c->nbytes, next, len);
+            rc = 1;
+            break;
+        }
+        int owner = EXTENT_OWNER(c->rank, c->log_client_id);
+        for (size_t j = 0; j < c->nbytes; j++) {
+            size_t b = c->offset + j;
+            if ((ref->pos[b] != (c->log_offset + j)) ||
+                (ref->owner[b] != owner)) {
+                fprintf(stderr, "chunk byte %zu maps to %zu of %x, "
+                        "expected %lu of %x\n", b, c->log_offset + j,
+                        owner, ref->pos[b], ref->owner[b]);
+                rc = 1;
+                break;
+            }
+        }
+        bytes += c->nbytes;
+        next = c->offset + c->nbytes;
+    }
+    free(chunks);
+    STRESS_CHECK(0 == rc, "chunk list of [%lu, +%lu) is wrong", offset, len);
+
+    size_t expect = ref_count(ref, offset, offset + len - 1);
+    STRESS_CHECK(bytes == expect, "chunks of [%lu, +%lu) cover %zu bytes, "
+                 "expected %zu", offset, len, bytes, expect);
+    return 0;
+}
+
+static int stress_extent_tree(uint64_t* state)
+{
+    struct extent_tree tree;
+    ref_map ref;
+    bench_write_t prev = { 0, 0, 0, 0 };
+    bench_write_t w;
+    struct extent_tree_node batch[8];
+    unsigned long log_end = 0;
+    int rc = 0;
+
+    if (extent_tree_init(&tree) || ref_init(&ref, stress_space)) {
+        fprintf(stderr, "failed to initialize extent_tree stress test\n");
+        return 1;
+    }
+
+    for (round_op = 0; round_op < stress_ops; round_op++) {
+        unsigned long choice = rand_below(state, 100);
+        unsigned long start = rand_below(state, stress_space);
+        unsigned long len = 1 + rand_below(state, stress_space / 8);
+        if ((start + len) > stress_space) {
+            len = stress_space - start;
+        }
+        unsigned long end = start + len - 1;
+
+        if (choice < 40) {
+            stress_write(state, &prev, &log_end, &w);
+            unsigned long wend = w.start + w.len - 1;
+            int rank = w.cli & 1;
+            if (extent_tree_add(&tree, w.start, wend, rank, 0, w.cli,
+                                w.pos)) {
+                fprintf(stderr, "extent_tree_add() failed\n");
+                rc = 1;
+                break;
+            }
+            ref_add(&ref, w.start, wend, w.pos, EXTENT_OWNER(rank, w.cli));
+        } else if (choice < 55) {
+            /* a batch is applied in order, as if added one at a time.
+             * Sorted batches take the single-pass merge path. */
+            int n = 1 + (int) rand_below(state, 8);
+            for (int i = 0; i < n; i++) {
+                stress_write(state, &prev, &log_end, &w);
+                memset(batch + i, 0, sizeof(batch[i]));
+                batch[i].start = w.start;
+                batch[i].end = w.start + w.len - 1;
+                batch[i].svr_rank = w.cli & 1;
+                batch[i].cli_id = w.cli;
+                batch[i].pos = w.pos;
+            }
+            if (rand_below(state, 2)) {
+                /* sorted and non-overlapping */
+                unsigned long off = rand_below(state, stress_space / 2);
+                for (int i = 0; i < n; i++) {
+                    unsigned long blen = batch[i].end - batch[i].start + 1;
+                    blen = 1 + (blen % (stress_space / 32));
+                    if ((off + blen) > stress_space) {
+                        n = i;
+                        break;
+                    }
+                    batch[i].start = off;
+                    batch[i].end = off + blen - 1;
+                    off += blen + rand_below(state, 64);
+                }
+            }
+            if ((n > 0) && extent_tree_add_batch(&tree, n, batch)) {
+                fprintf(stderr, "extent_tree_add_batch() failed\n");
+                rc = 1;
+                break;
+            }
+            for (int i = 0; i < n; i++) {
+                ref_add(&ref, batch[i].start, batch[i].end, batch[i].pos,
+                        EXTENT_OWNER(batch[i].svr_rank, batch[i].cli_id));
+            }
+        } else if (choice < 60) {
+            unsigned long size = rand_below(state, stress_space + 1);
+            if (extent_tree_truncate(&tree, size)) {
+                fprintf(stderr, "extent_tree_truncate() failed\n");
+                rc = 1;
+                break;
+            }
+            if (size < stress_space) {
+                ref_remove(&ref, size, (unsigned long)(stress_space - 1));
+            }
+        } else if (choice < 80) {
+            extent_tree_rdlock(&tree);
+            struct extent_tree_node* node =
+                extent_tree_find(&tree, start, end);
+            unsigned long b = ref_first(&ref, start, end);
+            if (REF_NONE == b) {
+                if (NULL != node) {
+                    fprintf(stderr, "find [%lu, %lu] returned [%lu, %lu], "
+                            "expected nothing\n",
+                            start, end, node->start, node->end);
+                    rc = 1;
+                }
+            } else if ((NULL == node) ||
+                       (node->start > b) || (node->end < b)) {
+                fprintf(stderr, "find [%lu, %lu] missed byte %lu\n",
+                        start, end, b);
+                rc = 1;
+            }
+            extent_tree_unlock(&tree);
+        } else if (choice < 94) {
+            rc = check_chunk_list(&tree, &ref, start, len);
+        } else if (choice < 98) {
+            /* later adds unfreeze the tree */
+            if (extent_tree_freeze(&tree)) {
+                fprintf(stderr, "extent_tree_freeze() failed\n");
+                rc = 1;
+                break;
+            }
+        } else if (choice < 99) {
+            extent_tree_clear(&tree);
+            ref_remove(&ref, 0, (unsigned long)(stress_space - 1));
+        } else {
+            rc = check_extent_tree(&tree, &ref);
+        }
+        if (0 != rc) {
+            break;
+        }
+    }
+    if (0 == rc) {
+        rc = check_extent_tree(&tree, &ref);
+    } else {
+        fprintf(stderr, "FAIL stress_extent_tree (seed=%llu op=%zu)\n",
+                (unsigned long long) round_seed, round_op);
+    }
+
+    extent_tree_destroy(&tree);
+    ref_free(&ref);
+    return rc;
+}
+
+static int stress_slotmap(uint64_t* state)
+{
+    size_t total = 1 + rand_below(state, 4096);
+    size_t region_sz = sizeof(slot_map) + (total / 8) + 1;
+    void* region = malloc(region_sz);
+    char* used = calloc(total, 1);
+    ssize_t* resv_start = calloc(total, sizeof(ssize_t));
+    size_t* resv_count = calloc(total, sizeof(size_t));
+    size_t n_resv = 0;
+    size_t n_used = 0;
+    int rc = 0;
+
+    slot_map* smap = NULL;
+    if ((NULL != region) && (NULL != used) &&
+        (NULL != resv_start) && (NULL != resv_count)) {
+        smap = slotmap_init(total, region, region_sz);
+    }
+    if (NULL == smap) {
+        fprintf(stderr, "failed to initialize slotmap stress test\n");
+        free(region);
+        free(used);
+        free(resv_start);
+        free(resv_count);
+        return 1;
+    }
+
+    for (round_op = 0; round_op < stress_ops; round_op++) {
+        unsigned long choice = rand_below(state, 100);
+        if ((choice < 55) || (0 == n_resv)) {
+            /* mostly small reservations, some spanning many bytes */
+            size_t count = 1 + rand_below(state, 8);
+            if (0 == rand_below(state, 8)) {
+                count = 1 + rand_below(state, 64);
+            }
+            ssize_t slot = slotmap_reserve(smap, count);
+            if (slot >= 0) {
+                if (((size_t)slot + count) > total) {
+                    fprintf(stderr, "reserved [%zd, +%zu) of %zu slots\n",
+                            slot, count, total);
+                    rc = 1;
+                    break;
+                }
+                for (size_t i = 0; i < count; i++) {
+                    if (used[slot + i]) {
+                        fprintf(stderr, "reserved slot %zu twice\n",
+                                (size_t)slot + i);
+                        rc = 1;
+                        break;
+                    }
+                    used[slot + i] = 1;
+                }
+                resv_start[n_resv] = slot;
+                resv_count[n_resv] = count;
+                n_resv++;
+                n_used += count;
+            } else if (0 == n_used) {
+                /* slotmap_reserve() may skip fragmented space, and
+                 * reserves more than 8 slots only as whole bytes of the
+                 * use map, but it must succeed on an empty map */
+                size_t whole_bytes = total / 8;
+                if ((count <= total) &&
+                    ((count <= 8) || (((count + 7) / 8) <= whole_bytes))) {
+                    fprintf(stderr, "failed to reserve %zu slots of an "
+                            "empty map of %zu\n", count, total);
+                    rc = 1;
+                }
+            }
+        } else if (choice < 98) {
+            size_t r = (size_t) rand_below(state, n_resv);
+            if (slotmap_release(smap, (size_t)resv_start[r],
+                                resv_count[r])) {
+                fprintf(stderr, "slotmap_release() failed\n");
+                rc = 1;
+                break;
+            }
+            for (size_t i = 0; i < resv_count[r]; i++) {
+                used[resv_start[r] + i] = 0;
+            }
+            n_used -= resv_count[r];
+            n_resv--;
+            resv_start[r] = resv_start[n_resv];
+            resv_count[r] = resv_count[n_resv];
+        } else {
+            slotmap_clear(smap);
+            memset(used, 0, total);
+            n_resv = 0;
+            n_used = 0;
+        }
+        if ((0 == rc) && (smap->used_slots != n_used)) {
+            fprintf(stderr, "map has %zu used slots, expected %zu\n",
+                    smap->used_slots, n_used);
+            rc = 1;
+        }
+        if (0 != rc) {
+            break;
+        }
+    }
+    if (0 != rc) {
+        fprintf(stderr, "FAIL stress_slotmap (seed=%llu op=%zu)\n",
+                (unsigned long long) round_seed, round_op);
+    }
+
+    free(region);
+    free(used);
+    free(resv_start);
+    free(resv_count);
+    return rc;
+}
+
+static int run_stress(void)
+{
+    int failures = 0;
+    for (size_t r = 0; r < stress_rounds; r++) {
+        round_seed = seed + r;
+        uint64_t state = (round_seed * 0x9E3779B97F4A7C15ULL) | 1;
+        failures += stress_seg_tree(&state);
+        failures += stress_extent_tree(&state);
+        failures += stress_slotmap(&state);
+    }
+    printf("stress: %zu rounds of %zu operations on %zu bytes "
+           "(seeds %llu-%llu), %d failures\n",
+           stress_rounds, stress_ops, stress_space,
+           (unsigned long long) seed,
+           (unsigned long long)(seed + stress_rounds - 1), failures);
+    return (failures ? 1 : 0);
+}
+
+static void print_usage(const char* prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -n, --ops=NUM        operations per phase (default %zu)\n"
+            "  -x, --xfer=NUM       bytes per write (default %zu)\n"
+            "  -w, --writers=NUM    writers in strided pattern "
+            "(default %d)\n"
+            "  -m, --slots=NUM      slots in the slot map (default %zu)\n"
+            "  -s, --stress=NUM     run NUM rounds of randomized checks\n"
+            "                       instead of the benchmarks\n"
+            "  -o, --stress-ops=NUM operations per round (default %zu)\n"
+            "  -b, --space=NUM      file size for the checks "
+            "(default %zu)\n"
+            "  -r, --seed=NUM       random seed (default %llu)\n"
+            "  -h, --help           print this usage\n",
+            prog, num_ops, xfer_size, num_writers, num_slots,
+            stress_ops, stress_space, (unsigned long long) seed);
+}
+
+static struct option long_opts[] = {
+    { "ops", 1, 0, 'n' },
+    { "xfer", 1, 0, 'x' },
+    { "writers", 1, 0, 'w' },
+    { "slots", 1, 0, 'm' },
+    { "stress", 1, 0, 's' },
+    { "stress-ops", 1, 0, 'o' },
+    { "space", 1, 0, 'b' },
+    { "seed", 1, 0, 'r' },
+    { "help", 0, 0, 'h' },
+    { 0, 0, 0, 0 },
+};
+
+int main(int argc, char** argv)
+{
+    int ch;
+    int ret = 0;
+
+    while ((ch = getopt_long(argc, argv, "n:x:w:m:s:o:b:r:h",
+                             long_opts, NULL)) != -1) {
+        switch (ch) {
+        case 'n':
+            num_ops = strtoul(optarg, NULL, 0);
+            break;
+        case 'x':
+            xfer_size = strtoul(optarg, NULL, 0);
+            break;
+        case 'w':
+            num_writers = atoi(optarg);
+            break;
+        case 'm':
+            num_slots = strtoul(optarg, NULL, 0);
+            break;
+        case 's':
+            stress_rounds = strtoul(optarg, NULL, 0);
+            break;
+        case 'o':
+            stress_ops = strtoul(optarg, NULL, 0);
+            break;
+        case 'b':
+            stress_space = strtoul(optarg, NULL, 0);
+            break;
+        case 'r':
+            seed = strtoull(optarg, NULL, 0);
+            break;
+        case 'h':
+        default:
+            print_usage(argv[0]);
+            return (ch == 'h') ? 0 : 1;
+        }
+    }
+
+    if ((0 == num_ops) || (0 == xfer_size) || (num_writers <= 0) ||
+        (0 == num_slots) || (stress_space < 64)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (stress_rounds > 0) {
+        return run_stress();
+    }
+
+    for (int p = 0; p < PATTERN_MAX; p++) {
+        ret |= bench_seg_tree((bench_pattern_e)p);
+    }
+    for (int p = 0; p < PATTERN_MAX; p++) {
+        ret |= bench_extent_tree((bench_pattern_e)p);
+    }
+    ret |= bench_slotmap();
+
+    return ret;
+}
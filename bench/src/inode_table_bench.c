@@ -0,0 +1,352 @@
+/*
+ * Copyright (c) 2020, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2020, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+/*
+ * Microbenchmark for the server inode table.
+ *
+ * Measures create, metaget, and add_extents throughput of the unifyfs_inode
+ * API at several thread counts. With -g, every operation is additionally
+ * serialized through a single global rwlock, which reproduces the locking
+ * behavior of the former single RB-tree inode table for comparison.
+ */
+
+#include <getopt.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "unifyfs_inode.h"
+#include "unifyfs_inode_table.h"
+
+extern struct unifyfs_inode_table* global_inode_table;
+
+/* benchmark parameters */
+static size_t files_per_thread  = 10000; /* inodes created by each thread */
+static size_t gets_per_thread   = 100000; /* metaget calls by each thread */
+static int    extents_per_add   = 16;    /* extents per add_extents call */
+static int    use_global_lock;           /* emulate single-lock table */
+static char*  thread_list       = "1,8,64";
+
+static pthread_rwlock_t global_lock = PTHREAD_RWLOCK_INITIALIZER;
+static pthread_barrier_t phase_barrier;
+static size_t total_files;
+
+typedef enum {
+    PHASE_CREATE = 0,
+    PHASE_METAGET,
+    PHASE_ADD_EXTENTS,
+    PHASE_MAX
+} bench_phase_e;
+
+static const char* phase_names[PHASE_MAX] = {
+    "create",
+    "metaget",
+    "add_extents"
+};
+
+typedef struct {
+    int tid;
+    int nthreads;
+    int errors;
+    double elapsed[PHASE_MAX];
+} bench_thread_t;
+
+static double now_secs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+/* map a file index to a unique positive gfid, scrambled to resemble
+ * hashed paths (multiplying by an odd constant is a bijection mod 2^31) */
+static inline int64_t bench_gfid(size_t idx)
+{
+    uint32_t x = (uint32_t)idx * 2654435761u;
+    return (int)(x & 0x7FFFFFFF);
+}
+
+/* xorshift PRNG, private to each thread */
+static inline uint64_t bench_rand(uint64_t* state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+static void bench_create(bench_thread_t* t)
+{
+    char name[64];
+    unifyfs_file_attr_t attr;
+    size_t first = (size_t)t->tid * files_per_thread;
+
+    for (size_t i = 0; i < files_per_thread; i++) {
+        size_t idx = first + i;
+        memset(&attr, 0, sizeof(attr));
+        snprintf(name, sizeof(name), "/unifyfs/bench.%zu", idx);
+        attr.filename = name;
+        attr.gfid = bench_gfid(idx);
+        attr.mode = UNIFYFS_STAT_DEFAULT_FILE_MODE;
+
+        if (use_global_lock) {
+            pthread_rwlock_wrlock(&global_lock);
+        }
+        int rc = unifyfs_inode_create(attr.gfid, &attr);
+        if (use_global_lock) {
+            pthread_rwlock_unlock(&global_lock);
+        }
+        if (rc != UNIFYFS_SUCCESS) {
+            t->errors++;
+        }
+    }
+}
+
+static void bench_metaget(bench_thread_t* t)
+{
+    unifyfs_file_attr_t attr;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL * (uint64_t)(t->tid + 1);
+
+    for (size_t i = 0; i < gets_per_thread; i++) {
+        size_t idx = (size_t)(bench_rand(&seed) % total_files);
+        int64_t gfid = bench_gfid(idx);
+
+        if (use_global_lock) {
+            pthread_rwlock_rdlock(&global_lock);
+        }
+        int rc = unifyfs_inode_metaget(gfid, &attr);
+        if (use_global_lock) {
+            pthread_rwlock_unlock(&global_lock);
+        }
+        if (rc != UNIFYFS_SUCCESS) {
+            t->errors++;
+        }
+    }
+}
+
+static void bench_add_extents(bench_thread_t* t)
+{
+    struct extent_tree_node* nodes;
+    size_t first = (size_t)t->tid * files_per_thread;
+
+    nodes = calloc(extents_per_add, sizeof(*nodes));
+    if (NULL == nodes) {
+        t->errors++;
+        return;
+    }
+
+    for (size_t i = 0; i < files_per_thread; i++) {
+        /* strided, non-contiguous extents so nothing coalesces */
+        for (int e = 0; e < extents_per_add; e++) {
+            nodes[e].start    = (unsigned long)e * 8192;
+            nodes[e].end      = nodes[e].start + 4095;
+            nodes[e].svr_rank = 0;
+            nodes[e].app_id   = 0;
+            nodes[e].cli_id   = t->tid;
+            nodes[e].pos      = (unsigned long)e * 4096;
+        }
+
+        int64_t gfid = bench_gfid(first + i);
+        if (use_global_lock) {
+            pthread_rwlock_wrlock(&global_lock);
+        }
+        int rc = unifyfs_inode_add_extents(gfid, extents_per_add, nodes);
+        if (use_global_lock) {
+            pthread_rwlock_unlock(&global_lock);
+        }
+        if (rc != UNIFYFS_SUCCESS) {
+            t->errors++;
+        }
+    }
+
+    free(nodes);
+}
+
+static void* bench_thread_main(void* arg)
+{
+    bench_thread_t* t = (bench_thread_t*) arg;
+
+    for (int p = 0; p < PHASE_MAX; p++) {
+        pthread_barrier_wait(&phase_barrier);
+        double start = now_secs();
+        switch (p) {
+        case PHASE_CREATE:
+            bench_create(t);
+            break;
+        case PHASE_METAGET:
+            bench_metaget(t);
+            break;
+        case PHASE_ADD_EXTENTS:
+            bench_add_extents(t);
+            break;
+        default:
+            break;
+        }
+        t->elapsed[p] = now_secs() - start;
+    }
+
+    return NULL;
+}
+
+static int run_bench(int nthreads)
+{
+    int rc = unifyfs_inode_table_init(global_inode_table);
+    if (rc != UNIFYFS_SUCCESS) {
+        fprintf(stderr, "failed to initialize inode table (rc=%d)\n", rc);
+        return rc;
+    }
+
+    total_files = files_per_thread * (size_t)nthreads;
+
+    bench_thread_t* threads = calloc(nthreads, sizeof(*threads));
+    pthread_t* tids = calloc(nthreads, sizeof(*tids));
+    if ((NULL == threads) || (NULL == tids)) {
+        fprintf(stderr, "failed to allocate thread state\n");
+        free(threads);
+        free(tids);
+        unifyfs_inode_table_destroy(global_inode_table);
+        return ENOMEM;
+    }
+
+    pthread_barrier_init(&phase_barrier, NULL, nthreads);
+    for (int i = 0; i < nthreads; i++) {
+        threads[i].tid = i;
+        threads[i].nthreads = nthreads;
+        pthread_create(&tids[i], NULL, bench_thread_main, &threads[i]);
+    }
+
+    int errors = 0;
+    double max_elapsed[PHASE_MAX] = {0};
+    for (int i = 0; i < nthreads; i++) {
+        pthread_join(tids[i], NULL);
+        errors += threads[i].errors;
+        for (int p = 0; p < PHASE_MAX; p++) {
+            if (threads[i].elapsed[p] > max_elapsed[p]) {
+                max_elapsed[p] = threads[i].elapsed[p];
+            }
+        }
+    }
+    pthread_barrier_destroy(&phase_barrier);
+
+    size_t ops[PHASE_MAX];
+    ops[PHASE_CREATE]      = total_files;
+    ops[PHASE_METAGET]     = gets_per_thread * (size_t)nthreads;
+    ops[PHASE_ADD_EXTENTS] = total_files;
+
+    for (int p = 0; p < PHASE_MAX; p++) {
+        double rate = 0.0;
+        if (max_elapsed[p] > 0.0) {
+            rate = (double)ops[p] / max_elapsed[p];
+        }
+        printf("%-8s %-12s threads=%-3d ops=%-9zu time=%9.4f s "
+               "rate=%12.0f ops/s\n",
+               (use_global_lock ? "global" : "sharded"), phase_names[p],
+               nthreads, ops[p], max_elapsed[p], rate);
+    }
+    if (errors) {
+        printf("WARNING: %d operations failed\n", errors);
+    }
+
+    free(threads);
+    free(tids);
+    unifyfs_inode_table_destroy(global_inode_table);
+
+    return (errors ? EIO : UNIFYFS_SUCCESS);
+}
+
+static void print_usage(const char* prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -n, --files=NUM      inodes created per thread (default %zu)\n"
+            "  -m, --gets=NUM       metaget calls per thread (default %zu)\n"
+            "  -e, --extents=NUM    extents per add_extents (default %d)\n"
+            "  -t, --threads=LIST   comma-separated thread counts "
+            "(default %s)\n"
+            "  -g, --global-lock    serialize through one global lock\n"
+            "  -h, --help           print this usage\n",
+            prog, files_per_thread, gets_per_thread, extents_per_add,
+            thread_list);
+}
+
+static struct option long_opts[] = {
+    { "files", 1, 0, 'n' },
+    { "gets", 1, 0, 'm' },
+    { "extents", 1, 0, 'e' },
+    { "threads", 1, 0, 't' },
+    { "global-lock", 0, 0, 'g' },
+    { "help", 0, 0, 'h' },
+    { 0, 0, 0, 0 },
+};
+
+int main(int argc, char** argv)
+{
+    int ch;
+    int ret = 0;
+
+    while ((ch = getopt_long(argc, argv, "n:m:e:t:gh",
+                             long_opts, NULL)) != -1) {
+        switch (ch) {
+        case 'n':
+            files_per_thread = strtoul(optarg, NULL, 0);
+            break;
+        case 'm':
+            gets_per_thread = strtoul(optarg, NULL, 0);
+            break;
+        case 'e':
+            extents_per_add = atoi(optarg);
+            break;
+        case 't':
+            thread_list = optarg;
+            break;
+        case 'g':
+            use_global_lock = 1;
+            break;
+        case 'h':
+        default:
+            print_usage(argv[0]);
+            return (ch == 'h') ? 0 : 1;
+        }
+    }
+
+    if ((files_per_thread == 0) || (extents_per_add <= 0)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    /* inodes use argobots mutexes */
+    ABT_init(0, NULL);
+
+    char* list = strdup(thread_list);
+    char* saveptr = NULL;
+    char* tok = strtok_r(list, ",", &saveptr);
+    while (NULL != tok) {
+        int nthreads = atoi(tok);
+        if (nthreads > 0) {
+            if (run_bench(nthreads) != UNIFYFS_SUCCESS) {
+                ret = 1;
+            }
+        }
+        tok = strtok_r(NULL, ",", &saveptr);
+    }
+    free(list);
+
+    ABT_finalize();
+
+    return ret;
+}
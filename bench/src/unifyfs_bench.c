@@ -0,0 +1,1111 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+/*
+ * Single-node benchmark suite for a real UnifyFS server.
+ *
+ * Starts unifyfsd in the foreground with its state under a private work
+ * directory, then runs a matrix of workloads against it. Each workload
+ * forks a number of client processes, which use the client library API
+ * and synchronize through a process-shared barrier. The I/O workloads
+ * vary the file layout (a file per process or one shared file), access
+ * pattern, transfer size, log storage (shared memory or spillover file)
+ * and sync frequency. The metadata workload creates, stats and removes
+ * many small files. One line of JSON is written per workload with its
+ * throughput, latency percentiles and the server's resident memory.
+ */
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <getopt.h>
+#include <limits.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "unifyfs_api.h"
+#include "unifyfs_const.h"
+
+/* benchmark parameters */
+static char*  server_path    = BINDIR "/unifyfsd";
+static char*  work_dir;                  /* default: /tmp/unifyfs-bench.<pid> */
+static char*  mountpoint     = "/unifyfs";
+static char*  procs_list     = "1,4";
+static char*  layout_list    = "nn,n1";
+static char*  access_list    = "seq,strided,random";
+static char*  xfer_list      = "64k,1m";
+static char*  storage_list   = "shmem,spill";
+static char*  sync_list      = "0,16";
+static size_t bytes_per_proc = 16 * MIB; /* data written per process */
+static size_t meta_files     = 1000;   /* files per process, 0 skips */
+static int    timeout_secs   = 600;    /* limit on each client process */
+static FILE*  out_fp;
+
+static pid_t server_pid = -1;
+
+typedef enum {
+    LAYOUT_NN = 0,  /* a file per process */
+    LAYOUT_N1       /* one file shared by all processes */
+} bench_layout_e;
+
+typedef enum {
+    ACCESS_SEQ = 0, /* contiguous blocks in order */
+    ACCESS_STRIDED, /* noncontiguous blocks in order */
+    ACCESS_RANDOM   /* the contiguous blocks in a random order */
+} bench_access_e;
+
+typedef enum {
+    STORAGE_SHMEM = 0,
+    STORAGE_SPILL
+} bench_storage_e;
+
+static const char* layout_names[]  = { "n-n", "n-1" };
+static const char* access_names[]  = { "seq", "strided", "random" };
+static const char* storage_names[] = { "shmem", "spill" };
+
+/* a workload, the metadata workload only uses nprocs */
+typedef struct {
+    int nprocs;
+    bench_layout_e layout;
+    bench_access_e access;
+    bench_storage_e storage;
+    size_t xfer;
+    size_t sync_every;  /* writes between syncs, 0 syncs once at end */
+} bench_case_t;
+
+/* operations timed by the workloads, the metadata workload reuses the
+ * slots of the I/O operations */
+typedef enum {
+    OP_WRITE = 0,
+    OP_SYNC = 1,
+    OP_READ = 2,
+    OP_CREATE = 0,
+    OP_STAT = 1,
+    OP_REMOVE = 2,
+    OP_MAX = 3
+} bench_op_e;
+
+static const char* io_op_names[OP_MAX]   = { "write", "sync", "read" };
+static const char* meta_op_names[OP_MAX] = { "create", "stat", "remove" };
+
+/* per-process results, in memory shared with the parent */
+typedef struct {
+    int errors;
+    size_t n_ops[OP_MAX];
+    double elapsed[OP_MAX];
+} bench_proc_t;
+
+/* memory shared by the parent and client processes of a workload. The
+ * latencies (in ns) of process p for op o start at
+ * lat + ((p * OP_MAX) + o) * max_ops */
+typedef struct {
+    pthread_barrier_t barrier;
+    size_t max_ops;
+    bench_proc_t* procs;
+    uint64_t* lat;
+} bench_shared_t;
+
+static bench_shared_t* shared;
+static size_t shared_size;
+
+static double now_secs(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + ((double)ts.tv_nsec / 1e9);
+}
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* xorshift PRNG */
+static inline uint64_t bench_rand(uint64_t* state)
+{
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/* parse a size with an optional k, m or g suffix */
+static size_t parse_size(const char* str)
+{
+    char* end = NULL;
+    unsigned long long val = strtoull(str, &end, 0);
+    switch ((NULL != end) ? *end : '\0') {
+    case 'g':
+    case 'G':
+        val *= 1024;
+        /* fall through */
+    case 'm':
+    case 'M':
+        val *= 1024;
+        /* fall through */
+    case 'k':
+    case 'K':
+        val *= 1024;
+        break;
+    default:
+        break;
+    }
+    return (size_t) val;
+}
+
+/* return the index of name in names, or -1 */
+static int lookup_name(const char* name, const char** names, int n_names)
+{
+    for (int i = 0; i < n_names; i++) {
+        if (0 == strcmp(name, names[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/* split a comma-separated list into an array of at most max tokens,
+ * which point into the returned copy of the list */
+static char* split_list(const char* list, char** toks, int max, int* n)
+{
+    char* copy = strdup(list);
+    char* saveptr = NULL;
+    *n = 0;
+    if (NULL == copy) {
+        return NULL;
+    }
+    char* tok = strtok_r(copy, ",", &saveptr);
+    while ((NULL != tok) && (*n < max)) {
+        toks[(*n)++] = tok;
+        tok = strtok_r(NULL, ",", &saveptr);
+    }
+    return copy;
+}
+
+static uint64_t* op_latencies(int rank, bench_op_e op)
+{
+    return shared->lat + ((((size_t)rank * OP_MAX) + op) * shared->max_ops);
+}
+
+static void record_op(int rank, bench_op_e op, uint64_t start_ns)
+{
+    bench_proc_t* p = shared->procs + rank;
+    if (p->n_ops[op] < shared->max_ops) {
+        op_latencies(rank, op)[p->n_ops[op]] = now_ns() - start_ns;
+    }
+    p->n_ops[op]++;
+}
+
+static void bench_barrier(void)
+{
+    pthread_barrier_wait(&(shared->barrier));
+}
+
+static int shared_alloc(int nprocs, size_t max_ops)
+{
+    size_t procs_sz = sizeof(bench_proc_t) * (size_t)nprocs;
+    size_t lat_sz = sizeof(uint64_t) * (size_t)nprocs * OP_MAX * max_ops;
+    shared_size = sizeof(bench_shared_t) + procs_sz + lat_sz;
+
+    void* mem = mmap(NULL, shared_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (MAP_FAILED == mem) {
+        fprintf(stderr, "failed to map %zu bytes of shared memory - %s\n",
+                shared_size, strerror(errno));
+        return errno;
+    }
+    memset(mem, 0, sizeof(bench_shared_t) + procs_sz);
+    shared = (bench_shared_t*) mem;
+    shared->max_ops = max_ops;
+    shared->procs = (bench_proc_t*)(shared + 1);
+    shared->lat = (uint64_t*)(shared->procs + nprocs);
+
+    pthread_barrierattr_t attr;
+    pthread_barrierattr_init(&attr);
+    pthread_barrierattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+    pthread_barrier_init(&(shared->barrier), &attr, (unsigned)nprocs);
+    pthread_barrierattr_destroy(&attr);
+    return 0;
+}
+
+static void shared_free(void)
+{
+    pthread_barrier_destroy(&(shared->barrier));
+    munmap(shared, shared_size);
+    shared = NULL;
+}
+
+/* connect a client process to the server with the log storage of the
+ * workload */
+static int client_init(const bench_case_t* c, unifyfs_handle* fshdl)
+{
+    /* leave room for partial chunks at the ends of each transfer */
+    char log_size[32];
+    snprintf(log_size, sizeof(log_size), "%zu",
+             (2 * bytes_per_proc) + (64 * MIB));
+
+    unifyfs_cfg_option options[2];
+    options[0].opt_name = "logio.shmem_size";
+    options[1].opt_name = "logio.spill_size";
+    if (STORAGE_SHMEM == c->storage) {
+        options[0].opt_value = log_size;
+        options[1].opt_value = "0";
+    } else {
+        options[0].opt_value = "0";
+        options[1].opt_value = log_size;
+    }
+
+    *fshdl = UNIFYFS_INVALID_HANDLE;
+    unifyfs_rc urc = unifyfs_initialize(mountpoint, options, 2, fshdl);
+    if (UNIFYFS_SUCCESS != urc) {
+        fprintf(stderr, "failed to initialize client - %s\n",
+                unifyfs_rc_enum_description(urc));
+        return (int) urc;
+    }
+    return 0;
+}
+
+/* file offset of the i-th block accessed by the process at rank, where
+ * order is a permutation of the process's blocks for random access */
+static off_t block_offset(const bench_case_t* c, int rank,
+                          size_t nblocks, const size_t* order, size_t i)
+{
+    size_t blk;
+    if (ACCESS_STRIDED == c->access) {
+        if (LAYOUT_N1 == c->layout) {
+            /* processes interleave blocks */
+            blk = (i * (size_t)c->nprocs) + (size_t)rank;
+        } else {
+            /* every other block is left as a hole */
+            blk = 2 * i;
+        }
+    } else {
+        size_t j = (ACCESS_RANDOM == c->access) ? order[i] : i;
+        if (LAYOUT_N1 == c->layout) {
+            /* each process has a contiguous segment */
+            blk = ((size_t)rank * nblocks) + j;
+        } else {
+            blk = j;
+        }
+    }
+    return (off_t)(blk * c->xfer);
+}
+
+/* tag the start of each block with its offset, so reads can be checked */
+static void fill_block(char* buf, off_t offset, size_t xfer)
+{
+    uint64_t tag = (uint64_t) offset;
+    memset(buf, (int)(offset & 0xFF), xfer);
+    if (xfer >= sizeof(tag)) {
+        memcpy(buf, &tag, sizeof(tag));
+    }
+}
+
+static int check_block(const char* buf, off_t offset, size_t xfer)
+{
+    uint64_t tag = 0;
+    if (xfer >= sizeof(tag)) {
+        memcpy(&tag, buf, sizeof(tag));
+        return (tag == (uint64_t)offset) ? 0 : EIO;
+    }
+    return (buf[0] == (char)(offset & 0xFF)) ? 0 : EIO;
+}
+
+static int io_request(unifyfs_handle fshdl, unifyfs_gfid gfid,
+                      unifyfs_ioreq_op op, char* buf, off_t offset,
+                      size_t nbytes)
+{
+    unifyfs_io_request req;
+    memset(&req, 0, sizeof(req));
+    req.op = op;
+    req.gfid = gfid;
+    req.user_buf = buf;
+    req.offset = offset;
+    req.nbytes = nbytes;
+
+    unifyfs_rc urc = unifyfs_dispatch_io(fshdl, 1, &req);
+    if (UNIFYFS_SUCCESS == urc) {
+        urc = unifyfs_wait_io(fshdl, 1, &req, 1);
+    }
+    if (UNIFYFS_SUCCESS != urc) {
+        return (int) urc;
+    }
+    if (req.result.error) {
+        return req.result.error;
+    }
+    if ((UNIFYFS_IOREQ_OP_READ == op) && (req.result.count != nbytes)) {
+        return EIO;
+    }
+    return 0;
+}
+
+/* I/O workload body of the client process at rank. Every process passes
+ * the same barriers, even after errors, so the others don't hang. */
+static void run_io_client(const bench_case_t* c, int rank)
+{
+    bench_proc_t* me = shared->procs + rank;
+    size_t nblocks = bytes_per_proc / c->xfer;
+    char path[PATH_MAX];
+    unifyfs_gfid gfid = UNIFYFS_INVALID_GFID;
+    unifyfs_handle fshdl;
+
+    int ok = (0 == client_init(c, &fshdl));
+    if (!ok) {
+        me->errors++;
+    }
+
+    char* buf = malloc(c->xfer);
+    size_t* order = calloc(nblocks, sizeof(size_t));
+    if ((NULL == buf) || (NULL == order)) {
+        me->errors++;
+        ok = 0;
+    } else {
+        /* random access visits the blocks in a shuffled order */
+        uint64_t seed = 0x9E3779B97F4A7C15ULL * (uint64_t)(rank + 1);
+        for (size_t i = 0; i < nblocks; i++) {
+            order[i] = i;
+        }
+        for (size_t i = nblocks; i > 1; i--) {
+            size_t j = (size_t)(bench_rand(&seed) % i);
+            size_t tmp = order[i - 1];
+            order[i - 1] = order[j];
+            order[j] = tmp;
+        }
+    }
+
+    /* create the files, the shared file is created by rank 0 */
+    if (LAYOUT_N1 == c->layout) {
+        snprintf(path, sizeof(path), "%s/bench.shared", mountpoint);
+    } else {
+        snprintf(path, sizeof(path), "%s/bench.%d", mountpoint, rank);
+    }
+    if (ok && ((LAYOUT_NN == c->layout) || (0 == rank))) {
+        if (unifyfs_create(fshdl, 0, path, &gfid) != UNIFYFS_SUCCESS) {
+            me->errors++;
+            ok = 0;
+        }
+    }
+    bench_barrier();
+    if (ok && (LAYOUT_N1 == c->layout) && (0 != rank)) {
+        if (unifyfs_open(fshdl, path, &gfid) != UNIFYFS_SUCCESS) {
+            me->errors++;
+            ok = 0;
+        }
+    }
+    bench_barrier();
+
+    /* write phase, including the syncs */
+    double start = now_secs();
+    for (size_t i = 0; ok && (i < nblocks); i++) {
+        off_t offset = block_offset(c, rank, nblocks, order, i);
+        fill_block(buf, offset, c->xfer);
+        uint64_t op_start = now_ns();
+        if (io_request(fshdl, gfid, UNIFYFS_IOREQ_OP_WRITE, buf,
+                       offset, c->xfer)) {
+            me->errors++;
+        }
+        record_op(rank, OP_WRITE, op_start);
+
+        size_t n_written = i + 1;
+        if (((c->sync_every > 0) && (0 == (n_written % c->sync_every))) ||
+            (n_written == nblocks)) {
+            op_start = now_ns();
+            if (unifyfs_sync(fshdl, gfid) != UNIFYFS_SUCCESS) {
+                me->errors++;
+            }
+            record_op(rank, OP_SYNC, op_start);
+        }
+    }
+    me->elapsed[OP_WRITE] = now_secs() - start;
+    bench_barrier();
+
+    /* read phase, each process reads the blocks written by the next
+     * process, so reads are served by the server rather than the
+     * client's own log */
+    int peer = (rank + 1) % c->nprocs;
+    unifyfs_gfid read_gfid = gfid;
+    char peer_path[PATH_MAX];
+    if (ok && (LAYOUT_NN == c->layout) && (peer != rank)) {
+        snprintf(peer_path, sizeof(peer_path), "%s/bench.%d",
+                 mountpoint, peer);
+        if (unifyfs_open(fshdl, peer_path, &read_gfid) != UNIFYFS_SUCCESS) {
+            me->errors++;
+            ok = 0;
+        }
+    }
+    start = now_secs();
+    for (size_t i = 0; ok && (i < nblocks); i++) {
+        off_t offset = block_offset(c, peer, nblocks, order, i);
+        uint64_t op_start = now_ns();
+        if (io_request(fshdl, read_gfid, UNIFYFS_IOREQ_OP_READ, buf,
+                       offset, c->xfer) ||
+            check_block(buf, offset, c->xfer)) {
+            me->errors++;
+        }
+        record_op(rank, OP_READ, op_start);
+    }
+    me->elapsed[OP_READ] = now_secs() - start;
+    bench_barrier();
+
+    /* clean up for the next workload */
+    if (ok && ((LAYOUT_NN == c->layout) || (0 == rank))) {
+        if (unifyfs_remove(fshdl, path) != UNIFYFS_SUCCESS) {
+            me->errors++;
+        }
+    }
+    bench_barrier();
+    if (UNIFYFS_INVALID_HANDLE != fshdl) {
+        unifyfs_finalize(fshdl);
+    }
+    free(buf);
+    free(order);
+}
+
+/* metadata workload body of the client process at rank */
+static void run_meta_client(const bench_case_t* c, int rank)
+{
+    bench_proc_t* me = shared->procs + rank;
+    char path[PATH_MAX];
+    unifyfs_handle fshdl;
+
+    int ok = (0 == client_init(c, &fshdl));
+    if (!ok) {
+        me->errors++;
+    }
+
+    unifyfs_gfid* gfids = calloc(meta_files, sizeof(unifyfs_gfid));
+    if (NULL == gfids) {
+        me->errors++;
+        ok = 0;
+    }
+    bench_barrier();
+
+    double start = now_secs();
+    for (size_t i = 0; ok && (i < meta_files); i++) {
+        snprintf(path, sizeof(path), "%s/bench.meta.%d.%zu",
+                 mountpoint, rank, i);
+        uint64_t op_start = now_ns();
+        if (unifyfs_create(fshdl, 0, path, gfids + i) != UNIFYFS_SUCCESS) {
+            me->errors++;
+        }
+        record_op(rank, OP_CREATE, op_start);
+    }
+    me->elapsed[OP_CREATE] = now_secs() - start;
+    bench_barrier();
+
+    start = now_secs();
+    for (size_t i = 0; ok && (i < meta_files); i++) {
+        unifyfs_status st;
+        uint64_t op_start = now_ns();
+        if (unifyfs_stat(fshdl, gfids[i], &st) != UNIFYFS_SUCCESS) {
+            me->errors++;
+        }
+        record_op(rank, OP_STAT, op_start);
+    }
+    me->elapsed[OP_STAT] = now_secs() - start;
+    bench_barrier();
+
+    start = now_secs();
+    for (size_t i = 0; ok && (i < meta_files); i++) {
+        snprintf(path, sizeof(path), "%s/bench.meta.%d.%zu",
+                 mountpoint, rank, i);
+        uint64_t op_start = now_ns();
+        if (unifyfs_remove(fshdl, path) != UNIFYFS_SUCCESS) {
+            me->errors++;
+        }
+        record_op(rank, OP_REMOVE, op_start);
+    }
+    me->elapsed[OP_REMOVE] = now_secs() - start;
+    bench_barrier();
+
+    if (UNIFYFS_INVALID_HANDLE != fshdl) {
+        unifyfs_finalize(fshdl);
+    }
+    free(gfids);
+}
+
+/* fork the client processes of a workload and wait for them */
+static int run_clients(const bench_case_t* c, int is_meta)
+{
+    int ret = 0;
+    pid_t* pids = calloc((size_t)c->nprocs, sizeof(pid_t));
+    if (NULL == pids) {
+        return ENOMEM;
+    }
+
+    fflush(out_fp);
+    fflush(stderr);
+    int nforked = 0;
+    for (int rank = 0; rank < c->nprocs; rank++) {
+        pid_t pid = fork();
+        if (0 == pid) {
+            /* a hung client must not stall the rest of the suite */
+            alarm((unsigned int) timeout_secs);
+            if (is_meta) {
+                run_meta_client(c, rank);
+            } else {
+                run_io_client(c, rank);
+            }
+            _exit(0);
+        } else if (pid < 0) {
+            fprintf(stderr, "fork() failed - %s\n", strerror(errno));
+            ret = errno;
+            break;
+        }
+        pids[nforked++] = pid;
+    }
+
+    if (nforked < c->nprocs) {
+        /* the forked clients would wait forever at the first barrier */
+        for (int i = 0; i < nforked; i++) {
+            kill(pids[i], SIGKILL);
+        }
+    }
+    for (int i = 0; i < nforked; i++) {
+        int status = 0;
+        waitpid(pids[i], &status, 0);
+        if (!WIFEXITED(status) || (0 != WEXITSTATUS(status))) {
+            fprintf(stderr, "client process %d failed (status=%d)\n",
+                    i, status);
+            ret = ECHILD;
+        }
+    }
+    free(pids);
+    return ret;
+}
+
+static int cmp_u64(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* latency of the given percentile of sorted values, in microseconds */
+static double percentile_us(const uint64_t* vals, size_t n, double pct)
+{
+    if (0 == n) {
+        return 0.0;
+    }
+    size_t idx = (size_t)((pct / 100.0) * (double)(n - 1) + 0.5);
+    return (double)vals[idx] / 1000.0;
+}
+
+/* write the JSON summary of an operation over all processes. Throughput
+ * is computed over the slowest process's elapsed time for the phase. */
+static void print_op(const bench_case_t* c, bench_op_e op,
+                     const char* name, size_t op_bytes, int timed)
+{
+    size_t total = 0;
+    double elapsed = 0.0;
+    for (int p = 0; p < c->nprocs; p++) {
+        bench_proc_t* bp = shared->procs + p;
+        size_t n = bp->n_ops[op];
+        total += (n < shared->max_ops) ? n : shared->max_ops;
+        if (bp->elapsed[op] > elapsed) {
+            elapsed = bp->elapsed[op];
+        }
+    }
+
+    uint64_t* vals = malloc((total ? total : 1) * sizeof(uint64_t));
+    if (NULL == vals) {
+        return;
+    }
+    size_t n_vals = 0;
+    for (int p = 0; p < c->nprocs; p++) {
+        size_t n = shared->procs[p].n_ops[op];
+        if (n > shared->max_ops) {
+            n = shared->max_ops;
+        }
+        memcpy(vals + n_vals, op_latencies(p, op), n * sizeof(uint64_t));
+        n_vals += n;
+    }
+    qsort(vals, n_vals, sizeof(uint64_t), cmp_u64);
+
+    fprintf(out_fp, ",\"%s\":{\"ops\":%zu", name, n_vals);
+    if (timed && (elapsed > 0.0)) {
+        if (op_bytes) {
+            double mib = (double)(op_bytes * n_vals) / (double)MIB;
+            fprintf(out_fp, ",\"mib_per_sec\":%.2f", mib / elapsed);
+        } else {
+            fprintf(out_fp, ",\"ops_per_sec\":%.1f",
+                    (double)n_vals / elapsed);
+        }
+    }
+    fprintf(out_fp, ",\"lat_us\":{\"p50\":%.1f,\"p90\":%.1f,"
+            "\"p99\":%.1f,\"max\":%.1f}}",
+            percentile_us(vals, n_vals, 50.0),
+            percentile_us(vals, n_vals, 90.0),
+            percentile_us(vals, n_vals, 99.0),
+            percentile_us(vals, n_vals, 100.0));
+    free(vals);
+}
+
+/* read a memory size (in KiB) of the server from /proc */
+static long server_mem_kib(const char* field)
+{
+    char filename[64];
+    char line[256];
+    long kib = -1;
+    size_t len = strlen(field);
+
+    snprintf(filename, sizeof(filename), "/proc/%d/status", (int)server_pid);
+    FILE* fp = fopen(filename, "r");
+    if (NULL == fp) {
+        return -1;
+    }
+    while (NULL != fgets(line, sizeof(line), fp)) {
+        if ((0 == strncmp(line, field, len)) && (':' == line[len])) {
+            kib = strtol(line + len + 1, NULL, 10);
+            break;
+        }
+    }
+    fclose(fp);
+    return kib;
+}
+
+static int print_result(const bench_case_t* c, int is_meta, int rc)
+{
+    int errors = 0;
+    for (int p = 0; p < c->nprocs; p++) {
+        errors += shared->procs[p].errors;
+    }
+
+    if (is_meta) {
+        fprintf(out_fp, "{\"workload\":\"meta\",\"procs\":%d,"
+                "\"files_per_proc\":%zu", c->nprocs, meta_files);
+        for (int op = 0; op < OP_MAX; op++) {
+            print_op(c, (bench_op_e)op, meta_op_names[op], 0, 1);
+        }
+    } else {
+        fprintf(out_fp, "{\"workload\":\"io\",\"procs\":%d,"
+                "\"layout\":\"%s\",\"access\":\"%s\",\"storage\":\"%s\","
+                "\"xfer_size\":%zu,\"sync_every\":%zu,"
+                "\"bytes_per_proc\":%zu",
+                c->nprocs, layout_names[c->layout],
+                access_names[c->access], storage_names[c->storage],
+                c->xfer, c->sync_every,
+                (bytes_per_proc / c->xfer) * c->xfer);
+        print_op(c, OP_WRITE, io_op_names[OP_WRITE], c->xfer, 1);
+        print_op(c, OP_SYNC, io_op_names[OP_SYNC], 0, 0);
+        print_op(c, OP_READ, io_op_names[OP_READ], c->xfer, 1);
+    }
+    fprintf(out_fp, ",\"server_rss_kib\":%ld,\"server_hwm_kib\":%ld,"
+            "\"errors\":%d,\"rc\":%d}\n",
+            server_mem_kib("VmRSS"), server_mem_kib("VmHWM"), errors, rc);
+    fflush(out_fp);
+
+    return ((0 == rc) && (0 == errors)) ? 0 : EIO;
+}
+
+static int run_case(const bench_case_t* c, int is_meta)
+{
+    size_t max_ops = meta_files;
+    if (!is_meta) {
+        max_ops = bytes_per_proc / c->xfer;
+        if (0 == max_ops) {
+            fprintf(stderr, "transfer size %zu is larger than %zu bytes "
+                    "per process\n", c->xfer, bytes_per_proc);
+            return EINVAL;
+        }
+    }
+
+    int rc = shared_alloc(c->nprocs, max_ops);
+    if (rc) {
+        return rc;
+    }
+    rc = run_clients(c, is_meta);
+    rc = print_result(c, is_meta, rc);
+    shared_free();
+    return rc;
+}
+
+static int join_path(char* path, size_t path_sz,
+                     const char* dir, const char* name)
+{
+    int n = snprintf(path, path_sz, "%s/%s", dir, name);
+    if ((n < 0) || ((size_t)n >= path_sz)) {
+        fprintf(stderr, "path %s/%s is too long\n", dir, name);
+        return ENAMETOOLONG;
+    }
+    return 0;
+}
+
+static int make_dir(const char* parent, const char* name,
+                    char* path, size_t path_sz)
+{
+    int rc = join_path(path, path_sz, parent, name);
+    if (rc) {
+        return rc;
+    }
+    if ((mkdir(path, 0700) != 0) && (errno != EEXIST)) {
+        fprintf(stderr, "failed to create %s - %s\n", path, strerror(errno));
+        return errno;
+    }
+    return 0;
+}
+
+/* start unifyfsd in the foreground with its state in the work directory,
+ * and wait until it is ready for clients */
+static int start_server(void)
+{
+    char meta_dir[PATH_MAX];
+    char share_dir[PATH_MAX];
+    char spill_dir[PATH_MAX];
+    char state_dir[PATH_MAX];
+    char hostfile[PATH_MAX];
+    char pidfile[PATH_MAX];
+    char stdlog[PATH_MAX];
+    char host[256] = "localhost";
+
+    if ((mkdir(work_dir, 0700) != 0) && (errno != EEXIST)) {
+        fprintf(stderr, "failed to create %s - %s\n",
+                work_dir, strerror(errno));
+        return errno;
+    }
+    if (make_dir(work_dir, "meta", meta_dir, sizeof(meta_dir)) ||
+        make_dir(work_dir, "share", share_dir, sizeof(share_dir)) ||
+        make_dir(work_dir, "spill", spill_dir, sizeof(spill_dir)) ||
+        make_dir(work_dir, "state", state_dir, sizeof(state_dir))) {
+        return EIO;
+    }
+
+    /* a single server on this host */
+    gethostname(host, sizeof(host));
+    host[sizeof(host) - 1] = '\0';
+    if (join_path(hostfile, sizeof(hostfile), share_dir, "unifyfsd.hosts") ||
+        join_path(pidfile, sizeof(pidfile), share_dir,
+                  UNIFYFSD_PID_FILENAME) ||
+        join_path(stdlog, sizeof(stdlog), work_dir, "unifyfsd.stdlog")) {
+        return ENAMETOOLONG;
+    }
+    FILE* fp = fopen(hostfile, "w");
+    if (NULL == fp) {
+        fprintf(stderr, "failed to create %s - %s\n",
+                hostfile, strerror(errno));
+        return errno;
+    }
+    fprintf(fp, "1\n%s\n", host);
+    fclose(fp);
+
+    unlink(pidfile);
+
+    /* the clients inherit these settings too */
+    setenv("UNIFYFS_MOUNTPOINT", mountpoint, 1);
+    setenv("UNIFYFS_DAEMONIZE", "off", 1);
+    setenv("UNIFYFS_META_DB_PATH", meta_dir, 1);
+    setenv("UNIFYFS_SHAREDFS_DIR", share_dir, 1);
+    setenv("UNIFYFS_RUNSTATE_DIR", state_dir, 1);
+    setenv("UNIFYFS_LOG_DIR", state_dir, 1);
+    setenv("UNIFYFS_LOGIO_SPILL_DIR", spill_dir, 1);
+    setenv("UNIFYFS_SERVER_HOSTFILE", hostfile, 1);
+    setenv("UNIFYFS_LOG_VERBOSITY", "1", 0);
+
+    fflush(out_fp);
+    fflush(stderr);
+    server_pid = fork();
+    if (0 == server_pid) {
+        FILE* log = freopen(stdlog, "w", stdout);
+        if (NULL != log) {
+            dup2(fileno(stdout), fileno(stderr));
+        }
+        execl(server_path, server_path, (char*)NULL);
+        fprintf(stderr, "failed to exec %s - %s\n",
+                server_path, strerror(errno));
+        _exit(1);
+    } else if (server_pid < 0) {
+        fprintf(stderr, "fork() failed - %s\n", strerror(errno));
+        return errno;
+    }
+
+    /* the server writes its pid file once it accepts clients */
+    for (int waited = 0; waited < (timeout_secs * 10); waited++) {
+        int status;
+        if (waitpid(server_pid, &status, WNOHANG) == server_pid) {
+            fprintf(stderr, "unifyfsd exited during startup, see %s\n",
+                    stdlog);
+            server_pid = -1;
+            return ECHILD;
+        }
+        struct stat st;
+        if ((stat(pidfile, &st) == 0) && (st.st_size > 0)) {
+            return 0;
+        }
+        usleep(100000);
+    }
+    fprintf(stderr, "timed out waiting for unifyfsd, see %s\n", stdlog);
+    return ETIMEDOUT;
+}
+
+static void stop_server(void)
+{
+    if (server_pid <= 0) {
+        return;
+    }
+    kill(server_pid, SIGTERM);
+    for (int waited = 0; waited < 300; waited++) {
+        if (waitpid(server_pid, NULL, WNOHANG) == server_pid) {
+            server_pid = -1;
+            return;
+        }
+        usleep(100000);
+    }
+    fprintf(stderr, "unifyfsd did not exit, killing it\n");
+    kill(server_pid, SIGKILL);
+    waitpid(server_pid, NULL, 0);
+    server_pid = -1;
+}
+
+#define MAX_LIST 16
+
+/* run every combination of the I/O parameter lists, then the metadata
+ * workload for each process count */
+static int run_matrix(void)
+{
+    char* procs[MAX_LIST];
+    char* layouts[MAX_LIST];
+    char* accesses[MAX_LIST];
+    char* xfers[MAX_LIST];
+    char* storages[MAX_LIST];
+    char* syncs[MAX_LIST];
+    int n_procs, n_layouts, n_accesses, n_xfers, n_storages, n_syncs;
+    int ret = 0;
+
+    char* lists[6];
+    lists[0] = split_list(procs_list, procs, MAX_LIST, &n_procs);
+    lists[1] = split_list(layout_list, layouts, MAX_LIST, &n_layouts);
+    lists[2] = split_list(access_list, accesses, MAX_LIST, &n_accesses);
+    lists[3] = split_list(xfer_list, xfers, MAX_LIST, &n_xfers);
+    lists[4] = split_list(storage_list, storages, MAX_LIST, &n_storages);
+    lists[5] = split_list(sync_list, syncs, MAX_LIST, &n_syncs);
+
+    bench_case_t c;
+    memset(&c, 0, sizeof(c));
+    for (int p = 0; p < n_procs; p++) {
+        c.nprocs = atoi(procs[p]);
+        if (c.nprocs <= 0) {
+            continue;
+        }
+        for (int l = 0; l < n_layouts; l++) {
+            int layout = lookup_name(layouts[l], layout_names, 2);
+            if (layout < 0) {
+                /* also accept the names without the dash */
+                layout = (0 == strcmp(layouts[l], "n1")) ? LAYOUT_N1 :
+                         (0 == strcmp(layouts[l], "nn")) ? LAYOUT_NN : -1;
+            }
+            if (layout < 0) {
+                fprintf(stderr, "unknown layout %s\n", layouts[l]);
+                ret = EINVAL;
+                continue;
+            }
+            c.layout = (bench_layout_e) layout;
+            for (int a = 0; a < n_accesses; a++) {
+                int access = lookup_name(accesses[a], access_names, 3);
+                if (access < 0) {
+                    fprintf(stderr, "unknown access %s\n", accesses[a]);
+                    ret = EINVAL;
+                    continue;
+                }
+                c.access = (bench_access_e) access;
+                for (int x = 0; x < n_xfers; x++) {
+                    c.xfer = parse_size(xfers[x]);
+                    if (0 == c.xfer) {
+                        continue;
+                    }
+                    for (int s = 0; s < n_storages; s++) {
+                        int storage = lookup_name(storages[s],
+                                                  storage_names, 2);
+                        if (storage < 0) {
+                            fprintf(stderr, "unknown storage %s\n",
+                                    storages[s]);
+                            ret = EINVAL;
+                            continue;
+                        }
+                        c.storage = (bench_storage_e) storage;
+                        for (int y = 0; y < n_syncs; y++) {
+                            c.sync_every = (size_t) atol(syncs[y]);
+                            if (run_case(&c, 0) != 0) {
+                                ret = EIO;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        if (meta_files > 0) {
+            c.storage = STORAGE_SHMEM;
+            if (run_case(&c, 1) != 0) {
+                ret = EIO;
+            }
+        }
+    }
+
+    for (int i = 0; i < 6; i++) {
+        free(lists[i]);
+    }
+    return ret;
+}
+
+static void print_usage(const char* prog)
+{
+    fprintf(stderr,
+            "usage: %s [options]\n"
+            "  -S, --server=PATH     unifyfsd to run (default %s)\n"
+            "  -d, --dir=DIR         work directory for server state\n"
+            "                        (default /tmp/unifyfs-bench.<pid>)\n"
+            "  -m, --mount=PATH      mountpoint (default %s)\n"
+            "  -o, --output=FILE     write results to FILE (default stdout)\n"
+            "  -n, --procs=LIST      client process counts (default %s)\n"
+            "  -l, --layout=LIST     nn (file per process), n1 (shared file)"
+            "\n                        (default %s)\n"
+            "  -a, --access=LIST     seq, strided, random (default %s)\n"
+            "  -x, --xfer=LIST       transfer sizes (default %s)\n"
+            "  -s, --storage=LIST    shmem, spill (default %s)\n"
+            "  -y, --sync=LIST       writes between syncs, 0 syncs at end\n"
+            "                        (default %s)\n"
+            "  -b, --bytes=SIZE      bytes written per process "
+            "(default %zu)\n"
+            "  -f, --files=NUM       metadata files per process, 0 skips\n"
+            "                        (default %zu)\n"
+            "  -t, --timeout=SECS    limit on each client process "
+            "(default %d)\n"
+            "  -h, --help            print this usage\n",
+            prog, server_path, mountpoint, procs_list, layout_list,
+            access_list, xfer_list, storage_list, sync_list,
+            bytes_per_proc, meta_files, timeout_secs);
+}
+
+static struct option long_opts[] = {
+    { "server", 1, 0, 'S' },
+    { "dir", 1, 0, 'd' },
+    { "mount", 1, 0, 'm' },
+    { "output", 1, 0, 'o' },
+    { "procs", 1, 0, 'n' },
+    { "layout", 1, 0, 'l' },
+    { "access", 1, 0, 'a' },
+    { "xfer", 1, 0, 'x' },
+    { "storage", 1, 0, 's' },
+    { "sync", 1, 0, 'y' },
+    { "bytes", 1, 0, 'b' },
+    { "files", 1, 0, 'f' },
+    { "timeout", 1, 0, 't' },
+    { "help", 0, 0, 'h' },
+    { 0, 0, 0, 0 },
+};
+
+int main(int argc, char** argv)
+{
+    int ch;
+    char* output = NULL;
+    char default_dir[64];
+
+    while ((ch = getopt_long(argc, argv, "S:d:m:o:n:l:a:x:s:y:b:f:t:h",
+                             long_opts, NULL)) != -1) {
+        switch (ch) {
+        case 'S':
+            server_path = optarg;
+            break;
+        case 'd':
+            work_dir = optarg;
+            break;
+        case 'm':
+            mountpoint = optarg;
+            break;
+        case 'o':
+            output = optarg;
+            break;
+        case 'n':
+            procs_list = optarg;
+            break;
+        case 'l':
+            layout_list = optarg;
+            break;
+        case 'a':
+            access_list = optarg;
+            break;
+        case 'x':
+            xfer_list = optarg;
+            break;
+        case 's':
+            storage_list = optarg;
+            break;
+        case 'y':
+            sync_list = optarg;
+            break;
+        case 'b':
+            bytes_per_proc = parse_size(optarg);
+            break;
+        case 'f':
+            meta_files = strtoul(optarg, NULL, 0);
+            break;
+        case 't':
+            timeout_secs = atoi(optarg);
+            break;
+        case 'h':
+        default:
+            print_usage(argv[0]);
+            return (ch == 'h') ? 0 : 1;
+        }
+    }
+
+    if ((0 == bytes_per_proc) || (timeout_secs <= 0)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (NULL == work_dir) {
+        snprintf(default_dir, sizeof(default_dir), "/tmp/unifyfs-bench.%d",
+                 (int) getpid());
+        work_dir = default_dir;
+    }
+
+    out_fp = stdout;
+    if (NULL != output) {
+        out_fp = fopen(output, "w");
+        if (NULL == out_fp) {
+            fprintf(stderr, "failed to open %s - %s\n",
+                    output, strerror(errno));
+            return 1;
+        }
+    }
+
+    int ret = start_server();
+    if (0 == ret) {
+        ret = run_matrix();
+    }
+    stop_server();
+
+    if (stdout != out_fp) {
+        fclose(out_fp);
+    }
+    return (0 == ret) ? 0 : 1;
+}
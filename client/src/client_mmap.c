@@ -0,0 +1,505 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#include "client_mmap.h"
+#include "unifyfs-sysio.h"
+
+/* a memory mapping of a UnifyFS file */
+typedef struct {
+    char*     addr;      /* start of mapping, NULL if entry is not in use */
+    size_t    length;    /* length of mapping (multiple of page size) */
+    off_t     offset;    /* file offset at start of mapping */
+    int       fid;       /* local file id */
+    int64_t   gfid;      /* global file id, to detect reuse of fid */
+    int       writeback; /* whether changes are written back to file */
+    uint64_t* page_hash; /* hash of each page when last read or written */
+} client_mmap_t;
+
+/* list of mappings, protected by mmap_sync */
+static client_mmap_t mmaps[UNIFYFS_CLIENT_MAX_MMAPS];
+static pthread_mutex_t mmap_sync = PTHREAD_MUTEX_INITIALIZER;
+
+/* range of log data that can be mapped directly */
+typedef struct {
+    off_t  file_offset; /* page-aligned file offset */
+    off_t  log_offset;  /* log offset of data at file_offset */
+    size_t length;      /* multiple of page size */
+} direct_range_t;
+
+/* hash of a page, used to find pages that changed since they were last
+ * read from or written back to the file */
+static uint64_t page_hash(const char* page, size_t page_sz)
+{
+    const uint64_t* words = (const uint64_t*) page;
+    size_t n_words = page_sz / sizeof(uint64_t);
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < n_words; i++) {
+        hash ^= words[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static inline size_t round_up(size_t val, size_t align)
+{
+    return ((val + align - 1) / align) * align;
+}
+
+/* find the pages of [offset, offset+length) of the laminated file
+ * that can be mapped straight from our log, which requires both the
+ * file offset and the storage location of the data to be page
+ * aligned. Returns number of ranges found, and sets *ranges to a
+ * list the caller must free. */
+static int find_direct_ranges(unifyfs_filemeta_t* meta,
+                              off_t offset,
+                              size_t length,
+                              size_t page_sz,
+                              direct_range_t** ranges)
+{
+    *ranges = NULL;
+    if (!unifyfs_local_extents || !meta->attrs.is_laminated) {
+        return 0;
+    }
+
+    int count = 0;
+    int max_count = 0;
+    direct_range_t* list = NULL;
+
+    off_t map_end = offset + (off_t)length;
+    struct seg_tree* extents = &meta->extents;
+    seg_tree_rdlock(extents);
+    struct seg_tree_node* node = seg_tree_find_nolock(extents,
+        (unsigned long)offset, (unsigned long)(map_end - 1));
+    while ((NULL != node) && ((off_t)node->start < map_end)) {
+        /* page-aligned part of extent within mapping */
+        off_t ext_start = (off_t)node->start;
+        off_t ext_end = (off_t)node->end + 1;
+        off_t start = (ext_start > offset) ? ext_start : offset;
+        off_t end = (ext_end < map_end) ? ext_end : map_end;
+        start = (off_t) round_up((size_t)start, page_sz);
+        end = (end / (off_t)page_sz) * (off_t)page_sz;
+
+        off_t log_offset = (off_t)node->ptr + (start - ext_start);
+        if ((end > start) && ((log_offset % (off_t)page_sz) == 0)) {
+            if (count == max_count) {
+                max_count = (max_count) ? (2 * max_count) : 16;
+                direct_range_t* tmp = realloc(list,
+                    max_count * sizeof(direct_range_t));
+                if (NULL == tmp) {
+                    break;
+                }
+                list = tmp;
+            }
+            list[count].file_offset = start;
+            list[count].log_offset  = log_offset;
+            list[count].length      = (size_t)(end - start);
+            count++;
+        }
+        node = seg_tree_iter(extents, node);
+    }
+    seg_tree_unlock(extents);
+
+    *ranges = list;
+    return count;
+}
+
+/* read [pos, pos+count) of file into buf, zero-filling past end of
+ * file */
+static int fill_from_file(int fd, off_t pos, char* buf, size_t count)
+{
+    if (0 == count) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    size_t nread = 0;
+    int rc = unifyfs_fd_read(fd, pos, buf, count, &nread);
+    if (rc != UNIFYFS_SUCCESS) {
+        return rc;
+    }
+    if (nread < count) {
+        memset(buf + nread, 0, count - nread);
+    }
+    return UNIFYFS_SUCCESS;
+}
+
+int client_mmap_create(int fd,
+                       void* addr,
+                       size_t length,
+                       int prot,
+                       int flags,
+                       off_t offset,
+                       void** maddr)
+{
+    *maddr = MAP_FAILED;
+
+    int fid = unifyfs_get_fid_from_fd(fd);
+    unifyfs_fd_t* filedesc = unifyfs_get_filedesc_from_fd(fd);
+    if ((fid < 0) || (NULL == filedesc)) {
+        return EBADF;
+    }
+    unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
+    assert(meta != NULL);
+
+    size_t page_sz = get_page_size();
+    if ((0 == length) || (offset < 0) || (offset % (off_t)page_sz)) {
+        return EINVAL;
+    }
+
+    int shared = ((flags & MAP_SHARED) != 0);
+    if (shared == ((flags & MAP_PRIVATE) != 0)) {
+        /* must give exactly one of MAP_SHARED or MAP_PRIVATE */
+        return EINVAL;
+    }
+
+    /* a file must be open for reading to map it, and open for writing
+     * to write to a shared mapping */
+    int writeback = (shared && (prot & PROT_WRITE));
+    if (!filedesc->read) {
+        return EACCES;
+    }
+    if (writeback && (!filedesc->write || meta->attrs.is_laminated)) {
+        return EACCES;
+    }
+
+    size_t map_len = round_up(length, page_sz);
+
+    /* find a free entry for the mapping */
+    pthread_mutex_lock(&mmap_sync);
+    client_mmap_t* map = NULL;
+    for (int i = 0; i < UNIFYFS_CLIENT_MAX_MMAPS; i++) {
+        if (NULL == mmaps[i].addr) {
+            map = &mmaps[i];
+            break;
+        }
+    }
+    if (NULL == map) {
+        pthread_mutex_unlock(&mmap_sync);
+        LOGERR("too many mappings of UnifyFS files");
+        return ENOMEM;
+    }
+
+    /* reserve memory for mapping */
+    int anon_flags = MAP_PRIVATE | MAP_ANONYMOUS | (flags & MAP_FIXED);
+    MAP_OR_FAIL(mmap);
+    char* base = UNIFYFS_REAL(mmap)(addr, map_len, (PROT_READ | PROT_WRITE),
+                                    anon_flags, -1, 0);
+    if (MAP_FAILED == (void*)base) {
+        int err = errno;
+        pthread_mutex_unlock(&mmap_sync);
+        return err;
+    }
+    map->addr = base;
+    map->length = map_len;
+    map->writeback = 0;
+    map->page_hash = NULL;
+    pthread_mutex_unlock(&mmap_sync);
+
+    /* map what we can straight from our log when the mapping is only
+     * read, and read the rest of the data from the file */
+    int rc = UNIFYFS_SUCCESS;
+    direct_range_t* ranges = NULL;
+    int n_ranges = 0;
+    if (prot == PROT_READ) {
+        n_ranges = find_direct_ranges(meta, offset, map_len, page_sz,
+                                      &ranges);
+    }
+    off_t filled = offset;
+    for (int i = 0; (i < n_ranges) && (rc == UNIFYFS_SUCCESS); i++) {
+        char* range_addr = base + (ranges[i].file_offset - offset);
+        int map_rc = unifyfs_logio_map(logio_ctx, ranges[i].log_offset,
+                                       ranges[i].length, range_addr);
+        if (map_rc != UNIFYFS_SUCCESS) {
+            /* leave these pages to be read below */
+            continue;
+        }
+        rc = fill_from_file(fd, filled, base + (filled - offset),
+                            (size_t)(ranges[i].file_offset - filled));
+        filled = ranges[i].file_offset + (off_t)ranges[i].length;
+    }
+    free(ranges);
+    if (rc == UNIFYFS_SUCCESS) {
+        rc = fill_from_file(fd, filled, base + (filled - offset),
+                            (size_t)((offset + (off_t)map_len) - filled));
+    }
+
+    /* remember page contents, so we can tell which ones change */
+    uint64_t* hashes = NULL;
+    if ((rc == UNIFYFS_SUCCESS) && writeback) {
+        size_t n_pages = map_len / page_sz;
+        hashes = malloc(n_pages * sizeof(uint64_t));
+        if (NULL == hashes) {
+            rc = ENOMEM;
+        } else {
+            for (size_t i = 0; i < n_pages; i++) {
+                hashes[i] = page_hash(base + (i * page_sz), page_sz);
+            }
+        }
+    }
+
+    /* we read pages of writable mappings to find changes */
+    if (writeback) {
+        prot |= PROT_READ;
+    }
+    if ((rc == UNIFYFS_SUCCESS) && (prot != (PROT_READ | PROT_WRITE))) {
+        if (0 != mprotect(base, map_len, prot)) {
+            rc = errno;
+        }
+    }
+
+    pthread_mutex_lock(&mmap_sync);
+    if (rc != UNIFYFS_SUCCESS) {
+        MAP_OR_FAIL(munmap);
+        UNIFYFS_REAL(munmap)(base, map_len);
+        free(hashes);
+        map->addr = NULL;
+    } else {
+        map->offset = offset;
+        map->fid = fid;
+        map->gfid = meta->attrs.gfid;
+        map->writeback = writeback;
+        map->page_hash = hashes;
+        *maddr = base;
+        LOGDBG("mapped %zu bytes at offset=%zu of gfid=%" PRId64 " to %p",
+               map_len, (size_t)offset, meta->attrs.gfid, (void*)base);
+    }
+    pthread_mutex_unlock(&mmap_sync);
+
+    return rc;
+}
+
+int client_mmap_is_tracked(void* addr, size_t length)
+{
+    char* start = (char*) addr;
+    char* end = start + length;
+    int found = 0;
+    pthread_mutex_lock(&mmap_sync);
+    for (int i = 0; i < UNIFYFS_CLIENT_MAX_MMAPS; i++) {
+        client_mmap_t* map = &mmaps[i];
+        if ((NULL != map->addr) &&
+            (start < (map->addr + map->length)) && (map->addr < end)) {
+            found = 1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&mmap_sync);
+    return found;
+}
+
+/* write back changed pages of map within [start, end), which are
+ * page aligned, and sync them with the server, called with
+ * mmap_sync held */
+static int mmap_writeback(client_mmap_t* map, char* start, char* end,
+                          size_t page_sz)
+{
+    if (!map->writeback) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    /* bound range by mapping */
+    if (start < map->addr) {
+        start = map->addr;
+    }
+    if (end > (map->addr + map->length)) {
+        end = map->addr + map->length;
+    }
+    if (start >= end) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    int fid = map->fid;
+    if (unifyfs_gfid_from_fid(fid) != map->gfid) {
+        LOGWARN("file of mapping at %p no longer exists", map->addr);
+        return EBADF;
+    }
+
+    /* data beyond the end of the file is not written back */
+    off_t file_size = unifyfs_fid_logical_size(fid);
+
+    int ret = UNIFYFS_SUCCESS;
+    int wrote = 0;
+    size_t first = (size_t)(start - map->addr) / page_sz;
+    size_t last = (size_t)(end - map->addr) / page_sz;
+    size_t page = first;
+    while (page < last) {
+        /* find next run of changed pages */
+        char* page_addr = map->addr + (page * page_sz);
+        uint64_t hash = page_hash(page_addr, page_sz);
+        if (hash == map->page_hash[page]) {
+            page++;
+            continue;
+        }
+        size_t run_start = page;
+        while (page < last) {
+            page_addr = map->addr + (page * page_sz);
+            hash = page_hash(page_addr, page_sz);
+            if (hash == map->page_hash[page]) {
+                break;
+            }
+            map->page_hash[page] = hash;
+            page++;
+        }
+
+        off_t pos = map->offset + (off_t)(run_start * page_sz);
+        size_t count = (page - run_start) * page_sz;
+        if (pos >= file_size) {
+            break;
+        }
+        if ((pos + (off_t)count) > file_size) {
+            count = (size_t)(file_size - pos);
+        }
+
+        size_t nwritten = 0;
+        char* buf = map->addr + (run_start * page_sz);
+        int rc = unifyfs_fid_write(fid, pos, buf, count, &nwritten);
+        if (rc != UNIFYFS_SUCCESS) {
+            LOGERR("failed to write back %zu bytes at offset=%zu "
+                   "of gfid=%" PRId64, count, (size_t)pos, map->gfid);
+            ret = rc;
+        }
+        wrote = 1;
+    }
+
+    if (wrote) {
+        int rc = unifyfs_fid_sync(fid);
+        if (rc != UNIFYFS_SUCCESS) {
+            ret = rc;
+        }
+    }
+    return ret;
+}
+
+int client_mmap_sync(void* addr, size_t length)
+{
+    size_t page_sz = get_page_size();
+    char* start = (char*) addr;
+    char* end = (char*) round_up((uintptr_t)start + length, page_sz);
+
+    int ret = UNIFYFS_SUCCESS;
+    pthread_mutex_lock(&mmap_sync);
+    for (int i = 0; i < UNIFYFS_CLIENT_MAX_MMAPS; i++) {
+        client_mmap_t* map = &mmaps[i];
+        if ((NULL != map->addr) &&
+            (start < (map->addr + map->length)) && (map->addr < end)) {
+            int rc = mmap_writeback(map, start, end, page_sz);
+            if (rc != UNIFYFS_SUCCESS) {
+                ret = rc;
+            }
+        }
+    }
+    pthread_mutex_unlock(&mmap_sync);
+    return ret;
+}
+
+int client_mmap_unmap(void* addr, size_t length)
+{
+    size_t page_sz = get_page_size();
+    char* start = (char*) addr;
+    char* end = (char*) round_up((uintptr_t)start + length, page_sz);
+    if ((uintptr_t)start % page_sz) {
+        return EINVAL;
+    }
+
+    int ret = UNIFYFS_SUCCESS;
+    pthread_mutex_lock(&mmap_sync);
+
+    /* a range inside a single mapping splits it in two, get the entry
+     * and page hashes for its tail before anything is changed, so that
+     * the unmap fails as a whole if they can't be had */
+    client_mmap_t* tail = NULL;
+    uint64_t* tail_hash = NULL;
+    for (int i = 0; i < UNIFYFS_CLIENT_MAX_MMAPS; i++) {
+        client_mmap_t* map = &mmaps[i];
+        if ((NULL == map->addr) || (start <= map->addr) ||
+            (end >= (map->addr + map->length))) {
+            continue;
+        }
+        for (int j = 0; j < UNIFYFS_CLIENT_MAX_MMAPS; j++) {
+            if (NULL == mmaps[j].addr) {
+                tail = &mmaps[j];
+                break;
+            }
+        }
+        if ((NULL != tail) && map->writeback) {
+            size_t tail_pages = (size_t)(map->addr + map->length - end)
+                                / page_sz;
+            tail_hash = malloc(tail_pages * sizeof(uint64_t));
+        }
+        if ((NULL == tail) || (map->writeback && (NULL == tail_hash))) {
+            pthread_mutex_unlock(&mmap_sync);
+            return ENOMEM;
+        }
+        break;
+    }
+
+    for (int i = 0; i < UNIFYFS_CLIENT_MAX_MMAPS; i++) {
+        client_mmap_t* map = &mmaps[i];
+        if ((NULL == map->addr) || (map == tail)) {
+            continue;
+        }
+        char* map_end = map->addr + map->length;
+        if ((start >= map_end) || (map->addr >= end)) {
+            continue;
+        }
+
+        int rc = mmap_writeback(map, start, end, page_sz);
+        if (rc != UNIFYFS_SUCCESS) {
+            ret = rc;
+        }
+
+        /* keep the parts of the mapping before and after the range */
+        char* head_end = (start > map->addr) ? start : map->addr;
+        char* tail_start = (end < map_end) ? end : map_end;
+        size_t head_pages = (size_t)(head_end - map->addr) / page_sz;
+        size_t tail_pages = (size_t)(map_end - tail_start) / page_sz;
+        if (tail_pages && head_pages) {
+            /* range is in the middle, track tail as a new mapping */
+            *tail = *map;
+            tail->addr = tail_start;
+            tail->length = tail_pages * page_sz;
+            tail->offset = map->offset + (off_t)(tail_start - map->addr);
+            tail->page_hash = tail_hash;
+            if (map->writeback) {
+                size_t first = (size_t)(tail_start - map->addr) / page_sz;
+                memcpy(tail->page_hash, map->page_hash + first,
+                       tail_pages * sizeof(uint64_t));
+            }
+            map->length = head_pages * page_sz;
+        } else if (head_pages) {
+            map->length = head_pages * page_sz;
+        } else if (tail_pages) {
+            size_t first = (size_t)(tail_start - map->addr) / page_sz;
+            if (map->writeback) {
+                memmove(map->page_hash, map->page_hash + first,
+                        tail_pages * sizeof(uint64_t));
+            }
+            map->offset += (off_t)(tail_start - map->addr);
+            map->addr = tail_start;
+            map->length = tail_pages * page_sz;
+        } else {
+            /* whole mapping is gone */
+            free(map->page_hash);
+            map->page_hash = NULL;
+            map->addr = NULL;
+            map->length = 0;
+        }
+    }
+
+    MAP_OR_FAIL(munmap);
+    if (0 != UNIFYFS_REAL(munmap)(addr, length)) {
+        ret = errno;
+    }
+    pthread_mutex_unlock(&mmap_sync);
+
+    return ret;
+}
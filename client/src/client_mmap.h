@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#ifndef _UNIFYFS_CLIENT_MMAP_H
+#define _UNIFYFS_CLIENT_MMAP_H
+
+#include "unifyfs-internal.h"
+
+/* Memory mappings of UnifyFS files.
+ *
+ * A mapping is anonymous memory filled with the file data when it is
+ * created. For read-only mappings of laminated files, pages of file data
+ * that this client wrote to its local log (and so are tracked as local
+ * extents) are instead mapped directly from log storage. Writes to a
+ * shared writable mapping are written back to the file through the log
+ * on msync() and munmap(), where only pages that changed since they were
+ * last read or written back are written. Changes to private mappings
+ * are never written back. */
+
+/* Map length bytes of the file open on fd starting at offset, using
+ * the given mmap() protection and flags. On success, sets *maddr to the
+ * start of the mapping and returns UNIFYFS_SUCCESS. Otherwise, returns
+ * an error code. */
+int client_mmap_create(int fd,
+                       void* addr,
+                       size_t length,
+                       int prot,
+                       int flags,
+                       off_t offset,
+                       void** maddr);
+
+/* Returns 1 if any part of [addr, addr+length) is in a mapping of a
+ * UnifyFS file, 0 otherwise */
+int client_mmap_is_tracked(void* addr, size_t length);
+
+/* Write back changed pages of shared writable mappings that overlap
+ * [addr, addr+length) and sync them with the server. Returns
+ * UNIFYFS_SUCCESS, or an error code. */
+int client_mmap_sync(void* addr, size_t length);
+
+/* Write back changed pages as in client_mmap_sync() and unmap the
+ * given range of any mappings that overlap it. Returns UNIFYFS_SUCCESS,
+ * or an error code. */
+int client_mmap_unmap(void* addr, size_t length);
+
+#endif // _UNIFYFS_CLIENT_MMAP_H
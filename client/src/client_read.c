@@ -13,12 +13,15 @@
  */
 
 #include "client_read.h"
+#include "unifyfs_stats.h"
+#include "unifyfs_trace.h"
 
 
 static void debug_print_read_req(read_req_t* req)
 {
     if (NULL != req) {
-        LOGDBG("read_req[%p] gfid=%d, file offset=%zu, length=%zu, buf=%p"
+        LOGDBG("read_req[%p] gfid=%" PRId64
+               ", file offset=%zu, length=%zu, buf=%p"
                " - nread=%zu, errcode=%d (%s), byte coverage=[%zu,%zu]",
                req, req->gfid, req->offset, req->length, req->buf, req->nread,
                req->errcode, unifyfs_rc_enum_description(req->errcode),
@@ -295,7 +298,7 @@ void service_local_reqs(
     for (i = 0; i < count; i++) {
         /* get current read request */
         read_req_t* req = &read_reqs[i];
-        int gfid = req->gfid;
+        int64_t gfid = req->gfid;
 
         /* lookup local extents if we have them */
         int fid = unifyfs_fid_from_gfid(gfid);
@@ -451,16 +454,9 @@ int compare_read_req(const void* a, const void* b)
     }
 }
 
-/**
- * Service a list of client read requests using either local
- * data or forwarding requests to the server.
- *
- * @param in_reqs     a list of read requests
- * @param in_count    number of read requests
- *
- * @return error code
- */
-int process_gfid_reads(read_req_t* in_reqs, int in_count)
+/* service a list of read requests, see process_gfid_reads() */
+static int service_gfid_reads(read_req_t* in_reqs, int in_count,
+                              unifyfs_trace_ctx_t* trace)
 {
     if (0 == in_count) {
         return UNIFYFS_SUCCESS;
@@ -520,6 +516,13 @@ int process_gfid_reads(read_req_t* in_reqs, int in_count)
         service_local_reqs(in_reqs, in_count,
                            local_reqs, server_reqs, &server_count);
 
+        /* completed requests are at the front of the local list */
+        uint64_t local_bytes = 0;
+        for (i = 0; i < (in_count - server_count); i++) {
+            local_bytes += local_reqs[i].nread;
+        }
+        unifyfs_stats_add(UNIFYFS_STAT_CLIENT_READ_LOCAL_BYTES, local_bytes);
+
         /* return early if we satisfied all requests locally */
         if (server_count == 0) {
             /* copy completed requests back into user's array */
@@ -552,6 +555,7 @@ int process_gfid_reads(read_req_t* in_reqs, int in_count)
         return ENOMEM;
     }
     unsigned int mread_id = mread->id;
+    mread->trace = *trace;
 
     /* create buffer of extent requests */
     size_t size = (size_t)server_count * sizeof(unifyfs_extent_t);
@@ -572,8 +576,11 @@ int process_gfid_reads(read_req_t* in_reqs, int in_count)
            mread_id, server_count, server_reqs);
 
     /* invoke multi-read rpc on server */
-    read_rc = invoke_client_mread_rpc(mread_id, server_count, size, buffer);
+    uint64_t rpc_start = unifyfs_stats_now_ns();
+    read_rc = invoke_client_mread_rpc(mread_id, server_count, size, buffer,
+                                      trace);
     free(buffer);
+    unifyfs_trace_span(trace, UNIFYFS_TRACE_CLIENT_MREAD_RPC, rpc_start);
 
     if (read_rc != UNIFYFS_SUCCESS) {
         /* mark requests as failed if we couldn't even start the read(s) */
@@ -591,6 +598,7 @@ int process_gfid_reads(read_req_t* in_reqs, int in_count)
 
         /* this loop uses usleep() instead of pthread_cond_timedwait()
          * because that method caused unexplained read timeouts */
+        uint64_t wait_start = unifyfs_stats_now_ns();
         int wait_time_ms = 0;
         int complete = 0;
         while (1) {
@@ -619,6 +627,8 @@ int process_gfid_reads(read_req_t* in_reqs, int in_count)
         }
         LOGDBG("mread[%u] wait completed - %u requests, %u errors",
                mread->id, mread->n_reads, mread->n_error);
+        unifyfs_trace_span(trace, UNIFYFS_TRACE_CLIENT_READ_WAIT,
+                           wait_start);
     }
 
     /* got all of the data we'll get from the server, check for short reads
@@ -736,4 +746,35 @@ int process_gfid_reads(read_req_t* in_reqs, int in_count)
     return ret;
 }
 
+/**
+ * Service a list of client read requests using either local
+ * data or forwarding requests to the server.
+ *
+ * @param in_reqs     a list of read requests
+ * @param in_count    number of read requests
+ *
+ * @return error code
+ */
+int process_gfid_reads(read_req_t* in_reqs, int in_count)
+{
+    uint64_t start_ns = unifyfs_stats_now_ns();
+
+    unifyfs_trace_ctx_t trace;
+    unifyfs_trace_begin(&trace);
 
+    /* outstanding reads are tracked in shared client state */
+    unifyfs_client_lock();
+    int ret = service_gfid_reads(in_reqs, in_count, &trace);
+    unifyfs_client_unlock();
+
+    if ((NULL != in_reqs) && (in_count > 0)) {
+        uint64_t bytes = 0;
+        for (int i = 0; i < in_count; i++) {
+            bytes += in_reqs[i].nread;
+        }
+        unifyfs_stats_add(UNIFYFS_STAT_CLIENT_READ_BYTES, bytes);
+        unifyfs_stats_record(UNIFYFS_STAT_CLIENT_READ, start_ns);
+        unifyfs_trace_span(&trace, UNIFYFS_TRACE_CLIENT_READ, start_ns);
+    }
+    return ret;
+}
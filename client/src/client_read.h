@@ -29,6 +29,7 @@ typedef struct {
     unsigned int id;         /* unique id for this set of read requests */
     unsigned int n_reads;    /* number of read requests */
     read_req_t* reqs;        /* array of read requests */
+    unifyfs_trace_ctx_t trace; /* trace context of the read */
 
     /* the following is for synchronizing access/updates to below state */
     ABT_mutex sync;
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#include "client_shm_queue.h"
+
+/* number of times we check for a result before sleeping on it, the
+ * server usually answers local requests within a few microseconds */
+#define SHM_QUEUE_SPIN_COUNT 4096
+
+/* time to sleep on a result before checking it again (usec), and
+ * time after which we give up on it */
+#define SHM_QUEUE_WAIT_USEC 10000
+#define SHM_QUEUE_TIMEOUT_USEC \
+    ((long)UNIFYFS_CLIENT_READ_TIMEOUT_SECONDS * 1000000)
+
+/* request queue in our superblock */
+static void* shm_queue; // = NULL
+
+/* set when the server is taking requests from the queue */
+static volatile int shm_queue_enabled; // = 0
+
+/* number of requests we have posted, protected by shm_queue_sync,
+ * which lets our threads take turns as the single producer */
+static uint64_t shm_queue_tail; // = 0
+static pthread_mutex_t shm_queue_sync = PTHREAD_MUTEX_INITIALIZER;
+
+void client_shm_queue_init(void* queue)
+{
+    pthread_mutex_lock(&shm_queue_sync);
+
+    /* a client from an earlier run may have left requests in the queue,
+     * only reset the slot headers, so the rest stays untouched */
+    unifyfs_shm_reqq_header_t* hdr = queue;
+    hdr->doorbell = 0;
+    hdr->server_waiting = 0;
+    for (uint64_t i = 0; i < UNIFYFS_SHM_REQQ_DEPTH; i++) {
+        unifyfs_shm_reqq_slot_t* slot = unifyfs_shm_reqq_slot(queue, i);
+        slot->state = SHM_REQQ_SLOT_FREE;
+        slot->client_waiting = 0;
+    }
+
+    shm_queue = queue;
+    shm_queue_tail = 0;
+    shm_queue_enabled = 0;
+
+    pthread_mutex_unlock(&shm_queue_sync);
+}
+
+void client_shm_queue_enable(int enable)
+{
+    shm_queue_enabled = enable;
+}
+
+/* wait for the server to complete the request in the given slot,
+ * returns UNIFYFS_SUCCESS once the result is ready, or
+ * UNIFYFS_ERROR_TIMEOUT if we gave up on it */
+static int wait_for_result(unifyfs_shm_reqq_slot_t* slot)
+{
+    uint32_t state;
+    for (int i = 0; i < SHM_QUEUE_SPIN_COUNT; i++) {
+        state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+        if (state != SHM_REQQ_SLOT_POSTED) {
+            return UNIFYFS_SUCCESS;
+        }
+    }
+
+    /* tell the server to wake us, then sleep until the state changes */
+    __atomic_store_n(&slot->client_waiting, 1, __ATOMIC_SEQ_CST);
+    long waited = 0;
+    while (1) {
+        state = __atomic_load_n(&slot->state, __ATOMIC_SEQ_CST);
+        if (state != SHM_REQQ_SLOT_POSTED) {
+            return UNIFYFS_SUCCESS;
+        }
+
+        int rc = unifyfs_shm_futex_wait(&slot->state, state,
+                                        SHM_QUEUE_WAIT_USEC);
+        if (rc == UNIFYFS_ERROR_TIMEOUT) {
+            waited += SHM_QUEUE_WAIT_USEC;
+            if (waited >= SHM_QUEUE_TIMEOUT_USEC) {
+                /* give up, unless the result arrived meanwhile,
+                 * the server frees the slot when it is done */
+                uint32_t expected = SHM_REQQ_SLOT_POSTED;
+                if (__atomic_compare_exchange_n(&slot->state, &expected,
+                                                SHM_REQQ_SLOT_ABANDONED, 0,
+                                                __ATOMIC_SEQ_CST,
+                                                __ATOMIC_SEQ_CST)) {
+                    return UNIFYFS_ERROR_TIMEOUT;
+                }
+            }
+        }
+    }
+}
+
+int client_shm_queue_request(client_rpc_e req_type,
+                             unifyfs_shm_reqq_args_t* args,
+                             const void* in_data,
+                             size_t in_size,
+                             void* out_data,
+                             size_t* out_size)
+{
+    if (!shm_queue_enabled || (in_size > UNIFYFS_SHM_REQQ_DATA_MAX)) {
+        return EAGAIN;
+    }
+
+    /* claim the next slot, unless the server or the thread that last
+     * used it are not yet done with it */
+    pthread_mutex_lock(&shm_queue_sync);
+    if (NULL == shm_queue) {
+        pthread_mutex_unlock(&shm_queue_sync);
+        return EAGAIN;
+    }
+    unifyfs_shm_reqq_header_t* hdr = shm_queue;
+    unifyfs_shm_reqq_slot_t* slot =
+        unifyfs_shm_reqq_slot(shm_queue, shm_queue_tail);
+    uint32_t state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+    if (state != SHM_REQQ_SLOT_FREE) {
+        pthread_mutex_unlock(&shm_queue_sync);
+        LOGDBG("request queue is full");
+        return EAGAIN;
+    }
+
+    /* fill in request, then post it */
+    slot->req_type = (int32_t) req_type;
+    slot->ret = UNIFYFS_SUCCESS;
+    slot->client_waiting = 0;
+    slot->args = *args;
+    slot->data_size = (uint32_t) in_size;
+    if (in_size > 0) {
+        memcpy(slot->data, in_data, in_size);
+    }
+    __atomic_store_n(&slot->state, SHM_REQQ_SLOT_POSTED, __ATOMIC_RELEASE);
+    shm_queue_tail++;
+    pthread_mutex_unlock(&shm_queue_sync);
+
+    /* ring the doorbell, waking the server if it is sleeping */
+    __atomic_add_fetch(&hdr->doorbell, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&hdr->server_waiting, __ATOMIC_SEQ_CST)) {
+        unifyfs_shm_futex_wake(&hdr->doorbell, 1);
+    }
+
+    int ret = wait_for_result(slot);
+    if (ret != UNIFYFS_SUCCESS) {
+        LOGERR("timed out waiting for queued request type=%d",
+               (int)req_type);
+        return ret;
+    }
+
+    /* copy out results, then release the slot */
+    ret = (int) slot->ret;
+    *args = slot->args;
+    if (NULL != out_size) {
+        size_t data_size = (size_t) slot->data_size;
+        if (data_size > UNIFYFS_SHM_REQQ_DATA_MAX) {
+            data_size = UNIFYFS_SHM_REQQ_DATA_MAX;
+        }
+        if (data_size > *out_size) {
+            data_size = *out_size;
+        }
+        if (data_size > 0) {
+            memcpy(out_data, slot->data, data_size);
+        }
+        *out_size = data_size;
+    }
+    __atomic_store_n(&slot->state, SHM_REQQ_SLOT_FREE, __ATOMIC_RELEASE);
+
+    return ret;
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#ifndef _UNIFYFS_CLIENT_SHM_QUEUE_H
+#define _UNIFYFS_CLIENT_SHM_QUEUE_H
+
+#include "unifyfs-internal.h"
+#include "unifyfs_client_rpcs.h"
+
+/* client side of the shared-memory request queue to the local server
+ * (see unifyfs_shm_reqq_slot_t in unifyfs_meta.h) */
+
+/* reset the request queue at the given location in the superblock,
+ * the queue is not used until it is enabled */
+void client_shm_queue_init(void* queue);
+
+/* start (enable=1) or stop (enable=0) sending requests through the
+ * queue, it should only be enabled once the server has attached */
+void client_shm_queue_enable(int enable);
+
+/* Send a request of the given type through the queue and wait for its
+ * result. On input, args holds the request arguments, and in_data points
+ * to in_size bytes of request data. On return, args holds the results,
+ * and up to *out_size bytes of result data are copied to out_data, with
+ * *out_size set to the number of bytes copied. Returns EAGAIN if the
+ * request could not be queued (the queue is not enabled or full, or the
+ * data is too large), in which case the caller should use an RPC.
+ * Otherwise returns the result of the request. */
+int client_shm_queue_request(client_rpc_e req_type,
+                             unifyfs_shm_reqq_args_t* args,
+                             const void* in_data,
+                             size_t in_size,
+                             void* out_data,
+                             size_t* out_size);
+
+#endif // _UNIFYFS_CLIENT_SHM_QUEUE_H
@@ -13,91 +13,536 @@
  */
 
 #include "client_transfer.h"
+#include "margo_client.h"
 #include "unifyfs-sysio.h"
 
+/* Data is copied through a ring of transfer buffers. The calling thread
+ * reads chunks from the source into free buffers, while a writer thread
+ * writes filled buffers to the destination, so that reading chunk N+1
+ * overlaps writing chunk N. */
+typedef struct tx_pipeline {
+    int fd_dst;
+    size_t depth;           /* number of buffers in ring */
+    char** bufs;            /* transfer buffers */
+    off_t* offsets;         /* file offset of data in each buffer */
+    size_t* lengths;        /* length of data in each buffer */
+    size_t n_filled;        /* number of buffers filled by reader */
+    size_t n_written;       /* number of buffers written by writer */
+    int done;               /* set when reader will fill no more buffers */
+    int error;              /* first error hit by writer */
+    pthread_mutex_t sync;
+    pthread_cond_t cond;
+} tx_pipeline;
+
+/* Background transfers run in several worker threads, alongside the
+ * application's own threads. Every call a transfer makes into the client
+ * library holds the library lock (see unifyfs_client_lock()) for the whole
+ * call, so that transfers and application threads take turns inside the
+ * library, while reads and writes of files on other file systems still
+ * overlap. */
+
+/* lock the client library if fd is a UnifyFS file descriptor,
+ * returns 1 if the lock was taken */
+static int tx_lock_fd(int fd)
+{
+    if (unifyfs_intercept_fd(&fd)) {
+        unifyfs_client_lock();
+        return 1;
+    }
+    return 0;
+}
+
+static void tx_unlock_fd(int locked)
+{
+    if (locked) {
+        unifyfs_client_unlock();
+    }
+}
+
+static int tx_open(const char* path, int flags, mode_t mode)
+{
+    unifyfs_client_lock();
+    int fd = UNIFYFS_WRAP(open)(path, flags, mode);
+    unifyfs_client_unlock();
+    return fd;
+}
+
+static int tx_close(int fd)
+{
+    int locked = tx_lock_fd(fd);
+    int rc = UNIFYFS_WRAP(close)(fd);
+    tx_unlock_fd(locked);
+    return rc;
+}
+
+static ssize_t tx_pread(int fd, void* buf, size_t count, off_t offset)
+{
+    int locked = tx_lock_fd(fd);
+    ssize_t n = UNIFYFS_WRAP(pread)(fd, buf, count, offset);
+    tx_unlock_fd(locked);
+    return n;
+}
+
+static ssize_t tx_pwrite(int fd, const void* buf, size_t count, off_t offset)
+{
+    int locked = tx_lock_fd(fd);
+    ssize_t n = UNIFYFS_WRAP(pwrite)(fd, buf, count, offset);
+    tx_unlock_fd(locked);
+    return n;
+}
+
+static off_t tx_lseek(int fd, off_t offset, int whence)
+{
+    int locked = tx_lock_fd(fd);
+    off_t pos = UNIFYFS_WRAP(lseek)(fd, offset, whence);
+    tx_unlock_fd(locked);
+    return pos;
+}
+
+static int tx_fsync(int fd)
+{
+    int locked = tx_lock_fd(fd);
+    int rc = UNIFYFS_WRAP(fsync)(fd);
+    tx_unlock_fd(locked);
+    return rc;
+}
+
+static int tx_ftruncate(int fd, off_t length)
+{
+    int locked = tx_lock_fd(fd);
+    int rc = UNIFYFS_WRAP(ftruncate)(fd, length);
+    tx_unlock_fd(locked);
+    return rc;
+}
+
+static int tx_stat(const char* path, struct stat* buf)
+{
+    unifyfs_client_lock();
+    int rc = UNIFYFS_WRAP(stat)(path, buf);
+    unifyfs_client_unlock();
+    return rc;
+}
+
+static int tx_chmod(const char* path, mode_t mode)
+{
+    unifyfs_client_lock();
+    int rc = UNIFYFS_WRAP(chmod)(path, mode);
+    unifyfs_client_unlock();
+    return rc;
+}
+
+static int tx_unlink(const char* path)
+{
+    unifyfs_client_lock();
+    int rc = UNIFYFS_WRAP(unlink)(path);
+    unifyfs_client_unlock();
+    return rc;
+}
+
+static int tx_get_file_meta(int64_t gfid, unifyfs_file_attr_t* gfattr)
+{
+    unifyfs_client_lock();
+    int rc = unifyfs_get_global_file_meta(gfid, gfattr);
+    unifyfs_client_unlock();
+    return rc;
+}
+
+/* write all count bytes in buf to fd at offset */
+static int write_fully(int fd, const char* buf, size_t count, off_t offset)
+{
+    while (count > 0) {
+        errno = 0;
+        ssize_t n_written = tx_pwrite(fd, buf, count, offset);
+        int err = errno;
+        if (n_written < 0) {
+            if (err == EINTR || err == EAGAIN) {
+                continue;
+            }
+            return err;
+        } else if (n_written == 0) {
+            return (err) ? err : EIO;
+        }
+        buf += n_written;
+        count -= (size_t) n_written;
+        offset += (off_t) n_written;
+    }
+    return UNIFYFS_SUCCESS;
+}
+
+static void* tx_writer_thread(void* arg)
+{
+    tx_pipeline* tx = (tx_pipeline*) arg;
+
+    pthread_mutex_lock(&tx->sync);
+    while (1) {
+        while ((tx->n_written == tx->n_filled) && !tx->done) {
+            pthread_cond_wait(&tx->cond, &tx->sync);
+        }
+        if (tx->n_written == tx->n_filled) {
+            /* reader is done, and we have written everything */
+            break;
+        }
+        size_t slot = tx->n_written % tx->depth;
+        pthread_mutex_unlock(&tx->sync);
+
+        int rc = UNIFYFS_SUCCESS;
+        if (!tx->error) {
+            rc = write_fully(tx->fd_dst, tx->bufs[slot],
+                             tx->lengths[slot], tx->offsets[slot]);
+        }
+
+        pthread_mutex_lock(&tx->sync);
+        if (rc != UNIFYFS_SUCCESS && !tx->error) {
+            tx->error = rc;
+        }
+        tx->n_written++;
+        pthread_cond_signal(&tx->cond);
+    }
+    pthread_mutex_unlock(&tx->sync);
+
+    return NULL;
+}
+
+/* copy the given file ranges from fd_src to the same offsets in fd_dst,
+ * stops early with ECANCELED if *cancel is set */
 static
 int do_transfer_data(int fd_src,
                      int fd_dst,
-                     off_t offset,
-                     size_t count)
+                     size_t n_ranges,
+                     unifyfs_extent_t* ranges,
+                     volatile int* cancel)
 {
     int ret = UNIFYFS_SUCCESS;
-    int err;
-    off_t pos = 0;
-    ssize_t n_written = 0;
-    ssize_t n_read = 0;
-    ssize_t n_processed = 0;
-    size_t len = UNIFYFS_TX_BUFSIZE;
-    char* buf = NULL;
-
-    buf = malloc(UNIFYFS_TX_BUFSIZE);
-    if (NULL == buf) {
-        LOGERR("failed to allocate transfer buffer");
-        return ENOMEM;
+
+    size_t count = 0;
+    for (size_t i = 0; i < n_ranges; i++) {
+        count += ranges[i].length;
     }
 
-    errno = 0;
-    pos = UNIFYFS_WRAP(lseek)(fd_src, offset, SEEK_SET);
-    err = errno;
-    if (pos == (off_t) -1) {
-        LOGERR("lseek failed (%d: %s)\n", err, strerror(err));
-        ret = err;
-        goto out;
+    tx_pipeline tx = { 0, };
+    tx.fd_dst = fd_dst;
+    tx.depth = (size_t) unifyfs_transfer_depth;
+    if (tx.depth > 1) {
+        /* no point in having more buffers than chunks */
+        size_t n_chunks = (count / UNIFYFS_TX_BUFSIZE) + n_ranges;
+        if (tx.depth > n_chunks) {
+            tx.depth = n_chunks;
+        }
+    }
+    if (tx.depth < 1) {
+        tx.depth = 1;
     }
 
-    errno = 0;
-    pos = UNIFYFS_WRAP(lseek)(fd_dst, offset, SEEK_SET);
-    err = errno;
-    if (pos == (off_t) -1) {
-        LOGERR("lseek failed (%d: %s)\n", err, strerror(err));
-        ret = err;
+    size_t n_bufs = tx.depth;
+    tx.bufs = calloc(tx.depth, sizeof(char*));
+    tx.offsets = calloc(tx.depth, sizeof(off_t));
+    tx.lengths = calloc(tx.depth, sizeof(size_t));
+    if ((NULL == tx.bufs) || (NULL == tx.offsets) || (NULL == tx.lengths)) {
+        LOGERR("failed to allocate transfer buffers");
+        ret = ENOMEM;
         goto out;
     }
+    for (size_t i = 0; i < n_bufs; i++) {
+        tx.bufs[i] = malloc(UNIFYFS_TX_BUFSIZE);
+        if (NULL == tx.bufs[i]) {
+            LOGERR("failed to allocate transfer buffer");
+            ret = ENOMEM;
+            goto out;
+        }
+    }
+
+    /* with a single buffer, write in this thread after each read */
+    int use_writer = (tx.depth > 1);
+    pthread_t writer;
+    if (use_writer) {
+        pthread_mutex_init(&tx.sync, NULL);
+        pthread_cond_init(&tx.cond, NULL);
+        int rc = pthread_create(&writer, NULL, tx_writer_thread, &tx);
+        if (rc != 0) {
+            LOGERR("failed to create transfer writer thread");
+            use_writer = 0;
+            tx.depth = 1;
+            pthread_cond_destroy(&tx.cond);
+            pthread_mutex_destroy(&tx.sync);
+        }
+    }
+
+    size_t range_ndx = 0;
+    size_t n_processed = 0; /* bytes of current range already copied */
+    while (range_ndx < n_ranges) {
+        unifyfs_extent_t* range = ranges + range_ndx;
+        if (n_processed == range->length) {
+            range_ndx++;
+            n_processed = 0;
+            continue;
+        }
+        if ((NULL != cancel) && *cancel) {
+            ret = ECANCELED;
+            break;
+        }
 
-    while (count > n_processed) {
-        if (len > count) {
-            len = count;
+        /* wait for a free buffer */
+        size_t slot = 0;
+        if (use_writer) {
+            pthread_mutex_lock(&tx.sync);
+            while ((tx.n_filled - tx.n_written) == tx.depth) {
+                pthread_cond_wait(&tx.cond, &tx.sync);
+            }
+            slot = tx.n_filled % tx.depth;
+            int werr = tx.error;
+            pthread_mutex_unlock(&tx.sync);
+            if (werr) {
+                ret = werr;
+                break;
+            }
         }
 
+        size_t len = range->length - n_processed;
+        if (len > UNIFYFS_TX_BUFSIZE) {
+            len = UNIFYFS_TX_BUFSIZE;
+        }
+        off_t pos = (off_t)(range->offset + n_processed);
+
         errno = 0;
-        n_read = UNIFYFS_WRAP(read)(fd_src, buf, len);
-        err = errno;
+        ssize_t n_read = tx_pread(fd_src, tx.bufs[slot], len, pos);
+        int err = errno;
         if (n_read == 0) {  /* EOF */
             break;
         } else if (n_read < 0) {   /* error */
+            if (err == EINTR || err == EAGAIN) {
+                continue;
+            }
             ret = err;
-            goto out;
+            break;
         }
 
-        do {
-            errno = 0;
-            n_written = UNIFYFS_WRAP(write)(fd_dst, buf, n_read);
-            err = errno;
-            if (n_written < 0) {
-                ret = err;
-                goto out;
-            } else if ((n_written == 0) && err && (err != EAGAIN)) {
-                ret = err;
-                goto out;
+        if (use_writer) {
+            /* hand filled buffer to writer */
+            pthread_mutex_lock(&tx.sync);
+            tx.offsets[slot] = pos;
+            tx.lengths[slot] = (size_t) n_read;
+            tx.n_filled++;
+            pthread_cond_signal(&tx.cond);
+            pthread_mutex_unlock(&tx.sync);
+        } else {
+            int rc = write_fully(fd_dst, tx.bufs[slot], (size_t) n_read, pos);
+            if (rc != UNIFYFS_SUCCESS) {
+                ret = rc;
+                break;
             }
+        }
+        n_processed += (size_t) n_read;
+    }
 
-            n_read -= n_written;
-            n_processed += n_written;
-        } while (n_read > 0);
+    if (use_writer) {
+        /* let writer finish what we have read, and stop */
+        pthread_mutex_lock(&tx.sync);
+        tx.done = 1;
+        pthread_cond_signal(&tx.cond);
+        pthread_mutex_unlock(&tx.sync);
+        pthread_join(writer, NULL);
+        if ((ret == UNIFYFS_SUCCESS) && tx.error) {
+            ret = tx.error;
+        }
+        pthread_cond_destroy(&tx.cond);
+        pthread_mutex_destroy(&tx.sync);
     }
 
 out:
-    if (NULL != buf) {
-        free(buf);
+    if (NULL != tx.bufs) {
+        for (size_t i = 0; i < n_bufs; i++) {
+            free(tx.bufs[i]);
+        }
+        free(tx.bufs);
+    }
+    free(tx.offsets);
+    free(tx.lengths);
+
+    return ret;
+}
+
+/* append [offset, offset+length) to the growable list of data ranges,
+ * merging it into the last range when the two are adjacent */
+static int add_data_range(unifyfs_extent_t** ranges,
+                          size_t* n_ranges,
+                          size_t* max_ranges,
+                          size_t offset,
+                          size_t length)
+{
+    if (0 == length) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    if (*n_ranges > 0) {
+        unifyfs_extent_t* last = *ranges + (*n_ranges - 1);
+        if ((last->offset + last->length) == offset) {
+            last->length += length;
+            return UNIFYFS_SUCCESS;
+        }
+    }
+
+    if (*n_ranges == *max_ranges) {
+        size_t new_max = (*max_ranges) ? (2 * (*max_ranges)) : 16;
+        unifyfs_extent_t* tmp = realloc(*ranges,
+                                        new_max * sizeof(unifyfs_extent_t));
+        if (NULL == tmp) {
+            return ENOMEM;
+        }
+        *ranges = tmp;
+        *max_ranges = new_max;
+    }
+
+    unifyfs_extent_t* range = *ranges + *n_ranges;
+    range->gfid = 0;
+    range->offset = offset;
+    range->length = length;
+    (*n_ranges)++;
+    return UNIFYFS_SUCCESS;
+}
+
+/* get the written ranges of a laminated UnifyFS file from the servers,
+ * in batches of UNIFYFS_CLIENT_EXTENT_MAP_RANGES */
+static int get_extent_map_ranges(int64_t gfid,
+                                 size_t size,
+                                 unifyfs_extent_t** ranges,
+                                 size_t* n_ranges,
+                                 size_t* max_ranges)
+{
+    int batch_max = UNIFYFS_CLIENT_EXTENT_MAP_RANGES;
+    unifyfs_extent_t* batch = calloc(batch_max, sizeof(unifyfs_extent_t));
+    if (NULL == batch) {
+        return ENOMEM;
     }
 
+    int ret = UNIFYFS_SUCCESS;
+    size_t offset = 0;
+    while (offset < size) {
+        int n_batch = 0;
+        ret = invoke_client_extent_map_rpc(gfid, offset, batch_max,
+                                           batch, &n_batch);
+        if (ret != UNIFYFS_SUCCESS) {
+            break;
+        }
+        for (int i = 0; i < n_batch; i++) {
+            ret = add_data_range(ranges, n_ranges, max_ranges,
+                                 batch[i].offset, batch[i].length);
+            if (ret != UNIFYFS_SUCCESS) {
+                break;
+            }
+            offset = batch[i].offset + batch[i].length;
+        }
+        if ((ret != UNIFYFS_SUCCESS) || (n_batch < batch_max)) {
+            /* a short batch means we have seen the last range */
+            break;
+        }
+    }
+
+    free(batch);
     return ret;
 }
 
+/* Build the list of ranges of src that hold data, so that holes are
+ * skipped when copying it. Laminated UnifyFS files get their ranges from
+ * the servers' extent maps, other files use SEEK_DATA and SEEK_HOLE. When
+ * the ranges can not be determined, the whole file is one range. */
+static int get_data_ranges(const char* src,
+                           int fd_src,
+                           size_t size,
+                           unifyfs_extent_t** ranges,
+                           size_t* n_ranges)
+{
+    int ret = UNIFYFS_SUCCESS;
+    size_t max_ranges = 0;
+    *ranges = NULL;
+    *n_ranges = 0;
+
+    char src_upath[UNIFYFS_MAX_FILENAME];
+    if (unifyfs_intercept_path(src, src_upath)) {
+        int64_t gfid = unifyfs_generate_gfid(src_upath);
+        unifyfs_file_attr_t gfattr = { 0, };
+        int rc = tx_get_file_meta(gfid, &gfattr);
+        if (NULL != gfattr.filename) {
+            free(gfattr.filename);
+        }
+        if ((rc == UNIFYFS_SUCCESS) && gfattr.is_laminated) {
+            ret = get_extent_map_ranges(gfid, size, ranges, n_ranges,
+                                        &max_ranges);
+            if (ret == UNIFYFS_SUCCESS) {
+                return ret;
+            }
+            LOGDBG("extent map of %s failed (ret=%d), copying whole file",
+                   src, ret);
+            goto whole_file;
+        }
+    }
+
+    size_t offset = 0;
+    while (offset < size) {
+        errno = 0;
+        off_t data = tx_lseek(fd_src, (off_t)offset, SEEK_DATA);
+        if (data < 0) {
+            if (errno == ENXIO) {
+                /* no more data before end of file */
+                break;
+            }
+            /* file system does not support SEEK_DATA */
+            goto whole_file;
+        }
+        off_t hole = tx_lseek(fd_src, data, SEEK_HOLE);
+        if ((hole < 0) || ((size_t)hole > size)) {
+            hole = (off_t) size;
+        }
+        if ((size_t)data >= size) {
+            break;
+        }
+        ret = add_data_range(ranges, n_ranges, &max_ranges,
+                             (size_t)data, (size_t)(hole - data));
+        if (ret != UNIFYFS_SUCCESS) {
+            goto whole_file;
+        }
+        offset = (size_t) hole;
+    }
+    return UNIFYFS_SUCCESS;
+
+whole_file:
+    *n_ranges = 0;
+    return add_data_range(ranges, n_ranges, &max_ranges, 0, size);
+}
+
+/* select the part of the data ranges that covers data bytes
+ * [start, end) counted in order across all ranges, as needed to split
+ * the data of a sparse file evenly among clients */
+static size_t select_data_ranges(unifyfs_extent_t* ranges,
+                                 size_t n_ranges,
+                                 size_t start,
+                                 size_t end,
+                                 unifyfs_extent_t* selected)
+{
+    size_t n_selected = 0;
+    size_t data_pos = 0;
+    for (size_t i = 0; (i < n_ranges) && (data_pos < end); i++) {
+        size_t range_start = data_pos;
+        size_t range_end = data_pos + ranges[i].length;
+        data_pos = range_end;
+        if (range_end <= start) {
+            continue;
+        }
+        size_t skip = (start > range_start) ? (start - range_start) : 0;
+        size_t stop = (end < range_end) ? (end - range_start)
+                                        : ranges[i].length;
+        selected[n_selected] = ranges[i];
+        selected[n_selected].offset += skip;
+        selected[n_selected].length = stop - skip;
+        n_selected++;
+    }
+    return n_selected;
+}
+
 int do_transfer_file_serial(const char* src,
                             const char* dst,
                             struct stat* sb_src,
-                            int direction)
+                            int direction,
+                            volatile int* cancel)
 {
     /* NOTE: we currently do not use the @direction */
 
@@ -107,7 +552,7 @@ int do_transfer_file_serial(const char* src,
     int fd_dst = 0;
 
     errno = 0;
-    fd_src = UNIFYFS_WRAP(open)(src, O_RDONLY);
+    fd_src = tx_open(src, O_RDONLY, 0);
     err = errno;
     if (fd_src < 0) {
         LOGERR("failed to open() source file %s", src);
@@ -115,27 +560,38 @@ int do_transfer_file_serial(const char* src,
     }
 
     errno = 0;
-    fd_dst = UNIFYFS_WRAP(open)(dst, O_WRONLY);
+    fd_dst = tx_open(dst, O_WRONLY, 0);
     err = errno;
     if (fd_dst < 0) {
         LOGERR("failed to open() destination file %s", dst);
-        close(fd_src);
+        tx_close(fd_src);
         return err;
     }
 
-    LOGDBG("serial transfer (rank=%d of %d): length=%zu",
-           client_rank, global_rank_cnt, sb_src->st_size);
+    unifyfs_extent_t* ranges = NULL;
+    size_t n_ranges = 0;
+    ret = get_data_ranges(src, fd_src, (size_t)sb_src->st_size,
+                          &ranges, &n_ranges);
+    if (ret != UNIFYFS_SUCCESS) {
+        LOGERR("failed to get data ranges of %s", src);
+        goto close_files;
+    }
+
+    LOGDBG("serial transfer (rank=%d of %d): length=%zu, #ranges=%zu",
+           client_rank, global_rank_cnt, (size_t)sb_src->st_size, n_ranges);
 
-    ret = do_transfer_data(fd_src, fd_dst, 0, sb_src->st_size);
+    ret = do_transfer_data(fd_src, fd_dst, n_ranges, ranges, cancel);
     if (UNIFYFS_SUCCESS != ret) {
         LOGERR("failed to transfer data (ret=%d, %s)",
                ret, unifyfs_rc_enum_description(ret));
     } else {
-        UNIFYFS_WRAP(fsync)(fd_dst);
+        tx_fsync(fd_dst);
     }
 
-    UNIFYFS_WRAP(close)(fd_dst);
-    UNIFYFS_WRAP(close)(fd_src);
+close_files:
+    free(ranges);
+    tx_close(fd_dst);
+    tx_close(fd_src);
 
     return ret;
 }
@@ -143,7 +599,8 @@ int do_transfer_file_serial(const char* src,
 int do_transfer_file_parallel(const char* src,
                               const char* dst,
                               struct stat* sb_src,
-                              int direction)
+                              int direction,
+                              volatile int* cancel)
 {
     /* NOTE: we currently do not use the @direction */
 
@@ -151,36 +608,51 @@ int do_transfer_file_parallel(const char* src,
     int ret = UNIFYFS_SUCCESS;
     int fd_src = 0;
     int fd_dst = 0;
-    uint64_t total_chunks = 0;
-    uint64_t chunk_start = 0;
-    uint64_t n_chunks_remainder = 0;
-    uint64_t n_chunks_per_rank = 0;
-    uint64_t offset = 0;
-    uint64_t len = 0;
-    uint64_t size = sb_src->st_size;
-    uint64_t last_chunk_size = 0;
+
+    errno = 0;
+    fd_src = tx_open(src, O_RDONLY, 0);
+    err = errno;
+    if (fd_src < 0) {
+        LOGERR("failed to open() source file %s", src);
+        return err;
+    }
+
+    /* the work is split by bytes of data, so that holes in sparse
+     * files do not leave some ranks with nothing to copy */
+    unifyfs_extent_t* ranges = NULL;
+    size_t n_ranges = 0;
+    ret = get_data_ranges(src, fd_src, (size_t)sb_src->st_size,
+                          &ranges, &n_ranges);
+    if (ret != UNIFYFS_SUCCESS) {
+        LOGERR("failed to get data ranges of %s", src);
+        tx_close(fd_src);
+        return ret;
+    }
+
+    uint64_t data_size = 0;
+    for (size_t i = 0; i < n_ranges; i++) {
+        data_size += ranges[i].length;
+    }
 
     /* calculate total number of chunk transfers */
-    total_chunks = size / UNIFYFS_TX_BUFSIZE;
-    last_chunk_size = size % UNIFYFS_TX_BUFSIZE;
-    if (last_chunk_size) {
+    uint64_t total_chunks = data_size / UNIFYFS_TX_BUFSIZE;
+    if (data_size % UNIFYFS_TX_BUFSIZE) {
         total_chunks++;
     }
 
-    /* calculate chunks per rank */
-    n_chunks_per_rank = total_chunks / global_rank_cnt;
-    n_chunks_remainder = total_chunks % global_rank_cnt;
-
     /*
-     * if the file is smaller than (rank_count * transfer_size), just
-     * use the serial mode.
+     * if the file has less than (rank_count * transfer_size) of data,
+     * just use the serial mode.
      *
      * FIXME: is this assumption fair even for the large rank count?
      */
     if (total_chunks <= (uint64_t)global_rank_cnt) {
+        free(ranges);
+        tx_close(fd_src);
         if (client_rank == 0) {
             LOGDBG("using serial transfer for small file");
-            ret = do_transfer_file_serial(src, dst, sb_src, direction);
+            ret = do_transfer_file_serial(src, dst, sb_src, direction,
+                                          cancel);
             if (ret) {
                 LOGERR("do_transfer_file_serial() failed");
             }
@@ -191,67 +663,98 @@ int do_transfer_file_parallel(const char* src,
     }
 
     errno = 0;
-    fd_src = UNIFYFS_WRAP(open)(src, O_RDONLY);
-    err = errno;
-    if (fd_src < 0) {
-        LOGERR("failed to open() source file %s", src);
-        return err;
-    }
-
-    errno = 0;
-    fd_dst = UNIFYFS_WRAP(open)(dst, O_WRONLY);
+    fd_dst = tx_open(dst, O_WRONLY, 0);
     err = errno;
     if (fd_dst < 0) {
         LOGERR("failed to open() destination file %s", dst);
-        UNIFYFS_WRAP(close)(fd_src);
+        free(ranges);
+        tx_close(fd_src);
         return err;
     }
 
-    chunk_start = n_chunks_per_rank * client_rank;
-    offset = chunk_start * UNIFYFS_TX_BUFSIZE;
-    len = n_chunks_per_rank * UNIFYFS_TX_BUFSIZE;
+    /* each rank gets a contiguous run of whole chunks of data, where
+     * the first ranks take one more chunk of any remainder */
+    uint64_t n_chunks_per_rank = total_chunks / global_rank_cnt;
+    uint64_t n_chunks_remainder = total_chunks % global_rank_cnt;
+    uint64_t rank = (uint64_t) client_rank;
+    uint64_t chunk_start = (n_chunks_per_rank * rank) +
+        ((rank < n_chunks_remainder) ? rank : n_chunks_remainder);
+    uint64_t n_chunks = n_chunks_per_rank +
+        ((rank < n_chunks_remainder) ? 1 : 0);
+    uint64_t data_start = chunk_start * UNIFYFS_TX_BUFSIZE;
+    uint64_t data_end = data_start + (n_chunks * UNIFYFS_TX_BUFSIZE);
+    if (data_end > data_size) {
+        data_end = data_size;
+    }
+
+    /* the selected ranges are a subset of the ranges, possibly with
+     * the first and last ones clipped, so they fit in place */
+    size_t n_mine = select_data_ranges(ranges, n_ranges,
+                                       (size_t)data_start, (size_t)data_end,
+                                       ranges);
 
     LOGDBG("parallel transfer (rank=%d of %d): "
-           "#chunks=%zu, offset=%zu, length=%zu",
-           client_rank, global_rank_cnt,
-           (size_t)n_chunks_per_rank, (size_t)offset, (size_t)len);
+           "#chunks=%zu, data offset=%zu, length=%zu, #ranges=%zu",
+           client_rank, global_rank_cnt, (size_t)n_chunks,
+           (size_t)data_start, (size_t)(data_end - data_start), n_mine);
 
-    ret = do_transfer_data(fd_src, fd_dst, (off_t)offset, (size_t)len);
+    ret = do_transfer_data(fd_src, fd_dst, n_mine, ranges, cancel);
     if (ret) {
         LOGERR("failed to transfer data (ret=%d, %s)",
                ret, unifyfs_rc_enum_description(ret));
     } else {
-        if (n_chunks_remainder && (client_rank < n_chunks_remainder)) {
-            /* do single chunk transfer per rank of remainder portion */
-            len = UNIFYFS_TX_BUFSIZE;
-            if (last_chunk_size && (client_rank == (n_chunks_remainder - 1))) {
-                len = last_chunk_size;
-            }
-            chunk_start = (total_chunks - n_chunks_remainder) + client_rank;
-            offset = chunk_start * UNIFYFS_TX_BUFSIZE;
-
-            LOGDBG("parallel transfer (rank=%d of %d): "
-                   "#chunks=1, offset=%zu, length=%zu",
-                   client_rank, global_rank_cnt,
-                   (size_t)offset, (size_t)len);
-            ret = do_transfer_data(fd_src, fd_dst, (off_t)offset, (size_t)len);
-            if (ret) {
-                LOGERR("failed to transfer data (ret=%d, %s)",
-                       ret, unifyfs_rc_enum_description(ret));
-            }
-        }
-        fsync(fd_dst);
+        tx_fsync(fd_dst);
     }
 
-    UNIFYFS_WRAP(close)(fd_dst);
-    UNIFYFS_WRAP(close)(fd_src);
+    free(ranges);
+    tx_close(fd_dst);
+    tx_close(fd_src);
 
     return ret;
 }
 
-int unifyfs_transfer_file(const char* src,
-                          const char* dst,
-                          int parallel)
+/* Ask the servers to stage out the file with the given UnifyFS path
+ * to dst by writing the data in their local logs to it. Sets *done to 0
+ * if the file is not laminated, in which case the client must copy it. */
+static int transfer_file_by_servers(const char* src_upath,
+                                    const char* dst,
+                                    int parallel,
+                                    int* done)
+{
+    *done = 0;
+
+    int64_t gfid = unifyfs_generate_gfid(src_upath);
+    unifyfs_file_attr_t gfattr = { 0, };
+    int rc = tx_get_file_meta(gfid, &gfattr);
+    if (rc != UNIFYFS_SUCCESS) {
+        return rc;
+    }
+    if (NULL != gfattr.filename) {
+        free(gfattr.filename);
+    }
+    if (!gfattr.is_laminated) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    /* for parallel transfers, one request stages out the whole file */
+    *done = 1;
+    if (parallel && (client_rank != 0)) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    LOGDBG("server transfer of %s to %s", src_upath, dst);
+    rc = invoke_client_transfer_rpc(gfid, dst);
+    if (rc != UNIFYFS_SUCCESS) {
+        LOGERR("server transfer of %s to %s failed (ret=%d, %s)",
+               src_upath, dst, rc, unifyfs_rc_enum_description(rc));
+    }
+    return rc;
+}
+
+int client_transfer_file(const char* src,
+                         const char* dst,
+                         int parallel,
+                         volatile int* cancel)
 {
     int rc, err;
     int ret = 0;
@@ -274,7 +777,7 @@ int unifyfs_transfer_file(const char* src,
     }
 
     errno = 0;
-    rc = UNIFYFS_WRAP(stat)(src, &sb_src);
+    rc = tx_stat(src, &sb_src);
     err = errno;
     if (rc < 0) {
         return -err;
@@ -285,7 +788,7 @@ int unifyfs_transfer_file(const char* src,
     pos += sprintf(pos, "%s", dst);
 
     errno = 0;
-    rc = UNIFYFS_WRAP(stat)(dst, &sb_dst);
+    rc = tx_stat(dst, &sb_dst);
     err = errno;
     if (rc == 0 && S_ISDIR(sb_dst.st_mode)) {
         /* if the given destination path is a directory, append the
@@ -304,24 +807,48 @@ int unifyfs_transfer_file(const char* src,
         LOGDBG("WARNING: none of pathnames points to unifyfs volume");
     }
 
+    /* servers can write laminated files out from their logs, but they
+     * resolve the destination path in their own working directories */
+    if (unify_src && !unify_dst && unifyfs_transfer_server &&
+        ('/' == dst_path[0])) {
+        int done = 0;
+        rc = transfer_file_by_servers(src_upath, dst_path, parallel, &done);
+        if ((rc != UNIFYFS_SUCCESS) || done) {
+            return -unifyfs_rc_errno(rc);
+        }
+    }
+
     /* for both serial and parallel transfers, use rank 0 client to
      * create the destination file using the source file's mode*/
     if (0 == client_rank) {
         errno = 0;
         int create_flags = O_CREAT | O_WRONLY | O_TRUNC;
-        int fd = UNIFYFS_WRAP(open)(dst_path, create_flags, sb_src.st_mode);
+        int fd = tx_open(dst_path, create_flags, sb_src.st_mode);
         err = errno;
         if (fd < 0) {
             LOGERR("failed to create destination file %s", dst);
             return -err;
         }
-        close(fd);
+
+        /* size the destination up front, holes in the source are
+         * skipped by the copy and so stay holes in the destination */
+        errno = 0;
+        rc = tx_ftruncate(fd, sb_src.st_size);
+        err = errno;
+        if (rc < 0) {
+            LOGERR("failed to set size of destination file %s", dst);
+            tx_close(fd);
+            return -err;
+        }
+        tx_close(fd);
     }
 
     if (parallel) {
-        rc = do_transfer_file_parallel(src_path, dst_path, &sb_src, txdir);
+        rc = do_transfer_file_parallel(src_path, dst_path, &sb_src, txdir,
+                                       cancel);
     } else {
-        rc = do_transfer_file_serial(src_path, dst_path, &sb_src, txdir);
+        rc = do_transfer_file_serial(src_path, dst_path, &sb_src, txdir,
+                                     cancel);
     }
 
     if (rc != UNIFYFS_SUCCESS) {
@@ -336,9 +863,270 @@ int unifyfs_transfer_file(const char* src,
              * the new file mode. use chmod with the new mode to ask for file
              * lamination. */
             mode_no_write = (sb_src.st_mode) & ~(0222);
-            UNIFYFS_WRAP(chmod)(dst_path, mode_no_write);
+            tx_chmod(dst_path, mode_no_write);
         }
     }
 
     return ret;
 }
+
+int unifyfs_transfer_file(const char* src,
+                          const char* dst,
+                          int parallel)
+{
+    return client_transfer_file(src, dst, parallel, NULL);
+}
+
+/*
+ * Background transfer engine. Dispatched requests are queued, and a pool
+ * of worker threads (client.transfer_threads) runs them, so that several
+ * files are in flight at once and the caller is free to do other work.
+ */
+
+typedef struct tx_job {
+    unifyfs_transfer_request* req;
+    volatile int cancel;     /* set to ask worker to stop transfer */
+    struct tx_job* next;
+} tx_job;
+
+/* engine state, protected by tx_engine_sync */
+static pthread_mutex_t tx_engine_sync = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t tx_engine_work = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t tx_engine_done = PTHREAD_COND_INITIALIZER;
+static tx_job* tx_queue_head;  /* jobs waiting for a worker */
+static tx_job* tx_queue_tail;
+static tx_job* tx_active;      /* jobs being run by workers */
+static pthread_t* tx_workers;
+static int tx_num_workers;
+static int tx_engine_exit;
+
+/* mark request as done, and wake waiters, called with
+ * tx_engine_sync held */
+static void tx_job_finish(tx_job* job, int rc)
+{
+    unifyfs_transfer_request* req = job->req;
+    if (rc == ECANCELED) {
+        req->result.error = ECANCELED;
+        req->result.rc = UNIFYFS_FAILURE;
+        req->state = UNIFYFS_IOREQ_STATE_CANCELED;
+    } else {
+        req->result.error = rc;
+        req->result.rc = (rc) ? UNIFYFS_FAILURE : UNIFYFS_SUCCESS;
+        req->state = UNIFYFS_IOREQ_STATE_COMPLETED;
+    }
+    pthread_cond_broadcast(&tx_engine_done);
+}
+
+static void tx_job_run(tx_job* job)
+{
+    unifyfs_transfer_request* req = job->req;
+    int rc = client_transfer_file(req->src_path, req->dst_path,
+                                  req->use_parallel, &job->cancel);
+    if (rc) {
+        /* client_transfer_file() returns a negative error code */
+        rc = -rc;
+    } else if (req->mode == UNIFYFS_TRANSFER_MODE_MOVE) {
+        /* successful copy, now remove source */
+        errno = 0;
+        if (tx_unlink(req->src_path)) {
+            rc = errno;
+        }
+    }
+
+    pthread_mutex_lock(&tx_engine_sync);
+    tx_job** prev = &tx_active;
+    while (*prev != job) {
+        prev = &((*prev)->next);
+    }
+    *prev = job->next;
+    tx_job_finish(job, rc);
+    pthread_mutex_unlock(&tx_engine_sync);
+
+    free(job);
+}
+
+static void* tx_worker_thread(void* arg)
+{
+    pthread_mutex_lock(&tx_engine_sync);
+    while (1) {
+        while ((NULL == tx_queue_head) && !tx_engine_exit) {
+            pthread_cond_wait(&tx_engine_work, &tx_engine_sync);
+        }
+        if (tx_engine_exit) {
+            break;
+        }
+
+        /* move next job from queue to active list */
+        tx_job* job = tx_queue_head;
+        tx_queue_head = job->next;
+        if (NULL == tx_queue_head) {
+            tx_queue_tail = NULL;
+        }
+        job->next = tx_active;
+        tx_active = job;
+        pthread_mutex_unlock(&tx_engine_sync);
+
+        tx_job_run(job);
+
+        pthread_mutex_lock(&tx_engine_sync);
+    }
+    pthread_mutex_unlock(&tx_engine_sync);
+
+    return NULL;
+}
+
+/* start worker threads if needed, called with tx_engine_sync held */
+static int tx_engine_start(void)
+{
+    if (tx_num_workers > 0) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    int n_workers = unifyfs_transfer_threads;
+    if (n_workers < 1) {
+        n_workers = 1;
+    }
+    tx_workers = calloc((size_t)n_workers, sizeof(pthread_t));
+    if (NULL == tx_workers) {
+        return ENOMEM;
+    }
+
+    tx_engine_exit = 0;
+    for (int i = 0; i < n_workers; i++) {
+        int rc = pthread_create(&tx_workers[i], NULL, tx_worker_thread, NULL);
+        if (rc != 0) {
+            LOGERR("failed to create transfer worker thread");
+            break;
+        }
+        tx_num_workers++;
+    }
+    if (0 == tx_num_workers) {
+        free(tx_workers);
+        tx_workers = NULL;
+        return UNIFYFS_FAILURE;
+    }
+    return UNIFYFS_SUCCESS;
+}
+
+int client_transfer_submit(unifyfs_transfer_request* req)
+{
+    tx_job* job = calloc(1, sizeof(tx_job));
+    if (NULL == job) {
+        return ENOMEM;
+    }
+    job->req = req;
+
+    pthread_mutex_lock(&tx_engine_sync);
+    int rc = tx_engine_start();
+    if (rc != UNIFYFS_SUCCESS) {
+        pthread_mutex_unlock(&tx_engine_sync);
+        free(job);
+        return rc;
+    }
+
+    req->state = UNIFYFS_IOREQ_STATE_IN_PROGRESS;
+    if (NULL == tx_queue_tail) {
+        tx_queue_head = job;
+    } else {
+        tx_queue_tail->next = job;
+    }
+    tx_queue_tail = job;
+    pthread_cond_signal(&tx_engine_work);
+    pthread_mutex_unlock(&tx_engine_sync);
+
+    return UNIFYFS_SUCCESS;
+}
+
+int client_transfer_cancel(unifyfs_transfer_request* req)
+{
+    pthread_mutex_lock(&tx_engine_sync);
+
+    /* a queued job is canceled right away */
+    tx_job* prev = NULL;
+    for (tx_job* job = tx_queue_head; NULL != job; job = job->next) {
+        if (job->req == req) {
+            if (NULL == prev) {
+                tx_queue_head = job->next;
+            } else {
+                prev->next = job->next;
+            }
+            if (tx_queue_tail == job) {
+                tx_queue_tail = prev;
+            }
+            tx_job_finish(job, ECANCELED);
+            pthread_mutex_unlock(&tx_engine_sync);
+            free(job);
+            return UNIFYFS_SUCCESS;
+        }
+        prev = job;
+    }
+
+    /* a running job stops at its next transfer buffer */
+    for (tx_job* job = tx_active; NULL != job; job = job->next) {
+        if (job->req == req) {
+            job->cancel = 1;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&tx_engine_sync);
+    return UNIFYFS_SUCCESS;
+}
+
+int client_transfer_wait(size_t nreqs,
+                         unifyfs_transfer_request* reqs,
+                         int waitall)
+{
+    pthread_mutex_lock(&tx_engine_sync);
+    while (1) {
+        size_t n_done = 0;
+        for (size_t i = 0; i < nreqs; i++) {
+            unifyfs_transfer_request* req = reqs + i;
+            if ((req->state == UNIFYFS_IOREQ_STATE_CANCELED) ||
+                (req->state == UNIFYFS_IOREQ_STATE_COMPLETED)) {
+                n_done++;
+            }
+        }
+        if ((n_done == nreqs) || (!waitall && n_done)) {
+            break;
+        }
+        pthread_cond_wait(&tx_engine_done, &tx_engine_sync);
+    }
+    pthread_mutex_unlock(&tx_engine_sync);
+
+    return UNIFYFS_SUCCESS;
+}
+
+void client_transfer_fini(void)
+{
+    pthread_mutex_lock(&tx_engine_sync);
+    if (0 == tx_num_workers) {
+        pthread_mutex_unlock(&tx_engine_sync);
+        return;
+    }
+
+    /* cancel queued jobs, and stop running ones */
+    while (NULL != tx_queue_head) {
+        tx_job* job = tx_queue_head;
+        tx_queue_head = job->next;
+        tx_job_finish(job, ECANCELED);
+        free(job);
+    }
+    tx_queue_tail = NULL;
+    for (tx_job* job = tx_active; NULL != job; job = job->next) {
+        job->cancel = 1;
+    }
+    tx_engine_exit = 1;
+    pthread_cond_broadcast(&tx_engine_work);
+    pthread_mutex_unlock(&tx_engine_sync);
+
+    for (int i = 0; i < tx_num_workers; i++) {
+        pthread_join(tx_workers[i], NULL);
+    }
+
+    pthread_mutex_lock(&tx_engine_sync);
+    free(tx_workers);
+    tx_workers = NULL;
+    tx_num_workers = 0;
+    pthread_mutex_unlock(&tx_engine_sync);
+}
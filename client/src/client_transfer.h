@@ -12,7 +12,11 @@
  * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
  */
 
+#ifndef _UNIFYFS_CLIENT_TRANSFER_H
+#define _UNIFYFS_CLIENT_TRANSFER_H
+
 #include "unifyfs-internal.h"
+#include "unifyfs_api.h"
 
 /* client transfer (stage-in/out) support */
 
@@ -25,12 +29,42 @@ enum {
     UNIFYFS_TX_PARALLEL = 1,
 };
 
+/* the transfer functions below stop early and return ECANCELED
+ * when given a non-NULL cancel flag that becomes set */
+
 int do_transfer_file_serial(const char* src,
                             const char* dst,
                             struct stat* sb_src,
-                            int direction);
+                            int direction,
+                            volatile int* cancel);
 
 int do_transfer_file_parallel(const char* src,
                               const char* dst,
                               struct stat* sb_src,
-                              int direction);
+                              int direction,
+                              volatile int* cancel);
+
+/* copy src to dst, as unifyfs_transfer_file(), returns 0 on success,
+ * or a negative error code */
+int client_transfer_file(const char* src,
+                         const char* dst,
+                         int parallel,
+                         volatile int* cancel);
+
+/* queue transfer request for background worker threads, marking it
+ * in-progress, its state and result are set when it is done */
+int client_transfer_submit(unifyfs_transfer_request* req);
+
+/* cancel a queued request, or ask a running request to stop,
+ * does nothing for a request that is not queued or running */
+int client_transfer_cancel(unifyfs_transfer_request* req);
+
+/* wait until all (waitall) or any of the requests are done */
+int client_transfer_wait(size_t nreqs,
+                         unifyfs_transfer_request* reqs,
+                         int waitall);
+
+/* cancel outstanding requests and stop worker threads */
+void client_transfer_fini(void);
+
+#endif // _UNIFYFS_CLIENT_TRANSFER_H
@@ -20,6 +20,7 @@
 #include "unifyfs_rpc_util.h"
 #include "margo_client.h"
 #include "client_read.h"
+#include "client_shm_queue.h"
 
 /* global rpc context */
 static client_rpc_context_t* client_rpc_context; // = NULL
@@ -55,10 +56,15 @@ static void register_client_rpcs(client_rpc_context_t* ctx)
     CLIENT_REGISTER_RPC(unmount);
     CLIENT_REGISTER_RPC(metaset);
     CLIENT_REGISTER_RPC(metaget);
+    CLIENT_REGISTER_RPC(extent_map);
     CLIENT_REGISTER_RPC(filesize);
+    CLIENT_REGISTER_RPC(stat);
+    CLIENT_REGISTER_RPC(stat_many);
+    CLIENT_REGISTER_RPC(stats);
     CLIENT_REGISTER_RPC(truncate);
     CLIENT_REGISTER_RPC(unlink);
     CLIENT_REGISTER_RPC(laminate);
+    CLIENT_REGISTER_RPC(transfer);
     CLIENT_REGISTER_RPC(fsync);
     CLIENT_REGISTER_RPC(mread);
     CLIENT_REGISTER_RPC_HANDLER(mread_req_data);
@@ -378,7 +384,8 @@ int invoke_client_metaset_rpc(unifyfs_file_attr_op_e attr_op,
     memcpy(&(in.attr), f_meta, sizeof(*f_meta));
 
     /* call rpc function */
-    LOGDBG("invoking the metaset rpc function in client - gfid:%d file:%s",
+    LOGDBG("invoking the metaset rpc function in client - gfid:%"
+           PRId64 " file:%s",
            in.attr.gfid, in.attr.filename);
     hg_return_t hret = margo_forward(handle, &in);
     if (hret != HG_SUCCESS) {
@@ -407,13 +414,34 @@ int invoke_client_metaset_rpc(unifyfs_file_attr_op_e attr_op,
 }
 
 /* invokes the client metaget rpc function */
-int invoke_client_metaget_rpc(int gfid, unifyfs_file_attr_t* file_meta)
+int invoke_client_metaget_rpc(int64_t gfid, unifyfs_file_attr_t* file_meta)
 {
     /* check that we have initialized margo */
     if (NULL == client_rpc_context) {
         return UNIFYFS_FAILURE;
     }
 
+    /* try the shared-memory request queue first */
+    unifyfs_shm_reqq_args_t args;
+    memset(&args, 0, sizeof(args));
+    args.gfid = gfid;
+    char filename[UNIFYFS_MAX_FILENAME];
+    size_t filename_size = sizeof(filename);
+    int qret = client_shm_queue_request(UNIFYFS_CLIENT_RPC_METAGET, &args,
+                                        NULL, 0, filename, &filename_size);
+    if (qret != EAGAIN) {
+        if (qret == UNIFYFS_SUCCESS) {
+            /* fill in results */
+            *file_meta = args.attr;
+            file_meta->filename = NULL;
+            if (filename_size > 0) {
+                filename[filename_size - 1] = '\0';
+                file_meta->filename = strdup(filename);
+            }
+        }
+        return qret;
+    }
+
     /* get handle to rpc function */
     hg_handle_t handle = create_handle(client_rpc_context->rpcs.metaget_id);
 
@@ -421,7 +449,7 @@ int invoke_client_metaget_rpc(int gfid, unifyfs_file_attr_t* file_meta)
     unifyfs_metaget_in_t in;
     in.app_id    = (int32_t) unifyfs_app_id;
     in.client_id = (int32_t) unifyfs_client_id;
-    in.gfid      = (int32_t)gfid;
+    in.gfid      = gfid;
 
     /* call rpc function */
     LOGDBG("invoking the metaget rpc function in client");
@@ -460,13 +488,26 @@ int invoke_client_metaget_rpc(int gfid, unifyfs_file_attr_t* file_meta)
 }
 
 /* invokes the client filesize rpc function */
-int invoke_client_filesize_rpc(int gfid, size_t* outsize)
+int invoke_client_filesize_rpc(int64_t gfid, size_t* outsize)
 {
     /* check that we have initialized margo */
     if (NULL == client_rpc_context) {
         return UNIFYFS_FAILURE;
     }
 
+    /* try the shared-memory request queue first */
+    unifyfs_shm_reqq_args_t args;
+    memset(&args, 0, sizeof(args));
+    args.gfid = gfid;
+    int qret = client_shm_queue_request(UNIFYFS_CLIENT_RPC_FILESIZE, &args,
+                                        NULL, 0, NULL, NULL);
+    if (qret != EAGAIN) {
+        if (qret == UNIFYFS_SUCCESS) {
+            *outsize = (size_t) args.size;
+        }
+        return qret;
+    }
+
     /* get handle to rpc function */
     hg_handle_t handle = create_handle(client_rpc_context->rpcs.filesize_id);
 
@@ -474,7 +515,7 @@ int invoke_client_filesize_rpc(int gfid, size_t* outsize)
     unifyfs_filesize_in_t in;
     in.app_id    = (int32_t) unifyfs_app_id;
     in.client_id = (int32_t) unifyfs_client_id;
-    in.gfid      = (int32_t) gfid;
+    in.gfid      = gfid;
 
     /* call rpc function */
     LOGDBG("invoking the filesize rpc function in client");
@@ -507,14 +548,324 @@ int invoke_client_filesize_rpc(int gfid, size_t* outsize)
     return ret;
 }
 
+/* invokes the client stat rpc function, which returns file attributes
+ * with an up-to-date size (the filename is not returned). cacheable is
+ * set if the server will bump our metadata epoch when they change */
+int invoke_client_stat_rpc(int64_t gfid, unifyfs_file_attr_t* file_meta,
+                           int* cacheable)
+{
+    /* check that we have initialized margo */
+    if (NULL == client_rpc_context) {
+        return UNIFYFS_FAILURE;
+    }
+
+    /* try the shared-memory request queue first */
+    unifyfs_shm_reqq_args_t args;
+    memset(&args, 0, sizeof(args));
+    args.gfid = gfid;
+    int qret = client_shm_queue_request(UNIFYFS_CLIENT_RPC_STAT, &args,
+                                        NULL, 0, NULL, NULL);
+    if (qret != EAGAIN) {
+        if (qret == UNIFYFS_SUCCESS) {
+            /* fill in results */
+            *file_meta = args.attr;
+            file_meta->filename = NULL;
+            *cacheable = (int) args.cacheable;
+        }
+        return qret;
+    }
+
+    /* get handle to rpc function */
+    hg_handle_t handle = create_handle(client_rpc_context->rpcs.stat_id);
+
+    /* fill in input struct */
+    unifyfs_stat_in_t in;
+    in.app_id    = (int32_t) unifyfs_app_id;
+    in.client_id = (int32_t) unifyfs_client_id;
+    in.gfid      = gfid;
+
+    /* call rpc function */
+    LOGDBG("invoking the stat rpc function in client");
+    hg_return_t hret = margo_forward(handle, &in);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_forward() failed");
+        margo_destroy(handle);
+        return UNIFYFS_ERROR_MARGO;
+    }
+
+    /* decode response */
+    int ret;
+    unifyfs_stat_out_t out;
+    hret = margo_get_output(handle, &out);
+    if (hret == HG_SUCCESS) {
+        LOGDBG("Got response ret=%" PRIi32, out.ret);
+        ret = (int) out.ret;
+        if (ret == (int)UNIFYFS_SUCCESS) {
+            /* fill in results  */
+            *file_meta = out.attr;
+            file_meta->filename = NULL;
+            *cacheable = (int) out.cacheable;
+        }
+        margo_free_output(handle, &out);
+    } else {
+        LOGERR("margo_get_output() failed");
+        ret = UNIFYFS_ERROR_MARGO;
+    }
+
+    /* free resources */
+    margo_destroy(handle);
+
+    return ret;
+}
+
+/* invokes the client stat-many rpc function. the gfid of each entry
+ * in results must be set, and on success the server has filled in the
+ * rc and attributes of each entry */
+int invoke_client_stat_many_rpc(int num_files,
+                                unifyfs_stat_result_t* results)
+{
+    /* check that we have initialized margo */
+    if (NULL == client_rpc_context) {
+        return UNIFYFS_FAILURE;
+    }
+
+    if (num_files <= 0) {
+        return EINVAL;
+    }
+
+    /* get handle to rpc function */
+    hg_handle_t handle = create_handle(client_rpc_context->rpcs.stat_many_id);
+
+    /* initialize bulk handle for results, which the server
+     * reads the gfids from and writes the results to */
+    unifyfs_stat_many_in_t in;
+    void* results_buf = (void*) results;
+    hg_size_t results_size = (hg_size_t)num_files * sizeof(*results);
+    hg_return_t hret = margo_bulk_create(client_rpc_context->mid,
+                                         1, &results_buf, &results_size,
+                                         HG_BULK_READWRITE, &in.bulk_results);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return UNIFYFS_ERROR_MARGO;
+    }
+
+    /* fill input struct */
+    in.app_id    = (int32_t) unifyfs_app_id;
+    in.client_id = (int32_t) unifyfs_client_id;
+    in.num_files = (int32_t) num_files;
+    in.bulk_size = results_size;
+
+    /* call rpc function */
+    LOGDBG("invoking the stat-many rpc function in client");
+    hret = margo_forward(handle, &in);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_forward() failed");
+        margo_bulk_free(in.bulk_results);
+        margo_destroy(handle);
+        return UNIFYFS_ERROR_MARGO;
+    }
+
+    /* decode response */
+    int ret;
+    unifyfs_stat_many_out_t out;
+    hret = margo_get_output(handle, &out);
+    if (hret == HG_SUCCESS) {
+        LOGDBG("Got response ret=%" PRIi32, out.ret);
+        ret = (int) out.ret;
+        margo_free_output(handle, &out);
+    } else {
+        LOGERR("margo_get_output() failed");
+        ret = UNIFYFS_ERROR_MARGO;
+    }
+
+    /* the server has pushed the results before responding */
+    margo_bulk_free(in.bulk_results);
+
+    /* free resources */
+    margo_destroy(handle);
+
+    return ret;
+}
+
+/* invokes the client extent map rpc function, which fills ranges with
+ * up to max_ranges written ranges of the file at or after offset */
+int invoke_client_extent_map_rpc(int64_t gfid, size_t offset,
+                                 int max_ranges, unifyfs_extent_t* ranges,
+                                 int* num_ranges)
+{
+    /* check that we have initialized margo */
+    if (NULL == client_rpc_context) {
+        return UNIFYFS_FAILURE;
+    }
+
+    *num_ranges = 0;
+    if (max_ranges <= 0) {
+        return EINVAL;
+    }
+
+    /* get handle to rpc function */
+    hg_handle_t handle =
+        create_handle(client_rpc_context->rpcs.extent_map_id);
+
+    /* initialize bulk handle for ranges, which the server writes */
+    unifyfs_extent_map_in_t in;
+    void* ranges_buf = (void*) ranges;
+    hg_size_t ranges_size = (hg_size_t)max_ranges * sizeof(*ranges);
+    hg_return_t hret = margo_bulk_create(client_rpc_context->mid,
+                                         1, &ranges_buf, &ranges_size,
+                                         HG_BULK_WRITE_ONLY, &in.bulk_ranges);
+    if (hret != HG_SUCCESS) {
+        margo_destroy(handle);
+        return UNIFYFS_ERROR_MARGO;
+    }
+
+    /* fill input struct */
+    in.app_id     = (int32_t) unifyfs_app_id;
+    in.client_id  = (int32_t) unifyfs_client_id;
+    in.gfid       = gfid;
+    in.offset     = (hg_size_t) offset;
+    in.max_ranges = (int32_t) max_ranges;
+    in.bulk_size  = ranges_size;
+
+    /* call rpc function */
+    LOGDBG("invoking the extent map rpc function in client");
+    hret = margo_forward(handle, &in);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_forward() failed");
+        margo_bulk_free(in.bulk_ranges);
+        margo_destroy(handle);
+        return UNIFYFS_ERROR_MARGO;
+    }
+
+    /* decode response */
+    int ret;
+    unifyfs_extent_map_out_t out;
+    hret = margo_get_output(handle, &out);
+    if (hret == HG_SUCCESS) {
+        LOGDBG("Got response ret=%" PRIi32 " num_ranges=%" PRIi32,
+               out.ret, out.num_ranges);
+        ret = (int) out.ret;
+        if (ret == UNIFYFS_SUCCESS) {
+            *num_ranges = (int) out.num_ranges;
+        }
+        margo_free_output(handle, &out);
+    } else {
+        LOGERR("margo_get_output() failed");
+        ret = UNIFYFS_ERROR_MARGO;
+    }
+
+    /* the server has pushed the ranges before responding */
+    margo_bulk_free(in.bulk_ranges);
+
+    /* free resources */
+    margo_destroy(handle);
+
+    return ret;
+}
+
+/* invokes the client stats rpc function, which returns the performance
+ * statistics of the server as a JSON string in *json (caller frees) */
+int invoke_client_stats_rpc(char** json)
+{
+    /* check that we have initialized margo */
+    if (NULL == client_rpc_context) {
+        return UNIFYFS_FAILURE;
+    }
+
+    *json = NULL;
+
+    /* start with a buffer that should fit, and retry with the size
+     * reported by the server if it does not */
+    hg_size_t buf_size = UNIFYFS_CLIENT_STATS_BUFSIZE;
+    int ret = UNIFYFS_SUCCESS;
+    while (NULL == *json) {
+        char* buf = malloc(buf_size);
+        if (NULL == buf) {
+            return ENOMEM;
+        }
+
+        /* get handle to rpc function */
+        hg_handle_t handle = create_handle(client_rpc_context->rpcs.stats_id);
+
+        /* initialize bulk handle for the string, which the server writes */
+        unifyfs_stats_in_t in;
+        void* bulk_buf = (void*) buf;
+        hg_return_t hret = margo_bulk_create(client_rpc_context->mid,
+                                             1, &bulk_buf, &buf_size,
+                                             HG_BULK_WRITE_ONLY,
+                                             &in.bulk_json);
+        if (hret != HG_SUCCESS) {
+            free(buf);
+            margo_destroy(handle);
+            return UNIFYFS_ERROR_MARGO;
+        }
+
+        /* fill input struct */
+        in.app_id    = (int32_t) unifyfs_app_id;
+        in.client_id = (int32_t) unifyfs_client_id;
+        in.bulk_size = buf_size;
+
+        /* call rpc function */
+        LOGDBG("invoking the stats rpc function in client");
+        hret = margo_forward(handle, &in);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_forward() failed");
+            ret = UNIFYFS_ERROR_MARGO;
+        } else {
+            /* decode response */
+            unifyfs_stats_out_t out;
+            hret = margo_get_output(handle, &out);
+            if (hret == HG_SUCCESS) {
+                LOGDBG("Got response ret=%" PRIi32 " json_size=%zu",
+                       out.ret, (size_t) out.json_size);
+                ret = (int) out.ret;
+                if ((ret == UNIFYFS_SUCCESS) &&
+                    (out.json_size < buf_size)) {
+                    *json = buf;
+                    buf = NULL;
+                } else if (ret == UNIFYFS_SUCCESS) {
+                    /* too small, retry with room for the string */
+                    buf_size = out.json_size + 1;
+                }
+                margo_free_output(handle, &out);
+            } else {
+                LOGERR("margo_get_output() failed");
+                ret = UNIFYFS_ERROR_MARGO;
+            }
+        }
+
+        /* the server has pushed the string before responding */
+        margo_bulk_free(in.bulk_json);
+        margo_destroy(handle);
+        free(buf);
+
+        if (ret != UNIFYFS_SUCCESS) {
+            break;
+        }
+    }
+
+    return ret;
+}
+
 /* invokes the client truncate rpc function */
-int invoke_client_truncate_rpc(int gfid, size_t filesize)
+int invoke_client_truncate_rpc(int64_t gfid, size_t filesize)
 {
     /* check that we have initialized margo */
     if (NULL == client_rpc_context) {
         return UNIFYFS_FAILURE;
     }
 
+    /* try the shared-memory request queue first */
+    unifyfs_shm_reqq_args_t args;
+    memset(&args, 0, sizeof(args));
+    args.gfid = gfid;
+    args.size = (uint64_t) filesize;
+    int qret = client_shm_queue_request(UNIFYFS_CLIENT_RPC_TRUNCATE, &args,
+                                        NULL, 0, NULL, NULL);
+    if (qret != EAGAIN) {
+        return qret;
+    }
+
     /* get handle to rpc function */
     hg_handle_t handle = create_handle(client_rpc_context->rpcs.truncate_id);
 
@@ -522,7 +873,7 @@ int invoke_client_truncate_rpc(int gfid, size_t filesize)
     unifyfs_truncate_in_t in;
     in.app_id    = (int32_t) unifyfs_app_id;
     in.client_id = (int32_t) unifyfs_client_id;
-    in.gfid      = (int32_t) gfid;
+    in.gfid      = gfid;
     in.filesize  = (hg_size_t) filesize;
 
     /* call rpc function */
@@ -554,13 +905,23 @@ int invoke_client_truncate_rpc(int gfid, size_t filesize)
 }
 
 /* invokes the client unlink rpc function */
-int invoke_client_unlink_rpc(int gfid)
+int invoke_client_unlink_rpc(int64_t gfid)
 {
     /* check that we have initialized margo */
     if (NULL == client_rpc_context) {
         return UNIFYFS_FAILURE;
     }
 
+    /* try the shared-memory request queue first */
+    unifyfs_shm_reqq_args_t args;
+    memset(&args, 0, sizeof(args));
+    args.gfid = gfid;
+    int qret = client_shm_queue_request(UNIFYFS_CLIENT_RPC_UNLINK, &args,
+                                        NULL, 0, NULL, NULL);
+    if (qret != EAGAIN) {
+        return qret;
+    }
+
     /* get handle to rpc function */
     hg_handle_t handle = create_handle(client_rpc_context->rpcs.unlink_id);
 
@@ -568,7 +929,7 @@ int invoke_client_unlink_rpc(int gfid)
     unifyfs_unlink_in_t in;
     in.app_id    = (int32_t) unifyfs_app_id;
     in.client_id = (int32_t) unifyfs_client_id;
-    in.gfid      = (int32_t) gfid;
+    in.gfid      = gfid;
 
     /* call rpc function */
     LOGDBG("invoking the unlink rpc function in client");
@@ -599,13 +960,23 @@ int invoke_client_unlink_rpc(int gfid)
 }
 
 /* invokes the client-to-server laminate rpc function */
-int invoke_client_laminate_rpc(int gfid)
+int invoke_client_laminate_rpc(int64_t gfid)
 {
     /* check that we have initialized margo */
     if (NULL == client_rpc_context) {
         return UNIFYFS_FAILURE;
     }
 
+    /* try the shared-memory request queue first */
+    unifyfs_shm_reqq_args_t args;
+    memset(&args, 0, sizeof(args));
+    args.gfid = gfid;
+    int qret = client_shm_queue_request(UNIFYFS_CLIENT_RPC_LAMINATE, &args,
+                                        NULL, 0, NULL, NULL);
+    if (qret != EAGAIN) {
+        return qret;
+    }
+
     /* get handle to rpc function */
     hg_handle_t handle = create_handle(client_rpc_context->rpcs.laminate_id);
 
@@ -613,7 +984,7 @@ int invoke_client_laminate_rpc(int gfid)
     unifyfs_laminate_in_t in;
     in.app_id    = (int32_t) unifyfs_app_id;
     in.client_id = (int32_t) unifyfs_client_id;
-    in.gfid      = (int32_t) gfid;
+    in.gfid      = gfid;
 
     /* call rpc function */
     LOGDBG("invoking the laminate rpc function in client");
@@ -643,14 +1014,72 @@ int invoke_client_laminate_rpc(int gfid)
     return ret;
 }
 
+/* invokes the client-to-server transfer rpc function */
+int invoke_client_transfer_rpc(int64_t gfid, const char* dst_file)
+{
+    /* check that we have initialized margo */
+    if (NULL == client_rpc_context) {
+        return UNIFYFS_FAILURE;
+    }
+
+    /* get handle to rpc function */
+    hg_handle_t handle = create_handle(client_rpc_context->rpcs.transfer_id);
+
+    /* fill in input struct */
+    unifyfs_transfer_in_t in;
+    in.app_id    = (int32_t) unifyfs_app_id;
+    in.client_id = (int32_t) unifyfs_client_id;
+    in.gfid      = gfid;
+    in.dst_file  = dst_file;
+
+    /* call rpc function */
+    LOGDBG("invoking the transfer rpc function in client");
+    hg_return_t hret = margo_forward(handle, &in);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_forward() failed");
+        margo_destroy(handle);
+        return UNIFYFS_ERROR_MARGO;
+    }
+
+    /* decode response */
+    int ret;
+    unifyfs_transfer_out_t out;
+    hret = margo_get_output(handle, &out);
+    if (hret == HG_SUCCESS) {
+        LOGDBG("Got response ret=%" PRIi32, out.ret);
+        ret = (int) out.ret;
+        margo_free_output(handle, &out);
+    } else {
+        LOGERR("margo_get_output() failed");
+        ret = UNIFYFS_ERROR_MARGO;
+    }
+
+    /* free resources */
+    margo_destroy(handle);
+
+    return ret;
+}
+
 /* invokes the client sync rpc function */
-int invoke_client_sync_rpc(int gfid)
+int invoke_client_sync_rpc(int64_t gfid,
+                           const unifyfs_trace_ctx_t* trace)
 {
     /* check that we have initialized margo */
     if (NULL == client_rpc_context) {
         return UNIFYFS_FAILURE;
     }
 
+    /* try the shared-memory request queue first */
+    unifyfs_shm_reqq_args_t args;
+    memset(&args, 0, sizeof(args));
+    args.gfid = gfid;
+    args.trace_id = trace->id;
+    int qret = client_shm_queue_request(UNIFYFS_CLIENT_RPC_SYNC, &args,
+                                        NULL, 0, NULL, NULL);
+    if (qret != EAGAIN) {
+        return qret;
+    }
+
     /* get handle to rpc function */
     hg_handle_t handle = create_handle(client_rpc_context->rpcs.fsync_id);
 
@@ -658,7 +1087,8 @@ int invoke_client_sync_rpc(int gfid)
     unifyfs_fsync_in_t in;
     in.app_id    = (int32_t) unifyfs_app_id;
     in.client_id = (int32_t) unifyfs_client_id;
-    in.gfid      = (int32_t) gfid;
+    in.gfid      = gfid;
+    in.trace     = *trace;
 
     /* call rpc function */
     LOGINFO("invoking the sync rpc function in client");
@@ -690,13 +1120,28 @@ int invoke_client_sync_rpc(int gfid)
 
 /* invokes the client mread rpc function */
 int invoke_client_mread_rpc(unsigned int reqid, int read_count,
-                            size_t extents_size, void* extents_buffer)
+                            size_t extents_size, void* extents_buffer,
+                            const unifyfs_trace_ctx_t* trace)
 {
     /* check that we have initialized margo */
     if (NULL == client_rpc_context) {
         return UNIFYFS_FAILURE;
     }
 
+    /* try the shared-memory request queue first, which takes
+     * the extents if they fit in a queue slot */
+    unifyfs_shm_reqq_args_t args;
+    memset(&args, 0, sizeof(args));
+    args.mread_id   = (int32_t) reqid;
+    args.read_count = (int32_t) read_count;
+    args.trace_id   = trace->id;
+    int qret = client_shm_queue_request(UNIFYFS_CLIENT_RPC_READ, &args,
+                                        extents_buffer, extents_size,
+                                        NULL, NULL);
+    if (qret != EAGAIN) {
+        return qret;
+    }
+
     /* get handle to rpc function */
     hg_handle_t handle = create_handle(client_rpc_context->rpcs.mread_id);
 
@@ -714,6 +1159,7 @@ int invoke_client_mread_rpc(unsigned int reqid, int read_count,
     in.app_id     = (int32_t) unifyfs_app_id;
     in.client_id  = (int32_t) unifyfs_client_id;
     in.read_count = (int32_t) read_count;
+    in.trace      = *trace;
     in.bulk_size  = (hg_size_t) extents_size;
 
     /* call rpc function */
@@ -807,6 +1253,7 @@ static void unifyfs_mread_req_data_rpc(hg_handle_t handle)
                          * maximum transfer size that the underlying transport
                          * supports, and a large bulk transfer may result in
                          * failure. */
+                        uint64_t pull_start = unifyfs_stats_now_ns();
                         int i = 0;
                         hg_size_t remain = in.bulk_size;
                         do {
@@ -830,6 +1277,8 @@ static void unifyfs_mread_req_data_rpc(hg_handle_t handle)
                         } while (remain > 0);
 
                         if (hret == HG_SUCCESS) {
+                            unifyfs_trace_span(&(mread->trace),
+                                UNIFYFS_TRACE_CLIENT_DATA_PULL, pull_start);
                             ABT_mutex_lock(mread->sync);
                             update_read_req_coverage(rdreq, data_offset,
                                                      data_size);
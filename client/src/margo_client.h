@@ -29,10 +29,15 @@ typedef struct ClientRpcIds {
     hg_id_t unmount_id;
     hg_id_t metaset_id;
     hg_id_t metaget_id;
+    hg_id_t extent_map_id;
     hg_id_t filesize_id;
+    hg_id_t stat_id;
+    hg_id_t stat_many_id;
+    hg_id_t stats_id;
     hg_id_t truncate_id;
     hg_id_t unlink_id;
     hg_id_t laminate_id;
+    hg_id_t transfer_id;
     hg_id_t fsync_id;
     hg_id_t mread_id;
     hg_id_t mread_req_data_id;
@@ -65,19 +70,35 @@ int invoke_client_unmount_rpc(void);
 int invoke_client_metaset_rpc(unifyfs_file_attr_op_e attr_op,
                               unifyfs_file_attr_t* f_meta);
 
-int invoke_client_metaget_rpc(int gfid, unifyfs_file_attr_t* f_meta);
+int invoke_client_metaget_rpc(int64_t gfid, unifyfs_file_attr_t* f_meta);
 
-int invoke_client_filesize_rpc(int gfid, size_t* filesize);
+int invoke_client_extent_map_rpc(int64_t gfid, size_t offset,
+                                 int max_ranges, unifyfs_extent_t* ranges,
+                                 int* num_ranges);
 
-int invoke_client_truncate_rpc(int gfid, size_t filesize);
+int invoke_client_filesize_rpc(int64_t gfid, size_t* filesize);
 
-int invoke_client_unlink_rpc(int gfid);
+int invoke_client_stat_rpc(int64_t gfid, unifyfs_file_attr_t* f_meta,
+                           int* cacheable);
 
-int invoke_client_laminate_rpc(int gfid);
+int invoke_client_stat_many_rpc(int num_files,
+                                unifyfs_stat_result_t* results);
 
-int invoke_client_sync_rpc(int gfid);
+int invoke_client_stats_rpc(char** json);
+
+int invoke_client_truncate_rpc(int64_t gfid, size_t filesize);
+
+int invoke_client_unlink_rpc(int64_t gfid);
+
+int invoke_client_laminate_rpc(int64_t gfid);
+
+int invoke_client_transfer_rpc(int64_t gfid, const char* dst_file);
+
+int invoke_client_sync_rpc(int64_t gfid,
+                           const unifyfs_trace_ctx_t* trace);
 
 int invoke_client_mread_rpc(unsigned int reqid, int read_count,
-                            size_t extents_size, void* extents_buffer);
+                            size_t extents_size, void* extents_buffer,
+                            const unifyfs_trace_ctx_t* trace);
 
 #endif // MARGO_CLIENT_H
@@ -19,7 +19,9 @@
 static inline unifyfs_dirstream_t* unifyfs_dirstream_alloc(int fid)
 {
     /* allocate a file descriptor for this stream */
+    unifyfs_stack_lock();
     int fd = unifyfs_stack_pop(unifyfs_fd_stack);
+    unifyfs_stack_unlock();
     if (fd < 0) {
         /* exhausted our file descriptors */
         errno = EMFILE;
@@ -27,11 +29,15 @@ static inline unifyfs_dirstream_t* unifyfs_dirstream_alloc(int fid)
     }
 
     /* allocate a directory stream id */
+    unifyfs_stack_lock();
     int dirid = unifyfs_stack_pop(unifyfs_dirstream_stack);
+    unifyfs_stack_unlock();
     if (dirid < 0) {
         /* exhausted our directory streams,
          * return our file descriptor and set errno */
+        unifyfs_stack_lock();
         unifyfs_stack_push(unifyfs_fd_stack, fd);
+        unifyfs_stack_unlock();
         errno = EMFILE;
         return NULL;
     }
@@ -72,14 +78,18 @@ static inline int unifyfs_dirstream_free(unifyfs_dirstream_t* dirp)
     unifyfs_fd_init(dirp->fd);
 
     /* return file descriptor to the free stack */
+    unifyfs_stack_lock();
     unifyfs_stack_push(unifyfs_fd_stack, dirp->fd);
+    unifyfs_stack_unlock();
 
     /* reinit dir stream to indicate that it's no longer in use,
      * not really necessary, but should help find bugs */
     unifyfs_dirstream_init(dirp->dirid);
 
     /* return our index to directory stream stack */
+    unifyfs_stack_lock();
     unifyfs_stack_push(unifyfs_dirstream_stack, dirp->dirid);
+    unifyfs_stack_unlock();
 
     return UNIFYFS_SUCCESS;
 }
@@ -100,7 +110,7 @@ DIR* UNIFYFS_WRAP(opendir)(const char* name)
      */
 
     int fid  = unifyfs_get_fid_from_path(upath);
-    int gfid = unifyfs_generate_gfid(upath);
+    int64_t gfid = unifyfs_generate_gfid(upath);
 
     unifyfs_file_attr_t gfattr = { 0, };
     int ret = unifyfs_get_global_file_meta(gfid, &gfattr);
@@ -44,19 +44,20 @@
 #include "unifyfs-fixed.h"
 #include "unifyfs_log.h"
 #include "margo_client.h"
+#include "unifyfs_trace.h"
 #include "seg_tree.h"
 
 /* ---------------------------------------
  * Operations on client write index
  * --------------------------------------- */
 
-/*
- * Clear all entries in the log index.  This only clears the metadata,
- * not the data itself.
- */
-static void clear_index(void)
+/* Return number of published index entries not yet consumed by server */
+static inline uint64_t index_ring_pending(void)
 {
-    *unifyfs_indices.ptr_num_entries = 0;
+    unifyfs_index_ring_t* ring = unifyfs_indices.ring;
+    uint64_t head = unifyfs_index_ring_load(&ring->head);
+    uint64_t tail = unifyfs_index_ring_load(&ring->tail);
+    return (tail - head);
 }
 
 /* Add the metadata for a single write to the index */
@@ -75,16 +76,19 @@ static int add_write_meta_to_index(unifyfs_filemeta_t* meta,
     }
 
     /*
-     * We want to make sure this write will not overflow the maximum
-     * number of index entries we can sync with server. A write can at most
-     * create two new nodes in the seg_tree. If we're close to potentially
-     * filling up the index, sync it out.
+     * The index ring is used as a double buffer: once the extents of this
+     * file would fill half of the ring, publish them so the server can
+     * consume them in the background while we keep writing into the other
+     * half. A write can at most create two new nodes in the seg_tree.
      */
     unsigned long count_before = seg_tree_count(&meta->extents_sync);
-    if (count_before >= (unifyfs_max_index_entries - 2)) {
-        /* this will flush our segments, sync them, and set the running
-         * segment count back to 0 */
-        unifyfs_sync_extents(meta->fid);
+    if ((count_before + 2) >= (unifyfs_max_index_entries / 2)) {
+        int rc = unifyfs_publish_index_from_seg_tree(meta);
+        if (rc != UNIFYFS_SUCCESS) {
+            LOGERR("failed to publish write index for gfid=%" PRId64,
+                   meta->attrs.gfid);
+            return rc;
+        }
     }
 
     /* store the write in our segment tree used for syncing with server. */
@@ -97,56 +101,107 @@ static int add_write_meta_to_index(unifyfs_filemeta_t* meta,
 }
 
 /*
- * Remove all entries in the current index and re-write it using the write
- * metadata stored in the target file's extents_sync segment tree. This only
- * re-writes the metadata in the index. All the actual data is still kept
- * in the write log and will be referenced correctly by the new metadata.
- *
- * After this function is done, 'unifyfs_indices' will have been totally
- * re-written. The writes in the index will be flattened, non-overlapping,
+ * Append the write metadata stored in the target file's extents_sync
+ * segment tree to the index ring, and publish it to the server by
+ * advancing the ring tail. This only copies the metadata. All the actual
+ * data is still kept in the write log and will be referenced correctly by
+ * the new metadata. The published writes are flattened, non-overlapping,
  * and sequential. The extents_sync segment tree will be cleared.
  *
- * This function is called when we sync our extents with the server.
+ * If the ring does not have room for the extents, we first ask the server
+ * to consume all published entries with a sync rpc.
+ *
+ * This function is called when we sync our extents with the server, or
+ * when a file has accumulated enough extents to fill half the ring.
  *
- * Returns maximum write log offset for synced extents.
+ * Returns UNIFYFS_SUCCESS, or error code.
  */
-off_t unifyfs_rewrite_index_from_seg_tree(unifyfs_filemeta_t* meta)
+static int publish_index(unifyfs_filemeta_t* meta)
 {
-    /* get pointer to index buffer */
+    int rc = UNIFYFS_SUCCESS;
+    int64_t gfid = meta->attrs.gfid;
+    unifyfs_index_ring_t* ring = unifyfs_indices.ring;
     unifyfs_index_t* indexes = unifyfs_indices.index_entry;
+    uint64_t n_slots = (uint64_t) unifyfs_max_index_entries;
+
+    seg_tree_rdlock(&meta->extents_sync);
+
+    uint64_t count = (uint64_t) meta->extents_sync.count;
+    if (0 == count) {
+        seg_tree_unlock(&meta->extents_sync);
+        return UNIFYFS_SUCCESS;
+    }
 
-    /* Erase the index before we re-write it */
-    clear_index();
+    /* wait for the server to drain the ring if there is not enough
+     * free space, this is the only case where a writer stalls */
+    if ((n_slots - index_ring_pending()) < count) {
+        LOGDBG("index ring full, waiting on server (gfid=%" PRId64 ")", gfid);
+        unifyfs_trace_ctx_t untraced = { 0 };
+        rc = invoke_client_sync_rpc(gfid, &untraced);
+        if (rc != UNIFYFS_SUCCESS) {
+            LOGERR("failed to drain write index ring for gfid=%" PRId64, gfid);
+            seg_tree_unlock(&meta->extents_sync);
+            return rc;
+        }
+    }
 
-    /* count up number of entries we wrote to buffer */
-    unsigned long idx = 0;
+    /* only we update the tail, under index_ring_sync,
+     * so no need for atomic load */
+    uint64_t tail = ring->tail;
 
     /* record maximum write log offset */
     off_t max_log_offset = 0;
 
-    int gfid = meta->attrs.gfid;
-
-    seg_tree_rdlock(&meta->extents_sync);
     /* For each write in this file's seg_tree ... */
     struct seg_tree_node* node = NULL;
     while ((node = seg_tree_iter(&meta->extents_sync, node))) {
-        indexes[idx].file_pos = node->start;
-        indexes[idx].log_pos  = node->ptr;
-        indexes[idx].length   = node->end - node->start + 1;
-        indexes[idx].gfid     = gfid;
-        idx++;
-        if ((off_t)(node->end) > max_log_offset) {
-            max_log_offset = (off_t) node->end;
+        unifyfs_index_t* idx = &indexes[tail % n_slots];
+        idx->file_pos = node->start;
+        idx->log_pos  = node->ptr;
+        idx->length   = node->end - node->start + 1;
+        idx->gfid     = gfid;
+        tail++;
+
+        off_t log_end = (off_t)(node->ptr + (node->end - node->start));
+        if (log_end > max_log_offset) {
+            max_log_offset = log_end;
         }
     }
     seg_tree_unlock(&meta->extents_sync);
+
+    /* ensure any data written to the spillover file is flushed
+     * before the server can see extents that reference it */
+    off_t logio_shmem_size;
+    unifyfs_logio_get_sizes(logio_ctx, &logio_shmem_size, NULL);
+    if (max_log_offset >= logio_shmem_size) {
+        /* some extents range into spill over area,
+         * so flush data to spill over file */
+        rc = unifyfs_logio_sync(logio_ctx);
+        if (UNIFYFS_SUCCESS != rc) {
+            LOGERR("failed to sync logio data");
+        }
+        LOGDBG("after logio spill sync");
+    }
+
+    /* make the new entries visible to the server */
+    unifyfs_index_ring_store(&ring->tail, tail);
+
     /* All done processing this files writes.  Clear its seg_tree */
     seg_tree_clear(&meta->extents_sync);
 
-    /* record total number of entries in index buffer */
-    *unifyfs_indices.ptr_num_entries = idx;
+    return rc;
+}
 
-    return max_log_offset;
+/* serializes publishers of the index ring, which may be application
+ * threads and background transfers writing to different files */
+static pthread_mutex_t index_ring_sync = PTHREAD_MUTEX_INITIALIZER;
+
+int unifyfs_publish_index_from_seg_tree(unifyfs_filemeta_t* meta)
+{
+    pthread_mutex_lock(&index_ring_sync);
+    int rc = publish_index(meta);
+    pthread_mutex_unlock(&index_ring_sync);
+    return rc;
 }
 
 /*
@@ -205,47 +260,45 @@ int unifyfs_sync_extents(int target_fid)
             return UNIFYFS_FAILURE;
         }
 
+        /* write out small writes held in a write-combining buffer */
+        tmp_rc = unifyfs_fid_flush_write_buffers(fid);
+        if (UNIFYFS_SUCCESS != tmp_rc) {
+            return tmp_rc;
+        }
+
         /* sync with server if we need to */
         if (meta->needs_sync) {
-            /* write contents from segment tree to index buffer */
-            off_t max_log_off = unifyfs_rewrite_index_from_seg_tree(meta);
-
-            /* if there are no index entries, we've got nothing to sync */
-            if (*unifyfs_indices.ptr_num_entries == 0) {
-                /* consider that we've sync'd successfully */
-                meta->needs_sync = 0;
-                return UNIFYFS_SUCCESS;
+            uint64_t sync_start = unifyfs_stats_now_ns();
+            unifyfs_trace_ctx_t trace;
+            unifyfs_trace_begin(&trace);
+
+            /* publish contents from segment tree to index ring */
+            tmp_rc = unifyfs_publish_index_from_seg_tree(meta);
+            if (UNIFYFS_SUCCESS != tmp_rc) {
+                LOGERR("failed to publish write index for gfid=%" PRId64,
+                       meta->attrs.gfid);
+                return tmp_rc;
             }
 
-            /* ensure any data written to the spillover file is flushed */
-            off_t logio_shmem_size;
-            unifyfs_logio_get_sizes(logio_ctx, &logio_shmem_size, NULL);
-            if (max_log_off >= logio_shmem_size) {
-                /* some extents range into spill over area,
-                 * so flush data to spill over file */
-                tmp_rc = unifyfs_logio_sync(logio_ctx);
+            /* the server may have already consumed everything we
+             * published in the background, otherwise tell the server to
+             * consume up to our tail, which it acknowledges by replying */
+            if (index_ring_pending() > 0) {
+                uint64_t rpc_start = unifyfs_stats_now_ns();
+                tmp_rc = invoke_client_sync_rpc(meta->attrs.gfid, &trace);
+                unifyfs_trace_span(&trace, UNIFYFS_TRACE_CLIENT_SYNC_RPC,
+                                   rpc_start);
                 if (UNIFYFS_SUCCESS != tmp_rc) {
-                    LOGERR("failed to sync logio data");
+                    /* something went wrong when trying to flush extents */
+                    LOGERR("failed to flush write index to server for "
+                           "gfid=%" PRId64, meta->attrs.gfid);
                     ret = tmp_rc;
                 }
-                LOGDBG("after logio spill sync");
-            }
-
-            /* tell the server to grab our new extents */
-            tmp_rc = invoke_client_sync_rpc(meta->attrs.gfid);
-            if (UNIFYFS_SUCCESS != tmp_rc) {
-                /* something went wrong when trying to flush extents */
-                LOGERR("failed to flush write index to server for gfid=%d",
-                       meta->attrs.gfid);
-                ret = tmp_rc;
             }
 
             /* we've sync'd, so mark this file as being up-to-date */
             meta->needs_sync = 0;
-
-            /* flushed, clear buffer and refresh number of entries
-             * and number remaining */
-            clear_index();
+            unifyfs_trace_span(&trace, UNIFYFS_TRACE_CLIENT_SYNC, sync_start);
         }
 
         return ret;
@@ -45,8 +45,8 @@
 
 #include "unifyfs-internal.h"
 
-/* rewrite client's shared memory index of file write extents */
-off_t unifyfs_rewrite_index_from_seg_tree(unifyfs_filemeta_t* meta);
+/* publish file write extents to client's shared memory index ring */
+int unifyfs_publish_index_from_seg_tree(unifyfs_filemeta_t* meta);
 
 /* remove/truncate write extents in client metadata */
 int truncate_write_meta(unifyfs_filemeta_t* meta, off_t trunc_sz);
@@ -222,6 +222,12 @@ typedef struct {
     int   read;  /* whether file is opened for read */
     int   write; /* whether file is opened for write */
     int   append; /* whether file is opened for append */
+
+    /* write-combining buffer, holding a run of small contiguous writes
+     * that have not yet been written to the log */
+    char*  wbuf;     /* buffer (allocated on first use) */
+    off_t  wbuf_pos; /* file offset of buffered data */
+    size_t wbuf_len; /* number of bytes buffered */
 } unifyfs_fd_t;
 
 enum unifyfs_stream_orientation {
@@ -246,6 +252,7 @@ typedef struct {
     off_t  bufpos;   /* byte offset in file corresponding to start of buffer */
     size_t buflen;   /* number of bytes active in buffer */
     size_t bufdirty; /* whether data in buffer needs to be flushed */
+    int    needs_sync; /* whether data written by stream needs sync */
 
     unsigned char* ubuf; /* ungetc buffer (we store bytes from end) */
     size_t ubufsize;     /* size of ungetc buffer in bytes */
@@ -282,6 +289,7 @@ typedef struct {
     enum flock_enum flock_status; /* file lock status */
 
     int needs_sync;               /* have unsynced writes */
+    int wbuf_fd;                  /* fd buffering writes to file, or -1 */
     struct seg_tree extents_sync; /* Segment tree containing our coalesced
                                    * writes between sync operations */
     struct seg_tree extents;      /* Segment tree of all local data extents */
@@ -305,7 +313,7 @@ typedef struct {
  * at offset with given length. */
 typedef struct {
     /* The read request parameters */
-    int gfid;             /* global id of file to be read */
+    int64_t gfid;         /* global id of file to be read */
     size_t offset;        /* logical file offset */
     size_t length;        /* requested number of bytes */
     char* buf;            /* user buffer to place data */
@@ -332,8 +340,8 @@ typedef struct {
 } read_req_t;
 
 typedef struct {
-    size_t* ptr_num_entries;
-    unifyfs_index_t* index_entry;
+    unifyfs_index_ring_t* ring;   /* ring header in superblock */
+    unifyfs_index_t* index_entry; /* ring slots */
 } unifyfs_index_buf_t;
 
 
@@ -402,6 +410,10 @@ extern pthread_mutex_t unifyfs_stack_mutex;
 
 extern int    unifyfs_max_files;  /* maximum number of files to store */
 extern bool   unifyfs_local_extents;  /* enable tracking of local extents */
+extern size_t unifyfs_stream_bufsize; /* default stdio stream buffer size */
+extern int    unifyfs_transfer_depth;   /* buffers per file transfer */
+extern int    unifyfs_transfer_threads; /* concurrent file transfers */
+extern bool   unifyfs_transfer_server;  /* stage out from server logs */
 
 /* -------------------------------
  * Common functions
@@ -426,6 +438,15 @@ int unifyfs_stack_lock(void);
 
 int unifyfs_stack_unlock(void);
 
+/* Lock and unlock the client library state that threads share: the file
+ * table and its indexes, file storage and write buffers, and outstanding
+ * reads. The unifyfs_fid_*() functions that use this state take the lock
+ * themselves, so application threads and background transfer workers
+ * take turns. The lock is recursive. */
+int unifyfs_client_lock(void);
+
+int unifyfs_client_unlock(void);
+
 /* sets flag if the path should be intercept as a unifyfs path,
  * and if so, writes normalized path in upath, which should
  * be a buffer of size UNIFYFS_MAX_FILENAME */
@@ -477,11 +498,11 @@ int unifyfs_fd_is_laminated(int fd);
 const char* unifyfs_path_from_fid(int fid);
 
 /* Given a fid, return a gfid */
-int unifyfs_gfid_from_fid(const int fid);
+int64_t unifyfs_gfid_from_fid(const int fid);
 
 /* returns fid for corresponding gfid, if one is active,
  * returns -1 otherwise */
-int unifyfs_fid_from_gfid(const int gfid);
+int unifyfs_fid_from_gfid(const int64_t gfid);
 
 /* checks to see if fid is a directory
  * returns 1 for yes
@@ -496,13 +517,17 @@ int unifyfs_fid_is_dir(int fid);
  * returns 0 for no */
 int unifyfs_fid_is_dir_empty(const char* path);
 
+/* Get global metadata (without the filename) with current size for the
+ * given gfid, from the client metadata cache if the server allows */
+int unifyfs_gfid_stat(int64_t gfid, unifyfs_file_attr_t* attr);
+
 /* Return current global size of given file id */
 off_t unifyfs_fid_global_size(int fid);
 
 /* if we have a local fid structure corresponding to the gfid
  * in question, we attempt the file lookup with the fid method
  * otherwise call back to the rpc */
-off_t unifyfs_gfid_filesize(int gfid);
+off_t unifyfs_gfid_filesize(int64_t gfid);
 
 /*
  * Return current size of given file id.  If the file is laminated, return the
@@ -525,6 +550,9 @@ int unifyfs_fid_free(int fid);
 int unifyfs_fid_create_file(const char* path,
                             int exclusive);
 
+/* change the path of an active file id, returns success|error */
+int unifyfs_fid_rename(int fid, const char* new_path);
+
 /* add a new directory and initialize metadata
  * returns the new fid, or a negative value on error */
 int unifyfs_fid_create_directory(const char* path);
@@ -538,6 +566,22 @@ int unifyfs_fid_write(
     size_t* nwritten /* returns number of bytes written */
 );
 
+/* write count bytes from buf into file open on fd starting at offset
+ * pos, small writes may be held in the write-combining buffer of fd */
+int unifyfs_fd_write_combine(
+    int fd,          /* file descriptor to write to */
+    off_t pos,       /* starting offset within file */
+    const void* buf, /* buffer of data to be written */
+    size_t count,    /* number of bytes to write */
+    size_t* nwritten /* returns number of bytes written */
+);
+
+/* write data held in the write-combining buffer of fd to the log */
+int unifyfs_fd_flush_write_buffer(int fd);
+
+/* write data held in a write-combining buffer for file id to the log */
+int unifyfs_fid_flush_write_buffers(int fid);
+
 /* truncate file id to given length, frees resources if length is
  * less than size and allocates and zero-fills new bytes if length
  * is more than size */
@@ -566,11 +610,11 @@ int unifyfs_fid_delete(int fid);
 int unifyfs_set_global_file_meta_from_fid(int fid,
                                           unifyfs_file_attr_op_e op);
 
-int unifyfs_set_global_file_meta(int gfid,
+int unifyfs_set_global_file_meta(int64_t gfid,
                                  unifyfs_file_attr_op_e op,
                                  unifyfs_file_attr_t* gfattr);
 
-int unifyfs_get_global_file_meta(int gfid,
+int unifyfs_get_global_file_meta(int64_t gfid,
                                  unifyfs_file_attr_t* gfattr);
 
 #endif /* UNIFYFS_INTERNAL_H */
@@ -336,7 +336,9 @@ static int unifyfs_fopen(
     }
 
     /* allocate a stream for this file */
+    unifyfs_stack_lock();
     int sid = unifyfs_stack_pop(unifyfs_stream_stack);
+    unifyfs_stack_unlock();
     if (sid < 0) {
         /* TODO: would like to return EMFILE to indicate
          * process has hit file stream limit, not the OS */
@@ -349,13 +351,17 @@ static int unifyfs_fopen(
     unifyfs_stream_t* s = &(unifyfs_streams[sid]);
 
     /* allocate a file descriptor for this file */
+    unifyfs_stack_lock();
     int fd = unifyfs_stack_pop(unifyfs_fd_stack);
+    unifyfs_stack_unlock();
     if (fd < 0) {
         /* TODO: would like to return EMFILE to indicate
          * process has hit file descriptor limit, not the OS */
 
         /* put back our stream id */
+        unifyfs_stack_lock();
         unifyfs_stack_push(unifyfs_stream_stack, sid);
+        unifyfs_stack_unlock();
 
         /* exhausted our file descriptors */
         return ENFILE;
@@ -391,6 +397,7 @@ static int unifyfs_fopen(
     s->bufpos   = 0;
     s->buflen   = 0;
     s->bufdirty = 0;
+    s->needs_sync = 0;
 
     /* initialize the ungetc buffer */
     s->ubuf     = NULL;
@@ -464,7 +471,42 @@ static int unifyfs_setvbuf(
     return UNIFYFS_SUCCESS;
 }
 
-/* calls unifyfs_fd_write to flush stream if it is dirty,
+/* calls unifyfs_fd_write to write out buffered data if the stream
+ * is dirty, without syncing it to the server, which is used when the
+ * stream buffer fills or is needed for a read, returns UNIFYFS error
+ * codes, sets stream error indicator and errno upon error */
+static int unifyfs_stream_write_out(unifyfs_stream_t* s)
+{
+    if (s->buf == NULL || !s->bufdirty) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    size_t nwritten = 0;
+    int write_rc = unifyfs_fd_write(s->fd, s->bufpos, s->buf, s->buflen,
+        &nwritten);
+    if (write_rc != UNIFYFS_SUCCESS) {
+        /* ERROR: set stream error indicator and errno */
+        s->err = 1;
+        errno = unifyfs_rc_errno(write_rc);
+        return write_rc;
+    }
+
+    /* TODO: treat short writes as error? */
+
+    /* note there is no need to update the file descriptor position here
+     * since we wrote to a specific offset independent of the file
+     * descriptor position */
+
+    /* data is in the file now, and the buffer still holds a valid
+     * copy of it for later reads */
+    s->bufdirty = 0;
+    s->needs_sync = 1;
+
+    return UNIFYFS_SUCCESS;
+}
+
+/* calls unifyfs_fd_write to flush stream if it is dirty, and syncs
+ * data written through the stream to the server,
  * returns UNIFYFS error codes, sets stream error indicator and errno
  * upon error */
 static int unifyfs_stream_flush(FILE* stream)
@@ -475,23 +517,14 @@ static int unifyfs_stream_flush(FILE* stream)
     /* TODO: check that stream is valid */
 
     /* if buffer is dirty, write data to file */
-    if (s->buf != NULL && s->bufdirty) {
-        size_t nwritten = 0;
-        int write_rc = unifyfs_fd_write(s->fd, s->bufpos, s->buf, s->buflen,
-            &nwritten);
-        if (write_rc != UNIFYFS_SUCCESS) {
-            /* ERROR: set stream error indicator and errno */
-            s->err = 1;
-            errno = unifyfs_rc_errno(write_rc);
-            return write_rc;
-        }
-
-        /* TODO: treat short writes as error? */
-
-        /* note there is no need to update the file descriptor position here
-         * since we wrote to a specific offset independent of the file
-         * descriptor position */
+    int write_rc = unifyfs_stream_write_out(s);
+    if (write_rc != UNIFYFS_SUCCESS) {
+        /* ERROR: write out sets error indicator and errno */
+        return write_rc;
+    }
 
+    /* if we have written data, sync it with the server */
+    if (s->needs_sync) {
         /* lookup file id from file descriptor attached to stream */
         int fid = unifyfs_get_fid_from_fd(s->fd);
         if (fid < 0) {
@@ -509,8 +542,8 @@ static int unifyfs_stream_flush(FILE* stream)
             return ret;
         }
 
-        /* indicate that buffer is now flushed */
-        s->bufdirty = 0;
+        /* indicate that written data is now synced */
+        s->needs_sync = 0;
     }
 
     return UNIFYFS_SUCCESS;
@@ -555,7 +588,7 @@ static int unifyfs_stream_read(
     /* associate buffer with stream if we need to */
     if (s->buf == NULL) {
         int setvbuf_rc = unifyfs_setvbuf(stream, NULL, s->buftype,
-                                         UNIFYFS_CLIENT_STREAM_BUFSIZE);
+                                         unifyfs_stream_bufsize);
         if (setvbuf_rc != UNIFYFS_SUCCESS) {
             /* ERROR: failed to associate buffer */
             s->err = 1;
@@ -604,9 +637,6 @@ static int unifyfs_stream_read(
         remaining -= ubuf_chars;
     }
 
-    /* TODO: if count is large enough, read directly to user's
-     * buffer and be done with it */
-
     /* read data from file into buffer */
     int eof = 0;
     while (remaining > 0 && !eof) {
@@ -616,13 +646,33 @@ static int unifyfs_stream_read(
         if (current < start || current >= start + length) {
             /* current is outside the range of our buffer */
 
-            /* flush buffer if needed before read */
-            int flush_rc = unifyfs_stream_flush(stream);
+            /* write out buffer if needed before read, the read syncs
+             * our writes to the file with the server */
+            int flush_rc = unifyfs_stream_write_out(s);
             if (flush_rc != UNIFYFS_SUCCESS) {
-                /* ERROR: flush sets error indicator and errno */
+                /* ERROR: write out sets error indicator and errno */
                 return flush_rc;
             }
 
+            /* if the rest of the read would fill the stream buffer,
+             * read directly into user's buffer to avoid the copy */
+            if (remaining >= s->bufsize) {
+                size_t nread = 0;
+                char* buf_start = (char*)buf + (count - remaining);
+                int read_rc = unifyfs_fd_read(s->fd, current, buf_start,
+                    remaining, &nread);
+                if (read_rc != UNIFYFS_SUCCESS) {
+                    /* ERROR: set error indicator and errno */
+                    s->err = 1;
+                    errno = unifyfs_rc_errno(read_rc);
+                    return EIO;
+                }
+
+                current   += nread;
+                remaining -= nread;
+                break;
+            }
+
             /* read data from file into buffer */
             size_t nread = 0;
             int read_rc = unifyfs_fd_read(s->fd, current, s->buf,
@@ -756,7 +806,7 @@ static int unifyfs_stream_write(
     /* associate buffer with stream if we need to */
     if (s->buf == NULL) {
         int setvbuf_rc = unifyfs_setvbuf(stream, NULL, s->buftype,
-                                         UNIFYFS_CLIENT_STREAM_BUFSIZE);
+                                         unifyfs_stream_bufsize);
         if (setvbuf_rc != UNIFYFS_SUCCESS) {
             /* ERROR: failed to associate buffer */
             s->err = 1;
@@ -778,6 +828,7 @@ static int unifyfs_stream_write(
         }
 
         /* TODO: treat short writes as error? */
+        s->needs_sync = 1;
 
         /* update file position */
         filedesc->pos = current + (off_t) nwritten;
@@ -785,8 +836,36 @@ static int unifyfs_stream_write(
         return UNIFYFS_SUCCESS;
     }
 
-    /* TODO: if count is large enough, write directly to file
-     * and be done with it */
+    /* if count would fill the stream buffer, write data directly from
+     * user's buffer to file after writing out what we have buffered */
+    if (s->buftype == _IOFBF && count >= s->bufsize) {
+        int flush_rc = unifyfs_stream_write_out(s);
+        if (flush_rc != UNIFYFS_SUCCESS) {
+            /* ERROR: write out sets error indicator and errno */
+            return flush_rc;
+        }
+
+        size_t nwritten = 0;
+        int write_rc = unifyfs_fd_write(s->fd, current, buf, count, &nwritten);
+        if (write_rc != UNIFYFS_SUCCESS) {
+            /* ERROR: set stream error indicator and errno */
+            s->err = 1;
+            errno = unifyfs_rc_errno(write_rc);
+            return write_rc;
+        }
+        s->needs_sync = 1;
+
+        /* buffer may hold stale data for the range we just wrote */
+        if (current < (s->bufpos + (off_t)s->buflen) &&
+            s->bufpos < (current + (off_t)nwritten)) {
+            s->buflen = 0;
+        }
+
+        /* update file position */
+        filedesc->pos = current + (off_t) nwritten;
+
+        return UNIFYFS_SUCCESS;
+    }
 
     /* write data from buffer to file */
     size_t remaining = count;
@@ -847,12 +926,12 @@ static int unifyfs_stream_write(
             s->buflen += bytes;
         }
 
-        /* if we've filled the buffer, flush it */
+        /* if we've filled the buffer or ended a line, write it out,
+         * the data is synced with the server on fflush or fclose */
         if (need_flush) {
-            /* flush stream */
-            int flush_rc = unifyfs_stream_flush(stream);
+            int flush_rc = unifyfs_stream_write_out(s);
             if (flush_rc != UNIFYFS_SUCCESS) {
-                /* ERROR: flush sets error indicator and errno */
+                /* ERROR: write out sets error indicator and errno */
                 return flush_rc;
             }
         }
@@ -873,6 +952,69 @@ static int unifyfs_stream_write(
     return UNIFYFS_SUCCESS;
 }
 
+/* reads the next character from the stream buffer without going
+ * through unifyfs_stream_read, returns the character, or -1 if the
+ * character is not in the buffer and the caller must take the
+ * slow path */
+static inline int unifyfs_stream_getc_fast(unifyfs_stream_t* s)
+{
+    if (s->buf == NULL || s->ubuflen > 0 || s->eof) {
+        return -1;
+    }
+
+    unifyfs_fd_t* filedesc = unifyfs_get_filedesc_from_fd(s->fd);
+    if (filedesc == NULL || !filedesc->read) {
+        return -1;
+    }
+
+    off_t current = filedesc->pos;
+    if (current < s->bufpos || current >= s->bufpos + (off_t)s->buflen) {
+        return -1;
+    }
+
+    /* clear pointers, will force a reset when refill is called */
+    s->_p = NULL;
+    s->_r = 0;
+
+    unsigned char* stream_buf = (unsigned char*) s->buf;
+    filedesc->pos = current + 1;
+    return (int) stream_buf[current - s->bufpos];
+}
+
+/* appends a character to the dirty data in the stream buffer without
+ * going through unifyfs_stream_write, returns the character, or -1 if
+ * the caller must take the slow path because the write would not
+ * extend the buffered data or would require a flush */
+static inline int unifyfs_stream_putc_fast(unifyfs_stream_t* s, int c)
+{
+    unsigned char ch = (unsigned char) c;
+    if (!s->bufdirty || s->append || s->ubuflen > 0) {
+        return -1;
+    }
+    if (s->buftype != _IOFBF && (s->buftype != _IOLBF || ch == '\n')) {
+        return -1;
+    }
+    if (s->buflen + 1 >= s->bufsize) {
+        return -1;
+    }
+
+    unifyfs_fd_t* filedesc = unifyfs_get_filedesc_from_fd(s->fd);
+    if (filedesc == NULL || !filedesc->write ||
+        filedesc->pos != s->bufpos + (off_t)s->buflen) {
+        return -1;
+    }
+
+    /* clear pointers, will force a reset when refill is called */
+    s->_p = NULL;
+    s->_r = 0;
+
+    unsigned char* stream_buf = (unsigned char*) s->buf;
+    stream_buf[s->buflen] = ch;
+    s->buflen++;
+    filedesc->pos++;
+    return (int) ch;
+}
+
 /* fseek, fseeko, rewind, and fsetpos all call this function, sets error
  * indicator and errno if necessary, returns -1 on error, returns
  * 0 for success */
@@ -894,10 +1036,10 @@ static int unifyfs_fseek(FILE* stream, off_t offset, int whence)
         return -1;
     }
 
-    /* flush stream if we need to */
-    int flush_rc = unifyfs_stream_flush(stream);
+    /* write out stream buffer if we need to */
+    int flush_rc = unifyfs_stream_write_out(s);
     if (flush_rc != UNIFYFS_SUCCESS) {
-        /* ERROR: flush sets error indicator and errno */
+        /* ERROR: write out sets error indicator and errno */
         return -1;
     }
 
@@ -1141,6 +1283,12 @@ int UNIFYFS_WRAP(fgetc)(FILE* stream)
 {
     /* check whether we should intercept this stream */
     if (unifyfs_intercept_stream(stream)) {
+        /* serve character from stream buffer if we can */
+        int c = unifyfs_stream_getc_fast((unifyfs_stream_t*) stream);
+        if (c >= 0) {
+            return c;
+        }
+
         /* read next character from file */
         unsigned char charbuf;
         size_t count = 1;
@@ -1165,6 +1313,12 @@ int UNIFYFS_WRAP(fputc)(int c, FILE* stream)
 {
     /* check whether we should intercept this stream */
     if (unifyfs_intercept_stream(stream)) {
+        /* append character to stream buffer if we can */
+        int ret = unifyfs_stream_putc_fast((unifyfs_stream_t*) stream, c);
+        if (ret >= 0) {
+            return ret;
+        }
+
         /* write data to file */
         unsigned char charbuf = (unsigned char) c;
         size_t count = 1;
@@ -1188,6 +1342,12 @@ int UNIFYFS_WRAP(getc)(FILE* stream)
 {
     /* check whether we should intercept this stream */
     if (unifyfs_intercept_stream(stream)) {
+        /* serve character from stream buffer if we can */
+        int c = unifyfs_stream_getc_fast((unifyfs_stream_t*) stream);
+        if (c >= 0) {
+            return c;
+        }
+
         /* read next character from file */
         unsigned char charbuf;
         size_t count = 1;
@@ -1212,6 +1372,12 @@ int UNIFYFS_WRAP(putc)(int c, FILE* stream)
 {
     /* check whether we should intercept this stream */
     if (unifyfs_intercept_stream(stream)) {
+        /* append character to stream buffer if we can */
+        int ret = unifyfs_stream_putc_fast((unifyfs_stream_t*) stream, c);
+        if (ret >= 0) {
+            return ret;
+        }
+
         /* write data to file */
         unsigned char charbuf = (unsigned char) c;
         size_t count = 1;
@@ -1878,6 +2044,13 @@ int UNIFYFS_WRAP(fclose)(FILE* stream)
             s->ubuf = NULL;
         }
 
+        /* write out data held in write-combining buffer */
+        int wbuf_rc = unifyfs_fd_flush_write_buffer(s->fd);
+        if (wbuf_rc != UNIFYFS_SUCCESS) {
+            errno = unifyfs_rc_errno(wbuf_rc);
+            return EOF;
+        }
+
         /* close the file */
         int close_rc = unifyfs_fid_close(fid);
         if (close_rc != UNIFYFS_SUCCESS) {
@@ -1891,13 +2064,17 @@ int UNIFYFS_WRAP(fclose)(FILE* stream)
         unifyfs_fd_init(s->fd);
 
         /* add file descriptor back to free stack */
+        unifyfs_stack_lock();
         unifyfs_stack_push(unifyfs_fd_stack, s->fd);
+        unifyfs_stack_unlock();
 
         /* set file descriptor to -1 to indicate stream is invalid */
         unifyfs_stream_init(s->sid);
 
         /* add stream back to free stack */
+        unifyfs_stack_lock();
         unifyfs_stack_push(unifyfs_stream_stack, s->sid);
+        unifyfs_stack_unlock();
 
         /* currently a no-op */
         return 0;
@@ -2281,7 +2458,7 @@ static int __srefill(unifyfs_stream_t* stream)
     /* associate buffer with stream if we need to */
     if (s->buf == NULL) {
         int setvbuf_rc = unifyfs_setvbuf((FILE*)stream, NULL, s->buftype,
-                                         UNIFYFS_CLIENT_STREAM_BUFSIZE);
+                                         unifyfs_stream_bufsize);
         if (setvbuf_rc != UNIFYFS_SUCCESS) {
             /* ERROR: failed to associate buffer */
             s->err = 1;
@@ -2306,10 +2483,10 @@ static int __srefill(unifyfs_stream_t* stream)
     if (current < start || current >= start + length) {
         /* current is outside the range of our buffer */
 
-        /* flush buffer if needed before read */
-        int flush_rc = unifyfs_stream_flush((FILE*)stream);
+        /* write out buffer if needed before read */
+        int flush_rc = unifyfs_stream_write_out(s);
         if (flush_rc != UNIFYFS_SUCCESS) {
-            /* ERROR: flush sets error indicator and errno */
+            /* ERROR: write out sets error indicator and errno */
             return 1;
         }
 
@@ -43,6 +43,7 @@
 #include "unifyfs.h"
 #include "unifyfs-internal.h"
 #include "unifyfs-sysio.h"
+#include "client_mmap.h"
 #include "margo_client.h"
 #include "client_read.h"
 
@@ -169,7 +170,7 @@ static int unifyfs_remove(const char* upath, mode_t mask)
         }
     } else {
         /* path doesn't exist locally, but may exist globally */
-        int gfid = unifyfs_generate_gfid(upath);
+        int64_t gfid = unifyfs_generate_gfid(upath);
         unifyfs_file_attr_t attr = {0};
 
         int ret = unifyfs_get_global_file_meta(gfid, &attr);
@@ -595,7 +596,11 @@ int UNIFYFS_WRAP(rename)(const char* oldpath, const char* newpath)
         /* finally overwrite the old name with the new name */
         LOGDBG("Changing %s to %s",
                (char*)&unifyfs_filelist[fid].filename, new_upath);
-        strcpy((void*)&unifyfs_filelist[fid].filename, new_upath);
+        int rc = unifyfs_fid_rename(fid, new_upath);
+        if (rc != UNIFYFS_SUCCESS) {
+            errno = unifyfs_rc_errno(rc);
+            return -1;
+        }
 
         /* success */
         return 0;
@@ -634,7 +639,7 @@ int UNIFYFS_WRAP(truncate)(const char* path, off_t length)
             /* TODO: here, we don't correctly set EISDIR for directories.
              * we could fetch file attribute w/ metaget and check for such
              * invalid requests to avoid extra rpcs. */
-            int gfid = unifyfs_generate_gfid(upath);
+            int64_t gfid = unifyfs_generate_gfid(upath);
             int rc = invoke_client_truncate_rpc(gfid, length);
             if (rc != UNIFYFS_SUCCESS) {
                 LOGDBG("truncate rpc failed %s in UNIFYFS", upath);
@@ -695,32 +700,17 @@ int UNIFYFS_WRAP(remove)(const char* path)
 }
 
 /* Get global file meta data with accurate file size */
-static int unifyfs_get_meta_with_size(int gfid, unifyfs_file_attr_t* pfattr)
+static int unifyfs_get_meta_with_size(int64_t gfid, unifyfs_file_attr_t* pfattr)
 {
-    /* lookup global meta data for this file */
-    int ret = unifyfs_get_global_file_meta(gfid, pfattr);
+    /* a single stat rpc returns the attributes along with the current
+     * global file size, as tracked by the owner server of the file.
+     * repeated lookups are served from the client metadata cache */
+    int ret = unifyfs_gfid_stat(gfid, pfattr);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGDBG("get metadata rpc failed");
+        LOGDBG("stat rpc failed");
         return ret;
     }
 
-    /* if file is laminated, we assume the file size in the meta
-     * data is already accurate, if not, look up the current file
-     * size with an rpc. we only track size for regular files. */
-    if (S_ISREG(pfattr->mode) && !pfattr->is_laminated) {
-        /* lookup current global file size */
-        size_t filesize;
-        ret = invoke_client_filesize_rpc(gfid, &filesize);
-        if (ret == UNIFYFS_SUCCESS) {
-            /* success, we have a file size value */
-            pfattr->size = (uint64_t) filesize;
-        } else {
-            /* failed to get file size for some reason */
-            LOGDBG("filesize rpc failed");
-            return ret;
-        }
-    }
-
     return UNIFYFS_SUCCESS;
 }
 
@@ -749,7 +739,7 @@ static int __stat(const char* path, struct stat* buf)
     memset(buf, 0, sizeof(*buf));
 
     /* get global file id for given path */
-    int gfid = unifyfs_generate_gfid(path);
+    int64_t gfid = unifyfs_generate_gfid(path);
 
     /* get stat information for file */
     unifyfs_file_attr_t fattr;
@@ -1070,8 +1060,9 @@ int unifyfs_fd_write(int fd, off_t pos, const void* buf, size_t count,
         return EOVERFLOW;
     }
 
-    /* finally write specified data to file */
-    int write_rc = unifyfs_fid_write(fid, pos, buf, count, nwritten);
+    /* finally write specified data to file, small writes may be
+     * combined in the write buffer of the file descriptor */
+    int write_rc = unifyfs_fd_write_combine(fd, pos, buf, count, nwritten);
     return write_rc;
 }
 
@@ -1090,7 +1081,9 @@ static int unifyfs_create(char* upath, mode_t mode)
     }
 
     /* allocate a free file descriptor value */
+    unifyfs_stack_lock();
     int fd = unifyfs_stack_pop(unifyfs_fd_stack);
+    unifyfs_stack_unlock();
     if (fd < 0) {
         /* ran out of file descriptors */
         errno = EMFILE;
@@ -1167,7 +1160,9 @@ int UNIFYFS_WRAP(open)(const char* path, int flags, ...)
         }
 
         /* allocate a free file descriptor value */
+        unifyfs_stack_lock();
         int fd = unifyfs_stack_pop(unifyfs_fd_stack);
+        unifyfs_stack_unlock();
         if (fd < 0) {
             /* ran out of file descriptors */
             errno = EMFILE;
@@ -1333,24 +1328,44 @@ off_t UNIFYFS_WRAP(lseek)(int fd, off_t offset, int whence)
             current_pos = logical_eof + offset;
             break;
         case SEEK_DATA:
-            /* Using fallback approach: always return offset */
-            logical_eof = unifyfs_fid_logical_size(fid);
-            if (offset < 0 || offset > logical_eof) {
-                /* negative offset and offset beyond EOF are invalid */
-                errno = ENXIO;
-                return (off_t)(-1);
-            }
-            current_pos = offset;
-            break;
         case SEEK_HOLE:
-            /* Using fallback approach: always return offset for EOF */
             logical_eof = unifyfs_fid_logical_size(fid);
             if (offset < 0 || offset > logical_eof) {
                 /* negative offset and offset beyond EOF are invalid */
                 errno = ENXIO;
                 return (off_t)(-1);
             }
-            current_pos = logical_eof;
+            if (!unifyfs_fid_is_laminated(fid)) {
+                /* Using fallback approach: the file is all data */
+                current_pos = (whence == SEEK_DATA) ? offset : logical_eof;
+            } else {
+                /* extents of laminated files are final, so look up the
+                 * first written range at or after offset */
+                unifyfs_extent_t range;
+                int n_ranges = 0;
+                int rc = invoke_client_extent_map_rpc(meta->attrs.gfid,
+                                                      (size_t) offset, 1,
+                                                      &range, &n_ranges);
+                if (rc != UNIFYFS_SUCCESS) {
+                    errno = unifyfs_rc_errno(rc);
+                    return (off_t)(-1);
+                }
+                if (whence == SEEK_DATA) {
+                    if (0 == n_ranges) {
+                        /* only holes after offset */
+                        errno = ENXIO;
+                        return (off_t)(-1);
+                    }
+                    current_pos = (off_t) range.offset;
+                } else if ((0 == n_ranges) ||
+                           ((off_t) range.offset > offset)) {
+                    /* offset is in a hole */
+                    current_pos = offset;
+                } else {
+                    /* merged ranges end at a hole or EOF */
+                    current_pos = (off_t)(range.offset + range.length);
+                }
+            }
             break;
         default:
             errno = EINVAL;
@@ -2004,70 +2019,21 @@ int UNIFYFS_WRAP(flock)(int fd, int operation)
     }
 }
 
-/* TODO: handle different flags */
 void* UNIFYFS_WRAP(mmap)(void* addr, size_t length, int prot, int flags,
                          int fd, off_t offset)
 {
     /* check whether we should intercept this file descriptor */
     if (unifyfs_intercept_fd(&fd)) {
-        /* for now, tell user that we can't support mmap,
-         * we'll need to track assigned memory region so that
-         * we can identify our files on msync and munmap */
-        fprintf(stderr, "Function not yet supported @ %s:%d\n",
-                __FILE__, __LINE__);
-        errno = ENODEV;
-        return MAP_FAILED;
-
-#if 0 // TODO - mmap support
-        /* get the file id for this file descriptor */
-        int fid = unifyfs_get_fid_from_fd(fd);
-        if (fid < 0) {
-            errno = EBADF;
-            return MAP_FAILED;
-        }
-
-        /* TODO: handle addr properly based on flags */
-
-        /* allocate memory required to mmap the data if addr is NULL;
-         * using posix_memalign instead of malloc to align mmap'ed area
-         * to page size */
-        if (!addr) {
-            int ret = posix_memalign(&addr, sysconf(_SC_PAGE_SIZE), length);
-            if (ret) {
-                /* posix_memalign does not set errno */
-                if (ret == EINVAL) {
-                    errno = EINVAL;
-                    return MAP_FAILED;
-                }
-
-                if (ret == ENOMEM) {
-                    errno = ENOMEM;
-                    return MAP_FAILED;
-                }
-            }
-        }
-
-        /* TODO: do we need to extend file if offset+length goes past current end? */
-
-        /* check that we don't copy past the end of the file */
-        off_t last_byte = offset + length;
-        off_t file_size = unifyfs_fid_size(fid);
-        if (last_byte > file_size) {
-            /* trying to copy past the end of the file, so
-             * adjust the total amount to be copied */
-            length = (size_t)(file_size - offset);
-        }
-
-        /* read data from file */
-        int rc = unifyfs_fid_read(fid, offset, addr, length);
+        /* map file data into memory, shared writable mappings are
+         * written back to the file on msync and munmap */
+        void* maddr = MAP_FAILED;
+        int rc = client_mmap_create(fd, addr, length, prot, flags, offset,
+                                    &maddr);
         if (rc != UNIFYFS_SUCCESS) {
-            /* TODO: need to free memory in this case? */
-            errno = ENOMEM;
+            errno = unifyfs_rc_errno(rc);
             return MAP_FAILED;
         }
-
-        return addr;
-#endif
+        return maddr;
     } else {
         MAP_OR_FAIL(mmap);
         void* ret = UNIFYFS_REAL(mmap)(addr, length, prot, flags, fd, offset);
@@ -2077,11 +2043,16 @@ void* UNIFYFS_WRAP(mmap)(void* addr, size_t length, int prot, int flags,
 
 int UNIFYFS_WRAP(munmap)(void* addr, size_t length)
 {
-#if 0 // TODO - mmap support
-    fprintf(stderr, "Function not yet supported @ %s:%d\n", __FILE__, __LINE__);
-    errno = EINVAL;
-    return -1;
-#endif
+    /* check whether range is in a mapping of a UnifyFS file */
+    if (client_mmap_is_tracked(addr, length)) {
+        int rc = client_mmap_unmap(addr, length);
+        if (rc != UNIFYFS_SUCCESS) {
+            errno = unifyfs_rc_errno(rc);
+            return -1;
+        }
+        return 0;
+    }
+
     MAP_OR_FAIL(munmap);
     int ret = UNIFYFS_REAL(munmap)(addr, length);
     return ret;
@@ -2089,13 +2060,18 @@ int UNIFYFS_WRAP(munmap)(void* addr, size_t length)
 
 int UNIFYFS_WRAP(msync)(void* addr, size_t length, int flags)
 {
-#if 0 // TODO - mmap support
-    /* TODO: need to keep track of all the mmaps that are linked to
-     * a given file before this function can be implemented */
-    fprintf(stderr, "Function not yet supported @ %s:%d\n", __FILE__, __LINE__);
-    errno = EINVAL;
-    return -1;
-#endif
+    /* check whether range is in a mapping of a UnifyFS file,
+     * we write back changes synchronously for both MS_SYNC and
+     * MS_ASYNC */
+    if (client_mmap_is_tracked(addr, length)) {
+        int rc = client_mmap_sync(addr, length);
+        if (rc != UNIFYFS_SUCCESS) {
+            errno = unifyfs_rc_errno(rc);
+            return -1;
+        }
+        return 0;
+    }
+
     MAP_OR_FAIL(msync);
     int ret = UNIFYFS_REAL(msync)(addr, length, flags);
     return ret;
@@ -2141,6 +2117,12 @@ int UNIFYFS_WRAP(close)(int fd)
 
         /* if file was opened for writing, sync it */
         if (filedesc->write) {
+            int flush_rc = unifyfs_fd_flush_write_buffer(fd);
+            if (flush_rc != UNIFYFS_SUCCESS) {
+                errno = unifyfs_rc_errno(flush_rc);
+                return -1;
+            }
+
             int sync_rc = unifyfs_fid_sync(fid);
             if (sync_rc != UNIFYFS_SUCCESS) {
                 errno = unifyfs_rc_errno(sync_rc);
@@ -2161,7 +2143,9 @@ int UNIFYFS_WRAP(close)(int fd)
         unifyfs_fd_init(fd);
 
         /* add file descriptor back to free stack */
+        unifyfs_stack_lock();
         unifyfs_stack_push(unifyfs_fd_stack, fd);
+        unifyfs_stack_unlock();
 
         return 0;
     } else {
@@ -2196,7 +2180,7 @@ static int __chmod(int fid, mode_t mode)
 
     /* found file, and it's not yet laminated,
      * get the global file id */
-    int gfid = unifyfs_gfid_from_fid(fid);
+    int64_t gfid = unifyfs_gfid_from_fid(fid);
 
     /*
      * If the chmod clears all the existing write bits, then it's a laminate.
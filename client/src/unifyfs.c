@@ -44,11 +44,15 @@
 #include "unifyfs-internal.h"
 #include "unifyfs-fixed.h"
 #include "client_read.h"
+#include "client_shm_queue.h"
+#include "client_transfer.h"
 
 // client-server rpc headers
 #include "unifyfs_client_rpcs.h"
 #include "unifyfs_rpc_util.h"
 #include "margo_client.h"
+#include "unifyfs_stats.h"
+#include "unifyfs_trace.h"
 
 #ifdef USE_SPATH
 #include "spath.h"
@@ -72,14 +76,24 @@ int client_rank;     /* client-provided rank (for debugging) */
 int unifyfs_app_id;    /* application (aka mountpoint) id */
 int unifyfs_client_id; /* client id within application */
 
-static int unifyfs_use_single_shm = 0;
-static int unifyfs_page_size      = 0;
+static int unifyfs_page_size = 0;
 
 /* Determine whether we automatically sync every write to server.
  * This slows write performance, but it can serve as a work
  * around for apps that do not have all necessary syncs. */
 static bool unifyfs_write_sync;
 
+/* Size of the per-fd buffer used to combine runs of small contiguous
+ * writes into one log write and extent, 0 disables write combining */
+static size_t unifyfs_write_combine_size;
+
+/* Determine whether we send common requests to the server through
+ * the request queue in our superblock, rather than as RPCs */
+static bool unifyfs_shm_requests;
+
+/* request queue region in superblock */
+static void* unifyfs_shm_queue;
+
 static off_t unifyfs_max_offt;
 static off_t unifyfs_min_offt;
 static off_t unifyfs_max_long;
@@ -88,6 +102,10 @@ static off_t unifyfs_min_long;
 /* TODO: moved these to fixed file */
 int    unifyfs_max_files;  /* maximum number of files to store */
 bool   unifyfs_local_extents;  /* track data extents in client to read local */
+size_t unifyfs_stream_bufsize; /* default buffer size of stdio streams */
+int    unifyfs_transfer_depth;   /* transfer buffers per file transfer */
+int    unifyfs_transfer_threads; /* threads running background transfers */
+bool   unifyfs_transfer_server;  /* servers stage out laminated files */
 
 /* whether to return UNIFYFS (true) or TMPFS (false) magic value from statfs */
 bool unifyfs_super_magic;
@@ -106,6 +124,33 @@ static void* free_fid_stack;
 unifyfs_filename_t* unifyfs_filelist;
 static unifyfs_filemeta_t* unifyfs_filemetas;
 
+/* one more than the highest file id ever handed out from this superblock,
+ * kept in the superblock header. entries at or above this value have
+ * never been used, so scans of the file table stop here */
+static uint32_t* unifyfs_fid_hwm;
+
+/* the file table grows on demand: memory for its entries is reserved
+ * this many file ids at a time, as file ids are handed out */
+#define FID_TABLE_CHUNK 128
+
+/* number of file ids whose file table entries have memory reserved */
+static int fid_reserved;
+
+/* process-local hash indexes over the active entries of the file table,
+ * so that lookups by path or gfid do not scan every file id. like the
+ * file table itself, they are protected by the library lock */
+typedef struct {
+    int fid;                 /* file id of this entry */
+    int64_t gfid;            /* gfid key, fixed at create time */
+    int indexed;             /* whether entry is in the indexes */
+    UT_hash_handle hh_path;  /* keyed by the file name in unifyfs_filelist */
+    UT_hash_handle hh_gfid;  /* keyed by gfid */
+} unifyfs_fid_index_t;
+
+static unifyfs_fid_index_t* fid_index_entries; /* one entry per file id */
+static unifyfs_fid_index_t* fid_path_index;    /* path hash head */
+static unifyfs_fid_index_t* fid_gfid_index;    /* gfid hash head */
+
 /* TODO: metadata spillover is not currently supported */
 int unifyfs_spillmetablock = -1;
 
@@ -149,6 +194,10 @@ char* unifyfs_cwd;
 /* mutex to lock stack operations */
 pthread_mutex_t unifyfs_stack_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* library lock, see unifyfs_client_lock() */
+static pthread_mutex_t unifyfs_client_mutex;
+static pthread_once_t unifyfs_client_mutex_once = PTHREAD_ONCE_INIT;
+
 /* single function to route all unsupported wrapper calls through */
 int unifyfs_vunsupported(
     const char* fn_name,
@@ -251,22 +300,41 @@ inline int unifyfs_would_overflow_long(long a, long b)
     return 0;
 }
 
-/* lock access to shared data structures in superblock */
+/* lock access to the free file id, file descriptor and stream stacks,
+ * which application threads and background transfers share */
 inline int unifyfs_stack_lock(void)
 {
-    if (unifyfs_use_single_shm) {
-        return pthread_mutex_lock(&unifyfs_stack_mutex);
-    }
-    return 0;
+    return pthread_mutex_lock(&unifyfs_stack_mutex);
 }
 
-/* unlock access to shared data structures in superblock */
+/* unlock access to the free id stacks */
 inline int unifyfs_stack_unlock(void)
 {
-    if (unifyfs_use_single_shm) {
-        return pthread_mutex_unlock(&unifyfs_stack_mutex);
-    }
-    return 0;
+    return pthread_mutex_unlock(&unifyfs_stack_mutex);
+}
+
+/* the library lock is recursive, since the functions that take it
+ * call each other */
+static void client_mutex_init(void)
+{
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&unifyfs_client_mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+/* lock the client library state shared between threads */
+int unifyfs_client_lock(void)
+{
+    pthread_once(&unifyfs_client_mutex_once, client_mutex_init);
+    return pthread_mutex_lock(&unifyfs_client_mutex);
+}
+
+/* unlock the client library state shared between threads */
+int unifyfs_client_unlock(void)
+{
+    return pthread_mutex_unlock(&unifyfs_client_mutex);
 }
 
 static void unifyfs_normalize_path(const char* path, char* normalized)
@@ -394,24 +462,70 @@ inline int unifyfs_intercept_dirstream(DIR* dirp)
     return 0;
 }
 
+/* add an active file id to the path and gfid indexes */
+static void fid_index_add(int fid, int64_t gfid)
+{
+    unifyfs_fid_index_t* entry = &fid_index_entries[fid];
+    const char* path = unifyfs_filelist[fid].filename;
+
+    unifyfs_client_lock();
+    if (!entry->indexed) {
+        entry->fid  = fid;
+        entry->gfid = gfid;
+        HASH_ADD_KEYPTR(hh_path, fid_path_index, path, strlen(path), entry);
+        HASH_ADD(hh_gfid, fid_gfid_index, gfid, sizeof(entry->gfid), entry);
+        entry->indexed = 1;
+    }
+    unifyfs_client_unlock();
+}
+
+/* remove a file id from the path and gfid indexes */
+static void fid_index_remove(int fid)
+{
+    unifyfs_fid_index_t* entry = &fid_index_entries[fid];
+
+    unifyfs_client_lock();
+    if (entry->indexed) {
+        HASH_DELETE(hh_path, fid_path_index, entry);
+        HASH_DELETE(hh_gfid, fid_gfid_index, entry);
+        entry->indexed = 0;
+    }
+    unifyfs_client_unlock();
+}
+
+/* drop all entries from the indexes */
+static void fid_index_clear(void)
+{
+    unifyfs_fid_index_t* entry;
+    unifyfs_fid_index_t* tmp;
+
+    unifyfs_client_lock();
+    HASH_ITER(hh_path, fid_path_index, entry, tmp) {
+        entry->indexed = 0;
+    }
+    HASH_CLEAR(hh_path, fid_path_index);
+    HASH_CLEAR(hh_gfid, fid_gfid_index);
+    unifyfs_client_unlock();
+}
+
 /* given a path, return the local file id, or -1 if not found */
 inline int unifyfs_get_fid_from_path(const char* path)
 {
-    /* scan through active entries in filelist array looking
-     * for a match of path */
-    int i = 0;
-    while (i < unifyfs_max_files) {
-        if (unifyfs_filelist[i].in_use &&
-            strcmp((void*)&unifyfs_filelist[i].filename, path) == 0) {
-            LOGDBG("File found: unifyfs_filelist[%d].filename = %s",
-                   i, (char*)&unifyfs_filelist[i].filename);
-            return i;
-        }
-        i++;
+    unifyfs_fid_index_t* entry = NULL;
+    int fid = -1;
+
+    unifyfs_client_lock();
+    HASH_FIND(hh_path, fid_path_index, path, strlen(path), entry);
+    if (NULL != entry) {
+        fid = entry->fid;
     }
+    unifyfs_client_unlock();
 
-    /* couldn't find specified path */
-    return -1;
+    if (fid >= 0) {
+        LOGDBG("File found: unifyfs_filelist[%d].filename = %s",
+               fid, (char*)&unifyfs_filelist[fid].filename);
+    }
+    return fid;
 }
 
 /* initialize file descriptor structure for given fd value */
@@ -428,6 +542,14 @@ int unifyfs_fd_init(int fd)
     filedesc->read  = 0;
     filedesc->write = 0;
 
+    /* drop write-combining buffer, callers flush it before closing */
+    if (NULL != filedesc->wbuf) {
+        free(filedesc->wbuf);
+        filedesc->wbuf = NULL;
+    }
+    filedesc->wbuf_pos = 0;
+    filedesc->wbuf_len = 0;
+
     return UNIFYFS_SUCCESS;
 }
 
@@ -602,7 +724,7 @@ int unifyfs_fid_is_dir(int fid)
     return 0;
 }
 
-int unifyfs_gfid_from_fid(const int fid)
+int64_t unifyfs_gfid_from_fid(const int fid)
 {
     /* check that local file id is in range */
     if (fid < 0 || fid >= unifyfs_max_files) {
@@ -618,20 +740,20 @@ int unifyfs_gfid_from_fid(const int fid)
     }
 }
 
-/* scan list of files and return fid corresponding to target gfid,
- * returns -1 if not found */
-int unifyfs_fid_from_gfid(int gfid)
+/* return fid corresponding to target gfid, returns -1 if not found */
+int unifyfs_fid_from_gfid(int64_t gfid)
 {
-    int i;
-    for (i = 0; i < unifyfs_max_files; i++) {
-        if (unifyfs_filelist[i].in_use &&
-            unifyfs_filemetas[i].attrs.gfid == gfid) {
-            /* found a file id that's in use and it matches
-             * the target fid, this is the one */
-            return i;
-        }
+    unifyfs_fid_index_t* entry = NULL;
+    int fid = -1;
+
+    unifyfs_client_lock();
+    HASH_FIND(hh_gfid, fid_gfid_index, &gfid, sizeof(gfid), entry);
+    if (NULL != entry) {
+        fid = entry->fid;
     }
-    return -1;
+    unifyfs_client_unlock();
+
+    return fid;
 }
 
 /* Given a fid, return the path.  */
@@ -652,28 +774,170 @@ const char* unifyfs_path_from_fid(int fid)
  * returns 0 for no */
 int unifyfs_fid_is_dir_empty(const char* path)
 {
-    int i = 0;
-    while (i < unifyfs_max_files) {
-        /* only check this element if it's active */
-        if (unifyfs_filelist[i].in_use) {
-            /* if the file starts with the path, it is inside of that directory
-             * also check that it's not the directory entry itself */
-            char* strptr = strstr(path, unifyfs_filelist[i].filename);
-            if (strptr == unifyfs_filelist[i].filename &&
-                strcmp(path, unifyfs_filelist[i].filename) != 0) {
-                /* found a child item in path */
-                LOGDBG("File found: unifyfs_filelist[%d].filename = %s",
-                       i, (char*)&unifyfs_filelist[i].filename);
-                return 0;
+    int empty = 1;
+    unifyfs_fid_index_t* entry;
+    unifyfs_fid_index_t* tmp;
+
+    /* only active files are in the index, so walk it
+     * rather than every slot of the file table */
+    unifyfs_client_lock();
+    HASH_ITER(hh_path, fid_path_index, entry, tmp) {
+        int i = entry->fid;
+
+        /* if the file starts with the path, it is inside of that directory
+         * also check that it's not the directory entry itself */
+        char* strptr = strstr(path, unifyfs_filelist[i].filename);
+        if (strptr == unifyfs_filelist[i].filename &&
+            strcmp(path, unifyfs_filelist[i].filename) != 0) {
+            /* found a child item in path */
+            LOGDBG("File found: unifyfs_filelist[%d].filename = %s",
+                   i, (char*)&unifyfs_filelist[i].filename);
+            empty = 0;
+            break;
+        }
+    }
+    unifyfs_client_unlock();
+
+    /* if no files with this prefix were found, dir must be empty */
+    return empty;
+}
+
+/* ---------------------------------------
+ * Cache of global file metadata
+ * --------------------------------------- */
+
+/* The server marks stat results as cacheable when it will hear about any
+ * change to them (it owns the file, the file is laminated, or it holds a
+ * lease from the owner). When such a change happens, it increments the
+ * metadata epoch in our superblock, so cached attributes are only used
+ * while the epoch is the one they were fetched in. */
+/* max number of files with cached metadata, the cache is emptied when
+ * it fills up */
+#ifndef UNIFYFS_CLIENT_META_CACHE_MAX
+# define UNIFYFS_CLIENT_META_CACHE_MAX 4096
+#endif
+
+typedef struct {
+    int64_t gfid;              /* global file id */
+    unifyfs_file_attr_t attr;  /* attributes, without the filename */
+    time_t expire;             /* time after which not to trust attr */
+    UT_hash_handle hh;
+} unifyfs_meta_cache_entry_t;
+
+static unifyfs_meta_cache_entry_t* meta_cache; // = NULL
+static size_t meta_cache_count; // = 0
+static uint64_t meta_cache_epoch; // = 0
+static pthread_mutex_t meta_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/* return current metadata epoch from the superblock */
+static uint64_t meta_cache_current_epoch(void)
+{
+    if (NULL == unifyfs_indices.ring) {
+        return 0;
+    }
+    return unifyfs_index_ring_load(&(unifyfs_indices.ring->meta_epoch));
+}
+
+/* drop all cached attributes, assumes caller has the cache mutex */
+static void meta_cache_clear_locked(void)
+{
+    unifyfs_meta_cache_entry_t* entry;
+    unifyfs_meta_cache_entry_t* tmp;
+    HASH_ITER(hh, meta_cache, entry, tmp) {
+        HASH_DEL(meta_cache, entry);
+        free(entry);
+    }
+    meta_cache_count = 0;
+}
+
+/* drop all cached attributes, and start over with the given epoch */
+static void meta_cache_reset(uint64_t epoch)
+{
+    pthread_mutex_lock(&meta_cache_mutex);
+    meta_cache_clear_locked();
+    meta_cache_epoch = epoch;
+    pthread_mutex_unlock(&meta_cache_mutex);
+}
+
+/* copy cached attributes for gfid into attr, returns 1 if found */
+static int meta_cache_lookup(int64_t gfid, unifyfs_file_attr_t* attr)
+{
+    int found = 0;
+    uint64_t epoch = meta_cache_current_epoch();
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&meta_cache_mutex);
+    if (epoch != meta_cache_epoch) {
+        /* server says something changed */
+        meta_cache_clear_locked();
+        meta_cache_epoch = epoch;
+    } else {
+        unifyfs_meta_cache_entry_t* entry = NULL;
+        HASH_FIND(hh, meta_cache, &gfid, sizeof(gfid), entry);
+        if (NULL != entry) {
+            if (now < entry->expire) {
+                *attr = entry->attr;
+                found = 1;
+            } else {
+                HASH_DEL(meta_cache, entry);
+                free(entry);
+                meta_cache_count--;
+            }
+        }
+    }
+    pthread_mutex_unlock(&meta_cache_mutex);
+
+    return found;
+}
+
+/* cache attributes for gfid that were fetched in the given epoch */
+static void meta_cache_insert(int64_t gfid,
+                              unifyfs_file_attr_t* attr,
+                              uint64_t epoch)
+{
+    pthread_mutex_lock(&meta_cache_mutex);
+    if ((epoch == meta_cache_epoch) &&
+        (epoch == meta_cache_current_epoch())) {
+        unifyfs_meta_cache_entry_t* entry = NULL;
+        HASH_FIND(hh, meta_cache, &gfid, sizeof(gfid), entry);
+        if (NULL == entry) {
+            if (meta_cache_count >= UNIFYFS_CLIENT_META_CACHE_MAX) {
+                meta_cache_clear_locked();
+            }
+            entry = malloc(sizeof(*entry));
+            if (NULL != entry) {
+                entry->gfid = gfid;
+                HASH_ADD(hh, meta_cache, gfid, sizeof(entry->gfid), entry);
+                meta_cache_count++;
             }
         }
+        if (NULL != entry) {
+            entry->attr = *attr;
+            entry->attr.filename = NULL;
+            entry->expire = time(NULL) + UNIFYFS_METADATA_LEASE_SECONDS;
+        }
+    }
+    pthread_mutex_unlock(&meta_cache_mutex);
+}
 
-        /* go on to next file */
-        i++;
+/* Get global metadata (without the filename) with current size for the
+ * given gfid, from the metadata cache if possible */
+int unifyfs_gfid_stat(int64_t gfid, unifyfs_file_attr_t* attr)
+{
+    if (meta_cache_lookup(gfid, attr)) {
+        LOGDBG("using cached metadata for gfid=%" PRId64, gfid);
+        return UNIFYFS_SUCCESS;
     }
 
-    /* couldn't find any files with this prefix, dir must be empty */
-    return 1;
+    /* take epoch before asking, so that a change reported by the server
+     * while our request is in flight keeps us from caching the reply */
+    uint64_t epoch = meta_cache_current_epoch();
+    int cacheable = 0;
+    int ret = invoke_client_stat_rpc(gfid, attr, &cacheable);
+    if ((ret == UNIFYFS_SUCCESS) && cacheable) {
+        meta_cache_insert(gfid, attr, epoch);
+    }
+    return ret;
 }
 
 /* Return the global (laminated) size of the file */
@@ -705,21 +969,21 @@ off_t unifyfs_fid_logical_size(int fid)
         unifyfs_fid_sync(fid);
 
         /* get file size for this file */
-        size_t filesize;
-        int gfid = unifyfs_gfid_from_fid(fid);
-        int ret = invoke_client_filesize_rpc(gfid, &filesize);
+        unifyfs_file_attr_t attr;
+        int64_t gfid = unifyfs_gfid_from_fid(fid);
+        int ret = unifyfs_gfid_stat(gfid, &attr);
         if (ret != UNIFYFS_SUCCESS) {
             /* failed to get file size */
             return (off_t)-1;
         }
-        return (off_t)filesize;
+        return (off_t)attr.size;
     }
 }
 
 /* if we have a local fid structure corresponding to the gfid
  * in question, we attempt the file lookup with the fid method
  * otherwise call back to the rpc */
-off_t unifyfs_gfid_filesize(int gfid)
+off_t unifyfs_gfid_filesize(int64_t gfid)
 {
     off_t filesize = (off_t)-1;
 
@@ -732,11 +996,11 @@ off_t unifyfs_gfid_filesize(int gfid)
     } else {
         /* no fid for this gfid,
          * look it up with server rpc */
-        size_t size;
-        int ret = invoke_client_filesize_rpc(gfid, &size);
+        unifyfs_file_attr_t attr;
+        int ret = unifyfs_gfid_stat(gfid, &attr);
         if (ret == UNIFYFS_SUCCESS) {
             /* got the file size successfully */
-            filesize = size;
+            filesize = (off_t)attr.size;
         }
     }
 
@@ -753,7 +1017,9 @@ int unifyfs_fid_update_file_meta(int fid, unifyfs_file_attr_t* gfattr)
     /* lookup local metadata for file */
     unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
     if (meta != NULL) {
+        unifyfs_client_lock();
         meta->attrs = *gfattr;
+        unifyfs_client_unlock();
         return UNIFYFS_SUCCESS;
     }
 
@@ -775,7 +1041,7 @@ int unifyfs_fid_update_file_meta(int fid, unifyfs_file_attr_t* gfattr)
  * gfattr: The metadata values to store.
  */
 int unifyfs_set_global_file_meta(
-    int gfid,
+    int64_t gfid,
     unifyfs_file_attr_op_e attr_op,
     unifyfs_file_attr_t* gfattr)
 {
@@ -793,7 +1059,7 @@ int unifyfs_set_global_file_meta(
     return ret;
 }
 
-int unifyfs_get_global_file_meta(int gfid, unifyfs_file_attr_t* gfattr)
+int unifyfs_get_global_file_meta(int64_t gfid, unifyfs_file_attr_t* gfattr)
 {
     /* check that we have an output buffer to write to */
     if (NULL == gfattr) {
@@ -834,7 +1100,7 @@ int unifyfs_set_global_file_meta_from_fid(int fid, unifyfs_file_attr_op_e op)
     /* set global file id */
     fattr.gfid = meta->attrs.gfid;
 
-    LOGDBG("setting global file metadata for fid:%d gfid:%d path:%s",
+    LOGDBG("setting global file metadata for fid:%d gfid:%" PRId64 " path:%s",
            fid, fattr.gfid, meta->attrs.filename);
 
     unifyfs_file_attr_update(op, &fattr, &(meta->attrs));
@@ -847,12 +1113,56 @@ int unifyfs_set_global_file_meta_from_fid(int fid, unifyfs_file_attr_op_e op)
     return ret;
 }
 
+/* reserve superblock memory for the file table entries of file ids
+ * below n_fids, rounded up to a whole chunk of file ids */
+static int fid_table_reserve(int n_fids)
+{
+    if (n_fids <= fid_reserved) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    int end = ((n_fids + FID_TABLE_CHUNK - 1) / FID_TABLE_CHUNK) *
+              FID_TABLE_CHUNK;
+    if (end > unifyfs_max_files) {
+        end = unifyfs_max_files;
+    }
+    size_t count = (size_t)(end - fid_reserved);
+
+    char* base = (char*)shm_super_ctx->addr;
+    char* names = (char*)&unifyfs_filelist[fid_reserved];
+    char* metas = (char*)&unifyfs_filemetas[fid_reserved];
+    int rc = unifyfs_shm_reserve(shm_super_ctx, (size_t)(names - base),
+                                 count * sizeof(unifyfs_filename_t));
+    if (rc == UNIFYFS_SUCCESS) {
+        rc = unifyfs_shm_reserve(shm_super_ctx, (size_t)(metas - base),
+                                 count * sizeof(unifyfs_filemeta_t));
+    }
+    if (rc != UNIFYFS_SUCCESS) {
+        LOGERR("failed to reserve file table entries %d-%d",
+               fid_reserved, end - 1);
+        return rc;
+    }
+
+    LOGDBG("reserved file table entries %d-%d", fid_reserved, end - 1);
+    fid_reserved = end;
+    return UNIFYFS_SUCCESS;
+}
+
 /* allocate a file id slot for a new file
  * return the fid or -1 on error */
 int unifyfs_fid_alloc(void)
 {
     unifyfs_stack_lock();
     int fid = unifyfs_stack_pop(free_fid_stack);
+    if ((fid >= 0) && (fid_table_reserve(fid + 1) != UNIFYFS_SUCCESS)) {
+        /* no memory for the file table entry */
+        unifyfs_stack_push(free_fid_stack, fid);
+        unifyfs_stack_unlock();
+        return -ENOSPC;
+    }
+    if ((fid >= 0) && ((uint32_t)fid >= *unifyfs_fid_hwm)) {
+        *unifyfs_fid_hwm = (uint32_t)fid + 1;
+    }
     unifyfs_stack_unlock();
     LOGDBG("unifyfs_stack_pop() gave %d", fid);
     if (fid < 0) {
@@ -872,10 +1182,9 @@ int unifyfs_fid_free(int fid)
     return UNIFYFS_SUCCESS;
 }
 
-/* add a new file and initialize metadata
- * returns the new fid, or negative value on error */
-int unifyfs_fid_create_file(const char* path,
-                            int exclusive)
+/* add a new file, see unifyfs_fid_create_file() */
+static int fid_create_file(const char* path,
+                           int exclusive)
 {
     /* check that pathname is within bounds */
     size_t pathlen = strlen(path) + 1;
@@ -883,6 +1192,16 @@ int unifyfs_fid_create_file(const char* path,
         return -ENAMETOOLONG;
     }
 
+    /* the caller has checked that the path is not in our file table,
+     * so any local file with the same gfid has a different path */
+    int64_t gfid = unifyfs_generate_gfid(path);
+    int other_fid = unifyfs_fid_from_gfid(gfid);
+    if (other_fid >= 0) {
+        LOGERR("gfid=%" PRId64 " of %s is in use by %s",
+               gfid, path, unifyfs_filelist[other_fid].filename);
+        return -UNIFYFS_ERROR_GFID;
+    }
+
     /* allocate an id for this file */
     int fid = unifyfs_fid_alloc();
     if (fid < 0)  {
@@ -903,7 +1222,7 @@ int unifyfs_fid_create_file(const char* path,
 
     /* initialize file attributes */
     unifyfs_file_attr_set_invalid(&(meta->attrs));
-    meta->attrs.gfid = unifyfs_generate_gfid(path);
+    meta->attrs.gfid = gfid;
     meta->attrs.size = 0;
     meta->attrs.mode = UNIFYFS_STAT_DEFAULT_FILE_MODE;
     meta->attrs.is_laminated = 0;
@@ -925,16 +1244,57 @@ int unifyfs_fid_create_file(const char* path,
     meta->fid          = fid;
     meta->storage      = FILE_STORAGE_NULL;
     meta->needs_sync   = 0;
+    meta->wbuf_fd      = -1;
 
     /* PTHREAD_PROCESS_SHARED allows Process-Shared Synchronization */
     meta->flock_status = UNLOCKED;
     pthread_spin_init(&meta->fspinlock, PTHREAD_PROCESS_SHARED);
 
+    /* make the new file visible to path and gfid lookups */
+    fid_index_add(fid, meta->attrs.gfid);
+
     return fid;
 }
 
-/* create directory state for given path. returns success|error */
-int unifyfs_fid_create_directory(const char* path)
+/* add a new file and initialize metadata
+ * returns the new fid, or negative value on error */
+int unifyfs_fid_create_file(const char* path,
+                            int exclusive)
+{
+    unifyfs_client_lock();
+    int fid = fid_create_file(path, exclusive);
+    unifyfs_client_unlock();
+    return fid;
+}
+
+/* change the path of an active file id, the caller must already
+ * have verified that no other file is using new_path */
+int unifyfs_fid_rename(int fid, const char* new_path)
+{
+    size_t pathlen = strlen(new_path) + 1;
+    if (pathlen > UNIFYFS_MAX_FILENAME) {
+        return ENAMETOOLONG;
+    }
+
+    unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
+    if (NULL == meta) {
+        return EINVAL;
+    }
+
+    /* the path index is keyed on the name stored in the file table,
+     * so take the entry out while the name changes */
+    unifyfs_client_lock();
+    fid_index_remove(fid);
+    strlcpy((void*)&unifyfs_filelist[fid].filename, new_path,
+            UNIFYFS_MAX_FILENAME);
+    fid_index_add(fid, meta->attrs.gfid);
+    unifyfs_client_unlock();
+
+    return UNIFYFS_SUCCESS;
+}
+
+/* create directory state, see unifyfs_fid_create_directory() */
+static int fid_create_directory(const char* path)
 {
     /* check that pathname is within bounds */
     size_t pathlen = strlen(path) + 1;
@@ -944,7 +1304,7 @@ int unifyfs_fid_create_directory(const char* path)
 
     /* get local and global file ids */
     int fid  = unifyfs_get_fid_from_path(path);
-    int gfid = unifyfs_generate_gfid(path);
+    int64_t gfid = unifyfs_generate_gfid(path);
 
     /* test whether we have info for file in our local file list */
     int found_local = (fid != -1);
@@ -1009,9 +1369,17 @@ int unifyfs_fid_create_directory(const char* path)
     return UNIFYFS_SUCCESS;
 }
 
-/* delete a file id, free its local storage resources and return
- * the file id to free stack */
-int unifyfs_fid_delete(int fid)
+/* create directory state for given path. returns success|error */
+int unifyfs_fid_create_directory(const char* path)
+{
+    unifyfs_client_lock();
+    int rc = fid_create_directory(path);
+    unifyfs_client_unlock();
+    return rc;
+}
+
+/* delete a file id, see unifyfs_fid_delete() */
+static int fid_delete(int fid)
 {
     /* finalize the storage we're using for this file */
     int rc = fid_storage_free(fid);
@@ -1022,6 +1390,7 @@ int unifyfs_fid_delete(int fid)
     }
 
     /* set this file id as not in use */
+    fid_index_remove(fid);
     unifyfs_filelist[fid].in_use = 0;
 
     /* add this id back to the free stack */
@@ -1035,11 +1404,18 @@ int unifyfs_fid_delete(int fid)
     return UNIFYFS_SUCCESS;
 }
 
-/* Write count bytes from buf into file starting at offset pos.
- *
- * Returns UNIFYFS_SUCCESS, or an error code
- */
-int unifyfs_fid_write(
+/* delete a file id, free its local storage resources and return
+ * the file id to free stack */
+int unifyfs_fid_delete(int fid)
+{
+    unifyfs_client_lock();
+    int rc = fid_delete(fid);
+    unifyfs_client_unlock();
+    return rc;
+}
+
+/* write count bytes from buf into file, see unifyfs_fid_write() */
+static int fid_write(
     int fid,          /* local file id to write to */
     off_t pos,        /* starting position in file */
     const void* buf,  /* buffer to be written */
@@ -1065,6 +1441,14 @@ int unifyfs_fid_write(
         return EROFS;
     }
 
+    /* buffered writes to the file come before this one */
+    if (meta->wbuf_fd >= 0) {
+        rc = unifyfs_fid_flush_write_buffers(fid);
+        if (rc != UNIFYFS_SUCCESS) {
+            return rc;
+        }
+    }
+
     /* determine storage type to write file data */
     if (meta->storage == FILE_STORAGE_LOGIO) {
         /* file stored in logged i/o */
@@ -1092,10 +1476,193 @@ int unifyfs_fid_write(
     return rc;
 }
 
-/* truncate file id to given length, frees resources if length is
- * less than size and allocates and zero-fills new bytes if length
- * is more than size */
-int unifyfs_fid_truncate(int fid, off_t length)
+/* Write count bytes from buf into file starting at offset pos.
+ *
+ * Returns UNIFYFS_SUCCESS, or an error code
+ */
+int unifyfs_fid_write(
+    int fid,          /* local file id to write to */
+    off_t pos,        /* starting position in file */
+    const void* buf,  /* buffer to be written */
+    size_t count,     /* number of bytes to write */
+    size_t* nwritten) /* returns number of bytes written */
+{
+    uint64_t start_ns = unifyfs_stats_now_ns();
+    unifyfs_trace_ctx_t trace;
+    unifyfs_trace_begin(&trace);
+    unifyfs_client_lock();
+    int rc = fid_write(fid, pos, buf, count, nwritten);
+    unifyfs_client_unlock();
+    unifyfs_stats_add(UNIFYFS_STAT_CLIENT_WRITE_BYTES, *nwritten);
+    unifyfs_stats_record(UNIFYFS_STAT_CLIENT_WRITE, start_ns);
+    unifyfs_trace_span(&trace, UNIFYFS_TRACE_CLIENT_WRITE, start_ns);
+    return rc;
+}
+
+/* write buffered data of fd, see unifyfs_fd_flush_write_buffer() */
+static int fd_flush_write_buffer(int fd)
+{
+    unifyfs_fd_t* filedesc = unifyfs_get_filedesc_from_fd(fd);
+    if ((NULL == filedesc) || (0 == filedesc->wbuf_len)) {
+        /* nothing buffered */
+        return UNIFYFS_SUCCESS;
+    }
+
+    int fid = filedesc->fid;
+    unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
+    assert(meta != NULL);
+
+    /* mark buffer empty first, so the write below goes to the log */
+    size_t count = filedesc->wbuf_len;
+    filedesc->wbuf_len = 0;
+    if (meta->wbuf_fd == fd) {
+        meta->wbuf_fd = -1;
+    }
+
+    LOGDBG("flushing %zu buffered bytes at pos=%zu for fid=%d",
+           count, (size_t)filedesc->wbuf_pos, fid);
+
+    size_t nwritten = 0;
+    int rc = unifyfs_fid_write(fid, filedesc->wbuf_pos, filedesc->wbuf,
+                               count, &nwritten);
+    if ((rc == UNIFYFS_SUCCESS) && (nwritten < count)) {
+        /* we already told the writer all of it was written */
+        LOGERR("lost %zu buffered bytes for fid=%d",
+               (count - nwritten), fid);
+        rc = ENOSPC;
+    }
+    return rc;
+}
+
+/* Write data held in the write-combining buffer of fd to the log as a
+ * single write, which adds one extent for the whole run of writes.
+ *
+ * Returns UNIFYFS_SUCCESS, or an error code
+ */
+int unifyfs_fd_flush_write_buffer(int fd)
+{
+    unifyfs_client_lock();
+    int rc = fd_flush_write_buffer(fd);
+    unifyfs_client_unlock();
+    return rc;
+}
+
+/* Write data held in a write-combining buffer for file id to the log.
+ * Only one fd at a time holds buffered data for a file, so that buffered
+ * and direct writes to the file reach the log in order.
+ *
+ * Returns UNIFYFS_SUCCESS, or an error code
+ */
+int unifyfs_fid_flush_write_buffers(int fid)
+{
+    int rc = UNIFYFS_SUCCESS;
+    unifyfs_client_lock();
+    unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
+    if ((NULL != meta) && (meta->wbuf_fd >= 0)) {
+        rc = fd_flush_write_buffer(meta->wbuf_fd);
+    }
+    unifyfs_client_unlock();
+    return rc;
+}
+
+/* write through the buffer of fd, see unifyfs_fd_write_combine() */
+static int fd_write_combine(
+    int fd,           /* file descriptor to write to */
+    off_t pos,        /* starting position in file */
+    const void* buf,  /* buffer to be written */
+    size_t count,     /* number of bytes to write */
+    size_t* nwritten) /* returns number of bytes written */
+{
+    int rc;
+
+    /* assume we won't write anything */
+    *nwritten = 0;
+
+    unifyfs_fd_t* filedesc = unifyfs_get_filedesc_from_fd(fd);
+    assert(filedesc != NULL);
+    int fid = filedesc->fid;
+
+    /* large writes, and all writes when every write is synced,
+     * go straight to the log */
+    if ((count >= unifyfs_write_combine_size) || unifyfs_write_sync) {
+        return unifyfs_fid_write(fid, pos, buf, count, nwritten);
+    }
+
+    /* short-circuit a 0-byte write */
+    if (count == 0) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
+    assert(meta != NULL);
+
+    if (meta->attrs.is_laminated) {
+        /* attempt to write to laminated file, return read-only filesystem */
+        return EROFS;
+    }
+
+    /* append to our buffered run if the write continues it */
+    if ((meta->wbuf_fd == fd) &&
+        (pos == (filedesc->wbuf_pos + (off_t)filedesc->wbuf_len)) &&
+        ((filedesc->wbuf_len + count) <= unifyfs_write_combine_size)) {
+        memcpy(filedesc->wbuf + filedesc->wbuf_len, buf, count);
+        filedesc->wbuf_len += count;
+        *nwritten = count;
+        return UNIFYFS_SUCCESS;
+    }
+
+    /* otherwise write out the buffered run for the file */
+    if (meta->wbuf_fd >= 0) {
+        rc = fd_flush_write_buffer(meta->wbuf_fd);
+        if (rc != UNIFYFS_SUCCESS) {
+            return rc;
+        }
+    }
+
+    /* and start a new run with this write */
+    if (NULL == filedesc->wbuf) {
+        filedesc->wbuf = malloc(unifyfs_write_combine_size);
+        if (NULL == filedesc->wbuf) {
+            /* no buffer, so write it directly */
+            return unifyfs_fid_write(fid, pos, buf, count, nwritten);
+        }
+    }
+    memcpy(filedesc->wbuf, buf, count);
+    filedesc->wbuf_pos = pos;
+    filedesc->wbuf_len = count;
+    meta->wbuf_fd = fd;
+
+    /* the file has data to sync, which flushes the buffer first */
+    meta->needs_sync = 1;
+
+    *nwritten = count;
+    return UNIFYFS_SUCCESS;
+}
+
+/* Write count bytes from buf into the file open on fd starting at offset
+ * pos. A write smaller than the write-combining buffer is held in the
+ * buffer of fd, as long as it continues the run of writes held there.
+ * Otherwise, the buffered run is written to the log first. Errors from
+ * writing buffered data to the log are returned by the flush, i.e., on
+ * a later write, sync, or close.
+ *
+ * Returns UNIFYFS_SUCCESS, or an error code
+ */
+int unifyfs_fd_write_combine(
+    int fd,           /* file descriptor to write to */
+    off_t pos,        /* starting position in file */
+    const void* buf,  /* buffer to be written */
+    size_t count,     /* number of bytes to write */
+    size_t* nwritten) /* returns number of bytes written */
+{
+    unifyfs_client_lock();
+    int rc = fd_write_combine(fd, pos, buf, count, nwritten);
+    unifyfs_client_unlock();
+    return rc;
+}
+
+/* truncate file id to given length, see unifyfs_fid_truncate() */
+static int fid_truncate(int fid, off_t length)
 {
     /* get meta data for this file */
     unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
@@ -1116,8 +1683,14 @@ int unifyfs_fid_truncate(int fid, off_t length)
         return EIO;
     }
 
+    /* buffered writes come before the truncate */
+    int rc = unifyfs_fid_flush_write_buffers(fid);
+    if (rc != UNIFYFS_SUCCESS) {
+        return rc;
+    }
+
     /* remove/update writes past truncation size for this file id */
-    int rc = truncate_write_meta(meta, length);
+    rc = truncate_write_meta(meta, length);
     if (rc != UNIFYFS_SUCCESS) {
         return rc;
     }
@@ -1133,7 +1706,7 @@ int unifyfs_fid_truncate(int fid, off_t length)
     meta->attrs.size = length;
 
     /* invoke truncate rpc */
-    int gfid = unifyfs_gfid_from_fid(fid);
+    int64_t gfid = unifyfs_gfid_from_fid(fid);
     rc = invoke_client_truncate_rpc(gfid, length);
     if (rc != UNIFYFS_SUCCESS) {
         return rc;
@@ -1142,6 +1715,19 @@ int unifyfs_fid_truncate(int fid, off_t length)
     return UNIFYFS_SUCCESS;
 }
 
+/* truncate file id to given length, frees resources if length is
+ * less than size and allocates and zero-fills new bytes if length
+ * is more than size */
+int unifyfs_fid_truncate(int fid, off_t length)
+{
+    uint64_t start_ns = unifyfs_stats_now_ns();
+    unifyfs_client_lock();
+    int rc = fid_truncate(fid, length);
+    unifyfs_client_unlock();
+    unifyfs_stats_record(UNIFYFS_STAT_CLIENT_TRUNCATE, start_ns);
+    return rc;
+}
+
 /* sync data for file id to server if needed */
 int unifyfs_fid_sync(int fid)
 {
@@ -1153,18 +1739,31 @@ int unifyfs_fid_sync(int fid)
     assert(meta != NULL);
 
     /* sync data with server */
+    unifyfs_client_lock();
     if (meta->needs_sync) {
+        uint64_t start_ns = unifyfs_stats_now_ns();
         ret = unifyfs_sync_extents(fid);
+        unifyfs_stats_record(UNIFYFS_STAT_CLIENT_SYNC, start_ns);
     }
+    unifyfs_client_unlock();
 
     return ret;
 }
 
-/* opens a new file id with specified path, access flags, and permissions,
- * fills outfid with file id and outpos with position for current file pointer,
- * returns UNIFYFS error code
- */
-int unifyfs_fid_open(
+/* the gfid is a hash of the path, so check that global attributes
+ * found for a gfid really belong to the given path */
+static int check_gfid_path(unifyfs_file_attr_t* gfattr, const char* path)
+{
+    if ((NULL != gfattr->filename) && (0 != strcmp(gfattr->filename, path))) {
+        LOGERR("gfid=%" PRId64 " of %s is in use by %s",
+               gfattr->gfid, path, gfattr->filename);
+        return UNIFYFS_ERROR_GFID;
+    }
+    return UNIFYFS_SUCCESS;
+}
+
+/* opens a new file id, see unifyfs_fid_open() */
+static int fid_open(
     const char* path, /* path of file to be opened */
     int flags,        /* flags bits as from open(2) */
     mode_t mode,      /* mode bits as from open(2) */
@@ -1191,8 +1790,9 @@ int unifyfs_fid_open(
 
     /* look for local and global file ids */
     int fid  = unifyfs_get_fid_from_path(path);
-    int gfid = unifyfs_generate_gfid(path);
-    LOGDBG("unifyfs_get_fid_from_path() gave %d (gfid = %d)", fid, gfid);
+    int64_t gfid = unifyfs_generate_gfid(path);
+    LOGDBG("unifyfs_get_fid_from_path() gave %d (gfid = %" PRId64 ")",
+           fid, gfid);
 
     /* test whether we have info for file in our local file list */
     int found_local = (fid >= 0);
@@ -1256,6 +1856,9 @@ int unifyfs_fid_open(
              * Another process beat us to the punch in creating it.
              * Read its metadata to update our cache. */
             ret = unifyfs_get_global_file_meta(gfid, &gfattr);
+            if (ret == UNIFYFS_SUCCESS) {
+                ret = check_gfid_path(&gfattr, path);
+            }
             if (ret == UNIFYFS_SUCCESS) {
                 if (found_local) {
                     /* TODO: check that global metadata is consistent with
@@ -1307,6 +1910,12 @@ int unifyfs_fid_open(
             return ret;
         }
 
+        /* make sure the file we found is this path */
+        ret = check_gfid_path(&gfattr, path);
+        if (ret != UNIFYFS_SUCCESS) {
+            return ret;
+        }
+
         /* succeeded in global lookup for file,
          * allocate a local file id structure if needed */
         if (!found_local) {
@@ -1402,6 +2011,25 @@ int unifyfs_fid_open(
     return UNIFYFS_SUCCESS;
 }
 
+/* opens a new file id with specified path, access flags, and permissions,
+ * fills outfid with file id and outpos with position for current file pointer,
+ * returns UNIFYFS error code
+ */
+int unifyfs_fid_open(
+    const char* path, /* path of file to be opened */
+    int flags,        /* flags bits as from open(2) */
+    mode_t mode,      /* mode bits as from open(2) */
+    int* outfid,      /* allocated local file id if open is successful */
+    off_t* outpos)    /* initial file position if open is successful */
+{
+    uint64_t start_ns = unifyfs_stats_now_ns();
+    unifyfs_client_lock();
+    int ret = fid_open(path, flags, mode, outfid, outpos);
+    unifyfs_client_unlock();
+    unifyfs_stats_record(UNIFYFS_STAT_CLIENT_OPEN, start_ns);
+    return ret;
+}
+
 int unifyfs_fid_close(int fid)
 {
     /* TODO: clear any held locks */
@@ -1410,13 +2038,13 @@ int unifyfs_fid_close(int fid)
     return UNIFYFS_SUCCESS;
 }
 
-/* unlink file and then delete its associated state */
-int unifyfs_fid_unlink(int fid)
+/* unlink a file, see unifyfs_fid_unlink() */
+static int fid_unlink(int fid)
 {
     int rc;
 
     /* invoke unlink rpc */
-    int gfid = unifyfs_gfid_from_fid(fid);
+    int64_t gfid = unifyfs_gfid_from_fid(fid);
     rc = invoke_client_unlink_rpc(gfid);
     if (rc != UNIFYFS_SUCCESS) {
         /* TODO: if item does not exist globally, but just locally,
@@ -1424,8 +2052,18 @@ int unifyfs_fid_unlink(int fid)
         return rc;
     }
 
+    /* drop any buffered writes, there is no file left to hold them */
+    unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
+    if ((NULL != meta) && (meta->wbuf_fd >= 0)) {
+        unifyfs_fd_t* filedesc = unifyfs_get_filedesc_from_fd(meta->wbuf_fd);
+        if (NULL != filedesc) {
+            filedesc->wbuf_len = 0;
+        }
+        meta->wbuf_fd = -1;
+    }
+
     /* finalize the storage we're using for this file */
-    rc = unifyfs_fid_delete(fid);
+    rc = fid_delete(fid);
     if (rc != UNIFYFS_SUCCESS) {
         /* released storage for file, but failed to release
          * structures tracking storage, again bail out to keep
@@ -1436,6 +2074,15 @@ int unifyfs_fid_unlink(int fid)
     return UNIFYFS_SUCCESS;
 }
 
+/* unlink file and then delete its associated state */
+int unifyfs_fid_unlink(int fid)
+{
+    unifyfs_client_lock();
+    int rc = fid_unlink(fid);
+    unifyfs_client_unlock();
+    return rc;
+}
+
 /* =======================================
  * Operations to mount/unmount file system
  * ======================================= */
@@ -1459,10 +2106,18 @@ int unifyfs_fid_unlink(int fid)
  *  - array of unifyfs_filemeta structs, indexed by local
  *    file id
  *
- *  - count of number of active index entries
- *  - array of index metadata to track physical offset
+ *    the file name and metadata arrays make up the file table. the
+ *    superblock is mapped without reserving memory, and memory for
+ *    table entries is reserved in chunks as file ids are handed out,
+ *    so the table only uses memory for files that have been created
+ *
+ *  - header of write index ring (head and tail counts)
+ *  - ring of index metadata to track physical offset
  *    of logical file data, of length unifyfs_max_index_entries,
  *    entries added during write operations
+ *
+ *  - page-aligned request queue to the server, which is only
+ *    used if client.shm_requests is enabled
  */
 
 /* compute memory size of superblock in bytes,
@@ -1473,8 +2128,9 @@ static size_t get_superblock_size(void)
     size_t sb_size = 0;
 
     /* header: uint32_t to hold magic number to indicate
-     * that superblock is initialized */
-    sb_size += sizeof(uint32_t);
+     * that superblock is initialized, followed by uint32_t
+     * file id high-water mark */
+    sb_size += 2 * sizeof(uint32_t);
 
     /* free file id stack */
     sb_size += unifyfs_stack_bytes(unifyfs_max_files);
@@ -1489,6 +2145,12 @@ static size_t get_superblock_size(void)
     sb_size += unifyfs_page_size;
     sb_size += unifyfs_max_index_entries * sizeof(unifyfs_index_t);
 
+    /* request queue, plus space to align it to a page */
+    if (unifyfs_shm_requests) {
+        sb_size += unifyfs_page_size;
+        sb_size += UNIFYFS_SHM_REQQ_SIZE;
+    }
+
     /* return number of bytes */
     return sb_size;
 }
@@ -1511,8 +2173,12 @@ static void init_superblock_pointers(void* superblock)
 {
     char* ptr = (char*)superblock;
 
-    /* jump over header (right now just a uint32_t to record
-     * magic value of 0xdeadbeef if initialized */
+    /* jump over magic value (a uint32_t to record
+     * magic value of 0xdeadbeef if initialized) */
+    ptr += sizeof(uint32_t);
+
+    /* file id high-water mark */
+    unifyfs_fid_hwm = (uint32_t*)ptr;
     ptr += sizeof(uint32_t);
 
     /* stack to manage free file ids */
@@ -1527,14 +2193,22 @@ static void init_superblock_pointers(void* superblock)
     unifyfs_filemetas = (unifyfs_filemeta_t*)ptr;
     ptr += unifyfs_max_files * sizeof(unifyfs_filemeta_t);
 
-    /* record pointer to number of index entries */
-    unifyfs_indices.ptr_num_entries = (size_t*)ptr;
+    /* record pointer to header of index ring */
+    unifyfs_indices.ring = (unifyfs_index_ring_t*)ptr;
 
     /* pointer to array of index entries */
     ptr += unifyfs_page_size;
     unifyfs_indices.index_entry = (unifyfs_index_t*)ptr;
     ptr += unifyfs_max_index_entries * sizeof(unifyfs_index_t);
 
+    /* pointer to request queue */
+    unifyfs_shm_queue = NULL;
+    if (unifyfs_shm_requests) {
+        ptr = next_page_align(ptr);
+        unifyfs_shm_queue = (void*)ptr;
+        ptr += UNIFYFS_SHM_REQQ_SIZE;
+    }
+
     /* compute size of memory we're using and check that
      * it matches what we allocated */
     size_t ptr_size = (size_t)(ptr - (char*)superblock);
@@ -1546,17 +2220,18 @@ static void init_superblock_pointers(void* superblock)
 /* initialize data structures for first use */
 static int init_superblock_structures(void)
 {
-    int i;
-    for (i = 0; i < unifyfs_max_files; i++) {
-        /* indicate that file id is not in use by setting flag to 0 */
-        unifyfs_filelist[i].in_use = 0;
-    }
+    /* the file name and metadata arrays are left alone, a new shmem
+     * region is zero-filled, so every entry already reads as not in
+     * use. the free stack hands out low file ids first, which keeps
+     * the used, and reserved, part of the file table small */
+    *unifyfs_fid_hwm = 0;
 
     /* initialize stack of free file ids */
     unifyfs_stack_init(free_fid_stack, unifyfs_max_files);
 
-    /* initialize count of key/value entries */
-    *(unifyfs_indices.ptr_num_entries) = 0;
+    /* initialize write index ring to empty */
+    unifyfs_indices.ring->head = 0;
+    unifyfs_indices.ring->tail = 0;
 
     LOGDBG("Meta-stacks initialized!");
 
@@ -1571,7 +2246,7 @@ static int init_superblock_shm(size_t super_sz)
 
     /* attach shmem region for client's superblock */
     sprintf(shm_name, SHMEM_SUPER_FMTSTR, unifyfs_app_id, unifyfs_client_id);
-    shm_context* shm_ctx = unifyfs_shm_alloc(shm_name, super_sz);
+    shm_context* shm_ctx = unifyfs_shm_alloc_sparse(shm_name, super_sz);
     if (NULL == shm_ctx) {
         LOGERR("Failed to attach to shmem superblock region %s", shm_name);
         return UNIFYFS_ERROR_SHMEM;
@@ -1582,6 +2257,27 @@ static int init_superblock_shm(size_t super_sz)
     void* addr = shm_ctx->addr;
     init_superblock_pointers(addr);
 
+    /* reserve memory for everything but the file table, whose entries
+     * are reserved as file ids are handed out */
+    size_t table_start = (size_t)((char*)unifyfs_filelist - (char*)addr);
+    size_t table_end = (size_t)((char*)unifyfs_indices.ring - (char*)addr);
+    fid_reserved = 0;
+    if ((unifyfs_shm_reserve(shm_ctx, 0, table_start) != UNIFYFS_SUCCESS) ||
+        (unifyfs_shm_reserve(shm_ctx, table_end, shm_ctx->size - table_end)
+         != UNIFYFS_SUCCESS)) {
+        LOGERR("Failed to reserve shmem superblock region %s", shm_name);
+        unifyfs_shm_free(&shm_super_ctx);
+        return UNIFYFS_ERROR_SHMEM;
+    }
+
+    /* metadata cached before this superblock was attached is stale */
+    meta_cache_reset(meta_cache_current_epoch());
+
+    /* drop any requests an earlier client left in the queue */
+    if (unifyfs_shm_requests) {
+        client_shm_queue_init(unifyfs_shm_queue);
+    }
+
     /* initialize structures in superblock if it's newly allocated,
      * we depend on shm_open setting all bytes to 0 to know that
      * it is not initialized */
@@ -1609,11 +2305,23 @@ static int init_superblock_shm(size_t super_sz)
          * any entries to the server, but we can't do that since that will
          * try to rewrite the index using the trees, which point to invalid
          * memory at this point. */
-        /* initialize count of key/value entries */
-        *(unifyfs_indices.ptr_num_entries) = 0;
+        /* reset write index ring to empty */
+        unifyfs_indices.ring->head = 0;
+        unifyfs_indices.ring->tail = 0;
+
+        /* entries beyond the high-water mark were never used */
+        int max_fid = (int)*unifyfs_fid_hwm;
+        if (max_fid > unifyfs_max_files) {
+            max_fid = unifyfs_max_files;
+        }
+
+        /* the earlier run reserved the entries it used */
+        if (fid_table_reserve(max_fid) != UNIFYFS_SUCCESS) {
+            return UNIFYFS_ERROR_SHMEM;
+        }
 
         int i;
-        for (i = 0; i < unifyfs_max_files; i++) {
+        for (i = 0; i < max_fid; i++) {
             /* if the file entry is active, reset its segment trees */
             if (unifyfs_filelist[i].in_use) {
                 /* got a live file, get pointer to its metadata */
@@ -1623,11 +2331,17 @@ static int init_superblock_shm(size_t super_sz)
                 /* Reset our segment tree that will record our writes */
                 seg_tree_init(&meta->extents_sync);
 
+                /* write-combining buffers of the last run are gone */
+                meta->wbuf_fd = -1;
+
                 /* Reset our segment tree to track extents for all writes
                  * by this process, can be used to read back local data */
                 if (unifyfs_local_extents) {
                     seg_tree_init(&meta->extents);
                 }
+
+                /* rebuild lookup indexes for the file */
+                fid_index_add(i, meta->attrs.gfid);
             }
         }
     }
@@ -1636,6 +2350,20 @@ static int init_superblock_shm(size_t super_sz)
     return UNIFYFS_SUCCESS;
 }
 
+/* refresh the statistics gauges for our log */
+static void update_client_stats(void)
+{
+    off_t shmem_size, shmem_used, spill_size, spill_used;
+    if ((NULL != logio_ctx) &&
+        (unifyfs_logio_get_sizes(logio_ctx, &shmem_size, &spill_size) == 0) &&
+        (unifyfs_logio_get_usage(logio_ctx, &shmem_used, &spill_used) == 0)) {
+        unifyfs_stats_set_gauge(UNIFYFS_STAT_LOGIO_SHMEM_SIZE, shmem_size);
+        unifyfs_stats_set_gauge(UNIFYFS_STAT_LOGIO_SHMEM_USED, shmem_used);
+        unifyfs_stats_set_gauge(UNIFYFS_STAT_LOGIO_SPILL_SIZE, spill_size);
+        unifyfs_stats_set_gauge(UNIFYFS_STAT_LOGIO_SPILL_USED, spill_used);
+    }
+}
+
 int unifyfs_init(unifyfs_cfg_t* clnt_cfg)
 {
     int rc;
@@ -1735,6 +2463,47 @@ int unifyfs_init(unifyfs_cfg_t* clnt_cfg)
             }
         }
 
+        /* Determine default size of stdio stream buffers */
+        unifyfs_stream_bufsize = UNIFYFS_CLIENT_STREAM_BUFSIZE;
+        cfgval = clnt_cfg->client_stream_buf_size;
+        if (cfgval != NULL) {
+            rc = configurator_int_val(cfgval, &l);
+            if ((rc == 0) && (l > 0)) {
+                unifyfs_stream_bufsize = (size_t)l;
+            }
+        }
+
+        /* Determine number of buffers used to overlap reads and writes
+         * of a file transfer, and number of files transferred at once
+         * by background transfers */
+        unifyfs_transfer_depth = UNIFYFS_CLIENT_TRANSFER_DEPTH;
+        cfgval = clnt_cfg->client_transfer_depth;
+        if (cfgval != NULL) {
+            rc = configurator_int_val(cfgval, &l);
+            if ((rc == 0) && (l > 0)) {
+                unifyfs_transfer_depth = (int)l;
+            }
+        }
+        unifyfs_transfer_threads = UNIFYFS_CLIENT_TRANSFER_THREADS;
+        cfgval = clnt_cfg->client_transfer_threads;
+        if (cfgval != NULL) {
+            rc = configurator_int_val(cfgval, &l);
+            if ((rc == 0) && (l > 0)) {
+                unifyfs_transfer_threads = (int)l;
+            }
+        }
+
+        /* Determine whether servers write laminated files to their
+         * stage-out destination directly from their local logs */
+        unifyfs_transfer_server = false;
+        cfgval = clnt_cfg->client_transfer_server;
+        if (cfgval != NULL) {
+            rc = configurator_bool_val(cfgval, &b);
+            if (rc == 0) {
+                unifyfs_transfer_server = (bool)b;
+            }
+        }
+
         /* Determine whether we automatically sync every write to server.
          * This slows write performance, but it can serve as a work
          * around for apps that do not have all necessary syncs. */
@@ -1747,6 +2516,28 @@ int unifyfs_init(unifyfs_cfg_t* clnt_cfg)
             }
         }
 
+        /* Determine whether we send common requests to the server
+         * through a queue in shared memory instead of as RPCs */
+        unifyfs_shm_requests = false;
+        cfgval = clnt_cfg->client_shm_requests;
+        if (cfgval != NULL) {
+            rc = configurator_bool_val(cfgval, &b);
+            if (rc == 0) {
+                unifyfs_shm_requests = (bool)b;
+            }
+        }
+
+        /* Determine size of per-fd buffer used to combine small
+         * contiguous writes, writes are not combined by default */
+        unifyfs_write_combine_size = 0;
+        cfgval = clnt_cfg->client_write_buf_size;
+        if (cfgval != NULL) {
+            rc = configurator_int_val(cfgval, &l);
+            if ((rc == 0) && (l > 0)) {
+                unifyfs_write_combine_size = (size_t)l;
+            }
+        }
+
         /* Determine SUPER MAGIC value to return from statfs.
          * Use UNIFYFS_SUPER_MAGIC if true, TMPFS_SUPER_MAGIC otherwise. */
         unifyfs_super_magic = true;
@@ -1816,6 +2607,14 @@ int unifyfs_init(unifyfs_cfg_t* clnt_cfg)
         unifyfs_dirstream_stack = malloc(free_dirstream_size);
         unifyfs_stack_init(unifyfs_dirstream_stack, num_dirstreams);
 
+        /* allocate file table index entries */
+        fid_index_entries = calloc((size_t)unifyfs_max_files,
+                                   sizeof(unifyfs_fid_index_t));
+        if (NULL == fid_index_entries) {
+            LOGERR("failed to allocate file table index");
+            return ENOMEM;
+        }
+
         /* determine the size of the superblock */
         size_t shm_super_size = get_superblock_size();
 
@@ -1843,6 +2642,35 @@ int unifyfs_init(unifyfs_cfg_t* clnt_cfg)
             return rc;
         }
 
+        /* set up statistics, optionally dumped periodically */
+        unifyfs_stats_init("unifyfs-client", update_client_stats);
+        cfgval = clnt_cfg->stats_dump_interval;
+        if (cfgval != NULL) {
+            rc = configurator_int_val(cfgval, &l);
+            if ((rc == 0) && (l > 0)) {
+                rc = unifyfs_stats_dump_start(clnt_cfg->stats_dump_dir,
+                                              (int)l);
+                if (rc != UNIFYFS_SUCCESS) {
+                    LOGERR("failed to start statistics dumps");
+                }
+            }
+        }
+
+        /* trace a sample of our requests */
+        l = 0;
+        cfgval = clnt_cfg->trace_sample_rate;
+        if (cfgval != NULL) {
+            rc = configurator_int_val(cfgval, &l);
+            if (rc != 0) {
+                l = 0;
+            }
+        }
+        rc = unifyfs_trace_init("unifyfs-client", (int)l,
+                                clnt_cfg->trace_dir);
+        if (rc != UNIFYFS_SUCCESS) {
+            LOGERR("failed to start request tracing");
+        }
+
         /* remember that we've now initialized the library */
         unifyfs_initialized = 1;
     }
@@ -1862,6 +2690,10 @@ int unifyfs_fini(void)
         return UNIFYFS_FAILURE;
     }
 
+    /* write final statistics and traces before tearing down the log */
+    unifyfs_trace_fini();
+    unifyfs_stats_dump_stop();
+
     /* close spillover files */
     if (NULL != logio_ctx) {
         unifyfs_logio_close(logio_ctx, 0);
@@ -1872,10 +2704,20 @@ int unifyfs_fini(void)
         unifyfs_spillmetablock = -1;
     }
 
+    /* stop using the request queue before we detach from it */
+    client_shm_queue_enable(0);
+
     /* detach from superblock shmem, but don't unlink the file so that
      * a later client can reattach. */
     unifyfs_shm_free(&shm_super_ctx);
 
+    /* free file table indexes */
+    fid_index_clear();
+    if (fid_index_entries != NULL) {
+        free(fid_index_entries);
+        fid_index_entries = NULL;
+    }
+
     /* free directory stream stack */
     if (unifyfs_dirstream_stack != NULL) {
         free(unifyfs_dirstream_stack);
@@ -1917,7 +2759,7 @@ void fill_client_mount_info(unifyfs_cfg_t* clnt_cfg,
 void fill_client_attach_info(unifyfs_cfg_t* clnt_cfg,
                              unifyfs_attach_in_t* in)
 {
-    size_t meta_offset = (char*)unifyfs_indices.ptr_num_entries -
+    size_t meta_offset = (char*)unifyfs_indices.ring -
                          (char*)shm_super_ctx->addr;
     size_t meta_size   = unifyfs_max_index_entries
                          * sizeof(unifyfs_index_t);
@@ -1927,6 +2769,13 @@ void fill_client_attach_info(unifyfs_cfg_t* clnt_cfg,
     in->shmem_super_size  = shm_super_ctx->size;
     in->meta_offset       = meta_offset;
     in->meta_size         = meta_size;
+    in->reqq_offset       = 0;
+    in->reqq_size         = 0;
+    if (unifyfs_shm_requests) {
+        in->reqq_offset   = (char*)unifyfs_shm_queue -
+                            (char*)shm_super_ctx->addr;
+        in->reqq_size     = UNIFYFS_SHM_REQQ_SIZE;
+    }
 
     if (NULL != logio_ctx->shmem) {
         in->logio_mem_size = logio_ctx->shmem->size;
@@ -1995,13 +2844,25 @@ int unifyfs_mount(
         }
     }
 
+    // write log messages from a background thread
+    cfgval = client_cfg.log_async;
+    if (cfgval != NULL) {
+        bool b;
+        rc = configurator_bool_val(cfgval, &b);
+        if ((rc == 0) && b) {
+            if (unifyfs_log_async_start() != UNIFYFS_SUCCESS) {
+                LOGERR("failed to start log thread");
+            }
+        }
+    }
+
     // record mountpoint prefix string
     unifyfs_mount_prefix = strdup(prefix);
     unifyfs_mount_prefixlen = strlen(unifyfs_mount_prefix);
     client_cfg.unifyfs_mountpoint = unifyfs_mount_prefix;
 
     // generate app_id from mountpoint prefix
-    unifyfs_app_id = unifyfs_generate_gfid(unifyfs_mount_prefix);
+    unifyfs_app_id = unifyfs_generate_app_id(unifyfs_mount_prefix);
     if (l_app_id != 0) {
         LOGDBG("ignoring passed app_id=%d, using mountpoint app_id=%d",
                l_app_id, unifyfs_app_id);
@@ -2053,6 +2914,11 @@ int unifyfs_mount(
         return rc;
     }
 
+    /* the server now takes requests from our request queue */
+    if (unifyfs_shm_requests) {
+        client_shm_queue_enable(1);
+    }
+
     /* add mount point as a new directory in the file list */
     int fid = unifyfs_get_fid_from_path(prefix);
     if (fid < 0) {
@@ -2086,6 +2952,9 @@ int unifyfs_unmount(void)
         return UNIFYFS_SUCCESS;
     }
 
+    /* stop background transfers */
+    client_transfer_fini();
+
     /* sync any outstanding writes */
     LOGDBG("syncing data");
     int rc = unifyfs_sync_extents(-1);
@@ -2098,6 +2967,10 @@ int unifyfs_unmount(void)
      * tear down connection to server
      ************************/
 
+    /* send remaining requests as rpcs, our request manager thread at
+     * the server stops when we disconnect */
+    client_shm_queue_enable(0);
+
     /* invoke unmount rpc to tell server we're disconnecting */
     LOGDBG("calling unmount");
     rc = invoke_client_unmount_rpc();
@@ -13,6 +13,8 @@
  */
 
 #include "unifyfs_api_internal.h"
+#include "client_transfer.h"
+#include "unifyfs_stats.h"
 
 /*
  * Public Methods
@@ -38,7 +40,7 @@ unifyfs_rc unifyfs_initialize(const char* mountpoint,
         LOGERR("failed to allocate client handle");
         return ENOMEM;
     }
-    unifyfs_app_id = unifyfs_generate_gfid(mountpoint);
+    unifyfs_app_id = unifyfs_generate_app_id(mountpoint);
     client->app_id = unifyfs_app_id;
 
     // initialize configuration
@@ -63,6 +65,18 @@ unifyfs_rc unifyfs_initialize(const char* mountpoint,
         }
     }
 
+    // write log messages from a background thread
+    cfgval = client_cfg->log_async;
+    if (cfgval != NULL) {
+        bool b;
+        rc = configurator_bool_val(cfgval, &b);
+        if ((rc == 0) && b) {
+            if (unifyfs_log_async_start() != UNIFYFS_SUCCESS) {
+                LOGERR("failed to start log thread");
+            }
+        }
+    }
+
     // initialize k-v store access
     int kv_rank = 0;
     int kv_nranks = 1;
@@ -139,6 +153,9 @@ unifyfs_rc unifyfs_finalize(unifyfs_handle fshdl)
     int ret = UNIFYFS_SUCCESS;
 
     if (client->is_mounted) {
+        /* stop background transfers */
+        client_transfer_fini();
+
         /* sync any outstanding writes */
         LOGDBG("syncing data");
         int rc = unifyfs_sync_extents(-1);
@@ -202,3 +219,33 @@ unifyfs_rc unifyfs_finalize(unifyfs_handle fshdl)
 
     return ret;
 }
+
+/* Get a JSON snapshot of the statistics of the local server */
+unifyfs_rc unifyfs_get_server_stats(unifyfs_handle fshdl,
+                                    char** json)
+{
+    if ((UNIFYFS_INVALID_HANDLE == fshdl) || (NULL == json)) {
+        return EINVAL;
+    }
+    *json = NULL;
+
+    unifyfs_client* client = fshdl;
+    if (!client->is_mounted) {
+        return UNIFYFS_FAILURE;
+    }
+
+    return (unifyfs_rc) invoke_client_stats_rpc(json);
+}
+
+/* Get a JSON snapshot of the statistics of this client process */
+unifyfs_rc unifyfs_get_client_stats(unifyfs_handle fshdl,
+                                    char** json)
+{
+    if ((UNIFYFS_INVALID_HANDLE == fshdl) || (NULL == json)) {
+        return EINVAL;
+    }
+    *json = NULL;
+
+    size_t json_len;
+    return (unifyfs_rc) unifyfs_stats_to_json(json, &json_len);
+}
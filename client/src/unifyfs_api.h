@@ -43,7 +43,7 @@ typedef struct unifyfs_client* unifyfs_handle;
 
 
 /* global file id type */
-typedef uint32_t unifyfs_gfid;
+typedef uint64_t unifyfs_gfid;
 
 /* a valid gfid generated via MD5 hash will never be zero */
 #define UNIFYFS_INVALID_GFID ((unifyfs_gfid)0)
@@ -206,6 +206,25 @@ unifyfs_rc unifyfs_stat(unifyfs_handle fshdl,
                         const unifyfs_gfid gfid,
                         unifyfs_status* st);
 
+/*
+ * Get global file status for many files using a single request to the
+ * server, which looks up the files concurrently. Unlike unifyfs_stat(),
+ * the files do not need to be open by this client.
+ *
+ * @param[in]   fshdl       Client file system handle
+ * @param[in]   num_files   Number of files
+ * @param[in]   gfids       Array of global file ids of target files
+ * @param[out]  sts         Array of file status structures
+ * @param[out]  rcs         Array of per-file UnifyFS success or failure codes
+ *
+ * @return      UnifyFS success or failure code
+ */
+unifyfs_rc unifyfs_stat_many(unifyfs_handle fshdl,
+                             const size_t num_files,
+                             const unifyfs_gfid* gfids,
+                             unifyfs_status* sts,
+                             unifyfs_rc* rcs);
+
 /*
  * Synchronize client writes with global metadata. After successful
  * completion, writes will be visible to other clients.
@@ -333,6 +352,32 @@ unifyfs_rc unifyfs_wait_transfer(unifyfs_handle fshdl,
                                  unifyfs_transfer_request* reqs,
                                  const int waitall);
 
+/*
+ * Get a snapshot of the performance counters and latency histograms
+ * of the local server, as a JSON object string. On success, *json is
+ * allocated and should be freed by the caller.
+ *
+ * @param[in]   fshdl       Client file system handle
+ * @param[out]  json        JSON statistics string
+ *
+ * @return      UnifyFS success or failure code
+ */
+unifyfs_rc unifyfs_get_server_stats(unifyfs_handle fshdl,
+                                    char** json);
+
+/*
+ * Get a snapshot of the performance counters and latency histograms
+ * of this client process, as a JSON object string. On success, *json is
+ * allocated and should be freed by the caller.
+ *
+ * @param[in]   fshdl       Client file system handle
+ * @param[out]  json        JSON statistics string
+ *
+ * @return      UnifyFS success or failure code
+ */
+unifyfs_rc unifyfs_get_client_stats(unifyfs_handle fshdl,
+                                    char** json);
+
 
 #ifdef __cplusplus
 } // extern "C"
@@ -84,7 +84,7 @@ unifyfs_rc unifyfs_sync(unifyfs_handle fshdl,
         return (unifyfs_rc)EINVAL;
     }
 
-    int fid = unifyfs_fid_from_gfid((int)gfid);
+    int fid = unifyfs_fid_from_gfid(gfid);
     if (-1 == fid) {
         return (unifyfs_rc)EINVAL;
     }
@@ -104,24 +104,26 @@ unifyfs_rc unifyfs_stat(unifyfs_handle fshdl,
         return (unifyfs_rc)EINVAL;
     }
 
-    int fid = unifyfs_fid_from_gfid((int)gfid);
+    int fid = unifyfs_fid_from_gfid(gfid);
     if (-1 == fid) {
         return (unifyfs_rc)EINVAL;
     }
 
     unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
     if (meta == NULL) {
-        LOGERR("missing local file metadata for gfid=%d", (int)gfid);
+        LOGERR("missing local file metadata for gfid=%" PRId64, gfid);
         return UNIFYFS_FAILURE;
     }
 
     /* get global metadata to pick up current file size */
     unifyfs_file_attr_t attr = {0};
-    int rc = unifyfs_get_global_file_meta((int)gfid, &attr);
+    int rc = unifyfs_gfid_stat(gfid, &attr);
     if (UNIFYFS_SUCCESS != rc) {
-        LOGERR("missing global file metadata for gfid=%d", (int)gfid);
+        LOGERR("missing global file metadata for gfid=%" PRId64, gfid);
     } else {
-        /* update local file metadata from global metadata */
+        /* update local file metadata from global metadata,
+         * the stat rpc does not return the filename */
+        attr.filename = meta->attrs.filename;
         unifyfs_fid_update_file_meta(fid, &attr);
     }
 
@@ -135,6 +137,69 @@ unifyfs_rc unifyfs_stat(unifyfs_handle fshdl,
     return UNIFYFS_SUCCESS;
 }
 
+/* Get global file status for many files using a single server request */
+unifyfs_rc unifyfs_stat_many(unifyfs_handle fshdl,
+                             const size_t num_files,
+                             const unifyfs_gfid* gfids,
+                             unifyfs_status* sts,
+                             unifyfs_rc* rcs)
+{
+    if ((UNIFYFS_INVALID_HANDLE == fshdl)
+        || (0 == num_files)
+        || (num_files > INT32_MAX)
+        || (NULL == gfids)
+        || (NULL == sts)
+        || (NULL == rcs)) {
+        return (unifyfs_rc)EINVAL;
+    }
+
+    unifyfs_stat_result_t* results = calloc(num_files, sizeof(*results));
+    if (NULL == results) {
+        return (unifyfs_rc)ENOMEM;
+    }
+    for (size_t i = 0; i < num_files; i++) {
+        results[i].gfid = (int64_t) gfids[i];
+    }
+
+    int rc = invoke_client_stat_many_rpc((int)num_files, results);
+    if (UNIFYFS_SUCCESS != rc) {
+        LOGERR("stat-many rpc for %zu files failed", num_files);
+        free(results);
+        return (unifyfs_rc)rc;
+    }
+
+    for (size_t i = 0; i < num_files; i++) {
+        unifyfs_stat_result_t* res = results + i;
+        unifyfs_status* st = sts + i;
+        memset(st, 0, sizeof(*st));
+        rcs[i] = (unifyfs_rc) res->rc;
+        if (UNIFYFS_SUCCESS != res->rc) {
+            continue;
+        }
+
+        /* update local file metadata, if we have the file open */
+        int fid = unifyfs_fid_from_gfid(res->gfid);
+        if (-1 != fid) {
+            unifyfs_filemeta_t* meta = unifyfs_get_meta_from_fid(fid);
+            if (NULL != meta) {
+                res->attr.filename = meta->attrs.filename;
+                unifyfs_fid_update_file_meta(fid, &(res->attr));
+            }
+        }
+
+        st->global_file_size = (off_t) res->attr.size;
+        st->laminated = res->attr.is_laminated;
+        st->mode = (int) res->attr.mode;
+
+        /* TODO - need new metadata fields to track these */
+        st->local_file_size = (off_t) res->attr.size;
+        st->local_write_nbytes = 0;
+    }
+
+    free(results);
+    return UNIFYFS_SUCCESS;
+}
+
 /* Global lamination - no further writes to file are permitted */
 unifyfs_rc unifyfs_laminate(unifyfs_handle fshdl,
                             const char* filepath)
@@ -144,17 +209,17 @@ unifyfs_rc unifyfs_laminate(unifyfs_handle fshdl,
         return (unifyfs_rc)EINVAL;
     }
 
-    int gfid = unifyfs_generate_gfid(filepath);
+    int64_t gfid = unifyfs_generate_gfid(filepath);
     int rc = invoke_client_laminate_rpc(gfid);
     if (UNIFYFS_SUCCESS == rc) {
         /* update the local state for this file (if any) */
-        int fid = unifyfs_fid_from_gfid((int)gfid);
+        int fid = unifyfs_fid_from_gfid(gfid);
         if (-1 != fid) {
             /* get global metadata to pick up file size and laminated flag */
             unifyfs_file_attr_t attr = {0};
             rc = unifyfs_get_global_file_meta(gfid, &attr);
             if (UNIFYFS_SUCCESS != rc) {
-                LOGERR("missing global metadata for %s (gfid:%d)",
+                LOGERR("missing global metadata for %s (gfid:%" PRId64 ")",
                        filepath, gfid);
             } else {
                 /* update local file metadata from global metadata */
@@ -178,7 +243,7 @@ unifyfs_rc unifyfs_remove(unifyfs_handle fshdl,
     unifyfs_rc ret = UNIFYFS_SUCCESS;
 
     /* invoke unlink rpc */
-    int gfid = unifyfs_generate_gfid(filepath);
+    int64_t gfid = unifyfs_generate_gfid(filepath);
     int rc = invoke_client_unlink_rpc(gfid);
     if (rc != UNIFYFS_SUCCESS) {
         ret = rc;
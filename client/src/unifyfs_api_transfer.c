@@ -16,11 +16,6 @@
 #include "unifyfs_api_internal.h"
 #include "client_transfer.h"
 
-/* this avoids a #include of <unifyfs.h> */
-extern int unifyfs_transfer_file(const char* src,
-                                 const char* dst,
-                                 int parallel);
-
 /*
  * Public Methods
  */
@@ -40,10 +35,10 @@ unifyfs_rc unifyfs_dispatch_transfer(unifyfs_handle fshdl,
         return EINVAL;
     }
 
+    /* requests run in the background, see client_transfer_submit() */
     unifyfs_transfer_request* req;
     for (size_t i = 0; i < nreqs; i++) {
         req = reqs + i;
-        req->state = UNIFYFS_IOREQ_STATE_IN_PROGRESS;
 
         /* check for a valid transfer mode */
         switch (req->mode) {
@@ -57,28 +52,12 @@ unifyfs_rc unifyfs_dispatch_transfer(unifyfs_handle fshdl,
             continue;
         }
 
-        int rc = unifyfs_transfer_file(req->src_path, req->dst_path,
-                                       req->use_parallel);
-        if (rc) {
-            /* unifyfs_transfer_file() returns a negative error code */
-            req->result.error = -rc;
+        int rc = client_transfer_submit(req);
+        if (rc != UNIFYFS_SUCCESS) {
+            req->result.error = rc;
             req->result.rc = UNIFYFS_FAILURE;
-        } else {
-            req->result.error = 0;
-            req->result.rc = UNIFYFS_SUCCESS;
-
-            if (req->mode == UNIFYFS_TRANSFER_MODE_MOVE) {
-                /* successful copy, now remove source */
-                errno = 0;
-                rc = unlink(req->src_path);
-                if (rc) {
-                    req->result.error = errno;
-                    req->result.rc = UNIFYFS_FAILURE;
-                }
-            }
+            req->state = UNIFYFS_IOREQ_STATE_COMPLETED;
         }
-
-        req->state = UNIFYFS_IOREQ_STATE_COMPLETED;
     }
 
     return UNIFYFS_SUCCESS;
@@ -99,7 +78,13 @@ unifyfs_rc unifyfs_cancel_transfer(unifyfs_handle fshdl,
         return EINVAL;
     }
 
-    return UNIFYFS_ERROR_NYI;
+    /* the request state is checked under the transfer engine's lock,
+     * requests that are already done are left alone */
+    for (size_t i = 0; i < nreqs; i++) {
+        client_transfer_cancel(reqs + i);
+    }
+
+    return UNIFYFS_SUCCESS;
 }
 
 /* Wait for an array of transfer requests to be completed/canceled */
@@ -118,27 +103,5 @@ unifyfs_rc unifyfs_wait_transfer(unifyfs_handle fshdl,
         return EINVAL;
     }
 
-    size_t i, n_done;
-    while (1) {
-        n_done = 0;
-        for (i = 0; i < nreqs; i++) {
-            unifyfs_transfer_request* req = reqs + i;
-            if ((req->state == UNIFYFS_IOREQ_STATE_CANCELED) ||
-                (req->state == UNIFYFS_IOREQ_STATE_COMPLETED)) {
-                n_done++;
-            }
-        }
-        if (waitall) {
-            /* for waitall, all reqs must be done to finish */
-            if (n_done == nreqs) {
-                break;
-            }
-        } else if (n_done) {
-            /* at least one req is done */
-            break;
-        }
-        usleep(1000); /* sleep 1 ms */
-    }
-
-    return UNIFYFS_SUCCESS;
+    return client_transfer_wait(nreqs, reqs, waitall);
 }
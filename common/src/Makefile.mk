@@ -14,6 +14,8 @@ UNIFYFS_COMMON_BASE_SRCS = \
   %reldir%/rm_enumerator.c \
   %reldir%/seg_tree.h \
   %reldir%/seg_tree.c \
+  %reldir%/slab_cache.h \
+  %reldir%/slab_cache.c \
   %reldir%/slotmap.h \
   %reldir%/slotmap.c \
   %reldir%/tinyexpr.h \
@@ -26,6 +28,7 @@ UNIFYFS_COMMON_BASE_SRCS = \
   %reldir%/unifyfs_keyval.c \
   %reldir%/unifyfs_log.h \
   %reldir%/unifyfs_log.c \
+  %reldir%/unifyfs_log_async.c \
   %reldir%/unifyfs_logio.h \
   %reldir%/unifyfs_logio.c \
   %reldir%/unifyfs_meta.h \
@@ -41,6 +44,10 @@ UNIFYFS_COMMON_BASE_SRCS = \
   %reldir%/unifyfs_rc.c \
   %reldir%/unifyfs_shm.h \
   %reldir%/unifyfs_shm.c \
+  %reldir%/unifyfs_stats.h \
+  %reldir%/unifyfs_stats.c \
+  %reldir%/unifyfs_trace.h \
+  %reldir%/unifyfs_trace.c \
   %reldir%/unifyfs-stack.h \
   %reldir%/unifyfs-stack.c
 
@@ -52,6 +52,12 @@ compare_func(struct seg_tree_node* node1, struct seg_tree_node* node2)
 RB_PROTOTYPE(inttree, seg_tree_node, entry, compare_func)
 RB_GENERATE(inttree, seg_tree_node, entry, compare_func)
 
+/* Number of nodes in the first and largest slabs of the node allocator.
+ * Slabs double in size from the first up to the largest. The first slab
+ * is small so that a tree of a few segments holds little memory. */
+#define SEG_TREE_SLAB_MIN_NODES 4
+#define SEG_TREE_SLAB_MAX_NODES 8192
+
 /* Returns 0 on success, positive non-zero error code otherwise */
 int seg_tree_init(struct seg_tree* seg_tree)
 {
@@ -59,7 +65,9 @@ int seg_tree_init(struct seg_tree* seg_tree)
     pthread_rwlock_init(&seg_tree->rwlock, NULL);
     RB_INIT(&seg_tree->head);
 
-    return 0;
+    return slab_cache_init(&seg_tree->node_cache,
+        sizeof(struct seg_tree_node),
+        SEG_TREE_SLAB_MIN_NODES, SEG_TREE_SLAB_MAX_NODES);
 }
 
 /*
@@ -68,15 +76,18 @@ int seg_tree_init(struct seg_tree* seg_tree)
 void seg_tree_destroy(struct seg_tree* seg_tree)
 {
     seg_tree_clear(seg_tree);
+    slab_cache_destroy(&seg_tree->node_cache);
 }
 
-/* Allocate a node for the range tree.  Free node with free() when finished */
-static struct seg_tree_node*
-seg_tree_node_alloc(unsigned long start, unsigned long end, unsigned long ptr)
+/* Allocate a node for the range tree from the tree's node cache.
+ * Free node with seg_tree_node_free() when finished.
+ * Assumes caller has write lock on tree. */
+static struct seg_tree_node* seg_tree_node_alloc(
+    struct seg_tree* seg_tree,
+    unsigned long start, unsigned long end, unsigned long ptr)
 {
     /* allocate a new node structure */
-    struct seg_tree_node* node;
-    node = calloc(1, sizeof(*node));
+    struct seg_tree_node* node = slab_cache_alloc(&seg_tree->node_cache);
     if (!node) {
         return NULL;
     }
@@ -89,6 +100,15 @@ seg_tree_node_alloc(unsigned long start, unsigned long end, unsigned long ptr)
     return node;
 }
 
+/* Release a node back to the tree's node cache.
+ * Assumes caller has write lock on tree. */
+static inline void seg_tree_node_free(
+    struct seg_tree* seg_tree,
+    struct seg_tree_node* node)
+{
+    slab_cache_free(&seg_tree->node_cache, node);
+}
+
 /*
  * Given two start/end ranges, return a new range from start1/end1 that
  * does not overlap start2/end2.  The non-overlapping range is stored
@@ -162,15 +182,16 @@ int seg_tree_add(struct seg_tree* seg_tree, unsigned long start,
     unsigned long ptr_end;
     int ret;
 
+    /* Lock the tree so we can modify it */
+    seg_tree_wrlock(seg_tree);
+
     /* Create our range */
-    node = seg_tree_node_alloc(start, end, ptr);
+    node = seg_tree_node_alloc(seg_tree, start, end, ptr);
     if (!node) {
+        seg_tree_unlock(seg_tree);
         return ENOMEM;
     }
 
-    /* Lock the tree so we can modify it */
-    seg_tree_wrlock(seg_tree);
-
     /*
      * Try to insert our range into the RB tree.  If it overlaps with any other
      * range, then it is not inserted, and the overlapping range node is
@@ -194,7 +215,7 @@ int seg_tree_add(struct seg_tree* seg_tree, unsigned long start,
              * non-overlapping range.  Delete the existing range.
              */
             RB_REMOVE(inttree, &seg_tree->head, overlap);
-            free(overlap);
+            seg_tree_node_free(seg_tree, overlap);
             seg_tree->count--;
         } else {
             /*
@@ -204,10 +225,10 @@ int seg_tree_add(struct seg_tree* seg_tree, unsigned long start,
              * inserted without issue.  The remaining section will be processed
              * on the next pass of this while() loop.
              */
-            resized = seg_tree_node_alloc(new_start, new_end,
+            resized = seg_tree_node_alloc(seg_tree, new_start, new_end,
                 overlap->ptr + (new_start - overlap->start));
             if (!resized) {
-                free(node);
+                seg_tree_node_free(seg_tree, node);
                 rc = ENOMEM;
                 goto release_add;
             }
@@ -224,12 +245,12 @@ int seg_tree_add(struct seg_tree* seg_tree, unsigned long start,
                  * There's still a remaining section after the non-overlapping
                  * part.  Add it in.
                  */
-                remaining = seg_tree_node_alloc(
+                remaining = seg_tree_node_alloc(seg_tree,
                     resized->end + 1, overlap->end,
                     overlap->ptr + (resized->end + 1 - overlap->start));
                 if (!remaining) {
-                    free(node);
-                    free(resized);
+                    seg_tree_node_free(seg_tree, node);
+                    seg_tree_node_free(seg_tree, resized);
                     rc = ENOMEM;
                     goto release_add;
                 }
@@ -237,7 +258,7 @@ int seg_tree_add(struct seg_tree* seg_tree, unsigned long start,
 
             /* Remove our old range */
             RB_REMOVE(inttree, &seg_tree->head, overlap);
-            free(overlap);
+            seg_tree_node_free(seg_tree, overlap);
             seg_tree->count--;
 
             /* Insert the non-overlapping part of the new range */
@@ -286,7 +307,7 @@ int seg_tree_add(struct seg_tree* seg_tree, unsigned long start,
 
             /* Delete new extent from the tree and free it. */
             RB_REMOVE(inttree, &seg_tree->head, target);
-            free(target);
+            seg_tree_node_free(seg_tree, target);
             seg_tree->count--;
 
             /*
@@ -315,7 +336,7 @@ int seg_tree_add(struct seg_tree* seg_tree, unsigned long start,
 
             /* Delete next extent from the tree and free it. */
             RB_REMOVE(inttree, &seg_tree->head, next);
-            free(next);
+            seg_tree_node_free(seg_tree, next);
             seg_tree->count--;
         }
     }
@@ -351,7 +372,7 @@ int seg_tree_remove(
                  * remove whole extent */
                 LOGDBG("removing node [%lu, %lu]", node->start, node->end);
                 RB_REMOVE(inttree, &seg_tree->head, node);
-                free(node);
+                seg_tree_node_free(seg_tree, node);
                 seg_tree->count--;
             } else {
                 /* start <= node_s <= end < node_e
@@ -414,17 +435,15 @@ struct seg_tree_node* seg_tree_find_nolock(
     unsigned long end)
 {
     /* Create a range of just our starting byte offset */
-    struct seg_tree_node* node = seg_tree_node_alloc(start, start, 0);
-    if (!node) {
-        return NULL;
-    }
+    struct seg_tree_node node = {
+        .start = start,
+        .end = start,
+    };
 
     /* Search tree for either a range that overlaps with
      * the target range (starting byte), or otherwise the
      * node for the next biggest starting byte. */
-    struct seg_tree_node* next = RB_NFIND(inttree, &seg_tree->head, node);
-
-    free(node);
+    struct seg_tree_node* next = RB_NFIND(inttree, &seg_tree->head, &node);
 
     /* We may have found a node that doesn't include our starting
      * byte offset, but it would be the range with the lowest
@@ -553,29 +572,13 @@ seg_tree_unlock(struct seg_tree* seg_tree)
  */
 void seg_tree_clear(struct seg_tree* seg_tree)
 {
-    struct seg_tree_node* node = NULL;
-    struct seg_tree_node* oldnode = NULL;
-
     seg_tree_wrlock(seg_tree);
 
-    if (RB_EMPTY(&seg_tree->head)) {
-        /* seg_tree is empty, nothing to do */
-        seg_tree_unlock(seg_tree);
-        return;
-    }
-
-    /* Remove and free each node in the tree */
-    while ((node = seg_tree_iter(seg_tree, node))) {
-        if (oldnode) {
-            RB_REMOVE(inttree, &seg_tree->head, oldnode);
-            free(oldnode);
-        }
-        oldnode = node;
-    }
-    if (oldnode) {
-        RB_REMOVE(inttree, &seg_tree->head, oldnode);
-        free(oldnode);
-    }
+    /* All nodes come from the node cache, so drop the tree structure and
+     * release the node slabs in bulk rather than removing nodes one by
+     * one. */
+    RB_INIT(&seg_tree->head);
+    slab_cache_release(&seg_tree->node_cache);
 
     seg_tree->count = 0;
     seg_tree->max = 0;
@@ -599,3 +602,11 @@ unsigned long seg_tree_max(struct seg_tree* seg_tree)
     seg_tree_unlock(seg_tree);
     return max;
 }
+
+/* Fill in memory usage statistics for the nodes of the tree */
+void seg_tree_mem_stats(struct seg_tree* seg_tree, slab_cache_stats_t* stats)
+{
+    seg_tree_rdlock(seg_tree);
+    slab_cache_get_stats(&seg_tree->node_cache, stats);
+    seg_tree_unlock(seg_tree);
+}
@@ -16,6 +16,7 @@
 #define __SEG_TREE_H__
 
 #include <pthread.h>
+#include "slab_cache.h"
 #include "tree.h"
 
 struct seg_tree_node {
@@ -30,6 +31,7 @@ struct seg_tree {
     pthread_rwlock_t rwlock;
     unsigned long count;     /* number of segments stored in tree */
     unsigned long max;       /* maximum logical offset value in the tree */
+    struct slab_cache node_cache; /* allocator for tree nodes */
 };
 
 /* Returns 0 on success, positive non-zero error code otherwise */
@@ -112,6 +114,9 @@ unsigned long seg_tree_count(struct seg_tree* seg_tree);
 /* Return the maximum ending logical offset in the tree */
 unsigned long seg_tree_max(struct seg_tree* seg_tree);
 
+/* Fill in memory usage statistics for the nodes of the tree */
+void seg_tree_mem_stats(struct seg_tree* seg_tree, slab_cache_stats_t* stats);
+
 /*
  * Locking functions for use with seg_tree_iter().  They allow you to lock the
  * tree to iterate over it:
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2020, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2020, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "slab_cache.h"
+
+/* objects are aligned to pointer size, which also lets a freed object
+ * hold the free list link */
+#define SLAB_OBJ_ALIGN (sizeof(void*))
+
+/* size of the slab header, rounded up to keep objects aligned */
+#define SLAB_HDR_SIZE \
+    ((sizeof(struct slab) + SLAB_OBJ_ALIGN - 1) & ~(SLAB_OBJ_ALIGN - 1))
+
+int slab_cache_init(struct slab_cache* cache,
+                    size_t obj_size,
+                    size_t init_objs,
+                    size_t max_objs)
+{
+    if ((NULL == cache) || (0 == obj_size) || (0 == init_objs)) {
+        return EINVAL;
+    }
+
+    memset(cache, 0, sizeof(*cache));
+
+    if (obj_size < sizeof(void*)) {
+        obj_size = sizeof(void*);
+    }
+    cache->obj_size = (obj_size + SLAB_OBJ_ALIGN - 1) & ~(SLAB_OBJ_ALIGN - 1);
+
+    if (max_objs < init_objs) {
+        max_objs = init_objs;
+    }
+    cache->init_slab_objs = init_objs;
+    cache->slab_objs      = init_objs;
+    cache->max_slab_objs  = max_objs;
+
+    return 0;
+}
+
+/* allocate a new slab and make it the source of never-used objects */
+static int slab_cache_grow(struct slab_cache* cache)
+{
+    size_t nobjs = cache->slab_objs;
+    struct slab* s = malloc(SLAB_HDR_SIZE + (nobjs * cache->obj_size));
+    if (NULL == s) {
+        return ENOMEM;
+    }
+
+    s->num_objs  = nobjs;
+    s->next      = cache->slabs;
+    cache->slabs = s;
+
+    cache->next_obj = (char*)s + SLAB_HDR_SIZE;
+    cache->end_obj  = cache->next_obj + (nobjs * cache->obj_size);
+
+    cache->num_slabs++;
+    cache->total_objs += nobjs;
+
+    /* use bigger slabs as the cache grows, so that very large
+     * structures need few slabs while small ones waste little */
+    if (cache->slab_objs < cache->max_slab_objs) {
+        cache->slab_objs *= 2;
+        if (cache->slab_objs > cache->max_slab_objs) {
+            cache->slab_objs = cache->max_slab_objs;
+        }
+    }
+
+    return 0;
+}
+
+void* slab_cache_alloc(struct slab_cache* cache)
+{
+    void* obj;
+
+    if (NULL != cache->free_list) {
+        /* reuse a previously freed object */
+        obj = cache->free_list;
+        cache->free_list = *((void**)obj);
+    } else {
+        if (cache->next_obj == cache->end_obj) {
+            if (slab_cache_grow(cache) != 0) {
+                return NULL;
+            }
+        }
+        obj = cache->next_obj;
+        cache->next_obj += cache->obj_size;
+    }
+
+    cache->used_objs++;
+    memset(obj, 0, cache->obj_size);
+    return obj;
+}
+
+void slab_cache_free(struct slab_cache* cache, void* obj)
+{
+    if (NULL == obj) {
+        return;
+    }
+
+    *((void**)obj) = cache->free_list;
+    cache->free_list = obj;
+    cache->used_objs--;
+}
+
+void slab_cache_release(struct slab_cache* cache)
+{
+    struct slab* s = cache->slabs;
+    while (NULL != s) {
+        struct slab* next = s->next;
+        free(s);
+        s = next;
+    }
+
+    cache->slab_objs  = cache->init_slab_objs;
+    cache->slabs      = NULL;
+    cache->free_list  = NULL;
+    cache->next_obj   = NULL;
+    cache->end_obj    = NULL;
+    cache->num_slabs  = 0;
+    cache->total_objs = 0;
+    cache->used_objs  = 0;
+}
+
+void slab_cache_destroy(struct slab_cache* cache)
+{
+    slab_cache_release(cache);
+    memset(cache, 0, sizeof(*cache));
+}
+
+void slab_cache_get_stats(struct slab_cache* cache,
+                          slab_cache_stats_t* stats)
+{
+    stats->obj_size       = cache->obj_size;
+    stats->num_slabs      = cache->num_slabs;
+    stats->total_objs     = cache->total_objs;
+    stats->used_objs      = cache->used_objs;
+    stats->bytes_reserved = (cache->num_slabs * SLAB_HDR_SIZE) +
+                            (cache->total_objs * cache->obj_size);
+    stats->bytes_used     = cache->used_objs * cache->obj_size;
+}
+
+void slab_cache_stats_add(slab_cache_stats_t* dst,
+                          const slab_cache_stats_t* src)
+{
+    if (0 == dst->obj_size) {
+        dst->obj_size = src->obj_size;
+    }
+    dst->num_slabs      += src->num_slabs;
+    dst->total_objs     += src->total_objs;
+    dst->used_objs      += src->used_objs;
+    dst->bytes_reserved += src->bytes_reserved;
+    dst->bytes_used     += src->bytes_used;
+}
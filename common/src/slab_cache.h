@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2020, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2020, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#ifndef __SLAB_CACHE_H__
+#define __SLAB_CACHE_H__
+
+#include <stddef.h>
+
+/*
+ * slab_cache: a simple allocator for fixed-size objects.
+ *
+ * Objects are carved out of large slabs, and freed objects are kept on a
+ * free list for reuse. All slabs are released at once with
+ * slab_cache_release(), which makes clearing a large data structure
+ * O(number of slabs) rather than O(number of objects).
+ *
+ * NOTE: the cache does no locking itself. It is meant to be embedded in a
+ * data structure whose own lock is held when allocating or freeing objects.
+ */
+
+/* slab header, followed by the object storage */
+struct slab {
+    struct slab* next;      /* next slab in the cache */
+    size_t num_objs;        /* number of objects in this slab */
+};
+
+struct slab_cache {
+    size_t obj_size;        /* size of each object in bytes */
+    size_t init_slab_objs;  /* number of objects in first slab */
+    size_t slab_objs;       /* number of objects in next allocated slab */
+    size_t max_slab_objs;   /* upper limit on objects per slab */
+    struct slab* slabs;     /* list of allocated slabs */
+    void* free_list;        /* list of freed objects */
+    char* next_obj;         /* next never-used object in newest slab */
+    char* end_obj;          /* end of object storage in newest slab */
+    size_t num_slabs;       /* number of slabs allocated */
+    size_t total_objs;      /* total object capacity of all slabs */
+    size_t used_objs;       /* number of objects currently allocated */
+};
+
+/* memory usage statistics of a slab cache */
+typedef struct {
+    size_t obj_size;        /* size of each object in bytes */
+    size_t num_slabs;       /* number of slabs allocated */
+    size_t total_objs;      /* total object capacity */
+    size_t used_objs;       /* number of objects in use */
+    size_t bytes_reserved;  /* bytes of memory held by the cache */
+    size_t bytes_used;      /* bytes held by objects in use */
+} slab_cache_stats_t;
+
+/*
+ * Initialize a slab cache for objects of obj_size bytes. The first slab
+ * holds init_objs objects, and each later slab doubles in size up to
+ * max_objs objects. Returns 0 on success, errno otherwise.
+ */
+int slab_cache_init(struct slab_cache* cache,
+                    size_t obj_size,
+                    size_t init_objs,
+                    size_t max_objs);
+
+/* Return a zeroed object, or NULL if out of memory */
+void* slab_cache_alloc(struct slab_cache* cache);
+
+/* Return an object to the cache for reuse */
+void slab_cache_free(struct slab_cache* cache, void* obj);
+
+/*
+ * Release all slabs back to the system, invalidating every object
+ * allocated from the cache. The cache remains initialized for reuse.
+ */
+void slab_cache_release(struct slab_cache* cache);
+
+/* Release all slabs. The cache must be initialized again before reuse. */
+void slab_cache_destroy(struct slab_cache* cache);
+
+/* Fill in memory usage statistics for the cache */
+void slab_cache_get_stats(struct slab_cache* cache,
+                          slab_cache_stats_t* stats);
+
+/* Accumulate the statistics in src into dst */
+void slab_cache_stats_add(slab_cache_stats_t* dst,
+                          const slab_cache_stats_t* src);
+
+#endif /* __SLAB_CACHE_H__ */
@@ -234,8 +234,19 @@ ssize_t slotmap_reserve(slot_map* smap,
     }
     uint8_t* usemap = get_use_map(smap);
     size_t map_bytes = slot_map_bytes(smap->total_slots);
+
+    /* bits of the last use map byte past the last slot are never used,
+     * treat them as used when searching bits of that byte */
+    uint8_t tail_mask = 0;
+    if (SLOT_BIT(smap->total_slots)) {
+        tail_mask = (uint8_t)(0xFF << SLOT_BIT(smap->total_slots));
+    }
+
     for (size_t byte_ndx = search_start; byte_ndx < map_bytes; byte_ndx++) {
         uint8_t byte_val = usemap[byte_ndx];
+        if ((byte_ndx + 1) == map_bytes) {
+            byte_val |= tail_mask;
+        }
         if (byte_val == UINT8_MAX) {
             /* current byte is completely occupied */
             continue;
@@ -248,9 +259,11 @@ ssize_t slotmap_reserve(slot_map* smap,
                 run_count++;
                 byte_ndx++;
                 if (run_count == slot_bytes) {
-                    /* success */
+                    /* success, unless the run ends in a partial
+                     * last byte that is too short */
                     start_slot = BYTE_BIT_TO_SLOT(run_start, 0);
-                    found_start = 1;
+                    found_start = ((start_slot + num_slots) <=
+                                   smap->total_slots);
                     break;
                 }
             }
@@ -263,7 +276,8 @@ ssize_t slotmap_reserve(slot_map* smap,
                 /* success, can reserve all slots in this byte of use map */
                 assert(bit_in_byte != -1);
                 start_slot = BYTE_BIT_TO_SLOT(byte_ndx, bit_in_byte);
-                found_start = 1;
+                found_start = ((start_slot + num_slots) <=
+                               smap->total_slots);
             } else if ((byte_ndx + 1) < map_bytes) {
                 /* check if free bits are at the end of the byte */
                 find_consecutive_zero_bits(byte_val, free_bits, &bit_in_byte);
@@ -275,12 +289,16 @@ ssize_t slotmap_reserve(slot_map* smap,
                     size_t have_bits = free_bits;
                     size_t need_bits = num_slots - have_bits;
                     byte_val = usemap[byte_ndx + 1];
+                    if ((byte_ndx + 2) == map_bytes) {
+                        byte_val |= tail_mask;
+                    }
                     free_bits = find_consecutive_zero_bits(byte_val, need_bits,
                                                            &bit_in_byte2);
                     if ((free_bits >= need_bits) && (bit_in_byte2 == 0)) {
                         /* success, has enough free bits at start of byte */
                         start_slot = BYTE_BIT_TO_SLOT(byte_ndx, bit_in_byte);
-                        found_start = 1;
+                        found_start = ((start_slot + num_slots) <=
+                                       smap->total_slots);
                     }
                 }
             }
@@ -34,13 +34,18 @@ extern "C" {
 typedef enum {
     UNIFYFS_CLIENT_RPC_INVALID = 0,
     UNIFYFS_CLIENT_RPC_ATTACH,
+    UNIFYFS_CLIENT_RPC_EXTENT_MAP,
     UNIFYFS_CLIENT_RPC_FILESIZE,
     UNIFYFS_CLIENT_RPC_LAMINATE,
     UNIFYFS_CLIENT_RPC_METAGET,
     UNIFYFS_CLIENT_RPC_METASET,
     UNIFYFS_CLIENT_RPC_MOUNT,
     UNIFYFS_CLIENT_RPC_READ,
+    UNIFYFS_CLIENT_RPC_STAT,
+    UNIFYFS_CLIENT_RPC_STAT_MANY,
+    UNIFYFS_CLIENT_RPC_STATS,
     UNIFYFS_CLIENT_RPC_SYNC,
+    UNIFYFS_CLIENT_RPC_TRANSFER,
     UNIFYFS_CLIENT_RPC_TRUNCATE,
     UNIFYFS_CLIENT_RPC_UNLINK,
     UNIFYFS_CLIENT_RPC_UNMOUNT
@@ -55,6 +60,8 @@ MERCURY_GEN_PROC(unifyfs_attach_in_t,
                  ((hg_size_t)(shmem_super_size))
                  ((hg_size_t)(meta_offset))
                  ((hg_size_t)(meta_size))
+                 ((hg_size_t)(reqq_offset))
+                 ((hg_size_t)(reqq_size))
                  ((hg_size_t)(logio_mem_size))
                  ((hg_size_t)(logio_spill_size))
                  ((hg_const_string_t)(logio_spill_dir)))
@@ -103,12 +110,78 @@ DECLARE_MARGO_RPC_HANDLER(unifyfs_metaset_rpc)
 MERCURY_GEN_PROC(unifyfs_metaget_in_t,
                  ((int32_t)(app_id))
                  ((int32_t)(client_id))
-                 ((int32_t)(gfid)))
+                 ((int64_t)(gfid)))
 MERCURY_GEN_PROC(unifyfs_metaget_out_t,
                  ((int32_t)(ret))
                  ((unifyfs_file_attr_t)(attr)))
 DECLARE_MARGO_RPC_HANDLER(unifyfs_metaget_rpc)
 
+/* unifyfs_stat_rpc (client => server)
+ *
+ * given a global file id, return file metadata with an up-to-date
+ * file size, as known by the owner server of the file. if cacheable is
+ * set, the client may reuse the metadata until the metadata epoch in its
+ * superblock changes */
+MERCURY_GEN_PROC(unifyfs_stat_in_t,
+                 ((int32_t)(app_id))
+                 ((int32_t)(client_id))
+                 ((int64_t)(gfid)))
+MERCURY_GEN_PROC(unifyfs_stat_out_t,
+                 ((int32_t)(ret))
+                 ((int32_t)(cacheable))
+                 ((unifyfs_file_attr_t)(attr)))
+DECLARE_MARGO_RPC_HANDLER(unifyfs_stat_rpc)
+
+/* unifyfs_stat_many_rpc (client => server)
+ *
+ * given a count of files and a bulk data array of stat results
+ * (unifyfs_stat_result_t) with the gfid of each file filled in,
+ * look up the metadata of all files and push the filled in array back */
+MERCURY_GEN_PROC(unifyfs_stat_many_in_t,
+                 ((int32_t)(app_id))
+                 ((int32_t)(client_id))
+                 ((int32_t)(num_files))
+                 ((hg_size_t)(bulk_size))
+                 ((hg_bulk_t)(bulk_results)))
+MERCURY_GEN_PROC(unifyfs_stat_many_out_t, ((int32_t)(ret)))
+DECLARE_MARGO_RPC_HANDLER(unifyfs_stat_many_rpc)
+
+/* unifyfs_stats_rpc (client => server)
+ *
+ * given a bulk buffer of bulk_size bytes, push back the performance
+ * statistics of the server as a NUL-terminated JSON string. json_size is
+ * the length of the string, so a client whose buffer is too small (in
+ * which case nothing is pushed) can retry with a larger one. */
+MERCURY_GEN_PROC(unifyfs_stats_in_t,
+                 ((int32_t)(app_id))
+                 ((int32_t)(client_id))
+                 ((hg_size_t)(bulk_size))
+                 ((hg_bulk_t)(bulk_json)))
+MERCURY_GEN_PROC(unifyfs_stats_out_t,
+                 ((int32_t)(ret))
+                 ((hg_size_t)(json_size)))
+DECLARE_MARGO_RPC_HANDLER(unifyfs_stats_rpc)
+
+/* unifyfs_extent_map_rpc (client => server)
+ *
+ * given an app_id, client_id, global file id, starting offset, and a
+ * bulk data array with room for max_ranges file extents (unifyfs_extent_t),
+ * push back the written ranges of the file at or after the offset, in
+ * offset order. adjacent ranges are merged, so the gaps between ranges
+ * are holes. a range that starts before the offset is clipped to it. */
+MERCURY_GEN_PROC(unifyfs_extent_map_in_t,
+                 ((int32_t)(app_id))
+                 ((int32_t)(client_id))
+                 ((int64_t)(gfid))
+                 ((hg_size_t)(offset))
+                 ((int32_t)(max_ranges))
+                 ((hg_size_t)(bulk_size))
+                 ((hg_bulk_t)(bulk_ranges)))
+MERCURY_GEN_PROC(unifyfs_extent_map_out_t,
+                 ((int32_t)(ret))
+                 ((int32_t)(num_ranges)))
+DECLARE_MARGO_RPC_HANDLER(unifyfs_extent_map_rpc)
+
 /* unifyfs_fsync_rpc (client => server)
  *
  * given a client identified by (app_id, client_id) as input, read the write
@@ -117,7 +190,8 @@ DECLARE_MARGO_RPC_HANDLER(unifyfs_metaget_rpc)
 MERCURY_GEN_PROC(unifyfs_fsync_in_t,
                  ((int32_t)(app_id))
                  ((int32_t)(client_id))
-                 ((int32_t)(gfid)))
+                 ((int64_t)(gfid))
+                 ((unifyfs_trace_ctx_t)(trace)))
 MERCURY_GEN_PROC(unifyfs_fsync_out_t, ((int32_t)(ret)))
 DECLARE_MARGO_RPC_HANDLER(unifyfs_fsync_rpc)
 
@@ -128,7 +202,7 @@ DECLARE_MARGO_RPC_HANDLER(unifyfs_fsync_rpc)
 MERCURY_GEN_PROC(unifyfs_filesize_in_t,
                  ((int32_t)(app_id))
                  ((int32_t)(client_id))
-                 ((int32_t)(gfid)))
+                 ((int64_t)(gfid)))
 MERCURY_GEN_PROC(unifyfs_filesize_out_t,
                  ((int32_t)(ret))
                  ((hg_size_t)(filesize)))
@@ -141,7 +215,7 @@ DECLARE_MARGO_RPC_HANDLER(unifyfs_filesize_rpc)
 MERCURY_GEN_PROC(unifyfs_truncate_in_t,
                  ((int32_t)(app_id))
                  ((int32_t)(client_id))
-                 ((int32_t)(gfid))
+                 ((int64_t)(gfid))
                  ((hg_size_t)(filesize)))
 MERCURY_GEN_PROC(unifyfs_truncate_out_t,
                  ((int32_t)(ret)))
@@ -154,7 +228,7 @@ DECLARE_MARGO_RPC_HANDLER(unifyfs_truncate_rpc)
 MERCURY_GEN_PROC(unifyfs_unlink_in_t,
                  ((int32_t)(app_id))
                  ((int32_t)(client_id))
-                 ((int32_t)(gfid)))
+                 ((int64_t)(gfid)))
 MERCURY_GEN_PROC(unifyfs_unlink_out_t,
                  ((int32_t)(ret)))
 DECLARE_MARGO_RPC_HANDLER(unifyfs_unlink_rpc)
@@ -166,11 +240,25 @@ DECLARE_MARGO_RPC_HANDLER(unifyfs_unlink_rpc)
 MERCURY_GEN_PROC(unifyfs_laminate_in_t,
                  ((int32_t)(app_id))
                  ((int32_t)(client_id))
-                 ((int32_t)(gfid)))
+                 ((int64_t)(gfid)))
 MERCURY_GEN_PROC(unifyfs_laminate_out_t,
                  ((int32_t)(ret)))
 DECLARE_MARGO_RPC_HANDLER(unifyfs_laminate_rpc)
 
+/* unifyfs_transfer_rpc (client => server)
+ *
+ * given an app_id, client_id, global file id of a laminated file,
+ * and a destination file path, have the servers write the file data
+ * held in their local logs to the destination file */
+MERCURY_GEN_PROC(unifyfs_transfer_in_t,
+                 ((int32_t)(app_id))
+                 ((int32_t)(client_id))
+                 ((int64_t)(gfid))
+                 ((hg_const_string_t)(dst_file)))
+MERCURY_GEN_PROC(unifyfs_transfer_out_t,
+                 ((int32_t)(ret)))
+DECLARE_MARGO_RPC_HANDLER(unifyfs_transfer_rpc)
+
 /* unifyfs_mread_rpc (client => server)
  *
  * given mread (mread_id, app_id, client_id) and count of read requests,
@@ -181,6 +269,7 @@ MERCURY_GEN_PROC(unifyfs_mread_in_t,
                  ((int32_t)(app_id))
                  ((int32_t)(client_id))
                  ((int32_t)(read_count))
+                 ((unifyfs_trace_ctx_t)(trace))
                  ((hg_size_t)(bulk_size))
                  ((hg_bulk_t)(bulk_extents)))
 MERCURY_GEN_PROC(unifyfs_mread_out_t, ((int32_t)(ret)))
@@ -72,13 +72,20 @@
     UNIFYFS_CFG(client, cwd, STRING, NULLSTRING, "current working directory", NULL) \
     UNIFYFS_CFG(client, local_extents, BOOL, off, "track extents to service reads of local data", NULL) \
     UNIFYFS_CFG(client, max_files, INT, UNIFYFS_CLIENT_MAX_FILES, "client max file count", NULL) \
+    UNIFYFS_CFG(client, shm_requests, BOOL, off, "send common requests to server through shared memory", NULL) \
+    UNIFYFS_CFG(client, transfer_depth, INT, UNIFYFS_CLIENT_TRANSFER_DEPTH, "number of buffers used to overlap reads and writes of a file transfer", NULL) \
+    UNIFYFS_CFG(client, transfer_server, BOOL, off, "servers write laminated files to stage-out destination from their local logs", NULL) \
+    UNIFYFS_CFG(client, transfer_threads, INT, UNIFYFS_CLIENT_TRANSFER_THREADS, "number of files transferred concurrently by background transfers", NULL) \
+    UNIFYFS_CFG(client, write_buf_size, INT, 0, "per-descriptor buffer size for combining small writes (0 disables)", NULL) \
     UNIFYFS_CFG(client, write_index_size, INT, UNIFYFS_CLIENT_WRITE_INDEX_SIZE, "write metadata index buffer size", NULL) \
     UNIFYFS_CFG(client, write_sync, BOOL, off, "sync every write to server", NULL) \
+    UNIFYFS_CFG(client, stream_buf_size, INT, UNIFYFS_CLIENT_STREAM_BUFSIZE, "default buffer size for stdio streams", NULL) \
     UNIFYFS_CFG(client, super_magic, BOOL, on, "return UnifyFS super magic from statfs, TMPFS otherwise", NULL) \
     UNIFYFS_CFG_CLI(log, verbosity, INT, 0, "log verbosity level", NULL, 'v', "specify logging verbosity level") \
     UNIFYFS_CFG_CLI(log, file, STRING, unifyfsd.log, "log file name", NULL, 'l', "specify log file name") \
     UNIFYFS_CFG_CLI(log, dir, STRING, LOGDIR, "log file directory", configurator_directory_check, 'L', "specify full path to directory to contain log file") \
     UNIFYFS_CFG(log, on_error, BOOL, off, "turn on verbose logging when an error is encountered", NULL) \
+    UNIFYFS_CFG(log, async, BOOL, off, "record log messages in per-thread buffers and write them from a background thread", NULL) \
     UNIFYFS_CFG(logio, chunk_size, INT, UNIFYFS_LOGIO_CHUNK_SIZE, "log-based I/O data chunk size", NULL) \
     UNIFYFS_CFG(logio, shmem_size, INT, UNIFYFS_LOGIO_SHMEM_SIZE, "log-based I/O shared memory region size", NULL) \
     UNIFYFS_CFG(logio, spill_size, INT, UNIFYFS_LOGIO_SPILL_SIZE, "log-based I/O spillover file size", NULL) \
@@ -94,6 +101,10 @@
     UNIFYFS_CFG_CLI(server, init_timeout, INT, UNIFYFS_DEFAULT_INIT_TIMEOUT, "timeout of waiting for server initialization", NULL, 't', "timeout in seconds to wait for servers to be ready for clients") \
     UNIFYFS_CFG(server, max_app_clients, INT, MAX_APP_CLIENTS, "maximum number of clients per application", NULL) \
     UNIFYFS_CFG_CLI(sharedfs, dir, STRING, NULLSTRING, "shared file system directory", configurator_directory_check, 'S', "specify full path to directory to contain server shared files") \
+    UNIFYFS_CFG(stats, dump_dir, STRING, LOGDIR, "directory for periodic statistics dumps", configurator_directory_check) \
+    UNIFYFS_CFG(stats, dump_interval, INT, 0, "seconds between statistics dumps (0 disables)", NULL) \
+    UNIFYFS_CFG(trace, dir, STRING, LOGDIR, "directory for request trace files", configurator_directory_check) \
+    UNIFYFS_CFG(trace, sample_rate, INT, 0, "trace one of every N client requests (0 disables)", NULL) \
 
 #ifdef __cplusplus
 extern "C" {
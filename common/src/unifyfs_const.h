@@ -58,6 +58,7 @@
 
 // Server - General
 #define MAX_BULK_TX_SIZE (8 * MIB) /* bulk transfer size (between servers) */
+#define MAX_STAGE_TX_SIZE (8 * MIB) /* stage-out write size (to dest file) */
 #define MAX_NUM_APPS 64            /* max # apps/mountpoints supported */
 #define MAX_APP_CLIENTS 256        /* max # clients per application */
 #define MIN_USLEEP_INTERVAL 50     /* unit: us */
@@ -66,13 +67,18 @@
 #define UNIFYFS_STAGE_STATUS_FILENAME "unifyfs-stage.status"
 
 // Client
-#define UNIFYFS_CLIENT_MAX_FILES 128
-#define UNIFYFS_CLIENT_MAX_FILEDESCS UNIFYFS_CLIENT_MAX_FILES
-#define UNIFYFS_CLIENT_STREAM_BUFSIZE MIB
+#define UNIFYFS_CLIENT_MAX_FILES 4096
+#define UNIFYFS_CLIENT_MAX_FILEDESCS 128
+#define UNIFYFS_CLIENT_MAX_MMAPS 256    /* max # mappings of UnifyFS files */
+#define UNIFYFS_CLIENT_TRANSFER_DEPTH 4   /* buffers per file transfer */
+#define UNIFYFS_CLIENT_TRANSFER_THREADS 2 /* # concurrent file transfers */
+#define UNIFYFS_CLIENT_STREAM_BUFSIZE (4 * MIB)
 #define UNIFYFS_CLIENT_WRITE_INDEX_SIZE (20 * MIB)
 #define UNIFYFS_CLIENT_MAX_READ_COUNT KIB      /* max # active read requests */
 #define UNIFYFS_CLIENT_READ_TIMEOUT_SECONDS 60
 #define UNIFYFS_CLIENT_MAX_ACTIVE_REQUESTS 64  /* max concurrent client reqs */
+#define UNIFYFS_CLIENT_EXTENT_MAP_RANGES KIB   /* ranges per extent map rpc */
+#define UNIFYFS_CLIENT_STATS_BUFSIZE (64 * KIB) /* initial stats rpc buffer */
 
 // Log-based I/O
 #define UNIFYFS_LOGIO_CHUNK_SIZE (4 * MIB)
@@ -94,28 +94,45 @@ void unifyfs_log_print(time_t now,
                        int lineno,
                        const char* function,
                        char* msg)
+{
+    unifyfs_log_write(now, (long)unifyfs_gettid(), srcfile, lineno,
+                      function, msg);
+    fflush(unifyfs_log_stream);
+}
+
+/* write a message of the given thread to the log with given time and
+ * source context */
+void unifyfs_log_write(time_t now,
+                       long tid,
+                       const char* srcfile,
+                       int lineno,
+                       const char* function,
+                       const char* msg)
 {
     char timestamp[64] = {0};
-    struct tm* log_ltime = localtime(&now);
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", log_ltime);
+    struct tm log_ltime;
+    localtime_r(&now, &log_ltime);
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", &log_ltime);
 
-    char* file = (char*)srcfile;
-    char* func = (char*)function;
+    const char* file = srcfile;
+    const char* func = function;
     if (NULL != file) {
         file += unifyfs_log_source_base_len;
     }
     if (NULL == func) {
-        func = (char*) null_func;
+        func = null_func;
     }
     fprintf(unifyfs_log_stream, "%s tid=%ld @ %s() [%s:%d] %s\n",
-            timestamp, (long)unifyfs_gettid(), func, file, lineno, msg);
-    fflush(unifyfs_log_stream);
+            timestamp, tid, func, file, lineno, msg);
 }
 
 /* close our log file stream.
  * returns UNIFYFS_SUCCESS on success */
 int unifyfs_log_close(void)
 {
+    /* write out messages held by the log thread */
+    unifyfs_log_async_stop();
+
     /* if stream is open, and its not stderr, close it */
     if (NULL != unifyfs_log_stream) {
         if (unifyfs_log_stream != stderr) {
@@ -30,6 +30,7 @@
 #ifndef __UNIFYFS_LOG_H__
 #define __UNIFYFS_LOG_H__
 
+#include <stdarg.h>
 #include <stdio.h>
 #include <time.h>
 #include <sys/types.h>
@@ -52,6 +53,25 @@ typedef enum {
 extern unifyfs_log_level_t unifyfs_log_level;
 extern int unifyfs_log_on_error;
 extern FILE* unifyfs_log_stream;
+extern int unifyfs_log_async;
+
+/* asynchronous logging settings */
+#define UNIFYFS_LOG_RING_SIZE     (256 * 1024) /* per-thread ring bytes */
+#define UNIFYFS_LOG_FLUSH_USEC    10000        /* log thread wake interval */
+#define UNIFYFS_LOG_MAX_STRING    4096         /* max message/string length */
+#define UNIFYFS_LOG_SITE_MAX_ARGS 32           /* max recorded arguments */
+
+/* static state of a LOG() call site for asynchronous logging, filled in
+ * on first use */
+typedef struct unifyfs_log_site {
+    int state;
+    int lineno;
+    const char* srcfile;
+    const char* function;
+    const char* fmt;
+    int n_args;
+    char arg_types[UNIFYFS_LOG_SITE_MAX_ARGS];
+} unifyfs_log_site_t;
 
 pid_t unifyfs_gettid(void);
 
@@ -62,6 +82,30 @@ void unifyfs_log_print(time_t now,
                        const char* function,
                        char* msg);
 
+/* write one message for the given thread to debug file stream,
+ * without flushing it */
+void unifyfs_log_write(time_t now,
+                       long tid,
+                       const char* srcfile,
+                       int lineno,
+                       const char* function,
+                       const char* msg);
+
+/* record one message in this thread's log ring, for the log thread
+ * to format and write */
+void unifyfs_log_record(unifyfs_log_site_t* site,
+                        const char* srcfile,
+                        int lineno,
+                        const char* function,
+                        const char* fmt, ...);
+
+/* start writing log messages from a background thread,
+ * returns UNIFYFS_SUCCESS on success */
+int unifyfs_log_async_start(void);
+
+/* write out recorded messages and stop the background log thread */
+void unifyfs_log_async_stop(void);
+
 /* open specified file as debug file stream,
  * returns UNIFYFS_SUCCESS on success */
 int unifyfs_log_open(const char* file);
@@ -79,6 +123,12 @@ void unifyfs_set_log_on_error(void);
 #define LOG(level, ...) \
     do { \
         if (level <= unifyfs_log_level) { \
+            if (unifyfs_log_async) { \
+                static unifyfs_log_site_t log_site; \
+                unifyfs_log_record(&log_site, __FILE__, __LINE__, \
+                                   __func__, __VA_ARGS__); \
+                break; \
+            } \
             if (NULL == unifyfs_log_stream) { \
                 unifyfs_log_stream = stderr; \
             } \
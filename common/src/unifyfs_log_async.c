@@ -0,0 +1,695 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+/*
+ * Asynchronous logging
+ *
+ * Each thread that logs gets its own ring buffer, where LOG() appends a
+ * binary record holding a monotonic timestamp, the thread id, a pointer
+ * to the static state of the call site (source location and format
+ * string), and the raw message arguments. Only the logging thread writes
+ * to a ring and only the log thread reads from it, so records are added
+ * with a couple of atomic loads and stores, and no locks or system calls.
+ * When a ring is full, the message is dropped and counted.
+ *
+ * The log thread wakes up periodically, merges the records of all rings
+ * in timestamp order, formats them the same way as synchronous messages,
+ * and writes them to the log stream with one flush per pass.
+ *
+ * The argument types of a call site are parsed from its format string
+ * the first time it is used. Call sites with formats we can not record
+ * (e.g., %n or wide strings) are formatted by the caller instead, and
+ * recorded as a single string.
+ */
+
+#include "unifyfs_const.h"
+#include "unifyfs_log.h"
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* set while the log thread is running */
+int unifyfs_log_async; // = 0
+
+/* record header, records are 8-byte aligned in the ring. A record with
+ * a zero tid is padding up to the end of the ring. */
+typedef struct {
+    uint32_t size;                  /* record size including header */
+    uint32_t tid;                   /* thread id, 0 for padding */
+    uint64_t timestamp;             /* CLOCK_MONOTONIC nanoseconds */
+    unifyfs_log_site_t* site;       /* call site of message */
+} log_record_hdr;
+
+typedef struct log_ring {
+    struct log_ring* next;          /* list of all rings */
+    int in_use;                     /* owned by a live thread */
+    uint64_t head;                  /* bytes written by producer */
+    uint64_t tail;                  /* bytes consumed by log thread */
+    uint64_t dropped;               /* messages dropped when full */
+    uint64_t dropped_reported;      /* drops already reported */
+    uint64_t read_pos;              /* log thread position this pass */
+    uint64_t read_limit;            /* producer position at pass start */
+    uint32_t tid;                   /* id of the thread that owns it */
+    char* buf;
+} log_ring;
+
+/* list of all rings, new rings are pushed at the head */
+static log_ring* ring_list; // = NULL
+
+/* the ring of this thread */
+static __thread log_ring* my_ring; // = NULL
+
+static pthread_key_t ring_key;
+static pthread_t log_thread;
+static int log_thread_exit; // = 0
+
+/* offset from CLOCK_MONOTONIC to CLOCK_REALTIME at startup */
+static int64_t realtime_offset_ns; // = 0
+
+/* argument types recorded in the ring */
+enum {
+    LOG_ARG_INT = 'i',          /* int or smaller */
+    LOG_ARG_LONG = 'l',         /* long, long long, size_t, etc. */
+    LOG_ARG_DOUBLE = 'd',
+    LOG_ARG_LDOUBLE = 'D',      /* recorded as double */
+    LOG_ARG_PTR = 'p',
+    LOG_ARG_STR = 's'
+};
+
+/* call site states */
+enum {
+    LOG_SITE_NEW = 0,
+    LOG_SITE_READY = 1,
+    LOG_SITE_PREFORMAT = 2
+};
+
+static inline uint64_t log_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* a conversion specification in a format string */
+typedef struct {
+    const char* start;      /* at '%' */
+    size_t len;             /* through the conversion character */
+    int n_stars;            /* '*' width and precision arguments */
+    char type;              /* one of LOG_ARG_*, or 0 for "%%" */
+} log_spec;
+
+/* find the next conversion specification at or after fmt. Returns 1 and
+ * fills spec if found, 0 at end of string, or -1 for a specification we
+ * can not record. */
+static int next_spec(const char* fmt, const char** next, log_spec* spec)
+{
+    const char* p = strchr(fmt, '%');
+    if (NULL == p) {
+        return 0;
+    }
+
+    memset(spec, 0, sizeof(*spec));
+    spec->start = p++;
+    if ('%' == *p) {
+        spec->len = 2;
+        *next = p + 1;
+        return 1;
+    }
+
+    /* flags, width, and precision */
+    while (strchr("-+ #0", *p) && *p) {
+        p++;
+    }
+    for (; ('*' == *p) || ((*p >= '0') && (*p <= '9')) || ('.' == *p); p++) {
+        if ('*' == *p) {
+            spec->n_stars++;
+        }
+    }
+
+    /* length modifiers */
+    int n_long = 0;
+    int is_ldouble = 0;
+    for (; strchr("hlLqjzt", *p) && *p; p++) {
+        if ('h' != *p) {
+            n_long++;
+        }
+        if ('L' == *p) {
+            is_ldouble = 1;
+        }
+    }
+
+    switch (*p) {
+    case 'c':
+        if (n_long) {
+            return -1; /* wide character */
+        }
+        spec->type = LOG_ARG_INT;
+        break;
+    case 'd': case 'i': case 'o': case 'u': case 'x': case 'X':
+        spec->type = n_long ? LOG_ARG_LONG : LOG_ARG_INT;
+        break;
+    case 'e': case 'E': case 'f': case 'F':
+    case 'g': case 'G': case 'a': case 'A':
+        spec->type = is_ldouble ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+        break;
+    case 'p':
+        spec->type = LOG_ARG_PTR;
+        break;
+    case 's':
+        if (n_long) {
+            return -1; /* wide string */
+        }
+        spec->type = LOG_ARG_STR;
+        break;
+    default:
+        return -1;
+    }
+
+    spec->len = (size_t)(p - spec->start) + 1;
+    *next = p + 1;
+    return 1;
+}
+
+/* parse the argument types of a call site from its format string */
+static void parse_site(unifyfs_log_site_t* site, const char* fmt)
+{
+    int n_args = 0;
+    int state = LOG_SITE_READY;
+    const char* p = fmt;
+    log_spec spec;
+    int rc;
+    while ((rc = next_spec(p, &p, &spec)) != 0) {
+        if ((rc < 0) ||
+            ((n_args + spec.n_stars + 1) > UNIFYFS_LOG_SITE_MAX_ARGS)) {
+            state = LOG_SITE_PREFORMAT;
+            break;
+        }
+        for (int i = 0; i < spec.n_stars; i++) {
+            site->arg_types[n_args++] = LOG_ARG_INT;
+        }
+        if (spec.type) {
+            site->arg_types[n_args++] = spec.type;
+        }
+    }
+    site->n_args = n_args;
+
+    /* concurrent first uses parse to the same result */
+    __atomic_store_n(&site->state, state, __ATOMIC_RELEASE);
+}
+
+static void ring_release(void* arg)
+{
+    log_ring* ring = (log_ring*) arg;
+    __atomic_store_n(&ring->in_use, 0, __ATOMIC_RELEASE);
+}
+
+/* get the ring for this thread, reusing a ring of an exited thread */
+static log_ring* get_my_ring(void)
+{
+    if (NULL != my_ring) {
+        return my_ring;
+    }
+
+    log_ring* ring = __atomic_load_n(&ring_list, __ATOMIC_ACQUIRE);
+    for (; NULL != ring; ring = ring->next) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&ring->in_use, &expected, 1, 0,
+                                        __ATOMIC_ACQ_REL,
+                                        __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (NULL == ring) {
+        ring = calloc(1, sizeof(log_ring));
+        if (NULL == ring) {
+            return NULL;
+        }
+        ring->buf = malloc(UNIFYFS_LOG_RING_SIZE);
+        if (NULL == ring->buf) {
+            free(ring);
+            return NULL;
+        }
+        ring->in_use = 1;
+        ring->next = __atomic_load_n(&ring_list, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&ring_list, &ring->next, ring,
+                                            0, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED)) {
+            ;
+        }
+    }
+
+    /* the thread id goes in every record, so look it up once here */
+    ring->tid = (uint32_t) unifyfs_gettid();
+    my_ring = ring;
+    pthread_setspecific(ring_key, ring);
+    return ring;
+}
+
+static inline size_t align8(size_t n)
+{
+    return (n + 7) & ~((size_t)7);
+}
+
+/* reserve a contiguous record of the given size in the ring, returns
+ * its address or NULL if the ring is full */
+static char* ring_reserve(log_ring* ring, size_t size, uint64_t* new_head)
+{
+    uint64_t head = ring->head;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+    size_t off = (size_t)(head % UNIFYFS_LOG_RING_SIZE);
+    size_t contig = UNIFYFS_LOG_RING_SIZE - off;
+    size_t pad = (contig < size) ? contig : 0;
+
+    if ((head + pad + size - tail) > UNIFYFS_LOG_RING_SIZE) {
+        return NULL;
+    }
+
+    if (pad) {
+        /* pad to end of ring, the consumer skips it */
+        log_record_hdr* hdr = (log_record_hdr*)(ring->buf + off);
+        hdr->size = (uint32_t) pad;
+        hdr->tid = 0;
+        head += pad;
+        off = 0;
+    }
+
+    *new_head = head + size;
+    return ring->buf + off;
+}
+
+static void record_message(log_ring* ring,
+                           unifyfs_log_site_t* site,
+                           const char* msg)
+{
+    size_t msg_len = strlen(msg);
+    size_t size = align8(sizeof(log_record_hdr) + msg_len + 1);
+    uint64_t new_head;
+    char* rec = ring_reserve(ring, size, &new_head);
+    if (NULL == rec) {
+        __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    log_record_hdr* hdr = (log_record_hdr*) rec;
+    hdr->size = (uint32_t) size;
+    hdr->tid = ring->tid;
+    hdr->timestamp = log_now_ns();
+    hdr->site = site;
+    memcpy(rec + sizeof(log_record_hdr), msg, msg_len + 1);
+    __atomic_store_n(&ring->head, new_head, __ATOMIC_RELEASE);
+}
+
+/* argument values of a message, as read from its va_list */
+typedef struct {
+    int64_t vals[UNIFYFS_LOG_SITE_MAX_ARGS];
+    const char* strs[UNIFYFS_LOG_SITE_MAX_ARGS];
+    uint32_t str_lens[UNIFYFS_LOG_SITE_MAX_ARGS];
+} log_args;
+
+/* read the arguments of a message of a parsed call site, and return
+ * the payload size needed to record them. Strings are stored with a
+ * length prefix. */
+static size_t read_args(unifyfs_log_site_t* site,
+                        va_list args,
+                        log_args* la)
+{
+    size_t size = 0;
+    for (int i = 0; i < site->n_args; i++) {
+        switch (site->arg_types[i]) {
+        case LOG_ARG_INT:
+            la->vals[i] = (int64_t) va_arg(args, int);
+            size += sizeof(int64_t);
+            break;
+        case LOG_ARG_LONG:
+            la->vals[i] = (int64_t) va_arg(args, long long);
+            size += sizeof(int64_t);
+            break;
+        case LOG_ARG_DOUBLE: {
+            double d = va_arg(args, double);
+            memcpy(&la->vals[i], &d, sizeof(d));
+            size += sizeof(int64_t);
+            break;
+        }
+        case LOG_ARG_LDOUBLE: {
+            double d = (double) va_arg(args, long double);
+            memcpy(&la->vals[i], &d, sizeof(d));
+            size += sizeof(int64_t);
+            break;
+        }
+        case LOG_ARG_PTR:
+            la->vals[i] = (int64_t)(intptr_t) va_arg(args, void*);
+            size += sizeof(int64_t);
+            break;
+        case LOG_ARG_STR: {
+            const char* s = va_arg(args, const char*);
+            if (NULL == s) {
+                s = "(null)";
+            }
+            size_t len = strnlen(s, UNIFYFS_LOG_MAX_STRING - 1);
+            la->strs[i] = s;
+            la->str_lens[i] = (uint32_t) len;
+            size += align8(sizeof(uint32_t) + len + 1);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return size;
+}
+
+/* write the arguments read by read_args() to a record payload */
+static void pack_args(unifyfs_log_site_t* site,
+                      const log_args* la,
+                      char* pos)
+{
+    for (int i = 0; i < site->n_args; i++) {
+        if (LOG_ARG_STR == site->arg_types[i]) {
+            uint32_t len = la->str_lens[i];
+            memcpy(pos, &len, sizeof(uint32_t));
+            memcpy(pos + sizeof(uint32_t), la->strs[i], len);
+            pos[sizeof(uint32_t) + len] = '\0';
+            pos += align8(sizeof(uint32_t) + len + 1);
+        } else {
+            memcpy(pos, &la->vals[i], sizeof(int64_t));
+            pos += sizeof(int64_t);
+        }
+    }
+}
+
+/* record a message of a call site in this thread's ring */
+void unifyfs_log_record(unifyfs_log_site_t* site,
+                        const char* srcfile,
+                        int lineno,
+                        const char* function,
+                        const char* fmt, ...)
+{
+    log_ring* ring = get_my_ring();
+    if (NULL == ring) {
+        return;
+    }
+
+    int state = __atomic_load_n(&site->state, __ATOMIC_ACQUIRE);
+    if (LOG_SITE_NEW == state) {
+        site->srcfile = srcfile;
+        site->lineno = lineno;
+        site->function = function;
+        site->fmt = fmt;
+        parse_site(site, fmt);
+        state = site->state;
+    }
+
+    va_list args;
+    va_start(args, fmt);
+
+    if (LOG_SITE_PREFORMAT == state) {
+        char msg[UNIFYFS_LOG_MAX_STRING] = {0};
+        vsnprintf(msg, sizeof(msg), fmt, args);
+        va_end(args);
+        record_message(ring, site, msg);
+        return;
+    }
+
+    log_args la;
+    size_t size = sizeof(log_record_hdr) + read_args(site, args, &la);
+    va_end(args);
+
+    size = align8(size);
+    uint64_t new_head;
+    char* rec = ring_reserve(ring, size, &new_head);
+    if (NULL == rec) {
+        __atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    log_record_hdr* hdr = (log_record_hdr*) rec;
+    hdr->size = (uint32_t) size;
+    hdr->tid = ring->tid;
+    hdr->timestamp = log_now_ns();
+    hdr->site = site;
+    pack_args(site, &la, rec + sizeof(log_record_hdr));
+
+    __atomic_store_n(&ring->head, new_head, __ATOMIC_RELEASE);
+}
+
+/* format the arguments of a record using its site's format string */
+static void format_record(unifyfs_log_site_t* site,
+                          const char* payload,
+                          char* msg,
+                          size_t msg_size)
+{
+    const char* fmt = site->fmt;
+    const char* p = fmt;
+    const char* next;
+    size_t used = 0;
+    log_spec spec;
+
+    msg[0] = '\0';
+    while (next_spec(p, &next, &spec) > 0) {
+        /* literal text before the specification */
+        used += scnprintf(msg + used, msg_size - used, "%.*s",
+                          (int)(spec.start - p), p);
+        p = next;
+
+        if (0 == spec.type) {
+            used += scnprintf(msg + used, msg_size - used, "%%");
+            continue;
+        }
+
+        /* put '*' arguments into the specification */
+        char spec_str[64];
+        size_t spec_len = 0;
+        for (size_t i = 0; i < spec.len; i++) {
+            if (spec_len >= (sizeof(spec_str) - 24)) {
+                break;
+            }
+            if ('*' == spec.start[i]) {
+                int64_t star;
+                memcpy(&star, payload, sizeof(star));
+                payload += sizeof(star);
+                spec_len += scnprintf(spec_str + spec_len,
+                                      sizeof(spec_str) - spec_len,
+                                      "%d", (int)star);
+            } else {
+                spec_str[spec_len++] = spec.start[i];
+            }
+        }
+        spec_str[spec_len] = '\0';
+
+        int64_t val;
+        double d;
+        switch (spec.type) {
+        case LOG_ARG_INT:
+            memcpy(&val, payload, sizeof(val));
+            payload += sizeof(val);
+            used += scnprintf(msg + used, msg_size - used, spec_str,
+                              (int)val);
+            break;
+        case LOG_ARG_LONG:
+            memcpy(&val, payload, sizeof(val));
+            payload += sizeof(val);
+            used += scnprintf(msg + used, msg_size - used, spec_str,
+                              (long long)val);
+            break;
+        case LOG_ARG_DOUBLE:
+            memcpy(&d, payload, sizeof(d));
+            payload += sizeof(d);
+            used += scnprintf(msg + used, msg_size - used, spec_str, d);
+            break;
+        case LOG_ARG_LDOUBLE:
+            memcpy(&d, payload, sizeof(d));
+            payload += sizeof(d);
+            used += scnprintf(msg + used, msg_size - used, spec_str,
+                              (long double)d);
+            break;
+        case LOG_ARG_PTR:
+            memcpy(&val, payload, sizeof(val));
+            payload += sizeof(val);
+            used += scnprintf(msg + used, msg_size - used, spec_str,
+                              (void*)(intptr_t)val);
+            break;
+        case LOG_ARG_STR: {
+            uint32_t len;
+            memcpy(&len, payload, sizeof(len));
+            used += scnprintf(msg + used, msg_size - used, spec_str,
+                              payload + sizeof(uint32_t));
+            payload += align8(sizeof(uint32_t) + len + 1);
+            break;
+        }
+        default:
+            break;
+        }
+    }
+
+    /* trailing literal text */
+    scnprintf(msg + used, msg_size - used, "%s", p);
+}
+
+/* write out one record */
+static void write_record(log_record_hdr* hdr)
+{
+    char msg[UNIFYFS_LOG_MAX_STRING];
+    const char* payload = (const char*)hdr + sizeof(log_record_hdr);
+    unifyfs_log_site_t* site = hdr->site;
+    if (site->state == LOG_SITE_PREFORMAT) {
+        scnprintf(msg, sizeof(msg), "%s", payload);
+    } else {
+        format_record(site, payload, msg, sizeof(msg));
+    }
+
+    int64_t ns = (int64_t)hdr->timestamp + realtime_offset_ns;
+    time_t now = (time_t)(ns / 1000000000LL);
+    unifyfs_log_write(now, (long)hdr->tid, site->srcfile, site->lineno,
+                      site->function, msg);
+}
+
+/* return the next record of the ring that the log thread has not read
+ * yet in this pass, skipping padding */
+static log_record_hdr* ring_peek(log_ring* ring)
+{
+    while (ring->read_pos < ring->read_limit) {
+        size_t off = (size_t)(ring->read_pos % UNIFYFS_LOG_RING_SIZE);
+        log_record_hdr* hdr = (log_record_hdr*)(ring->buf + off);
+        if (0 != hdr->tid) {
+            return hdr;
+        }
+        ring->read_pos += hdr->size;
+    }
+    return NULL;
+}
+
+/* write out all recorded messages in timestamp order */
+static void log_drain(void)
+{
+    log_ring* rings = __atomic_load_n(&ring_list, __ATOMIC_ACQUIRE);
+    log_ring* ring;
+    int n_written = 0;
+
+    /* messages recorded after this point wait for the next pass */
+    for (ring = rings; NULL != ring; ring = ring->next) {
+        ring->read_limit = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+        ring->read_pos = ring->tail;
+    }
+
+    while (1) {
+        log_ring* min_ring = NULL;
+        log_record_hdr* min_hdr = NULL;
+        for (ring = rings; NULL != ring; ring = ring->next) {
+            log_record_hdr* hdr = ring_peek(ring);
+            if ((NULL != hdr) &&
+                ((NULL == min_hdr) || (hdr->timestamp < min_hdr->timestamp))) {
+                min_ring = ring;
+                min_hdr = hdr;
+            }
+        }
+        if (NULL == min_ring) {
+            break;
+        }
+
+        write_record(min_hdr);
+        n_written++;
+        min_ring->read_pos += min_hdr->size;
+        __atomic_store_n(&min_ring->tail, min_ring->read_pos,
+                         __ATOMIC_RELEASE);
+    }
+
+    /* padding at the end of a ring can also be released */
+    for (ring = rings; NULL != ring; ring = ring->next) {
+        __atomic_store_n(&ring->tail, ring->read_pos, __ATOMIC_RELEASE);
+
+        uint64_t dropped = __atomic_load_n(&ring->dropped, __ATOMIC_RELAXED);
+        if (dropped != ring->dropped_reported) {
+            char msg[128];
+            scnprintf(msg, sizeof(msg),
+                      "WARNING: %llu log messages were dropped",
+                      (unsigned long long)(dropped - ring->dropped_reported));
+            unifyfs_log_write(time(NULL), (long)unifyfs_gettid(), __FILE__,
+                              __LINE__, __func__, msg);
+            ring->dropped_reported = dropped;
+            n_written++;
+        }
+    }
+
+    if (n_written) {
+        fflush(unifyfs_log_stream);
+    }
+}
+
+static void* log_thread_main(void* arg)
+{
+    struct timespec interval = {
+        .tv_sec = 0,
+        .tv_nsec = UNIFYFS_LOG_FLUSH_USEC * 1000
+    };
+
+    while (!__atomic_load_n(&log_thread_exit, __ATOMIC_ACQUIRE)) {
+        nanosleep(&interval, NULL);
+        log_drain();
+    }
+    log_drain();
+    return NULL;
+}
+
+/* start writing log messages from a background thread,
+ * returns UNIFYFS_SUCCESS on success */
+int unifyfs_log_async_start(void)
+{
+    if (unifyfs_log_async) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    if (NULL == unifyfs_log_stream) {
+        unifyfs_log_stream = stderr;
+    }
+
+    struct timespec mono, real;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    realtime_offset_ns =
+        (((int64_t)real.tv_sec - (int64_t)mono.tv_sec) * 1000000000LL) +
+        ((int64_t)real.tv_nsec - (int64_t)mono.tv_nsec);
+
+    static int key_created; // = 0
+    if (!key_created) {
+        if (pthread_key_create(&ring_key, ring_release) != 0) {
+            return UNIFYFS_FAILURE;
+        }
+        key_created = 1;
+    }
+
+    log_thread_exit = 0;
+    if (pthread_create(&log_thread, NULL, log_thread_main, NULL) != 0) {
+        return UNIFYFS_FAILURE;
+    }
+
+    __atomic_store_n(&unifyfs_log_async, 1, __ATOMIC_RELEASE);
+    return UNIFYFS_SUCCESS;
+}
+
+/* stop the background log thread after it writes out all recorded
+ * messages, new messages are written synchronously */
+void unifyfs_log_async_stop(void)
+{
+    if (!__atomic_load_n(&unifyfs_log_async, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+    __atomic_store_n(&unifyfs_log_async, 0, __ATOMIC_RELEASE);
+
+    __atomic_store_n(&log_thread_exit, 1, __ATOMIC_RELEASE);
+    pthread_join(log_thread, NULL);
+}
@@ -793,6 +793,80 @@ int unifyfs_logio_read(logio_context* ctx,
     }
 }
 
+/* Map data from logio context into memory */
+int unifyfs_logio_map(logio_context* ctx,
+                      const off_t log_offset,
+                      const size_t nbytes,
+                      void* addr)
+{
+    if ((NULL == ctx) || (NULL == addr) || (0 == nbytes)) {
+        return EINVAL;
+    }
+
+    size_t page_sz = get_page_size();
+    if ((nbytes % page_sz) || ((uintptr_t)addr % page_sz)) {
+        return EINVAL;
+    }
+
+    log_header* shmem_hdr = NULL;
+    off_t mem_size = 0;
+    if (NULL != ctx->shmem) {
+        shmem_hdr = (log_header*) ctx->shmem->addr;
+        mem_size = (off_t) shmem_hdr->data_sz;
+    }
+
+    size_t sz_in_mem = 0;
+    size_t sz_in_spill = 0;
+    off_t spill_offset = 0;
+    get_log_sizes(log_offset, nbytes, mem_size,
+                  &sz_in_mem, &sz_in_spill, &spill_offset);
+    if (sz_in_mem && sz_in_spill) {
+        /* data spans shared memory and spillover file */
+        return EINVAL;
+    }
+
+    /* determine which storage holds the data, and where */
+    int fd;
+    off_t map_offset;
+    if (sz_in_mem) {
+        map_offset = shmem_hdr->data_offset + log_offset;
+        if (map_offset % page_sz) {
+            return EINVAL;
+        }
+        fd = shm_open(ctx->shmem->name, O_RDONLY, 0);
+        if (-1 == fd) {
+            int err = errno;
+            LOGERR("shm_open(%s) failed: %s",
+                   ctx->shmem->name, strerror(err));
+            return err;
+        }
+    } else {
+        if ((NULL == ctx->spill_hdr) || (-1 == ctx->spill_fd)) {
+            return EINVAL;
+        }
+        log_header* spill_hdr = (log_header*) ctx->spill_hdr;
+        map_offset = spill_hdr->data_offset + spill_offset;
+        if (map_offset % page_sz) {
+            return EINVAL;
+        }
+        fd = ctx->spill_fd;
+    }
+
+    int ret = UNIFYFS_SUCCESS;
+    void* maddr = mmap(addr, nbytes, PROT_READ, (MAP_SHARED | MAP_FIXED),
+                       fd, map_offset);
+    if (MAP_FAILED == maddr) {
+        ret = errno;
+        LOGERR("mmap(log_off=%zu, nbytes=%zu) failed: %s",
+               (size_t)log_offset, nbytes, strerror(ret));
+    }
+
+    if (sz_in_mem) {
+        close(fd);
+    }
+    return ret;
+}
+
 /* Write data to logio context */
 int unifyfs_logio_write(logio_context* ctx,
                         const off_t log_offset,
@@ -912,3 +986,31 @@ int unifyfs_logio_get_sizes(logio_context* ctx,
 
     return UNIFYFS_SUCCESS;
 }
+
+/* get the shmem and spill data bytes currently reserved */
+int unifyfs_logio_get_usage(logio_context* ctx,
+                            off_t* shmem_used,
+                            off_t* spill_used)
+{
+    if (NULL == ctx) {
+        return EINVAL;
+    }
+
+    if (NULL != shmem_used) {
+        *shmem_used = 0;
+        if (NULL != ctx->shmem) {
+            log_header* shmem_hdr = (log_header*) ctx->shmem->addr;
+            *shmem_used = (off_t) shmem_hdr->reserved_sz;
+        }
+    }
+
+    if (NULL != spill_used) {
+        *spill_used = 0;
+        if (NULL != ctx->spill_hdr) {
+            log_header* spill_hdr = (log_header*) ctx->spill_hdr;
+            *spill_used = (off_t) spill_hdr->reserved_sz;
+        }
+    }
+
+    return UNIFYFS_SUCCESS;
+}
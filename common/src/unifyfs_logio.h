@@ -134,6 +134,25 @@ int unifyfs_logio_write(logio_context* ctx,
                         const char* buf,
                         size_t* obytes);
 
+/**
+ * Map log data from logio context at given log offset into memory
+ * at the given address, replacing any existing mapping there. The
+ * mapping is read-only and shares pages with the log storage, so it
+ * sees later writes to that part of the log. The data must be stored
+ * at a page-aligned location, and must be entirely in shared memory
+ * or entirely in the spillover file.
+ *
+ * @param ctx pointer to logio context
+ * @param log_offset log offset of data to map
+ * @param nbytes number of bytes to map (multiple of page size)
+ * @param addr page-aligned address at which to map data
+ * @return UNIFYFS_SUCCESS, or error code
+ */
+int unifyfs_logio_map(logio_context* ctx,
+                      const off_t log_offset,
+                      const size_t nbytes,
+                      void* addr);
+
 /**
  * Sync any spill data to disk for given logio context.
  *
@@ -154,6 +173,18 @@ int unifyfs_logio_get_sizes(logio_context* ctx,
                             off_t* shmem_sz,
                             off_t* spill_sz);
 
+/**
+ * Get the shmem and spill data bytes currently reserved.
+ *
+ * @param ctx pointer to logio context
+ * @param[out] shmem_used if non-NULL, set to reserved shmem data bytes
+ * @param[out] spill_used if non-NULL, set to reserved spillover data bytes
+ * @return UNIFYFS_SUCCESS, or error code
+ */
+int unifyfs_logio_get_usage(logio_context* ctx,
+                            off_t* shmem_used,
+                            off_t* spill_used);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -32,8 +32,10 @@
 extern "C" {
 #endif
 
-#ifndef UNIFYFS_METADATA_CACHE_SECONDS
-# define UNIFYFS_METADATA_CACHE_SECONDS 5
+/* upper bound on how long leased file metadata is used without hearing
+ * from the owner, in case a lease revocation is lost */
+#ifndef UNIFYFS_METADATA_LEASE_SECONDS
+# define UNIFYFS_METADATA_LEASE_SECONDS 60
 #endif
 
 
@@ -53,7 +55,7 @@ typedef struct {
 typedef struct {
     size_t offset;
     size_t length;
-    int gfid;
+    int64_t gfid;
 } unifyfs_extent_t;
 
 /* write-log metadata index structure */
@@ -61,13 +63,48 @@ typedef struct {
     off_t file_pos; /* start offset of data in file */
     off_t log_pos;  /* start offset of data in write log */
     size_t length;  /* length of data */
-    int gfid;       /* global file id */
+    int64_t gfid;   /* global file id */
 } unifyfs_index_t;
 
+/*
+ * Header of the client write index ring, which is kept at the start of
+ * the index region of the client superblock, one page before the array of
+ * index entries. The client appends entries at tail, and its server
+ * consumes them from head in the background, so a writer only has to wait
+ * for the server when the ring is full. Both counts only grow, entry i is
+ * stored in slot (i % number of slots). Use unifyfs_index_ring_load() and
+ * unifyfs_index_ring_store() to access them, so entries are visible before
+ * the count that publishes (or releases) them.
+ *
+ * The header also holds the client's metadata epoch, which the server
+ * increments whenever file metadata it told the client it could cache
+ * may have changed. The client drops its cached metadata when it sees a
+ * new epoch.
+ */
+typedef struct {
+    volatile uint64_t tail;       /* number of entries published by client */
+    char pad[56];                 /* keep head and tail in separate lines */
+    volatile uint64_t head;       /* number of entries consumed by server */
+    char pad2[56];                /* keep epoch apart from ring counts */
+    volatile uint64_t meta_epoch; /* bumped by server to invalidate cache */
+} unifyfs_index_ring_t;
+
+static inline
+uint64_t unifyfs_index_ring_load(volatile uint64_t* count)
+{
+    return __atomic_load_n(count, __ATOMIC_ACQUIRE);
+}
+
+static inline
+void unifyfs_index_ring_store(volatile uint64_t* count, uint64_t val)
+{
+    __atomic_store_n(count, val, __ATOMIC_RELEASE);
+}
+
 /* UnifyFS file attributes */
 typedef struct {
     char* filename;
-    int gfid;
+    int64_t gfid;
 
     /* Set when the file is laminated */
     int is_laminated;
@@ -85,6 +122,82 @@ typedef struct {
     struct timespec ctime;
 } unifyfs_file_attr_t;
 
+/* result of one file lookup in a stat-many request, the attributes
+ * are returned without the filename */
+typedef struct {
+    int64_t gfid;             /* global file id to look up */
+    int rc;                   /* UNIFYFS_SUCCESS or error code */
+    unifyfs_file_attr_t attr; /* file attributes (filename is NULL) */
+} unifyfs_stat_result_t;
+
+/*
+ * Optional request queue in the client superblock, which carries common
+ * client requests to the client's server without going through Mercury.
+ * The queue region follows the write index entries. It starts with a
+ * header, and slot i of the queue is at offset
+ * (1 + (i % UNIFYFS_SHM_REQQ_DEPTH)) * UNIFYFS_SHM_REQQ_SLOT_SIZE.
+ *
+ * The client is the single producer (its threads take turns using a
+ * lock), and the request manager thread of the client at the server is
+ * the single consumer. The client fills in the next slot, posts it by
+ * setting its state, then increments the doorbell and wakes the server if
+ * it sleeps on it. The server handles posted slots in order, writes the
+ * result into the same slot, and marks it done, waking the client if it
+ * sleeps on the slot state. The client frees the slot once it has read
+ * the result. A client that gives up waiting marks its slot abandoned,
+ * and the server frees it when done.
+ */
+#define UNIFYFS_SHM_REQQ_DEPTH 16
+#define UNIFYFS_SHM_REQQ_SLOT_SIZE (8 * KIB)
+#define UNIFYFS_SHM_REQQ_SIZE \
+    ((1 + UNIFYFS_SHM_REQQ_DEPTH) * UNIFYFS_SHM_REQQ_SLOT_SIZE)
+
+typedef enum {
+    SHM_REQQ_SLOT_FREE = 0,   /* available to client */
+    SHM_REQQ_SLOT_POSTED,     /* request is ready for server */
+    SHM_REQQ_SLOT_DONE,       /* result is ready for client */
+    SHM_REQQ_SLOT_ABANDONED   /* client stopped waiting for result */
+} shm_reqq_slot_state_e;
+
+typedef struct {
+    volatile uint32_t doorbell;       /* incremented to wake server */
+    volatile uint32_t server_waiting; /* set while server sleeps */
+} unifyfs_shm_reqq_header_t;
+
+/* fixed request arguments and results, variable-size data (i.e., read
+ * extents, or a returned filename) follows them in the slot */
+typedef struct {
+    int64_t gfid;
+    uint64_t size;            /* truncate size (in), file size (out) */
+    int32_t mread_id;         /* client mread id (in) */
+    int32_t read_count;       /* number of read extents in data (in) */
+    uint64_t trace_id;        /* request trace id, 0 if not traced (in) */
+    int32_t cacheable;        /* stat result may be cached (out) */
+    unifyfs_file_attr_t attr; /* file attributes, filename in data (out) */
+} unifyfs_shm_reqq_args_t;
+
+typedef struct {
+    volatile uint32_t state;          /* shm_reqq_slot_state_e */
+    volatile uint32_t client_waiting; /* set while client sleeps */
+    int32_t req_type;                 /* client_rpc_e */
+    int32_t ret;                      /* result of request */
+    uint32_t data_size;               /* bytes of data in use */
+    unifyfs_shm_reqq_args_t args;
+    char data[];
+} unifyfs_shm_reqq_slot_t;
+
+#define UNIFYFS_SHM_REQQ_DATA_MAX \
+    (UNIFYFS_SHM_REQQ_SLOT_SIZE - sizeof(unifyfs_shm_reqq_slot_t))
+
+static inline
+unifyfs_shm_reqq_slot_t* unifyfs_shm_reqq_slot(void* queue,
+                                               uint64_t index)
+{
+    size_t slot = 1 + (size_t)(index % UNIFYFS_SHM_REQQ_DEPTH);
+    return (unifyfs_shm_reqq_slot_t*)
+        ((char*)queue + (slot * UNIFYFS_SHM_REQQ_SLOT_SIZE));
+}
+
 enum {
     UNIFYFS_STAT_DEFAULT_DEV = 0,
     UNIFYFS_STAT_DEFAULT_BLKSIZE = 4096,
@@ -112,7 +225,7 @@ void debug_print_file_attr(unifyfs_file_attr_t* attr)
     if (!attr) {
         return;
     }
-    LOGDBG("fileattr(%p) - gfid=%d filename=%s",
+    LOGDBG("fileattr(%p) - gfid=%" PRId64 " filename=%s",
            attr, attr->gfid, attr->filename);
     LOGDBG("             - sz=%zu mode=%o uid=%d gid=%d",
            (size_t)attr->size, attr->mode, attr->uid, attr->gid);
@@ -150,7 +263,7 @@ int unifyfs_file_attr_update(int attr_op,
         return EINVAL;
     }
 
-    LOGDBG("updating attributes for gfid=%d", dst->gfid);
+    LOGDBG("updating attributes for gfid=%" PRId64, dst->gfid);
 
     /* Update fields only with valid values and associated operation.
      * invalid values are set by unifyfs_file_attr_set_invalid() above */
@@ -322,26 +435,35 @@ int compare_int(const void* a, const void* b)
 uint64_t compute_path_md5(const char* path);
 
 /*
- * Hash a file path to an integer gfid
+ * Hash a file path to a 64-bit gfid
  * @param path absolute file path
  * @return gfid
  */
 static inline
-int unifyfs_generate_gfid(const char* path)
+int64_t unifyfs_generate_gfid(const char* path)
 {
-    /* until we support 64-bit gfids, use top 32 bits */
     uint64_t hash64 = compute_path_md5(path);
-    uint32_t hash32 = (uint32_t)(hash64 >> 32);
 
-    /* TODO: Remove next statement once we get rid of MDHIM.
-     *
-     * MDHIM requires positive values for integer keys, due to the way
-     * slice servers are calculated. We use an integer key for the
-     * gfid -> file attributes index. To guarantee a positive value, we
-     * shift right one bit to make sure the top bit is zero. */
-    hash32 = hash32 >> 1;
+    /* keep the top bit clear so that gfids are positive, which leaves
+     * negative values free to mean "no file" (e.g., -1). with 63 bits,
+     * the chance of any two paths sharing a gfid stays below one in a
+     * million up to a few million files. servers still check the path
+     * on create to catch the case where two paths do collide */
+    return (int64_t)(hash64 >> 1);
+}
+
+/*
+ * Hash a mount point path to a positive 32-bit application id
+ * @param path absolute mount point path
+ * @return app id
+ */
+static inline
+int unifyfs_generate_app_id(const char* path)
+{
+    uint64_t hash64 = compute_path_md5(path);
 
-    return (int)hash32;
+    /* use the top 31 bits, so that the value is positive */
+    return (int)((uint32_t)(hash64 >> 32) >> 1);
 }
 
 #ifdef __cplusplus
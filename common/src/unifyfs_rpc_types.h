@@ -20,6 +20,7 @@
 #include <time.h>
 
 #include "unifyfs_meta.h"
+#include "unifyfs_trace.h"
 
 /* rpc encode/decode for timespec structs */
 typedef struct timespec sys_timespec_t;
@@ -28,9 +29,16 @@ MERCURY_GEN_STRUCT_PROC(sys_timespec_t,
     ((uint64_t)(tv_nsec))
 )
 
+/* rpc encode/decode for request trace context, which is included in the
+ * inputs of rpcs on the read and sync paths so that servers can record
+ * the stages of traced requests (see unifyfs_trace.h) */
+MERCURY_GEN_STRUCT_PROC(unifyfs_trace_ctx_t,
+    ((uint64_t)(id))
+)
+
 /* rpc encode/decode for unifyfs_file_attr_t */
 MERCURY_GEN_STRUCT_PROC(unifyfs_file_attr_t,
-    ((int32_t)(gfid))
+    ((int64_t)(gfid))
     ((int32_t)(is_laminated))
     ((int32_t)(is_shared))
     ((uint32_t)(mode))
@@ -45,6 +45,7 @@ typedef enum {
     UNIFYFS_SERVER_BCAST_RPC_EXTENTS,
     UNIFYFS_SERVER_BCAST_RPC_FILEATTR,
     UNIFYFS_SERVER_BCAST_RPC_LAMINATE,
+    UNIFYFS_SERVER_BCAST_RPC_TRANSFER,
     UNIFYFS_SERVER_BCAST_RPC_TRUNCATE,
     UNIFYFS_SERVER_BCAST_RPC_UNLINK
 } server_rpc_e;
@@ -66,6 +67,7 @@ MERCURY_GEN_PROC(chunk_read_request_in_t,
                  ((int32_t)(client_id))
                  ((int32_t)(req_id))
                  ((int32_t)(num_chks))
+                 ((unifyfs_trace_ctx_t)(trace))
                  ((hg_size_t)(total_data_size))
                  ((hg_size_t)(bulk_size))
                  ((hg_bulk_t)(bulk_handle)))
@@ -89,20 +91,25 @@ DECLARE_MARGO_RPC_HANDLER(chunk_read_response_rpc)
 /* Add file extents at owner */
 MERCURY_GEN_PROC(add_extents_in_t,
                  ((int32_t)(src_rank))
-                 ((int32_t)(gfid))
+                 ((int64_t)(gfid))
                  ((int32_t)(num_extents))
                  ((hg_bulk_t)(extents)))
 MERCURY_GEN_PROC(add_extents_out_t,
                  ((int32_t)(ret)))
 DECLARE_MARGO_RPC_HANDLER(add_extents_rpc)
 
-/* Find file extent locations by querying owner */
+/* Find file extent locations by querying owner. The owner returns its
+ * current extent version for the file. If that matches the version sent
+ * by the requester, which has cached locations from an earlier lookup,
+ * no locations are returned and the cached ones are still valid. */
 MERCURY_GEN_PROC(find_extents_in_t,
                  ((int32_t)(src_rank))
-                 ((int32_t)(gfid))
+                 ((int64_t)(gfid))
+                 ((uint64_t)(version))
                  ((int32_t)(num_extents))
                  ((hg_bulk_t)(extents)))
 MERCURY_GEN_PROC(find_extents_out_t,
+                 ((uint64_t)(version))
                  ((int32_t)(num_locations))
                  ((hg_bulk_t)(locations))
                  ((int32_t)(ret)))
@@ -110,7 +117,7 @@ DECLARE_MARGO_RPC_HANDLER(find_extents_rpc)
 
 /* Get file size from owner */
 MERCURY_GEN_PROC(filesize_in_t,
-                 ((int32_t)(gfid)))
+                 ((int64_t)(gfid)))
 MERCURY_GEN_PROC(filesize_out_t,
                  ((hg_size_t)(filesize))
                  ((int32_t)(ret)))
@@ -118,22 +125,32 @@ DECLARE_MARGO_RPC_HANDLER(filesize_rpc)
 
 /* Laminate file at owner */
 MERCURY_GEN_PROC(laminate_in_t,
-                 ((int32_t)(gfid)))
+                 ((int64_t)(gfid)))
 MERCURY_GEN_PROC(laminate_out_t,
                  ((int32_t)(ret)))
 DECLARE_MARGO_RPC_HANDLER(laminate_rpc)
 
-/* Get file metadata from owner */
+/* Get file metadata from owner, which may grant the requesting server
+ * a lease on the attributes (leased=1) */
 MERCURY_GEN_PROC(metaget_in_t,
-                 ((int32_t)(gfid)))
+                 ((int32_t)(src_rank))
+                 ((int64_t)(gfid)))
 MERCURY_GEN_PROC(metaget_out_t,
                  ((unifyfs_file_attr_t)(attr))
+                 ((int32_t)(leased))
                  ((int32_t)(ret)))
 DECLARE_MARGO_RPC_HANDLER(metaget_rpc)
 
+/* Revoke a file metadata lease granted by owner */
+MERCURY_GEN_PROC(lease_revoke_in_t,
+                 ((int64_t)(gfid)))
+MERCURY_GEN_PROC(lease_revoke_out_t,
+                 ((int32_t)(ret)))
+DECLARE_MARGO_RPC_HANDLER(lease_revoke_rpc)
+
 /* Set file metadata at owner */
 MERCURY_GEN_PROC(metaset_in_t,
-                 ((int32_t)(gfid))
+                 ((int64_t)(gfid))
                  ((int32_t)(fileop))
                  ((unifyfs_file_attr_t)(attr)))
 MERCURY_GEN_PROC(metaset_out_t,
@@ -142,7 +159,7 @@ DECLARE_MARGO_RPC_HANDLER(metaset_rpc)
 
 /* Truncate file at owner */
 MERCURY_GEN_PROC(truncate_in_t,
-                 ((int32_t)(gfid))
+                 ((int64_t)(gfid))
                  ((hg_size_t)(filesize)))
 MERCURY_GEN_PROC(truncate_out_t,
                  ((int32_t)(ret)))
@@ -160,7 +177,7 @@ DECLARE_MARGO_RPC_HANDLER(bcast_progress_rpc)
 /* Broadcast file extents to all servers */
 MERCURY_GEN_PROC(extent_bcast_in_t,
                  ((int32_t)(root))
-                 ((int32_t)(gfid))
+                 ((int64_t)(gfid))
                  ((int32_t)(num_extents))
                  ((hg_bulk_t)(extents)))
 MERCURY_GEN_PROC(extent_bcast_out_t,
@@ -170,7 +187,7 @@ DECLARE_MARGO_RPC_HANDLER(extent_bcast_rpc)
 /* Broadcast file metadata to all servers */
 MERCURY_GEN_PROC(fileattr_bcast_in_t,
                  ((int32_t)(root))
-                 ((int32_t)(gfid))
+                 ((int64_t)(gfid))
                  ((int32_t)(attrop))
                  ((unifyfs_file_attr_t)(attr)))
 MERCURY_GEN_PROC(fileattr_bcast_out_t,
@@ -180,7 +197,7 @@ DECLARE_MARGO_RPC_HANDLER(fileattr_bcast_rpc)
 /* Broadcast laminated file metadata to all servers */
 MERCURY_GEN_PROC(laminate_bcast_in_t,
                  ((int32_t)(root))
-                 ((int32_t)(gfid))
+                 ((int64_t)(gfid))
                  ((int32_t)(num_extents))
                  ((unifyfs_file_attr_t)(attr))
                  ((hg_bulk_t)(extents)))
@@ -188,10 +205,19 @@ MERCURY_GEN_PROC(laminate_bcast_out_t,
                  ((int32_t)(ret)))
 DECLARE_MARGO_RPC_HANDLER(laminate_bcast_rpc)
 
+/* Broadcast stage-out of laminated file data to all servers */
+MERCURY_GEN_PROC(transfer_bcast_in_t,
+                 ((int32_t)(root))
+                 ((int64_t)(gfid))
+                 ((hg_const_string_t)(dst_file)))
+MERCURY_GEN_PROC(transfer_bcast_out_t,
+                 ((int32_t)(ret)))
+DECLARE_MARGO_RPC_HANDLER(transfer_bcast_rpc)
+
 /* Broadcast truncation point to all servers */
 MERCURY_GEN_PROC(truncate_bcast_in_t,
                  ((int32_t)(root))
-                 ((int32_t)(gfid))
+                 ((int64_t)(gfid))
                  ((hg_size_t)(filesize)))
 MERCURY_GEN_PROC(truncate_bcast_out_t,
                  ((int32_t)(ret)))
@@ -200,7 +226,7 @@ DECLARE_MARGO_RPC_HANDLER(truncate_bcast_rpc)
 /* Broadcast unlink to all servers */
 MERCURY_GEN_PROC(unlink_bcast_in_t,
                  ((int32_t)(root))
-                 ((int32_t)(gfid)))
+                 ((int64_t)(gfid)))
 MERCURY_GEN_PROC(unlink_bcast_out_t,
                  ((int32_t)(ret)))
 DECLARE_MARGO_RPC_HANDLER(unlink_bcast_rpc)
@@ -18,20 +18,49 @@
 #include <fcntl.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <linux/futex.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/syscall.h>
 #include <sys/types.h>
 
 #include "unifyfs_const.h"
 #include "unifyfs_log.h"
 #include "unifyfs_shm.h"
 
-/* Allocate a shared memory region with given name and size,
- * and map it into memory.
+#ifdef HAVE_POSIX_FALLOCATE
+/* Reserve memory for [offset, offset + length) of the shared memory
+ * file open on fd. Returns 0 on success, or an errno value */
+static int shm_fallocate(int fd, const char* name,
+                         size_t offset, size_t length)
+{
+    int ret;
+    int try_count = 0;
+    do { /* this loop handles syscall interruption for large allocations */
+        ret = posix_fallocate(fd, (off_t)offset, (off_t)length);
+        if (ret != 0) {
+            /* failed to set size shared memory */
+            try_count++;
+            if ((ret != EINTR) || (try_count >= 5)) {
+                LOGERR("posix_fallocate failed for %s (%s)",
+                    name, strerror(ret));
+                return ret;
+            }
+        }
+    } while (ret != 0);
+    return 0;
+}
+#endif
+
+/* Open (creating if needed) the shared memory region with given name,
+ * set its size, and map it into memory. If reserve is set, memory for
+ * the whole region is reserved up front. Otherwise, pages are only
+ * backed once they are reserved with unifyfs_shm_reserve() or touched.
  * Returns a pointer to shm_context for region if successful,
  * or NULL on error */
-shm_context* unifyfs_shm_alloc(const char* name, size_t size)
+static shm_context* shm_map(const char* name, size_t size, int reserve)
 {
     int ret;
 
@@ -47,31 +76,31 @@ shm_context* unifyfs_shm_alloc(const char* name, size_t size)
 
     /* set size of shared memory region */
 #ifdef HAVE_POSIX_FALLOCATE
-    do { /* this loop handles syscall interruption for large allocations */
-        int try_count = 0;
-        ret = posix_fallocate(fd, 0, size);
-        if (ret != 0) {
-            /* failed to set size shared memory */
-            try_count++;
-            if ((ret != EINTR) || (try_count >= 5)) {
-                LOGERR("posix_fallocate failed for %s (%s)",
-                    name, strerror(ret));
-                close(fd);
-                return NULL;
-            }
+    if (reserve) {
+        if (shm_fallocate(fd, name, 0, size) != 0) {
+            close(fd);
+            return NULL;
         }
-    } while (ret != 0);
-#else
-    errno = 0;
-    ret = ftruncate(fd, size);
-    if (ret == -1) {
-        /* failed to set size of shared memory */
-        LOGERR("ftruncate failed for %s (%s)",
-               name, strerror(errno));
-        close(fd);
-        return NULL;
     }
+#else
+    reserve = 0;
 #endif
+    if (!reserve) {
+        /* only grow the region, it may already hold reserved pages */
+        struct stat st;
+        errno = 0;
+        ret = fstat(fd, &st);
+        if ((ret == 0) && ((size_t)st.st_size < size)) {
+            ret = ftruncate(fd, size);
+        }
+        if (ret == -1) {
+            /* failed to set size of shared memory */
+            LOGERR("ftruncate failed for %s (%s)",
+                   name, strerror(errno));
+            close(fd);
+            return NULL;
+        }
+    }
 
     /* map shared memory region into address space */
     errno = 0;
@@ -106,6 +135,55 @@ shm_context* unifyfs_shm_alloc(const char* name, size_t size)
     return ctx;
 }
 
+/* Allocate a shared memory region with given name and size,
+ * and map it into memory.
+ * Returns a pointer to shm_context for region if successful,
+ * or NULL on error */
+shm_context* unifyfs_shm_alloc(const char* name, size_t size)
+{
+    return shm_map(name, size, 1);
+}
+
+/* Allocate a shared memory region with given name and size, and map it
+ * into memory without reserving memory for it.
+ * Returns a pointer to shm_context for region if successful,
+ * or NULL on error */
+shm_context* unifyfs_shm_alloc_sparse(const char* name, size_t size)
+{
+    return shm_map(name, size, 0);
+}
+
+/* Reserve memory for [offset, offset + length) of a shared memory region,
+ * so that running out of memory is reported here, rather than as a bus
+ * error when the pages are first touched.
+ * Returns UNIFYFS_SUCCESS on success, or error code */
+int unifyfs_shm_reserve(shm_context* ctx, size_t offset, size_t length)
+{
+    if ((NULL == ctx) || ((offset + length) > ctx->size)) {
+        return EINVAL;
+    }
+
+#ifdef HAVE_POSIX_FALLOCATE
+    if (length > 0) {
+        errno = 0;
+        int fd = shm_open(ctx->name, O_RDWR, 0770);
+        if (fd == -1) {
+            int err = errno;
+            LOGERR("Failed to open shared memory %s (%s)",
+                   ctx->name, strerror(err));
+            return err;
+        }
+        int ret = shm_fallocate(fd, ctx->name, offset, length);
+        close(fd);
+        if (ret != 0) {
+            return ret;
+        }
+    }
+#endif
+
+    return UNIFYFS_SUCCESS;
+}
+
 /* Unmaps shared memory region and frees its context.
  * The shm_context pointer is set to NULL on success.
  * Returns UNIFYFS_SUCCESS on success, or error code */
@@ -173,3 +251,36 @@ int unifyfs_shm_unlink(shm_context* ctx)
 
     return UNIFYFS_SUCCESS;
 }
+
+/* Wait while the word at addr in shared memory holds val. We use the
+ * non-private futex operations, since the word is mapped by both the
+ * client and the server process.
+ * Returns UNIFYFS_SUCCESS if woken (or the word changed), or
+ * UNIFYFS_ERROR_TIMEOUT if the timeout expired */
+int unifyfs_shm_futex_wait(volatile uint32_t* addr,
+                           uint32_t val,
+                           long timeout_usec)
+{
+    struct timespec timeout;
+    timeout.tv_sec  = timeout_usec / 1000000;
+    timeout.tv_nsec = (timeout_usec % 1000000) * 1000;
+
+    errno = 0;
+    long rc = syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAIT, val,
+                      &timeout, NULL, 0);
+    if ((rc == -1) && (errno == ETIMEDOUT)) {
+        return UNIFYFS_ERROR_TIMEOUT;
+    }
+
+    /* EAGAIN means the word no longer held val, and EINTR that we
+     * were interrupted, either way the caller checks the word again */
+    return UNIFYFS_SUCCESS;
+}
+
+/* Wake up to count waiters on the word at addr in shared memory */
+void unifyfs_shm_futex_wake(volatile uint32_t* addr,
+                            int count)
+{
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAKE, count,
+            NULL, NULL, 0);
+}
@@ -17,6 +17,7 @@
 
 #include <pthread.h>
 #include <stddef.h>
+#include <stdint.h>
 
 #include "unifyfs_rc.h"
 
@@ -44,7 +45,7 @@ extern "C" {
 typedef struct shm_data_meta {
     size_t offset;
     size_t length;
-    int gfid;
+    int64_t gfid;
     int errcode;
 } shm_data_meta;
 
@@ -84,6 +85,25 @@ typedef struct shm_context {
  */
 shm_context* unifyfs_shm_alloc(const char* name, size_t size);
 
+/**
+ * Allocate a shared memory region with given name and size, and map it
+ * into memory, but do not reserve memory for it. Memory is only used for
+ * pages that are reserved with unifyfs_shm_reserve() or touched.
+ * @param name region name
+ * @param size region size in bytes
+ * @return shmem context pointer (NULL on failure)
+ */
+shm_context* unifyfs_shm_alloc_sparse(const char* name, size_t size);
+
+/**
+ * Reserve memory for part of a shared memory region.
+ * @param ctx shmem context pointer
+ * @param offset offset of part within region
+ * @param length length of part in bytes
+ * @return UNIFYFS_SUCCESS or error code
+ */
+int unifyfs_shm_reserve(shm_context* ctx, size_t offset, size_t length);
+
 /**
  * Unmaps shared memory region and frees its context. Context pointer
  * is set to NULL on success.
@@ -99,6 +119,28 @@ int unifyfs_shm_free(shm_context** pctx);
  */
 int unifyfs_shm_unlink(shm_context* ctx);
 
+/**
+ * Wait while the 32-bit word at addr within a shared memory region
+ * holds val, for at most timeout_usec microseconds. The wait may end
+ * early, so callers must check the word again.
+ * @param addr address of word in shared memory
+ * @param val value the word is expected to hold
+ * @param timeout_usec maximum wait in microseconds
+ * @return UNIFYFS_SUCCESS, or UNIFYFS_ERROR_TIMEOUT
+ */
+int unifyfs_shm_futex_wait(volatile uint32_t* addr,
+                           uint32_t val,
+                           long timeout_usec);
+
+/**
+ * Wake up processes and threads waiting on the 32-bit word at addr
+ * within a shared memory region.
+ * @param addr address of word in shared memory
+ * @param count maximum number of waiters to wake
+ */
+void unifyfs_shm_futex_wake(volatile uint32_t* addr,
+                            int count);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,502 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#include "unifyfs_const.h"
+#include "unifyfs_log.h"
+#include "unifyfs_stats.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+__thread unifyfs_stats_block_t* unifyfs_stats_my_block; // = NULL
+
+/* list of all blocks, new blocks are pushed at the head */
+static unifyfs_stats_block_t* block_list; // = NULL
+
+static pthread_key_t block_key;
+static pthread_once_t block_key_once = PTHREAD_ONCE_INIT;
+
+static uint64_t gauges[UNIFYFS_STATS_NUM_GAUGES];
+
+#define UNIFYFS_STATS_NAME(id, name) name,
+static const char* hist_names[UNIFYFS_STATS_NUM_HISTS] = {
+    UNIFYFS_STATS_HISTS(UNIFYFS_STATS_NAME)
+};
+static const char* counter_names[UNIFYFS_STATS_NUM_COUNTERS] = {
+    UNIFYFS_STATS_COUNTERS(UNIFYFS_STATS_NAME)
+};
+static const char* gauge_names[UNIFYFS_STATS_NUM_GAUGES] = {
+    UNIFYFS_STATS_GAUGES(UNIFYFS_STATS_NAME)
+};
+#undef UNIFYFS_STATS_NAME
+
+static const char* rpc_class_names[UNIFYFS_STATS_NUM_RPC_CLASSES] = {
+    "client_rpc",
+    "server_rpc",
+    "bcast",
+    "trace_stages"
+};
+
+static struct {
+    const char* const* names;
+    int n_names;
+} rpc_names[UNIFYFS_STATS_NUM_RPC_CLASSES];
+
+static const char* stats_label = "unifyfs";
+static void (*stats_update_fn)(void); // = NULL
+static uint64_t start_ns; // = 0
+
+/* periodic dump thread state */
+static pthread_t dump_thread;
+static pthread_mutex_t dump_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t dump_cond = PTHREAD_COND_INITIALIZER;
+static int dump_running; // = 0
+static int dump_exit; // = 0
+static int dump_interval; // = 0
+static char dump_path[PATH_MAX];
+
+/* mark the block of an exiting thread as reusable, its values remain
+ * part of the totals */
+static void block_release(void* arg)
+{
+    unifyfs_stats_block_t* blk = (unifyfs_stats_block_t*) arg;
+    __atomic_store_n(&blk->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void create_block_key(void)
+{
+    pthread_key_create(&block_key, block_release);
+}
+
+/* get the block for this thread, reusing a block of an exited thread */
+unifyfs_stats_block_t* unifyfs_stats_get_block(void)
+{
+    if (NULL != unifyfs_stats_my_block) {
+        return unifyfs_stats_my_block;
+    }
+
+    pthread_once(&block_key_once, create_block_key);
+
+    unifyfs_stats_block_t* blk = __atomic_load_n(&block_list,
+                                                 __ATOMIC_ACQUIRE);
+    for (; NULL != blk; blk = blk->next) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&blk->in_use, &expected, 1, 0,
+                                        __ATOMIC_ACQ_REL,
+                                        __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (NULL == blk) {
+        blk = calloc(1, sizeof(unifyfs_stats_block_t));
+        if (NULL == blk) {
+            return NULL;
+        }
+        blk->in_use = 1;
+        blk->next = __atomic_load_n(&block_list, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&block_list, &blk->next, blk,
+                                            0, __ATOMIC_RELEASE,
+                                            __ATOMIC_RELAXED)) {
+            ;
+        }
+    }
+
+    unifyfs_stats_my_block = blk;
+    pthread_setspecific(block_key, blk);
+    return blk;
+}
+
+unifyfs_stats_hist_t* unifyfs_stats_get_rpcs(unifyfs_stats_block_t* blk,
+                                             unifyfs_stats_rpc_class_e cls)
+{
+    unifyfs_stats_hist_t* rpcs = __atomic_load_n(&blk->rpcs[cls],
+                                                 __ATOMIC_ACQUIRE);
+    if (NULL == rpcs) {
+        rpcs = calloc(UNIFYFS_STATS_MAX_RPC_TYPES, sizeof(*rpcs));
+        if (NULL != rpcs) {
+            __atomic_store_n(&blk->rpcs[cls], rpcs, __ATOMIC_RELEASE);
+        }
+    }
+    return rpcs;
+}
+
+void unifyfs_stats_set_gauge(unifyfs_stats_gauge_e id, uint64_t val)
+{
+    __atomic_store_n(&gauges[id], val, __ATOMIC_RELAXED);
+}
+
+void unifyfs_stats_set_rpc_names(unifyfs_stats_rpc_class_e cls,
+                                 const char* const* names,
+                                 int n_names)
+{
+    rpc_names[cls].names = names;
+    rpc_names[cls].n_names = n_names;
+}
+
+void unifyfs_stats_init(const char* label,
+                        void (*update_fn)(void))
+{
+    if (NULL != label) {
+        stats_label = label;
+    }
+    stats_update_fn = update_fn;
+    start_ns = unifyfs_stats_now_ns();
+}
+
+/*
+ * Snapshots
+ */
+
+static void hist_sum(unifyfs_stats_hist_t* total,
+                     unifyfs_stats_hist_t* hist)
+{
+    total->count += __atomic_load_n(&hist->count, __ATOMIC_RELAXED);
+    total->sum_ns += __atomic_load_n(&hist->sum_ns, __ATOMIC_RELAXED);
+    uint64_t max = __atomic_load_n(&hist->max_ns, __ATOMIC_RELAXED);
+    if (max > total->max_ns) {
+        total->max_ns = max;
+    }
+    for (int b = 0; b < UNIFYFS_STATS_HIST_BUCKETS; b++) {
+        total->buckets[b] += __atomic_load_n(&hist->buckets[b],
+                                             __ATOMIC_RELAXED);
+    }
+}
+
+typedef struct {
+    uint64_t counters[UNIFYFS_STATS_NUM_COUNTERS];
+    unifyfs_stats_hist_t hists[UNIFYFS_STATS_NUM_HISTS];
+    unifyfs_stats_hist_t rpcs[UNIFYFS_STATS_NUM_RPC_CLASSES]
+                             [UNIFYFS_STATS_MAX_RPC_TYPES];
+} stats_snapshot;
+
+static void take_snapshot(stats_snapshot* snap)
+{
+    memset(snap, 0, sizeof(*snap));
+    unifyfs_stats_block_t* blk = __atomic_load_n(&block_list,
+                                                 __ATOMIC_ACQUIRE);
+    for (; NULL != blk; blk = blk->next) {
+        for (int i = 0; i < UNIFYFS_STATS_NUM_COUNTERS; i++) {
+            snap->counters[i] += __atomic_load_n(&blk->counters[i],
+                                                 __ATOMIC_RELAXED);
+        }
+        for (int i = 0; i < UNIFYFS_STATS_NUM_HISTS; i++) {
+            hist_sum(&(snap->hists[i]), &(blk->hists[i]));
+        }
+        for (int c = 0; c < UNIFYFS_STATS_NUM_RPC_CLASSES; c++) {
+            unifyfs_stats_hist_t* rpcs = __atomic_load_n(&blk->rpcs[c],
+                                                         __ATOMIC_ACQUIRE);
+            if (NULL == rpcs) {
+                continue;
+            }
+            for (int t = 0; t < UNIFYFS_STATS_MAX_RPC_TYPES; t++) {
+                hist_sum(&(snap->rpcs[c][t]), rpcs + t);
+            }
+        }
+    }
+}
+
+/* growable string buffer for building JSON */
+typedef struct {
+    char* buf;
+    size_t len;
+    size_t cap;
+    int err;
+} json_buf;
+
+static void jb_printf(json_buf* jb, const char* fmt, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void jb_printf(json_buf* jb, const char* fmt, ...)
+{
+    if (jb->err) {
+        return;
+    }
+
+    while (1) {
+        va_list args;
+        va_start(args, fmt);
+        size_t avail = jb->cap - jb->len;
+        int n = vsnprintf(jb->buf + jb->len, avail, fmt, args);
+        va_end(args);
+        if (n < 0) {
+            jb->err = EINVAL;
+            return;
+        }
+        if ((size_t)n < avail) {
+            jb->len += (size_t)n;
+            return;
+        }
+
+        size_t new_cap = (jb->cap * 2) + (size_t)n;
+        char* new_buf = realloc(jb->buf, new_cap);
+        if (NULL == new_buf) {
+            jb->err = ENOMEM;
+            return;
+        }
+        jb->buf = new_buf;
+        jb->cap = new_cap;
+    }
+}
+
+/* estimate a percentile as the upper bound of the bucket holding it */
+static uint64_t hist_percentile(unifyfs_stats_hist_t* hist, double pct)
+{
+    if (0 == hist->count) {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)((pct / 100.0) * (double)hist->count);
+    if (target < 1) {
+        target = 1;
+    }
+    uint64_t seen = 0;
+    for (int b = 0; b < UNIFYFS_STATS_HIST_BUCKETS; b++) {
+        seen += hist->buckets[b];
+        if (seen >= target) {
+            uint64_t upper = (uint64_t)1 << (b + 1);
+            return (upper < hist->max_ns) ? upper : hist->max_ns;
+        }
+    }
+    return hist->max_ns;
+}
+
+static void hist_to_json(json_buf* jb, unifyfs_stats_hist_t* hist)
+{
+    uint64_t mean = hist->count ? (hist->sum_ns / hist->count) : 0;
+    jb_printf(jb, "{\"count\":%llu,\"mean_ns\":%llu,\"max_ns\":%llu,"
+              "\"p50_ns\":%llu,\"p90_ns\":%llu,\"p99_ns\":%llu,"
+              "\"buckets\":[",
+              (unsigned long long) hist->count,
+              (unsigned long long) mean,
+              (unsigned long long) hist->max_ns,
+              (unsigned long long) hist_percentile(hist, 50.0),
+              (unsigned long long) hist_percentile(hist, 90.0),
+              (unsigned long long) hist_percentile(hist, 99.0));
+
+    /* non-empty buckets as [lower bound in ns, count] */
+    const char* sep = "";
+    for (int b = 0; b < UNIFYFS_STATS_HIST_BUCKETS; b++) {
+        if (hist->buckets[b]) {
+            uint64_t lower = b ? ((uint64_t)1 << b) : 0;
+            jb_printf(jb, "%s[%llu,%llu]", sep,
+                      (unsigned long long) lower,
+                      (unsigned long long) hist->buckets[b]);
+            sep = ",";
+        }
+    }
+    jb_printf(jb, "]}");
+}
+
+/* histograms of a class for types that have been used, by name */
+static void rpc_hists_to_json(json_buf* jb, stats_snapshot* snap, int c)
+{
+    jb_printf(jb, "{");
+    const char* sep = "";
+    for (int t = 0; t < UNIFYFS_STATS_MAX_RPC_TYPES; t++) {
+        unifyfs_stats_hist_t* hist = &(snap->rpcs[c][t]);
+        if (0 == hist->count) {
+            continue;
+        }
+        if ((t < rpc_names[c].n_names) &&
+            (NULL != rpc_names[c].names[t])) {
+            jb_printf(jb, "%s\"%s\":", sep, rpc_names[c].names[t]);
+        } else {
+            jb_printf(jb, "%s\"type_%d\":", sep, t);
+        }
+        hist_to_json(jb, hist);
+        sep = ",";
+    }
+    jb_printf(jb, "}");
+}
+
+int unifyfs_stats_to_json(char** json, size_t* json_len)
+{
+    if ((NULL == json) || (NULL == json_len)) {
+        return EINVAL;
+    }
+    *json = NULL;
+    *json_len = 0;
+
+    if (NULL != stats_update_fn) {
+        stats_update_fn();
+    }
+
+    stats_snapshot* snap = malloc(sizeof(stats_snapshot));
+    if (NULL == snap) {
+        return ENOMEM;
+    }
+    take_snapshot(snap);
+
+    json_buf jb = { .buf = malloc(4096), .len = 0, .cap = 4096, .err = 0 };
+    if (NULL == jb.buf) {
+        free(snap);
+        return ENOMEM;
+    }
+
+    char host[64] = "unknown";
+    gethostname(host, sizeof(host));
+    host[sizeof(host) - 1] = '\0';
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+    double uptime = (double)(unifyfs_stats_now_ns() - start_ns) / 1e9;
+
+    jb_printf(&jb, "{\"label\":\"%s\",\"host\":\"%s\",\"pid\":%d,"
+              "\"time\":%ld.%06ld,\"uptime_sec\":%.3f",
+              stats_label, host, (int) getpid(),
+              (long) now.tv_sec, (long) now.tv_usec, uptime);
+
+    jb_printf(&jb, ",\"counters\":{");
+    for (int i = 0; i < UNIFYFS_STATS_NUM_COUNTERS; i++) {
+        jb_printf(&jb, "%s\"%s\":%llu", (i ? "," : ""), counter_names[i],
+                  (unsigned long long) snap->counters[i]);
+    }
+
+    jb_printf(&jb, "},\"gauges\":{");
+    for (int i = 0; i < UNIFYFS_STATS_NUM_GAUGES; i++) {
+        uint64_t val = __atomic_load_n(&gauges[i], __ATOMIC_RELAXED);
+        jb_printf(&jb, "%s\"%s\":%llu", (i ? "," : ""), gauge_names[i],
+                  (unsigned long long) val);
+    }
+
+    jb_printf(&jb, "},\"histograms\":{");
+    for (int i = 0; i < UNIFYFS_STATS_NUM_HISTS; i++) {
+        jb_printf(&jb, "%s\"%s\":", (i ? "," : ""), hist_names[i]);
+        hist_to_json(&jb, &(snap->hists[i]));
+    }
+
+    /* rpc histograms, only for types that have been used */
+    jb_printf(&jb, "},\"rpcs\":{");
+    for (int c = 0; c < UNIFYFS_STATS_NUM_RPC_CLASSES; c++) {
+        if (c == UNIFYFS_STATS_TRACE_STAGES) {
+            continue;
+        }
+        jb_printf(&jb, "%s\"%s\":", (c ? "," : ""), rpc_class_names[c]);
+        rpc_hists_to_json(&jb, snap, c);
+    }
+
+    /* per-stage breakdown of traced requests */
+    jb_printf(&jb, "},\"%s\":",
+              rpc_class_names[UNIFYFS_STATS_TRACE_STAGES]);
+    rpc_hists_to_json(&jb, snap, UNIFYFS_STATS_TRACE_STAGES);
+    jb_printf(&jb, "}");
+    free(snap);
+
+    if (jb.err) {
+        free(jb.buf);
+        return jb.err;
+    }
+
+    *json = jb.buf;
+    *json_len = jb.len;
+    return UNIFYFS_SUCCESS;
+}
+
+/*
+ * Periodic dumps
+ */
+
+static void dump_snapshot(void)
+{
+    char* json = NULL;
+    size_t len = 0;
+    int rc = unifyfs_stats_to_json(&json, &len);
+    if (rc != UNIFYFS_SUCCESS) {
+        LOGERR("failed to take statistics snapshot (rc=%d)", rc);
+        return;
+    }
+
+    FILE* fp = fopen(dump_path, "a");
+    if (NULL == fp) {
+        LOGERR("failed to open statistics dump file %s - %s",
+               dump_path, strerror(errno));
+    } else {
+        fwrite(json, 1, len, fp);
+        fputc('\n', fp);
+        fclose(fp);
+    }
+    free(json);
+}
+
+static void* dump_thread_main(void* arg)
+{
+    pthread_mutex_lock(&dump_lock);
+    while (!dump_exit) {
+        struct timespec wake;
+        clock_gettime(CLOCK_REALTIME, &wake);
+        wake.tv_sec += dump_interval;
+        int rc = 0;
+        while (!dump_exit && (rc != ETIMEDOUT)) {
+            rc = pthread_cond_timedwait(&dump_cond, &dump_lock, &wake);
+        }
+        pthread_mutex_unlock(&dump_lock);
+        dump_snapshot();
+        pthread_mutex_lock(&dump_lock);
+    }
+    pthread_mutex_unlock(&dump_lock);
+    return NULL;
+}
+
+int unifyfs_stats_dump_start(const char* dir, int interval)
+{
+    if ((NULL == dir) || (interval <= 0)) {
+        return EINVAL;
+    }
+    if (dump_running) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    char host[64] = "unknown";
+    gethostname(host, sizeof(host));
+    host[sizeof(host) - 1] = '\0';
+    int n = snprintf(dump_path, sizeof(dump_path), "%s/%s.stats.%s.%d.json",
+                     dir, stats_label, host, (int) getpid());
+    if ((n < 0) || ((size_t)n >= sizeof(dump_path))) {
+        LOGERR("statistics dump path too long");
+        return EINVAL;
+    }
+
+    dump_interval = interval;
+    dump_exit = 0;
+    if (pthread_create(&dump_thread, NULL, dump_thread_main, NULL) != 0) {
+        LOGERR("failed to create statistics dump thread");
+        return UNIFYFS_FAILURE;
+    }
+    dump_running = 1;
+    LOGINFO("dumping statistics to %s every %d seconds",
+            dump_path, interval);
+    return UNIFYFS_SUCCESS;
+}
+
+void unifyfs_stats_dump_stop(void)
+{
+    if (!dump_running) {
+        return;
+    }
+
+    pthread_mutex_lock(&dump_lock);
+    dump_exit = 1;
+    pthread_cond_signal(&dump_cond);
+    pthread_mutex_unlock(&dump_lock);
+    pthread_join(dump_thread, NULL);
+    dump_running = 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#ifndef UNIFYFS_STATS_H
+#define UNIFYFS_STATS_H
+
+/*
+ * Performance counters and latency histograms
+ *
+ * Each thread updates its own block of statistics, so recording a value
+ * is a few relaxed loads and stores with no locks or shared cache lines.
+ * A snapshot sums the blocks of all threads, and is serialized as JSON.
+ * Gauges (e.g., log usage or queue depths) are not recorded as events,
+ * instead they are set by an update function just before each snapshot.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* latency histograms, as STAT(id, name) */
+#define UNIFYFS_STATS_HISTS(STAT) \
+    STAT(CLIENT_OPEN,       "client.open") \
+    STAT(CLIENT_READ,       "client.read") \
+    STAT(CLIENT_SYNC,       "client.sync") \
+    STAT(CLIENT_TRUNCATE,   "client.truncate") \
+    STAT(CLIENT_WRITE,      "client.write") \
+    STAT(RM_QUEUE_WAIT,     "rm.queue_wait") \
+    STAT(RM_SHM_REQUEST,    "rm.shm_request") \
+    STAT(SM_QUEUE_WAIT,     "sm.queue_wait") \
+    STAT(P2P_REQUEST,       "p2p.request")
+
+/* event and byte counters, as STAT(id, name) */
+#define UNIFYFS_STATS_COUNTERS(STAT) \
+    STAT(CLIENT_READ_BYTES,         "client.read_bytes") \
+    STAT(CLIENT_READ_LOCAL_BYTES,   "client.read_local_bytes") \
+    STAT(CLIENT_WRITE_BYTES,        "client.write_bytes") \
+    STAT(SERVER_READ_LOCAL_BYTES,   "server.read_local_bytes") \
+    STAT(SERVER_READ_REMOTE_BYTES,  "server.read_remote_bytes") \
+    STAT(SERVER_READ_SERVED_BYTES,  "server.read_served_bytes") \
+    STAT(P2P_ERRORS,                "p2p.errors")
+
+/* gauges, as STAT(id, name) */
+#define UNIFYFS_STATS_GAUGES(STAT) \
+    STAT(LOGIO_SHMEM_SIZE,  "logio.shmem_size") \
+    STAT(LOGIO_SHMEM_USED,  "logio.shmem_used") \
+    STAT(LOGIO_SPILL_SIZE,  "logio.spill_size") \
+    STAT(LOGIO_SPILL_USED,  "logio.spill_used") \
+    STAT(INODES,            "inodes") \
+    STAT(EXTENTS,           "extents") \
+    STAT(EXTENT_BYTES,      "extent_bytes") \
+    STAT(RM_QUEUE_DEPTH,    "rm.queue_depth") \
+    STAT(SM_QUEUE_DEPTH,    "sm.queue_depth")
+
+#define UNIFYFS_STATS_ENUM(id, name) UNIFYFS_STAT_##id,
+
+typedef enum {
+    UNIFYFS_STATS_HISTS(UNIFYFS_STATS_ENUM)
+    UNIFYFS_STATS_NUM_HISTS
+} unifyfs_stats_hist_e;
+
+typedef enum {
+    UNIFYFS_STATS_COUNTERS(UNIFYFS_STATS_ENUM)
+    UNIFYFS_STATS_NUM_COUNTERS
+} unifyfs_stats_counter_e;
+
+typedef enum {
+    UNIFYFS_STATS_GAUGES(UNIFYFS_STATS_ENUM)
+    UNIFYFS_STATS_NUM_GAUGES
+} unifyfs_stats_gauge_e;
+
+#undef UNIFYFS_STATS_ENUM
+
+/* RPC classes, each has a latency histogram per RPC type. Traced
+ * request stages (see unifyfs_trace.h) are kept the same way. */
+typedef enum {
+    UNIFYFS_STATS_RPC_CLIENT = 0, /* client rpcs handled by the server */
+    UNIFYFS_STATS_RPC_SERVER,     /* server rpcs handled by the svcmgr */
+    UNIFYFS_STATS_RPC_BCAST,      /* broadcasts forwarded to children */
+    UNIFYFS_STATS_TRACE_STAGES,   /* stages of sampled traced requests */
+    UNIFYFS_STATS_NUM_RPC_CLASSES
+} unifyfs_stats_rpc_class_e;
+
+#define UNIFYFS_STATS_MAX_RPC_TYPES 32
+
+/* histogram bucket b counts latencies in [2^b, 2^(b+1)) nanoseconds,
+ * the last bucket also counts anything longer */
+#define UNIFYFS_STATS_HIST_BUCKETS 40
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns;
+    uint64_t max_ns;
+    uint64_t buckets[UNIFYFS_STATS_HIST_BUCKETS];
+} unifyfs_stats_hist_t;
+
+/* per-thread block of statistics, only written by its owner thread */
+typedef struct unifyfs_stats_block {
+    struct unifyfs_stats_block* next;   /* list of all blocks */
+    int in_use;                         /* owned by a live thread */
+    uint64_t counters[UNIFYFS_STATS_NUM_COUNTERS];
+    unifyfs_stats_hist_t hists[UNIFYFS_STATS_NUM_HISTS];
+
+    /* rpc histograms are allocated on first use by the owner */
+    unifyfs_stats_hist_t* rpcs[UNIFYFS_STATS_NUM_RPC_CLASSES];
+} unifyfs_stats_block_t;
+
+extern __thread unifyfs_stats_block_t* unifyfs_stats_my_block;
+
+/* get the block of the calling thread, allocating it on first use.
+ * Returns NULL if allocation fails. */
+unifyfs_stats_block_t* unifyfs_stats_get_block(void);
+
+/* get the rpc histograms of the given class for a block, allocating
+ * them on first use */
+unifyfs_stats_hist_t* unifyfs_stats_get_rpcs(unifyfs_stats_block_t* blk,
+                                             unifyfs_stats_rpc_class_e cls);
+
+static inline uint64_t unifyfs_stats_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+/* add to a value of our own block, readers may load it concurrently */
+static inline void unifyfs_stats_bump(uint64_t* val, uint64_t n)
+{
+    uint64_t v = __atomic_load_n(val, __ATOMIC_RELAXED);
+    __atomic_store_n(val, v + n, __ATOMIC_RELAXED);
+}
+
+static inline void unifyfs_stats_hist_add(unifyfs_stats_hist_t* hist,
+                                          uint64_t ns)
+{
+    int b = 0;
+    if (ns > 1) {
+        b = 63 - __builtin_clzll(ns);
+        if (b >= UNIFYFS_STATS_HIST_BUCKETS) {
+            b = UNIFYFS_STATS_HIST_BUCKETS - 1;
+        }
+    }
+    unifyfs_stats_bump(&(hist->count), 1);
+    unifyfs_stats_bump(&(hist->sum_ns), ns);
+    unifyfs_stats_bump(&(hist->buckets[b]), 1);
+    if (ns > hist->max_ns) {
+        __atomic_store_n(&(hist->max_ns), ns, __ATOMIC_RELAXED);
+    }
+}
+
+static inline unifyfs_stats_block_t* unifyfs_stats_block(void)
+{
+    unifyfs_stats_block_t* blk = unifyfs_stats_my_block;
+    if (NULL == blk) {
+        blk = unifyfs_stats_get_block();
+    }
+    return blk;
+}
+
+/* add n to a counter */
+static inline void unifyfs_stats_add(unifyfs_stats_counter_e id,
+                                     uint64_t n)
+{
+    unifyfs_stats_block_t* blk = unifyfs_stats_block();
+    if (NULL != blk) {
+        unifyfs_stats_bump(&(blk->counters[id]), n);
+    }
+}
+
+/* record the time since start_ns (from unifyfs_stats_now_ns())
+ * in a latency histogram */
+static inline void unifyfs_stats_record(unifyfs_stats_hist_e id,
+                                        uint64_t start_ns)
+{
+    uint64_t now = unifyfs_stats_now_ns();
+    unifyfs_stats_block_t* blk = unifyfs_stats_block();
+    if (NULL != blk) {
+        unifyfs_stats_hist_add(&(blk->hists[id]), now - start_ns);
+    }
+}
+
+/* record a latency of ns nanoseconds for an rpc of the given class
+ * and type */
+static inline void unifyfs_stats_record_rpc_ns(unifyfs_stats_rpc_class_e cls,
+                                               int rpc_type,
+                                               uint64_t ns)
+{
+    if ((rpc_type < 0) || (rpc_type >= UNIFYFS_STATS_MAX_RPC_TYPES)) {
+        return;
+    }
+    unifyfs_stats_block_t* blk = unifyfs_stats_block();
+    if (NULL != blk) {
+        unifyfs_stats_hist_t* rpcs = blk->rpcs[cls];
+        if (NULL == rpcs) {
+            rpcs = unifyfs_stats_get_rpcs(blk, cls);
+            if (NULL == rpcs) {
+                return;
+            }
+        }
+        unifyfs_stats_hist_add(rpcs + rpc_type, ns);
+    }
+}
+
+/* record the time since start_ns for an rpc of the given class and type */
+static inline void unifyfs_stats_record_rpc(unifyfs_stats_rpc_class_e cls,
+                                            int rpc_type,
+                                            uint64_t start_ns)
+{
+    uint64_t now = unifyfs_stats_now_ns();
+    unifyfs_stats_record_rpc_ns(cls, rpc_type, now - start_ns);
+}
+
+/* set the value of a gauge, normally from the update function */
+void unifyfs_stats_set_gauge(unifyfs_stats_gauge_e id, uint64_t val);
+
+/* set the names of the rpc types of a class, names[i] is the
+ * name of type i. The array must remain valid. */
+void unifyfs_stats_set_rpc_names(unifyfs_stats_rpc_class_e cls,
+                                 const char* const* names,
+                                 int n_names);
+
+/* set the process label used in snapshots and dump file names, and
+ * the function called to refresh gauges before each snapshot */
+void unifyfs_stats_init(const char* label,
+                        void (*update_fn)(void));
+
+/* take a snapshot of all statistics as a JSON object string. On success,
+ * *json is allocated and must be freed by the caller, and *json_len is
+ * its length (not including the terminating NUL). */
+int unifyfs_stats_to_json(char** json, size_t* json_len);
+
+/* start a thread that appends a snapshot (one line of JSON) every
+ * interval seconds to <dir>/<label>.stats.<host>.<pid>.json */
+int unifyfs_stats_dump_start(const char* dir, int interval);
+
+/* stop the dump thread after appending a final snapshot */
+void unifyfs_stats_dump_stop(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* UNIFYFS_STATS_H */
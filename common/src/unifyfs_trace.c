@@ -0,0 +1,308 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#include "unifyfs_const.h"
+#include "unifyfs_log.h"
+#include "unifyfs_trace.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+/* spans buffered between writes to the trace file */
+#define TRACE_MAX_SPANS 16384
+
+/* milliseconds between writes to the trace file */
+#define TRACE_FLUSH_MSEC 1000
+
+typedef struct {
+    uint64_t id;
+    uint64_t start_ns;
+    uint64_t dur_ns;
+    uint32_t stage;
+    uint32_t tid;
+} trace_span;
+
+int unifyfs_trace_enabled; // = 0
+
+#define UNIFYFS_TRACE_NAME(id, name) name,
+static const char* const stage_names[UNIFYFS_TRACE_NUM_STAGES] = {
+    UNIFYFS_TRACE_STAGES(UNIFYFS_TRACE_NAME)
+};
+#undef UNIFYFS_TRACE_NAME
+
+/* recorded spans, swapped with the spare buffer by the writer */
+static pthread_mutex_t span_lock = PTHREAD_MUTEX_INITIALIZER;
+static trace_span* spans;        // = NULL
+static trace_span* spare_spans;  // = NULL
+static size_t n_spans;           // = 0
+static uint64_t n_dropped;       // = 0
+
+/* small per-thread ids for the trace file */
+static __thread uint32_t my_tid; // = 0
+static uint32_t next_tid;        // = 0
+
+/* sampling of client requests */
+static int sample_rate;          // = 0
+static uint64_t n_requests;      // = 0
+static uint64_t n_traced;        // = 0
+static uint64_t id_prefix;       // = 0
+
+/* add to monotonic times to get wall-clock times */
+static uint64_t realtime_offset_ns; // = 0
+
+/* trace file and writer thread state */
+static FILE* trace_fp;           // = NULL
+static char trace_path[PATH_MAX];
+static const char* trace_label = "unifyfs";
+static pthread_t writer_thread;
+static pthread_mutex_t writer_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t writer_cond = PTHREAD_COND_INITIALIZER;
+static int writer_running;       // = 0
+static int writer_exit;          // = 0
+
+void unifyfs_trace_add_span(uint64_t id,
+                            unifyfs_trace_stage_e stage,
+                            uint64_t start_ns,
+                            uint64_t end_ns)
+{
+    uint64_t dur_ns = end_ns - start_ns;
+    unifyfs_stats_record_rpc_ns(UNIFYFS_STATS_TRACE_STAGES, (int)stage,
+                                dur_ns);
+
+    if (0 == my_tid) {
+        my_tid = __atomic_add_fetch(&next_tid, 1, __ATOMIC_RELAXED);
+    }
+
+    pthread_mutex_lock(&span_lock);
+    if ((NULL != spans) && (n_spans < TRACE_MAX_SPANS)) {
+        trace_span* span = spans + n_spans;
+        span->id = id;
+        span->start_ns = start_ns;
+        span->dur_ns = dur_ns;
+        span->stage = (uint32_t) stage;
+        span->tid = my_tid;
+        n_spans++;
+    } else {
+        n_dropped++;
+    }
+    pthread_mutex_unlock(&span_lock);
+}
+
+void unifyfs_trace_begin(unifyfs_trace_ctx_t* tc)
+{
+    tc->id = 0;
+    if (!unifyfs_trace_enabled || (sample_rate <= 0)) {
+        return;
+    }
+
+    uint64_t n = __atomic_fetch_add(&n_requests, 1, __ATOMIC_RELAXED);
+    if (0 == (n % (uint64_t)sample_rate)) {
+        uint64_t seq = __atomic_add_fetch(&n_traced, 1, __ATOMIC_RELAXED);
+        tc->id = id_prefix | (seq & 0xFFFFFFFFULL);
+    }
+}
+
+/* append buffered spans to the trace file, only called by the writer
+ * thread, or after it has exited */
+static void write_spans(void)
+{
+    pthread_mutex_lock(&span_lock);
+    trace_span* full = spans;
+    size_t count = n_spans;
+    uint64_t dropped = n_dropped;
+    spans = spare_spans;
+    spare_spans = full;
+    n_spans = 0;
+    n_dropped = 0;
+    pthread_mutex_unlock(&span_lock);
+
+    if (dropped) {
+        LOGWARN("dropped %llu trace spans", (unsigned long long) dropped);
+    }
+    if ((0 == count) || (NULL == trace_fp)) {
+        return;
+    }
+
+    int pid = (int) getpid();
+    for (size_t i = 0; i < count; i++) {
+        trace_span* span = full + i;
+        uint64_t ts_ns = span->start_ns + realtime_offset_ns;
+        fprintf(trace_fp,
+                ",\n{\"name\":\"%s\",\"cat\":\"unifyfs\",\"ph\":\"X\","
+                "\"pid\":%d,\"tid\":%u,\"ts\":%llu.%03llu,"
+                "\"dur\":%llu.%03llu,\"args\":{\"trace_id\":\"%016llx\"}}",
+                stage_names[span->stage], pid, span->tid,
+                (unsigned long long)(ts_ns / 1000),
+                (unsigned long long)(ts_ns % 1000),
+                (unsigned long long)(span->dur_ns / 1000),
+                (unsigned long long)(span->dur_ns % 1000),
+                (unsigned long long) span->id);
+    }
+    fflush(trace_fp);
+}
+
+static void* writer_thread_main(void* arg)
+{
+    pthread_mutex_lock(&writer_lock);
+    while (!writer_exit) {
+        struct timespec wake;
+        clock_gettime(CLOCK_REALTIME, &wake);
+        wake.tv_nsec += (long)TRACE_FLUSH_MSEC * 1000000L;
+        while (wake.tv_nsec >= 1000000000L) {
+            wake.tv_sec++;
+            wake.tv_nsec -= 1000000000L;
+        }
+        int rc = 0;
+        while (!writer_exit && (rc != ETIMEDOUT)) {
+            rc = pthread_cond_timedwait(&writer_cond, &writer_lock, &wake);
+        }
+        pthread_mutex_unlock(&writer_lock);
+        write_spans();
+        pthread_mutex_lock(&writer_lock);
+    }
+    pthread_mutex_unlock(&writer_lock);
+    return NULL;
+}
+
+/* hash of host name and pid, used to make trace ids unique across
+ * client processes */
+static uint64_t make_id_prefix(const char* host)
+{
+    uint32_t h = 2166136261U; // FNV-1a
+    for (const char* c = host; *c; c++) {
+        h = (h ^ (uint8_t)*c) * 16777619U;
+    }
+    uint32_t pid = (uint32_t) getpid();
+    for (int i = 0; i < 4; i++) {
+        h = (h ^ ((pid >> (8 * i)) & 0xFF)) * 16777619U;
+    }
+    return ((uint64_t)h) << 32;
+}
+
+int unifyfs_trace_init(const char* label,
+                       int sample_rate_in,
+                       const char* dir)
+{
+    /* stage names are reported in statistics even if we don't trace */
+    unifyfs_stats_set_rpc_names(UNIFYFS_STATS_TRACE_STAGES, stage_names,
+                                UNIFYFS_TRACE_NUM_STAGES);
+
+    if ((sample_rate_in <= 0) || writer_running) {
+        return UNIFYFS_SUCCESS;
+    }
+    if (NULL == dir) {
+        return EINVAL;
+    }
+    if (NULL != label) {
+        trace_label = label;
+    }
+
+    char host[64] = "unknown";
+    gethostname(host, sizeof(host));
+    host[sizeof(host) - 1] = '\0';
+    int n = snprintf(trace_path, sizeof(trace_path),
+                     "%s/%s.trace.%s.%d.json",
+                     dir, trace_label, host, (int) getpid());
+    if ((n < 0) || ((size_t)n >= sizeof(trace_path))) {
+        LOGERR("trace file path too long");
+        return EINVAL;
+    }
+
+    spans = calloc(TRACE_MAX_SPANS, sizeof(trace_span));
+    spare_spans = calloc(TRACE_MAX_SPANS, sizeof(trace_span));
+    if ((NULL == spans) || (NULL == spare_spans)) {
+        free(spans);
+        free(spare_spans);
+        spans = NULL;
+        spare_spans = NULL;
+        return ENOMEM;
+    }
+
+    trace_fp = fopen(trace_path, "w");
+    if (NULL == trace_fp) {
+        int err = errno;
+        LOGERR("failed to open trace file %s - %s",
+               trace_path, strerror(err));
+        free(spans);
+        free(spare_spans);
+        spans = NULL;
+        spare_spans = NULL;
+        return err;
+    }
+
+    /* JSON array of trace events, starting with the process name */
+    fprintf(trace_fp, "[\n{\"name\":\"process_name\",\"ph\":\"M\","
+            "\"pid\":%d,\"args\":{\"name\":\"%s@%s\"}}",
+            (int) getpid(), trace_label, host);
+
+    struct timespec mono, real;
+    clock_gettime(CLOCK_MONOTONIC, &mono);
+    clock_gettime(CLOCK_REALTIME, &real);
+    realtime_offset_ns =
+        (((uint64_t)real.tv_sec * 1000000000ULL) + (uint64_t)real.tv_nsec) -
+        (((uint64_t)mono.tv_sec * 1000000000ULL) + (uint64_t)mono.tv_nsec);
+
+    sample_rate = sample_rate_in;
+    id_prefix = make_id_prefix(host);
+
+    writer_exit = 0;
+    if (pthread_create(&writer_thread, NULL, writer_thread_main, NULL) != 0) {
+        LOGERR("failed to create trace writer thread");
+        fclose(trace_fp);
+        trace_fp = NULL;
+        return UNIFYFS_FAILURE;
+    }
+    writer_running = 1;
+    unifyfs_trace_enabled = 1;
+
+    LOGINFO("tracing one of every %d requests to %s",
+            sample_rate, trace_path);
+    return UNIFYFS_SUCCESS;
+}
+
+void unifyfs_trace_fini(void)
+{
+    if (!writer_running) {
+        return;
+    }
+    unifyfs_trace_enabled = 0;
+
+    pthread_mutex_lock(&writer_lock);
+    writer_exit = 1;
+    pthread_cond_signal(&writer_cond);
+    pthread_mutex_unlock(&writer_lock);
+    pthread_join(writer_thread, NULL);
+    writer_running = 0;
+
+    /* spans recorded after the last write */
+    write_spans();
+    fprintf(trace_fp, "\n]\n");
+    fclose(trace_fp);
+    trace_fp = NULL;
+
+    /* threads still finishing a traced stage drop their spans */
+    pthread_mutex_lock(&span_lock);
+    free(spans);
+    free(spare_spans);
+    spans = NULL;
+    spare_spans = NULL;
+    n_spans = 0;
+    pthread_mutex_unlock(&span_lock);
+}
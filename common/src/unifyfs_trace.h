@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#ifndef UNIFYFS_TRACE_H
+#define UNIFYFS_TRACE_H
+
+/*
+ * Request tracing
+ *
+ * A sampled client read, write or sync is given a trace id, which is
+ * carried in the rpc inputs (see unifyfs_rpc_types.h) and request
+ * structures along the request's path through the client and servers.
+ * Each process records a span (start time and duration) for every stage
+ * of a traced request it handles. Spans are added to per-stage latency
+ * histograms in the statistics (see unifyfs_stats.h), which gives a
+ * breakdown of where sampled requests spend their time, and written to
+ * a trace file in Chrome trace event format for offline analysis of
+ * individual requests.
+ */
+
+#include <stdint.h>
+
+#include "unifyfs_stats.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* request stages, as STAGE(id, name) */
+#define UNIFYFS_TRACE_STAGES(STAGE) \
+    STAGE(CLIENT_READ,          "client.read") \
+    STAGE(CLIENT_MREAD_RPC,     "client.mread_rpc") \
+    STAGE(CLIENT_READ_WAIT,     "client.read_wait") \
+    STAGE(CLIENT_DATA_PULL,     "client.data_pull") \
+    STAGE(CLIENT_WRITE,         "client.write") \
+    STAGE(CLIENT_SYNC,          "client.sync") \
+    STAGE(CLIENT_SYNC_RPC,      "client.sync_rpc") \
+    STAGE(RM_QUEUE,             "rm.queue") \
+    STAGE(RM_MREAD,             "rm.mread") \
+    STAGE(RM_FIND_EXTENTS,      "rm.find_extents") \
+    STAGE(RM_READ_REQUEST,      "rm.read_request") \
+    STAGE(RM_CHUNK_READ_RPC,    "rm.chunk_read_rpc") \
+    STAGE(RM_SEND_DATA,         "rm.send_data") \
+    STAGE(RM_FSYNC,             "rm.fsync") \
+    STAGE(SM_QUEUE,             "sm.queue") \
+    STAGE(SM_CHUNK_READS,       "sm.chunk_reads") \
+    STAGE(SM_RESPONSE_RPC,      "sm.response_rpc")
+
+#define UNIFYFS_TRACE_ENUM(id, name) UNIFYFS_TRACE_##id,
+
+typedef enum {
+    UNIFYFS_TRACE_STAGES(UNIFYFS_TRACE_ENUM)
+    UNIFYFS_TRACE_NUM_STAGES
+} unifyfs_trace_stage_e;
+
+#undef UNIFYFS_TRACE_ENUM
+
+/* trace context carried with a request, an id of 0 means the request
+ * is not traced */
+typedef struct {
+    uint64_t id;
+} unifyfs_trace_ctx_t;
+
+/* nonzero when this process records spans */
+extern int unifyfs_trace_enabled;
+
+/* record a span for a stage of the traced request with the given id */
+void unifyfs_trace_add_span(uint64_t id,
+                            unifyfs_trace_stage_e stage,
+                            uint64_t start_ns,
+                            uint64_t end_ns);
+
+/* start the trace context of a new client request, which gets a trace
+ * id if it is sampled */
+void unifyfs_trace_begin(unifyfs_trace_ctx_t* tc);
+
+static inline int unifyfs_trace_is_on(const unifyfs_trace_ctx_t* tc)
+{
+    return unifyfs_trace_enabled && (NULL != tc) && (0 != tc->id);
+}
+
+/* record a stage of a traced request that started at start_ns
+ * (from unifyfs_stats_now_ns()) and ends now */
+static inline void unifyfs_trace_span(const unifyfs_trace_ctx_t* tc,
+                                      unifyfs_trace_stage_e stage,
+                                      uint64_t start_ns)
+{
+    if (unifyfs_trace_is_on(tc)) {
+        unifyfs_trace_add_span(tc->id, stage, start_ns,
+                               unifyfs_stats_now_ns());
+    }
+}
+
+/* enable tracing when sample_rate is positive. Clients trace one of
+ * every sample_rate requests, servers trace the requests they receive
+ * from clients that sampled them. Spans are written to
+ * <dir>/<label>.trace.<host>.<pid>.json */
+int unifyfs_trace_init(const char* label,
+                       int sample_rate,
+                       const char* dir);
+
+/* write any remaining spans and close the trace file */
+void unifyfs_trace_fini(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif /* UNIFYFS_TRACE_H */
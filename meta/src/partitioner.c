@@ -390,8 +390,9 @@ int get_slice_num(struct mdhim_t *md, struct index_t *index, void *key, int key_
 		break;
     case MDHIM_UNIFYFS_KEY:
         /* Use only the gfid portion of the key, which ensures all extents
-         * for the same file hash to the same server */
-        key_num = (uint64_t) UNIFYFS_KEY_FID(key);
+         * for the same file hash to the same server. Take the top 31 bits
+         * of the 63-bit gfid so the slice number fits in an int */
+        key_num = ((uint64_t) UNIFYFS_KEY_FID(key)) >> 32;
         break;
 	default:
 		return 0;
@@ -42,13 +42,22 @@ int compare_func(
 RB_PROTOTYPE(ext_tree, extent_tree_node, entry, compare_func)
 RB_GENERATE(ext_tree, extent_tree_node, entry, compare_func)
 
+/* number of nodes in the first and largest slabs of the node allocator,
+ * slabs double in size from the first up to the largest. The first slab
+ * is small to keep the trees of the many small files cheap. */
+#define EXTENT_TREE_SLAB_MIN_NODES 4
+#define EXTENT_TREE_SLAB_MAX_NODES 16384
+
 /* Returns 0 on success, positive non-zero error code otherwise */
 int extent_tree_init(struct extent_tree* extent_tree)
 {
     memset(extent_tree, 0, sizeof(*extent_tree));
     pthread_rwlock_init(&extent_tree->rwlock, NULL);
     RB_INIT(&extent_tree->head);
-    return 0;
+    return slab_cache_init(&extent_tree->node_cache,
+                           sizeof(struct extent_tree_node),
+                           EXTENT_TREE_SLAB_MIN_NODES,
+                           EXTENT_TREE_SLAB_MAX_NODES);
 }
 
 /*
@@ -57,11 +66,15 @@ int extent_tree_init(struct extent_tree* extent_tree)
 void extent_tree_destroy(struct extent_tree* extent_tree)
 {
     extent_tree_clear(extent_tree);
+    slab_cache_destroy(&extent_tree->node_cache);
     pthread_rwlock_destroy(&extent_tree->rwlock);
 }
 
-/* Allocate a node for the range tree.  Free node with free() when finished */
+/* Allocate a node for the range tree from the tree's node cache.
+ * Free node with extent_tree_node_free() when finished.
+ * Assumes caller has write lock on tree. */
 static struct extent_tree_node* extent_tree_node_alloc(
+    struct extent_tree* extent_tree, /* tree the node will belong to */
     unsigned long start, /* logical starting offset of extent */
     unsigned long end,   /* logical ending offset of extent */
     int svr_rank,        /* rank of server hosting data */
@@ -70,7 +83,7 @@ static struct extent_tree_node* extent_tree_node_alloc(
     unsigned long pos)   /* physical offset of data in log */
 {
     /* allocate a new node structure */
-    struct extent_tree_node* node = calloc(1, sizeof(*node));
+    struct extent_tree_node* node = slab_cache_alloc(&extent_tree->node_cache);
     if (!node) {
         return NULL;
     }
@@ -86,6 +99,65 @@ static struct extent_tree_node* extent_tree_node_alloc(
     return node;
 }
 
+/* Release a node back to the tree's node cache.
+ * Assumes caller has write lock on tree. */
+static inline void extent_tree_node_free(
+    struct extent_tree* extent_tree,
+    struct extent_tree_node* node)
+{
+    slab_cache_free(&extent_tree->node_cache, node);
+}
+
+/* Return index of the first extent in a frozen tree whose ending offset
+ * is at or after the given offset, or count if there is none. Since the
+ * extents are sorted and do not overlap, ending offsets are sorted too.
+ * Assumes caller has lock on tree. */
+static unsigned long extent_tree_frozen_lower_bound(
+    struct extent_tree* extent_tree,
+    unsigned long offset)
+{
+    struct extent_tree_node* nodes = extent_tree->frozen;
+    unsigned long lo = 0;
+    unsigned long hi = extent_tree->count;
+    while (lo < hi) {
+        unsigned long mid = lo + (hi - lo) / 2;
+        if (nodes[mid].end < offset) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* Convert a frozen tree back to a red-black tree so it can be modified.
+ * Assumes caller has write lock on tree. */
+static int extent_tree_thaw(struct extent_tree* extent_tree)
+{
+    struct extent_tree_node* frozen = extent_tree->frozen;
+    if (NULL == frozen) {
+        return 0;
+    }
+
+    for (unsigned long i = 0; i < extent_tree->count; i++) {
+        struct extent_tree_node* node =
+            slab_cache_alloc(&extent_tree->node_cache);
+        if (NULL == node) {
+            /* leave the tree frozen */
+            RB_INIT(&extent_tree->head);
+            slab_cache_release(&extent_tree->node_cache);
+            return ENOMEM;
+        }
+        *node = frozen[i];
+        RB_INSERT(ext_tree, &extent_tree->head, node);
+    }
+
+    extent_tree->frozen = NULL;
+    free(frozen);
+
+    return 0;
+}
+
 /*
  * Given two start/end ranges, return a new range from start1/end1 that
  * does not overlap start2/end2.  The non-overlapping range is stored
@@ -138,8 +210,9 @@ static int get_non_overlapping_range(
 
 /*
  * Add an entry to the range tree.  Returns 0 on success, nonzero otherwise.
+ * Assumes caller has write lock on tree.
  */
-int extent_tree_add(
+static int extent_tree_add_nolock(
     struct extent_tree* extent_tree, /* tree to add new extent item */
     unsigned long start, /* logical starting offset of extent */
     unsigned long end,   /* logical ending offset of extent */
@@ -151,16 +224,21 @@ int extent_tree_add(
     /* assume we'll succeed */
     int rc = 0;
 
+    /* a frozen tree must be converted back before we can modify it */
+    if (NULL != extent_tree->frozen) {
+        rc = extent_tree_thaw(extent_tree);
+        if (rc) {
+            return rc;
+        }
+    }
+
     /* Create node to define our new range */
-    struct extent_tree_node* node = extent_tree_node_alloc(
+    struct extent_tree_node* node = extent_tree_node_alloc(extent_tree,
         start, end, svr_rank, app_id, cli_id, pos);
     if (!node) {
         return ENOMEM;
     }
 
-    /* lock the tree so we can modify it */
-    extent_tree_wrlock(extent_tree);
-
     /* Try to insert our range into the RB tree.  If it overlaps with any other
      * range, then it is not inserted, and the overlapping range node is
      * returned in 'overlap'.  If 'overlap' is NULL, then there were no
@@ -181,7 +259,7 @@ int extent_tree_add(
              * We can't find a non-overlapping range.
              * Delete the existing range. */
             RB_REMOVE(ext_tree, &extent_tree->head, overlap);
-            free(overlap);
+            extent_tree_node_free(extent_tree, overlap);
             extent_tree->count--;
         } else {
             /* Part of the old range was non-overlapping.  Split the old range
@@ -190,16 +268,15 @@ int extent_tree_add(
              * inserted without issue.  The remaining section will be processed
              * on the next pass of this while() loop. */
             struct extent_tree_node* resized = extent_tree_node_alloc(
-                new_start, new_end,
+                extent_tree, new_start, new_end,
                 overlap->svr_rank, overlap->app_id, overlap->cli_id,
                 overlap->pos + (new_start - overlap->start));
             if (!resized) {
                 /* failed to allocate memory for range node,
                  * bail out and release lock without further
                  * changing state of extent tree */
-                free(node);
-                rc = ENOMEM;
-                goto release_add;
+                extent_tree_node_free(extent_tree, node);
+                return ENOMEM;
             }
 
             /* if the non-overlapping part came from the front
@@ -211,23 +288,22 @@ int extent_tree_add(
                 /* There's still a remaining section after the non-overlapping
                  * part.  Add it in. */
                 remaining = extent_tree_node_alloc(
-                    resized->end + 1, overlap->end,
+                    extent_tree, resized->end + 1, overlap->end,
                     overlap->svr_rank, overlap->app_id, overlap->cli_id,
                     overlap->pos + (resized->end + 1 - overlap->start));
                 if (!remaining) {
                     /* failed to allocate memory for range node,
                      * bail out and release lock without further
                      * changing state of extent tree */
-                    free(node);
-                    free(resized);
-                    rc = ENOMEM;
-                    goto release_add;
+                    extent_tree_node_free(extent_tree, node);
+                    extent_tree_node_free(extent_tree, resized);
+                    return ENOMEM;
                 }
             }
 
             /* Remove our old range and release it */
             RB_REMOVE(ext_tree, &extent_tree->head, overlap);
-            free(overlap);
+            extent_tree_node_free(extent_tree, overlap);
             extent_tree->count--;
 
             /* Insert the non-overlapping part of the new range */
@@ -273,7 +349,7 @@ int extent_tree_add(
 
             /* delete new extent from the tree and free it */
             RB_REMOVE(ext_tree, &extent_tree->head, target);
-            free(target);
+            extent_tree_node_free(extent_tree, target);
             extent_tree->count--;
 
             /* update target to point at previous extent since we just
@@ -300,12 +376,31 @@ int extent_tree_add(
 
             /* delete next extent from the tree and free it */
             RB_REMOVE(ext_tree, &extent_tree->head, next);
-            free(next);
+            extent_tree_node_free(extent_tree, next);
             extent_tree->count--;
         }
     }
 
-release_add:
+    return rc;
+}
+
+/*
+ * Add an entry to the range tree.  Returns 0 on success, nonzero otherwise.
+ */
+int extent_tree_add(
+    struct extent_tree* extent_tree, /* tree to add new extent item */
+    unsigned long start, /* logical starting offset of extent */
+    unsigned long end,   /* logical ending offset of extent */
+    int svr_rank,        /* rank of server hosting data */
+    int app_id,          /* application id (namespace) on server rank */
+    int cli_id,          /* client rank on server rank */
+    unsigned long pos)   /* physical offset of data in log */
+{
+    /* lock the tree so we can modify it */
+    extent_tree_wrlock(extent_tree);
+
+    int rc = extent_tree_add_nolock(extent_tree, start, end,
+                                    svr_rank, app_id, cli_id, pos);
 
     /* done modifying the tree */
     extent_tree_unlock(extent_tree);
@@ -313,6 +408,310 @@ release_add:
     return rc;
 }
 
+/* Return 1 if the extents are sorted by offset and do not overlap */
+static int extent_run_is_sorted(
+    int num_extents,
+    struct extent_tree_node* extents)
+{
+    for (int i = 1; i < num_extents; i++) {
+        if ((extents[i].start <= extents[i - 1].end) ||
+            (extents[i].end < extents[i].start)) {
+            return 0;
+        }
+    }
+    return ((num_extents > 0) && (extents[0].end >= extents[0].start));
+}
+
+/* Merging a run rebuilds the whole tree in O(n + m) time, while adding
+ * the run one extent at a time costs O(m log n). Return 1 if merging a
+ * run of the given length is expected to be cheaper. */
+static int extent_tree_merge_pays_off(
+    struct extent_tree* extent_tree,
+    int num_extents)
+{
+    unsigned long n = extent_tree->count;
+    unsigned long log_n = 1;
+    while ((log_n < 64) && ((1UL << log_n) <= n)) {
+        log_n++;
+    }
+    return (((unsigned long)num_extents * log_n) >= n);
+}
+
+/* Append the range [start, end] of extent src to the sorted node list
+ * being built by a merge, coalescing it with the previous node when the
+ * two are contiguous both in the file and in the same log */
+static int extent_merge_emit(
+    struct slab_cache* cache,          /* cache for new nodes */
+    struct extent_tree_node** out,     /* sorted list of new nodes */
+    unsigned long* n_out,              /* number of nodes in out */
+    unsigned long start,               /* start of range to append */
+    unsigned long end,                 /* end of range to append */
+    struct extent_tree_node* src)      /* extent that holds the range */
+{
+    unsigned long pos = src->pos + (start - src->start);
+
+    if (*n_out > 0) {
+        struct extent_tree_node* prev = out[*n_out - 1];
+        unsigned long pos_end = prev->pos + (prev->end - prev->start + 1);
+        if (prev->end + 1 == start         &&
+            prev->svr_rank == src->svr_rank &&
+            prev->cli_id   == src->cli_id   &&
+            prev->app_id   == src->app_id   &&
+            pos_end        == pos) {
+            prev->end = end;
+            return 0;
+        }
+    }
+
+    struct extent_tree_node* node = slab_cache_alloc(cache);
+    if (NULL == node) {
+        return ENOMEM;
+    }
+    node->start    = start;
+    node->end      = end;
+    node->svr_rank = src->svr_rank;
+    node->app_id   = src->app_id;
+    node->cli_id   = src->cli_id;
+    node->pos      = pos;
+
+    out[*n_out] = node;
+    (*n_out)++;
+    return 0;
+}
+
+/* Link the sorted nodes in [lo, hi] into a balanced subtree and return
+ * its root. Subtree sizes differ by at most one, so all leaves are on
+ * the two deepest levels. Coloring only the nodes on level red_depth
+ * red therefore gives every path the same number of black nodes. */
+static struct extent_tree_node* extent_tree_build(
+    struct extent_tree_node** nodes,
+    long lo,
+    long hi,
+    int depth,
+    int red_depth,
+    struct extent_tree_node* parent)
+{
+    if (lo > hi) {
+        return NULL;
+    }
+
+    long mid = lo + (hi - lo) / 2;
+    struct extent_tree_node* node = nodes[mid];
+    RB_PARENT(node, entry) = parent;
+    RB_COLOR(node, entry)  = (depth == red_depth) ? RB_RED : RB_BLACK;
+    RB_LEFT(node, entry)   = extent_tree_build(nodes, lo, mid - 1,
+                                               depth + 1, red_depth, node);
+    RB_RIGHT(node, entry)  = extent_tree_build(nodes, mid + 1, hi,
+                                               depth + 1, red_depth, node);
+    return node;
+}
+
+/*
+ * Merge a run of sorted, non-overlapping extents into the tree in a
+ * single in-order pass, with the new extents overwriting any overlapped
+ * portions of existing ones, then rebuild the tree from the merged list.
+ * The new nodes come from a fresh node cache, so the tree is unchanged
+ * if we run out of memory. Assumes caller has write lock on tree.
+ */
+static int extent_tree_merge_run(
+    struct extent_tree* extent_tree,
+    int num_extents,
+    struct extent_tree_node* run)
+{
+    int rc;
+    struct slab_cache fresh;
+    rc = slab_cache_init(&fresh, sizeof(struct extent_tree_node),
+                         EXTENT_TREE_SLAB_MIN_NODES,
+                         EXTENT_TREE_SLAB_MAX_NODES);
+    if (rc) {
+        return rc;
+    }
+
+    /* each new extent can split at most one existing extent in two */
+    unsigned long max_out = extent_tree->count + (2 * num_extents);
+    struct extent_tree_node** out = malloc(max_out * sizeof(*out));
+    if (NULL == out) {
+        slab_cache_destroy(&fresh);
+        return ENOMEM;
+    }
+    unsigned long n_out = 0;
+
+    /* o is the current existing extent, of which only the part starting
+     * at o_start remains to be merged */
+    struct extent_tree_node* o = extent_tree_iter(extent_tree, NULL);
+    unsigned long o_start = (o != NULL) ? o->start : 0;
+    int j = 0;
+    while ((o != NULL) && (j < num_extents)) {
+        struct extent_tree_node* n = &run[j];
+        if (o->end < n->start) {
+            /* existing extent ends before new one */
+            rc = extent_merge_emit(&fresh, out, &n_out, o_start, o->end, o);
+            o = extent_tree_iter(extent_tree, o);
+            o_start = (o != NULL) ? o->start : 0;
+        } else if (n->end < o_start) {
+            /* new extent ends before existing one */
+            rc = extent_merge_emit(&fresh, out, &n_out, n->start, n->end, n);
+            j++;
+        } else {
+            /* overlap, keep any leading part of the existing extent */
+            if (o_start < n->start) {
+                rc = extent_merge_emit(&fresh, out, &n_out,
+                                       o_start, n->start - 1, o);
+                if (rc) {
+                    break;
+                }
+            }
+            if (o->end > n->end) {
+                /* existing extent continues past new one, what is left
+                 * of it may still overlap the next new extent */
+                rc = extent_merge_emit(&fresh, out, &n_out,
+                                       n->start, n->end, n);
+                j++;
+                o_start = n->end + 1;
+            } else {
+                /* rest of existing extent is overwritten */
+                o = extent_tree_iter(extent_tree, o);
+                o_start = (o != NULL) ? o->start : 0;
+            }
+        }
+        if (rc) {
+            break;
+        }
+    }
+    while ((0 == rc) && (o != NULL)) {
+        rc = extent_merge_emit(&fresh, out, &n_out, o_start, o->end, o);
+        o = extent_tree_iter(extent_tree, o);
+        o_start = (o != NULL) ? o->start : 0;
+    }
+    while ((0 == rc) && (j < num_extents)) {
+        rc = extent_merge_emit(&fresh, out, &n_out,
+                               run[j].start, run[j].end, &run[j]);
+        j++;
+    }
+
+    if (rc) {
+        /* leave the tree as it was */
+        free(out);
+        slab_cache_destroy(&fresh);
+        return rc;
+    }
+
+    /* swap in the merged nodes and release the old ones in bulk */
+    struct slab_cache old_cache = extent_tree->node_cache;
+    extent_tree->node_cache = fresh;
+    slab_cache_release(&old_cache);
+    if (NULL != extent_tree->frozen) {
+        free(extent_tree->frozen);
+        extent_tree->frozen = NULL;
+    }
+
+    int red_depth = -1;
+    if (n_out > 1) {
+        /* depth of the deepest level */
+        red_depth = 0;
+        while ((2UL << red_depth) <= n_out) {
+            red_depth++;
+        }
+    }
+    RB_INIT(&extent_tree->head);
+    RB_ROOT(&extent_tree->head) =
+        extent_tree_build(out, 0, (long)n_out - 1, 0, red_depth, NULL);
+
+    extent_tree->count = n_out;
+    extent_tree->max   = (n_out > 0) ? out[n_out - 1]->end : 0;
+
+    free(out);
+
+    return 0;
+}
+
+/*
+ * Add a batch of entries to the range tree, in array order, while holding
+ * the tree lock once. Returns 0 on success, nonzero otherwise.
+ */
+int extent_tree_add_batch(
+    struct extent_tree* extent_tree, /* tree to add new extent items */
+    int num_extents,                 /* number of entries in extents */
+    struct extent_tree_node* extents) /* array of extents to add */
+{
+    int rc = 0;
+
+    extent_tree_wrlock(extent_tree);
+
+    /* extents synced by a client come from its segment tree, so they are
+     * normally sorted and non-overlapping and can be merged in one pass */
+    if ((num_extents > 1) &&
+        extent_tree_merge_pays_off(extent_tree, num_extents) &&
+        extent_run_is_sorted(num_extents, extents)) {
+        rc = extent_tree_merge_run(extent_tree, num_extents, extents);
+        if (rc) {
+            LOGERR("failed to merge %d extents (rc=%d)", num_extents, rc);
+        }
+        extent_tree_unlock(extent_tree);
+        return rc;
+    }
+
+    for (int i = 0; i < num_extents; i++) {
+        struct extent_tree_node* e = &extents[i];
+        rc = extent_tree_add_nolock(extent_tree, e->start, e->end,
+                                    e->svr_rank, e->app_id, e->cli_id,
+                                    e->pos);
+        if (rc) {
+            LOGERR("failed to add extent [%lu, %lu] (rc=%d)",
+                   e->start, e->end, rc);
+            break;
+        }
+    }
+
+    extent_tree_unlock(extent_tree);
+
+    return rc;
+}
+
+/*
+ * Freeze the tree into its sorted array form. Returns 0 on success,
+ * nonzero otherwise.
+ */
+int extent_tree_freeze(struct extent_tree* extent_tree)
+{
+    int rc = 0;
+
+    extent_tree_wrlock(extent_tree);
+
+    if ((NULL == extent_tree->frozen) && (extent_tree->count > 0)) {
+        struct extent_tree_node* nodes =
+            malloc(extent_tree->count * sizeof(*nodes));
+        if (NULL == nodes) {
+            rc = ENOMEM;
+        } else {
+            /* copy out the extents in order, then drop the tree nodes */
+            unsigned long i = 0;
+            struct extent_tree_node* node;
+            RB_FOREACH(node, ext_tree, &extent_tree->head) {
+                nodes[i] = *node;
+                memset(&(nodes[i].entry), 0, sizeof(nodes[i].entry));
+                i++;
+            }
+            RB_INIT(&extent_tree->head);
+            slab_cache_release(&extent_tree->node_cache);
+            extent_tree->frozen = nodes;
+        }
+    }
+
+    extent_tree_unlock(extent_tree);
+
+    return rc;
+}
+
+/* Return 1 if the tree is frozen, 0 otherwise */
+int extent_tree_is_frozen(struct extent_tree* extent_tree)
+{
+    extent_tree_rdlock(extent_tree);
+    int frozen = (NULL != extent_tree->frozen);
+    extent_tree_unlock(extent_tree);
+    return frozen;
+}
+
 /* search tree for entry that overlaps with given start/end
  * offsets, return first overlapping entry if found, NULL otherwise,
  * assumes caller has lock on tree */
@@ -321,20 +720,29 @@ struct extent_tree_node* extent_tree_find(
     unsigned long start, /* starting offset to search */
     unsigned long end)   /* ending offset to search */
 {
-    /* Create a range of just our starting byte offset */
-    struct extent_tree_node* node = extent_tree_node_alloc(
-        start, start, 0, 0, 0, 0);
-    if (!node) {
+    if (NULL != extent_tree->frozen) {
+        /* binary search for the first extent that does not end
+         * before our starting byte offset */
+        unsigned long idx =
+            extent_tree_frozen_lower_bound(extent_tree, start);
+        if ((idx < extent_tree->count) &&
+            (extent_tree->frozen[idx].start <= end)) {
+            return &(extent_tree->frozen[idx]);
+        }
         return NULL;
     }
 
+    /* Create a range of just our starting byte offset */
+    struct extent_tree_node node = {
+        .start = start,
+        .end   = start,
+    };
+
     /* search tree for either a range that overlaps with
      * the target range (starting byte), or otherwise the
      * node for the next biggest starting byte */
     struct extent_tree_node* next = RB_NFIND(
-        ext_tree, &extent_tree->head, node);
-
-    free(node);
+        ext_tree, &extent_tree->head, &node);
 
     /* we may have found a node that doesn't include our starting
      * byte offset, but it would be the range with the lowest
@@ -364,6 +772,22 @@ int extent_tree_truncate(
     /* lock the tree for reading */
     extent_tree_wrlock(tree);
 
+    if (NULL != tree->frozen) {
+        /* drop all extents that start at or after the truncated size,
+         * and trim the one that contains it (if any) */
+        unsigned long idx = extent_tree_frozen_lower_bound(tree, size);
+        if (idx < tree->count) {
+            if (tree->frozen[idx].start < size) {
+                tree->frozen[idx].end = size - 1;
+                idx++;
+            }
+            tree->count = idx;
+        }
+        tree->max = (tree->count > 0) ? tree->frozen[tree->count - 1].end : 0;
+        extent_tree_unlock(tree);
+        return 0;
+    }
+
     /* lookup node with the extent that has the maximum offset */
     struct extent_tree_node* node = RB_MAX(ext_tree, &tree->head);
 
@@ -383,9 +807,9 @@ int extent_tree_truncate(
 
             /* remove this node from the tree and release it */
             LOGDBG("removing node [%lu, %lu] due to truncate=%lu",
-                   node->start, node->end, size);
+                   oldnode->start, oldnode->end, size);
             RB_REMOVE(ext_tree, &tree->head, oldnode);
-            free(oldnode);
+            extent_tree_node_free(tree, oldnode);
 
             /* decrement the number of extents in the tree */
             tree->count--;
@@ -437,23 +861,22 @@ struct extent_tree_node* extent_tree_iter(
     struct extent_tree_node* start)
 {
     struct extent_tree_node* next = NULL;
+    if (NULL != extent_tree->frozen) {
+        /* extents of a frozen tree are consecutive in memory */
+        struct extent_tree_node* last =
+            extent_tree->frozen + extent_tree->count;
+        next = (start == NULL) ? extent_tree->frozen : (start + 1);
+        return (next < last) ? next : NULL;
+    }
+
     if (start == NULL) {
         /* Initial case, no starting node */
         next = RB_MIN(ext_tree, &extent_tree->head);
         return next;
     }
 
-    /*
-     * We were given a valid start node.  Look it up to start our traversal
-     * from there.
-     */
-    next = RB_FIND(ext_tree, &extent_tree->head, start);
-    if (!next) {
-        /* Some kind of error */
-        return NULL;
-    }
-
-    /* Look up our next node */
+    /* Look up our next node. start must be a node of this tree, so we
+     * can step from it directly rather than searching for it first */
     next = RB_NEXT(ext_tree, &extent_tree->head, start);
 
     return next;
@@ -504,28 +927,17 @@ void extent_tree_unlock(struct extent_tree* extent_tree)
  */
 void extent_tree_clear(struct extent_tree* extent_tree)
 {
-    struct extent_tree_node* node = NULL;
-    struct extent_tree_node* oldnode = NULL;
-
     extent_tree_wrlock(extent_tree);
 
-    if (RB_EMPTY(&extent_tree->head)) {
-        /* extent_tree is empty, nothing to do */
-        extent_tree_unlock(extent_tree);
-        return;
-    }
+    /* all nodes come from the node cache, so drop the tree structure
+     * and release the node slabs in bulk rather than removing and
+     * freeing nodes one at a time */
+    RB_INIT(&extent_tree->head);
+    slab_cache_release(&extent_tree->node_cache);
 
-    /* Remove and free each node in the tree */
-    while ((node = extent_tree_iter(extent_tree, node))) {
-        if (oldnode) {
-            RB_REMOVE(ext_tree, &extent_tree->head, oldnode);
-            free(oldnode);
-        }
-        oldnode = node;
-    }
-    if (oldnode) {
-        RB_REMOVE(ext_tree, &extent_tree->head, oldnode);
-        free(oldnode);
+    if (NULL != extent_tree->frozen) {
+        free(extent_tree->frozen);
+        extent_tree->frozen = NULL;
     }
 
     extent_tree->count = 0;
@@ -551,13 +963,32 @@ unsigned long extent_tree_max_offset(struct extent_tree* extent_tree)
     return max;
 }
 
+/* Fill in memory usage statistics for the nodes of the tree */
+void extent_tree_mem_stats(struct extent_tree* extent_tree,
+                           slab_cache_stats_t* stats)
+{
+    extent_tree_rdlock(extent_tree);
+    slab_cache_get_stats(&extent_tree->node_cache, stats);
+    if (NULL != extent_tree->frozen) {
+        /* report the sorted array of a frozen tree as a single slab */
+        size_t bytes = extent_tree->count * sizeof(struct extent_tree_node);
+        stats->obj_size        = sizeof(struct extent_tree_node);
+        stats->num_slabs      += 1;
+        stats->total_objs     += extent_tree->count;
+        stats->used_objs      += extent_tree->count;
+        stats->bytes_reserved += bytes;
+        stats->bytes_used     += bytes;
+    }
+    extent_tree_unlock(extent_tree);
+}
+
 /* given an extent tree and starting and ending logical offsets,
  * fill in key/value entries that overlap that range, returns at
  * most max entries starting from lowest starting offset,
  * sets outnum with actual number of entries returned */
 int extent_tree_span(
     struct extent_tree* extent_tree, /* extent tree to search */
-    int gfid,                        /* global file id we're looking in */
+    int64_t gfid,                    /* global file id we're looking in */
     unsigned long start,             /* starting logical offset */
     unsigned long end,               /* ending logical offset */
     int max,                         /* maximum number of key/vals to return */
@@ -642,31 +1073,48 @@ static void chunk_req_from_extent(
     chunk->log_app_id = n->app_id;
 }
 
-int extent_tree_get_chunk_list(
+int extent_tree_get_chunk_lists(
     struct extent_tree* extent_tree, /* extent tree to search */
-    unsigned long offset,            /* starting logical offset */
-    unsigned long len,               /* length of extent */
-    unsigned int* n_chunks,          /* [out] number of extents returned */
+    unsigned int n_ranges,           /* number of ranges to look up */
+    struct extent_tree_range* ranges, /* array of ranges */
+    unsigned int* n_chunks,          /* [out] number of chunks returned */
     chunk_read_req_t** chunks)       /* [out] extent array */
 {
     int ret = 0;
+    unsigned int i;
     unsigned int count = 0;
-    unsigned long end = offset + len - 1;
-    struct extent_tree_node* first = NULL;
     struct extent_tree_node* next = NULL;
     chunk_read_req_t* out_chunks = NULL;
     chunk_read_req_t* current = NULL;
 
+    *n_chunks = 0;
+    *chunks = NULL;
+    if (0 == n_ranges) {
+        return 0;
+    }
+
+    /* remember first overlapping extent of each range,
+     * so we only search the tree once per range */
+    struct extent_tree_node** firsts = calloc(n_ranges, sizeof(*firsts));
+    if (NULL == firsts) {
+        return ENOMEM;
+    }
+
     extent_tree_rdlock(extent_tree);
 
-    first = extent_tree_find(extent_tree, offset, end);
-    next = first;
-    while (next && next->start <= end) {
-        count++;
-        next = extent_tree_iter(extent_tree, next);
+    for (i = 0; i < n_ranges; i++) {
+        if (0 == ranges[i].len) {
+            continue;
+        }
+        unsigned long end = ranges[i].offset + ranges[i].len - 1;
+        firsts[i] = extent_tree_find(extent_tree, ranges[i].offset, end);
+        next = firsts[i];
+        while (next && next->start <= end) {
+            count++;
+            next = extent_tree_iter(extent_tree, next);
+        }
     }
 
-    *n_chunks = count;
     if (0 == count) {
         goto out_unlock;
     }
@@ -677,22 +1125,41 @@ int extent_tree_get_chunk_list(
         goto out_unlock;
     }
 
-    next = first;
     current = out_chunks;
-    while (next && next->start <= end) {
-        /* trim out the extent so it does not include the data that is not
-         * requested */
-        chunk_req_from_extent(offset, len, next, current);
-
-        next = extent_tree_iter(extent_tree, next);
-        current += 1;
+    for (i = 0; i < n_ranges; i++) {
+        unsigned long offset = ranges[i].offset;
+        unsigned long len = ranges[i].len;
+        unsigned long end = offset + len - 1;
+        next = firsts[i];
+        while (next && next->start <= end) {
+            chunk_req_from_extent(offset, len, next, current);
+            next = extent_tree_iter(extent_tree, next);
+            current += 1;
+        }
     }
 
+    *n_chunks = count;
     *chunks = out_chunks;
 
 out_unlock:
     extent_tree_unlock(extent_tree);
 
+    free(firsts);
+
     return ret;
 }
 
+int extent_tree_get_chunk_list(
+    struct extent_tree* extent_tree, /* extent tree to search */
+    unsigned long offset,            /* starting logical offset */
+    unsigned long len,               /* length of extent */
+    unsigned int* n_chunks,          /* [out] number of extents returned */
+    chunk_read_req_t** chunks)       /* [out] extent array */
+{
+    struct extent_tree_range range = {
+        .offset = offset,
+        .len    = len,
+    };
+    return extent_tree_get_chunk_lists(extent_tree, 1, &range,
+                                       n_chunks, chunks);
+}
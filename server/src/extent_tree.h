@@ -16,6 +16,7 @@
 #define __EXTENT_TREE_H__
 
 #include "unifyfs_global.h"
+#include "slab_cache.h"
 
 struct extent_tree_node {
     RB_ENTRY(extent_tree_node) entry;
@@ -27,11 +28,29 @@ struct extent_tree_node {
     unsigned long pos;   /* physical offset of data in log */
 };
 
+/*
+ * An extent tree has two forms. While a file is being written, extents are
+ * kept as nodes of a red-black tree. Once a file is laminated, its extents
+ * no longer change, so the tree can be frozen (see extent_tree_freeze()),
+ * which packs the extents into one array sorted by offset. Lookups in a
+ * frozen tree use binary search, and iteration walks the array, which is
+ * much more cache friendly than chasing tree pointers. All extent_tree
+ * functions work with either form, and adding to a frozen tree unfreezes it.
+ */
 struct extent_tree {
     RB_HEAD(ext_tree, extent_tree_node) head;
     pthread_rwlock_t rwlock;
     unsigned long count;     /* number of segments stored in tree */
     unsigned long max;       /* maximum logical offset value in the tree */
+    struct slab_cache node_cache; /* allocator for tree nodes */
+    struct extent_tree_node* frozen; /* sorted extents of a frozen tree,
+                                      * NULL unless tree is frozen */
+};
+
+/* logical byte range for batched extent lookups */
+struct extent_tree_range {
+    unsigned long offset;    /* starting logical offset */
+    unsigned long len;       /* length of range */
 };
 
 /* Returns 0 on success, positive non-zero error code otherwise */
@@ -61,6 +80,29 @@ int extent_tree_add(
     unsigned long pos    /* physical offset of data in log */
 );
 
+/*
+ * Add a batch of entries to the range tree, in array order, while holding
+ * the tree lock once. Only the start, end, svr_rank, app_id, cli_id, and
+ * pos fields of the given nodes are used. When the batch is sorted by
+ * offset and non-overlapping, it is merged into the tree in a single pass
+ * rather than being added one entry at a time. Returns 0 on success,
+ * nonzero otherwise.
+ */
+int extent_tree_add_batch(
+    struct extent_tree* extent_tree, /* tree to add new extent items */
+    int num_extents,                 /* number of entries in extents */
+    struct extent_tree_node* extents); /* array of extents to add */
+
+/*
+ * Freeze the tree into its sorted array form. Meant to be used once the
+ * extents will no longer change (e.g., on lamination). Returns 0 on
+ * success, nonzero otherwise (in which case the tree is left unfrozen).
+ */
+int extent_tree_freeze(struct extent_tree* extent_tree);
+
+/* Return 1 if the tree is frozen, 0 otherwise */
+int extent_tree_is_frozen(struct extent_tree* extent_tree);
+
 /* search tree for entry that overlaps with given start/end
  * offsets, return first overlapping entry if found, NULL otherwise,
  * assumes caller has lock on tree */
@@ -108,6 +150,10 @@ unsigned long extent_tree_count(struct extent_tree* extent_tree);
 /* Return the maximum ending logical offset in the tree */
 unsigned long extent_tree_max_offset(struct extent_tree* extent_tree);
 
+/* Fill in memory usage statistics for the nodes of the tree */
+void extent_tree_mem_stats(struct extent_tree* extent_tree,
+                           slab_cache_stats_t* stats);
+
 /*
  * Locking functions for use with extent_tree_iter().  They allow you to
  * lock the tree to iterate over it:
@@ -149,7 +195,7 @@ void extent_tree_unlock(struct extent_tree* extent_tree);
  * sets outnum with actual number of entries returned */
 int extent_tree_span(
     struct extent_tree* extent_tree, /* extent tree to search */
-    int gfid,                        /* global file id we're looking in */
+    int64_t gfid,                    /* global file id we're looking in */
     unsigned long start,             /* starting logical offset */
     unsigned long end,               /* ending logical offset */
     int max,                         /* maximum number of key/vals to return */
@@ -164,6 +210,16 @@ int extent_tree_get_chunk_list(
     unsigned int* n_chunks,          /* [out] number of chunks returned */
     chunk_read_req_t** chunks);      /* [out] extent array */
 
+/* given an extent tree and an array of logical ranges, return in chunks
+ * the extents that overlap each range (trimmed to the range), listed in
+ * order of the given ranges, while holding the tree lock once */
+int extent_tree_get_chunk_lists(
+    struct extent_tree* extent_tree, /* extent tree to search */
+    unsigned int n_ranges,           /* number of ranges to look up */
+    struct extent_tree_range* ranges, /* array of ranges */
+    unsigned int* n_chunks,          /* [out] number of chunks returned */
+    chunk_read_req_t** chunks);      /* [out] extent array */
+
 /* dump method for debugging extent trees */
 static inline
 void extent_tree_dump(struct extent_tree* extent_tree)
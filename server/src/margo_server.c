@@ -179,6 +179,11 @@ static void register_server_server_rpcs(margo_instance_id mid)
                        laminate_bcast_in_t, laminate_bcast_out_t,
                        laminate_bcast_rpc);
 
+    unifyfsd_rpc_context->rpcs.lease_revoke_id =
+        MARGO_REGISTER(mid, "lease_revoke_rpc",
+                       lease_revoke_in_t, lease_revoke_out_t,
+                       lease_revoke_rpc);
+
     unifyfsd_rpc_context->rpcs.metaget_id =
         MARGO_REGISTER(mid, "metaget_rpc",
                        metaget_in_t, metaget_out_t,
@@ -194,6 +199,11 @@ static void register_server_server_rpcs(margo_instance_id mid)
                        server_pid_in_t, server_pid_out_t,
                        server_pid_rpc);
 
+    unifyfsd_rpc_context->rpcs.transfer_bcast_id =
+        MARGO_REGISTER(mid, "transfer_bcast_rpc",
+                       transfer_bcast_in_t, transfer_bcast_out_t,
+                       transfer_bcast_rpc);
+
     unifyfsd_rpc_context->rpcs.truncate_id =
         MARGO_REGISTER(mid, "truncate_rpc",
                        truncate_in_t, truncate_out_t,
@@ -281,6 +291,10 @@ static void register_client_server_rpcs(margo_instance_id mid)
                    unifyfs_fsync_in_t, unifyfs_fsync_out_t,
                    unifyfs_fsync_rpc);
 
+    MARGO_REGISTER(mid, "unifyfs_extent_map_rpc",
+                   unifyfs_extent_map_in_t, unifyfs_extent_map_out_t,
+                   unifyfs_extent_map_rpc);
+
     MARGO_REGISTER(mid, "unifyfs_filesize_rpc",
                    unifyfs_filesize_in_t, unifyfs_filesize_out_t,
                    unifyfs_filesize_rpc);
@@ -297,10 +311,26 @@ static void register_client_server_rpcs(margo_instance_id mid)
                    unifyfs_laminate_in_t, unifyfs_laminate_out_t,
                    unifyfs_laminate_rpc);
 
+    MARGO_REGISTER(mid, "unifyfs_transfer_rpc",
+                   unifyfs_transfer_in_t, unifyfs_transfer_out_t,
+                   unifyfs_transfer_rpc);
+
     MARGO_REGISTER(mid, "unifyfs_mread_rpc",
                    unifyfs_mread_in_t, unifyfs_mread_out_t,
                    unifyfs_mread_rpc);
 
+    MARGO_REGISTER(mid, "unifyfs_stat_rpc",
+                   unifyfs_stat_in_t, unifyfs_stat_out_t,
+                   unifyfs_stat_rpc);
+
+    MARGO_REGISTER(mid, "unifyfs_stat_many_rpc",
+                   unifyfs_stat_many_in_t, unifyfs_stat_many_out_t,
+                   unifyfs_stat_many_rpc);
+
+    MARGO_REGISTER(mid, "unifyfs_stats_rpc",
+                   unifyfs_stats_in_t, unifyfs_stats_out_t,
+                   unifyfs_stats_rpc);
+
     /* register the RPCs we call (and capture assigned hg_id_t) */
     unifyfsd_rpc_context->rpcs.client_mread_data_id =
         MARGO_REGISTER(mid, "unifyfs_mread_req_data_rpc",
@@ -571,6 +601,62 @@ void* pull_margo_bulk_buffer(hg_handle_t rpc_hdl,
     }
 }
 
+/* Push contents of buffer to the remote buffer of passed bulk handle.
+ * Returns UNIFYFS_SUCCESS, or UNIFYFS_ERROR_MARGO on failure. */
+int push_margo_bulk_buffer(hg_handle_t rpc_hdl,
+                           hg_bulk_t bulk_remote,
+                           void* buffer,
+                           hg_size_t bulk_sz)
+{
+    if (0 == bulk_sz) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    /* get mercury info to set up bulk transfer */
+    const struct hg_info* hgi = margo_get_info(rpc_hdl);
+    assert(hgi);
+    margo_instance_id mid = margo_hg_info_get_instance(hgi);
+    assert(mid != MARGO_INSTANCE_NULL);
+
+    /* register local source buffer for bulk access */
+    hg_bulk_t bulk_local;
+    hg_return_t hret = margo_bulk_create(mid, 1, &buffer, &bulk_sz,
+                                         HG_BULK_READ_ONLY, &bulk_local);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_bulk_create() failed");
+        return UNIFYFS_ERROR_MARGO;
+    }
+
+    /* execute the transfer in chunks of at most MAX_BULK_TX_SIZE,
+     * as in pull_margo_bulk_buffer() */
+    int i = 0;
+    hg_size_t remain = bulk_sz;
+    do {
+        hg_size_t offset = i * MAX_BULK_TX_SIZE;
+        hg_size_t len = remain < MAX_BULK_TX_SIZE ? remain : MAX_BULK_TX_SIZE;
+        hret = margo_bulk_transfer(mid, HG_BULK_PUSH, hgi->addr,
+                                   bulk_remote, offset,
+                                   bulk_local, offset, len);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_bulk_transfer(buf_offset=%zu, len=%zu) failed",
+                   (size_t)offset, (size_t)len);
+            break;
+        }
+        remain -= len;
+        i++;
+    } while (remain > 0);
+
+    margo_bulk_free(bulk_local);
+
+    if (hret != HG_SUCCESS) {
+        LOGERR("failed bulk transfer - transferred %zu of %zu bytes",
+               (bulk_sz - remain), bulk_sz);
+        return UNIFYFS_ERROR_MARGO;
+    }
+    LOGDBG("successful bulk transfer (%zu bytes)", bulk_sz);
+    return UNIFYFS_SUCCESS;
+}
+
 /* MARGO CLIENT-SERVER RPC INVOCATION FUNCTIONS */
 
 /* create and return a margo handle for given rpc id and app-client */
@@ -40,10 +40,12 @@ typedef struct ServerRpcIds {
     hg_id_t filesize_id;
     hg_id_t laminate_id;
     hg_id_t laminate_bcast_id;
+    hg_id_t lease_revoke_id;
     hg_id_t metaget_id;
     hg_id_t metaset_id;
     hg_id_t fileattr_bcast_id;
     hg_id_t server_pid_id;
+    hg_id_t transfer_bcast_id;
     hg_id_t truncate_id;
     hg_id_t truncate_bcast_id;
     hg_id_t unlink_bcast_id;
@@ -79,6 +81,13 @@ void* pull_margo_bulk_buffer(hg_handle_t rpc_hdl,
                             hg_size_t bulk_sz,
                             hg_bulk_t* local_bulk);
 
+/* push contents of buffer to the remote buffer of passed bulk handle.
+ * returns UNIFYFS_SUCCESS, or UNIFYFS_ERROR_MARGO on failure. */
+int push_margo_bulk_buffer(hg_handle_t rpc_hdl,
+                           hg_bulk_t bulk_remote,
+                           void* buffer,
+                           hg_size_t bulk_sz);
+
 /* invokes the client mread request data response rpc function */
 int invoke_client_mread_req_data_rpc(int app_id,
                                      int client_id,
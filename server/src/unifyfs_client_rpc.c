@@ -41,6 +41,7 @@
 #include "unifyfs_client_rpcs.h"
 #include "unifyfs_rpc_util.h"
 #include "unifyfs_misc.h"
+#include "unifyfs_stats.h"
 
 
 static void create_mountpoint_dir(int app_id,
@@ -133,7 +134,7 @@ static void unifyfs_mount_rpc(hg_handle_t handle)
         ret = UNIFYFS_ERROR_MARGO;
     } else {
         /* read app_id and client_id from input */
-        app_id = unifyfs_generate_gfid(in.mount_prefix);
+        app_id = unifyfs_generate_app_id(in.mount_prefix);
 
         /* lookup app_config for given app_id */
         app_config* app_cfg = get_application(app_id);
@@ -479,6 +480,79 @@ static void unifyfs_fsync_rpc(hg_handle_t handle)
 }
 DEFINE_MARGO_RPC_HANDLER(unifyfs_fsync_rpc)
 
+/* given an app_id, client_id, global file id, and starting offset,
+ * return the written ranges of the file */
+static void unifyfs_extent_map_rpc(hg_handle_t handle)
+{
+    int ret = UNIFYFS_SUCCESS;
+    hg_return_t hret;
+
+    /* get input params */
+    unifyfs_extent_map_in_t* in = malloc(sizeof(*in));
+    if (NULL == in) {
+        ret = ENOMEM;
+    } else {
+        hret = margo_get_input(handle, in);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_get_input() failed");
+            ret = UNIFYFS_ERROR_MARGO;
+        } else {
+            client_rpc_req_t* req = NULL;
+            size_t expected = (size_t)in->max_ranges *
+                              sizeof(unifyfs_extent_t);
+            if ((in->max_ranges <= 0) ||
+                ((size_t)in->bulk_size != expected)) {
+                LOGERR("invalid extent map request (max=%d, size=%zu)",
+                       (int)in->max_ranges, (size_t)in->bulk_size);
+                ret = EINVAL;
+            } else {
+                req = malloc(sizeof(client_rpc_req_t));
+                if (NULL == req) {
+                    ret = ENOMEM;
+                } else {
+                    unifyfs_fops_ctx_t ctx = {
+                        .app_id = in->app_id,
+                        .client_id = in->client_id,
+                    };
+                    req->req_type = UNIFYFS_CLIENT_RPC_EXTENT_MAP;
+                    req->handle = handle;
+                    req->input = (void*) in;
+                    req->bulk_buf = NULL;
+                    req->bulk_sz = 0;
+                    ret = rm_submit_client_rpc_request(&ctx, req);
+                }
+            }
+
+            if (ret != UNIFYFS_SUCCESS) {
+                if (NULL != req) {
+                    free(req);
+                }
+                margo_free_input(handle, in);
+            }
+        }
+    }
+
+    /* if we hit an error during request submission, respond with the error */
+    if (ret != UNIFYFS_SUCCESS) {
+        if (NULL != in) {
+            free(in);
+        }
+
+        /* return to caller */
+        unifyfs_extent_map_out_t out;
+        out.ret = (int32_t) ret;
+        out.num_ranges = 0;
+        hret = margo_respond(handle, &out);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_respond() failed");
+        }
+
+        /* free margo resources */
+        margo_destroy(handle);
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(unifyfs_extent_map_rpc)
+
 /* given an app_id, client_id, global file id,
  * return current file size */
 static void unifyfs_filesize_rpc(hg_handle_t handle)
@@ -730,6 +804,69 @@ static void unifyfs_laminate_rpc(hg_handle_t handle)
 }
 DEFINE_MARGO_RPC_HANDLER(unifyfs_laminate_rpc)
 
+/* given an app_id, client_id, global file id, and destination file path,
+ * stage out the laminated file */
+static void unifyfs_transfer_rpc(hg_handle_t handle)
+{
+    int ret = UNIFYFS_SUCCESS;
+    hg_return_t hret;
+
+    /* get input params */
+    unifyfs_transfer_in_t* in = malloc(sizeof(*in));
+    if (NULL == in) {
+        ret = ENOMEM;
+    } else {
+        hret = margo_get_input(handle, in);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_get_input() failed");
+            ret = UNIFYFS_ERROR_MARGO;
+        } else {
+            client_rpc_req_t* req = malloc(sizeof(client_rpc_req_t));
+            if (NULL == req) {
+                ret = ENOMEM;
+            } else {
+                unifyfs_fops_ctx_t ctx = {
+                    .app_id = in->app_id,
+                    .client_id = in->client_id,
+                };
+                req->req_type = UNIFYFS_CLIENT_RPC_TRANSFER;
+                req->handle = handle;
+                req->input = (void*) in;
+                req->bulk_buf = NULL;
+                req->bulk_sz = 0;
+                ret = rm_submit_client_rpc_request(&ctx, req);
+            }
+
+            if (ret != UNIFYFS_SUCCESS) {
+                if (NULL != req) {
+                    free(req);
+                }
+                margo_free_input(handle, in);
+            }
+        }
+    }
+
+    /* if we hit an error during request submission, respond with the error */
+    if (ret != UNIFYFS_SUCCESS) {
+        if (NULL != in) {
+            free(in);
+        }
+
+        /* return to caller */
+        unifyfs_transfer_out_t out;
+        out.ret = (int32_t) ret;
+        hret = margo_respond(handle, &out);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_respond() failed");
+        }
+
+        /* free margo resources */
+        margo_destroy(handle);
+    }
+
+}
+DEFINE_MARGO_RPC_HANDLER(unifyfs_transfer_rpc)
+
 
 /* given (mread_id, app_id, client_id) and count of read requests,
  * followed by a bulk data array of read extents (unifyfs_extent_t),
@@ -801,3 +938,199 @@ static void unifyfs_mread_rpc(hg_handle_t handle)
     }
 }
 DEFINE_MARGO_RPC_HANDLER(unifyfs_mread_rpc)
+
+/* returns file meta data with an up-to-date file size
+ * given a global file id */
+static void unifyfs_stat_rpc(hg_handle_t handle)
+{
+    int ret = UNIFYFS_SUCCESS;
+    hg_return_t hret;
+
+    /* get input params */
+    unifyfs_stat_in_t* in = malloc(sizeof(*in));
+    if (NULL == in) {
+        ret = ENOMEM;
+    } else {
+        hret = margo_get_input(handle, in);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_get_input() failed");
+            ret = UNIFYFS_ERROR_MARGO;
+        } else {
+            client_rpc_req_t* req = malloc(sizeof(client_rpc_req_t));
+            if (NULL == req) {
+                ret = ENOMEM;
+            } else {
+                unifyfs_fops_ctx_t ctx = {
+                    .app_id = in->app_id,
+                    .client_id = in->client_id,
+                };
+                req->req_type = UNIFYFS_CLIENT_RPC_STAT;
+                req->handle = handle;
+                req->input = (void*) in;
+                req->bulk_buf = NULL;
+                req->bulk_sz = 0;
+                ret = rm_submit_client_rpc_request(&ctx, req);
+            }
+
+            if (ret != UNIFYFS_SUCCESS) {
+                if (NULL != req) {
+                    free(req);
+                }
+                margo_free_input(handle, in);
+            }
+        }
+    }
+
+    /* if we hit an error during request submission, respond with the error */
+    if (ret != UNIFYFS_SUCCESS) {
+        if (NULL != in) {
+            free(in);
+        }
+
+        /* return to caller */
+        unifyfs_stat_out_t out;
+        out.ret = (int32_t) ret;
+        memset(&(out.attr), 0, sizeof(out.attr));
+        hret = margo_respond(handle, &out);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_respond() failed");
+        }
+
+        /* free margo resources */
+        margo_destroy(handle);
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(unifyfs_stat_rpc)
+
+/* given (app_id, client_id) and count of files, followed by a bulk data
+ * array of stat results (unifyfs_stat_result_t), look up the metadata for
+ * all files. The input (and its bulk handle) is kept with the request, so
+ * that the results can be pushed back into the client's array. */
+static void unifyfs_stat_many_rpc(hg_handle_t handle)
+{
+    int ret = UNIFYFS_SUCCESS;
+    hg_return_t hret;
+
+    /* get input params */
+    unifyfs_stat_many_in_t* in = malloc(sizeof(*in));
+    if (NULL == in) {
+        ret = ENOMEM;
+    } else {
+        hret = margo_get_input(handle, in);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_get_input() failed");
+            ret = UNIFYFS_ERROR_MARGO;
+        } else {
+            /* pull array of stat results holding the target gfids */
+            hg_size_t size = in->bulk_size;
+            size_t expected = (size_t)in->num_files *
+                              sizeof(unifyfs_stat_result_t);
+            void* buffer = NULL;
+            if ((in->num_files <= 0) || ((size_t)size != expected)) {
+                LOGERR("invalid stat-many request (num_files=%d, size=%zu)",
+                       (int)in->num_files, (size_t)size);
+                ret = EINVAL;
+            } else {
+                buffer = pull_margo_bulk_buffer(handle, in->bulk_results,
+                                                size, NULL);
+                if (NULL == buffer) {
+                    ret = UNIFYFS_ERROR_MARGO;
+                }
+            }
+            if (NULL != buffer) {
+                client_rpc_req_t* req = malloc(sizeof(*req));
+                if (NULL == req) {
+                    ret = ENOMEM;
+                } else {
+                    unifyfs_fops_ctx_t ctx = {
+                        .app_id = in->app_id,
+                        .client_id = in->client_id
+                    };
+                    req->req_type = UNIFYFS_CLIENT_RPC_STAT_MANY;
+                    req->handle = handle;
+                    req->input = (void*) in;
+                    req->bulk_buf = buffer;
+                    req->bulk_sz = size;
+                    ret = rm_submit_client_rpc_request(&ctx, req);
+                }
+                if (ret != UNIFYFS_SUCCESS) {
+                    free(buffer);
+                    if (NULL != req) {
+                        free(req);
+                    }
+                }
+            }
+            if (ret != UNIFYFS_SUCCESS) {
+                margo_free_input(handle, in);
+            }
+        }
+    }
+
+    /* if we hit an error during request submission, respond with the error */
+    if (ret != UNIFYFS_SUCCESS) {
+        if (NULL != in) {
+            free(in);
+        }
+
+        /* return to caller */
+        unifyfs_stat_many_out_t out;
+        out.ret = (int32_t) ret;
+        hret = margo_respond(handle, &out);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_respond() failed");
+        }
+
+        /* free margo resources */
+        margo_destroy(handle);
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(unifyfs_stat_many_rpc)
+
+/* push a snapshot of the server performance statistics as a JSON string
+ * into the client's buffer. This is answered directly rather than by the
+ * client's request manager, so that it is not queued behind the client
+ * requests it may be used to diagnose. */
+static void unifyfs_stats_rpc(hg_handle_t handle)
+{
+    int ret = UNIFYFS_SUCCESS;
+    size_t json_len = 0;
+    uint64_t start = unifyfs_stats_now_ns();
+
+    /* get input params */
+    unifyfs_stats_in_t in;
+    hg_return_t hret = margo_get_input(handle, &in);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_get_input() failed");
+        ret = UNIFYFS_ERROR_MARGO;
+    } else {
+        char* json = NULL;
+        ret = unifyfs_stats_to_json(&json, &json_len);
+        if (ret != UNIFYFS_SUCCESS) {
+            LOGERR("failed to take statistics snapshot");
+        } else if (json_len < (size_t)in.bulk_size) {
+            /* push the string with its terminating NUL */
+            ret = push_margo_bulk_buffer(handle, in.bulk_json,
+                                         json, json_len + 1);
+        }
+        free(json);
+        margo_free_input(handle, &in);
+    }
+
+    /* build output structure to return to caller */
+    unifyfs_stats_out_t out;
+    out.ret = (int32_t) ret;
+    out.json_size = (hg_size_t) json_len;
+
+    /* send output back to caller */
+    hret = margo_respond(handle, &out);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_respond() failed");
+    }
+
+    /* free margo resources */
+    margo_destroy(handle);
+
+    unifyfs_stats_record_rpc(UNIFYFS_STATS_RPC_CLIENT,
+                             UNIFYFS_CLIENT_RPC_STATS, start);
+}
+DEFINE_MARGO_RPC_HANDLER(unifyfs_stats_rpc)
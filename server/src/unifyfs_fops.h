@@ -18,6 +18,7 @@
 #include "unifyfs_configurator.h"
 #include "unifyfs_log.h"
 #include "unifyfs_meta.h"
+#include "unifyfs_trace.h"
 
 /*
  * extra information that we need to pass for file operations.
@@ -26,32 +27,50 @@ struct _unifyfs_fops_ctx {
     int app_id;
     int client_id;
     int mread_id;
+    unifyfs_trace_ctx_t trace; /* trace context of the client request */
 };
 typedef struct _unifyfs_fops_ctx unifyfs_fops_ctx_t;
 
 typedef int (*unifyfs_fops_init_t)(unifyfs_cfg_t* cfg);
 
 typedef int (*unifyfs_fops_metaget_t)(unifyfs_fops_ctx_t* ctx,
-                                      int gfid, unifyfs_file_attr_t* attr);
+                                      int64_t gfid, unifyfs_file_attr_t* attr);
 
 typedef int (*unifyfs_fops_metaset_t)(unifyfs_fops_ctx_t* ctx,
-                                      int gfid, int attr_op,
+                                      int64_t gfid, int attr_op,
                                       unifyfs_file_attr_t* attr);
 
-typedef int (*unifyfs_fops_fsync_t)(unifyfs_fops_ctx_t* ctx, int gfid);
+typedef int (*unifyfs_fops_fsync_t)(unifyfs_fops_ctx_t* ctx, int64_t gfid);
+
+typedef int (*unifyfs_fops_extent_map_t)(unifyfs_fops_ctx_t* ctx,
+                                         int64_t gfid, size_t offset,
+                                         size_t max_ranges,
+                                         unifyfs_extent_t* ranges,
+                                         size_t* num_ranges);
 
 typedef int (*unifyfs_fops_filesize_t)(unifyfs_fops_ctx_t* ctx,
-                                       int gfid, size_t* filesize);
+                                       int64_t gfid, size_t* filesize);
+
+typedef int (*unifyfs_fops_stat_t)(unifyfs_fops_ctx_t* ctx,
+                                   int64_t gfid, unifyfs_file_attr_t* attr,
+                                   int* cacheable);
+
+typedef int (*unifyfs_fops_stat_many_t)(unifyfs_fops_ctx_t* ctx,
+                                        size_t n_files,
+                                        unifyfs_stat_result_t* results);
 
 typedef int (*unifyfs_fops_truncate_t)(unifyfs_fops_ctx_t* ctx,
-                                       int gfid, off_t len);
+                                       int64_t gfid, off_t len);
+
+typedef int (*unifyfs_fops_laminate_t)(unifyfs_fops_ctx_t* ctx, int64_t gfid);
 
-typedef int (*unifyfs_fops_laminate_t)(unifyfs_fops_ctx_t* ctx, int gfid);
+typedef int (*unifyfs_fops_transfer_t)(unifyfs_fops_ctx_t* ctx,
+                                       int64_t gfid, const char* dst_file);
 
-typedef int (*unifyfs_fops_unlink_t)(unifyfs_fops_ctx_t* ctx, int gfid);
+typedef int (*unifyfs_fops_unlink_t)(unifyfs_fops_ctx_t* ctx, int64_t gfid);
 
 typedef int (*unifyfs_fops_read_t)(unifyfs_fops_ctx_t* ctx,
-                                   int gfid, off_t offset, size_t len);
+                                   int64_t gfid, off_t offset, size_t len);
 
 typedef int (*unifyfs_fops_mread_t)(unifyfs_fops_ctx_t* ctx,
                                     size_t n_req, void* req);
@@ -62,9 +81,13 @@ struct unifyfs_fops {
     unifyfs_fops_metaget_t metaget;
     unifyfs_fops_metaset_t metaset;
     unifyfs_fops_fsync_t fsync;
+    unifyfs_fops_extent_map_t extent_map;
     unifyfs_fops_filesize_t filesize;
+    unifyfs_fops_stat_t stat;
+    unifyfs_fops_stat_many_t stat_many;
     unifyfs_fops_truncate_t truncate;
     unifyfs_fops_laminate_t laminate;
+    unifyfs_fops_transfer_t transfer;
     unifyfs_fops_unlink_t unlink;
     unifyfs_fops_read_t read;
     unifyfs_fops_mread_t mread;
@@ -99,7 +122,7 @@ static inline int unifyfs_fops_init(unifyfs_cfg_t* cfg)
 }
 
 static inline int unifyfs_fops_metaget(unifyfs_fops_ctx_t* ctx,
-                                       int gfid, unifyfs_file_attr_t* attr)
+                                       int64_t gfid, unifyfs_file_attr_t* attr)
 {
     if (!global_fops_tab->metaget) {
         return ENOSYS;
@@ -109,7 +132,7 @@ static inline int unifyfs_fops_metaget(unifyfs_fops_ctx_t* ctx,
 }
 
 static inline int unifyfs_fops_metaset(unifyfs_fops_ctx_t* ctx,
-                                       int gfid, int attr_op,
+                                       int64_t gfid, int attr_op,
                                        unifyfs_file_attr_t* attr)
 {
     if (!global_fops_tab->metaset) {
@@ -119,7 +142,7 @@ static inline int unifyfs_fops_metaset(unifyfs_fops_ctx_t* ctx,
     return global_fops_tab->metaset(ctx, gfid, attr_op, attr);
 }
 
-static inline int unifyfs_fops_fsync(unifyfs_fops_ctx_t* ctx, int gfid)
+static inline int unifyfs_fops_fsync(unifyfs_fops_ctx_t* ctx, int64_t gfid)
 {
     if (!global_fops_tab->fsync) {
         return ENOSYS;
@@ -128,8 +151,24 @@ static inline int unifyfs_fops_fsync(unifyfs_fops_ctx_t* ctx, int gfid)
     return global_fops_tab->fsync(ctx, gfid);
 }
 
+/* get up to max_ranges written ranges of the file at or after offset,
+ * in offset order, with adjacent ranges merged */
+static inline int unifyfs_fops_extent_map(unifyfs_fops_ctx_t* ctx,
+                                          int64_t gfid, size_t offset,
+                                          size_t max_ranges,
+                                          unifyfs_extent_t* ranges,
+                                          size_t* num_ranges)
+{
+    if (!global_fops_tab->extent_map) {
+        return ENOSYS;
+    }
+
+    return global_fops_tab->extent_map(ctx, gfid, offset, max_ranges,
+                                       ranges, num_ranges);
+}
+
 static inline int unifyfs_fops_filesize(unifyfs_fops_ctx_t* ctx,
-                                        int gfid, size_t* filesize)
+                                        int64_t gfid, size_t* filesize)
 {
     if (!global_fops_tab->filesize) {
         return ENOSYS;
@@ -138,8 +177,54 @@ static inline int unifyfs_fops_filesize(unifyfs_fops_ctx_t* ctx,
     return global_fops_tab->filesize(ctx, gfid, filesize);
 }
 
+/* get file attributes with an up-to-date size. the filename is not
+ * returned. cacheable is set if the client may keep the attributes until
+ * its metadata epoch changes. for implementations without a combined
+ * lookup, this falls back to metaget followed by filesize */
+static inline int unifyfs_fops_stat(unifyfs_fops_ctx_t* ctx,
+                                    int64_t gfid, unifyfs_file_attr_t* attr,
+                                    int* cacheable)
+{
+    if (global_fops_tab->stat) {
+        return global_fops_tab->stat(ctx, gfid, attr, cacheable);
+    }
+
+    *cacheable = 0;
+    int ret = unifyfs_fops_metaget(ctx, gfid, attr);
+    attr->filename = NULL;
+    if ((ret == UNIFYFS_SUCCESS) && !attr->is_laminated &&
+        S_ISREG(attr->mode)) {
+        size_t filesize = 0;
+        ret = unifyfs_fops_filesize(ctx, gfid, &filesize);
+        if (ret == UNIFYFS_SUCCESS) {
+            attr->size = (uint64_t) filesize;
+        }
+    }
+    return ret;
+}
+
+/* get attributes for each gfid in the results array, setting the rc and
+ * attr of each result */
+static inline int unifyfs_fops_stat_many(unifyfs_fops_ctx_t* ctx,
+                                         size_t n_files,
+                                         unifyfs_stat_result_t* results)
+{
+    if (global_fops_tab->stat_many) {
+        return global_fops_tab->stat_many(ctx, n_files, results);
+    }
+
+    for (size_t i = 0; i < n_files; i++) {
+        unifyfs_stat_result_t* res = results + i;
+        memset(&(res->attr), 0, sizeof(res->attr));
+        int cacheable;
+        res->rc = unifyfs_fops_stat(ctx, res->gfid, &(res->attr),
+                                    &cacheable);
+    }
+    return UNIFYFS_SUCCESS;
+}
+
 static inline int unifyfs_fops_truncate(unifyfs_fops_ctx_t* ctx,
-                                        int gfid, off_t len)
+                                        int64_t gfid, off_t len)
 {
     if (!global_fops_tab->truncate) {
         return ENOSYS;
@@ -148,7 +233,7 @@ static inline int unifyfs_fops_truncate(unifyfs_fops_ctx_t* ctx,
     return global_fops_tab->truncate(ctx, gfid, len);
 }
 
-static inline int unifyfs_fops_laminate(unifyfs_fops_ctx_t* ctx, int gfid)
+static inline int unifyfs_fops_laminate(unifyfs_fops_ctx_t* ctx, int64_t gfid)
 {
     if (!global_fops_tab->laminate) {
         return ENOSYS;
@@ -157,7 +242,19 @@ static inline int unifyfs_fops_laminate(unifyfs_fops_ctx_t* ctx, int gfid)
     return global_fops_tab->laminate(ctx, gfid);
 }
 
-static inline int unifyfs_fops_unlink(unifyfs_fops_ctx_t* ctx, int gfid)
+/* write the data of a laminated file to dst_file, with each server
+ * writing the extents held in its local logs */
+static inline int unifyfs_fops_transfer(unifyfs_fops_ctx_t* ctx,
+                                        int64_t gfid, const char* dst_file)
+{
+    if (!global_fops_tab->transfer) {
+        return ENOSYS;
+    }
+
+    return global_fops_tab->transfer(ctx, gfid, dst_file);
+}
+
+static inline int unifyfs_fops_unlink(unifyfs_fops_ctx_t* ctx, int64_t gfid)
 {
     if (!global_fops_tab->unlink) {
         return ENOSYS;
@@ -167,7 +264,7 @@ static inline int unifyfs_fops_unlink(unifyfs_fops_ctx_t* ctx, int gfid)
 }
 
 static inline int unifyfs_fops_read(unifyfs_fops_ctx_t* ctx,
-                                    int gfid, off_t offset, size_t len)
+                                    int64_t gfid, off_t offset, size_t len)
 {
     if (!global_fops_tab->read) {
         return ENOSYS;
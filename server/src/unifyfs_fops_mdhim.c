@@ -26,7 +26,7 @@ static int split_index(
     unifyfs_val_t** vals, /* list to add newly created values into */
     int* keylens,         /* list for size of each key */
     int* vallens,         /* list for size of each value */
-    int gfid,             /* global file id of write */
+    int64_t gfid,         /* global file id of write */
     size_t offset,        /* starting byte offset of extent */
     size_t length,        /* number of bytes in extent */
     size_t log_offset,    /* offset within data log */
@@ -102,7 +102,7 @@ static int split_index(
 static int split_request(
     unifyfs_key_t** keys, /* list to add newly created keys into */
     int* keylens,         /* list to add byte size of each key */
-    int gfid,             /* target global file id to read from */
+    int64_t gfid,         /* target global file id to read from */
     size_t offset,        /* starting offset of read */
     size_t length)        /* number of bytes to read */
 {
@@ -167,59 +167,28 @@ static int mdhim_init(unifyfs_cfg_t* cfg)
 }
 
 static int mdhim_metaget(unifyfs_fops_ctx_t* ctx,
-                         int gfid, unifyfs_file_attr_t* attr)
+                         int64_t gfid, unifyfs_file_attr_t* attr)
 {
     return unifyfs_get_file_attribute(gfid, attr);
 }
 
 static int mdhim_metaset(unifyfs_fops_ctx_t* ctx,
-                         int gfid, int create, unifyfs_file_attr_t* attr)
+                         int64_t gfid, int create, unifyfs_file_attr_t* attr)
 {
     return unifyfs_set_file_attribute(create, create, attr);
 }
 
-static int mdhim_fsync(unifyfs_fops_ctx_t* ctx, int gfid)
+/* store a run of client index entries for a single file in MDHIM */
+static int mdhim_sync_extents(unifyfs_fops_ctx_t* ctx,
+                              unifyfs_index_t* meta_payload,
+                              size_t extent_num_entries)
 {
     size_t i;
 
     /* assume we'll succeed */
     int ret = (int)UNIFYFS_SUCCESS;
 
-    /* get memory page size on this machine */
-    int page_sz = (int) get_page_size();
-
-    /* get application client */
-    app_client* client = get_app_client(ctx->app_id, ctx->client_id);
-    if (NULL == client) {
-        return EINVAL;
-    }
-
-    /* get pointer to superblock for this client and app */
-    shm_context* super_ctx = client->shmem_super;
-    if (NULL == super_ctx) {
-        LOGERR("missing client superblock");
-        return UNIFYFS_FAILURE;
-    }
-    char* superblk = (char*)(super_ctx->addr);
-
-    /* get pointer to start of key/value region in superblock */
-    char* meta = superblk + client->super_meta_offset;
-
-    /* get number of file extent index values client has for us,
-     * stored as a size_t value in meta region of shared memory */
-    size_t extent_num_entries = *(size_t*)(meta);
-
-    /* indices are stored in the superblock shared memory
-     * created by the client, these are stored as index_t
-     * structs starting one page size offset into meta region */
-    char* ptr_extents = meta + page_sz;
-
-    if (extent_num_entries == 0) {
-        /* Nothing to do */
-        return UNIFYFS_SUCCESS;
-    }
-
-    unifyfs_index_t* meta_payload = (unifyfs_index_t*)(ptr_extents);
+    int64_t gfid = meta_payload[0].gfid;
 
     /* total up number of key/value pairs we'll need for this
      * set of index values */
@@ -305,7 +274,61 @@ mdhim_sync_exit:
     return ret;
 }
 
-static int mdhim_filesize(unifyfs_fops_ctx_t* ctx, int gfid, size_t* outsize)
+/* consume the extents the client has published in its index ring,
+ * up to the ring tail at the time of the call */
+static int mdhim_fsync(unifyfs_fops_ctx_t* ctx, int64_t gfid)
+{
+    /* assume we'll succeed */
+    int ret = (int)UNIFYFS_SUCCESS;
+
+    /* get application client */
+    app_client* client = get_app_client(ctx->app_id, ctx->client_id);
+    if (NULL == client) {
+        return EINVAL;
+    }
+
+    if (NULL == client->shmem_super) {
+        LOGERR("missing client superblock");
+        return UNIFYFS_FAILURE;
+    }
+
+    size_t num_pending = app_client_index_pending(client);
+    if (num_pending == 0) {
+        /* Nothing to do */
+        return UNIFYFS_SUCCESS;
+    }
+
+    unifyfs_index_t* entries = calloc(num_pending, sizeof(*entries));
+    if (NULL == entries) {
+        LOGERR("failed to allocate memory for index entries");
+        return ENOMEM;
+    }
+
+    size_t num_done = 0;
+    while (num_done < num_pending) {
+        size_t n = app_client_index_next_run(client, entries,
+                                             num_pending - num_done);
+        if (0 == n) {
+            break;
+        }
+
+        int rc = mdhim_sync_extents(ctx, entries, n);
+        if (rc != UNIFYFS_SUCCESS) {
+            ret = rc;
+        }
+
+        /* consume entries even on failure, error goes to the client */
+        app_client_index_consume(client, n);
+        num_done += n;
+    }
+
+    free(entries);
+
+    return ret;
+}
+
+static int mdhim_filesize(unifyfs_fops_ctx_t* ctx, int64_t gfid,
+                          size_t* outsize)
 {
     size_t filesize = 0;
     int ret = unifyfs_invoke_filesize_rpc(gfid, &filesize);
@@ -543,7 +566,7 @@ truncate_rewrite_exit:
     return ret;
 }
 
-static int mdhim_truncate(unifyfs_fops_ctx_t* ctx, int gfid, off_t len)
+static int mdhim_truncate(unifyfs_fops_ctx_t* ctx, int64_t gfid, off_t len)
 {
     size_t newsize = (size_t) len;
 
@@ -659,7 +682,7 @@ truncate_exit:
     return rc;
 }
 
-static int mdhim_laminate(unifyfs_fops_ctx_t* ctx, int gfid)
+static int mdhim_laminate(unifyfs_fops_ctx_t* ctx, int64_t gfid)
 {
     int rc = UNIFYFS_SUCCESS;
 
@@ -676,7 +699,8 @@ static int mdhim_laminate(unifyfs_fops_ctx_t* ctx, int gfid)
     mode_t mode = (mode_t) attr.mode;
     if ((mode & S_IFMT) != S_IFREG) {
         /* item is not a regular file */
-        LOGERR("ERROR: only regular files can be laminated (gfid=%d)", gfid);
+        LOGERR("ERROR: only regular files can be laminated (gfid=%" PRId64 ")",
+               gfid);
         return EINVAL;
     }
 
@@ -685,7 +709,8 @@ static int mdhim_laminate(unifyfs_fops_ctx_t* ctx, int gfid)
     ret = mdhim_filesize(ctx, gfid, &filesize);
     if (ret != UNIFYFS_SUCCESS) {
         /* failed to get file size for file */
-        LOGERR("lamination file size calculation failed (gfid=%d)", gfid);
+        LOGERR("lamination file size calculation failed (gfid=%" PRId64 ")",
+               gfid);
         return ret;
     }
 
@@ -696,13 +721,13 @@ static int mdhim_laminate(unifyfs_fops_ctx_t* ctx, int gfid)
     /* update metadata, set size and laminate */
     rc = unifyfs_set_file_attribute(1, 1, &attr);
     if (rc != UNIFYFS_SUCCESS) {
-        LOGERR("lamination metadata update failed (gfid=%d)", gfid);
+        LOGERR("lamination metadata update failed (gfid=%" PRId64 ")", gfid);
     }
 
     return rc;
 }
 
-static int mdhim_unlink(unifyfs_fops_ctx_t* ctx, int gfid)
+static int mdhim_unlink(unifyfs_fops_ctx_t* ctx, int64_t gfid)
 {
     int rc = UNIFYFS_SUCCESS;
 
@@ -806,7 +831,7 @@ static int get_local_keyvals(
         unifyfs_key_t* k2 = keys[i+1];
 
         /* get gfid, start, and end offset of this pair */
-        int gfid     = k1->gfid;
+        int64_t gfid     = k1->gfid;
         size_t start = k1->offset;
         size_t end   = k2->offset;
 
@@ -820,7 +845,7 @@ static int get_local_keyvals(
         int ret = unifyfs_inode_span_extents(gfid, start, end,
                 UNIFYFS_MAX_SPLIT_CNT, tmpkeys, tmpvals, &num_local);
         if (ret) {
-            LOGERR("failed to span extents (gfid=%d)", gfid);
+            LOGERR("failed to span extents (gfid=%" PRId64 ")", gfid);
             // now what?
         }
 
@@ -937,7 +962,7 @@ static int get_local_keyvals(
     return UNIFYFS_SUCCESS;
 }
 
-static int create_gfid_chunk_reads(reqmgr_thrd_t* thrd_ctrl, int gfid,
+static int create_gfid_chunk_reads(reqmgr_thrd_t* thrd_ctrl, int64_t gfid,
                                    int app_id, int client_id, int num_keys,
                                    unifyfs_key_t** keys, int* keylens)
 {
@@ -1006,7 +1031,7 @@ static int create_gfid_chunk_reads(reqmgr_thrd_t* thrd_ctrl, int gfid,
 }
 
 static int mdhim_read(unifyfs_fops_ctx_t* ctx,
-                      int gfid, off_t offset, size_t length)
+                      int64_t gfid, off_t offset, size_t length)
 {
     /* get application client */
     int app_id = ctx->app_id;
@@ -1115,12 +1140,12 @@ static int mdhim_mread(unifyfs_fops_ctx_t* ctx, size_t num_req, void* reqbuf)
     /* get chunks corresponding to requested client read extents */
     int ret;
     int num_keys = 0;
-    int last_gfid = -1;
+    int64_t last_gfid = -1;
     for (i = 0; i < num_req; i++) {
         req = reqs + i;
 
         /* get the file id for this request */
-        int gfid = req->gfid;
+        int64_t gfid = req->gfid;
 
         /* if we have switched to a different file, create chunk reads
          * for the previous file */
@@ -1130,7 +1155,8 @@ static int mdhim_mread(unifyfs_fops_ctx_t* ctx, size_t num_req, void* reqbuf)
                                           app_id, client_id,
                                           num_keys, keys, key_lens);
             if (ret != UNIFYFS_SUCCESS) {
-                LOGERR("Error creating chunk reads for gfid=%d", last_gfid);
+                LOGERR("Error creating chunk reads for gfid=%"
+                       PRId64, last_gfid);
                 rc = ret;
             }
 
@@ -1141,7 +1167,7 @@ static int mdhim_mread(unifyfs_fops_ctx_t* ctx, size_t num_req, void* reqbuf)
         /* get offset and length of current read request */
         size_t off = req->offset;
         size_t len = req->length;
-        LOGDBG("gfid:%d, offset:%zu, length:%zu", gfid, off, len);
+        LOGDBG("gfid:%" PRId64 ", offset:%zu, length:%zu", gfid, off, len);
 
         /* Generate a pair of keys for each read request, representing
          * the start and end offsets. MDHIM returns all key-value pairs that
@@ -1168,7 +1194,7 @@ static int mdhim_mread(unifyfs_fops_ctx_t* ctx, size_t num_req, void* reqbuf)
                                   app_id, client_id,
                                   num_keys, keys, key_lens);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("Error creating chunk reads for gfid=%d", last_gfid);
+        LOGERR("Error creating chunk reads for gfid=%" PRId64, last_gfid);
         rc = ret;
     }
 
@@ -13,7 +13,7 @@
  */
 
 #include "margo_server.h"
-#include "unifyfs_inode_tree.h"
+#include "unifyfs_inode_table.h"
 #include "unifyfs_inode.h"
 #include "unifyfs_group_rpc.h"
 #include "unifyfs_p2p_rpc.h"
@@ -39,7 +39,7 @@ int rpc_init(unifyfs_cfg_t* cfg)
 
 static
 int rpc_metaget(unifyfs_fops_ctx_t* ctx,
-                int gfid,
+                int64_t gfid,
                 unifyfs_file_attr_t* attr)
 {
     return unifyfs_invoke_metaget_rpc(gfid, attr);
@@ -47,7 +47,7 @@ int rpc_metaget(unifyfs_fops_ctx_t* ctx,
 
 static
 int rpc_metaset(unifyfs_fops_ctx_t* ctx,
-                int gfid,
+                int64_t gfid,
                 int attr_op,
                 unifyfs_file_attr_t* attr)
 {
@@ -55,106 +55,229 @@ int rpc_metaset(unifyfs_fops_ctx_t* ctx,
 }
 
 /*
- * sync rpc from client contains extents for a single gfid (file).
+ * add extents from a run of client index entries for a single file,
+ * first to our local inode, then to the owner of the file
  */
 static
-int rpc_fsync(unifyfs_fops_ctx_t* ctx,
-              int gfid)
+int rpc_sync_extents(unifyfs_fops_ctx_t* ctx,
+                     unifyfs_index_t* entries,
+                     size_t num_extents,
+                     struct extent_tree_node* extents)
 {
     size_t i;
+    int ret;
+    int64_t gfid = entries[0].gfid;
+
+    for (i = 0; i < num_extents; i++) {
+        struct extent_tree_node* extent = &extents[i];
+        unifyfs_index_t* meta = &entries[i];
+
+        extent->start = meta->file_pos;
+        extent->end = (meta->file_pos + meta->length) - 1;
+        extent->svr_rank = glb_pmi_rank;
+        extent->app_id = ctx->app_id;
+        extent->cli_id = ctx->client_id;
+        extent->pos = meta->log_pos;
+    }
 
+    /* update local inode state first, at the owner this also revokes
+     * metadata leases if the file size changed */
+    ret = sm_add_extents(gfid, num_extents, extents);
+    if (ret) {
+        LOGERR("failed to add local extents (gfid=%" PRId64 ", ret=%d)",
+               gfid, ret);
+        return ret;
+    }
+
+    /* then update owner inode state */
+    ret = unifyfs_invoke_add_extents_rpc(gfid, num_extents, extents);
+    if (ret) {
+        LOGERR("failed to add extents (gfid=%" PRId64 ", ret=%d)", gfid, ret);
+    }
+
+    return ret;
+}
+
+/*
+ * consume the extents the client has published in its index ring, up to
+ * the ring tail at the time of the call. this is used both for client
+ * sync rpcs (for the given gfid) and for background draining of the ring
+ * (gfid=-1), and consumes extents for any file found in the ring.
+ */
+static
+int rpc_fsync(unifyfs_fops_ctx_t* ctx,
+              int64_t gfid)
+{
     /* assume we'll succeed */
     int ret = UNIFYFS_SUCCESS;
 
-    /* get memory page size on this machine */
-    int page_sz = (int) get_page_size();
-
     /* get application client */
     app_client* client = get_app_client(ctx->app_id, ctx->client_id);
     if (NULL == client) {
         return EINVAL;
     }
 
-    /* get pointer to superblock for this client and app */
-    shm_context* super_ctx = client->shmem_super;
-    if (NULL == super_ctx) {
+    if (NULL == client->shmem_super) {
         LOGERR("missing client superblock");
         return UNIFYFS_FAILURE;
     }
-    char* superblk = (char*)(super_ctx->addr);
-
-    /* get pointer to start of key/value region in superblock */
-    char* meta = superblk + client->super_meta_offset;
 
-    /* get number of file extent index values client has for us,
-     * stored as a size_t value in meta region of shared memory */
-    size_t num_extents = *(size_t*)(meta);
-
-    /* indices are stored in the superblock shared memory
-     * created by the client, these are stored as index_t
-     * structs starting one page size offset into meta region
-     *
-     * Is it safe to assume that the index information in this superblock is
-     * not going to be modified by the client while we perform this operation?
-     */
-    char* ptr_extents = meta + page_sz;
-
-    if (num_extents == 0) {
+    size_t num_pending = app_client_index_pending(client);
+    if (num_pending == 0) {
         return UNIFYFS_SUCCESS;  /* Nothing to do */
     }
 
-    unifyfs_index_t* meta_payload = (unifyfs_index_t*)(ptr_extents);
-
-    struct extent_tree_node* extents = calloc(num_extents, sizeof(*extents));
-    if (NULL == extents) {
+    unifyfs_index_t* entries = calloc(num_pending, sizeof(*entries));
+    struct extent_tree_node* extents = calloc(num_pending, sizeof(*extents));
+    if ((NULL == entries) || (NULL == extents)) {
         LOGERR("failed to allocate memory for local_extents");
+        free(entries);
+        free(extents);
         return ENOMEM;
     }
 
-    /* the sync rpc now contains extents from a single file/gfid */
-    assert(gfid == meta_payload[0].gfid);
+    LOGDBG("consuming %zu index entries (gfid=%" PRId64 ")", num_pending, gfid);
 
-    for (i = 0; i < num_extents; i++) {
-        struct extent_tree_node* extent = &extents[i];
-        unifyfs_index_t* meta = &meta_payload[i];
+    /* the ring holds runs of extents for a single file at a time */
+    size_t num_done = 0;
+    while (num_done < num_pending) {
+        size_t n = app_client_index_next_run(client, entries,
+                                             num_pending - num_done);
+        if (0 == n) {
+            break;
+        }
 
-        extent->start = meta->file_pos;
-        extent->end = (meta->file_pos + meta->length) - 1;
-        extent->svr_rank = glb_pmi_rank;
-        extent->app_id = ctx->app_id;
-        extent->cli_id = ctx->client_id;
-        extent->pos = meta->log_pos;
+        int rc = rpc_sync_extents(ctx, entries, n, extents);
+        if (rc != UNIFYFS_SUCCESS) {
+            ret = rc;
+        }
+
+        /* consume entries even if we failed to add them, the error is
+         * reported to the client instead */
+        app_client_index_consume(client, n);
+        num_done += n;
     }
 
-    /* update local inode state first */
-    ret = unifyfs_inode_add_extents(gfid, num_extents, extents);
-    if (ret) {
-        LOGERR("failed to add local extents (gfid=%d, ret=%d)", gfid, ret);
+    free(entries);
+    free(extents);
+
+    return ret;
+}
+
+/* qsort comparison of chunk read requests by file offset */
+static int compare_chunk_offsets(const void* a, const void* b)
+{
+    const chunk_read_req_t* ca = a;
+    const chunk_read_req_t* cb = b;
+    if (ca->offset < cb->offset) {
+        return -1;
+    } else if (ca->offset > cb->offset) {
+        return 1;
+    }
+    return 0;
+}
+
+static
+int rpc_extent_map(unifyfs_fops_ctx_t* ctx,
+                   int64_t gfid,
+                   size_t offset,
+                   size_t max_ranges,
+                   unifyfs_extent_t* ranges,
+                   size_t* num_ranges)
+{
+    *num_ranges = 0;
+
+    /* the owner, and every server once the file is laminated, has all of
+     * its extents, so walk them from offset until the ranges are full */
+    unifyfs_file_attr_t attrs;
+    int is_owner = (hash_gfid_to_server(gfid) == glb_pmi_rank);
+    if (is_owner || ((unifyfs_inode_metaget(gfid, &attrs) ==
+                      UNIFYFS_SUCCESS) && attrs.is_laminated)) {
+        return unifyfs_inode_map_extents(gfid, offset, max_ranges,
+                                         ranges, num_ranges);
+    }
+
+    size_t filesize = 0;
+    int ret = unifyfs_invoke_filesize_rpc(gfid, &filesize);
+    if (ret != UNIFYFS_SUCCESS) {
         return ret;
     }
+    if (offset >= filesize) {
+        return UNIFYFS_SUCCESS;
+    }
 
-    /* then update owner inode state */
-    ret = unifyfs_invoke_add_extents_rpc(gfid, num_extents, extents);
-    if (ret) {
-        LOGERR("failed to add extents (gfid=%d, ret=%d)", gfid, ret);
+    /* locate the written data from offset to the end of the file, which
+     * leaves out the holes */
+    unifyfs_inode_extent_t extent;
+    extent.gfid = gfid;
+    extent.offset = (unsigned long) offset;
+    extent.length = (unsigned long)(filesize - offset);
+
+    unsigned int n_chunks = 0;
+    chunk_read_req_t* chunks = NULL;
+    ret = unifyfs_invoke_find_extents_rpc(gfid, 1, &extent,
+                                          &n_chunks, &chunks);
+    if (ret != UNIFYFS_SUCCESS) {
+        LOGERR("failed to find extents for gfid=%" PRId64, gfid);
+        return ret;
     }
 
-    free(extents);
+    /* chunks may be grouped by server, so put them in file order and
+     * merge the adjacent ones */
+    qsort(chunks, (size_t) n_chunks, sizeof(*chunks), compare_chunk_offsets);
+    size_t n = 0;
+    for (unsigned int i = 0; i < n_chunks; i++) {
+        chunk_read_req_t* chk = chunks + i;
+        if (0 == chk->nbytes) {
+            continue;
+        }
+        if ((n > 0) &&
+            ((ranges[n - 1].offset + ranges[n - 1].length) == chk->offset)) {
+            ranges[n - 1].length += chk->nbytes;
+            continue;
+        }
+        if (n == max_ranges) {
+            break;
+        }
+        ranges[n].gfid = gfid;
+        ranges[n].offset = chk->offset;
+        ranges[n].length = chk->nbytes;
+        n++;
+    }
+    free(chunks);
 
-    return ret;
+    *num_ranges = n;
+    return UNIFYFS_SUCCESS;
 }
 
 static
 int rpc_filesize(unifyfs_fops_ctx_t* ctx,
-                 int gfid,
+                 int64_t gfid,
                  size_t* filesize)
 {
     return unifyfs_invoke_filesize_rpc(gfid, filesize);
 }
 
+static
+int rpc_stat(unifyfs_fops_ctx_t* ctx,
+             int64_t gfid,
+             unifyfs_file_attr_t* attr,
+             int* cacheable)
+{
+    return unifyfs_invoke_stat_rpc(gfid, attr, cacheable);
+}
+
+static
+int rpc_stat_many(unifyfs_fops_ctx_t* ctx,
+                  size_t n_files,
+                  unifyfs_stat_result_t* results)
+{
+    return unifyfs_invoke_stat_many_rpc(n_files, results);
+}
+
 static
 int rpc_truncate(unifyfs_fops_ctx_t* ctx,
-                 int gfid,
+                 int64_t gfid,
                  off_t len)
 {
     return unifyfs_invoke_truncate_rpc(gfid, len);
@@ -162,20 +285,73 @@ int rpc_truncate(unifyfs_fops_ctx_t* ctx,
 
 static
 int rpc_laminate(unifyfs_fops_ctx_t* ctx,
-                 int gfid)
+                 int64_t gfid)
 {
     return unifyfs_invoke_laminate_rpc(gfid);
 }
 
+static
+int rpc_transfer(unifyfs_fops_ctx_t* ctx,
+                 int64_t gfid,
+                 const char* dst_file)
+{
+    unifyfs_file_attr_t attr = { 0, };
+    int ret = unifyfs_invoke_metaget_rpc(gfid, &attr);
+    if (ret != UNIFYFS_SUCCESS) {
+        return ret;
+    }
+    if (NULL != attr.filename) {
+        free(attr.filename);
+        attr.filename = NULL;
+    }
+    if (!attr.is_laminated) {
+        /* extent locations are only final once the file is laminated */
+        LOGERR("gfid=%" PRId64 " must be laminated for transfer", gfid);
+        return EINVAL;
+    }
+
+    /* create the destination at the final file size, so that any holes
+     * and trailing unwritten bytes read back as zeros */
+    mode_t mode = (attr.mode & 0777) | S_IWUSR;
+    int fd = open(dst_file, O_WRONLY | O_CREAT | O_TRUNC, mode);
+    if (-1 == fd) {
+        ret = errno;
+        LOGERR("failed to create transfer destination %s - %s",
+               dst_file, strerror(ret));
+        return ret;
+    }
+    if (0 != ftruncate(fd, (off_t) attr.size)) {
+        ret = errno;
+        LOGERR("failed to size transfer destination %s - %s",
+               dst_file, strerror(ret));
+    }
+    close(fd);
+    if (ret != UNIFYFS_SUCCESS) {
+        return ret;
+    }
+
+    if (!attr.is_shared) {
+        /* all data of a private file is in the logs of our clients */
+        return sm_transfer(gfid, dst_file);
+    }
+    return unifyfs_invoke_broadcast_transfer(gfid, dst_file);
+}
+
 static
 int rpc_unlink(unifyfs_fops_ctx_t* ctx,
-               int gfid)
+               int64_t gfid)
 {
     int ret = unifyfs_inode_unlink(gfid);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("unlink(gfid=%d) failed", gfid);
+        LOGERR("unlink(gfid=%" PRId64 ") failed", gfid);
     }
-    return unifyfs_invoke_broadcast_unlink(gfid);
+
+    /* local clients may have cached the file metadata */
+    invalidate_client_metadata_caches();
+
+    ret = unifyfs_invoke_broadcast_unlink(gfid);
+    unifyfs_p2p_note_mutation(gfid);
+    return ret;
 }
 
 static
@@ -274,8 +450,11 @@ int submit_read_request(unifyfs_fops_ctx_t* ctx,
         unifyfs_inode_extent_t* ext = extents + extent_ndx;
         unsigned int n_chunks = 0;
         chunk_read_req_t* chunks = NULL;
+        uint64_t start_ns = unifyfs_stats_now_ns();
         int rc = unifyfs_invoke_find_extents_rpc(ext->gfid, 1, ext,
                                                  &n_chunks, &chunks);
+        unifyfs_trace_span(&(ctx->trace), UNIFYFS_TRACE_RM_FIND_EXTENTS,
+                           start_ns);
         if (rc) {
             LOGERR("failed to find extent locations");
             return rc;
@@ -304,9 +483,11 @@ int submit_read_request(unifyfs_fops_ctx_t* ctx,
             rdreq.num_server_reads = (int) n_remote_reads;
             rdreq.remote_reads = remote_reads;
             rdreq.extent = *ext;
+            rdreq.trace = ctx->trace;
+            rdreq.start_ns = start_ns;
             ret = rm_submit_read_request(&rdreq);
         } else {
-            LOGDBG("extent(gfid=%d, offset=%lu, len=%lu) has no data",
+            LOGDBG("extent(gfid=%" PRId64 ", offset=%lu, len=%lu) has no data",
                    ext->gfid, ext->offset, ext->length);
             invoke_client_mread_req_complete_rpc(app_id, client_id,
                                                  client_mread, extent_ndx,
@@ -319,7 +500,7 @@ int submit_read_request(unifyfs_fops_ctx_t* ctx,
 
 static
 int rpc_read(unifyfs_fops_ctx_t* ctx,
-             int gfid,
+             int64_t gfid,
              off_t offset,
              size_t length)
 {
@@ -368,9 +549,13 @@ static struct unifyfs_fops _fops_rpc = {
     .metaget = rpc_metaget,
     .metaset = rpc_metaset,
     .fsync = rpc_fsync,
+    .extent_map = rpc_extent_map,
     .filesize = rpc_filesize,
+    .stat = rpc_stat,
+    .stat_many = rpc_stat_many,
     .truncate = rpc_truncate,
     .laminate = rpc_laminate,
+    .transfer = rpc_transfer,
     .unlink = rpc_unlink,
     .read = rpc_read,
     .mread = rpc_mread,
@@ -34,6 +34,7 @@
 // system headers
 #include <assert.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <pthread.h>
 #include <stdbool.h>
@@ -76,7 +77,7 @@ typedef struct {
 extern server_info_t* glb_servers; /* array of server info structs */
 extern size_t glb_num_servers; /* number of entries in glb_servers array */
 
-extern struct unifyfs_inode_tree* global_inode_tree; /* global inode tree */
+extern struct unifyfs_inode_table* global_inode_table; /* global inode table */
 
 // NEW READ REQUEST STRUCTURES
 typedef enum {
@@ -87,7 +88,7 @@ typedef enum {
 } readreq_status_e;
 
 typedef struct {
-    int gfid;           /* gfid */
+    int64_t gfid;       /* gfid */
     size_t nbytes;      /* size of data chunk */
     size_t offset;      /* file offset */
     size_t log_offset;  /* remote log offset */
@@ -99,14 +100,14 @@ typedef struct {
 #define debug_print_chunk_read_req(reqptr) \
 do { \
     chunk_read_req_t* _req = (reqptr); \
-    LOGDBG("chunk_read_req(%p) - gfid=%d, offset=%zu, nbytes=%zu @ " \
-           "server[%d] log(app=%d, client=%d, offset=%zu)", \
+    LOGDBG("chunk_read_req(%p) - gfid=%" PRId64 ", offset=%zu, " \
+           "nbytes=%zu @ server[%d] log(app=%d, client=%d, offset=%zu)", \
            _req, _req->gfid, _req->offset, _req->nbytes, _req->rank, \
            _req->log_app_id, _req->log_client_id, _req->log_offset); \
 } while (0)
 
 typedef struct {
-    int gfid;         /* gfid */
+    int64_t gfid;     /* gfid */
     size_t offset;    /* file offset */
     size_t nbytes;    /* requested read size */
     ssize_t read_rc;  /* bytes read (or negative error code) */
@@ -124,6 +125,7 @@ typedef struct {
                               * @SM: received requests buffer */
     chunk_read_resp_t* resp; /* @RM: received responses buffer
                               * @SM: allocated responses buffer */
+    unifyfs_trace_ctx_t trace; /* trace context of the client read */
 } server_chunk_reads_t;
 
 // forward declaration of reqmgr_thrd
@@ -148,6 +150,8 @@ typedef struct app_client {
     shm_context* shmem_super; /* shmem context for superblock region */
     size_t super_meta_offset; /* superblock offset to index metadata */
     size_t super_meta_size;   /* size of index metadata region in bytes */
+    size_t super_reqq_offset; /* superblock offset to request queue */
+    size_t super_reqq_size;   /* size of request queue (0 if not used) */
 } app_client;
 
 /**
@@ -187,10 +191,37 @@ unifyfs_rc attach_app_client(app_client* client,
                              const size_t logio_shmem_size,
                              const size_t shmem_super_size,
                              const size_t super_meta_offset,
-                             const size_t super_meta_size);
+                             const size_t super_meta_size,
+                             const size_t super_reqq_offset,
+                             const size_t super_reqq_size);
 
 unifyfs_rc disconnect_app_client(app_client* clnt);
 
+/* Return the number of write index entries the client has published
+ * in its index ring that have not yet been consumed */
+size_t app_client_index_pending(app_client* client);
+
+/* Copy the next unconsumed write index entries from the client's index
+ * ring into entries, stopping at max entries or at the first entry for a
+ * different file than the first one. Returns the number of entries
+ * copied, which is 0 if there are none pending. */
+size_t app_client_index_next_run(app_client* client,
+                                 unifyfs_index_t* entries,
+                                 size_t max);
+
+/* Release count entries at the head of the client's index ring back to
+ * the client */
+void app_client_index_consume(app_client* client,
+                              size_t count);
+
+/* Return the start of the client's shared-memory request queue,
+ * or NULL if the client does not use one */
+void* app_client_request_queue(app_client* client);
+
+/* Increment the metadata epoch of every connected client, which makes
+ * them drop any file metadata they have cached */
+void invalidate_client_metadata_caches(void);
+
 unifyfs_rc cleanup_app_client(app_config* app, app_client* clnt);
 
 
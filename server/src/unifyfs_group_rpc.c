@@ -13,6 +13,7 @@
  */
 
 #include "unifyfs_group_rpc.h"
+#include "unifyfs_stats.h"
 
 
 #ifndef UNIFYFS_BCAST_K_ARY
@@ -203,6 +204,8 @@ static void collective_cleanup(coll_request* coll_req)
 /* Forward the collective request to any children */
 static int collective_forward(coll_request* coll_req)
 {
+    coll_req->start_ns = unifyfs_stats_now_ns();
+
     /* get info for tree */
     int child_count = coll_req->tree.child_count;
     if (0 == child_count) {
@@ -254,6 +257,11 @@ void collective_set_local_retval(coll_request* coll_req, int val)
         lbo->ret = val;
         break;
     }
+    case UNIFYFS_SERVER_BCAST_RPC_TRANSFER: {
+        transfer_bcast_out_t* xbo = (transfer_bcast_out_t*) output;
+        xbo->ret = val;
+        break;
+    }
     case UNIFYFS_SERVER_BCAST_RPC_TRUNCATE: {
         truncate_bcast_out_t* tbo = (truncate_bcast_out_t*) output;
         tbo->ret = val;
@@ -315,6 +323,15 @@ static int coll_get_child_response(coll_request* coll_req,
                 }
                 break;
             }
+            case UNIFYFS_SERVER_BCAST_RPC_TRANSFER: {
+                transfer_bcast_out_t* cxbo = (transfer_bcast_out_t*) out;
+                transfer_bcast_out_t* xbo  = (transfer_bcast_out_t*) output;
+                child_ret = cxbo->ret;
+                if (child_ret != UNIFYFS_SUCCESS) {
+                    xbo->ret = child_ret;
+                }
+                break;
+            }
             case UNIFYFS_SERVER_BCAST_RPC_TRUNCATE: {
                 truncate_bcast_out_t* ctbo = (truncate_bcast_out_t*) out;
                 truncate_bcast_out_t* tbo  = (truncate_bcast_out_t*) output;
@@ -401,6 +418,11 @@ static int collective_finish(coll_request* coll_req)
                coll_req, (int)(coll_req->req_type));
     }
 
+    if (coll_req->start_ns) {
+        unifyfs_stats_record_rpc(UNIFYFS_STATS_RPC_BCAST,
+                                 (int)(coll_req->req_type),
+                                 coll_req->start_ns);
+    }
     collective_cleanup(coll_req);
 
     return ret;
@@ -438,7 +460,19 @@ int invoke_bcast_progress_rpc(coll_request* coll_req)
         if (hret != HG_SUCCESS) {
             LOGERR("failed to forward bcast progress for coll(%p)", coll_req);
             ret = UNIFYFS_ERROR_MARGO;
+        } else {
+            /* result includes failures reported by the children */
+            bcast_progress_out_t out;
+            hret = margo_get_output(handle, &out);
+            if (hret != HG_SUCCESS) {
+                LOGERR("margo_get_output() failed");
+                ret = UNIFYFS_ERROR_MARGO;
+            } else {
+                ret = (int) out.ret;
+                margo_free_output(handle, &out);
+            }
         }
+        margo_destroy(handle);
     }
 
     return ret;
@@ -563,18 +597,18 @@ static void extent_bcast_rpc(hg_handle_t handle)
 DEFINE_MARGO_RPC_HANDLER(extent_bcast_rpc)
 
 /* Execute broadcast tree for extent metadata */
-int unifyfs_invoke_broadcast_extents_rpc(int gfid)
+int unifyfs_invoke_broadcast_extents_rpc(int64_t gfid)
 {
     /* assuming success */
     int ret = UNIFYFS_SUCCESS;
 
-    LOGDBG("BCAST_RPC: starting extents for gfid=%d", gfid);
+    LOGDBG("BCAST_RPC: starting extents for gfid=%" PRId64, gfid);
 
     size_t n_extents;
     struct extent_tree_node* extents;
     ret = unifyfs_inode_get_extents(gfid, &n_extents, &extents);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("failed to get extents for gfid=%d", gfid);
+        LOGERR("failed to get extents for gfid=%" PRId64, gfid);
         return ret;
     }
 
@@ -602,7 +636,7 @@ int unifyfs_invoke_broadcast_extents_rpc(int gfid)
         } else {
             /* set input params */
             in->root        = (int32_t) glb_pmi_rank;
-            in->gfid        = (int32_t) gfid;
+            in->gfid        = gfid;
             in->extents     = extents_bulk;
             in->num_extents = (int32_t) n_extents;
 
@@ -714,7 +748,7 @@ static void laminate_bcast_rpc(hg_handle_t handle)
 DEFINE_MARGO_RPC_HANDLER(laminate_bcast_rpc)
 
 /* Execute broadcast tree for attributes and extent metadata due to laminate */
-int unifyfs_invoke_broadcast_laminate(int gfid)
+int unifyfs_invoke_broadcast_laminate(int64_t gfid)
 {
     /* assuming success */
     int ret = UNIFYFS_SUCCESS;
@@ -723,23 +757,23 @@ int unifyfs_invoke_broadcast_laminate(int gfid)
     unifyfs_file_attr_t attrs;
     ret = unifyfs_inode_metaget(gfid, &attrs);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("failed to get file attributes for gfid=%d", gfid);
+        LOGERR("failed to get file attributes for gfid=%" PRId64, gfid);
         return ret;
     }
 
     if (!attrs.is_shared) {
         /* no need to broadcast for private files */
-        LOGDBG("gfid=%d is private, not broadcasting", gfid);
+        LOGDBG("gfid=%" PRId64 " is private, not broadcasting", gfid);
         return UNIFYFS_SUCCESS;
     }
 
-    LOGDBG("BCAST_RPC: starting laminate for gfid=%d", gfid);
+    LOGDBG("BCAST_RPC: starting laminate for gfid=%" PRId64, gfid);
 
     size_t n_extents;
     struct extent_tree_node* extents;
     ret = unifyfs_inode_get_extents(gfid, &n_extents, &extents);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("failed to get extents for gfid=%d", gfid);
+        LOGERR("failed to get extents for gfid=%" PRId64, gfid);
         return ret;
     }
 
@@ -766,7 +800,7 @@ int unifyfs_invoke_broadcast_laminate(int gfid)
     } else {
         /* set input params */
         in->root        = (int32_t) glb_pmi_rank;
-        in->gfid        = (int32_t) gfid;
+        in->gfid        = gfid;
         in->attr        = attrs;
         in->extents     = extents_bulk;
         in->num_extents = (int32_t) n_extents;
@@ -797,6 +831,125 @@ int unifyfs_invoke_broadcast_laminate(int gfid)
 }
 
 
+/*************************************************************************
+ * Broadcast stage-out of laminated file data
+ *************************************************************************/
+
+/* transfer broadcast rpc handler */
+static void transfer_bcast_rpc(hg_handle_t handle)
+{
+    LOGDBG("BCAST_RPC: transfer handler");
+
+    /* assume we'll succeed */
+    int ret = UNIFYFS_SUCCESS;
+
+    coll_request* coll = NULL;
+    server_rpc_req_t* req = calloc(1, sizeof(*req));
+    transfer_bcast_in_t* in = calloc(1, sizeof(*in));
+    transfer_bcast_out_t* out = calloc(1, sizeof(*out));
+    if ((NULL == req) || (NULL == in) || (NULL == out)) {
+        ret = ENOMEM;
+    } else {
+        /* get input params */
+        hg_return_t hret = margo_get_input(handle, in);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_get_input() failed");
+            ret = UNIFYFS_ERROR_MARGO;
+        } else {
+            hg_id_t op_hgid = unifyfsd_rpc_context->rpcs.transfer_bcast_id;
+            server_rpc_e rpc = UNIFYFS_SERVER_BCAST_RPC_TRANSFER;
+            coll = collective_create(rpc, handle, op_hgid, (int)(in->root),
+                                     (void*)in, (void*)out, sizeof(*out),
+                                     HG_BULK_NULL, HG_BULK_NULL, NULL);
+            if (NULL == coll) {
+                ret = ENOMEM;
+            } else {
+                ret = collective_forward(coll);
+                if (ret == UNIFYFS_SUCCESS) {
+                    req->req_type = rpc;
+                    req->coll = coll;
+                    req->handle = handle;
+                    req->input = (void*) in;
+                    req->bulk_buf = NULL;
+                    req->bulk_sz = 0;
+                    ret = sm_submit_service_request(req);
+                    if (ret != UNIFYFS_SUCCESS) {
+                        LOGERR("failed to submit coll request to svcmgr");
+                    }
+                }
+            }
+        }
+    }
+
+    if (ret != UNIFYFS_SUCCESS) {
+        /* report failure back to caller */
+        transfer_bcast_out_t xbo;
+        xbo.ret = (int32_t)ret;
+        hg_return_t hret = margo_respond(handle, &xbo);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_respond() failed");
+        }
+
+        if (NULL != coll) {
+            collective_cleanup(coll);
+        } else {
+            margo_destroy(handle);
+        }
+    }
+}
+DEFINE_MARGO_RPC_HANDLER(transfer_bcast_rpc)
+
+/* Execute broadcast tree to have each server write the file data held
+ * in its local logs to the destination file */
+int unifyfs_invoke_broadcast_transfer(int64_t gfid,
+                                      const char* dst_file)
+{
+    LOGDBG("BCAST_RPC: starting transfer(dst=%s) for gfid=%" PRId64,
+           dst_file, gfid);
+
+    /* assuming success */
+    int ret = UNIFYFS_SUCCESS;
+
+    coll_request* coll = NULL;
+    transfer_bcast_in_t* in = calloc(1, sizeof(*in));
+    if (NULL == in) {
+        ret = ENOMEM;
+    } else {
+        /* set input params */
+        in->root     = (int32_t) glb_pmi_rank;
+        in->gfid     = gfid;
+        in->dst_file = dst_file;
+
+        hg_id_t op_hgid = unifyfsd_rpc_context->rpcs.transfer_bcast_id;
+        server_rpc_e rpc = UNIFYFS_SERVER_BCAST_RPC_TRANSFER;
+        coll = collective_create(rpc, HG_HANDLE_NULL, op_hgid,
+                                 glb_pmi_rank, (void*)in,
+                                 NULL, sizeof(transfer_bcast_out_t),
+                                 HG_BULK_NULL, HG_BULK_NULL, NULL);
+        if (NULL == coll) {
+            free(in);
+            ret = ENOMEM;
+        } else {
+            /* the children write their data while we write ours */
+            ret = collective_forward(coll);
+            if (ret == UNIFYFS_SUCCESS) {
+                int local_ret = sm_transfer(gfid, dst_file);
+                if (local_ret != UNIFYFS_SUCCESS) {
+                    LOGERR("local transfer(gfid=%" PRId64 ") failed - rc=%d",
+                           gfid, local_ret);
+                }
+
+                /* wait for the rest of the tree to finish */
+                ret = invoke_bcast_progress_rpc(coll);
+                if (ret == UNIFYFS_SUCCESS) {
+                    ret = local_ret;
+                }
+            }
+        }
+    }
+    return ret;
+}
+
 /*************************************************************************
  * Broadcast file truncation
  *************************************************************************/
@@ -866,10 +1019,10 @@ static void truncate_bcast_rpc(hg_handle_t handle)
 DEFINE_MARGO_RPC_HANDLER(truncate_bcast_rpc)
 
 /* Execute broadcast tree for file truncate */
-int unifyfs_invoke_broadcast_truncate(int gfid,
+int unifyfs_invoke_broadcast_truncate(int64_t gfid,
                                       size_t filesize)
 {
-    LOGDBG("BCAST_RPC: starting truncate(filesize=%zu) for gfid=%d",
+    LOGDBG("BCAST_RPC: starting truncate(filesize=%zu) for gfid=%" PRId64,
            filesize, gfid);
 
     /* assuming success */
@@ -972,11 +1125,12 @@ static void fileattr_bcast_rpc(hg_handle_t handle)
 DEFINE_MARGO_RPC_HANDLER(fileattr_bcast_rpc)
 
 /* Execute broadcast tree for file attributes update */
-int unifyfs_invoke_broadcast_fileattr(int gfid,
+int unifyfs_invoke_broadcast_fileattr(int64_t gfid,
                                       int attr_op,
                                       unifyfs_file_attr_t* fattr)
 {
-    LOGDBG("BCAST_RPC: starting metaset(op=%d) for gfid=%d", attr_op, gfid);
+    LOGDBG("BCAST_RPC: starting metaset(op=%d) for gfid=%"
+           PRId64, attr_op, gfid);
 
     /* assuming success */
     int ret = UNIFYFS_SUCCESS;
@@ -988,7 +1142,7 @@ int unifyfs_invoke_broadcast_fileattr(int gfid,
     } else {
         /* get input params */
         in->root   = (int32_t) glb_pmi_rank;
-        in->gfid   = (int32_t) gfid;
+        in->gfid   = gfid;
         in->attrop = (int32_t) attr_op;
         in->attr   = *fattr;
 
@@ -1079,9 +1233,9 @@ static void unlink_bcast_rpc(hg_handle_t handle)
 DEFINE_MARGO_RPC_HANDLER(unlink_bcast_rpc)
 
 /* Execute broadcast tree for file unlink */
-int unifyfs_invoke_broadcast_unlink(int gfid)
+int unifyfs_invoke_broadcast_unlink(int64_t gfid)
 {
-    LOGDBG("BCAST_RPC: starting unlink for gfid=%d", gfid);
+    LOGDBG("BCAST_RPC: starting unlink for gfid=%" PRId64, gfid);
 
     /* assuming success */
     int ret = UNIFYFS_SUCCESS;
@@ -36,6 +36,7 @@ typedef struct {
     hg_bulk_t      bulk_forward;
     margo_request* child_reqs;
     hg_handle_t*   child_hdls;
+    uint64_t       start_ns;     /* when request was forwarded (for stats) */
 } coll_request;
 
 /* set collective output return value to local result value */
@@ -59,7 +60,7 @@ int invoke_bcast_progress_rpc(coll_request* coll_req);
  *
  * @return success|failure
  */
-int unifyfs_invoke_broadcast_extents(int gfid,
+int unifyfs_invoke_broadcast_extents(int64_t gfid,
                                      unsigned int len,
                                      struct extent_tree_node* extents);
 
@@ -72,7 +73,7 @@ int unifyfs_invoke_broadcast_extents(int gfid,
  *
  * @return success|failure
  */
-int unifyfs_invoke_broadcast_fileattr(int gfid,
+int unifyfs_invoke_broadcast_fileattr(int64_t gfid,
                                       int fileop,
                                       unifyfs_file_attr_t* attr);
 
@@ -83,7 +84,20 @@ int unifyfs_invoke_broadcast_fileattr(int gfid,
  *
  * @return success|failure
  */
-int unifyfs_invoke_broadcast_laminate(int gfid);
+int unifyfs_invoke_broadcast_laminate(int64_t gfid);
+
+/**
+ * @brief Have all servers write the data of a laminated file held in
+ *        their local logs to the destination file, and wait for them
+ *        to finish
+ *
+ * @param gfid      target file
+ * @param dst_file  destination file path, which must already exist
+ *
+ * @return success|failure
+ */
+int unifyfs_invoke_broadcast_transfer(int64_t gfid,
+                                      const char* dst_file);
 
 /**
  * @brief Truncate target file at all servers
@@ -93,7 +107,7 @@ int unifyfs_invoke_broadcast_laminate(int gfid);
  *
  * @return success|failure
  */
-int unifyfs_invoke_broadcast_truncate(int gfid,
+int unifyfs_invoke_broadcast_truncate(int64_t gfid,
                                       size_t filesize);
 
 /**
@@ -103,7 +117,7 @@ int unifyfs_invoke_broadcast_truncate(int gfid,
  *
  * @return success|failure
  */
-int unifyfs_invoke_broadcast_unlink(int gfid);
+int unifyfs_invoke_broadcast_unlink(int64_t gfid);
 
 
 #endif // UNIFYFS_GROUP_RPC_H
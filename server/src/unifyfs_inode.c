@@ -17,15 +17,17 @@
 #include <string.h>
 #include <stdlib.h>
 #include <pthread.h>
+#include <time.h>
 
 #include "unifyfs_inode.h"
-#include "unifyfs_inode_tree.h"
+#include "unifyfs_inode_table.h"
 
-struct unifyfs_inode_tree _global_inode_tree;
-struct unifyfs_inode_tree* global_inode_tree = &_global_inode_tree;
+struct unifyfs_inode_table _global_inode_table;
+struct unifyfs_inode_table* global_inode_table = &_global_inode_table;
 
 static inline
-struct unifyfs_inode* unifyfs_inode_alloc(int gfid, unifyfs_file_attr_t* attr)
+struct unifyfs_inode* unifyfs_inode_alloc(int64_t gfid,
+                                          unifyfs_file_attr_t* attr)
 {
     struct unifyfs_inode* ino = calloc(1, sizeof(*ino));
     if (NULL != ino) {
@@ -41,6 +43,9 @@ struct unifyfs_inode* unifyfs_inode_alloc(int gfid, unifyfs_file_attr_t* attr)
         ino->attr = *attr;
         ino->attr.filename = strdup(attr->filename);
 
+        /* zero is never a valid extent version */
+        ino->extent_version = 1;
+
         pthread_rwlock_init(&(ino->rwlock), NULL);
         ABT_mutex_create(&(ino->abt_sync));
     } else {
@@ -50,7 +55,20 @@ struct unifyfs_inode* unifyfs_inode_alloc(int gfid, unifyfs_file_attr_t* attr)
     return ino;
 }
 
-static inline
+/* free all cached owner extent lookups of the inode.
+ * Assumes caller has write lock on inode (or is destroying it). */
+static void unifyfs_inode_extent_cache_clear(struct unifyfs_inode* ino)
+{
+    if (NULL != ino->extent_cache) {
+        for (int i = 0; i < UNIFYFS_INODE_EXTENT_CACHE_SIZE; i++) {
+            free(ino->extent_cache[i].chunks);
+        }
+        free(ino->extent_cache);
+        ino->extent_cache = NULL;
+        ino->extent_cache_next = 0;
+    }
+}
+
 int unifyfs_inode_destroy(struct unifyfs_inode* ino)
 {
     int ret = UNIFYFS_SUCCESS;
@@ -65,6 +83,12 @@ int unifyfs_inode_destroy(struct unifyfs_inode* ino)
             free(ino->extents);
         }
 
+        if (NULL != ino->lease_holders) {
+            free(ino->lease_holders);
+        }
+
+        unifyfs_inode_extent_cache_clear(ino);
+
         pthread_rwlock_destroy(&(ino->rwlock));
         ABT_mutex_free(&(ino->abt_sync));
 
@@ -113,7 +137,30 @@ void unifyfs_inode_unlock(struct unifyfs_inode* ino)
     pthread_rwlock_unlock(&ino->rwlock);
 }
 
-int unifyfs_inode_create(int gfid, unifyfs_file_attr_t* attr)
+/* drop cached owner extent lookups and note that the extents changed.
+ * Assumes caller has write lock on inode. */
+static void unifyfs_inode_extents_changed(struct unifyfs_inode* ino)
+{
+    ino->extent_version++;
+    unifyfs_inode_extent_cache_clear(ino);
+}
+
+/* extents of a laminated file no longer change, so pack them into the
+ * sorted array form of the extent tree for faster lookups.
+ * Assumes caller has write lock on inode. */
+static void unifyfs_inode_freeze_extents(struct unifyfs_inode* ino)
+{
+    if (NULL != ino->extents) {
+        int rc = extent_tree_freeze(ino->extents);
+        if (rc) {
+            /* not fatal, lookups just use the unfrozen tree */
+            LOGWARN("failed to freeze extents of gfid=%" PRId64 " (rc=%d)",
+                    ino->gfid, rc);
+        }
+    }
+}
+
+int unifyfs_inode_create(int64_t gfid, unifyfs_file_attr_t* attr)
 {
     if (NULL == attr) {
         return EINVAL;
@@ -125,11 +172,26 @@ int unifyfs_inode_create(int gfid, unifyfs_file_attr_t* attr)
     }
 
     int ret = UNIFYFS_SUCCESS;
-    unifyfs_inode_tree_wrlock(global_inode_tree);
+    unifyfs_inode_table_wrlock(global_inode_table, gfid);
     {
-        ret = unifyfs_inode_tree_insert(global_inode_tree, ino);
+        ret = unifyfs_inode_table_insert(global_inode_table, ino);
+        if (ret == EEXIST) {
+            /* an inode with this gfid exists, make sure it belongs to
+             * the same path rather than a different path whose hash
+             * happens to match */
+            struct unifyfs_inode* existing =
+                unifyfs_inode_table_search(global_inode_table, gfid);
+            if ((NULL != existing) &&
+                (NULL != existing->attr.filename) &&
+                (NULL != attr->filename) &&
+                (0 != strcmp(existing->attr.filename, attr->filename))) {
+                LOGERR("gfid=%" PRId64 " collision: %s exists, create %s",
+                       gfid, existing->attr.filename, attr->filename);
+                ret = UNIFYFS_ERROR_GFID;
+            }
+        }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     if (ret != UNIFYFS_SUCCESS) {
         unifyfs_inode_destroy(ino);
@@ -138,7 +200,7 @@ int unifyfs_inode_create(int gfid, unifyfs_file_attr_t* attr)
     return ret;
 }
 
-int unifyfs_inode_update_attr(int gfid, int attr_op,
+int unifyfs_inode_update_attr(int64_t gfid, int attr_op,
                               unifyfs_file_attr_t* attr)
 {
     if (NULL == attr) {
@@ -148,23 +210,26 @@ int unifyfs_inode_update_attr(int gfid, int attr_op,
     int ret = UNIFYFS_SUCCESS;
     struct unifyfs_inode* ino = NULL;
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (NULL == ino) {
             ret = ENOENT;
         } else {
             unifyfs_inode_wrlock(ino);
             unifyfs_file_attr_update(attr_op, &ino->attr, attr);
+            if (ino->attr.is_laminated) {
+                unifyfs_inode_freeze_extents(ino);
+            }
             unifyfs_inode_unlock(ino);
         }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     return ret;
 }
 
-int unifyfs_inode_metaset(int gfid, int attr_op,
+int unifyfs_inode_metaset(int64_t gfid, int attr_op,
                           unifyfs_file_attr_t* attr)
 {
     int ret;
@@ -178,39 +243,233 @@ int unifyfs_inode_metaset(int gfid, int attr_op,
     return ret;
 }
 
-int unifyfs_inode_metaget(int gfid, unifyfs_file_attr_t* attr)
+int unifyfs_inode_metaget(int64_t gfid, unifyfs_file_attr_t* attr)
 {
     int ret = UNIFYFS_SUCCESS;
     struct unifyfs_inode* ino = NULL;
 
-    if ((NULL == global_inode_tree) || (NULL == attr)) {
+    if ((NULL == global_inode_table) || (NULL == attr)) {
         return EINVAL;
     }
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (NULL != ino) {
             *attr = ino->attr;
         } else {
             ret = ENOENT;
         }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    return ret;
+}
+
+/* number of lease revocations seen by this server */
+static uint64_t lease_generation; // = 0
+
+/* seconds on a clock that does not jump, for lease timeouts */
+static time_t lease_clock(void)
+{
+    struct timespec tp = {0};
+    clock_gettime(CLOCK_MONOTONIC, &tp);
+    return tp.tv_sec;
+}
+
+int unifyfs_inode_lease_grant(int64_t gfid, int rank, int n_servers,
+                              unifyfs_file_attr_t* attr)
+{
+    int ret = UNIFYFS_SUCCESS;
+    struct unifyfs_inode* ino = NULL;
+
+    if ((NULL == attr) || (rank < 0) || (rank >= n_servers)) {
+        return EINVAL;
+    }
+
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
+    {
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
+        if (NULL == ino) {
+            ret = ENOENT;
+        } else {
+            unifyfs_inode_wrlock(ino);
+            if (NULL == ino->lease_holders) {
+                size_t n_words = ((size_t)n_servers + 63) / 64;
+                ino->lease_holders = calloc(n_words, sizeof(uint64_t));
+            }
+            if (NULL == ino->lease_holders) {
+                ret = ENOMEM;
+            } else {
+                ino->lease_holders[rank / 64] |= (1ULL << (rank % 64));
+            }
+            *attr = ino->attr;
+            unifyfs_inode_unlock(ino);
+        }
+    }
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     return ret;
 }
 
-int unifyfs_inode_unlink(int gfid)
+int unifyfs_inode_lease_take_holders(int64_t gfid, int n_servers,
+                                     int* n_ranks, int** ranks)
 {
     int ret = UNIFYFS_SUCCESS;
     struct unifyfs_inode* ino = NULL;
 
-    unifyfs_inode_tree_wrlock(global_inode_tree);
+    if ((NULL == n_ranks) || (NULL == ranks) || (n_servers <= 0)) {
+        return EINVAL;
+    }
+    *n_ranks = 0;
+    *ranks = NULL;
+
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ret = unifyfs_inode_tree_remove(global_inode_tree, gfid, &ino);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
+        if (NULL == ino) {
+            ret = ENOENT;
+        } else {
+            unifyfs_inode_wrlock(ino);
+            uint64_t* holders = ino->lease_holders;
+            ino->lease_holders = NULL;
+            unifyfs_inode_unlock(ino);
+
+            if (NULL != holders) {
+                size_t n_words = ((size_t)n_servers + 63) / 64;
+                int count = 0;
+                for (size_t i = 0; i < n_words; i++) {
+                    count += __builtin_popcountll(holders[i]);
+                }
+                if (count > 0) {
+                    int* list = calloc((size_t)count, sizeof(int));
+                    if (NULL == list) {
+                        ret = ENOMEM;
+                    } else {
+                        int n = 0;
+                        for (int r = 0; r < n_servers; r++) {
+                            if (holders[r / 64] & (1ULL << (r % 64))) {
+                                list[n++] = r;
+                            }
+                        }
+                        *n_ranks = n;
+                        *ranks = list;
+                    }
+                }
+                free(holders);
+            }
+        }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    return ret;
+}
+
+uint64_t unifyfs_inode_lease_generation(void)
+{
+    return __atomic_load_n(&lease_generation, __ATOMIC_ACQUIRE);
+}
+
+int unifyfs_inode_lease_set(int64_t gfid, unifyfs_file_attr_t* attr,
+                            uint64_t generation)
+{
+    int ret = UNIFYFS_SUCCESS;
+    struct unifyfs_inode* ino = NULL;
+
+    if (NULL == attr) {
+        return EINVAL;
+    }
+
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
+    {
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
+        if (NULL == ino) {
+            ret = ENOENT;
+        } else {
+            /* checking the generation while holding the inode lock means
+             * a concurrent revoke, which bumps the generation before it
+             * takes the lock, either stops us here or drops our lease */
+            unifyfs_inode_wrlock(ino);
+            if (generation != unifyfs_inode_lease_generation()) {
+                ret = ESTALE;
+            } else {
+                ino->lease_attr = *attr;
+                ino->lease_attr.filename = NULL;
+                ino->lease_expire = lease_clock() +
+                                    UNIFYFS_METADATA_LEASE_SECONDS;
+                ino->lease_valid = 1;
+            }
+            unifyfs_inode_unlock(ino);
+        }
+    }
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    return ret;
+}
+
+int unifyfs_inode_lease_get(int64_t gfid, unifyfs_file_attr_t* attr)
+{
+    int ret = UNIFYFS_SUCCESS;
+    struct unifyfs_inode* ino = NULL;
+
+    if (NULL == attr) {
+        return EINVAL;
+    }
+
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
+    {
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
+        if (NULL == ino) {
+            ret = ENOENT;
+        } else {
+            unifyfs_inode_rdlock(ino);
+            if (ino->lease_valid && (lease_clock() < ino->lease_expire)) {
+                *attr = ino->lease_attr;
+                attr->filename = ino->attr.filename;
+            } else {
+                ret = ENOENT;
+            }
+            unifyfs_inode_unlock(ino);
+        }
+    }
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    return ret;
+}
+
+int unifyfs_inode_lease_revoke(int64_t gfid)
+{
+    int ret = UNIFYFS_SUCCESS;
+    struct unifyfs_inode* ino = NULL;
+
+    __atomic_add_fetch(&lease_generation, 1, __ATOMIC_ACQ_REL);
+
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
+    {
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
+        if (NULL == ino) {
+            ret = ENOENT;
+        } else {
+            unifyfs_inode_wrlock(ino);
+            ino->lease_valid = 0;
+            unifyfs_inode_unlock(ino);
+        }
+    }
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    return ret;
+}
+
+int unifyfs_inode_unlink(int64_t gfid)
+{
+    int ret = UNIFYFS_SUCCESS;
+    struct unifyfs_inode* ino = NULL;
+
+    unifyfs_inode_table_wrlock(global_inode_table, gfid);
+    {
+        ret = unifyfs_inode_table_remove(global_inode_table, gfid, &ino);
+    }
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     if (ret == UNIFYFS_SUCCESS) {
         ret = unifyfs_inode_destroy(ino);
@@ -219,58 +478,60 @@ int unifyfs_inode_unlink(int gfid)
     return ret;
 }
 
-int unifyfs_inode_truncate(int gfid, unsigned long size)
+int unifyfs_inode_truncate(int64_t gfid, unsigned long size)
 {
     int ret = UNIFYFS_SUCCESS;
     struct unifyfs_inode* ino = NULL;
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (!ino) {
             ret = ENOENT;
         } else {
             unifyfs_inode_wrlock(ino);
             {
                 if (ino->attr.is_laminated) {
-                    LOGERR("cannot truncate a laminated file (gfid=%d)", gfid);
+                    LOGERR("cannot truncate a laminated file (gfid=%"
+                           PRId64 ")", gfid);
                     ret = EINVAL;
                 } else {
                     ino->attr.size = size;
                     if (NULL != ino->extents) {
                         ret = extent_tree_truncate(ino->extents, size);
                     }
+                    unifyfs_inode_extents_changed(ino);
                 }
             }
             unifyfs_inode_unlock(ino);
         }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     return ret;
 }
 
-int unifyfs_inode_add_extents(int gfid, int num_extents,
+int unifyfs_inode_add_extents(int64_t gfid, int num_extents,
                               struct extent_tree_node* nodes)
 {
     int ret = UNIFYFS_SUCCESS;
-    int i = 0;
     struct unifyfs_inode* ino = NULL;
     struct extent_tree* tree = NULL;
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (!ino) {
             ret = ENOENT;
-            goto out_unlock_tree;
+            goto out_unlock_table;
         }
 
         if (ino->attr.is_laminated) {
-            LOGERR("trying to add extents to a laminated file (gfid=%d)",
+            LOGERR("trying to add extents to a laminated file (gfid=%"
+                   PRId64 ")",
                    gfid);
             ret = EINVAL;
-            goto out_unlock_tree;
+            goto out_unlock_table;
         }
 
         ABT_mutex_lock(ino->abt_sync);
@@ -283,28 +544,24 @@ int unifyfs_inode_add_extents(int gfid, int num_extents,
                 goto out_unlock_inode;
             }
 
-            for (i = 0; i < num_extents; i++) {
-                struct extent_tree_node* current = &nodes[i];
-
-                /* debug output becomes too noisy with this:
-                 * LOGDBG("extent[%4d]: [%lu, %lu] @ server[%d] log(%d:%d:%lu)",
-                 *        i, current->start, current->end, current->svr_rank,
-                 *        current->app_id, current->cli_id, current->pos);
-                 */
-                ret = extent_tree_add(tree, current->start, current->end,
-                                      current->svr_rank, current->app_id,
-                                      current->cli_id, current->pos);
-                if (ret) {
-                    LOGERR("failed to add extent [%lu, %lu] to gfid=%d",
-                           current->start, current->end, gfid);
-                    goto out_unlock_inode;
-                }
+            /* add the whole batch while holding the tree lock once */
+            ret = extent_tree_add_batch(tree, num_extents, nodes);
+            if (ret) {
+                LOGERR("failed to add extents to gfid=%" PRId64, gfid);
+                goto out_unlock_inode;
             }
+            unifyfs_inode_extents_changed(ino);
 
-            /* if the extent tree max offset is greater than the size we
-             * we currently have in the inode attributes, then update the
+            /* adding extents can only grow the file, so if the largest
+             * ending offset of the new extents is beyond the size we
+             * currently have in the inode attributes, then update the
              * inode size */
-            unsigned long extent_sz = extent_tree_max_offset(ino->extents) + 1;
+            unsigned long extent_sz = 0;
+            for (int i = 0; i < num_extents; i++) {
+                if (nodes[i].end + 1 > extent_sz) {
+                    extent_sz = nodes[i].end + 1;
+                }
+            }
             if ((uint64_t)extent_sz > ino->attr.size) {
                 ino->attr.size = extent_sz;
             }
@@ -312,26 +569,27 @@ int unifyfs_inode_add_extents(int gfid, int num_extents,
 out_unlock_inode:
         unifyfs_inode_unlock(ino);
 
-        LOGINFO("added %d extents to inode (gfid=%d, filesize=%" PRIu64 ")",
-               num_extents, gfid, ino->attr.size);
+        LOGINFO("added %d extents to inode (gfid=%" PRId64
+                ", filesize=%" PRIu64 ")",
+                num_extents, gfid, ino->attr.size);
 
         ABT_mutex_unlock(ino->abt_sync);
     }
-out_unlock_tree:
-    unifyfs_inode_tree_unlock(global_inode_tree);
+out_unlock_table:
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     return ret;
 }
 
-int unifyfs_inode_get_filesize(int gfid, size_t* outsize)
+int unifyfs_inode_get_filesize(int64_t gfid, size_t* outsize)
 {
     int ret = UNIFYFS_SUCCESS;
     size_t filesize = 0;
     struct unifyfs_inode* ino = NULL;
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (!ino) {
             ret = ENOENT;
         } else {
@@ -344,38 +602,39 @@ int unifyfs_inode_get_filesize(int gfid, size_t* outsize)
             unifyfs_inode_unlock(ino);
 
             *outsize = filesize;
-            LOGDBG("local file size (gfid=%d): %lu", gfid, filesize);
+            LOGDBG("local file size (gfid=%" PRId64 "): %lu", gfid, filesize);
         }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     return ret;
 }
 
-int unifyfs_inode_laminate(int gfid)
+int unifyfs_inode_laminate(int64_t gfid)
 {
     int ret = UNIFYFS_SUCCESS;
     struct unifyfs_inode* ino = NULL;
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (!ino) {
             ret = ENOENT;
         } else {
             unifyfs_inode_wrlock(ino);
             ino->attr.is_laminated = 1;
+            unifyfs_inode_freeze_extents(ino);
             unifyfs_inode_unlock(ino);
 
-            LOGDBG("file laminated (gfid=%d)", gfid);
+            LOGDBG("file laminated (gfid=%" PRId64 ")", gfid);
         }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     return ret;
 }
 
-int unifyfs_inode_get_extents(int gfid, size_t* n,
+int unifyfs_inode_get_extents(int64_t gfid, size_t* n,
                               struct extent_tree_node** nodes)
 {
     int ret = UNIFYFS_SUCCESS;
@@ -385,9 +644,9 @@ int unifyfs_inode_get_extents(int gfid, size_t* n,
         return EINVAL;
     }
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (!ino) {
             ret = ENOENT;
         } else {
@@ -415,7 +674,166 @@ int unifyfs_inode_get_extents(int gfid, size_t* n,
             unifyfs_inode_unlock(ino);
         }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    return ret;
+}
+
+int unifyfs_inode_get_extent_version(int64_t gfid, uint64_t* version)
+{
+    int ret = UNIFYFS_SUCCESS;
+    struct unifyfs_inode* ino = NULL;
+
+    if (NULL == version) {
+        return EINVAL;
+    }
+
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
+    {
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
+        if (NULL == ino) {
+            ret = ENOENT;
+        } else {
+            unifyfs_inode_rdlock(ino);
+            *version = ino->extent_version;
+            unifyfs_inode_unlock(ino);
+        }
+    }
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    return ret;
+}
+
+/* return the cache entry for the extent, or NULL if none.
+ * Assumes caller has lock on inode. */
+static unifyfs_extent_cache_entry_t* extent_cache_find(
+    struct unifyfs_inode* ino,
+    unifyfs_inode_extent_t* extent)
+{
+    if (NULL == ino->extent_cache) {
+        return NULL;
+    }
+    for (int i = 0; i < UNIFYFS_INODE_EXTENT_CACHE_SIZE; i++) {
+        unifyfs_extent_cache_entry_t* entry = ino->extent_cache + i;
+        if ((entry->version != 0) &&
+            (entry->offset == extent->offset) &&
+            (entry->length == extent->length)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+int unifyfs_inode_extent_cache_lookup(unifyfs_inode_extent_t* extent,
+                                      uint64_t* version,
+                                      unsigned int* n_chunks,
+                                      chunk_read_req_t** chunks)
+{
+    int ret = UNIFYFS_SUCCESS;
+    struct unifyfs_inode* ino = NULL;
+
+    if ((NULL == extent) || (NULL == version) ||
+        (NULL == n_chunks) || (NULL == chunks)) {
+        return EINVAL;
+    }
+    *n_chunks = 0;
+    *chunks = NULL;
+
+    int64_t gfid = extent->gfid;
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
+    {
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
+        if (NULL == ino) {
+            ret = ENOENT;
+        } else {
+            unifyfs_inode_rdlock(ino);
+            unifyfs_extent_cache_entry_t* entry =
+                extent_cache_find(ino, extent);
+            if (NULL == entry) {
+                ret = ENOENT;
+            } else {
+                *version = entry->version;
+                if (entry->n_chunks > 0) {
+                    size_t sz = entry->n_chunks * sizeof(chunk_read_req_t);
+                    *chunks = malloc(sz);
+                    if (NULL == *chunks) {
+                        ret = ENOMEM;
+                    } else {
+                        memcpy(*chunks, entry->chunks, sz);
+                        *n_chunks = entry->n_chunks;
+                    }
+                }
+            }
+            unifyfs_inode_unlock(ino);
+        }
+    }
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    return ret;
+}
+
+int unifyfs_inode_extent_cache_store(unifyfs_inode_extent_t* extent,
+                                     uint64_t version,
+                                     unsigned int n_chunks,
+                                     chunk_read_req_t* chunks)
+{
+    int ret = UNIFYFS_SUCCESS;
+    struct unifyfs_inode* ino = NULL;
+
+    if ((NULL == extent) || (0 == version) ||
+        ((n_chunks > 0) && (NULL == chunks))) {
+        return EINVAL;
+    }
+
+    chunk_read_req_t* copy = NULL;
+    if (n_chunks > 0) {
+        size_t sz = n_chunks * sizeof(chunk_read_req_t);
+        copy = malloc(sz);
+        if (NULL == copy) {
+            return ENOMEM;
+        }
+        memcpy(copy, chunks, sz);
+    }
+
+    int64_t gfid = extent->gfid;
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
+    {
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
+        if (NULL == ino) {
+            ret = ENOENT;
+        } else {
+            unifyfs_inode_wrlock(ino);
+            if (NULL == ino->extent_cache) {
+                ino->extent_cache = calloc(UNIFYFS_INODE_EXTENT_CACHE_SIZE,
+                                           sizeof(*(ino->extent_cache)));
+            }
+            if (NULL == ino->extent_cache) {
+                ret = ENOMEM;
+            } else {
+                /* reuse the entry for this extent, or replace the
+                 * entries in round-robin order */
+                unifyfs_extent_cache_entry_t* entry =
+                    extent_cache_find(ino, extent);
+                if (NULL == entry) {
+                    unsigned int ndx = ino->extent_cache_next;
+                    ino->extent_cache_next =
+                        (ndx + 1) % UNIFYFS_INODE_EXTENT_CACHE_SIZE;
+                    entry = ino->extent_cache + ndx;
+                }
+                free(entry->chunks);
+                entry->offset   = extent->offset;
+                entry->length   = extent->length;
+                entry->version  = version;
+                entry->n_chunks = n_chunks;
+                entry->chunks   = copy;
+                copy = NULL;
+            }
+            unifyfs_inode_unlock(ino);
+        }
+    }
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    free(copy);
 
     return ret;
 }
@@ -423,37 +841,59 @@ int unifyfs_inode_get_extents(int gfid, size_t* n,
 int unifyfs_inode_get_extent_chunks(unifyfs_inode_extent_t* extent,
                                     unsigned int* n_chunks,
                                     chunk_read_req_t** chunks)
+{
+    return unifyfs_inode_get_extent_chunks_many(1, extent, n_chunks, chunks);
+}
+
+int unifyfs_inode_get_extent_chunks_many(unsigned int n_extents,
+                                         unifyfs_inode_extent_t* extents,
+                                         unsigned int* n_chunks,
+                                         chunk_read_req_t** chunks)
 {
     int ret = UNIFYFS_SUCCESS;
     struct unifyfs_inode* ino = NULL;
-    int gfid = extent->gfid;
+    int64_t gfid = extents[0].gfid;
+
+    *n_chunks = 0;
+    *chunks = NULL;
+
+    struct extent_tree_range* ranges = calloc(n_extents, sizeof(*ranges));
+    if (NULL == ranges) {
+        return ENOMEM;
+    }
+    for (unsigned int i = 0; i < n_extents; i++) {
+        assert(extents[i].gfid == gfid);
+        ranges[i].offset = extents[i].offset;
+        ranges[i].len    = extents[i].length;
+    }
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (!ino) {
             ret = ENOENT;
         } else {
             unifyfs_inode_rdlock(ino);
             {
                 if (NULL != ino->extents) {
-                    unsigned long offset = extent->offset;
-                    unsigned long len = extent->length;
-                    ret = extent_tree_get_chunk_list(ino->extents, offset, len,
-                                                     n_chunks, chunks);
+                    ret = extent_tree_get_chunk_lists(ino->extents,
+                                                      n_extents, ranges,
+                                                      n_chunks, chunks);
                     if (ret) {
-                        LOGERR("failed to get chunks for gfid:%d, ret=%d",
-                               gfid, ret);
+                        LOGERR("failed to get chunks for gfid:%" PRId64
+                               ", ret=%d", gfid, ret);
                     }
                 }
             }
             unifyfs_inode_unlock(ino);
         }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    free(ranges);
 
     if (ret == UNIFYFS_SUCCESS) {
-        /* extent_tree_get_chunk_list does not populate the gfid field */
+        /* extent_tree_get_chunk_lists does not populate the gfid field */
         for (unsigned int i = 0; i < *n_chunks; i++) {
             (*chunks)[i].gfid = gfid;
         }
@@ -494,6 +934,7 @@ int unifyfs_inode_resolve_extent_chunks(unsigned int n_extents,
     int ret = UNIFYFS_SUCCESS;
     unsigned int i = 0;
     unsigned int j = 0;
+    unsigned int n_runs = 0;
     unsigned int n_chunks = 0;
     chunk_read_req_t* chunks = NULL;
     unsigned int* n_resolved = NULL;
@@ -509,23 +950,33 @@ int unifyfs_inode_resolve_extent_chunks(unsigned int n_extents,
     n_resolved = (unsigned int*) buf;
     resolved = (chunk_read_req_t**) &n_resolved[n_extents];
 
-    /* resolve chunks addresses for all requests from inode tree */
-    for (i = 0; i < n_extents; i++) {
+    /* resolve chunks addresses for all requests from inode table,
+     * looking up each run of consecutive requests for the same file
+     * together */
+    for (i = 0; i < n_extents; i = j) {
         unifyfs_inode_extent_t* current = &extents[i];
+        for (j = i + 1; j < n_extents; j++) {
+            if (extents[j].gfid != current->gfid) {
+                break;
+            }
+        }
 
-        LOGDBG("resolving extent request [gfid=%d, offset=%lu, length=%lu]",
+        LOGDBG("resolving %u extent requests [gfid=%" PRId64 ", offset=%lu, "
+               "length=%lu, ...]", (j - i),
                current->gfid, current->offset, current->length);
 
-        ret = unifyfs_inode_get_extent_chunks(current,
-                                              &n_resolved[i], &resolved[i]);
+        ret = unifyfs_inode_get_extent_chunks_many((j - i), current,
+                                                   &n_resolved[n_runs],
+                                                   &resolved[n_runs]);
         if (ret) {
-            LOGERR("failed to resolve extent request "
-                   "[gfid=%d, offset=%lu, length=%lu] (ret=%d)",
+            LOGERR("failed to resolve extent requests "
+                   "[gfid=%" PRId64 ", offset=%lu, length=%lu, ...] (ret=%d)",
                    current->gfid, current->offset, current->length, ret);
             goto out_fail;
         }
 
-        n_chunks += n_resolved[i];
+        n_chunks += n_resolved[n_runs];
+        n_runs++;
     }
 
     LOGDBG("resolved %d chunks for read request", n_chunks);
@@ -539,7 +990,7 @@ int unifyfs_inode_resolve_extent_chunks(unsigned int n_extents,
         }
 
         chunk_read_req_t* pos = chunks;
-        for (i = 0; i < n_extents; i++) {
+        for (i = 0; i < n_runs; i++) {
             chunk_read_req_t* ext_chunks = resolved[i];
             for (j = 0; j < n_resolved[i]; j++) {
                 /* debug_print_chunk_read_req(ext_chunks + j); */
@@ -580,7 +1031,7 @@ out_fail:
 }
 
 int unifyfs_inode_span_extents(
-    int gfid,                      /* global file id we're looking in */
+    int64_t gfid,                  /* global file id we're looking in */
     unsigned long start,           /* starting logical offset */
     unsigned long end,             /* ending logical offset */
     int max,                       /* maximum number of key/vals to return */
@@ -591,9 +1042,9 @@ int unifyfs_inode_span_extents(
     int ret = UNIFYFS_SUCCESS;
     struct unifyfs_inode* ino = NULL;
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (!ino) {
             ret = ENOENT;
         } else {
@@ -602,7 +1053,7 @@ int unifyfs_inode_span_extents(
                 ret = extent_tree_span(ino->extents, gfid, start, end,
                                        max, keys, vals, outnum);
                 if (ret) {
-                    LOGERR("extent_tree_span failed (gfid=%d, ret=%d)",
+                    LOGERR("extent_tree_span failed (gfid=%" PRId64 ", ret=%d)",
                            gfid, ret);
                 }
             }
@@ -610,34 +1061,123 @@ int unifyfs_inode_span_extents(
         }
 
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     return ret;
 }
 
-int unifyfs_inode_dump(int gfid)
+int unifyfs_inode_map_extents(int64_t gfid,
+                              size_t offset,
+                              size_t max_ranges,
+                              unifyfs_extent_t* ranges,
+                              size_t* num_ranges)
+{
+    int ret = UNIFYFS_SUCCESS;
+    struct unifyfs_inode* ino = NULL;
+
+    if ((NULL == ranges) || (NULL == num_ranges)) {
+        return EINVAL;
+    }
+    *num_ranges = 0;
+
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
+    {
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
+        if (!ino) {
+            ret = ENOENT;
+        } else {
+            unifyfs_inode_rdlock(ino);
+            {
+                /* start at the first extent that ends at or after offset,
+                 * and stop once max_ranges ranges are full, merging
+                 * extents that are adjacent in the file */
+                size_t n = 0;
+                struct extent_tree* tree = ino->extents;
+                struct extent_tree_node* node =
+                    extent_tree_find(tree, (unsigned long) offset, ULONG_MAX);
+                while (NULL != node) {
+                    size_t start = (size_t) node->start;
+                    if (start < offset) {
+                        start = offset;
+                    }
+                    size_t length = (size_t)(node->end + 1) - start;
+                    if ((n > 0) &&
+                        ((ranges[n - 1].offset + ranges[n - 1].length) ==
+                         start)) {
+                        ranges[n - 1].length += length;
+                    } else if (n == max_ranges) {
+                        break;
+                    } else {
+                        ranges[n].gfid = gfid;
+                        ranges[n].offset = start;
+                        ranges[n].length = length;
+                        n++;
+                    }
+                    node = extent_tree_iter(tree, node);
+                }
+                *num_ranges = n;
+            }
+            unifyfs_inode_unlock(ino);
+        }
+    }
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
+
+    return ret;
+}
+
+static void add_inode_extent_mem_stats(struct unifyfs_inode* ino, void* arg)
+{
+    slab_cache_stats_t* total = (slab_cache_stats_t*) arg;
+    slab_cache_stats_t stats;
+
+    unifyfs_inode_rdlock(ino);
+    if (NULL != ino->extents) {
+        extent_tree_mem_stats(ino->extents, &stats);
+        slab_cache_stats_add(total, &stats);
+    }
+    unifyfs_inode_unlock(ino);
+}
+
+int unifyfs_inode_extents_mem_stats(slab_cache_stats_t* stats)
+{
+    if (NULL == stats) {
+        return EINVAL;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    unifyfs_inode_table_foreach(global_inode_table,
+                                add_inode_extent_mem_stats, stats);
+
+    return UNIFYFS_SUCCESS;
+}
+
+int unifyfs_inode_dump(int64_t gfid)
 {
     int ret = UNIFYFS_SUCCESS;
     struct unifyfs_inode* ino = NULL;
 
-    unifyfs_inode_tree_rdlock(global_inode_tree);
+    unifyfs_inode_table_rdlock(global_inode_table, gfid);
     {
-        ino = unifyfs_inode_tree_search(global_inode_tree, gfid);
+        ino = unifyfs_inode_table_search(global_inode_table, gfid);
         if (!ino) {
             ret = ENOENT;
         } else {
             unifyfs_inode_rdlock(ino);
             {
-                LOGDBG("== inode (gfid=%d) ==\n", ino->gfid);
+                LOGDBG("== inode (gfid=%" PRId64 ") ==\n", ino->gfid);
                 if (NULL != ino->extents) {
-                    LOGDBG("extents:");
+                    slab_cache_stats_t mem;
+                    extent_tree_mem_stats(ino->extents, &mem);
+                    LOGDBG("extents: %lu nodes, %zu of %zu bytes used",
+                           ino->extents->count, mem.bytes_used,
+                           mem.bytes_reserved);
                     extent_tree_dump(ino->extents);
                 }
             }
             unifyfs_inode_unlock(ino);
         }
     }
-    unifyfs_inode_tree_unlock(global_inode_tree);
+    unifyfs_inode_table_unlock(global_inode_table, gfid);
 
     return ret;
 }
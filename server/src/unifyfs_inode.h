@@ -22,37 +22,63 @@
  * @brief file extent descriptor
  */
 struct unifyfs_inode_extent {
-    int gfid;
+    int64_t gfid;
     unsigned long offset;
     unsigned long length;
 };
 typedef struct unifyfs_inode_extent unifyfs_inode_extent_t;
 
+/* number of remote extent lookups cached per inode */
+#ifndef UNIFYFS_INODE_EXTENT_CACHE_SIZE
+# define UNIFYFS_INODE_EXTENT_CACHE_SIZE 16
+#endif
+
+/**
+ * @brief result of an extent lookup at the owner of a file, kept at other
+ * servers so that reads of the same extent by other clients can reuse it
+ * while the owner's extent version is unchanged
+ */
+typedef struct {
+    unsigned long offset;     /* offset of looked up extent */
+    unsigned long length;     /* length of looked up extent */
+    uint64_t version;         /* owner extent version of the result */
+    unsigned int n_chunks;    /* number of chunk locations */
+    chunk_read_req_t* chunks; /* chunk locations */
+} unifyfs_extent_cache_entry_t;
+
 /**
  * @brief file and directory inode structure. this holds:
  */
 struct unifyfs_inode {
-    /* tree entry for global inode tree */
-    RB_ENTRY(unifyfs_inode) inode_tree_entry;
-
-    int gfid;                     /* global file identifier */
+    int64_t gfid;                 /* global file identifier */
     unifyfs_file_attr_t attr;     /* file attributes */
     struct extent_tree* extents;  /* extent information */
 
+    /* metadata leases (see unifyfs_inode_lease_*() functions) */
+    uint64_t* lease_holders;      /* owner: bitmap of server ranks */
+    int lease_valid;              /* holder: lease_attr can be used */
+    time_t lease_expire;          /* holder: lease safety timeout */
+    unifyfs_file_attr_t lease_attr; /* holder: owner attributes */
+
+    /* extent versions (see unifyfs_inode_extent_cache_*() functions) */
+    uint64_t extent_version;      /* bumped whenever extents change */
+    unifyfs_extent_cache_entry_t* extent_cache; /* cached owner lookups */
+    unsigned int extent_cache_next; /* next cache entry to replace */
+
     pthread_rwlock_t rwlock;      /* rwlock for pthread access */
     ABT_mutex abt_sync;           /* mutex for argobots ULT access */
 };
 
 /**
  * @brief create a new inode with given parameters. The newly created inode
- * will be inserted to the global inode tree (global_inode_tree).
+ * will be inserted to the global inode table (global_inode_table).
  *
  * @param gfid global file identifier.
  * @param attr attributes of the new file.
  *
  * @return 0 on success, errno otherwise
  */
-int unifyfs_inode_create(int gfid, unifyfs_file_attr_t* attr);
+int unifyfs_inode_create(int64_t gfid, unifyfs_file_attr_t* attr);
 
 /**
  * @brief update the attributes of file with @gfid. The attributes are
@@ -64,7 +90,7 @@ int unifyfs_inode_create(int gfid, unifyfs_file_attr_t* attr);
  *
  * @return 0 on success, errno otherwise
  */
-int unifyfs_inode_update_attr(int gfid, int attr_op,
+int unifyfs_inode_update_attr(int64_t gfid, int attr_op,
                               unifyfs_file_attr_t* attr);
 
 /**
@@ -77,7 +103,7 @@ int unifyfs_inode_update_attr(int gfid, int attr_op,
  * @return 0 on success, errno otherwise
  */
 
-int unifyfs_inode_metaset(int gfid, int attr_op,
+int unifyfs_inode_metaset(int64_t gfid, int attr_op,
                           unifyfs_file_attr_t* attr);
 
 /**
@@ -89,17 +115,99 @@ int unifyfs_inode_metaset(int gfid, int attr_op,
  *
  * @return 0 on success, errno otherwise
  */
-int unifyfs_inode_metaget(int gfid, unifyfs_file_attr_t* attr);
+int unifyfs_inode_metaget(int64_t gfid, unifyfs_file_attr_t* attr);
+
+/**
+ * @brief at the owner of file with @gfid, read its attributes and record
+ * that server @rank holds a lease on them. Both are done under the inode
+ * lock, so any later change to the attributes sees the new holder.
+ *
+ * @param      gfid       global file identifier
+ * @param      rank       server rank to grant the lease to
+ * @param      n_servers  number of servers
+ * @param[out] attr       output file attributes
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_lease_grant(int64_t gfid, int rank, int n_servers,
+                              unifyfs_file_attr_t* attr);
+
+/**
+ * @brief at the owner of file with @gfid, return the server ranks holding
+ * a lease on its attributes and forget them.
+ *
+ * @param      gfid       global file identifier
+ * @param      n_servers  number of servers, as given when granting
+ * @param[out] n_ranks    number of lease holders
+ * @param[out] ranks      array of lease holder ranks, caller should free
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_lease_take_holders(int64_t gfid, int n_servers,
+                                     int* n_ranks, int** ranks);
+
+/**
+ * @brief return the current lease generation, which is incremented each
+ * time a lease is revoked at this server. Take it before asking the owner
+ * for a lease, and pass it to unifyfs_inode_lease_set().
+ */
+uint64_t unifyfs_inode_lease_generation(void);
+
+/**
+ * @brief at a lease holder, store the owner's attributes of file with
+ * @gfid for use until the lease is revoked or times out. The lease is not
+ * stored if any lease was revoked since @generation was taken, as the
+ * revocation may have been meant for it.
+ *
+ * @param gfid        global file identifier
+ * @param attr        owner's file attributes
+ * @param generation  lease generation taken before the owner request
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_lease_set(int64_t gfid, unifyfs_file_attr_t* attr,
+                            uint64_t generation);
+
+/**
+ * @brief at a lease holder, read the leased attributes of file with
+ * @gfid. The filename is that of the local inode.
+ *
+ * @param      gfid  global file identifier
+ * @param[out] attr  output file attributes
+ *
+ * @return 0 on success, ENOENT if there is no valid lease
+ */
+int unifyfs_inode_lease_get(int64_t gfid, unifyfs_file_attr_t* attr);
+
+/**
+ * @brief at a lease holder, drop the lease on file with @gfid, and make
+ * any lease grant still on its way from the owner ineffective.
+ *
+ * @param gfid  global file identifier
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_lease_revoke(int64_t gfid);
 
 /**
  * @brief unlink file with @gfid. this will remove the target file inode from
- * the global inode tree.
+ * the global inode table.
  *
  * @param gfid  global file identifier
  *
  * @return 0 on success, errno otherwise
  */
-int unifyfs_inode_unlink(int gfid);
+int unifyfs_inode_unlink(int64_t gfid);
+
+/**
+ * @brief release all resources of an inode. the inode must already have
+ * been removed from the global inode table.
+ *
+ * @param ino  inode structure to free
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_destroy(struct unifyfs_inode* ino);
 
 /**
  * @brief truncate size of file with @gfid to @size.
@@ -109,7 +217,7 @@ int unifyfs_inode_unlink(int gfid);
  *
  * @return 0 on success, errno otherwise
  */
-int unifyfs_inode_truncate(int gfid, unsigned long size);
+int unifyfs_inode_truncate(int64_t gfid, unsigned long size);
 
 /**
  * @brief get the local extent array from the target inode
@@ -120,7 +228,7 @@ int unifyfs_inode_truncate(int gfid, unsigned long size);
  *
  * @return 0 on success, errno otherwise
  */
-int unifyfs_inode_get_extents(int gfid, size_t* n,
+int unifyfs_inode_get_extents(int64_t gfid, size_t* n,
                               struct extent_tree_node** nodes);
 
 /**
@@ -132,7 +240,8 @@ int unifyfs_inode_get_extents(int gfid, size_t* n,
  *
  * @return
  */
-int unifyfs_inode_add_extents(int gfid, int n, struct extent_tree_node* nodes);
+int unifyfs_inode_add_extents(int64_t gfid, int n,
+                              struct extent_tree_node* nodes);
 
 /**
  * @brief get the maximum file size from the local extent tree of given file
@@ -143,7 +252,7 @@ int unifyfs_inode_add_extents(int gfid, int n, struct extent_tree_node* nodes);
  *
  * @return 0 on success, errno otherwise
  */
-int unifyfs_inode_get_filesize(int gfid, size_t* outsize);
+int unifyfs_inode_get_filesize(int64_t gfid, size_t* outsize);
 
 /**
  * @brief set the given file as laminated
@@ -152,7 +261,49 @@ int unifyfs_inode_get_filesize(int gfid, size_t* outsize);
  *
  * @return 0 on success, errno otherwise
  */
-int unifyfs_inode_laminate(int gfid);
+int unifyfs_inode_laminate(int64_t gfid);
+
+/**
+ * @brief get the extent version of file with @gfid, which changes
+ * whenever extents are added or the file is truncated
+ *
+ * @param      gfid     global file identifier
+ * @param[out] version  current extent version
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_get_extent_version(int64_t gfid, uint64_t* version);
+
+/**
+ * @brief look for a cached owner lookup of @extent
+ *
+ * @param      extent    target file extent
+ * @param[out] version   owner extent version of the cached result
+ * @param[out] n_chunks  number of chunk locations
+ * @param[out] chunks    copy of chunk locations, caller should free
+ *
+ * @return 0 on success, ENOENT if not cached, errno otherwise
+ */
+int unifyfs_inode_extent_cache_lookup(unifyfs_inode_extent_t* extent,
+                                      uint64_t* version,
+                                      unsigned int* n_chunks,
+                                      chunk_read_req_t** chunks);
+
+/**
+ * @brief cache a copy of the result of an owner lookup of @extent,
+ * replacing any cached result for it
+ *
+ * @param extent    target file extent
+ * @param version   owner extent version of the result
+ * @param n_chunks  number of chunk locations
+ * @param chunks    chunk locations
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_extent_cache_store(unifyfs_inode_extent_t* extent,
+                                     uint64_t version,
+                                     unsigned int n_chunks,
+                                     chunk_read_req_t* chunks);
 
 /**
  * @brief Get chunks for given file extent
@@ -168,6 +319,23 @@ int unifyfs_inode_get_extent_chunks(unifyfs_inode_extent_t* extent,
                                     unsigned int* n_chunks,
                                     chunk_read_req_t** chunks);
 
+/**
+ * @brief Get chunks for an array of extents of the same file, with a
+ * single lookup of the file's inode and extent tree
+ *
+ * @param n_extents  number of input extents
+ * @param extents    array of extents, all with the same gfid
+ *
+ * @param[out] n_chunks  number of output chunk locations
+ * @param[out] chunks    array of output chunk locations, in extent order
+ *
+ * @return UNIFYFS_SUCCESS, or error code
+ */
+int unifyfs_inode_get_extent_chunks_many(unsigned int n_extents,
+                                         unifyfs_inode_extent_t* extents,
+                                         unsigned int* n_chunks,
+                                         chunk_read_req_t** chunks);
+
 /**
  * @brief Get chunk locations for an array of file extents
  *
@@ -203,7 +371,7 @@ int unifyfs_inode_resolve_extent_chunks(unsigned int n_extents,
  *
  * @return
  */
-int unifyfs_inode_span_extents(int gfid,
+int unifyfs_inode_span_extents(int64_t gfid,
                                unsigned long start,
                                unsigned long end,
                                int max,
@@ -211,6 +379,34 @@ int unifyfs_inode_span_extents(int gfid,
                                void* vals,
                                int* outnum);
 
+/**
+ * @brief get the written ranges of the file from offset onward, walking
+ * the extent tree and stopping once max_ranges ranges are filled.
+ * Adjacent extents are merged into a single range.
+ *
+ * @param      gfid        global file id
+ * @param      offset      logical offset to start from
+ * @param      max_ranges  capacity of ranges
+ * @param[out] ranges      array to fill with the written ranges
+ * @param[out] num_ranges  number of ranges filled
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_map_extents(int64_t gfid,
+                              size_t offset,
+                              size_t max_ranges,
+                              unifyfs_extent_t* ranges,
+                              size_t* num_ranges);
+
+/**
+ * @brief get memory usage of the extent tree nodes of all inodes
+ *
+ * @param[out] stats  accumulated extent node allocator statistics
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_extents_mem_stats(slab_cache_stats_t* stats);
+
 /**
  * @brief prints the inode information to the log stream
  *
@@ -218,7 +414,7 @@ int unifyfs_inode_span_extents(int gfid,
  *
  * @return 0 on success, errno otherwise
  */
-int unifyfs_inode_dump(int gfid);
+int unifyfs_inode_dump(int64_t gfid);
 
 #endif /* __UNIFYFS_INODE_H */
 
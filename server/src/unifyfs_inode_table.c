@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2020, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2020, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+#include "unifyfs_inode_table.h"
+
+/* starting slot for gfid in a shard with given capacity */
+static inline
+size_t shard_home_slot(struct unifyfs_inode_table_shard* shard, int64_t gfid)
+{
+    return (size_t)unifyfs_inode_table_hash(gfid) & (shard->capacity - 1);
+}
+
+/* allocate the slot array for a shard with given capacity */
+static int shard_init(struct unifyfs_inode_table_shard* shard,
+                      size_t capacity)
+{
+    memset(shard, 0, sizeof(*shard));
+    shard->slots = calloc(capacity, sizeof(*(shard->slots)));
+    if (NULL == shard->slots) {
+        return ENOMEM;
+    }
+    shard->capacity = capacity;
+    pthread_rwlock_init(&shard->rwlock, NULL);
+    return UNIFYFS_SUCCESS;
+}
+
+/* place inode in the first empty slot at or after its home slot,
+ * assumes there is at least one empty slot */
+static void shard_place(struct unifyfs_inode_table_shard* shard,
+                        struct unifyfs_inode* ino)
+{
+    size_t mask = shard->capacity - 1;
+    size_t i = shard_home_slot(shard, ino->gfid);
+    while (NULL != shard->slots[i]) {
+        i = (i + 1) & mask;
+    }
+    shard->slots[i] = ino;
+}
+
+/* double the capacity of the shard and rehash its inodes */
+static int shard_grow(struct unifyfs_inode_table_shard* shard)
+{
+    size_t old_capacity = shard->capacity;
+    struct unifyfs_inode** old_slots = shard->slots;
+
+    size_t new_capacity = old_capacity * 2;
+    struct unifyfs_inode** new_slots =
+        calloc(new_capacity, sizeof(*new_slots));
+    if (NULL == new_slots) {
+        return ENOMEM;
+    }
+
+    shard->slots    = new_slots;
+    shard->capacity = new_capacity;
+    for (size_t i = 0; i < old_capacity; i++) {
+        if (NULL != old_slots[i]) {
+            shard_place(shard, old_slots[i]);
+        }
+    }
+    free(old_slots);
+
+    return UNIFYFS_SUCCESS;
+}
+
+/* return index of slot holding gfid, or -1 if not found */
+static ssize_t shard_find_slot(struct unifyfs_inode_table_shard* shard,
+                               int64_t gfid)
+{
+    size_t mask = shard->capacity - 1;
+    size_t i = shard_home_slot(shard, gfid);
+    struct unifyfs_inode* ino;
+    while (NULL != (ino = shard->slots[i])) {
+        if (ino->gfid == gfid) {
+            return (ssize_t)i;
+        }
+        i = (i + 1) & mask;
+    }
+    return -1;
+}
+
+/* Returns 0 on success, positive non-zero error code otherwise */
+int unifyfs_inode_table_init(
+    struct unifyfs_inode_table* table)
+{
+    if (NULL == table) {
+        return EINVAL;
+    }
+
+    memset(table, 0, sizeof(*table));
+
+    size_t n_shards = UNIFYFS_INODE_TABLE_SHARDS;
+    struct unifyfs_inode_table_shard* shards = NULL;
+    int rc = posix_memalign((void**)&shards, sizeof(*shards),
+                            n_shards * sizeof(*shards));
+    if (rc != 0) {
+        return ENOMEM;
+    }
+
+    for (size_t i = 0; i < n_shards; i++) {
+        rc = shard_init(&shards[i], UNIFYFS_INODE_TABLE_SHARD_SLOTS);
+        if (rc != UNIFYFS_SUCCESS) {
+            for (size_t j = 0; j < i; j++) {
+                pthread_rwlock_destroy(&shards[j].rwlock);
+                free(shards[j].slots);
+            }
+            free(shards);
+            return rc;
+        }
+    }
+
+    table->num_shards = n_shards;
+    table->shards     = shards;
+
+    return UNIFYFS_SUCCESS;
+}
+
+/* Remove and free all inodes, and release the table resources. */
+void unifyfs_inode_table_destroy(
+    struct unifyfs_inode_table* table)
+{
+    if ((NULL != table) && (NULL != table->shards)) {
+        unifyfs_inode_table_clear(table);
+        for (size_t i = 0; i < table->num_shards; i++) {
+            struct unifyfs_inode_table_shard* shard = &(table->shards[i]);
+            pthread_rwlock_destroy(&shard->rwlock);
+            free(shard->slots);
+        }
+        free(table->shards);
+        table->shards     = NULL;
+        table->num_shards = 0;
+    }
+}
+
+int unifyfs_inode_table_insert(
+    struct unifyfs_inode_table* table, /* table on which to add new entry */
+    struct unifyfs_inode* ino)         /* initial file attribute */
+{
+    if ((NULL == ino) || (ino->gfid != ino->attr.gfid)) {
+        return EINVAL;
+    }
+
+    struct unifyfs_inode_table_shard* shard =
+        unifyfs_inode_table_shard(table, ino->gfid);
+
+    /* check if the inode already exists */
+    if (shard_find_slot(shard, ino->gfid) >= 0) {
+        return EEXIST;
+    }
+
+    /* keep load factor at or below 3/4 to bound probe lengths */
+    if (4 * (shard->count + 1) > 3 * shard->capacity) {
+        int rc = shard_grow(shard);
+        if (rc != UNIFYFS_SUCCESS) {
+            return rc;
+        }
+    }
+
+    shard_place(shard, ino);
+    shard->count++;
+
+    return UNIFYFS_SUCCESS;
+}
+
+/* Search for and return entry for given gfid on specified table.
+ * If not found, return NULL, assumes caller has lock on gfid's shard */
+struct unifyfs_inode* unifyfs_inode_table_search(
+    struct unifyfs_inode_table* table,
+    int64_t gfid)
+{
+    struct unifyfs_inode_table_shard* shard =
+        unifyfs_inode_table_shard(table, gfid);
+
+    ssize_t slot = shard_find_slot(shard, gfid);
+    if (slot < 0) {
+        return NULL;
+    }
+    return shard->slots[slot];
+}
+
+int unifyfs_inode_table_remove(
+    struct unifyfs_inode_table* table,
+    int64_t gfid,
+    struct unifyfs_inode** removed)
+{
+    struct unifyfs_inode_table_shard* shard =
+        unifyfs_inode_table_shard(table, gfid);
+
+    ssize_t slot = shard_find_slot(shard, gfid);
+    if (slot < 0) {
+        return ENOENT;
+    }
+
+    *removed = shard->slots[slot];
+    shard->slots[slot] = NULL;
+    shard->count--;
+
+    /* backward-shift deletion: move any following entries of the probe
+     * run into the hole if their home slot allows it, so that lookups
+     * never need tombstones */
+    size_t mask = shard->capacity - 1;
+    size_t hole = (size_t)slot;
+    size_t i = (hole + 1) & mask;
+    struct unifyfs_inode* ino;
+    while (NULL != (ino = shard->slots[i])) {
+        size_t home = shard_home_slot(shard, ino->gfid);
+        /* entry can move to hole if its home is not cyclically
+         * within (hole, i] */
+        int can_move;
+        if (hole <= i) {
+            can_move = ((home <= hole) || (home > i));
+        } else {
+            can_move = ((home <= hole) && (home > i));
+        }
+        if (can_move) {
+            shard->slots[hole] = ino;
+            shard->slots[i] = NULL;
+            hole = i;
+        }
+        i = (i + 1) & mask;
+    }
+
+    return UNIFYFS_SUCCESS;
+}
+
+/* Return the total number of inodes in the table */
+size_t unifyfs_inode_table_count(
+    struct unifyfs_inode_table* table)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < table->num_shards; i++) {
+        struct unifyfs_inode_table_shard* shard = &(table->shards[i]);
+        pthread_rwlock_rdlock(&shard->rwlock);
+        total += shard->count;
+        pthread_rwlock_unlock(&shard->rwlock);
+    }
+    return total;
+}
+
+/* Call fn for every inode in the table */
+void unifyfs_inode_table_foreach(
+    struct unifyfs_inode_table* table,
+    unifyfs_inode_table_visit_fn fn,
+    void* arg)
+{
+    for (size_t i = 0; i < table->num_shards; i++) {
+        struct unifyfs_inode_table_shard* shard = &(table->shards[i]);
+        pthread_rwlock_rdlock(&shard->rwlock);
+        for (size_t j = 0; j < shard->capacity; j++) {
+            struct unifyfs_inode* ino = shard->slots[j];
+            if (NULL != ino) {
+                fn(ino, arg);
+            }
+        }
+        pthread_rwlock_unlock(&shard->rwlock);
+    }
+}
+
+/*
+ * Remove and free all inodes in the table, but keep it initialized so you
+ * can unifyfs_inode_table_insert() to it.
+ */
+void unifyfs_inode_table_clear(
+    struct unifyfs_inode_table* table)
+{
+    for (size_t i = 0; i < table->num_shards; i++) {
+        struct unifyfs_inode_table_shard* shard = &(table->shards[i]);
+        pthread_rwlock_wrlock(&shard->rwlock);
+        for (size_t j = 0; j < shard->capacity; j++) {
+            struct unifyfs_inode* ino = shard->slots[j];
+            if (NULL != ino) {
+                shard->slots[j] = NULL;
+                unifyfs_inode_destroy(ino);
+            }
+        }
+        shard->count = 0;
+        pthread_rwlock_unlock(&shard->rwlock);
+    }
+}
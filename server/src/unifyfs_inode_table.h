@@ -0,0 +1,204 @@
+/*
+ * Copyright (c) 2020, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2020, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#ifndef __UNIFYFS_INODE_TABLE_H
+#define __UNIFYFS_INODE_TABLE_H
+
+#include <pthread.h>
+#include "unifyfs_meta.h"
+#include "unifyfs_inode.h"
+
+/* number of shards in the inode table, must be a power of two */
+#ifndef UNIFYFS_INODE_TABLE_SHARDS
+# define UNIFYFS_INODE_TABLE_SHARDS 64
+#endif
+
+/* initial number of slots in each shard, must be a power of two */
+#ifndef UNIFYFS_INODE_TABLE_SHARD_SLOTS
+# define UNIFYFS_INODE_TABLE_SHARD_SLOTS 64
+#endif
+
+/*
+ * unifyfs_inode_table_shard: open-addressing (linear probing) hash table
+ * of inode pointers keyed by gfid. Each shard has its own lock, so
+ * operations on inodes that hash to different shards never contend.
+ * Shards are padded to a cache line to avoid false sharing of the locks.
+ */
+struct unifyfs_inode_table_shard {
+    pthread_rwlock_t rwlock;       /** lock for accessing shard */
+    size_t capacity;               /** number of slots (power of two) */
+    size_t count;                  /** number of occupied slots */
+    struct unifyfs_inode** slots;  /** slot array, NULL means empty */
+} __attribute__((aligned(64)));
+
+/*
+ * unifyfs_inode_table: sharded hash table for keeping active inodes.
+ *
+ * NOTE: except for unifyfs_inode_table_init, unifyfs_inode_table_clear, and
+ * unifyfs_inode_table_destroy, none of the following functions perform
+ * locking itself, but the caller should lock/unlock the shard holding the
+ * target gfid using unifyfs_inode_table_rdlock, unifyfs_inode_table_wrlock,
+ * and unifyfs_inode_table_unlock.
+ */
+struct unifyfs_inode_table {
+    size_t num_shards;                         /** number of shards */
+    struct unifyfs_inode_table_shard* shards;  /** shard array */
+};
+
+/**
+ * @brief initialize the inode table.
+ *
+ * @param table the table structure to be initialized. this should be
+ * allocated by the caller.
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_table_init(struct unifyfs_inode_table* table);
+
+/**
+ * @brief Remove and free all inodes in the table, but keep it initialized
+ * so you can unifyfs_inode_table_insert() to it.
+ *
+ * @param table inode table to clear
+ */
+void unifyfs_inode_table_clear(struct unifyfs_inode_table* table);
+
+/**
+ * @brief Remove and free all inodes in the table, and release the table
+ * resources.
+ *
+ * @param table inode table to destroy
+ */
+void unifyfs_inode_table_destroy(struct unifyfs_inode_table* table);
+
+/**
+ * @brief Insert a new inode to the table. Caller must hold the write lock
+ * for the shard of ino->gfid.
+ *
+ * @param table inode table
+ * @param ino new inode to insert
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_table_insert(struct unifyfs_inode_table* table,
+                               struct unifyfs_inode* ino);
+
+/**
+ * @brief Remove an inode with @gfid. Caller must hold the write lock for
+ * the shard of @gfid.
+ *
+ * @param table inode table
+ * @param gfid global file identifier of the target inode
+ * @param removed [out] removed inode
+ *
+ * @return 0 on success, errno otherwise
+ */
+int unifyfs_inode_table_remove(struct unifyfs_inode_table* table,
+                               int64_t gfid, struct unifyfs_inode** removed);
+
+/* Search for and return inode for given gfid on specified table.
+ * If not found, return NULL, assumes caller has lock on gfid's shard */
+struct unifyfs_inode* unifyfs_inode_table_search(
+    struct unifyfs_inode_table* table, /* table to search */
+    int64_t gfid                       /* global file id to find */
+);
+
+/* Return the total number of inodes in the table (takes shard locks) */
+size_t unifyfs_inode_table_count(struct unifyfs_inode_table* table);
+
+/* callback type for unifyfs_inode_table_foreach() */
+typedef void (*unifyfs_inode_table_visit_fn)(struct unifyfs_inode* ino,
+                                             void* arg);
+
+/**
+ * @brief Call @fn for every inode in the table. Each shard is read locked
+ * while its inodes are visited, so @fn must not modify the table.
+ *
+ * @param table inode table
+ * @param fn    function to call for each inode
+ * @param arg   argument passed through to @fn
+ */
+void unifyfs_inode_table_foreach(struct unifyfs_inode_table* table,
+                                 unifyfs_inode_table_visit_fn fn,
+                                 void* arg);
+
+/* mix the gfid bits so that sequential or clustered gfids spread
+ * evenly over shards and slots (64-bit finalizer from MurmurHash3) */
+static inline
+uint64_t unifyfs_inode_table_hash(int64_t gfid)
+{
+    uint64_t h = (uint64_t)gfid;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+}
+
+/* return the shard that holds the given gfid. the shard is selected
+ * using the high bits of the hash, while slots use the low bits */
+static inline
+struct unifyfs_inode_table_shard* unifyfs_inode_table_shard(
+    struct unifyfs_inode_table* table,
+    int64_t gfid)
+{
+    uint64_t h = unifyfs_inode_table_hash(gfid);
+    size_t idx = (size_t)(h >> 40) & (table->num_shards - 1);
+    return &(table->shards[idx]);
+}
+
+/**
+ * @brief Lock the shard holding @gfid for reading.
+ *
+ * @param table inode table
+ * @param gfid global file identifier
+ *
+ * @return 0 on success, errno otherwise
+ */
+static inline
+int unifyfs_inode_table_rdlock(struct unifyfs_inode_table* table, int64_t gfid)
+{
+    return pthread_rwlock_rdlock(
+        &(unifyfs_inode_table_shard(table, gfid)->rwlock));
+}
+
+/**
+ * @brief Lock the shard holding @gfid for read/write.
+ *
+ * @param table inode table
+ * @param gfid global file identifier
+ *
+ * @return 0 on success, errno otherwise
+ */
+static inline
+int unifyfs_inode_table_wrlock(struct unifyfs_inode_table* table, int64_t gfid)
+{
+    return pthread_rwlock_wrlock(
+        &(unifyfs_inode_table_shard(table, gfid)->rwlock));
+}
+
+/**
+ * @brief Unlock the shard holding @gfid.
+ *
+ * @param table inode table
+ * @param gfid global file identifier
+ */
+static inline
+void unifyfs_inode_table_unlock(struct unifyfs_inode_table* table, int64_t gfid)
+{
+    pthread_rwlock_unlock(&(unifyfs_inode_table_shard(table, gfid)->rwlock));
+}
+
+#endif /* __UNIFYFS_INODE_TABLE_H */
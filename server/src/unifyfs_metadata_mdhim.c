@@ -78,8 +78,8 @@ int unifyfs_keyval_compare(const void* a, const void* b)
     const unifyfs_keyval_t* kv_a = a;
     const unifyfs_keyval_t* kv_b = b;
 
-    int gfid_a = kv_a->key.gfid;
-    int gfid_b = kv_b->key.gfid;
+    int64_t gfid_a = kv_a->key.gfid;
+    int64_t gfid_b = kv_b->key.gfid;
     if (gfid_a == gfid_b) {
         int rank_a = kv_a->val.delegator_rank;
         int rank_b = kv_b->val.delegator_rank;
@@ -169,7 +169,7 @@ void print_fsync_indices(unifyfs_key_t** keys,
 {
     size_t i;
     for (i = 0; i < num_entries; i++) {
-        LOGDBG("gfid:%d, offset:%lu, addr:%lu, len:%lu, del_id:%d",
+        LOGDBG("gfid:%" PRId64 ", offset:%lu, addr:%lu, len:%lu, del_id:%d",
                keys[i]->gfid, keys[i]->offset,
                vals[i]->addr, vals[i]->len,
                vals[i]->delegator_rank);
@@ -227,7 +227,7 @@ int unifyfs_set_file_attribute(
     /* select index for file attributes */
     md->primary_index = unifyfs_indexes[IDX_FILE_ATTR];
 
-    int gfid = fattr_ptr->gfid;
+    int64_t gfid = fattr_ptr->gfid;
 
     /* if we want to preserve some settings,
      * we copy those fields from attributes
@@ -257,8 +257,9 @@ int unifyfs_set_file_attribute(
     }
 
     /* insert file attribute for given global file id */
+    fattr_key_t key = unifyfs_fattr_key(gfid);
     struct mdhim_brm_t* brm = mdhimPut(md,
-        &gfid, sizeof(int),
+        &key, sizeof(fattr_key_t),
         fattr_ptr, sizeof(unifyfs_file_attr_t),
         NULL, NULL);
 
@@ -271,7 +272,7 @@ int unifyfs_set_file_attribute(
     }
 
     if (rc != UNIFYFS_SUCCESS) {
-        LOGERR("failed to insert attributes for gfid=%d", gfid);
+        LOGERR("failed to insert attributes for gfid=%" PRId64, gfid);
     }
     return rc;
 }
@@ -325,7 +326,7 @@ int unifyfs_set_file_attributes(int num_entries,
 
 /* given a global file id, lookup and return file attributes */
 int unifyfs_get_file_attribute(
-    int gfid,
+    int64_t gfid,
     unifyfs_file_attr_t* attr)
 {
     int rc = UNIFYFS_SUCCESS;
@@ -333,16 +334,24 @@ int unifyfs_get_file_attribute(
     /* select index holding file attributes,
      * execute lookup for given file id */
     md->primary_index = unifyfs_indexes[IDX_FILE_ATTR];
+    fattr_key_t key = unifyfs_fattr_key(gfid);
     struct mdhim_bgetrm_t* bgrm = mdhimGet(md, md->primary_index,
-        &gfid, sizeof(int), MDHIM_GET_EQ);
+        &key, sizeof(fattr_key_t), MDHIM_GET_EQ);
 
     if (!bgrm || bgrm->error) {
         /* failed to find info for this file id */
         rc = (int)UNIFYFS_ERROR_MDHIM;
     } else {
-        /* copy file attribute from value into output parameter */
         unifyfs_file_attr_t* ptr = (unifyfs_file_attr_t*)bgrm->values[0];
-        memcpy(attr, ptr, sizeof(unifyfs_file_attr_t));
+        if (ptr->gfid != gfid) {
+            /* key is held by a different file */
+            LOGERR("gfid=%" PRId64 " shares attribute key with gfid=%" PRId64,
+                   gfid, ptr->gfid);
+            rc = (int)UNIFYFS_ERROR_GFID;
+        } else {
+            /* copy file attribute from value into output parameter */
+            memcpy(attr, ptr, sizeof(unifyfs_file_attr_t));
+        }
     }
 
     /* free resources returned from lookup */
@@ -351,22 +360,23 @@ int unifyfs_get_file_attribute(
     }
 
     if (rc != UNIFYFS_SUCCESS) {
-        LOGERR("failed to retrieve attributes for gfid=%d", gfid);
+        LOGERR("failed to retrieve attributes for gfid=%" PRId64, gfid);
     }
     return rc;
 }
 
 /* given a global file id, delete file attributes */
 int unifyfs_delete_file_attribute(
-    int gfid)
+    int64_t gfid)
 {
     int rc = UNIFYFS_SUCCESS;
 
     /* select index holding file attributes,
      * delete entry for given file id */
     md->primary_index = unifyfs_indexes[IDX_FILE_ATTR];
+    fattr_key_t key = unifyfs_fattr_key(gfid);
     struct mdhim_brm_t* brm = mdhimDelete(md, md->primary_index,
-        &gfid, sizeof(int));
+        &key, sizeof(fattr_key_t));
 
     /* check for errors and free resources */
     if (!brm) {
@@ -392,7 +402,7 @@ int unifyfs_delete_file_attribute(
     }
 
     if (rc != UNIFYFS_SUCCESS) {
-        LOGERR("failed to delete attributes for gfid=%d", gfid);
+        LOGERR("failed to delete attributes for gfid=%" PRId64, gfid);
     }
     return rc;
 }
@@ -38,12 +38,22 @@
 /* Key for file attributes */
 typedef int fattr_key_t;
 
+/* MDHIM needs small positive integer keys for the file attribute index,
+ * so attributes are stored under the top 31 bits of the 63-bit gfid.
+ * The stored attributes carry the full gfid to detect two files that
+ * share a key. */
+static inline
+fattr_key_t unifyfs_fattr_key(int64_t gfid)
+{
+    return (fattr_key_t)(gfid >> 32);
+}
+
 /**
  * Key for a file extent
  */
 typedef struct {
     /** global file id */
-    int gfid;
+    int64_t gfid;
     /** logical file offset */
     size_t offset;
 } unifyfs_key_t;
@@ -93,7 +103,7 @@ void print_fsync_indices(unifyfs_key_t** unifyfs_keys,
  * @param[out] *ptr_attr_val
  * @return UNIFYFS_SUCCESS on success
  */
-int unifyfs_get_file_attribute(int gfid,
+int unifyfs_get_file_attribute(int64_t gfid,
                                unifyfs_file_attr_t* ptr_attr_val);
 
 /**
@@ -102,7 +112,7 @@ int unifyfs_get_file_attribute(int gfid,
  * @param [in] gfid
  * @return UNIFYFS_SUCCESS on success
  */
-int unifyfs_delete_file_attribute(int gfid);
+int unifyfs_delete_file_attribute(int64_t gfid);
 
 /**
  * Store a File attribute to the KV-Store.
@@ -222,13 +232,13 @@ void debug_log_key_val(const char* ctx,
                        unifyfs_val_t* val)
 {
     if ((key != NULL) && (val != NULL)) {
-        LOGDBG("@%s - key(gfid=%d, offset=%lu), "
+        LOGDBG("@%s - key(gfid=%" PRId64 ", offset=%lu), "
                "val(del=%d, len=%lu, addr=%lu, app=%d, rank=%d)",
                ctx, key->gfid, key->offset,
                val->delegator_rank, val->len, val->addr,
                val->app_id, val->rank);
     } else if (key != NULL) {
-        LOGDBG("@%s - key(gfid=%d, offset=%lu)",
+        LOGDBG("@%s - key(gfid=%" PRId64 ", offset=%lu)",
                ctx, key->gfid, key->offset);
     }
 }
@@ -15,15 +15,16 @@
 #include "unifyfs_global.h"
 #include "unifyfs_p2p_rpc.h"
 #include "unifyfs_group_rpc.h"
+#include "unifyfs_stats.h"
 
 /*************************************************************************
  * Peer-to-peer RPC helper methods
  *************************************************************************/
 
 /* determine server responsible for maintaining target file's metadata */
-int hash_gfid_to_server(int gfid)
+int hash_gfid_to_server(int64_t gfid)
 {
-    return gfid % glb_pmi_size;
+    return (int)(gfid % glb_pmi_size);
 }
 
 /* helper method to initialize peer request rpc handle */
@@ -59,10 +60,12 @@ int forward_p2p_request(void* input_ptr,
     int rc = UNIFYFS_SUCCESS;
 
     /* call rpc function */
+    req->start_ns = unifyfs_stats_now_ns();
     hg_return_t hret = margo_iforward(req->handle, input_ptr,
                                       &(req->request));
     if (hret != HG_SUCCESS) {
         LOGERR("failed to forward p2p request(%p)", req);
+        unifyfs_stats_add(UNIFYFS_STAT_P2P_ERRORS, 1);
         rc = UNIFYFS_ERROR_MARGO;
     }
 
@@ -78,13 +81,169 @@ int wait_for_p2p_request(p2p_request* req)
     hg_return_t hret = margo_wait(req->request);
     if (hret != HG_SUCCESS) {
         LOGERR("wait on p2p request(%p) failed", req);
+        unifyfs_stats_add(UNIFYFS_STAT_P2P_ERRORS, 1);
         rc = UNIFYFS_ERROR_MARGO;
     }
+    unifyfs_stats_record(UNIFYFS_STAT_P2P_REQUEST, req->start_ns);
 
     return rc;
 }
 
 
+/*************************************************************************
+ * Coalescing of concurrent owner requests
+ *************************************************************************/
+
+/* When many local clients open the same file at once (e.g., an N-to-1
+ * shared file create), only the first request for a gfid is forwarded to
+ * the owner. Later requests of the same kind wait for it to complete and
+ * reuse its result, so the owner sees one request per server. */
+typedef enum {
+    P2P_COALESCE_METAGET = 0,
+    P2P_COALESCE_CREATE
+} p2p_coalesce_e;
+
+typedef struct p2p_coalesced_req {
+    struct p2p_coalesced_req* next;
+    int64_t gfid;
+    p2p_coalesce_e kind;
+    uint64_t mutation_seq;     /* mutation sequence of gfid when issued */
+    int refs;                  /* leader plus waiting followers */
+    int done;                  /* set once leader has stored result */
+    int rc;                    /* result of the owner request */
+    unifyfs_file_attr_t attrs; /* metaget result, or create attributes */
+} p2p_coalesced_req;
+
+static pthread_mutex_t coalesce_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t coalesce_cond = PTHREAD_COND_INITIALIZER;
+static p2p_coalesced_req* coalesce_list; // = NULL
+
+/* A metaget may only be joined by callers whose own earlier changes to
+ * the file it is sure to reflect. Every change of a file's attributes
+ * made through this server bumps a mutation sequence number for the gfid
+ * once the owner has applied it, and a metaget records the number that
+ * was current when it was issued. A caller only joins a metaget issued
+ * after its own last change, i.e., one that has the current number.
+ * Files share sequence numbers by gfid hash, so a collision can only
+ * prevent a join. */
+#define P2P_MUTATION_SEQ_BUCKETS 1024
+static uint64_t mutation_seqs[P2P_MUTATION_SEQ_BUCKETS];
+
+static inline uint64_t* gfid_mutation_seq(int64_t gfid)
+{
+    return &mutation_seqs[(uint64_t)gfid % P2P_MUTATION_SEQ_BUCKETS];
+}
+
+/* note that a change of the attributes of gfid has completed */
+void unifyfs_p2p_note_mutation(int64_t gfid)
+{
+    pthread_mutex_lock(&coalesce_lock);
+    (*gfid_mutation_seq(gfid))++;
+    pthread_mutex_unlock(&coalesce_lock);
+}
+
+/* Find an in-flight request of the given kind for gfid and take a
+ * reference on it, or register a new one if there is none.
+ * Sets *is_leader if caller must issue the owner request. */
+static p2p_coalesced_req* coalesce_join(int64_t gfid,
+                                        p2p_coalesce_e kind,
+                                        int* is_leader)
+{
+    p2p_coalesced_req* creq;
+
+    *is_leader = 0;
+    pthread_mutex_lock(&coalesce_lock);
+    uint64_t seq = *gfid_mutation_seq(gfid);
+    for (creq = coalesce_list; NULL != creq; creq = creq->next) {
+        if ((creq->gfid == gfid) && (creq->kind == kind) && !creq->done &&
+            ((kind != P2P_COALESCE_METAGET) || (creq->mutation_seq == seq))) {
+            creq->refs++;
+            break;
+        }
+    }
+    if (NULL == creq) {
+        creq = calloc(1, sizeof(*creq));
+        if (NULL != creq) {
+            creq->gfid = gfid;
+            creq->kind = kind;
+            creq->mutation_seq = seq;
+            creq->refs = 1;
+            creq->next = coalesce_list;
+            coalesce_list = creq;
+            *is_leader = 1;
+        }
+    }
+    pthread_mutex_unlock(&coalesce_lock);
+
+    return creq;
+}
+
+/* drop a reference, freeing the request when it was the last one.
+ * caller must hold coalesce_lock */
+static void coalesce_release_locked(p2p_coalesced_req* creq)
+{
+    if (--(creq->refs) > 0) {
+        return;
+    }
+    if (NULL != creq->attrs.filename) {
+        free(creq->attrs.filename);
+    }
+    free(creq);
+}
+
+/* Leader stores the result of its owner request, and wakes the followers.
+ * The request can not be joined after this. */
+static void coalesce_complete(p2p_coalesced_req* creq,
+                              int rc,
+                              unifyfs_file_attr_t* attrs)
+{
+    pthread_mutex_lock(&coalesce_lock);
+
+    /* unlink from in-flight list */
+    p2p_coalesced_req** prev = &coalesce_list;
+    while (*prev != creq) {
+        prev = &((*prev)->next);
+    }
+    *prev = creq->next;
+
+    creq->rc = rc;
+    if (NULL != attrs) {
+        creq->attrs = *attrs;
+        creq->attrs.filename = NULL;
+        if (NULL != attrs->filename) {
+            creq->attrs.filename = strdup(attrs->filename);
+        }
+    }
+    creq->done = 1;
+    pthread_cond_broadcast(&coalesce_cond);
+    coalesce_release_locked(creq);
+
+    pthread_mutex_unlock(&coalesce_lock);
+}
+
+/* Follower waits for the leader's result. If attrs is not NULL, it is
+ * set to a copy of the leader's attributes (with its own filename). */
+static int coalesce_wait(p2p_coalesced_req* creq,
+                         unifyfs_file_attr_t* attrs)
+{
+    pthread_mutex_lock(&coalesce_lock);
+    while (!creq->done) {
+        pthread_cond_wait(&coalesce_cond, &coalesce_lock);
+    }
+    int rc = creq->rc;
+    if (NULL != attrs) {
+        *attrs = creq->attrs;
+        attrs->filename = NULL;
+        if (NULL != creq->attrs.filename) {
+            attrs->filename = strdup(creq->attrs.filename);
+        }
+    }
+    coalesce_release_locked(creq);
+    pthread_mutex_unlock(&coalesce_lock);
+
+    return rc;
+}
+
 /*************************************************************************
  * File chunk reads request/response
  *************************************************************************/
@@ -103,7 +262,8 @@ int invoke_chunk_read_request_rpc(int dst_srvr_rank,
                                     rdreq->req_ndx,
                                     num_chunks,
                                     remote_reads->total_sz,
-                                    (char*)(remote_reads->reqs));
+                                    (char*)(remote_reads->reqs),
+                                    rdreq->trace);
     }
 
     int ret = UNIFYFS_SUCCESS;
@@ -137,6 +297,7 @@ int invoke_chunk_read_request_rpc(int dst_srvr_rank,
     in.num_chks        = (int32_t)num_chunks;
     in.total_data_size = (hg_size_t)remote_reads->total_sz;
     in.bulk_size       = bulk_sz;
+    in.trace           = rdreq->trace;
 
     /* register request buffer for bulk remote access */
     void* data_buf = remote_reads->reqs;
@@ -411,9 +572,9 @@ DEFINE_MARGO_RPC_HANDLER(chunk_read_response_rpc)
  *************************************************************************/
 
 /* Add extents to target file */
-int unifyfs_invoke_add_extents_rpc(int gfid,
-                                   unsigned int num_extents,
-                                   struct extent_tree_node* extents)
+static int forward_add_extents(int64_t gfid,
+                               unsigned int num_extents,
+                               struct extent_tree_node* extents)
 {
     int owner_rank = hash_gfid_to_server(gfid);
     if (owner_rank == glb_pmi_rank) {
@@ -444,7 +605,7 @@ int unifyfs_invoke_add_extents_rpc(int gfid,
     /* fill rpc input struct and forward request */
     add_extents_in_t in;
     in.src_rank = (int32_t) glb_pmi_rank;
-    in.gfid = (int32_t) gfid;
+    in.gfid = gfid;
     in.num_extents = (int32_t) num_extents;
     in.extents = bulk_handle;
     rc = forward_p2p_request((void*)&in, &preq);
@@ -476,6 +637,16 @@ int unifyfs_invoke_add_extents_rpc(int gfid,
     return ret;
 }
 
+/* change the file, then keep later metagets from joining older ones */
+int unifyfs_invoke_add_extents_rpc(int64_t gfid,
+                                   unsigned int num_extents,
+                                   struct extent_tree_node* extents)
+{
+    int ret = forward_add_extents(gfid, num_extents, extents);
+    unifyfs_p2p_note_mutation(gfid);
+    return ret;
+}
+
 /* Add extents rpc handler */
 static void add_extents_rpc(hg_handle_t handle)
 {
@@ -549,7 +720,7 @@ DEFINE_MARGO_RPC_HANDLER(add_extents_rpc)
  *************************************************************************/
 
 /* Lookup extent locations for target file */
-int unifyfs_invoke_find_extents_rpc(int gfid,
+int unifyfs_invoke_find_extents_rpc(int64_t gfid,
                                     unsigned int num_extents,
                                     unifyfs_inode_extent_t* extents,
                                     unsigned int* num_chunks,
@@ -572,7 +743,7 @@ int unifyfs_invoke_find_extents_rpc(int gfid,
             ret = sm_find_extents(gfid, (size_t)num_extents, extents,
                                   num_chunks, chunks);
             if (ret) {
-                LOGERR("failed to find extents for gfid=%d (ret=%d)",
+                LOGERR("failed to find extents for gfid=%" PRId64 " (ret=%d)",
                        gfid, ret);
             } else if (*num_chunks == 0) {
                 LOGDBG("extent lookup found no matching chunks");
@@ -590,6 +761,19 @@ int unifyfs_invoke_find_extents_rpc(int gfid,
         return rc;
     }
 
+    /* if another local client read the same extent before, ask the owner
+     * only whether the file extents changed since that lookup */
+    uint64_t cached_version = 0;
+    unsigned int cached_n_chks = 0;
+    chunk_read_req_t* cached_chks = NULL;
+    if (num_extents == 1) {
+        rc = unifyfs_inode_extent_cache_lookup(extents, &cached_version,
+                                               &cached_n_chks, &cached_chks);
+        if (rc != UNIFYFS_SUCCESS) {
+            cached_version = 0;
+        }
+    }
+
     /* create a margo bulk transfer handle for extents array */
     hg_bulk_t bulk_req_handle;
     void* buf = (void*) extents;
@@ -598,17 +782,20 @@ int unifyfs_invoke_find_extents_rpc(int gfid,
                                          HG_BULK_READ_ONLY, &bulk_req_handle);
     if (hret != HG_SUCCESS) {
         LOGERR("margo_bulk_create() failed");
+        free(cached_chks);
         return UNIFYFS_ERROR_MARGO;
     }
 
     /* fill rpc input struct and forward request */
     find_extents_in_t in;
     in.src_rank = (int32_t) glb_pmi_rank;
-    in.gfid = (int32_t) gfid;
+    in.gfid = gfid;
+    in.version = cached_version;
     in.num_extents = (int32_t) num_extents;
     in.extents = bulk_req_handle;
     rc = forward_p2p_request((void*)&in, &preq);
     if (rc != UNIFYFS_SUCCESS) {
+        free(cached_chks);
         return rc;
     }
     margo_bulk_free(bulk_req_handle);
@@ -616,6 +803,7 @@ int unifyfs_invoke_find_extents_rpc(int gfid,
     /* wait for request completion */
     rc = wait_for_p2p_request(&preq);
     if (rc != UNIFYFS_SUCCESS) {
+        free(cached_chks);
         return rc;
     }
 
@@ -628,7 +816,16 @@ int unifyfs_invoke_find_extents_rpc(int gfid,
     } else {
         /* set return value */
         ret = out.ret;
-        if (ret == UNIFYFS_SUCCESS) {
+        uint64_t version = (uint64_t) out.version;
+        if ((ret == UNIFYFS_SUCCESS) && (cached_version != 0) &&
+            (version == cached_version)) {
+            /* extents have not changed, use cached locations */
+            LOGDBG("using %u cached chunk locations for gfid=%" PRId64,
+                   cached_n_chks, gfid);
+            *chunks = cached_chks;
+            *num_chunks = cached_n_chks;
+            cached_chks = NULL;
+        } else if (ret == UNIFYFS_SUCCESS) {
             /* get number of chunks */
             unsigned int n_chks = (unsigned int) out.num_locations;
             if (n_chks > 0) {
@@ -642,16 +839,23 @@ int unifyfs_invoke_find_extents_rpc(int gfid,
                     ret = UNIFYFS_ERROR_MARGO;
                 } else {
                     /* lookup requested extents */
-                    LOGDBG("received %u chunk locations for gfid=%d",
+                    LOGDBG("received %u chunk locations for gfid=%" PRId64,
                            n_chks, gfid);
                     *chunks = (chunk_read_req_t*) buf;
                     *num_chunks = (unsigned int) n_chks;
                 }
             }
+            if ((ret == UNIFYFS_SUCCESS) && (num_extents == 1) &&
+                (version != 0)) {
+                /* keep locations for other reads of the same extent */
+                unifyfs_inode_extent_cache_store(extents, version,
+                                                 *num_chunks, *chunks);
+            }
         }
         margo_free_output(preq.handle, &out);
     }
     margo_destroy(preq.handle);
+    free(cached_chks);
 
     return ret;
 }
@@ -712,6 +916,7 @@ static void find_extents_rpc(hg_handle_t handle)
         /* return to caller */
         find_extents_out_t out;
         out.ret           = (int32_t) ret;
+        out.version       = 0;
         out.num_locations = 0;
         out.locations     = HG_BULK_NULL;
 
@@ -732,7 +937,7 @@ DEFINE_MARGO_RPC_HANDLER(find_extents_rpc)
  *************************************************************************/
 
 /* Get file attributes for target file */
-int unifyfs_invoke_metaget_rpc(int gfid,
+int unifyfs_invoke_metaget_rpc(int64_t gfid,
                                unifyfs_file_attr_t* attrs)
 {
     if (NULL == attrs) {
@@ -742,6 +947,10 @@ int unifyfs_invoke_metaget_rpc(int gfid,
     int owner_rank = hash_gfid_to_server(gfid);
     int need_local_metadata = 0;
 
+    /* take lease generation before looking for a lease, so that a lease
+     * granted by the reply below is ignored if revoked meanwhile */
+    uint64_t lease_gen = unifyfs_inode_lease_generation();
+
     /* do local inode metadata lookup */
     int rc = sm_get_fileattr(gfid, attrs);
     if (owner_rank == glb_pmi_rank) {
@@ -753,40 +962,52 @@ int unifyfs_invoke_metaget_rpc(int gfid,
             return UNIFYFS_SUCCESS;
         }
 
-        /* use cached attributes if within threshold */
-        struct timespec tp = {0};
-        clock_gettime(CLOCK_REALTIME, &tp);
-        time_t expire = attrs->ctime.tv_sec + UNIFYFS_METADATA_CACHE_SECONDS;
-        if (tp.tv_sec <= expire) {
-            LOGINFO("using cached attributes for gfid=%d", gfid);
+        /* use leased attributes, the owner revokes the lease
+         * before they change */
+        if (unifyfs_inode_lease_get(gfid, attrs) == UNIFYFS_SUCCESS) {
+            LOGDBG("using leased attributes for gfid=%" PRId64, gfid);
             return UNIFYFS_SUCCESS;
-        } else {
-            LOGINFO("cached attributes have expired");
         }
     } else if (rc == ENOENT) {
         /* metaget above failed with ENOENT, need to create inode */
         need_local_metadata = 1;
     }
 
+    /* if another client's request for this file is already on its way
+     * to the owner, use its result rather than sending our own */
+    int is_leader;
+    p2p_coalesced_req* creq = coalesce_join(gfid, P2P_COALESCE_METAGET,
+                                            &is_leader);
+    if ((NULL != creq) && !is_leader) {
+        LOGDBG("waiting on in-flight metaget for gfid=%" PRId64, gfid);
+        return coalesce_wait(creq, attrs);
+    }
+
     /* forward request to file owner */
     p2p_request preq;
     hg_id_t req_hgid = unifyfsd_rpc_context->rpcs.metaget_id;
     rc = get_p2p_request_handle(req_hgid, owner_rank, &preq);
-    if (rc != UNIFYFS_SUCCESS) {
-        return rc;
+    if (rc == UNIFYFS_SUCCESS) {
+        /* fill rpc input struct and forward request */
+        metaget_in_t in;
+        in.src_rank = (int32_t) glb_pmi_rank;
+        in.gfid = gfid;
+        rc = forward_p2p_request((void*)&in, &preq);
+        if (rc != UNIFYFS_SUCCESS) {
+            margo_destroy(preq.handle);
+        }
     }
-
-    /* fill rpc input struct and forward request */
-    metaget_in_t in;
-    in.gfid = (int32_t)gfid;
-    rc = forward_p2p_request((void*)&in, &preq);
-    if (rc != UNIFYFS_SUCCESS) {
-        return rc;
+    if (rc == UNIFYFS_SUCCESS) {
+        /* wait for request completion */
+        rc = wait_for_p2p_request(&preq);
+        if (rc != UNIFYFS_SUCCESS) {
+            margo_destroy(preq.handle);
+        }
     }
-
-    /* wait for request completion */
-    rc = wait_for_p2p_request(&preq);
     if (rc != UNIFYFS_SUCCESS) {
+        if (NULL != creq) {
+            coalesce_complete(creq, rc, NULL);
+        }
         return rc;
     }
 
@@ -808,11 +1029,18 @@ int unifyfs_invoke_metaget_rpc(int gfid,
             if (need_local_metadata) {
                 sm_set_fileattr(gfid, UNIFYFS_FILE_ATTR_OP_CREATE, attrs);
             }
+            if (out.leased) {
+                unifyfs_inode_lease_set(gfid, attrs, lease_gen);
+            }
         }
         margo_free_output(preq.handle, &out);
     }
     margo_destroy(preq.handle);
 
+    if (NULL != creq) {
+        coalesce_complete(creq, ret, (ret == UNIFYFS_SUCCESS) ? attrs : NULL);
+    }
+
     return ret;
 }
 
@@ -871,12 +1099,342 @@ static void metaget_rpc(hg_handle_t handle)
 DEFINE_MARGO_RPC_HANDLER(metaget_rpc)
 
 
+/*************************************************************************
+ * File metadata lease revocation
+ *************************************************************************/
+
+/* Revoke all leases granted on the attributes of target file and wait
+ * for the holders to drop them. Local clients are also told to drop any
+ * metadata they have cached. */
+int unifyfs_revoke_metadata_leases(int64_t gfid)
+{
+    /* local clients may cache attributes served by the owner itself */
+    invalidate_client_metadata_caches();
+
+    int n_holders = 0;
+    int* holders = NULL;
+    int rc = unifyfs_inode_lease_take_holders(gfid, glb_pmi_size,
+                                              &n_holders, &holders);
+    if (rc != UNIFYFS_SUCCESS) {
+        /* no inode, no leases */
+        return (rc == ENOENT) ? UNIFYFS_SUCCESS : rc;
+    } else if (0 == n_holders) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    p2p_request* preqs = calloc((size_t)n_holders, sizeof(*preqs));
+    int* started = calloc((size_t)n_holders, sizeof(int));
+    if ((NULL == preqs) || (NULL == started)) {
+        free(preqs);
+        free(started);
+        free(holders);
+        return ENOMEM;
+    }
+
+    /* send all revocations before waiting on any of them */
+    int ret = UNIFYFS_SUCCESS;
+    hg_id_t req_hgid = unifyfsd_rpc_context->rpcs.lease_revoke_id;
+    lease_revoke_in_t in;
+    in.gfid = gfid;
+    for (int i = 0; i < n_holders; i++) {
+        rc = get_p2p_request_handle(req_hgid, holders[i], preqs + i);
+        if (rc == UNIFYFS_SUCCESS) {
+            rc = forward_p2p_request((void*)&in, preqs + i);
+            if (rc != UNIFYFS_SUCCESS) {
+                margo_destroy(preqs[i].handle);
+            }
+        }
+        if (rc == UNIFYFS_SUCCESS) {
+            started[i] = 1;
+        } else {
+            /* the lease will time out at the holder */
+            LOGERR("failed to revoke lease on gfid=%" PRId64
+                   " at server %d", gfid, holders[i]);
+            ret = rc;
+        }
+    }
+
+    for (int i = 0; i < n_holders; i++) {
+        if (!started[i]) {
+            continue;
+        }
+        rc = wait_for_p2p_request(preqs + i);
+        if (rc == UNIFYFS_SUCCESS) {
+            lease_revoke_out_t out;
+            hg_return_t hret = margo_get_output(preqs[i].handle, &out);
+            if (hret != HG_SUCCESS) {
+                LOGERR("margo_get_output() failed");
+                rc = UNIFYFS_ERROR_MARGO;
+            } else {
+                rc = out.ret;
+                margo_free_output(preqs[i].handle, &out);
+            }
+        }
+        if (rc != UNIFYFS_SUCCESS) {
+            LOGERR("lease revoke on gfid=%" PRId64
+                   " at server %d failed - rc=%d", gfid, holders[i], rc);
+            ret = rc;
+        }
+        margo_destroy(preqs[i].handle);
+    }
+
+    free(preqs);
+    free(started);
+    free(holders);
+
+    return ret;
+}
+
+/* Lease revoke rpc handler. This is handled right away rather than
+ * through the service manager, since the owner may be waiting on it from
+ * its own service manager thread while handling our request. */
+static void lease_revoke_rpc(hg_handle_t handle)
+{
+    LOGDBG("lease revoke rpc handler");
+
+    int ret;
+    lease_revoke_in_t in;
+    hg_return_t hret = margo_get_input(handle, &in);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_get_input() failed");
+        ret = UNIFYFS_ERROR_MARGO;
+    } else {
+        int64_t gfid = in.gfid;
+        margo_free_input(handle, &in);
+
+        ret = unifyfs_inode_lease_revoke(gfid);
+        if (ret == ENOENT) {
+            /* file was unlinked here, so nothing is leased */
+            ret = UNIFYFS_SUCCESS;
+        }
+
+        /* local clients may have cached the leased attributes */
+        invalidate_client_metadata_caches();
+    }
+
+    /* return to caller */
+    lease_revoke_out_t out;
+    out.ret = (int32_t) ret;
+    hret = margo_respond(handle, &out);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_respond() failed");
+    }
+
+    /* free margo resources */
+    margo_destroy(handle);
+}
+DEFINE_MARGO_RPC_HANDLER(lease_revoke_rpc)
+
+
+/*************************************************************************
+ * File stat request
+ *************************************************************************/
+
+/* Check local metadata to see if attributes for gfid can be returned
+ * without asking the owner, which is the case when the local server is
+ * the owner, the file is laminated, or the local server holds a lease on
+ * its attributes. Returns 1 and sets *rc if attrs is final, otherwise
+ * returns 0 and sets *need_local if the local server has no inode for
+ * the file yet. */
+static int stat_local(int64_t gfid,
+                      unifyfs_file_attr_t* attrs,
+                      int* rc,
+                      int* need_local)
+{
+    *need_local = 0;
+    *rc = sm_get_fileattr(gfid, attrs);
+
+    int final = 0;
+    if (hash_gfid_to_server(gfid) == glb_pmi_rank) {
+        /* local server is the owner */
+        final = 1;
+    } else if (*rc == UNIFYFS_SUCCESS) {
+        if (attrs->is_laminated) {
+            /* if laminated, we already have final metadata locally */
+            final = 1;
+        } else if (unifyfs_inode_lease_get(gfid, attrs) ==
+                   UNIFYFS_SUCCESS) {
+            /* the owner revokes the lease when attributes change */
+            final = 1;
+        }
+    } else if (*rc == ENOENT) {
+        *need_local = 1;
+    }
+
+    /* the filename is not returned, and here it would point
+     * into the local inode */
+    attrs->filename = NULL;
+
+    return final;
+}
+
+/* Start a metaget request to the owner of gfid */
+static int stat_forward(int64_t gfid,
+                        p2p_request* preq)
+{
+    hg_id_t req_hgid = unifyfsd_rpc_context->rpcs.metaget_id;
+    int rc = get_p2p_request_handle(req_hgid, hash_gfid_to_server(gfid),
+                                    preq);
+    if (rc != UNIFYFS_SUCCESS) {
+        return rc;
+    }
+
+    metaget_in_t in;
+    in.src_rank = (int32_t) glb_pmi_rank;
+    in.gfid = gfid;
+    rc = forward_p2p_request((void*)&in, preq);
+    if (rc != UNIFYFS_SUCCESS) {
+        margo_destroy(preq->handle);
+    }
+    return rc;
+}
+
+/* Wait for a metaget request started by stat_forward(), copy the owner's
+ * attributes (without the filename) to attrs, and destroy the request
+ * handle. If the owner granted a lease, it is kept unless a lease was
+ * revoked after lease_gen was taken, and *leased is set. */
+static int stat_complete(int64_t gfid,
+                         p2p_request* preq,
+                         int need_local,
+                         uint64_t lease_gen,
+                         unifyfs_file_attr_t* attrs,
+                         int* leased)
+{
+    *leased = 0;
+    int ret = wait_for_p2p_request(preq);
+    if (ret != UNIFYFS_SUCCESS) {
+        margo_destroy(preq->handle);
+        return ret;
+    }
+
+    metaget_out_t out;
+    hg_return_t hret = margo_get_output(preq->handle, &out);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_get_output() failed");
+        ret = UNIFYFS_ERROR_MARGO;
+    } else {
+        ret = out.ret;
+        if (ret == UNIFYFS_SUCCESS) {
+            *attrs = out.attr;
+            if (need_local) {
+                sm_set_fileattr(gfid, UNIFYFS_FILE_ATTR_OP_CREATE, attrs);
+            }
+            if (out.leased &&
+                (unifyfs_inode_lease_set(gfid, attrs, lease_gen) ==
+                 UNIFYFS_SUCCESS)) {
+                *leased = 1;
+            }
+            attrs->filename = NULL;
+        }
+        margo_free_output(preq->handle, &out);
+    }
+    margo_destroy(preq->handle);
+
+    return ret;
+}
+
+/* Get file attributes (without the filename) with an up-to-date size for
+ * target file. Attributes of a non-laminated file only come from the
+ * owner or from a lease it granted, since the owner keeps the size
+ * current as extents are added and the file is truncated. Sets
+ * *cacheable if the owner will revoke the attributes once they change,
+ * so local clients may cache them until told otherwise. */
+int unifyfs_invoke_stat_rpc(int64_t gfid,
+                            unifyfs_file_attr_t* attrs,
+                            int* cacheable)
+{
+    if ((NULL == attrs) || (NULL == cacheable)) {
+        return EINVAL;
+    }
+
+    uint64_t lease_gen = unifyfs_inode_lease_generation();
+
+    int rc;
+    int need_local;
+    if (stat_local(gfid, attrs, &rc, &need_local)) {
+        *cacheable = (rc == UNIFYFS_SUCCESS);
+        return rc;
+    }
+
+    *cacheable = 0;
+    p2p_request preq;
+    rc = stat_forward(gfid, &preq);
+    if (rc != UNIFYFS_SUCCESS) {
+        return rc;
+    }
+    return stat_complete(gfid, &preq, need_local, lease_gen, attrs,
+                         cacheable);
+}
+
+/* Get file attributes for each gfid in results. Requests to owners are
+ * issued for up to UNIFYFS_STAT_MANY_INFLIGHT files at a time before
+ * waiting on any of them, so the lookups overlap rather than costing one
+ * round trip each. Sets the rc and attributes (without the filename) of
+ * each result. */
+int unifyfs_invoke_stat_many_rpc(size_t n_files,
+                                 unifyfs_stat_result_t* results)
+{
+    if ((0 == n_files) || (NULL == results)) {
+        return EINVAL;
+    }
+
+    size_t max_reqs = UNIFYFS_STAT_MANY_INFLIGHT;
+    if (max_reqs > n_files) {
+        max_reqs = n_files;
+    }
+    p2p_request* preqs = calloc(max_reqs, sizeof(*preqs));
+    size_t* req_ndx = calloc(max_reqs, sizeof(*req_ndx));
+    int* need_local = calloc(max_reqs, sizeof(*need_local));
+    if ((NULL == preqs) || (NULL == req_ndx) || (NULL == need_local)) {
+        free(preqs);
+        free(req_ndx);
+        free(need_local);
+        return ENOMEM;
+    }
+
+    size_t i = 0;
+    while (i < n_files) {
+        /* start requests for the next set of files */
+        uint64_t lease_gen = unifyfs_inode_lease_generation();
+        size_t n_reqs = 0;
+        for (; (i < n_files) && (n_reqs < max_reqs); i++) {
+            unifyfs_stat_result_t* res = results + i;
+            memset(&(res->attr), 0, sizeof(res->attr));
+            int local;
+            if (stat_local(res->gfid, &(res->attr), &(res->rc), &local)) {
+                continue;
+            }
+            res->rc = stat_forward(res->gfid, preqs + n_reqs);
+            if (res->rc == UNIFYFS_SUCCESS) {
+                req_ndx[n_reqs] = i;
+                need_local[n_reqs] = local;
+                n_reqs++;
+            }
+        }
+
+        /* collect their responses */
+        for (size_t r = 0; r < n_reqs; r++) {
+            unifyfs_stat_result_t* res = results + req_ndx[r];
+            int leased;
+            res->rc = stat_complete(res->gfid, preqs + r, need_local[r],
+                                    lease_gen, &(res->attr), &leased);
+        }
+    }
+
+    free(preqs);
+    free(req_ndx);
+    free(need_local);
+
+    return UNIFYFS_SUCCESS;
+}
+
+
 /*************************************************************************
  * File size request
  *************************************************************************/
 
 /*  Get current global size for the target file */
-int unifyfs_invoke_filesize_rpc(int gfid,
+int unifyfs_invoke_filesize_rpc(int64_t gfid,
                                 size_t* filesize)
 {
     if (NULL == filesize) {
@@ -897,6 +1455,12 @@ int unifyfs_invoke_filesize_rpc(int gfid,
         *filesize = (size_t) attrs.size;
         return rc;
     }
+    if ((rc == UNIFYFS_SUCCESS) &&
+        (unifyfs_inode_lease_get(gfid, &attrs) == UNIFYFS_SUCCESS)) {
+        /* leased size is current until the owner revokes the lease */
+        *filesize = (size_t) attrs.size;
+        return UNIFYFS_SUCCESS;
+    }
 
     /* forward request to file owner */
     p2p_request preq;
@@ -908,7 +1472,7 @@ int unifyfs_invoke_filesize_rpc(int gfid,
 
     /* fill rpc input struct and forward request */
     filesize_in_t in;
-    in.gfid = (int32_t)gfid;
+    in.gfid = gfid;
     rc = forward_p2p_request((void*)&in, &preq);
     if (rc != UNIFYFS_SUCCESS) {
         return rc;
@@ -1000,22 +1564,49 @@ DEFINE_MARGO_RPC_HANDLER(filesize_rpc)
  *************************************************************************/
 
 /* Set metadata for target file */
-int unifyfs_invoke_metaset_rpc(int gfid,
-                               int attr_op,
-                               unifyfs_file_attr_t* attrs)
+static int forward_metaset(int64_t gfid,
+                           int attr_op,
+                           unifyfs_file_attr_t* attrs)
 {
     if (NULL == attrs) {
         return EINVAL;
     }
 
-    int ret = sm_set_fileattr(gfid, attr_op, attrs);
-    if (ret != UNIFYFS_SUCCESS) {
-        return ret;
+    int owner_rank = hash_gfid_to_server(gfid);
+    int is_owner = (owner_rank == glb_pmi_rank);
+
+    /* concurrent creates of the same file by local clients are sent to
+     * the owner once, only one of them can succeed anyway */
+    p2p_coalesced_req* creq = NULL;
+    if ((attr_op == UNIFYFS_FILE_ATTR_OP_CREATE) && !is_owner) {
+        int is_leader;
+        creq = coalesce_join(gfid, P2P_COALESCE_CREATE, &is_leader);
+        if ((NULL != creq) && !is_leader) {
+            LOGDBG("waiting on in-flight create for gfid=%" PRId64, gfid);
+            unifyfs_file_attr_t created;
+            int rc = coalesce_wait(creq, &created);
+            if ((rc == UNIFYFS_SUCCESS) || (rc == EEXIST)) {
+                /* file exists now, check it is the one we wanted */
+                rc = EEXIST;
+                if ((NULL != created.filename) &&
+                    (NULL != attrs->filename) &&
+                    (0 != strcmp(created.filename, attrs->filename))) {
+                    rc = UNIFYFS_ERROR_GFID;
+                }
+            }
+            if (NULL != created.filename) {
+                free(created.filename);
+            }
+            return rc;
+        }
     }
 
-    int owner_rank = hash_gfid_to_server(gfid);
-    if (owner_rank == glb_pmi_rank) {
-        /* I'm the owner, return local result */
+    int ret = sm_set_fileattr(gfid, attr_op, attrs);
+    if ((ret != UNIFYFS_SUCCESS) || is_owner) {
+        /* local failure, or I'm the owner, return local result */
+        if (NULL != creq) {
+            coalesce_complete(creq, ret, attrs);
+        }
         return ret;
     }
 
@@ -1023,42 +1614,63 @@ int unifyfs_invoke_metaset_rpc(int gfid,
     p2p_request preq;
     hg_id_t req_hgid = unifyfsd_rpc_context->rpcs.metaset_id;
     int rc = get_p2p_request_handle(req_hgid, owner_rank, &preq);
-    if (rc != UNIFYFS_SUCCESS) {
-        return rc;
+    if (rc == UNIFYFS_SUCCESS) {
+        /* fill rpc input struct and forward request */
+        metaset_in_t in;
+        in.gfid = gfid;
+        in.fileop = (int32_t) attr_op;
+        in.attr = *attrs;
+        rc = forward_p2p_request((void*)&in, &preq);
+        if (rc == UNIFYFS_SUCCESS) {
+            /* wait for request completion */
+            rc = wait_for_p2p_request(&preq);
+        }
+        if (rc != UNIFYFS_SUCCESS) {
+            margo_destroy(preq.handle);
+        }
     }
-
-    /* fill rpc input struct and forward request */
-    metaset_in_t in;
-    in.gfid = (int32_t) gfid;
-    in.fileop = (int32_t) attr_op;
-    in.attr = *attrs;
-    rc = forward_p2p_request((void*)&in, &preq);
-    if (rc != UNIFYFS_SUCCESS) {
-        return rc;
+    if (rc == UNIFYFS_SUCCESS) {
+        /* get the output of the rpc */
+        metaset_out_t out;
+        hg_return_t hret = margo_get_output(preq.handle, &out);
+        if (hret != HG_SUCCESS) {
+            LOGERR("margo_get_output() failed");
+            ret = UNIFYFS_ERROR_MARGO;
+        } else {
+            /* set return value */
+            ret = out.ret;
+            margo_free_output(preq.handle, &out);
+        }
+        margo_destroy(preq.handle);
+    } else {
+        ret = rc;
     }
 
-    /* wait for request completion */
-    rc = wait_for_p2p_request(&preq);
-    if (rc != UNIFYFS_SUCCESS) {
-        return rc;
+    if ((attr_op == UNIFYFS_FILE_ATTR_OP_CREATE) && (ret != UNIFYFS_SUCCESS)) {
+        /* the owner did not take our create (e.g., another server created
+         * the file first), so the local inode we just created does not
+         * hold the owner's attributes. drop it so that the next metaget
+         * fetches the owner's copy */
+        unifyfs_inode_unlink(gfid);
     }
 
-    /* get the output of the rpc */
-    metaset_out_t out;
-    hg_return_t hret = margo_get_output(preq.handle, &out);
-    if (hret != HG_SUCCESS) {
-        LOGERR("margo_get_output() failed");
-        ret = UNIFYFS_ERROR_MARGO;
-    } else {
-        /* set return value */
-        ret = out.ret;
-        margo_free_output(preq.handle, &out);
+    if (NULL != creq) {
+        coalesce_complete(creq, ret, attrs);
     }
-    margo_destroy(preq.handle);
 
     return ret;
 }
 
+/* change the file, then keep later metagets from joining older ones */
+int unifyfs_invoke_metaset_rpc(int64_t gfid,
+                               int attr_op,
+                               unifyfs_file_attr_t* attrs)
+{
+    int ret = forward_metaset(gfid, attr_op, attrs);
+    unifyfs_p2p_note_mutation(gfid);
+    return ret;
+}
+
 /* Metaset rpc handler */
 static void metaset_rpc(hg_handle_t handle)
 {
@@ -1118,7 +1730,7 @@ DEFINE_MARGO_RPC_HANDLER(metaset_rpc)
  *************************************************************************/
 
 /*  Laminate the target file */
-int unifyfs_invoke_laminate_rpc(int gfid)
+static int forward_laminate(int64_t gfid)
 {
     int ret;
     int owner_rank = hash_gfid_to_server(gfid);
@@ -1137,7 +1749,7 @@ int unifyfs_invoke_laminate_rpc(int gfid)
 
     /* fill rpc input struct and forward request */
     laminate_in_t in;
-    in.gfid = (int32_t)gfid;
+    in.gfid = gfid;
     rc = forward_p2p_request((void*)&in, &preq);
     if (rc != UNIFYFS_SUCCESS) {
         return rc;
@@ -1165,6 +1777,14 @@ int unifyfs_invoke_laminate_rpc(int gfid)
     return ret;
 }
 
+/* change the file, then keep later metagets from joining older ones */
+int unifyfs_invoke_laminate_rpc(int64_t gfid)
+{
+    int ret = forward_laminate(gfid);
+    unifyfs_p2p_note_mutation(gfid);
+    return ret;
+}
+
 /* Laminate rpc handler */
 static void laminate_rpc(hg_handle_t handle)
 {
@@ -1224,8 +1844,8 @@ DEFINE_MARGO_RPC_HANDLER(laminate_rpc)
  *************************************************************************/
 
 /* Truncate the target file */
-int unifyfs_invoke_truncate_rpc(int gfid,
-                                size_t filesize)
+static int forward_truncate(int64_t gfid,
+                            size_t filesize)
 {
     int owner_rank = hash_gfid_to_server(gfid);
     if (owner_rank == glb_pmi_rank) {
@@ -1242,7 +1862,7 @@ int unifyfs_invoke_truncate_rpc(int gfid,
 
     /* fill rpc input struct and forward request */
     truncate_in_t in;
-    in.gfid = (int32_t) gfid;
+    in.gfid = gfid;
     in.filesize = (hg_size_t) filesize;
     rc = forward_p2p_request((void*)&in, &preq);
     if (rc != UNIFYFS_SUCCESS) {
@@ -1272,6 +1892,15 @@ int unifyfs_invoke_truncate_rpc(int gfid,
     return ret;
 }
 
+/* change the file, then keep later metagets from joining older ones */
+int unifyfs_invoke_truncate_rpc(int64_t gfid,
+                                size_t filesize)
+{
+    int ret = forward_truncate(gfid, filesize);
+    unifyfs_p2p_note_mutation(gfid);
+    return ret;
+}
+
 /* Truncate rpc handler */
 static void truncate_rpc(hg_handle_t handle)
 {
@@ -23,14 +23,20 @@
 #include "unifyfs_service_manager.h"
 
 
+/* max number of owner requests a stat-many lookup keeps in flight */
+#ifndef UNIFYFS_STAT_MANY_INFLIGHT
+# define UNIFYFS_STAT_MANY_INFLIGHT 128
+#endif
+
 /* determine server responsible for maintaining target file's metadata */
-int hash_gfid_to_server(int gfid);
+int hash_gfid_to_server(int64_t gfid);
 
 /* server peer-to-peer (p2p) margo request structure */
 typedef struct {
     margo_request request;
     hg_addr_t     peer;
     hg_handle_t   handle;
+    uint64_t      start_ns;     /* when request was forwarded (for stats) */
 } p2p_request;
 
 /* helper method to initialize peer request rpc handle */
@@ -77,7 +83,7 @@ int invoke_chunk_read_response_rpc(server_chunk_reads_t* scr);
  *
  * @return success|failure
  */
-int unifyfs_invoke_add_extents_rpc(int gfid,
+int unifyfs_invoke_add_extents_rpc(int64_t gfid,
                                    unsigned int num_extents,
                                    struct extent_tree_node* extents);
 
@@ -93,7 +99,7 @@ int unifyfs_invoke_add_extents_rpc(int gfid,
  *
  * @return success|failure
  */
-int unifyfs_invoke_find_extents_rpc(int gfid,
+int unifyfs_invoke_find_extents_rpc(int64_t gfid,
                                     unsigned int num_extents,
                                     unifyfs_inode_extent_t* extents,
                                     unsigned int* num_chunks,
@@ -107,7 +113,7 @@ int unifyfs_invoke_find_extents_rpc(int gfid,
  *
  * @return success|failure
  */
-int unifyfs_invoke_filesize_rpc(int gfid,
+int unifyfs_invoke_filesize_rpc(int64_t gfid,
                                 size_t* filesize);
 
 /**
@@ -117,7 +123,7 @@ int unifyfs_invoke_filesize_rpc(int gfid,
  *
  * @return success|failure
  */
-int unifyfs_invoke_laminate_rpc(int gfid);
+int unifyfs_invoke_laminate_rpc(int64_t gfid);
 
 /**
  * @brief Get metadata for target file
@@ -128,9 +134,55 @@ int unifyfs_invoke_laminate_rpc(int gfid);
  *
  * @return success|failure
  */
-int unifyfs_invoke_metaget_rpc(int gfid,
+int unifyfs_invoke_metaget_rpc(int64_t gfid,
                                unifyfs_file_attr_t* attrs);
 
+/**
+ * @brief Note that a change of the target file's attributes (e.g., its
+ * unlink) has completed, so that later metagets of the file are not
+ * coalesced with metagets issued before the change
+ *
+ * @param gfid  target file
+ */
+void unifyfs_p2p_note_mutation(int64_t gfid);
+
+/**
+ * @brief Revoke leases granted by the owner on the attributes of target
+ * file, waiting until all holders have dropped them
+ *
+ * @param gfid    target file
+ *
+ * @return success|failure
+ */
+int unifyfs_revoke_metadata_leases(int64_t gfid);
+
+/**
+ * @brief Get metadata with an up-to-date size for target file, asking the
+ * owner directly unless the file is laminated or leased
+ *
+ * @param gfid       target file
+ * @param attrs      file attributes to fill, the filename is set to NULL
+ * @param cacheable  set if local clients may cache the attributes
+ *
+ * @return success|failure
+ */
+int unifyfs_invoke_stat_rpc(int64_t gfid,
+                            unifyfs_file_attr_t* attrs,
+                            int* cacheable);
+
+/**
+ * @brief Get metadata with an up-to-date size for many files, overlapping
+ * the requests to the owners
+ *
+ * @param n_files  number of files
+ * @param results  array of stat results with gfid set, the rc and attr
+ *                 of each result are filled in
+ *
+ * @return success|failure
+ */
+int unifyfs_invoke_stat_many_rpc(size_t n_files,
+                                 unifyfs_stat_result_t* results);
+
 /**
  * @brief Update metadata for target file
  *
@@ -140,7 +192,7 @@ int unifyfs_invoke_metaget_rpc(int gfid,
  *
  * @return success|failure
  */
-int unifyfs_invoke_metaset_rpc(int gfid, int attr_op,
+int unifyfs_invoke_metaset_rpc(int64_t gfid, int attr_op,
                                unifyfs_file_attr_t* attrs);
 
 /**
@@ -151,7 +203,7 @@ int unifyfs_invoke_metaset_rpc(int gfid, int attr_op,
  *
  * @return success|failure
  */
-int unifyfs_invoke_truncate_rpc(int gfid, size_t filesize);
+int unifyfs_invoke_truncate_rpc(int64_t gfid, size_t filesize);
 
 /**
  * @brief Report pid of local server to rank 0 server
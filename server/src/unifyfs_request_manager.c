@@ -31,7 +31,7 @@
 #include "unifyfs_global.h"
 
 // server components
-#include "unifyfs_inode_tree.h"
+#include "unifyfs_inode_table.h"
 #include "unifyfs_metadata_mdhim.h"
 #include "unifyfs_request_manager.h"
 #include "unifyfs_service_manager.h"
@@ -42,6 +42,8 @@
 #include "unifyfs_p2p_rpc.h"
 
 #include "unifyfs_server_rpcs.h"
+#include "unifyfs_stats.h"
+#include "unifyfs_trace.h"
 
 
 #define RM_LOCK(rm) \
@@ -243,6 +245,20 @@ int rm_release_read_req(reqmgr_thrd_t* thrd_ctrl,
     return release_read_req(thrd_ctrl, rdreq);
 }
 
+/* ring the doorbell of the client's request queue, which is what the
+ * reqmgr thread sleeps on instead of its condition variable when the
+ * client uses a queue */
+static void ring_request_queue_doorbell(reqmgr_thrd_t* reqmgr)
+{
+    unifyfs_shm_reqq_header_t* hdr = reqmgr->shmq;
+    if (NULL != hdr) {
+        __atomic_add_fetch(&hdr->doorbell, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&hdr->server_waiting, __ATOMIC_SEQ_CST)) {
+            unifyfs_shm_futex_wake(&hdr->doorbell, 1);
+        }
+    }
+}
+
 static void signal_new_requests(reqmgr_thrd_t* reqmgr)
 {
     pid_t this_thread = unifyfs_gettid();
@@ -250,6 +266,7 @@ static void signal_new_requests(reqmgr_thrd_t* reqmgr)
         /* signal reqmgr to begin processing the requests we just added */
         LOGDBG("signaling new requests");
         pthread_cond_signal(&reqmgr->thrd_cond);
+        ring_request_queue_doorbell(reqmgr);
     }
 }
 
@@ -264,6 +281,7 @@ static void signal_new_responses(reqmgr_thrd_t* reqmgr)
              * signal it to begin processing the responses we just added */
             LOGDBG("signaling new responses");
             pthread_cond_signal(&reqmgr->thrd_cond);
+            ring_request_queue_doorbell(reqmgr);
         }
         RM_UNLOCK(reqmgr);
     }
@@ -428,9 +446,12 @@ int rm_submit_read_request(server_read_req_t* req)
     rdreq->chunks = req->chunks;
     rdreq->remote_reads = req->remote_reads;
     rdreq->extent = req->extent;
+    rdreq->trace = req->trace;
+    rdreq->start_ns = req->start_ns;
 
     for (i = 0; i < rdreq->num_server_reads; i++) {
         rdreq->remote_reads[i].rdreq_id = rm_req_index;
+        rdreq->remote_reads[i].trace = req->trace;
     }
 
     rdreq->status = READREQ_READY;
@@ -460,6 +481,7 @@ int rm_request_exit(reqmgr_thrd_t* thrd_ctrl)
     if (thrd_ctrl->waiting_for_work) {
          /* signal reqmgr thread */
         pthread_cond_signal(&thrd_ctrl->thrd_cond);
+        ring_request_queue_doorbell(thrd_ctrl);
     }
 
     /* release the lock */
@@ -512,8 +534,12 @@ static int rm_request_remote_chunks(reqmgr_thrd_t* thrd_ctrl)
                     LOGDBG("[%d of %d] sending %d chunk requests to server[%d]",
                            j, req->num_server_reads,
                            remote_reads->num_chunks, remote_rank);
+                    uint64_t start_ns = unifyfs_stats_now_ns();
                     rc = invoke_chunk_read_request_rpc(remote_rank, req,
                                                        remote_reads);
+                    unifyfs_trace_span(&(req->trace),
+                                       UNIFYFS_TRACE_RM_CHUNK_READ_RPC,
+                                       start_ns);
                     if (rc != UNIFYFS_SUCCESS) {
                         ret = rc;
                         LOGERR("server request rpc to %d failed - %s",
@@ -687,7 +713,7 @@ int send_data_to_client(server_read_req_t* rdreq,
         }
 
         LOGDBG("sending data for client[%d:%d] mread[%d] request %d "
-               "(gfid=%d, offset=%zu, length=%zu, remaining=%zu)",
+               "(gfid=%" PRId64 ", offset=%zu, length=%zu, remaining=%zu)",
                app_id, client_id, mread_id, read_ndx,
                resp->gfid, req_file_offset + read_byte_offset,
                send_sz, bytes_left);
@@ -698,7 +724,7 @@ int send_data_to_client(server_read_req_t* rdreq,
         if (rc != UNIFYFS_SUCCESS) {
             ret = rc;
             LOGERR("failed data rpc for mread[%d] request %d "
-                   "(gfid=%d, offset=%zu, length=%zu)",
+                   "(gfid=%" PRId64 ", offset=%zu, length=%zu)",
                    mread_id, read_ndx, resp->gfid,
                    req_file_offset + read_byte_offset, send_sz);
         }
@@ -752,6 +778,8 @@ int rm_handle_chunk_read_responses(reqmgr_thrd_t* thrd_ctrl,
         responses = server_chunks->resp;
         data_buf = (char*)(responses + num_chks);
 
+        size_t data_bytes = 0;
+        uint64_t send_start = unifyfs_stats_now_ns();
         for (i = 0; i < num_chks; i++) {
             chunk_read_resp_t* resp = responses + i;
             size_t processed = 0;
@@ -763,6 +791,16 @@ int rm_handle_chunk_read_responses(reqmgr_thrd_t* thrd_ctrl,
             }
 
             data_buf += processed;
+            data_bytes += processed;
+        }
+        unifyfs_trace_span(&(rdreq->trace), UNIFYFS_TRACE_RM_SEND_DATA,
+                           send_start);
+        if (server_chunks->rank == glb_pmi_rank) {
+            unifyfs_stats_add(UNIFYFS_STAT_SERVER_READ_LOCAL_BYTES,
+                              data_bytes);
+        } else {
+            unifyfs_stats_add(UNIFYFS_STAT_SERVER_READ_REMOTE_BYTES,
+                              data_bytes);
         }
 
         /* cleanup */
@@ -799,12 +837,27 @@ int rm_handle_chunk_read_responses(reqmgr_thrd_t* thrd_ctrl,
                        mread_id, read_ndx, rc);
                 ret = rc;
             }
+            unifyfs_trace_span(&(rdreq->trace), UNIFYFS_TRACE_RM_READ_REQUEST,
+                               rdreq->start_ns);
         }
     }
 
     return ret;
 }
 
+/* get the number of client rpc requests waiting for the request
+ * manager thread */
+size_t rm_get_queue_depth(reqmgr_thrd_t* reqmgr)
+{
+    size_t depth = 0;
+    RM_REQ_LOCK(reqmgr);
+    if (NULL != reqmgr->client_reqs) {
+        depth = (size_t) arraylist_size(reqmgr->client_reqs);
+    }
+    RM_REQ_UNLOCK(reqmgr);
+    return depth;
+}
+
 /* submit a client rpc request to the request manager thread */
 int rm_submit_client_rpc_request(unifyfs_fops_ctx_t* ctx,
                                  client_rpc_req_t* req)
@@ -822,6 +875,7 @@ int rm_submit_client_rpc_request(unifyfs_fops_ctx_t* ctx,
     /* get thread control structure */
     reqmgr_thrd_t* reqmgr = client->reqmgr;
     assert(NULL != reqmgr);
+    req->submit_ns = unifyfs_stats_now_ns();
     RM_REQ_LOCK(reqmgr);
     arraylist_add(reqmgr->client_reqs, req);
     RM_REQ_UNLOCK(reqmgr);
@@ -851,9 +905,16 @@ static int process_attach_rpc(reqmgr_thrd_t* reqmgr,
                                 in->logio_mem_size,
                                 in->shmem_super_size,
                                 in->meta_offset,
-                                in->meta_size);
+                                in->meta_size,
+                                in->reqq_offset,
+                                in->reqq_size);
         if (ret != UNIFYFS_SUCCESS) {
             LOGERR("attach_app_client() failed");
+        } else {
+            /* start taking requests from the client's request queue,
+             * which the client has just initialized */
+            reqmgr->shmq_head = 0;
+            reqmgr->shmq = app_client_request_queue(client);
         }
     } else {
         LOGERR("client not found (app_id=%d, client_id=%d)",
@@ -878,6 +939,59 @@ static int process_attach_rpc(reqmgr_thrd_t* reqmgr,
     return ret;
 }
 
+static int process_extent_map_rpc(reqmgr_thrd_t* reqmgr,
+                                  client_rpc_req_t* req)
+{
+    int ret = UNIFYFS_SUCCESS;
+
+    unifyfs_extent_map_in_t* in = req->input;
+    assert(in != NULL);
+    int64_t gfid = in->gfid;
+    size_t offset = (size_t) in->offset;
+    size_t max_ranges = (size_t) in->max_ranges;
+
+    LOGDBG("getting extent map for gfid=%" PRId64 " from offset=%zu",
+           gfid, offset);
+
+    size_t num_ranges = 0;
+    unifyfs_extent_t* ranges = calloc(max_ranges, sizeof(*ranges));
+    if (NULL == ranges) {
+        ret = ENOMEM;
+    } else {
+        unifyfs_fops_ctx_t ctx = {
+            .app_id = reqmgr->app_id,
+            .client_id = reqmgr->client_id,
+        };
+        ret = unifyfs_fops_extent_map(&ctx, gfid, offset, max_ranges,
+                                      ranges, &num_ranges);
+        if (ret != UNIFYFS_SUCCESS) {
+            LOGERR("unifyfs_fops_extent_map() failed");
+        } else if (num_ranges > 0) {
+            /* send the ranges back to the client */
+            ret = push_margo_bulk_buffer(req->handle, in->bulk_ranges,
+                                         ranges,
+                                         num_ranges * sizeof(*ranges));
+        }
+        free(ranges);
+    }
+    margo_free_input(req->handle, in);
+    free(in);
+
+    /* send rpc response */
+    unifyfs_extent_map_out_t out;
+    out.ret = (int32_t) ret;
+    out.num_ranges = (int32_t) num_ranges;
+    hg_return_t hret = margo_respond(req->handle, &out);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_respond() failed");
+    }
+
+    /* cleanup req */
+    margo_destroy(req->handle);
+
+    return ret;
+}
+
 static int process_filesize_rpc(reqmgr_thrd_t* reqmgr,
                                 client_rpc_req_t* req)
 {
@@ -886,11 +1000,11 @@ static int process_filesize_rpc(reqmgr_thrd_t* reqmgr,
 
     unifyfs_filesize_in_t* in = req->input;
     assert(in != NULL);
-    int gfid = in->gfid;
+    int64_t gfid = in->gfid;
     margo_free_input(req->handle, in);
     free(in);
 
-    LOGDBG("getting filesize for gfid=%d", gfid);
+    LOGDBG("getting filesize for gfid=%" PRId64, gfid);
 
     unifyfs_fops_ctx_t ctx = {
         .app_id = reqmgr->app_id,
@@ -923,20 +1037,30 @@ static int process_fsync_rpc(reqmgr_thrd_t* reqmgr,
 
     unifyfs_fsync_in_t* in = req->input;
     assert(in != NULL);
-    int gfid = in->gfid;
+    int64_t gfid = in->gfid;
+    unifyfs_trace_ctx_t trace = in->trace;
     margo_free_input(req->handle, in);
     free(in);
 
-    LOGINFO("syncing gfid=%d", gfid);
+    LOGINFO("syncing gfid=%" PRId64, gfid);
+
+    unifyfs_trace_span(&trace, UNIFYFS_TRACE_RM_QUEUE, req->submit_ns);
+    uint64_t start_ns = unifyfs_stats_now_ns();
 
     unifyfs_fops_ctx_t ctx = {
         .app_id = reqmgr->app_id,
         .client_id = reqmgr->client_id,
+        .trace = trace
     };
     ret = unifyfs_fops_fsync(&ctx, gfid);
+    unifyfs_trace_span(&trace, UNIFYFS_TRACE_RM_FSYNC, start_ns);
     if (ret != UNIFYFS_SUCCESS) {
         LOGERR("unifyfs_fops_fsync() failed");
+    } else if (reqmgr->index_sync_rc != UNIFYFS_SUCCESS) {
+        /* report failure to consume extents in the background */
+        ret = reqmgr->index_sync_rc;
     }
+    reqmgr->index_sync_rc = UNIFYFS_SUCCESS;
 
     /* send rpc response */
     unifyfs_fsync_out_t out;
@@ -959,11 +1083,11 @@ static int process_laminate_rpc(reqmgr_thrd_t* reqmgr,
 
     unifyfs_laminate_in_t* in = req->input;
     assert(in != NULL);
-    int gfid = in->gfid;
+    int64_t gfid = in->gfid;
     margo_free_input(req->handle, in);
     free(in);
 
-    LOGDBG("laminating gfid=%d", gfid);
+    LOGDBG("laminating gfid=%" PRId64, gfid);
 
     unifyfs_fops_ctx_t ctx = {
         .app_id = reqmgr->app_id,
@@ -995,11 +1119,11 @@ static int process_metaget_rpc(reqmgr_thrd_t* reqmgr,
 
     unifyfs_metaget_in_t* in = req->input;
     assert(in != NULL);
-    int gfid = in->gfid;
+    int64_t gfid = in->gfid;
     margo_free_input(req->handle, in);
     free(in);
 
-    LOGDBG("getting metadata for gfid=%d", gfid);
+    LOGDBG("getting metadata for gfid=%" PRId64, gfid);
 
     unifyfs_fops_ctx_t ctx = {
         .app_id = reqmgr->app_id,
@@ -1034,7 +1158,7 @@ static int process_metaset_rpc(reqmgr_thrd_t* reqmgr,
 
     unifyfs_metaset_in_t* in = req->input;
     assert(in != NULL);
-    int gfid = in->attr.gfid;
+    int64_t gfid = in->attr.gfid;
     int attr_op = (int) in->attr_op;
     unifyfs_file_attr_t fattr = in->attr;
     if (NULL != in->attr.filename) {
@@ -1045,7 +1169,7 @@ static int process_metaset_rpc(reqmgr_thrd_t* reqmgr,
     }
     free(in);
 
-    LOGDBG("setting metadata for gfid=%d", gfid);
+    LOGDBG("setting metadata for gfid=%" PRId64, gfid);
 
     unifyfs_fops_ctx_t ctx = {
         .app_id = reqmgr->app_id,
@@ -1084,17 +1208,23 @@ static int process_read_rpc(reqmgr_thrd_t* reqmgr,
     assert(in != NULL);
     int mread_id = in->mread_id;
     size_t read_count = in->read_count;
+    unifyfs_trace_ctx_t trace = in->trace;
     margo_free_input(req->handle, in);
     free(in);
 
     LOGDBG("processing mread[%d] with %zu requests", mread_id, read_count);
 
+    unifyfs_trace_span(&trace, UNIFYFS_TRACE_RM_QUEUE, req->submit_ns);
+    uint64_t start_ns = unifyfs_stats_now_ns();
+
     unifyfs_fops_ctx_t ctx = {
         .app_id = reqmgr->app_id,
         .client_id = reqmgr->client_id,
-        .mread_id = mread_id
+        .mread_id = mread_id,
+        .trace = trace
     };
     ret = unifyfs_fops_mread(&ctx, read_count, req->bulk_buf);
+    unifyfs_trace_span(&trace, UNIFYFS_TRACE_RM_MREAD, start_ns);
     if (ret != UNIFYFS_SUCCESS) {
         LOGERR("unifyfs_fops_read() failed");
     }
@@ -1114,6 +1244,126 @@ static int process_read_rpc(reqmgr_thrd_t* reqmgr,
     return ret;
 }
 
+static int process_stat_rpc(reqmgr_thrd_t* reqmgr,
+                            client_rpc_req_t* req)
+{
+    int ret = UNIFYFS_SUCCESS;
+
+    unifyfs_stat_in_t* in = req->input;
+    assert(in != NULL);
+    int64_t gfid = in->gfid;
+    margo_free_input(req->handle, in);
+    free(in);
+
+    LOGDBG("getting stat for gfid=%" PRId64, gfid);
+
+    unifyfs_fops_ctx_t ctx = {
+        .app_id = reqmgr->app_id,
+        .client_id = reqmgr->client_id,
+    };
+    unifyfs_file_attr_t fattr;
+    memset(&fattr, 0, sizeof(fattr));
+    int cacheable = 0;
+    ret = unifyfs_fops_stat(&ctx, gfid, &fattr, &cacheable);
+    if (ret != UNIFYFS_SUCCESS) {
+        LOGDBG("unifyfs_fops_stat() failed");
+        cacheable = 0;
+    }
+
+    /* send rpc response */
+    unifyfs_stat_out_t out;
+    out.ret = (int32_t) ret;
+    out.cacheable = (int32_t) cacheable;
+    out.attr = fattr;
+    hg_return_t hret = margo_respond(req->handle, &out);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_respond() failed");
+    }
+
+    /* cleanup req */
+    margo_destroy(req->handle);
+
+    return ret;
+}
+
+static int process_stat_many_rpc(reqmgr_thrd_t* reqmgr,
+                                 client_rpc_req_t* req)
+{
+    int ret = UNIFYFS_SUCCESS;
+
+    unifyfs_stat_many_in_t* in = req->input;
+    assert(in != NULL);
+    size_t num_files = (size_t) in->num_files;
+    unifyfs_stat_result_t* results = req->bulk_buf;
+
+    LOGDBG("getting stat for %zu files", num_files);
+
+    unifyfs_fops_ctx_t ctx = {
+        .app_id = reqmgr->app_id,
+        .client_id = reqmgr->client_id,
+    };
+    ret = unifyfs_fops_stat_many(&ctx, num_files, results);
+    if (ret != UNIFYFS_SUCCESS) {
+        LOGERR("unifyfs_fops_stat_many() failed");
+    } else {
+        /* send the filled in results back to the client */
+        ret = push_margo_bulk_buffer(req->handle, in->bulk_results,
+                                     req->bulk_buf, req->bulk_sz);
+    }
+    free(req->bulk_buf);
+    margo_free_input(req->handle, in);
+    free(in);
+
+    /* send rpc response */
+    unifyfs_stat_many_out_t out;
+    out.ret = (int32_t) ret;
+    hg_return_t hret = margo_respond(req->handle, &out);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_respond() failed");
+    }
+
+    /* cleanup req */
+    margo_destroy(req->handle);
+
+    return ret;
+}
+
+static int process_transfer_rpc(reqmgr_thrd_t* reqmgr,
+                                client_rpc_req_t* req)
+{
+    int ret = UNIFYFS_SUCCESS;
+
+    unifyfs_transfer_in_t* in = req->input;
+    assert(in != NULL);
+    int64_t gfid = in->gfid;
+
+    LOGDBG("transferring gfid=%" PRId64 " to %s", gfid, in->dst_file);
+
+    unifyfs_fops_ctx_t ctx = {
+        .app_id = reqmgr->app_id,
+        .client_id = reqmgr->client_id,
+    };
+    ret = unifyfs_fops_transfer(&ctx, gfid, in->dst_file);
+    if (ret != UNIFYFS_SUCCESS) {
+        LOGERR("unifyfs_fops_transfer() failed");
+    }
+    margo_free_input(req->handle, in);
+    free(in);
+
+    /* send rpc response */
+    unifyfs_transfer_out_t out;
+    out.ret = (int32_t) ret;
+    hg_return_t hret = margo_respond(req->handle, &out);
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_respond() failed");
+    }
+
+    /* cleanup req */
+    margo_destroy(req->handle);
+
+    return ret;
+}
+
 static int process_truncate_rpc(reqmgr_thrd_t* reqmgr,
                                 client_rpc_req_t* req)
 {
@@ -1121,12 +1371,12 @@ static int process_truncate_rpc(reqmgr_thrd_t* reqmgr,
 
     unifyfs_truncate_in_t* in = req->input;
     assert(in != NULL);
-    int gfid = in->gfid;
+    int64_t gfid = in->gfid;
     size_t filesize = in->filesize;
     margo_free_input(req->handle, in);
     free(in);
 
-    LOGDBG("truncating gfid=%d, sz=%zu", gfid, filesize);
+    LOGDBG("truncating gfid=%" PRId64 ", sz=%zu", gfid, filesize);
 
     unifyfs_fops_ctx_t ctx = {
         .app_id = reqmgr->app_id,
@@ -1151,6 +1401,31 @@ static int process_truncate_rpc(reqmgr_thrd_t* reqmgr,
     return ret;
 }
 
+/* consume any write index entries the client has published in its index
+ * ring, so that its later syncs have little or nothing left to do */
+static int rm_drain_client_index(reqmgr_thrd_t* reqmgr)
+{
+    app_client* client = get_app_client(reqmgr->app_id, reqmgr->client_id);
+    if ((NULL == client) || !client->connected) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    if (0 == app_client_index_pending(client)) {
+        return UNIFYFS_SUCCESS;
+    }
+
+    unifyfs_fops_ctx_t ctx = {
+        .app_id = reqmgr->app_id,
+        .client_id = reqmgr->client_id,
+    };
+    int rc = unifyfs_fops_fsync(&ctx, -1);
+    if (rc != UNIFYFS_SUCCESS) {
+        LOGERR("failed to consume client write index (rc=%d)", rc);
+        reqmgr->index_sync_rc = rc;
+    }
+    return rc;
+}
+
 static int process_unlink_rpc(reqmgr_thrd_t* reqmgr,
                               client_rpc_req_t* req)
 {
@@ -1158,11 +1433,16 @@ static int process_unlink_rpc(reqmgr_thrd_t* reqmgr,
 
     unifyfs_unlink_in_t* in = req->input;
     assert(in != NULL);
-    int gfid = in->gfid;
+    int64_t gfid = in->gfid;
     margo_free_input(req->handle, in);
     free(in);
 
-    LOGDBG("unlinking gfid=%d", gfid);
+    LOGDBG("unlinking gfid=%" PRId64, gfid);
+
+    /* apply extents the client published before the unlink, so none are
+     * left in its index ring to be applied to a removed (or re-created)
+     * file afterwards */
+    rm_drain_client_index(reqmgr);
 
     unifyfs_fops_ctx_t ctx = {
         .app_id = reqmgr->app_id,
@@ -1222,10 +1502,16 @@ static int rm_process_client_requests(reqmgr_thrd_t* reqmgr)
         int rret;
         client_rpc_req_t* req = (client_rpc_req_t*)
             arraylist_get(client_reqs, i);
-        switch (req->req_type) {
+        client_rpc_e req_type = req->req_type;
+        uint64_t start = unifyfs_stats_now_ns();
+        unifyfs_stats_record(UNIFYFS_STAT_RM_QUEUE_WAIT, req->submit_ns);
+        switch (req_type) {
         case UNIFYFS_CLIENT_RPC_ATTACH:
             rret = process_attach_rpc(reqmgr, req);
             break;
+        case UNIFYFS_CLIENT_RPC_EXTENT_MAP:
+            rret = process_extent_map_rpc(reqmgr, req);
+            break;
         case UNIFYFS_CLIENT_RPC_FILESIZE:
             rret = process_filesize_rpc(reqmgr, req);
             break;
@@ -1241,9 +1527,18 @@ static int rm_process_client_requests(reqmgr_thrd_t* reqmgr)
         case UNIFYFS_CLIENT_RPC_READ:
             rret = process_read_rpc(reqmgr, req);
             break;
+        case UNIFYFS_CLIENT_RPC_STAT:
+            rret = process_stat_rpc(reqmgr, req);
+            break;
+        case UNIFYFS_CLIENT_RPC_STAT_MANY:
+            rret = process_stat_many_rpc(reqmgr, req);
+            break;
         case UNIFYFS_CLIENT_RPC_SYNC:
             rret = process_fsync_rpc(reqmgr, req);
             break;
+        case UNIFYFS_CLIENT_RPC_TRANSFER:
+            rret = process_transfer_rpc(reqmgr, req);
+            break;
         case UNIFYFS_CLIENT_RPC_TRUNCATE:
             rret = process_truncate_rpc(reqmgr, req);
             break;
@@ -1255,6 +1550,8 @@ static int rm_process_client_requests(reqmgr_thrd_t* reqmgr)
             rret = UNIFYFS_ERROR_NYI;
             break;
         }
+        unifyfs_stats_record_rpc(UNIFYFS_STATS_RPC_CLIENT, (int)req_type,
+                                 start);
         if (rret != UNIFYFS_SUCCESS) {
             if ((rret != ENOENT) && (rret != EEXIST)) {
                 LOGERR("client rpc request %d failed (%s)",
@@ -1273,6 +1570,161 @@ static int rm_process_client_requests(reqmgr_thrd_t* reqmgr)
     return ret;
 }
 
+/* handle one request from the client's shared-memory request queue,
+ * leaving its results in the queue slot */
+static int process_shm_request(reqmgr_thrd_t* reqmgr,
+                               unifyfs_shm_reqq_slot_t* slot)
+{
+    int ret;
+    unifyfs_shm_reqq_args_t* args = &(slot->args);
+    int64_t gfid = args->gfid;
+
+    unifyfs_fops_ctx_t ctx = {
+        .app_id = reqmgr->app_id,
+        .client_id = reqmgr->client_id,
+        .trace = { .id = args->trace_id }
+    };
+    uint64_t start_ns = unifyfs_stats_now_ns();
+
+    LOGDBG("processing queued request type=%d for gfid=%" PRId64,
+           (int)slot->req_type, gfid);
+
+    switch (slot->req_type) {
+    case UNIFYFS_CLIENT_RPC_FILESIZE: {
+        size_t filesize = 0;
+        ret = unifyfs_fops_filesize(&ctx, gfid, &filesize);
+        args->size = (uint64_t) filesize;
+        break;
+    }
+    case UNIFYFS_CLIENT_RPC_LAMINATE:
+        ret = unifyfs_fops_laminate(&ctx, gfid);
+        break;
+    case UNIFYFS_CLIENT_RPC_METAGET: {
+        unifyfs_file_attr_t fattr;
+        memset(&fattr, 0, sizeof(fattr));
+        ret = unifyfs_fops_metaget(&ctx, gfid, &fattr);
+        slot->data_size = 0;
+        if (ret == UNIFYFS_SUCCESS) {
+            /* return filename in slot data */
+            if (NULL != fattr.filename) {
+                size_t len = strlcpy(slot->data, fattr.filename,
+                                     UNIFYFS_SHM_REQQ_DATA_MAX);
+                if (len >= UNIFYFS_SHM_REQQ_DATA_MAX) {
+                    len = UNIFYFS_SHM_REQQ_DATA_MAX - 1;
+                }
+                slot->data_size = (uint32_t)(len + 1);
+            }
+            args->attr = fattr;
+            args->attr.filename = NULL;
+        }
+        break;
+    }
+    case UNIFYFS_CLIENT_RPC_READ: {
+        size_t read_count = (size_t) args->read_count;
+        size_t extents_size = read_count * sizeof(unifyfs_extent_t);
+        if ((0 == read_count) ||
+            (extents_size > (size_t) slot->data_size) ||
+            (extents_size > UNIFYFS_SHM_REQQ_DATA_MAX)) {
+            ret = EINVAL;
+        } else {
+            ctx.mread_id = (int) args->mread_id;
+            ret = unifyfs_fops_mread(&ctx, read_count, slot->data);
+            unifyfs_trace_span(&(ctx.trace), UNIFYFS_TRACE_RM_MREAD,
+                               start_ns);
+        }
+        break;
+    }
+    case UNIFYFS_CLIENT_RPC_STAT: {
+        int cacheable = 0;
+        unifyfs_file_attr_t fattr;
+        memset(&fattr, 0, sizeof(fattr));
+        ret = unifyfs_fops_stat(&ctx, gfid, &fattr, &cacheable);
+        if (ret == UNIFYFS_SUCCESS) {
+            args->attr = fattr;
+            args->attr.filename = NULL;
+            args->cacheable = (int32_t) cacheable;
+        } else {
+            args->cacheable = 0;
+        }
+        break;
+    }
+    case UNIFYFS_CLIENT_RPC_SYNC:
+        ret = unifyfs_fops_fsync(&ctx, gfid);
+        unifyfs_trace_span(&(ctx.trace), UNIFYFS_TRACE_RM_FSYNC, start_ns);
+        if ((ret == UNIFYFS_SUCCESS) &&
+            (reqmgr->index_sync_rc != UNIFYFS_SUCCESS)) {
+            /* report failure to consume extents in the background */
+            ret = reqmgr->index_sync_rc;
+        }
+        reqmgr->index_sync_rc = UNIFYFS_SUCCESS;
+        break;
+    case UNIFYFS_CLIENT_RPC_TRUNCATE:
+        ret = unifyfs_fops_truncate(&ctx, gfid, (size_t) args->size);
+        break;
+    case UNIFYFS_CLIENT_RPC_UNLINK:
+        /* as for the unlink rpc, first apply published extents */
+        rm_drain_client_index(reqmgr);
+        ret = unifyfs_fops_unlink(&ctx, gfid);
+        break;
+    default:
+        LOGERR("unsupported queued request type %d", (int)slot->req_type);
+        ret = UNIFYFS_ERROR_NYI;
+        break;
+    }
+
+    return ret;
+}
+
+/* handle requests the client has posted to its shared-memory request
+ * queue, in the order they were posted */
+static int rm_process_shm_requests(reqmgr_thrd_t* reqmgr)
+{
+    int ret = UNIFYFS_SUCCESS;
+
+    void* queue = reqmgr->shmq;
+    if (NULL == queue) {
+        return ret;
+    }
+
+    while (!reqmgr->exit_flag) {
+        unifyfs_shm_reqq_slot_t* slot =
+            unifyfs_shm_reqq_slot(queue, reqmgr->shmq_head);
+        uint32_t state = __atomic_load_n(&slot->state, __ATOMIC_ACQUIRE);
+        if (state != SHM_REQQ_SLOT_POSTED) {
+            /* no more requests */
+            break;
+        }
+
+        uint64_t start = unifyfs_stats_now_ns();
+        int rret = process_shm_request(reqmgr, slot);
+        unifyfs_stats_record(UNIFYFS_STAT_RM_SHM_REQUEST, start);
+        if (rret != UNIFYFS_SUCCESS) {
+            if ((rret != ENOENT) && (rret != EEXIST)) {
+                LOGERR("queued client request failed (%s)",
+                       unifyfs_rc_enum_description(rret));
+            }
+            ret = rret;
+        }
+        slot->ret = (int32_t) rret;
+
+        /* hand the result to the client, or free the slot
+         * if the client gave up waiting for it */
+        uint32_t prev = __atomic_exchange_n(&slot->state,
+                                            SHM_REQQ_SLOT_DONE,
+                                            __ATOMIC_SEQ_CST);
+        if (prev == SHM_REQQ_SLOT_ABANDONED) {
+            __atomic_store_n(&slot->state, SHM_REQQ_SLOT_FREE,
+                             __ATOMIC_RELEASE);
+        } else if (__atomic_load_n(&slot->client_waiting,
+                                   __ATOMIC_SEQ_CST)) {
+            unifyfs_shm_futex_wake(&slot->state, 1);
+        }
+        reqmgr->shmq_head++;
+    }
+
+    return ret;
+}
+
 /* Entry point for request manager thread. One thread is created
  * for each client process to retrieve remote data and notify the
  * client when data is ready.
@@ -1294,12 +1746,33 @@ void* request_manager_thread(void* arg)
      * with main thread, new items inserted by the rpc handler */
     int rc;
     while (1) {
+        /* note the request queue doorbell before looking for work,
+         * so we don't sleep through a ring that comes after */
+        uint32_t doorbell = 0;
+        unifyfs_shm_reqq_header_t* shmq_hdr = thrd_ctrl->shmq;
+        if (NULL != shmq_hdr) {
+            doorbell = __atomic_load_n(&shmq_hdr->doorbell,
+                                       __ATOMIC_SEQ_CST);
+        }
+
         /* process any client requests */
         rc = rm_process_client_requests(thrd_ctrl);
         if (rc != UNIFYFS_SUCCESS) {
             LOGWARN("failed to process client rpc requests");
         }
 
+        /* process requests from the client's request queue */
+        rc = rm_process_shm_requests(thrd_ctrl);
+        if (rc != UNIFYFS_SUCCESS) {
+            LOGWARN("failed to process queued client requests");
+        }
+
+        /* consume write index entries published by the client */
+        rc = rm_drain_client_index(thrd_ctrl);
+        if (rc != UNIFYFS_SUCCESS) {
+            LOGWARN("failed to drain client write index");
+        }
+
          /* send chunk read requests to remote servers */
         rc = rm_request_remote_chunks(thrd_ctrl);
         if (rc != UNIFYFS_SUCCESS) {
@@ -1321,21 +1794,34 @@ void* request_manager_thread(void* arg)
 
         /* release lock and wait to be signaled by dispatcher */
         //LOGDBG("RM[%d:%d] waiting for work", appid, clid);
-        struct timespec timeout;
-        clock_gettime(CLOCK_REALTIME, &timeout);
-        timeout.tv_nsec += 10000000; /* 10 ms */
-        if (timeout.tv_nsec >= 1000000000) {
-            timeout.tv_nsec -= 1000000000;
-            timeout.tv_sec++;
-        }
-        int wait_rc = pthread_cond_timedwait(&thrd_ctrl->thrd_cond,
-                                             &thrd_ctrl->thrd_lock,
-                                             &timeout);
-        if (0 == wait_rc) {
-            LOGDBG("RM[%d:%d] got work", appid, clid);
-        } else if (ETIMEDOUT != wait_rc) {
-            LOGERR("RM[%d:%d] work condition wait failed (rc=%d)",
-                   appid, clid, wait_rc);
+        if ((NULL != shmq_hdr) && (shmq_hdr == thrd_ctrl->shmq)) {
+            /* the client and our dispatchers ring the request
+             * queue doorbell when there is work */
+            RM_UNLOCK(thrd_ctrl);
+            __atomic_store_n(&shmq_hdr->server_waiting, 1,
+                             __ATOMIC_SEQ_CST);
+            unifyfs_shm_futex_wait(&shmq_hdr->doorbell, doorbell,
+                                   10000); /* 10 ms */
+            __atomic_store_n(&shmq_hdr->server_waiting, 0,
+                             __ATOMIC_SEQ_CST);
+            RM_LOCK(thrd_ctrl);
+        } else {
+            struct timespec timeout;
+            clock_gettime(CLOCK_REALTIME, &timeout);
+            timeout.tv_nsec += 10000000; /* 10 ms */
+            if (timeout.tv_nsec >= 1000000000) {
+                timeout.tv_nsec -= 1000000000;
+                timeout.tv_sec++;
+            }
+            int wait_rc = pthread_cond_timedwait(&thrd_ctrl->thrd_cond,
+                                                 &thrd_ctrl->thrd_lock,
+                                                 &timeout);
+            if (0 == wait_rc) {
+                LOGDBG("RM[%d:%d] got work", appid, clid);
+            } else if (ETIMEDOUT != wait_rc) {
+                LOGERR("RM[%d:%d] work condition wait failed (rc=%d)",
+                       appid, clid, wait_rc);
+            }
         }
 
         /* set flag to indicate we're no longer waiting */
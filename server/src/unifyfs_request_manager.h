@@ -41,6 +41,7 @@ typedef struct {
     void* input;
     void* bulk_buf;
     size_t bulk_sz;
+    uint64_t submit_ns;     /* when request was queued (for stats) */
 } client_rpc_req_t;
 
 typedef struct {
@@ -55,6 +56,8 @@ typedef struct {
     chunk_read_req_t* chunks;  /* array of chunk-reads */
     server_chunk_reads_t* remote_reads; /* per-server remote reads array */
     unifyfs_inode_extent_t extent; /* the requested extent */
+    unifyfs_trace_ctx_t trace; /* trace context of the client read */
+    uint64_t start_ns;         /* submit time, for tracing */
 } server_read_req_t;
 
 /* Request manager state structure - created by main thread for each request
@@ -101,6 +104,15 @@ typedef struct reqmgr_thrd {
 
     /* client_id this thread is serving */
     int client_id;
+
+    /* error from background consumption of the client's write index,
+     * reported to the client on its next sync */
+    int index_sync_rc;
+
+    /* client's shared-memory request queue (NULL if not used), and the
+     * number of requests we have taken from it */
+    void* shmq;
+    uint64_t shmq_head;
 } reqmgr_thrd_t;
 
 /* reserve/release read requests */
@@ -163,4 +175,14 @@ int rm_submit_read_request(server_read_req_t* req);
 int rm_submit_client_rpc_request(unifyfs_fops_ctx_t* ctx,
                                  client_rpc_req_t* req);
 
+/**
+ * @brief get the number of client rpc requests waiting for the
+ * request manager thread.
+ *
+ * @param reqmgr   request manager thread control structure
+ *
+ * @return number of queued requests
+ */
+size_t rm_get_queue_depth(reqmgr_thrd_t* reqmgr);
+
 #endif
@@ -34,13 +34,15 @@
 // common headers
 #include "unifyfs_configurator.h"
 #include "unifyfs_keyval.h"
+#include "unifyfs_stats.h"
+#include "unifyfs_trace.h"
 
 // server components
 #include "unifyfs_global.h"
 #include "unifyfs_metadata_mdhim.h"
 #include "unifyfs_request_manager.h"
 #include "unifyfs_service_manager.h"
-#include "unifyfs_inode_tree.h"
+#include "unifyfs_inode_table.h"
 
 // margo rpcs
 #include "margo_server.h"
@@ -73,6 +75,8 @@ static int CountTasksPerNode(int rank, int numTasks);
 static int find_rank_idx(int my_rank);
 #endif
 
+static void update_server_stats(void);
+
 struct unifyfs_fops* global_fops_tab;
 
 /*
@@ -323,9 +327,22 @@ int main(int argc, char* argv[])
         LOGERR("%s", unifyfs_rc_enum_description((unifyfs_rc)rc));
     }
 
+    if (server_cfg.log_async != NULL) {
+        bool enable = false;
+        rc = configurator_bool_val(server_cfg.log_async, &enable);
+        if ((0 == rc) && enable) {
+            rc = unifyfs_log_async_start();
+            if (rc != UNIFYFS_SUCCESS) {
+                LOGERR("failed to start log thread");
+            }
+        }
+    }
+
     // print config
     unifyfs_config_print(&server_cfg, unifyfs_log_stream);
 
+    unifyfs_stats_init("unifyfsd", update_server_stats);
+
     if (NULL != server_cfg.server_hostfile) {
         rc = process_servers_hostfile(server_cfg.server_hostfile);
         if (rc != (int)UNIFYFS_SUCCESS) {
@@ -397,8 +414,13 @@ int main(int argc, char* argv[])
         exit(1);
     }
 
-    /* initialize our tree that maps a gfid to its extent tree */
-    unifyfs_inode_tree_init(global_inode_tree);
+    /* initialize our table that maps a gfid to its inode */
+    rc = unifyfs_inode_table_init(global_inode_table);
+    if (rc != UNIFYFS_SUCCESS) {
+        LOGERR("failed to initialize inode table: %s",
+               unifyfs_rc_enum_description(rc));
+        exit(1);
+    }
 
     LOGDBG("publishing server pid");
     rc = unifyfs_publish_server_pids();
@@ -408,6 +430,32 @@ int main(int argc, char* argv[])
         exit(1);
     }
 
+    // periodically dump statistics
+    if (server_cfg.stats_dump_interval != NULL) {
+        long interval = 0;
+        rc = configurator_int_val(server_cfg.stats_dump_interval, &interval);
+        if ((0 == rc) && (interval > 0)) {
+            rc = unifyfs_stats_dump_start(server_cfg.stats_dump_dir,
+                                          (int)interval);
+            if (rc != UNIFYFS_SUCCESS) {
+                LOGERR("failed to start statistics dumps");
+            }
+        }
+    }
+
+    // record the stages of requests traced by clients
+    long trace_rate = 0;
+    if (server_cfg.trace_sample_rate != NULL) {
+        rc = configurator_int_val(server_cfg.trace_sample_rate, &trace_rate);
+        if (rc != 0) {
+            trace_rate = 0;
+        }
+    }
+    rc = unifyfs_trace_init("unifyfsd", (int)trace_rate, server_cfg.trace_dir);
+    if (rc != UNIFYFS_SUCCESS) {
+        LOGERR("failed to start request tracing");
+    }
+
     LOGDBG("server[%d] - finished initialization", glb_pmi_rank);
 
     while (1) {
@@ -418,8 +466,12 @@ int main(int argc, char* argv[])
         }
     }
 
-    /* tear down gfid-to-extents tree */
-    unifyfs_inode_tree_destroy(global_inode_tree);
+    /* write final statistics and traces while server state is intact */
+    unifyfs_trace_fini();
+    unifyfs_stats_dump_stop();
+
+    /* tear down gfid-to-inode table */
+    unifyfs_inode_table_destroy(global_inode_table);
 
     LOGDBG("stopping service manager thread");
     rc = svcmgr_fini();
@@ -635,6 +687,121 @@ static int unifyfs_exit(void)
     return ret;
 }
 
+/* names of rpc types for statistics */
+static const char* const client_rpc_names[] = {
+    [UNIFYFS_CLIENT_RPC_INVALID]    = "invalid",
+    [UNIFYFS_CLIENT_RPC_ATTACH]     = "attach",
+    [UNIFYFS_CLIENT_RPC_EXTENT_MAP] = "extent_map",
+    [UNIFYFS_CLIENT_RPC_FILESIZE]   = "filesize",
+    [UNIFYFS_CLIENT_RPC_LAMINATE]   = "laminate",
+    [UNIFYFS_CLIENT_RPC_METAGET]    = "metaget",
+    [UNIFYFS_CLIENT_RPC_METASET]    = "metaset",
+    [UNIFYFS_CLIENT_RPC_MOUNT]      = "mount",
+    [UNIFYFS_CLIENT_RPC_READ]       = "read",
+    [UNIFYFS_CLIENT_RPC_STAT]       = "stat",
+    [UNIFYFS_CLIENT_RPC_STAT_MANY]  = "stat_many",
+    [UNIFYFS_CLIENT_RPC_STATS]      = "stats",
+    [UNIFYFS_CLIENT_RPC_SYNC]       = "sync",
+    [UNIFYFS_CLIENT_RPC_TRANSFER]   = "transfer",
+    [UNIFYFS_CLIENT_RPC_TRUNCATE]   = "truncate",
+    [UNIFYFS_CLIENT_RPC_UNLINK]     = "unlink",
+    [UNIFYFS_CLIENT_RPC_UNMOUNT]    = "unmount"
+};
+
+static const char* const server_rpc_names[] = {
+    [UNIFYFS_SERVER_RPC_INVALID]        = "invalid",
+    [UNIFYFS_SERVER_RPC_CHUNK_READ]     = "chunk_read",
+    [UNIFYFS_SERVER_RPC_EXTENTS_ADD]    = "extents_add",
+    [UNIFYFS_SERVER_RPC_EXTENTS_FIND]   = "extents_find",
+    [UNIFYFS_SERVER_RPC_FILESIZE]       = "filesize",
+    [UNIFYFS_SERVER_RPC_LAMINATE]       = "laminate",
+    [UNIFYFS_SERVER_RPC_METAGET]        = "metaget",
+    [UNIFYFS_SERVER_RPC_METASET]        = "metaset",
+    [UNIFYFS_SERVER_RPC_PID_REPORT]     = "pid_report",
+    [UNIFYFS_SERVER_RPC_TRUNCATE]       = "truncate",
+    [UNIFYFS_SERVER_BCAST_RPC_EXTENTS]  = "bcast_extents",
+    [UNIFYFS_SERVER_BCAST_RPC_FILEATTR] = "bcast_fileattr",
+    [UNIFYFS_SERVER_BCAST_RPC_LAMINATE] = "bcast_laminate",
+    [UNIFYFS_SERVER_BCAST_RPC_TRANSFER] = "bcast_transfer",
+    [UNIFYFS_SERVER_BCAST_RPC_TRUNCATE] = "bcast_truncate",
+    [UNIFYFS_SERVER_BCAST_RPC_UNLINK]   = "bcast_unlink"
+};
+
+#define NUM_RPC_NAMES(names) ((int)(sizeof(names) / sizeof(names[0])))
+
+/* refresh the statistics gauges from the current server state */
+static void update_server_stats(void)
+{
+    static int names_set; // = 0
+    if (!names_set) {
+        unifyfs_stats_set_rpc_names(UNIFYFS_STATS_RPC_CLIENT,
+                                    client_rpc_names,
+                                    NUM_RPC_NAMES(client_rpc_names));
+        unifyfs_stats_set_rpc_names(UNIFYFS_STATS_RPC_SERVER,
+                                    server_rpc_names,
+                                    NUM_RPC_NAMES(server_rpc_names));
+        unifyfs_stats_set_rpc_names(UNIFYFS_STATS_RPC_BCAST,
+                                    server_rpc_names,
+                                    NUM_RPC_NAMES(server_rpc_names));
+        names_set = 1;
+    }
+
+    /* sum log usage and request queue depths of all clients */
+    uint64_t shmem_size = 0;
+    uint64_t shmem_used = 0;
+    uint64_t spill_size = 0;
+    uint64_t spill_used = 0;
+    uint64_t rm_depth = 0;
+    ABT_mutex_lock(app_configs_abt_sync);
+    for (int i = 0; i < MAX_NUM_APPS; i++) {
+        app_config* app = app_configs[i];
+        if (NULL == app) {
+            continue;
+        }
+        for (size_t j = 0; j < app->clients_sz; j++) {
+            app_client* client = app->clients[j];
+            if (NULL == client) {
+                continue;
+            }
+            if (NULL != client->logio) {
+                off_t mem_sz, mem_used, spill_sz, spill_usd;
+                if ((unifyfs_logio_get_sizes(client->logio, &mem_sz,
+                                             &spill_sz) == 0) &&
+                    (unifyfs_logio_get_usage(client->logio, &mem_used,
+                                             &spill_usd) == 0)) {
+                    shmem_size += (uint64_t) mem_sz;
+                    shmem_used += (uint64_t) mem_used;
+                    spill_size += (uint64_t) spill_sz;
+                    spill_used += (uint64_t) spill_usd;
+                }
+            }
+            if (NULL != client->reqmgr) {
+                rm_depth += (uint64_t) rm_get_queue_depth(client->reqmgr);
+            }
+        }
+    }
+    ABT_mutex_unlock(app_configs_abt_sync);
+
+    unifyfs_stats_set_gauge(UNIFYFS_STAT_LOGIO_SHMEM_SIZE, shmem_size);
+    unifyfs_stats_set_gauge(UNIFYFS_STAT_LOGIO_SHMEM_USED, shmem_used);
+    unifyfs_stats_set_gauge(UNIFYFS_STAT_LOGIO_SPILL_SIZE, spill_size);
+    unifyfs_stats_set_gauge(UNIFYFS_STAT_LOGIO_SPILL_USED, spill_used);
+    unifyfs_stats_set_gauge(UNIFYFS_STAT_RM_QUEUE_DEPTH, rm_depth);
+    unifyfs_stats_set_gauge(UNIFYFS_STAT_SM_QUEUE_DEPTH,
+                            (uint64_t) sm_get_queue_depth());
+
+    /* inode and extent tree sizes */
+    unifyfs_stats_set_gauge(UNIFYFS_STAT_INODES,
+        (uint64_t) unifyfs_inode_table_count(global_inode_table));
+    slab_cache_stats_t ext_stats;
+    if (unifyfs_inode_extents_mem_stats(&ext_stats) == UNIFYFS_SUCCESS) {
+        unifyfs_stats_set_gauge(UNIFYFS_STAT_EXTENTS,
+                                (uint64_t) ext_stats.used_objs);
+        unifyfs_stats_set_gauge(UNIFYFS_STAT_EXTENT_BYTES,
+                                (uint64_t) ext_stats.bytes_reserved);
+    }
+}
+
 /* get pointer to app config for this app_id */
 app_config* get_application(int app_id)
 {
@@ -775,9 +942,11 @@ static unifyfs_rc attach_to_client_shmem(app_client* client,
     int app_id = client->app_id;
     int client_id = client->client_id;
 
-    /* initialize shmem region for client's superblock */
+    /* attach to shmem region for client's superblock. the client reserves
+     * memory for the parts of it that it uses, which leaves the unused
+     * part of its file table unbacked */
     sprintf(shm_name, SHMEM_SUPER_FMTSTR, app_id, client_id);
-    shm_ctx = unifyfs_shm_alloc(shm_name, shmem_super_sz);
+    shm_ctx = unifyfs_shm_alloc_sparse(shm_name, shmem_super_sz);
     if (NULL == shm_ctx) {
         LOGERR("Failed to attach to shmem superblock region %s", shm_name);
         return UNIFYFS_ERROR_SHMEM;
@@ -861,7 +1030,9 @@ unifyfs_rc attach_app_client(app_client* client,
                              const size_t logio_shmem_size,
                              const size_t shmem_super_size,
                              const size_t super_meta_offset,
-                             const size_t super_meta_size)
+                             const size_t super_meta_size,
+                             const size_t super_reqq_offset,
+                             const size_t super_reqq_size)
 {
     if (NULL == client) {
         return EINVAL;
@@ -894,11 +1065,126 @@ unifyfs_rc attach_app_client(app_client* client,
 
     client->super_meta_offset = super_meta_offset;
     client->super_meta_size = super_meta_size;
+
+    /* only use a request queue that lies within the superblock */
+    client->super_reqq_offset = 0;
+    client->super_reqq_size = 0;
+    if (super_reqq_size != 0) {
+        if ((super_reqq_size == UNIFYFS_SHM_REQQ_SIZE) &&
+            (super_reqq_offset + super_reqq_size <= shmem_super_size)) {
+            client->super_reqq_offset = super_reqq_offset;
+            client->super_reqq_size = super_reqq_size;
+        } else {
+            LOGWARN("ignoring invalid request queue of client %d:%d",
+                    app_id, client_id);
+        }
+    }
     client->connected = 1;
 
     return UNIFYFS_SUCCESS;
 }
 
+/* get pointers to the header and slots of the client's index ring,
+ * returns the number of ring slots (0 if the client is not attached) */
+static size_t get_client_index_ring(app_client* client,
+                                    unifyfs_index_ring_t** ring,
+                                    unifyfs_index_t** slots)
+{
+    shm_context* super_ctx = client->shmem_super;
+    if ((NULL == super_ctx) || (0 == client->super_meta_size)) {
+        return 0;
+    }
+
+    /* ring header is at start of index region in superblock,
+     * with the index entries starting one page after it */
+    char* meta = (char*)(super_ctx->addr) + client->super_meta_offset;
+    *ring  = (unifyfs_index_ring_t*) meta;
+    *slots = (unifyfs_index_t*)(meta + get_page_size());
+    return client->super_meta_size / sizeof(unifyfs_index_t);
+}
+
+size_t app_client_index_pending(app_client* client)
+{
+    unifyfs_index_ring_t* ring;
+    unifyfs_index_t* slots;
+    if (0 == get_client_index_ring(client, &ring, &slots)) {
+        return 0;
+    }
+
+    uint64_t tail = unifyfs_index_ring_load(&ring->tail);
+    return (size_t)(tail - ring->head);
+}
+
+size_t app_client_index_next_run(app_client* client,
+                                 unifyfs_index_t* entries,
+                                 size_t max)
+{
+    unifyfs_index_ring_t* ring;
+    unifyfs_index_t* slots;
+    size_t n_slots = get_client_index_ring(client, &ring, &slots);
+    if (0 == n_slots) {
+        return 0;
+    }
+
+    /* only we update the head, load tail to see what client published */
+    uint64_t head = ring->head;
+    uint64_t tail = unifyfs_index_ring_load(&ring->tail);
+
+    size_t count = 0;
+    while ((head + count < tail) && (count < max)) {
+        unifyfs_index_t* idx = &slots[(head + count) % n_slots];
+        if ((count > 0) && (idx->gfid != entries[0].gfid)) {
+            break;
+        }
+        entries[count] = *idx;
+        count++;
+    }
+    return count;
+}
+
+void app_client_index_consume(app_client* client,
+                              size_t count)
+{
+    unifyfs_index_ring_t* ring;
+    unifyfs_index_t* slots;
+    if (0 == get_client_index_ring(client, &ring, &slots)) {
+        return;
+    }
+
+    /* release slots back to client, after we are done reading them */
+    unifyfs_index_ring_store(&ring->head, ring->head + count);
+}
+
+void* app_client_request_queue(app_client* client)
+{
+    shm_context* super_ctx = client->shmem_super;
+    if ((NULL == super_ctx) || (0 == client->super_reqq_size)) {
+        return NULL;
+    }
+    return (char*)(super_ctx->addr) + client->super_reqq_offset;
+}
+
+void invalidate_client_metadata_caches(void)
+{
+    ABT_mutex_lock(app_configs_abt_sync);
+    for (int i = 0; i < MAX_NUM_APPS; i++) {
+        app_config* app = app_configs[i];
+        if (NULL == app) {
+            continue;
+        }
+        for (size_t j = 0; j < app->clients_sz; j++) {
+            app_client* client = app->clients[j];
+            unifyfs_index_ring_t* ring;
+            unifyfs_index_t* slots;
+            if ((NULL != client) && client->connected &&
+                (0 != get_client_index_ring(client, &ring, &slots))) {
+                __atomic_add_fetch(&ring->meta_epoch, 1, __ATOMIC_RELEASE);
+            }
+        }
+    }
+    ABT_mutex_unlock(app_configs_abt_sync);
+}
+
 /**
  * Disconnect ephemeral client state, while maintaining access to any data
  * the client wrote.
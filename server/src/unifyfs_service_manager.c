@@ -33,6 +33,8 @@
 #include "unifyfs_request_manager.h"
 #include "unifyfs_service_manager.h"
 #include "unifyfs_server_rpcs.h"
+#include "unifyfs_stats.h"
+#include "unifyfs_trace.h"
 #include "margo_server.h"
 
 /* Service Manager (SM) state */
@@ -218,8 +220,11 @@ int sm_issue_chunk_reads(int src_rank,
                          int src_req_id,
                          int num_chks,
                          size_t total_data_sz,
-                         char* msg_buf)
+                         char* msg_buf,
+                         unifyfs_trace_ctx_t trace)
 {
+    uint64_t start_ns = unifyfs_stats_now_ns();
+
     /* get pointer to read request array */
     chunk_read_req_t* reqs = (chunk_read_req_t*)msg_buf;
 
@@ -262,6 +267,7 @@ int sm_issue_chunk_reads(int src_rank,
     scr->reqs       = NULL;
     scr->total_sz   = buf_sz;
     scr->resp       = resp;
+    scr->trace      = trace;
 
     LOGDBG("issuing %d requests for req=%d, total data size = %zu",
            num_chks, src_req_id, total_data_sz);
@@ -322,8 +328,12 @@ int sm_issue_chunk_reads(int src_rank,
         /* update to point to next slot in read reply buffer */
         buf_cursor += nbytes;
     }
+    unifyfs_trace_span(&trace, UNIFYFS_TRACE_SM_CHUNK_READS, start_ns);
 
     if (src_rank != glb_pmi_rank) {
+        unifyfs_stats_add(UNIFYFS_STAT_SERVER_READ_SERVED_BYTES,
+                          total_data_sz);
+
         /* we need to send these read responses to another rank,
          * add chunk_reads to svcmgr response list */
         LOGDBG("adding to svcmgr chunk_reads");
@@ -354,16 +364,19 @@ int sm_issue_chunk_reads(int src_rank,
     }
 }
 
-int sm_laminate(int gfid)
+int sm_laminate(int64_t gfid)
 {
     int owner_rank = hash_gfid_to_server(gfid);
     int is_owner = (owner_rank == glb_pmi_rank);
 
     int ret = unifyfs_inode_laminate(gfid);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("failed to laminate gfid=%d (rc=%d, is_owner=%d)",
+        LOGERR("failed to laminate gfid=%" PRId64 " (rc=%d, is_owner=%d)",
                gfid, ret, is_owner);
     } else if (is_owner) {
+        /* leased attributes do not say the file is laminated */
+        unifyfs_revoke_metadata_leases(gfid);
+
         /* I'm the owner, tell the rest of the servers */
         ret = unifyfs_invoke_broadcast_laminate(gfid);
         if (ret != UNIFYFS_SUCCESS) {
@@ -373,7 +386,7 @@ int sm_laminate(int gfid)
     return ret;
 }
 
-int sm_get_fileattr(int gfid,
+int sm_get_fileattr(int64_t gfid,
                     unifyfs_file_attr_t* attrs)
 {
     int owner_rank = hash_gfid_to_server(gfid);
@@ -383,14 +396,15 @@ int sm_get_fileattr(int gfid,
     int ret = unifyfs_inode_metaget(gfid, attrs);
     if (ret) {
         if (ret != ENOENT) {
-            LOGERR("failed to get attributes for gfid=%d (rc=%d, is_owner=%d)",
+            LOGERR("failed to get attributes for gfid=%"
+                   PRId64 " (rc=%d, is_owner=%d)",
                     gfid, ret, is_owner);
         }
     }
     return ret;
 }
 
-int sm_set_fileattr(int gfid,
+int sm_set_fileattr(int64_t gfid,
                     int file_op,
                     unifyfs_file_attr_t* attrs)
 {
@@ -401,32 +415,59 @@ int sm_set_fileattr(int gfid,
     int ret = unifyfs_inode_metaset(gfid, file_op, attrs);
     if (ret) {
         if ((ret == EEXIST) && (file_op == UNIFYFS_FILE_ATTR_OP_CREATE)) {
-            LOGWARN("create requested for existing gfid=%d", gfid);
+            LOGWARN("create requested for existing gfid=%" PRId64, gfid);
         } else {
-            LOGERR("failed to set attributes for gfid=%d (rc=%d, is_owner=%d)",
+            LOGERR("failed to set attributes for gfid=%"
+                   PRId64 " (rc=%d, is_owner=%d)",
                    gfid, ret, is_owner);
         }
+    } else if (is_owner && (file_op != UNIFYFS_FILE_ATTR_OP_CREATE)) {
+        /* attributes changed, revoke leases granted on them before
+         * the change is acknowledged */
+        int rc = unifyfs_revoke_metadata_leases(gfid);
+        if (rc != UNIFYFS_SUCCESS) {
+            LOGERR("failed to revoke leases for gfid=%" PRId64 " (rc=%d)",
+                   gfid, rc);
+        }
     }
     return ret;
 }
 
-int sm_add_extents(int gfid,
+int sm_add_extents(int64_t gfid,
                    size_t num_extents,
                    struct extent_tree_node* extents)
 {
     int owner_rank = hash_gfid_to_server(gfid);
     int is_owner = (owner_rank == glb_pmi_rank);
 
+    /* at the owner, note the size so we know if the extents grow it */
+    size_t old_size = 0;
+    if (is_owner) {
+        unifyfs_inode_get_filesize(gfid, &old_size);
+    }
+
     unsigned int n_extents = (unsigned int)num_extents;
     int ret = unifyfs_inode_add_extents(gfid, n_extents, extents);
     if (ret) {
-        LOGERR("failed to add %u extents to gfid=%d (rc=%d, is_owner=%d)",
+        LOGERR("failed to add %u extents to gfid=%"
+               PRId64 " (rc=%d, is_owner=%d)",
                n_extents, gfid, ret, is_owner);
+    } else if (is_owner) {
+        size_t new_size = 0;
+        unifyfs_inode_get_filesize(gfid, &new_size);
+        if (new_size != old_size) {
+            /* size changed, revoke leases granted on attributes */
+            int rc = unifyfs_revoke_metadata_leases(gfid);
+            if (rc != UNIFYFS_SUCCESS) {
+                LOGERR("failed to revoke leases for gfid=%" PRId64
+                       " (rc=%d)", gfid, rc);
+            }
+        }
     }
     return ret;
 }
 
-int sm_find_extents(int gfid,
+int sm_find_extents(int64_t gfid,
                     size_t num_extents,
                     unifyfs_inode_extent_t* extents,
                     unsigned int* out_num_chunks,
@@ -446,7 +487,7 @@ int sm_find_extents(int gfid,
                                                       out_num_chunks,
                                                       out_chunks);
             if (ret) {
-                LOGERR("failed to find extents for gfid=%d (rc=%d)",
+                LOGERR("failed to find extents for gfid=%" PRId64 " (rc=%d)",
                     gfid, ret);
             } else if (*out_num_chunks == 0) {
                 LOGDBG("extent lookup found no matching chunks");
@@ -459,7 +500,7 @@ int sm_find_extents(int gfid,
     return ret;
 }
 
-int sm_truncate(int gfid, size_t filesize)
+int sm_truncate(int64_t gfid, size_t filesize)
 {
     int owner_rank = hash_gfid_to_server(gfid);
     int is_owner = (owner_rank == glb_pmi_rank);
@@ -469,20 +510,130 @@ int sm_truncate(int gfid, size_t filesize)
     if (ret == UNIFYFS_SUCCESS) {
         /* apply truncation to local file state */
         size_t old_size = (size_t) attrs.size;
-        LOGDBG("truncate - gfid=%d size=%zu old-size=%zu",
+        LOGDBG("truncate - gfid=%" PRId64 " size=%zu old-size=%zu",
                gfid, filesize, old_size);
         int ret = unifyfs_inode_truncate(gfid, (unsigned long)filesize);
         if (ret != UNIFYFS_SUCCESS) {
-            LOGERR("truncate(gfid=%d, size=%zu) failed",
+            LOGERR("truncate(gfid=%" PRId64 ", size=%zu) failed",
                    gfid, filesize);
-        } else if (is_owner && (filesize < old_size)) {
-            /* truncate the target file at other servers */
-            ret = unifyfs_invoke_broadcast_truncate(gfid, filesize);
-            if (ret != UNIFYFS_SUCCESS) {
-                LOGERR("truncate broadcast failed");
+        } else if (is_owner) {
+            /* size changed, revoke leases granted on attributes */
+            unifyfs_revoke_metadata_leases(gfid);
+            if (filesize < old_size) {
+                /* truncate the target file at other servers */
+                ret = unifyfs_invoke_broadcast_truncate(gfid, filesize);
+                if (ret != UNIFYFS_SUCCESS) {
+                    LOGERR("truncate broadcast failed");
+                }
+            }
+        }
+    }
+    return ret;
+}
+
+/* write count bytes from buf to fd at offset, retrying short writes */
+static int transfer_write(int fd, const char* buf, size_t count, off_t offset)
+{
+    while (count > 0) {
+        ssize_t nwrite = pwrite(fd, buf, count, offset);
+        if (nwrite < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        buf += nwrite;
+        count -= (size_t) nwrite;
+        offset += (off_t) nwrite;
+    }
+    return UNIFYFS_SUCCESS;
+}
+
+int sm_transfer(int64_t gfid, const char* dst_file)
+{
+    size_t n_extents = 0;
+    struct extent_tree_node* extents = NULL;
+    int ret = unifyfs_inode_get_extents(gfid, &n_extents, &extents);
+    if (ret != UNIFYFS_SUCCESS) {
+        LOGERR("failed to get extents for gfid=%" PRId64, gfid);
+        return ret;
+    }
+
+    /* the destination file was created and sized by the server that
+     * started the transfer, so each server just writes its own data */
+    int fd = -1;
+    char* buf = NULL;
+    size_t n_bytes = 0;
+    for (size_t i = 0; i < n_extents; i++) {
+        struct extent_tree_node* ext = extents + i;
+        if (ext->svr_rank != glb_pmi_rank) {
+            /* data is held by another server */
+            continue;
+        }
+
+        if (-1 == fd) {
+            fd = open(dst_file, O_WRONLY);
+            if (-1 == fd) {
+                ret = errno;
+                LOGERR("failed to open transfer destination %s - %s",
+                       dst_file, strerror(ret));
+                break;
+            }
+            buf = malloc(MAX_STAGE_TX_SIZE);
+            if (NULL == buf) {
+                ret = ENOMEM;
+                break;
+            }
+        }
+
+        app_client* clnt = get_app_client(ext->app_id, ext->cli_id);
+        if ((NULL == clnt) || (NULL == clnt->logio)) {
+            LOGERR("missing log for app client [%d:%d]",
+                   ext->app_id, ext->cli_id);
+            ret = EINVAL;
+            break;
+        }
+
+        /* copy extent from log to the same offset in the destination */
+        size_t ext_len = (size_t)(ext->end - ext->start + 1);
+        size_t done = 0;
+        while ((ret == UNIFYFS_SUCCESS) && (done < ext_len)) {
+            size_t len = ext_len - done;
+            if (len > MAX_STAGE_TX_SIZE) {
+                len = MAX_STAGE_TX_SIZE;
+            }
+            size_t nread = 0;
+            ret = unifyfs_logio_read(clnt->logio, ext->pos + done, len,
+                                     buf, &nread);
+            if ((ret == UNIFYFS_SUCCESS) && (nread != len)) {
+                ret = EIO;
+            }
+            if (ret == UNIFYFS_SUCCESS) {
+                off_t offset = (off_t)(ext->start + done);
+                ret = transfer_write(fd, buf, len, offset);
             }
+            done += len;
+        }
+        if (ret != UNIFYFS_SUCCESS) {
+            LOGERR("failed to transfer extent [%lu, %lu] to %s (rc=%d)",
+                   ext->start, ext->end, dst_file, ret);
+            break;
+        }
+        n_bytes += ext_len;
+    }
+
+    if (-1 != fd) {
+        if ((ret == UNIFYFS_SUCCESS) && (0 != fsync(fd))) {
+            ret = errno;
+            LOGERR("fsync() of transfer destination %s failed", dst_file);
         }
+        close(fd);
     }
+    LOGDBG("transferred %zu local bytes of gfid=%" PRId64 " to %s",
+           n_bytes, gfid, dst_file);
+
+    free(buf);
+    free(extents);
     return ret;
 }
 
@@ -520,7 +671,10 @@ static int send_chunk_read_responses(void)
         server_chunk_reads_t* scr = (server_chunk_reads_t*)
             arraylist_get(chunk_reads, i);
 
+        uint64_t start_ns = unifyfs_stats_now_ns();
+        unifyfs_trace_ctx_t trace = scr->trace;
         rc = invoke_chunk_read_response_rpc(scr);
+        unifyfs_trace_span(&trace, UNIFYFS_TRACE_SM_RESPONSE_RPC, start_ns);
     }
 
     /* free the list if we have one */
@@ -548,6 +702,7 @@ int sm_submit_service_request(server_rpc_req_t* req)
         return UNIFYFS_FAILURE;
     }
 
+    req->submit_ns = unifyfs_stats_now_ns();
     SM_REQ_LOCK();
     arraylist_add(sm->svc_reqs, req);
     SM_REQ_UNLOCK();
@@ -557,6 +712,19 @@ int sm_submit_service_request(server_rpc_req_t* req)
     return UNIFYFS_SUCCESS;
 }
 
+size_t sm_get_queue_depth(void)
+{
+    size_t depth = 0;
+    if (NULL != sm) {
+        SM_REQ_LOCK();
+        if (NULL != sm->svc_reqs) {
+            depth = (size_t) arraylist_size(sm->svc_reqs);
+        }
+        SM_REQ_UNLOCK();
+    }
+    return depth;
+}
+
 static int process_chunk_read_rpc(server_rpc_req_t* req)
 {
     int ret;
@@ -569,6 +737,9 @@ static int process_chunk_read_rpc(server_rpc_req_t* req)
     int req_id      = (int)in->req_id;
     int num_chks    = (int)in->num_chks;
     size_t total_sz = (size_t)in->total_data_size;
+    unifyfs_trace_ctx_t trace = in->trace;
+
+    unifyfs_trace_span(&trace, UNIFYFS_TRACE_SM_QUEUE, req->submit_ns);
 
     LOGDBG("handling chunk read requests from server[%d]: "
            "req=%d num_chunks=%d data_sz=%zu bulk_sz=%zu",
@@ -576,7 +747,7 @@ static int process_chunk_read_rpc(server_rpc_req_t* req)
 
     ret = sm_issue_chunk_reads(src_rank, app_id, client_id,
                                req_id, num_chks, total_sz,
-                               (char*)req->bulk_buf);
+                               (char*)req->bulk_buf, trace);
 
     margo_free_input(req->handle, in);
     free(in);
@@ -601,12 +772,12 @@ static int process_add_extents_rpc(server_rpc_req_t* req)
     /* get input parameters */
     add_extents_in_t* in = req->input;
     int sender = (int) in->src_rank;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
     size_t num_extents = (size_t) in->num_extents;
     struct extent_tree_node* extents = req->bulk_buf;
 
     /* add extents */
-    LOGDBG("adding %zu extents to gfid=%d from server[%d]",
+    LOGDBG("adding %zu extents to gfid=%" PRId64 " from server[%d]",
            num_extents, gfid, sender);
     int ret = sm_add_extents(gfid, num_extents, extents);
     if (ret) {
@@ -636,18 +807,31 @@ static int process_find_extents_rpc(server_rpc_req_t* req)
     /* get input parameters */
     find_extents_in_t* in = req->input;
     int sender = (int) in->src_rank;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
     size_t num_extents = (size_t) in->num_extents;
     unifyfs_inode_extent_t* extents = req->bulk_buf;
 
-    LOGDBG("received %zu extent lookups for gfid=%d from server[%d]",
+    LOGDBG("received %zu extent lookups for gfid=%" PRId64 " from server[%d]",
            num_extents, gfid, sender);
 
-    /* find chunks for given extents */
+    /* take the extent version before the lookup, so the locations we
+     * return are at least as new as the version we report */
+    uint64_t version = 0;
+    unifyfs_inode_get_extent_version(gfid, &version);
+
+    /* find chunks for given extents, unless the sender has cached
+     * locations from a lookup at the current version */
     unsigned int num_chunks = 0;
     chunk_read_req_t* chunk_locs = NULL;
-    int ret = sm_find_extents(gfid, num_extents, extents,
+    int ret = UNIFYFS_SUCCESS;
+    uint64_t cached_version = (uint64_t) in->version;
+    if ((cached_version != 0) && (cached_version == version)) {
+        LOGDBG("cached extent locations of server[%d] are current",
+               sender);
+    } else {
+        ret = sm_find_extents(gfid, num_extents, extents,
                               &num_chunks, &chunk_locs);
+    }
 
     margo_free_input(req->handle, in);
     free(in);
@@ -677,6 +861,7 @@ static int process_find_extents_rpc(server_rpc_req_t* req)
     /* send rpc response */
     find_extents_out_t out;
     out.ret           = (int32_t) ret;
+    out.version       = (uint64_t) version;
     out.num_locations = (int32_t) num_chunks;
     out.locations     = bulk_resp_handle;
 
@@ -699,7 +884,7 @@ static int process_filesize_rpc(server_rpc_req_t* req)
 {
     /* get target file */
     filesize_in_t* in = req->input;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
     margo_free_input(req->handle, in);
     free(in);
 
@@ -726,7 +911,7 @@ static int process_laminate_rpc(server_rpc_req_t* req)
 {
     /* get target file */
     laminate_in_t* in = req->input;
-    int gfid  = (int)in->gfid;
+    int64_t gfid  = in->gfid;
     margo_free_input(req->handle, in);
     free(in);
 
@@ -747,11 +932,36 @@ static int process_laminate_rpc(server_rpc_req_t* req)
     return ret;
 }
 
+/* The owner grants a server that asks for the attributes of a file a
+ * lease on them, and revokes it once they change, so that the server
+ * can answer later requests for them itself. Laminated attributes never
+ * change and need no lease. Returns 1 if a lease was granted, in which
+ * case attrs is updated to the attributes the lease covers. */
+static int grant_metadata_lease(int64_t gfid,
+                                int src_rank,
+                                unifyfs_file_attr_t* attrs)
+{
+    if (attrs->is_laminated || (src_rank == glb_pmi_rank) ||
+        (hash_gfid_to_server(gfid) != glb_pmi_rank)) {
+        return 0;
+    }
+
+    unifyfs_file_attr_t leased;
+    int rc = unifyfs_inode_lease_grant(gfid, src_rank, glb_pmi_size,
+                                       &leased);
+    if (rc != UNIFYFS_SUCCESS) {
+        return 0;
+    }
+    *attrs = leased;
+    return 1;
+}
+
 static int process_metaget_rpc(server_rpc_req_t* req)
 {
     /* get target file */
     metaget_in_t* in = req->input;
-    int gfid  = (int) in->gfid;
+    int64_t gfid  = in->gfid;
+    int src_rank = (int) in->src_rank;
     margo_free_input(req->handle, in);
     free(in);
 
@@ -761,10 +971,15 @@ static int process_metaget_rpc(server_rpc_req_t* req)
 
     /* get metadata for target file */
     int ret = sm_get_fileattr(gfid, &attrs);
+    int leased = 0;
+    if (ret == UNIFYFS_SUCCESS) {
+        leased = grant_metadata_lease(gfid, src_rank, &attrs);
+    }
 
     /* send rpc response */
     metaget_out_t out;
     out.ret = (int32_t) ret;
+    out.leased = (int32_t) leased;
     out.attr = attrs;
     hg_return_t hret = margo_respond(req->handle, &out);
     if (hret != HG_SUCCESS) {
@@ -782,7 +997,7 @@ static int process_metaset_rpc(server_rpc_req_t* req)
 {
     /* update target file metadata */
     metaset_in_t* in = req->input;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
     int attr_op = (int) in->fileop;
     unifyfs_file_attr_t* attrs = &(in->attr);
     int ret = sm_set_fileattr(gfid, attr_op, attrs);
@@ -803,6 +1018,170 @@ static int process_metaset_rpc(server_rpc_req_t* req)
     return ret;
 }
 
+/* metaget requests and metaset requests that create a file are what a
+ * storm of opens of a shared file turns into at its owner */
+static int is_open_request(server_rpc_req_t* req)
+{
+    if (req->req_type == UNIFYFS_SERVER_RPC_METAGET) {
+        return 1;
+    } else if (req->req_type == UNIFYFS_SERVER_RPC_METASET) {
+        metaset_in_t* in = req->input;
+        return (in->fileop == (int32_t)UNIFYFS_FILE_ATTR_OP_CREATE);
+    }
+    return 0;
+}
+
+static int64_t open_request_gfid(server_rpc_req_t* req)
+{
+    if (req->req_type == UNIFYFS_SERVER_RPC_METAGET) {
+        metaget_in_t* in = req->input;
+        return in->gfid;
+    } else {
+        metaset_in_t* in = req->input;
+        return in->gfid;
+    }
+}
+
+/* respond to a metaget or create request and release it */
+static void respond_open_request(server_rpc_req_t* req,
+                                 int ret,
+                                 unifyfs_file_attr_t* attrs)
+{
+    hg_return_t hret;
+    if (req->req_type == UNIFYFS_SERVER_RPC_METAGET) {
+        metaget_in_t* in = req->input;
+        int64_t gfid = in->gfid;
+        int src_rank = (int) in->src_rank;
+        margo_free_input(req->handle, in);
+        free(in);
+
+        metaget_out_t out;
+        out.ret = (int32_t) ret;
+        out.leased = 0;
+        out.attr = *attrs;
+        if (ret == UNIFYFS_SUCCESS) {
+            out.leased = (int32_t)
+                grant_metadata_lease(gfid, src_rank, &(out.attr));
+        }
+        hret = margo_respond(req->handle, &out);
+    } else {
+        metaset_in_t* in = req->input;
+        margo_free_input(req->handle, in);
+        free(in);
+
+        metaset_out_t out;
+        out.ret = (int32_t) ret;
+        hret = margo_respond(req->handle, &out);
+    }
+    if (hret != HG_SUCCESS) {
+        LOGERR("margo_respond() failed");
+    }
+    margo_destroy(req->handle);
+}
+
+/* Process a run of metaget and create requests, svc_reqs[first, last),
+ * grouping them by file. For each file, the first create is applied and
+ * the file attributes are then looked up once. The remaining creates
+ * fail with EEXIST (or UNIFYFS_ERROR_GFID if for a different path), and
+ * the metagets are all answered with the same attributes. */
+static int process_open_requests(arraylist_t* svc_reqs,
+                                 int first,
+                                 int last)
+{
+    int ret = UNIFYFS_SUCCESS;
+    int n_reqs = last - first;
+    char* done = calloc((size_t)n_reqs, sizeof(char));
+    if (NULL == done) {
+        /* can't batch, so answer each request on its own */
+        LOGERR("failed to batch %d open requests, processing singly",
+               n_reqs);
+        for (int i = first; i < last; i++) {
+            server_rpc_req_t* req = (server_rpc_req_t*)
+                arraylist_get(svc_reqs, i);
+            if (req->req_type == UNIFYFS_SERVER_RPC_METAGET) {
+                process_metaget_rpc(req);
+            } else {
+                /* as below, only failed creates are reported */
+                int rc = process_metaset_rpc(req);
+                if ((rc != UNIFYFS_SUCCESS) && (rc != EEXIST) &&
+                    (rc != UNIFYFS_ERROR_GFID)) {
+                    ret = rc;
+                }
+            }
+        }
+        return ret;
+    }
+
+    for (int i = first; i < last; i++) {
+        if (done[i - first]) {
+            continue;
+        }
+        server_rpc_req_t* req = (server_rpc_req_t*)
+            arraylist_get(svc_reqs, i);
+        int64_t gfid = open_request_gfid(req);
+
+        /* apply the first create for this file, if there is one */
+        int create_rc = -1;
+        for (int j = i; j < last; j++) {
+            server_rpc_req_t* jreq = (server_rpc_req_t*)
+                arraylist_get(svc_reqs, j);
+            if (!done[j - first] &&
+                (jreq->req_type == UNIFYFS_SERVER_RPC_METASET) &&
+                (open_request_gfid(jreq) == gfid)) {
+                metaset_in_t* in = jreq->input;
+                create_rc = sm_set_fileattr(gfid,
+                                            UNIFYFS_FILE_ATTR_OP_CREATE,
+                                            &(in->attr));
+                respond_open_request(jreq, create_rc, NULL);
+                done[j - first] = 1;
+                break;
+            }
+        }
+        if ((create_rc != -1) && (create_rc != UNIFYFS_SUCCESS) &&
+            (create_rc != EEXIST) && (create_rc != UNIFYFS_ERROR_GFID)) {
+            ret = create_rc;
+        }
+
+        /* one lookup answers every other request for this file */
+        unifyfs_file_attr_t attrs;
+        unifyfs_file_attr_set_invalid(&attrs);
+        int get_rc = sm_get_fileattr(gfid, &attrs);
+
+        int n_answered = 0;
+        for (int j = i; j < last; j++) {
+            server_rpc_req_t* jreq = (server_rpc_req_t*)
+                arraylist_get(svc_reqs, j);
+            if (done[j - first] || (open_request_gfid(jreq) != gfid)) {
+                continue;
+            }
+            int rc = get_rc;
+            if (jreq->req_type == UNIFYFS_SERVER_RPC_METASET) {
+                metaset_in_t* in = jreq->input;
+                if (get_rc == UNIFYFS_SUCCESS) {
+                    rc = EEXIST;
+                    if ((NULL != attrs.filename) &&
+                        (NULL != in->attr.filename) &&
+                        (0 != strcmp(attrs.filename, in->attr.filename))) {
+                        rc = UNIFYFS_ERROR_GFID;
+                    }
+                } else {
+                    /* file went away, create it as usual */
+                    rc = sm_set_fileattr(gfid, UNIFYFS_FILE_ATTR_OP_CREATE,
+                                         &(in->attr));
+                }
+            }
+            respond_open_request(jreq, rc, &attrs);
+            done[j - first] = 1;
+            n_answered++;
+        }
+        LOGDBG("batched %d open requests for gfid=%" PRId64,
+               n_answered + ((create_rc != -1) ? 1 : 0), gfid);
+    }
+
+    free(done);
+    return ret;
+}
+
 static int process_server_pid_rpc(server_rpc_req_t* req)
 {
     /* get input parameters */
@@ -833,7 +1212,7 @@ static int process_truncate_rpc(server_rpc_req_t* req)
 {
     /* get target file and requested file size */
     truncate_in_t* in = req->input;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
     size_t fsize = (size_t) in->filesize;
     margo_free_input(req->handle, in);
     free(in);
@@ -859,16 +1238,16 @@ static int process_extents_bcast_rpc(server_rpc_req_t* req)
 {
     /* get target file and extents */
     extent_bcast_in_t* in = req->input;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
     size_t num_extents = (size_t) in->num_extents;
     struct extent_tree_node* extents = req->bulk_buf;
 
-    LOGDBG("gfid=%d num_extents=%zu", gfid, num_extents);
+    LOGDBG("gfid=%" PRId64 " num_extents=%zu", gfid, num_extents);
 
     /* add extents */
     int ret = sm_add_extents(gfid, num_extents, extents);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("add_extents(gfid=%d) failed - rc=%d", gfid, ret);
+        LOGERR("add_extents(gfid=%" PRId64 ") failed - rc=%d", gfid, ret);
     }
     collective_set_local_retval(req->coll, ret);
 
@@ -882,16 +1261,16 @@ static int process_fileattr_bcast_rpc(server_rpc_req_t* req)
 {
     /* get target file and attributes */
     fileattr_bcast_in_t* in = req->input;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
     int attr_op = (int) in->attrop;
     unifyfs_file_attr_t* attrs = &(in->attr);
 
-    LOGDBG("gfid=%d", gfid);
+    LOGDBG("gfid=%" PRId64, gfid);
 
     /* update file attributes */
     int ret = sm_set_fileattr(gfid, attr_op, attrs);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("set_fileattr(gfid=%d, op=%d) failed - rc=%d",
+        LOGERR("set_fileattr(gfid=%" PRId64 ", op=%d) failed - rc=%d",
                gfid, attr_op, ret);
     }
     collective_set_local_retval(req->coll, ret);
@@ -906,12 +1285,12 @@ static int process_laminate_bcast_rpc(server_rpc_req_t* req)
 {
     /* get target file and extents */
     laminate_bcast_in_t* in = req->input;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
     size_t num_extents = (size_t) in->num_extents;
     unifyfs_file_attr_t* fattr = &(in->attr);
     struct extent_tree_node* extents = req->bulk_buf;
 
-    LOGDBG("gfid=%d num_extents=%zu", gfid, num_extents);
+    LOGDBG("gfid=%" PRId64 " num_extents=%zu", gfid, num_extents);
 
     /* update inode file attributes. first check to make sure
      * inode for the gfid exists. if it doesn't, create it with
@@ -923,7 +1302,8 @@ static int process_laminate_bcast_rpc(server_rpc_req_t* req)
         fattr->is_laminated = 0;
         ret = unifyfs_inode_create(gfid, fattr);
         if (ret != UNIFYFS_SUCCESS) {
-            LOGERR("inode create during laminate(gfid=%d) failed  - rc=%d",
+            LOGERR("inode create during laminate(gfid=%"
+                   PRId64 ") failed  - rc=%d",
                    gfid, ret);
         }
         fattr->is_laminated = 1;
@@ -932,7 +1312,7 @@ static int process_laminate_bcast_rpc(server_rpc_req_t* req)
     /* add extents */
     ret = sm_add_extents(gfid, num_extents, extents);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("extent add during laminate(gfid=%d) failed - rc=%d",
+        LOGERR("extent add during laminate(gfid=%" PRId64 ") failed - rc=%d",
                gfid, ret);
         collective_set_local_retval(req->coll, ret);
     }
@@ -941,7 +1321,7 @@ static int process_laminate_bcast_rpc(server_rpc_req_t* req)
     int attr_op = UNIFYFS_FILE_ATTR_OP_LAMINATE;
     ret = sm_set_fileattr(gfid, attr_op, fattr);
     if (ret != UNIFYFS_SUCCESS) {
-        LOGERR("metaset during laminate(gfid=%d) failed - rc=%d",
+        LOGERR("metaset during laminate(gfid=%" PRId64 ") failed - rc=%d",
                gfid, ret);
         collective_set_local_retval(req->coll, ret);
     }
@@ -952,14 +1332,86 @@ static int process_laminate_bcast_rpc(server_rpc_req_t* req)
     return ret;
 }
 
+/* our part of a transfer broadcast, run in its own thread so that the
+ * service manager keeps handling other requests while the data is
+ * written out */
+typedef struct transfer_bcast_work {
+    coll_request* coll;
+    int64_t gfid;
+    const char* dst_file; /* owned by the collective's input */
+} transfer_bcast_work_t;
+
+static int transfer_bcast_local(coll_request* coll,
+                                int64_t gfid,
+                                const char* dst_file)
+{
+    /* write our local data to the destination */
+    int ret = sm_transfer(gfid, dst_file);
+    if (ret != UNIFYFS_SUCCESS) {
+        if (ret == ENOENT) {
+            /* it's ok if we have no inode, and so no data, for the file */
+            ret = UNIFYFS_SUCCESS;
+        } else {
+            LOGERR("transfer(gfid=%" PRId64 ") failed - rc=%d", gfid, ret);
+        }
+    }
+    collective_set_local_retval(coll, ret);
+
+    /* finish broadcast operation */
+    return invoke_bcast_progress_rpc(coll);
+}
+
+static void* transfer_bcast_thread(void* arg)
+{
+    transfer_bcast_work_t* work = (transfer_bcast_work_t*) arg;
+    int ret = transfer_bcast_local(work->coll, work->gfid, work->dst_file);
+    if (ret != UNIFYFS_SUCCESS) {
+        LOGERR("transfer broadcast (gfid=%" PRId64 ") failed - rc=%d",
+               work->gfid, ret);
+    }
+    free(work);
+    return NULL;
+}
+
+static int process_transfer_bcast_rpc(server_rpc_req_t* req)
+{
+    /* get target file and destination path */
+    transfer_bcast_in_t* in = req->input;
+    int64_t gfid = in->gfid;
+
+    LOGDBG("gfid=%" PRId64 " dst=%s", gfid, in->dst_file);
+
+    transfer_bcast_work_t* work = malloc(sizeof(*work));
+    if (NULL != work) {
+        work->coll = req->coll;
+        work->gfid = gfid;
+        work->dst_file = in->dst_file;
+
+        pthread_t thrd;
+        pthread_attr_t attr;
+        pthread_attr_init(&attr);
+        pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+        int rc = pthread_create(&thrd, &attr, transfer_bcast_thread, work);
+        pthread_attr_destroy(&attr);
+        if (rc == 0) {
+            return UNIFYFS_SUCCESS;
+        }
+        LOGERR("failed to create transfer thread - %s", strerror(rc));
+        free(work);
+    }
+
+    /* could not hand off the copy, so do it here */
+    return transfer_bcast_local(req->coll, gfid, in->dst_file);
+}
+
 static int process_truncate_bcast_rpc(server_rpc_req_t* req)
 {
     /* get target file and requested file size */
     truncate_bcast_in_t* in = req->input;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
     size_t fsize = (size_t) in->filesize;
 
-    LOGDBG("gfid=%d size=%zu", gfid, fsize);
+    LOGDBG("gfid=%" PRId64 " size=%zu", gfid, fsize);
 
     /* apply truncation to local file state */
     int ret = unifyfs_inode_truncate(gfid, (unsigned long)fsize);
@@ -970,7 +1422,7 @@ static int process_truncate_bcast_rpc(server_rpc_req_t* req)
             /* it's ok if inode doesn't exist at non-owners */
             ret = UNIFYFS_SUCCESS;
         } else {
-            LOGERR("truncate(gfid=%d, size=%zu) failed - rc=%d",
+            LOGERR("truncate(gfid=%" PRId64 ", size=%zu) failed - rc=%d",
                    gfid, fsize, ret);
         }
     }
@@ -986,12 +1438,15 @@ static int process_unlink_bcast_rpc(server_rpc_req_t* req)
 {
     /* get target file and requested file size */
     unlink_bcast_in_t* in = req->input;
-    int gfid = (int) in->gfid;
+    int64_t gfid = in->gfid;
 
-    LOGDBG("gfid=%d", gfid);
+    LOGDBG("gfid=%" PRId64, gfid);
 
     /* apply truncation to local file state */
     int ret = unifyfs_inode_unlink(gfid);
+
+    /* local clients may have cached the file metadata */
+    invalidate_client_metadata_caches();
     if (ret != UNIFYFS_SUCCESS) {
         /* owner is root of broadcast tree */
         int is_owner = ((int)(in->root) == glb_pmi_rank);
@@ -999,7 +1454,7 @@ static int process_unlink_bcast_rpc(server_rpc_req_t* req)
             /* it's ok if inode doesn't exist at non-owners */
             ret = UNIFYFS_SUCCESS;
         } else {
-            LOGERR("unlink(gfid=%d) failed - rc=%d", gfid, ret);
+            LOGERR("unlink(gfid=%" PRId64 ") failed - rc=%d", gfid, ret);
         }
     }
     collective_set_local_retval(req->coll, ret);
@@ -1042,7 +1497,42 @@ static int process_service_requests(void)
         int rret;
         server_rpc_req_t* req = (server_rpc_req_t*)
             arraylist_get(svc_reqs, i);
-        switch (req->req_type) {
+        server_rpc_e req_type = req->req_type;
+        uint64_t start = unifyfs_stats_now_ns();
+
+        /* answer a run of metaget/create requests together */
+        if (is_open_request(req)) {
+            int last = i + 1;
+            while ((last < num_svc_reqs) &&
+                   is_open_request(arraylist_get(svc_reqs, last))) {
+                last++;
+            }
+            if ((last - i) > 1) {
+                for (int j = i; j < last; j++) {
+                    server_rpc_req_t* oreq = arraylist_get(svc_reqs, j);
+                    unifyfs_stats_record(UNIFYFS_STAT_SM_QUEUE_WAIT,
+                                         oreq->submit_ns);
+                }
+                rret = process_open_requests(svc_reqs, i, last);
+                if (rret != UNIFYFS_SUCCESS) {
+                    LOGERR("server open requests %d-%d failed (%s)",
+                           i, last - 1, unifyfs_rc_enum_description(rret));
+                    ret = rret;
+                }
+
+                /* each request of the run was answered at the end */
+                for (int j = i; j < last; j++) {
+                    server_rpc_req_t* oreq = arraylist_get(svc_reqs, j);
+                    unifyfs_stats_record_rpc(UNIFYFS_STATS_RPC_SERVER,
+                                             (int)(oreq->req_type), start);
+                }
+                i = last - 1;
+                continue;
+            }
+        }
+
+        unifyfs_stats_record(UNIFYFS_STAT_SM_QUEUE_WAIT, req->submit_ns);
+        switch (req_type) {
         case UNIFYFS_SERVER_RPC_CHUNK_READ:
             rret = process_chunk_read_rpc(req);
             break;
@@ -1079,6 +1569,9 @@ static int process_service_requests(void)
         case UNIFYFS_SERVER_BCAST_RPC_LAMINATE:
             rret = process_laminate_bcast_rpc(req);
             break;
+        case UNIFYFS_SERVER_BCAST_RPC_TRANSFER:
+            rret = process_transfer_bcast_rpc(req);
+            break;
         case UNIFYFS_SERVER_BCAST_RPC_TRUNCATE:
             rret = process_truncate_bcast_rpc(req);
             break;
@@ -1090,6 +1583,8 @@ static int process_service_requests(void)
             rret = UNIFYFS_ERROR_NYI;
             break;
         }
+        unifyfs_stats_record_rpc(UNIFYFS_STATS_RPC_SERVER, (int)req_type,
+                                 start);
         if (rret != UNIFYFS_SUCCESS) {
             if ((rret != ENOENT) && (rret != EEXIST)) {
                 LOGERR("server rpc request %d failed (%s)",
@@ -39,6 +39,7 @@ typedef struct {
     void* input;
     void* bulk_buf;
     size_t bulk_sz;
+    uint64_t submit_ns;     /* when request was queued (for stats) */
 } server_rpc_req_t;
 
 /* service manager pthread routine */
@@ -59,6 +60,9 @@ int svcmgr_fini(void);
  */
 int sm_submit_service_request(server_rpc_req_t* req);
 
+/* get the number of server rpc requests waiting for the service manager */
+size_t sm_get_queue_depth(void);
+
 /* decode and issue chunk reads contained in message buffer */
 int sm_issue_chunk_reads(int src_rank,
                          int src_app_id,
@@ -66,30 +70,36 @@ int sm_issue_chunk_reads(int src_rank,
                          int src_req_id,
                          int num_chks,
                          size_t total_data_sz,
-                         char* msg_buf);
+                         char* msg_buf,
+                         unifyfs_trace_ctx_t trace);
 
 /* File service operations */
 
-int sm_laminate(int gfid);
+int sm_laminate(int64_t gfid);
 
-int sm_get_fileattr(int gfid,
+int sm_get_fileattr(int64_t gfid,
                     unifyfs_file_attr_t* attrs);
 
-int sm_set_fileattr(int gfid,
+int sm_set_fileattr(int64_t gfid,
                     int file_op,
                     unifyfs_file_attr_t* attrs);
 
-int sm_add_extents(int gfid,
+int sm_add_extents(int64_t gfid,
                    size_t num_extents,
                    struct extent_tree_node* extents);
 
-int sm_find_extents(int gfid,
+int sm_find_extents(int64_t gfid,
                     size_t num_extents,
                     unifyfs_inode_extent_t* extents,
                     unsigned int* out_num_chunks,
                     chunk_read_req_t** out_chunks);
 
-int sm_truncate(int gfid,
+int sm_truncate(int64_t gfid,
                 size_t filesize);
 
+/* write the data of a laminated file that is held in the logs of our
+ * local clients to the same offsets in dst_file, which must exist */
+int sm_transfer(int64_t gfid,
+                const char* dst_file);
+
 #endif // UNIFYFS_SERVICE_MANAGER_H
@@ -61,6 +61,8 @@ int main(int argc, char* argv[])
 
         api_laminate_test(unifyfs_root, &fshdl);
 
+        api_transfer_test(unifyfs_root, &fshdl);
+
         api_finalize_test(unifyfs_root, &fshdl);
     }
 
@@ -53,4 +53,8 @@ int api_write_read_sync_stat_test(char* unifyfs_root,
 int api_laminate_test(char* unifyfs_root,
                       unifyfs_handle* fshdl);
 
+/* Tests file transfer dispatch, wait, and cancel */
+int api_transfer_test(char* unifyfs_root,
+                      unifyfs_handle* fshdl);
+
 #endif /* T_CLIENT_API_SUITE_H */
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#include "client_api_suite.h"
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Tests background file transfers (stage-out), with wait and cancel */
+int api_transfer_test(char* unifyfs_root,
+                      unifyfs_handle* fshdl)
+{
+    /* file spans several transfer buffers */
+    size_t filesize = (size_t)20 * MIB;
+
+    /* Create a random file name at the mountpoint path to test, and
+     * random destination file names outside of it */
+    char testfile[64];
+    char dstfile1[64];
+    char dstfile2[64];
+    testutil_rand_path(testfile, sizeof(testfile), unifyfs_root);
+    testutil_rand_path(dstfile1, sizeof(dstfile1), "/tmp");
+    testutil_rand_path(dstfile2, sizeof(dstfile2), "/tmp");
+
+    //-------------
+
+    diag("Creating test file");
+
+    int flags = 0;
+    unifyfs_gfid gfid = UNIFYFS_INVALID_GFID;
+    int rc = unifyfs_create(*fshdl, flags, testfile, &gfid);
+    ok(rc == UNIFYFS_SUCCESS && gfid != UNIFYFS_INVALID_GFID,
+       "%s:%d unifyfs_create(%s) is successful: rc=%d (%s)",
+       __FILE__, __LINE__, testfile, rc, unifyfs_rc_enum_description(rc));
+
+    //-------------
+
+    diag("Starting API transfer tests");
+
+    /**
+     * (1) write, sync, and laminate testfile
+     * (2) transfer testfile out, and wait for it
+     * (3) check contents of transferred file
+     * (4) transfer testfile out, cancel, and wait for it
+     */
+
+    char* databuf = malloc(filesize);
+    char* readbuf = malloc(filesize);
+    if ((NULL != databuf) && (NULL != readbuf)) {
+        testutil_lipsum_generate(databuf, filesize, 0);
+
+        /* (1) write, sync, and laminate testfile */
+        unifyfs_io_request fops[2];
+        fops[0].op = UNIFYFS_IOREQ_OP_WRITE;
+        fops[0].gfid = gfid;
+        fops[0].nbytes = filesize;
+        fops[0].offset = 0;
+        fops[0].user_buf = databuf;
+        fops[1].op = UNIFYFS_IOREQ_OP_SYNC_META;
+        fops[1].gfid = gfid;
+
+        rc = unifyfs_dispatch_io(*fshdl, 2, fops);
+        ok(rc == UNIFYFS_SUCCESS,
+           "%s:%d unifyfs_dispatch_io(%s, OP_WRITE) is successful: rc=%d (%s)",
+           __FILE__, __LINE__, testfile, rc, unifyfs_rc_enum_description(rc));
+
+        rc = unifyfs_wait_io(*fshdl, 2, fops, 1);
+        ok(rc == UNIFYFS_SUCCESS,
+           "%s:%d unifyfs_wait_io(%s, OP_WRITE) is successful: rc=%d (%s)",
+           __FILE__, __LINE__, testfile, rc, unifyfs_rc_enum_description(rc));
+
+        rc = unifyfs_laminate(*fshdl, testfile);
+        ok((rc == UNIFYFS_SUCCESS),
+           "%s:%d unifyfs_laminate(%s) is successful: rc=%d (%s)",
+           __FILE__, __LINE__, testfile,
+           rc, unifyfs_rc_enum_description(rc));
+
+        /* (2) transfer testfile out, and wait for it */
+        unifyfs_transfer_request xfer;
+        memset(&xfer, 0, sizeof(xfer));
+        xfer.src_path = testfile;
+        xfer.dst_path = dstfile1;
+        xfer.mode = UNIFYFS_TRANSFER_MODE_COPY;
+        xfer.use_parallel = 0;
+
+        rc = unifyfs_dispatch_transfer(*fshdl, 1, &xfer);
+        ok(rc == UNIFYFS_SUCCESS,
+           "%s:%d unifyfs_dispatch_transfer(%s -> %s) is successful:"
+           " rc=%d (%s)", __FILE__, __LINE__, testfile, dstfile1,
+           rc, unifyfs_rc_enum_description(rc));
+
+        rc = unifyfs_wait_transfer(*fshdl, 1, &xfer, 1);
+        ok((rc == UNIFYFS_SUCCESS) &&
+           (xfer.state == UNIFYFS_IOREQ_STATE_COMPLETED) &&
+           (xfer.result.rc == UNIFYFS_SUCCESS),
+           "%s:%d unifyfs_wait_transfer(%s -> %s) is successful:"
+           " rc=%d (%s), error=%d", __FILE__, __LINE__, testfile, dstfile1,
+           rc, unifyfs_rc_enum_description(rc), xfer.result.error);
+
+        /* (3) check contents of transferred file */
+        memset(readbuf, (int)'?', filesize);
+        ssize_t nread = -1;
+        int fd = open(dstfile1, O_RDONLY);
+        if (fd >= 0) {
+            nread = pread(fd, readbuf, filesize, 0);
+            close(fd);
+        }
+        uint64_t error_offset;
+        ok((nread == (ssize_t)filesize) &&
+           (0 == testutil_lipsum_check(readbuf, (uint64_t)filesize, 0,
+                                       &error_offset)),
+           "%s:%d transferred file %s data check is successful",
+           __FILE__, __LINE__, dstfile1);
+
+        /* (4) transfer testfile out, cancel, and wait for it */
+        memset(&xfer, 0, sizeof(xfer));
+        xfer.src_path = testfile;
+        xfer.dst_path = dstfile2;
+        xfer.mode = UNIFYFS_TRANSFER_MODE_COPY;
+        xfer.use_parallel = 0;
+
+        rc = unifyfs_dispatch_transfer(*fshdl, 1, &xfer);
+        ok(rc == UNIFYFS_SUCCESS,
+           "%s:%d unifyfs_dispatch_transfer(%s -> %s) is successful:"
+           " rc=%d (%s)", __FILE__, __LINE__, testfile, dstfile2,
+           rc, unifyfs_rc_enum_description(rc));
+
+        rc = unifyfs_cancel_transfer(*fshdl, 1, &xfer);
+        ok(rc == UNIFYFS_SUCCESS,
+           "%s:%d unifyfs_cancel_transfer(%s -> %s) is successful:"
+           " rc=%d (%s)", __FILE__, __LINE__, testfile, dstfile2,
+           rc, unifyfs_rc_enum_description(rc));
+
+        /* transfer may have finished before we canceled it */
+        rc = unifyfs_wait_transfer(*fshdl, 1, &xfer, 1);
+        ok((rc == UNIFYFS_SUCCESS) &&
+           ((xfer.state == UNIFYFS_IOREQ_STATE_CANCELED) ||
+            (xfer.state == UNIFYFS_IOREQ_STATE_COMPLETED)),
+           "%s:%d unifyfs_wait_transfer(%s -> %s) after cancel is"
+           " successful: rc=%d (%s), state=%d", __FILE__, __LINE__,
+           testfile, dstfile2, rc, unifyfs_rc_enum_description(rc),
+           (int)xfer.state);
+    }
+    free(databuf);
+    free(readbuf);
+
+    diag("Finished API transfer tests");
+
+    //-------------
+
+    diag("Removing test files");
+
+    rc = unifyfs_remove(*fshdl, testfile);
+    ok(rc == UNIFYFS_SUCCESS,
+       "%s:%d unifyfs_remove(%s) is successful: rc=%d (%s)",
+       __FILE__, __LINE__, testfile, rc, unifyfs_rc_enum_description(rc));
+
+    unlink(dstfile1);
+    unlink(dstfile2);
+
+    //-------------
+
+    return 0;
+}
@@ -218,6 +218,23 @@ int api_write_read_sync_stat_test(char* unifyfs_root,
            t3_status.global_file_size, filesize,
            rc, unifyfs_rc_enum_description(rc));
 
+        /* (6b) stat all files with a single request */
+        unifyfs_gfid gfids[3] = { t1_gfid, t2_gfid, t3_gfid };
+        unifyfs_status sts[3];
+        unifyfs_rc rcs[3];
+        rc = unifyfs_stat_many(*fshdl, 3, gfids, sts, rcs);
+        ok(rc == UNIFYFS_SUCCESS,
+           "%s:%d unifyfs_stat_many() is successful: rc=%d (%s)",
+           __FILE__, __LINE__, rc, unifyfs_rc_enum_description(rc));
+        for (int i = 0; i < 3; i++) {
+            ok((rcs[i] == UNIFYFS_SUCCESS) &&
+               (sts[i].global_file_size == filesize),
+               "%s:%d unifyfs_stat_many() file %d: filesize=%zu "
+               "(expected=%zu), rc=%d (%s)", __FILE__, __LINE__, i,
+               sts[i].global_file_size, filesize,
+               rcs[i], unifyfs_rc_enum_description(rcs[i]));
+        }
+
         /* (7) read and check full contents of all files */
         memset(readbuf, (int)'?', filesize);
         unifyfs_io_request t1_reads[n_chks];
@@ -0,0 +1,144 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+/* the record encoding functions are static, so include the source */
+#include "common/src/unifyfs_log_async.c"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "t/lib/tap.h"
+#include "t/lib/testutil.h"
+
+/*
+ * Test the format string parsing and record formatting of asynchronous
+ * logging against vsnprintf()
+ */
+
+/* Record a message the way unifyfs_log_record() does, format it the way
+ * the log thread does, and check that the result matches vsnprintf() */
+static void check_format(const char* fmt, ...)
+{
+    char expected[UNIFYFS_LOG_MAX_STRING];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(expected, sizeof(expected), fmt, args);
+    va_end(args);
+
+    unifyfs_log_site_t site;
+    memset(&site, 0, sizeof(site));
+    site.fmt = fmt;
+    parse_site(&site, fmt);
+    if (LOG_SITE_READY != site.state) {
+        fail("\"%s\" can be recorded", fmt);
+        return;
+    }
+
+    log_args la;
+    va_start(args, fmt);
+    size_t size = read_args(&site, args, &la);
+    va_end(args);
+
+    char* payload = malloc(size + 8);
+    if (NULL == payload) {
+        BAIL_OUT("malloc() of record payload failed");
+    }
+    pack_args(&site, &la, payload);
+
+    char msg[UNIFYFS_LOG_MAX_STRING];
+    format_record(&site, payload, msg, sizeof(msg));
+    free(payload);
+
+    is(msg, expected, "\"%s\" round trips as \"%s\"", fmt, expected);
+}
+
+int main(int argc, char** argv)
+{
+    plan(NO_PLAN);
+
+    /* next_spec() finds each conversion and its argument type */
+    const char* next = NULL;
+    log_spec spec;
+    int rc = next_spec("gfid=%-08.3lf rest", &next, &spec);
+    ok((rc == 1) && (spec.type == LOG_ARG_DOUBLE) && (spec.len == 8) &&
+       (0 == strcmp(next, " rest")),
+       "next_spec() parses flags, width, precision, and length");
+
+    rc = next_spec("100%% done", &next, &spec);
+    ok((rc == 1) && (spec.type == 0) && (spec.len == 2) &&
+       (0 == strcmp(next, " done")),
+       "next_spec() parses %%%% with no argument");
+
+    rc = next_spec("%*.*s", &next, &spec);
+    ok((rc == 1) && (spec.type == LOG_ARG_STR) && (spec.n_stars == 2),
+       "next_spec() counts '*' width and precision arguments");
+
+    rc = next_spec("%zu %lld %hhx", &next, &spec);
+    ok((rc == 1) && (spec.type == LOG_ARG_LONG), "%%zu is a long argument");
+    rc = next_spec(next, &next, &spec);
+    ok((rc == 1) && (spec.type == LOG_ARG_LONG), "%%lld is a long argument");
+    rc = next_spec(next, &next, &spec);
+    ok((rc == 1) && (spec.type == LOG_ARG_INT), "%%hhx is an int argument");
+    rc = next_spec(next, &next, &spec);
+    ok(rc == 0, "next_spec() returns 0 at end of string");
+
+    ok(next_spec("%ls", &next, &spec) == -1, "wide strings can't be recorded");
+    ok(next_spec("%n", &next, &spec) == -1, "%%n can't be recorded");
+
+    /* parse_site() records the argument types in order */
+    unifyfs_log_site_t site;
+    memset(&site, 0, sizeof(site));
+    parse_site(&site, "%d %ld %zu %f %p %s %*d %.*s %%");
+    ok((site.state == LOG_SITE_READY) && (site.n_args == 10) &&
+       (0 == memcmp(site.arg_types, "illdpsiiis", 10)),
+       "parse_site() records argument types (n_args=%d)", site.n_args);
+
+    memset(&site, 0, sizeof(site));
+    parse_site(&site, "rank %d wrote %n bytes");
+    ok(site.state == LOG_SITE_PREFORMAT,
+       "parse_site() preformats a site it can't record");
+
+    char many[4 * (UNIFYFS_LOG_SITE_MAX_ARGS + 1) + 1];
+    many[0] = '\0';
+    for (int i = 0; i <= UNIFYFS_LOG_SITE_MAX_ARGS; i++) {
+        strcat(many, "%d, ");
+    }
+    memset(&site, 0, sizeof(site));
+    parse_site(&site, many);
+    ok(site.state == LOG_SITE_PREFORMAT,
+       "parse_site() preformats a site with too many arguments");
+
+    /* format_record() output matches vsnprintf() */
+    check_format("no arguments");
+    check_format("int %d, negative %i, char %c, hex %#x", 42, -7, 'z', 255);
+    check_format("long %ld, long long %lld, unsigned %lu", -1234567890123L,
+                 (long long)9876543210LL, 4000000000UL);
+    check_format("size_t %zu, ssize_t %zd, off_t %jd", (size_t)1 << 40,
+                 (ssize_t)-1, (intmax_t)123);
+    check_format("double %f, %.3e, %g, %8.2f|", 3.14159, 6.02e23, 0.0001,
+                 -2.5);
+    check_format("pointer %p, null %p", (void*)&site, NULL);
+    check_format("string '%s', padded '%-8s', clipped '%.3s'", "file",
+                 "ab", "abcdef");
+    check_format("star width '%*d', star precision '%.*s'", 6, 17, 2,
+                 "xyz");
+    check_format("both stars '%*.*f'", 10, 2, 1.0 / 3.0);
+    check_format("100%% of %d%%", 5);
+    check_format("mixed gfid=%d off=%zu len=%zu path=%s rc=%d (%s) t=%.6f",
+                 12, (size_t)4096, (size_t)65536, "/unifyfs/a", -2,
+                 "No such file or directory", 1.5);
+
+    done_testing();
+}
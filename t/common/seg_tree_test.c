@@ -215,7 +215,21 @@ int main(int argc, char** argv)
        "removed a range that truncated two entries, got %s",
        print_tree(tmp, &seg_tree));
 
+    /* Node memory comes from the tree's slab cache */
+    slab_cache_stats_t mem;
+    seg_tree_mem_stats(&seg_tree, &mem);
+    ok(mem.used_objs == 3, "3 nodes allocated (got %zu)", mem.used_objs);
+    ok(mem.bytes_reserved >= mem.bytes_used,
+       "reserved >= used bytes (%zu >= %zu)",
+       mem.bytes_reserved, mem.bytes_used);
+
+    /* Clearing the tree releases all node memory at once */
     seg_tree_clear(&seg_tree);
+    seg_tree_mem_stats(&seg_tree, &mem);
+    ok(mem.used_objs == 0 && mem.bytes_reserved == 0,
+       "seg_tree_clear() releases node memory (%zu nodes, %zu bytes)",
+       mem.used_objs, mem.bytes_reserved);
+
     seg_tree_destroy(&seg_tree);
 
     done_testing();
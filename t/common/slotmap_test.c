@@ -120,6 +120,32 @@ int main(int argc, char** argv)
     rc = slotmap_clear(smap);
     ok(rc == 0, "clear the slotmap");
 
+    /* reservations must stay within a map whose last use map byte
+     * is partially used */
+    size_t odd_slots = 13;
+    smap = slotmap_init(odd_slots, buf, buf_sz);
+    ok(NULL != smap, "create slot map with %zu slots", odd_slots);
+    if (NULL == smap) {
+        done_testing(); // will exit program
+    }
+    for (size_t i = 0; i < 10; i++) {
+        slotmap_reserve(smap, 1);
+    }
+    slotmap_release(smap, 0, 2);
+
+    /* five slots are free, but only three at the end of the map */
+    ssize_t slot = slotmap_reserve(smap, 4);
+    ok((-1 == slot) || (((size_t)slot + 4) <= odd_slots),
+       "reservation of 4 slots stays within %zu slots (start = %zd)",
+       odd_slots, slot);
+
+    /* an empty map can use its partially used last use map byte */
+    rc = slotmap_clear(smap);
+    ok(rc == 0, "clear the slotmap");
+    slot = slotmap_reserve(smap, 9);
+    ok(0 == slot, "reserve 9 of %zu slots in an empty map (start = %zd)",
+       odd_slots, slot);
+
     done_testing();
 }
 
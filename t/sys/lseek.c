@@ -262,6 +262,55 @@ int lseek_test(char* unifyfs_root)
 
     close(fd);
 
+    /*--- lseek() with SEEK_DATA/SEEK_HOLE on laminated file ---*/
+
+    /* Laminate file, whose data is at [0, 12) and [37, 52) */
+    errno = 0;
+    rc = chmod(path, 0444);
+    err = errno;
+    ok(rc == 0 && err == 0, "%s:%d chmod(0444): %s",
+       __FILE__, __LINE__, strerror(err));
+
+    errno = 0;
+    fd = open(path, O_RDONLY);
+    err = errno;
+    ok(fd >= 0 && err == 0, "%s:%d open(%s, O_RDONLY): %s",
+       __FILE__, __LINE__, path, strerror(err));
+
+    /* lseek to data after hole with SEEK_DATA returns start of data */
+    errno = 0;
+    rc = (int) lseek(fd, 15, SEEK_DATA);
+    err = errno;
+    ok(rc == 37 && err == 0,
+       "%s:%d lseek(15, SEEK_DATA) on laminated file: %s",
+       __FILE__, __LINE__, strerror(err));
+
+    /* lseek to first hole of file with SEEK_HOLE returns end of data */
+    errno = 0;
+    rc = (int) lseek(fd, 0, SEEK_HOLE);
+    err = errno;
+    ok(rc == 12 && err == 0,
+       "%s:%d lseek(0, SEEK_HOLE) on laminated file: %s",
+       __FILE__, __LINE__, strerror(err));
+
+    /* lseek to middle of hole with SEEK_HOLE returns offset */
+    errno = 0;
+    rc = (int) lseek(fd, 18, SEEK_HOLE);
+    err = errno;
+    ok(rc == 18 && err == 0,
+       "%s:%d lseek(18, SEEK_HOLE) on laminated file: %s",
+       __FILE__, __LINE__, strerror(err));
+
+    /* lseek to last data with SEEK_HOLE returns EOF */
+    errno = 0;
+    rc = (int) lseek(fd, 42, SEEK_HOLE);
+    err = errno;
+    ok(rc == 52 && err == 0,
+       "%s:%d lseek(42, SEEK_HOLE) on laminated file: %s",
+       __FILE__, __LINE__, strerror(err));
+
+    close(fd);
+
     /* lseek in non-open file descriptor should fail with errno=EBADF */
     errno = 0;
     rc = (int) lseek(fd, 0, SEEK_SET);
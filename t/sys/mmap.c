@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+ /*
+  * Test mmap/msync/munmap
+  */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <linux/limits.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "t/lib/tap.h"
+#include "t/lib/testutil.h"
+
+/* file is three pages, and ends half way into its last page */
+#define MMAP_TEST_PAGES 3
+
+/* This function contains the tests for UNIFYFS_WRAP(mmap),
+ * UNIFYFS_WRAP(msync), and UNIFYFS_WRAP(munmap) found in
+ * client/src/unifyfs-sysio.c.
+ *
+ * Notice the tests are ordered in a logical testing order. Changing the order
+ * or adding new tests in between two others could negatively affect the
+ * desired results. */
+int mmap_test(char* unifyfs_root)
+{
+    diag("Starting UNIFYFS_WRAP(mmap/msync/munmap) tests");
+
+    char path[64];
+    int fd = -1;
+    int err, rc;
+    char* map;
+
+    size_t page_sz = (size_t) sysconf(_SC_PAGESIZE);
+    size_t map_sz = MMAP_TEST_PAGES * page_sz;
+    size_t file_sz = map_sz - (page_sz / 2);
+    char* buf = calloc(1, map_sz);
+    char* check = calloc(1, map_sz);
+
+    testutil_rand_path(path, sizeof(path), unifyfs_root);
+    testutil_lipsum_generate(buf, file_sz, 0);
+
+    /* mmap of bad file descriptor should fail with errno=EBADF */
+    errno = 0;
+    map = mmap(NULL, map_sz, PROT_READ, MAP_PRIVATE, fd, 0);
+    err = errno;
+    ok(map == MAP_FAILED && err == EBADF,
+       "%s:%d mmap() of bad file descriptor fails (errno=%d): %s",
+       __FILE__, __LINE__, err, strerror(err));
+
+    /* Create file with known contents */
+    errno = 0;
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+    err = errno;
+    ok(fd != -1 && err == 0, "%s:%d open(%s) (fd=%d): %s",
+       __FILE__, __LINE__, path, fd, strerror(err));
+
+    errno = 0;
+    rc = (int) write(fd, buf, file_sz);
+    err = errno;
+    ok(rc == (int)file_sz && err == 0, "%s:%d write(%zu): %s",
+       __FILE__, __LINE__, file_sz, strerror(err));
+
+    /* mmap at an unaligned offset should fail with errno=EINVAL */
+    errno = 0;
+    map = mmap(NULL, map_sz, PROT_READ, MAP_PRIVATE, fd, 1);
+    err = errno;
+    ok(map == MAP_FAILED && err == EINVAL,
+       "%s:%d mmap() at unaligned offset fails (errno=%d): %s",
+       __FILE__, __LINE__, err, strerror(err));
+
+    /* Private read-only mapping has file data, zeros past the end */
+    errno = 0;
+    map = mmap(NULL, map_sz, PROT_READ, MAP_PRIVATE, fd, 0);
+    err = errno;
+    ok(map != MAP_FAILED && err == 0, "%s:%d mmap(PROT_READ): %s",
+       __FILE__, __LINE__, strerror(err));
+    if (map != MAP_FAILED) {
+        ok(memcmp(map, buf, map_sz) == 0,
+           "%s:%d mapped data matches file", __FILE__, __LINE__);
+
+        errno = 0;
+        rc = munmap(map, map_sz);
+        err = errno;
+        ok(rc == 0 && err == 0, "%s:%d munmap(): %s",
+           __FILE__, __LINE__, strerror(err));
+    }
+
+    /* Changes to shared mapping are written back on msync */
+    errno = 0;
+    map = mmap(NULL, map_sz, (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+    err = errno;
+    ok(map != MAP_FAILED && err == 0,
+       "%s:%d mmap(PROT_READ|PROT_WRITE, MAP_SHARED): %s",
+       __FILE__, __LINE__, strerror(err));
+    if (map != MAP_FAILED) {
+        memset(map + page_sz, 'a', page_sz);
+        memset(buf + page_sz, 'a', page_sz);
+
+        errno = 0;
+        rc = msync(map, map_sz, MS_SYNC);
+        err = errno;
+        ok(rc == 0 && err == 0, "%s:%d msync(): %s",
+           __FILE__, __LINE__, strerror(err));
+
+        errno = 0;
+        rc = (int) pread(fd, check, file_sz, 0);
+        err = errno;
+        ok(rc == (int)file_sz && memcmp(check, buf, file_sz) == 0,
+           "%s:%d pread() after msync() sees changes: %s",
+           __FILE__, __LINE__, strerror(err));
+
+        /* Changes are also written back on munmap */
+        memset(map, 'b', 16);
+        memset(buf, 'b', 16);
+
+        errno = 0;
+        rc = munmap(map, map_sz);
+        err = errno;
+        ok(rc == 0 && err == 0, "%s:%d munmap(): %s",
+           __FILE__, __LINE__, strerror(err));
+
+        errno = 0;
+        rc = (int) pread(fd, check, file_sz, 0);
+        err = errno;
+        ok(rc == (int)file_sz && memcmp(check, buf, file_sz) == 0,
+           "%s:%d pread() after munmap() sees changes: %s",
+           __FILE__, __LINE__, strerror(err));
+    }
+
+    /* Changes to private mapping are not written back */
+    errno = 0;
+    map = mmap(NULL, page_sz, (PROT_READ | PROT_WRITE), MAP_PRIVATE, fd, 0);
+    err = errno;
+    ok(map != MAP_FAILED && err == 0,
+       "%s:%d mmap(PROT_READ|PROT_WRITE, MAP_PRIVATE): %s",
+       __FILE__, __LINE__, strerror(err));
+    if (map != MAP_FAILED) {
+        memset(map, 'c', 16);
+        munmap(map, page_sz);
+
+        errno = 0;
+        rc = (int) pread(fd, check, 16, 0);
+        err = errno;
+        ok(rc == 16 && memcmp(check, buf, 16) == 0,
+           "%s:%d private mapping changes not written back: %s",
+           __FILE__, __LINE__, strerror(err));
+    }
+
+    rc = close(fd);
+    ok(rc == 0, "%s:%d close() worked", __FILE__, __LINE__);
+
+    /* Laminate file, and map it read-only */
+    errno = 0;
+    rc = chmod(path, 0444);
+    err = errno;
+    ok(rc == 0 && err == 0, "%s:%d chmod(0444): %s",
+       __FILE__, __LINE__, strerror(err));
+
+    /* open for writing, so that only lamination denies a writable map */
+    errno = 0;
+    fd = open(path, O_RDWR);
+    err = errno;
+    ok(fd != -1 && err == 0, "%s:%d open(%s, O_RDWR): %s",
+       __FILE__, __LINE__, path, strerror(err));
+
+    /* Shared writable mapping of laminated file should fail */
+    errno = 0;
+    map = mmap(NULL, map_sz, (PROT_READ | PROT_WRITE), MAP_SHARED, fd, 0);
+    err = errno;
+    ok(map == MAP_FAILED && err == EACCES,
+       "%s:%d writable mmap() of laminated file fails (errno=%d): %s",
+       __FILE__, __LINE__, err, strerror(err));
+
+    /* Map second page onward */
+    errno = 0;
+    map = mmap(NULL, map_sz - page_sz, PROT_READ, MAP_SHARED, fd,
+               (off_t)page_sz);
+    err = errno;
+    ok(map != MAP_FAILED && err == 0,
+       "%s:%d mmap(PROT_READ) of laminated file: %s",
+       __FILE__, __LINE__, strerror(err));
+    if (map != MAP_FAILED) {
+        ok(memcmp(map, buf + page_sz, map_sz - page_sz) == 0,
+           "%s:%d mapped data matches laminated file", __FILE__, __LINE__);
+        munmap(map, map_sz - page_sz);
+    }
+
+    close(fd);
+
+    free(check);
+    free(buf);
+
+    diag("Finished UNIFYFS_WRAP(mmap/msync/munmap) tests");
+
+    return 0;
+}
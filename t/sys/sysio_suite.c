@@ -104,6 +104,8 @@ int main(int argc, char* argv[])
 
     unlink_test(unifyfs_root);
 
+    mmap_test(unifyfs_root);
+
     chdir_test(unifyfs_root);
 
     rc = unifyfs_unmount();
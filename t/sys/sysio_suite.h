@@ -71,6 +71,10 @@ int truncate_trunc_before_sync(char* unifyfs_root);
 /* Test for UNIFYFS_WRAP(unlink) */
 int unlink_test(char* unifyfs_root);
 
+/* Tests for UNIFYFS_WRAP(mmap), UNIFYFS_WRAP(msync), and
+ * UNIFYFS_WRAP(munmap) */
+int mmap_test(char* unifyfs_root);
+
 int chdir_test(char* unifyfs_root);
 
 #endif /* SYSIO_SUITE_H */
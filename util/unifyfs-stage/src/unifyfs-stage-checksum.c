@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+/*
+ * 64-bit xxHash (XXH64), following the reference algorithm by Yann Collet
+ * (https://github.com/Cyan4973/xxHash). Digests match the reference
+ * XXH64() for the same data and seed.
+ */
+#include <config.h>
+
+#include <stdint.h>
+#include <string.h>
+
+#include "unifyfs-stage.h"
+
+#define XXH_PRIME64_1 0x9E3779B185EBCA87ULL
+#define XXH_PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define XXH_PRIME64_3 0x165667B19E3779F9ULL
+#define XXH_PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define XXH_PRIME64_5 0x27D4EB2F165667C5ULL
+
+static inline uint64_t xxh_rotl64(uint64_t x, int r)
+{
+    return (x << r) | (x >> (64 - r));
+}
+
+/* read little-endian values, without alignment requirements */
+static inline uint64_t xxh_read64(const uint8_t* p)
+{
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline uint32_t xxh_read32(const uint8_t* p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline uint64_t xxh_round(uint64_t acc, uint64_t input)
+{
+    acc += input * XXH_PRIME64_2;
+    acc = xxh_rotl64(acc, 31);
+    acc *= XXH_PRIME64_1;
+    return acc;
+}
+
+static inline uint64_t xxh_merge_round(uint64_t acc, uint64_t val)
+{
+    val = xxh_round(0, val);
+    acc ^= val;
+    acc = (acc * XXH_PRIME64_1) + XXH_PRIME64_4;
+    return acc;
+}
+
+/**
+ * @brief computes the 64-bit xxHash of a buffer
+ *
+ * @param data      input buffer
+ * @param len       length of input in bytes
+ * @param seed      hash seed
+ *
+ * @return 64-bit digest
+ */
+uint64_t unifyfs_stage_xxh64(const void* data, size_t len, uint64_t seed)
+{
+    const uint8_t* p = (const uint8_t*) data;
+    const uint8_t* end = p + len;
+    uint64_t h64;
+
+    if (len >= 32) {
+        const uint8_t* limit = end - 32;
+        uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+        uint64_t v2 = seed + XXH_PRIME64_2;
+        uint64_t v3 = seed;
+        uint64_t v4 = seed - XXH_PRIME64_1;
+
+        do {
+            v1 = xxh_round(v1, xxh_read64(p));
+            v2 = xxh_round(v2, xxh_read64(p + 8));
+            v3 = xxh_round(v3, xxh_read64(p + 16));
+            v4 = xxh_round(v4, xxh_read64(p + 24));
+            p += 32;
+        } while (p <= limit);
+
+        h64 = xxh_rotl64(v1, 1) + xxh_rotl64(v2, 7) +
+              xxh_rotl64(v3, 12) + xxh_rotl64(v4, 18);
+        h64 = xxh_merge_round(h64, v1);
+        h64 = xxh_merge_round(h64, v2);
+        h64 = xxh_merge_round(h64, v3);
+        h64 = xxh_merge_round(h64, v4);
+    } else {
+        h64 = seed + XXH_PRIME64_5;
+    }
+
+    h64 += (uint64_t) len;
+
+    while ((p + 8) <= end) {
+        uint64_t k1 = xxh_round(0, xxh_read64(p));
+        h64 ^= k1;
+        h64 = (xxh_rotl64(h64, 27) * XXH_PRIME64_1) + XXH_PRIME64_4;
+        p += 8;
+    }
+
+    if ((p + 4) <= end) {
+        h64 ^= (uint64_t)xxh_read32(p) * XXH_PRIME64_1;
+        h64 = (xxh_rotl64(h64, 23) * XXH_PRIME64_2) + XXH_PRIME64_3;
+        p += 4;
+    }
+
+    while (p < end) {
+        h64 ^= (*p) * XXH_PRIME64_5;
+        h64 = xxh_rotl64(h64, 11) * XXH_PRIME64_1;
+        p++;
+    }
+
+    /* avalanche */
+    h64 ^= h64 >> 33;
+    h64 *= XXH_PRIME64_2;
+    h64 ^= h64 >> 29;
+    h64 *= XXH_PRIME64_3;
+    h64 ^= h64 >> 32;
+
+    return h64;
+}
+
+/**
+ * @brief combines per-chunk digests into the digest of the whole file
+ *
+ * Starting from a seed derived from the file size, each chunk digest (as
+ * little-endian bytes, in chunk order) is hashed with the running digest
+ * as its seed. Since this only depends on the chunk digests, chunks can
+ * be hashed by different processes and combined afterwards.
+ *
+ * @param chunk_digests     digest of each chunk, in file order
+ * @param n_chunks          number of chunks
+ * @param file_size         size of the file in bytes
+ *
+ * @return 64-bit digest of the file
+ */
+uint64_t unifyfs_stage_combine_digests(const uint64_t* chunk_digests,
+                                       size_t n_chunks,
+                                       uint64_t file_size)
+{
+    uint64_t h64 = file_size + XXH_PRIME64_5;
+    uint8_t le[8];
+
+    for (size_t i = 0; i < n_chunks; i++) {
+        for (int b = 0; b < 8; b++) {
+            le[b] = (uint8_t)(chunk_digests[i] >> (8 * b));
+        }
+        h64 = unifyfs_stage_xxh64(le, sizeof(le), h64);
+    }
+
+    return h64;
+}
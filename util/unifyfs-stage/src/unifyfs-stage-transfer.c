@@ -16,6 +16,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <errno.h>
 #include <ctype.h>
@@ -30,133 +31,63 @@
 #include <getopt.h>
 #include <time.h>
 #include <mpi.h>
-#include <openssl/md5.h>
 
 #include "unifyfs-stage.h"
 
-/**
- * @brief Run md5 checksum on specified file, send back
- *        digest.
- *
- * @param path      path to the target file
- * @param digest    hash of the file
- *
- * @return 0 on success, errno otherwise
- */
-static int md5_checksum(const char* path, unsigned char* digest)
+/* read count bytes at offset into buf, returns 0 or errno */
+static int stage_pread_full(int fd, char* buf, size_t count, off_t offset)
 {
-    int ret = 0;
-    size_t len = 0;
-    int fd = -1;
-    unsigned char data[UNIFYFS_STAGE_MD5_BLOCKSIZE] = { 0, };
-    MD5_CTX md5;
-
-    fd = open(path, O_RDONLY);
-    if (fd < 0) {
-        perror("open");
-        return errno;
-    }
-
-    ret = MD5_Init(&md5);
-    if (!ret) {
-        fprintf(stderr, "failed to create md5 context\n");
-        goto out;
-    }
-
-    while ((len = read(fd, (void*) data, UNIFYFS_STAGE_MD5_BLOCKSIZE)) != 0) {
-        ret = MD5_Update(&md5, data, len);
-        if (!ret) {
-            fprintf(stderr, "failed to update checksum\n");
-            goto out;
+    size_t done = 0;
+    while (done < count) {
+        ssize_t n = pread(fd, buf + done, count - done,
+                          offset + (off_t)done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        } else if (n == 0) {
+            /* file is shorter than expected */
+            return EIO;
         }
+        done += (size_t) n;
     }
-
-    ret = MD5_Final(digest, &md5);
-    if (!ret) {
-        fprintf(stderr, "failed to finalize md5\n");
-    }
-
-out:
-    /* MD5_xx returns 1 for success */
-    ret = (ret == 1 ? 0 : EIO);
-    close(fd);
-
-    return ret;
+    return 0;
 }
 
-/**
- * @brief prints md5 checksum into string
- *
- * @param buf       buffer to print into
- * @param digest    hash of the file
- *
- * @return buffer that has been printed to
- */
-static char* checksum_str(char* buf, unsigned char* digest)
+/* write count bytes from buf at offset, returns 0 or errno */
+static int stage_pwrite_full(int fd, const char* buf, size_t count,
+                             off_t offset)
 {
-    int i = 0;
-    char* pos = buf;
-
-    for (i = 0; i < MD5_DIGEST_LENGTH; i++) {
-        pos += sprintf(pos, "%02x", digest[i]);
+    size_t done = 0;
+    while (done < count) {
+        ssize_t n = pwrite(fd, buf + done, count - done,
+                           offset + (off_t)done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno;
+        }
+        done += (size_t) n;
     }
-
-    pos[0] = '\0';
-
-    return buf;
+    return 0;
 }
 
-/**
- * @brief takes check sums of two files and compares
- *
- * @param src     path to one file
- * @param dst     path to the other file
- *
- * @return 0 if files are identical, non-zero if not, or other error
- */
-static int verify_checksum(const char* src, const char* dst)
+/* returns the largest error code of all processes in comm */
+static int stage_agree(int err, MPI_Comm comm)
 {
-    int ret = 0;
-    int i = 0;
-    char md5src[2 * MD5_DIGEST_LENGTH + 1] = { 0, };
-    char md5dst[2 * MD5_DIGEST_LENGTH + 1] = { 0, };
-    unsigned char src_digest[MD5_DIGEST_LENGTH + 1] = { 0, };
-    unsigned char dst_digest[MD5_DIGEST_LENGTH + 1] = { 0, };
-
-    src_digest[MD5_DIGEST_LENGTH] = '\0';
-    dst_digest[MD5_DIGEST_LENGTH] = '\0';
-
-    ret = md5_checksum(src, src_digest);
-    if (ret) {
-        fprintf(stderr, "failed to calculate checksum for %s (%s)\n",
-                src, strerror(ret));
-        return ret;
-    }
-
-    ret = md5_checksum(dst, dst_digest);
-    if (ret) {
-        fprintf(stderr, "failed to calculate checksum for %s (%s)\n",
-                dst, strerror(ret));
-        return ret;
-    }
-
-    if (verbose) {
-        printf("[%d] src: %s, dst: %s\n", rank,
-               checksum_str(md5src, src_digest),
-               checksum_str(md5dst, dst_digest));
-    }
-
-    for (i = 0; i < MD5_DIGEST_LENGTH; i++) {
-        if (src_digest[i] != dst_digest[i]) {
-            fprintf(stderr, "[%d] checksum verification failed: "
-                    "(src=%s, dst=%s)\n", rank,
-                    checksum_str(md5src, src_digest),
-                    checksum_str(md5dst, dst_digest));
-            ret = EIO;
-        }
-    }
+    int max_err = 0;
+    MPI_Allreduce(&err, &max_err, 1, MPI_INT, MPI_MAX, comm);
+    return max_err;
+}
 
-    return ret;
+/* returns 1 if path is in the unifyfs volume mounted at mountpoint */
+static int stage_path_in_unifyfs(const char* path, const char* mountpoint)
+{
+    size_t len = strlen(mountpoint);
+    return (0 == strncmp(path, mountpoint, len)) &&
+           (('/' == path[len]) || ('\0' == path[len]));
 }
 
 /*
@@ -258,122 +189,573 @@ unifyfs_parse_manifest_line(char* line, char** src, char** dest)
     return rc;
 }
 
-/**
- * @brief controls the action of the stage-in or stage-out.  Opens up
- *        the manifest file, sends each line to be parsed, and fires
- *        each source/destination to be staged.
- *
- * @param ctx     stage context and instructions
+/*
+ * Staging scheduler
  *
- * @return 0 indicates success, non-zero is error
+ * All processes read the manifest, and the sources are stat'ed up front
+ * (each process stats a share of them) so that every process knows every
+ * file size. The files are then cut into work units: a whole file, or in
+ * parallel mode, UNIFYFS_STAGE_SPLIT_SIZE pieces of a file that is larger
+ * than that. Units are assigned largest first to the least loaded
+ * process, which every process computes the same way. Each process then
+ * claims units from the front of its own queue through an atomic counter
+ * in an MPI window, and once its queue is empty, claims units left in the
+ * queues of other processes in the same way.
  */
-int unifyfs_stage_transfer(unifyfs_stage_t* ctx)
+
+typedef struct {
+    char* src;
+    char* dst;
+    uint64_t size;
+    uint64_t mode;
+    uint64_t first_chunk;   /* index of first chunk in digest arrays */
+} stage_file_t;
+
+typedef struct {
+    uint64_t file;          /* index in file list */
+    uint64_t offset;
+    uint64_t length;
+} stage_unit_t;
+
+typedef struct {
+    unifyfs_stage_t* ctx;
+    size_t n_files;
+    stage_file_t* files;
+    size_t n_units;
+    stage_unit_t* units;
+    size_t* queue_start;    /* queue of rank r is units in sched order */
+    size_t* queue_count;    /* [queue_start[r], +queue_count[r]) */
+    size_t* sched;          /* unit indices grouped by rank */
+    uint64_t n_chunks;      /* total chunks of all files */
+    uint64_t* digests;      /* source digests, then destination digests */
+    char* buf;
+} stage_plan_t;
+
+/* read the manifest into the list of files, returns 0 or errno */
+static int stage_read_manifest(stage_plan_t* plan)
 {
     int ret = 0;
-    int count = 0;
-    FILE* fp = NULL;
+    size_t max_files = 0;
     char* src = NULL;
     char* dst = NULL;
     char linebuf[LINE_MAX] = { 0, };
 
-    if (!ctx) {
-        return EINVAL;
-    }
-
-    fp = fopen(ctx->manifest_file, "r");
+    FILE* fp = fopen(plan->ctx->manifest_file, "r");
     if (!fp) {
-        fprintf(stderr, "failed to open file %s: %s\n",
-                ctx->manifest_file, strerror(errno));
         ret = errno;
-        goto out;
+        fprintf(stderr, "failed to open file %s: %s\n",
+                plan->ctx->manifest_file, strerror(ret));
+        return ret;
     }
 
     while (NULL != fgets(linebuf, LINE_MAX - 1, fp)) {
         if (strlen(linebuf) < 5) {
             if (linebuf[0] == '\n') {
                 // manifest file ends in a blank line
-                goto out;
+                break;
             } else {
                 fprintf(stderr, "Short (bad) manifest file line: >%s<\n",
                         linebuf);
-                ret = -EINVAL;
-                goto out;
+                ret = EINVAL;
+                break;
             }
         }
         ret = unifyfs_parse_manifest_line(linebuf, &src, &dst);
-        if (ret < 0) {
-            fprintf(stderr, "failed to parse %s (%s)\n",
-                    linebuf, strerror(ret));
-            goto out;
+        if (ret) {
+            fprintf(stderr, "failed to parse %s\n", linebuf);
+            ret = EINVAL;
+            break;
+        }
+        if (NULL == src) {
+            /* whitespace only */
+            continue;
         }
-        if (ctx->mode == UNIFYFS_STAGE_SERIAL) {
-            if (count % total_ranks == rank) {
-                if (verbose) {
-                    fprintf(stdout, "[%d] serial transfer: src=%s, dst=%s\n",
-                            rank, src, dst);
-                }
 
-                ret = unifyfs_transfer_file_serial(src, dst);
-                if (ret) {
-                    fprintf(stderr, "[%d] failed to transfer file (err=%d)\n",
-                            rank, -ret);
-                    goto out;
-                }
+        if (plan->n_files == max_files) {
+            size_t new_max = max_files ? (2 * max_files) : 64;
+            stage_file_t* tmp = realloc(plan->files,
+                                        new_max * sizeof(stage_file_t));
+            if (NULL == tmp) {
+                free(src);
+                free(dst);
+                ret = ENOMEM;
+                break;
+            }
+            plan->files = tmp;
+            max_files = new_max;
+        }
+        stage_file_t* file = plan->files + plan->n_files;
+        memset(file, 0, sizeof(*file));
+        file->src = src;
+        file->dst = dst;
+        plan->n_files++;
+    }
 
-                if (ret < 0) {
-                    fprintf(stderr, "stat on %s failed (err=%d, %s)\n",
-                            dst, errno, strerror(errno));
-                    ret = errno;
-                    goto out;
-                }
+    fclose(fp);
+    return ret;
+}
 
-                if (ctx->checksum) {
-                    ret = verify_checksum(src, dst);
-                    if (ret) {
-                        fprintf(stderr, "checksums for >%s< and >%s< differ!\n",
-                                src, dst);
-                        goto out;
-                    }
-                }
-            }
+/* stat a share of the sources on each process, and share the sizes and
+ * modes with all processes */
+static int stage_stat_sources(stage_plan_t* plan)
+{
+    int ret = 0;
+    size_t n = plan->n_files;
+    uint64_t* info = calloc((2 * n) + 1, sizeof(uint64_t));
+    if (NULL == info) {
+        ret = ENOMEM;
+    }
+
+    for (size_t i = rank; !ret && (i < n); i += total_ranks) {
+        struct stat sb;
+        if (stat(plan->files[i].src, &sb) < 0) {
+            ret = errno;
+            fprintf(stderr, "[%d] stat on %s failed (%s)\n",
+                    rank, plan->files[i].src, strerror(ret));
+            break;
+        }
+        info[2 * i] = (uint64_t) sb.st_size;
+        info[(2 * i) + 1] = (uint64_t) sb.st_mode;
+    }
+
+    ret = stage_agree(ret, MPI_COMM_WORLD);
+    if (ret) {
+        free(info);
+        return ret;
+    }
+
+    MPI_Allreduce(MPI_IN_PLACE, info, (int)(2 * n), MPI_UINT64_T,
+                  MPI_SUM, MPI_COMM_WORLD);
+
+    uint64_t n_chunks = 0;
+    for (size_t i = 0; i < n; i++) {
+        stage_file_t* file = plan->files + i;
+        file->size = info[2 * i];
+        file->mode = info[(2 * i) + 1];
+        file->first_chunk = n_chunks;
+        n_chunks += (file->size + UNIFYFS_STAGE_CHUNK_SIZE - 1) /
+                    UNIFYFS_STAGE_CHUNK_SIZE;
+    }
+    plan->n_chunks = n_chunks;
+
+    free(info);
+    return 0;
+}
+
+/* create each destination at its final size, on a share of processes */
+static int stage_create_destinations(stage_plan_t* plan)
+{
+    int ret = 0;
+    for (size_t i = rank; i < plan->n_files; i += total_ranks) {
+        stage_file_t* file = plan->files + i;
+        int fd = open(file->dst, O_CREAT | O_WRONLY | O_TRUNC,
+                      (mode_t) file->mode);
+        if (fd < 0) {
+            ret = errno;
         } else {
-            if (verbose) {
-                fprintf(stdout, "[%d] parallel transfer: src=%s, dst=%s\n",
-                        rank, src, dst);
+            if (ftruncate(fd, (off_t) file->size) < 0) {
+                ret = errno;
             }
+            close(fd);
+        }
+        if (ret) {
+            fprintf(stderr, "[%d] failed to create %s (%s)\n",
+                    rank, file->dst, strerror(ret));
+            break;
+        }
+    }
+    return stage_agree(ret, MPI_COMM_WORLD);
+}
+
+/* larger units first, ties in file order */
+static int compare_units(const void* a, const void* b)
+{
+    const stage_unit_t* ua = a;
+    const stage_unit_t* ub = b;
+    if (ua->length != ub->length) {
+        return (ua->length > ub->length) ? -1 : 1;
+    }
+    if (ua->file != ub->file) {
+        return (ua->file < ub->file) ? -1 : 1;
+    }
+    if (ua->offset != ub->offset) {
+        return (ua->offset < ub->offset) ? -1 : 1;
+    }
+    return 0;
+}
+
+/* cut files into units and assign them to processes, largest first to
+ * the least loaded process */
+static int stage_schedule(stage_plan_t* plan)
+{
+    int parallel = (plan->ctx->mode == UNIFYFS_STAGE_PARALLEL);
+    size_t max_units = 0;
+    for (size_t i = 0; i < plan->n_files; i++) {
+        uint64_t size = plan->files[i].size;
+        if (parallel && (size > UNIFYFS_STAGE_SPLIT_SIZE)) {
+            max_units += (size + UNIFYFS_STAGE_SPLIT_SIZE - 1) /
+                         UNIFYFS_STAGE_SPLIT_SIZE;
+        } else if (size > 0) {
+            max_units++;
+        }
+    }
 
-            MPI_Barrier(MPI_COMM_WORLD);
+    plan->units = calloc(max_units + 1, sizeof(stage_unit_t));
+    plan->sched = calloc(max_units + 1, sizeof(size_t));
+    plan->queue_start = calloc(total_ranks, sizeof(size_t));
+    plan->queue_count = calloc(total_ranks, sizeof(size_t));
+    uint64_t* load = calloc(total_ranks, sizeof(uint64_t));
+    int* owner = calloc(max_units + 1, sizeof(int));
+    if ((NULL == plan->units) || (NULL == plan->sched) ||
+        (NULL == plan->queue_start) || (NULL == plan->queue_count) ||
+        (NULL == load) || (NULL == owner)) {
+        free(load);
+        free(owner);
+        return ENOMEM;
+    }
 
-            ret = unifyfs_transfer_file_parallel(src, dst);
-            if (ret) {
-                fprintf(stderr, "[%d] failed to transfer file (err=%d)\n",
-                        rank, -ret);
-                goto out;
+    /* empty files need nothing beyond being created */
+    size_t n_units = 0;
+    for (size_t i = 0; i < plan->n_files; i++) {
+        uint64_t size = plan->files[i].size;
+        uint64_t unit_size = size;
+        if (parallel && (size > UNIFYFS_STAGE_SPLIT_SIZE)) {
+            unit_size = UNIFYFS_STAGE_SPLIT_SIZE;
+        }
+        for (uint64_t off = 0; off < size; off += unit_size) {
+            stage_unit_t* unit = plan->units + n_units++;
+            unit->file = i;
+            unit->offset = off;
+            unit->length = unit_size;
+            if ((off + unit_size) > size) {
+                unit->length = size - off;
             }
+        }
+    }
+    plan->n_units = n_units;
 
-            MPI_Barrier(MPI_COMM_WORLD);
+    qsort(plan->units, n_units, sizeof(stage_unit_t), compare_units);
 
-            if (ctx->checksum && 0 == rank) {
-                ret = verify_checksum(src, dst);
-                if (ret) {
-                    goto out;
-                }
+    for (size_t u = 0; u < n_units; u++) {
+        int min_rank = 0;
+        for (int r = 1; r < total_ranks; r++) {
+            if (load[r] < load[min_rank]) {
+                min_rank = r;
             }
         }
+        owner[u] = min_rank;
+        load[min_rank] += plan->units[u].length;
+        plan->queue_count[min_rank]++;
+    }
 
-        count++;
+    /* group unit indices by owner, keeping largest first in each queue */
+    size_t start = 0;
+    for (int r = 0; r < total_ranks; r++) {
+        plan->queue_start[r] = start;
+        start += plan->queue_count[r];
+        plan->queue_count[r] = 0;
     }
-out:
+    for (size_t u = 0; u < n_units; u++) {
+        int r = owner[u];
+        plan->sched[plan->queue_start[r] + plan->queue_count[r]++] = u;
+    }
+
+    if (verbose) {
+        printf("[%d] scheduled %zu units, %" PRIu64 " bytes\n",
+               rank, plan->queue_count[rank], load[rank]);
+    }
+
+    free(load);
+    free(owner);
+    return 0;
+}
+
+/* copy one unit, hashing its chunks when checksums are enabled */
+static int stage_copy_unit(stage_plan_t* plan, stage_unit_t* unit)
+{
+    int ret = 0;
+    stage_file_t* file = plan->files + unit->file;
+    int checksum = plan->ctx->checksum;
+
+    int fd_src = open(file->src, O_RDONLY);
+    if (fd_src < 0) {
+        ret = errno;
+        fprintf(stderr, "[%d] failed to open %s (%s)\n",
+                rank, file->src, strerror(ret));
+        return ret;
+    }
+    int fd_dst = open(file->dst, (checksum ? O_RDWR : O_WRONLY));
+    if (fd_dst < 0) {
+        ret = errno;
+        fprintf(stderr, "[%d] failed to open %s (%s)\n",
+                rank, file->dst, strerror(ret));
+        close(fd_src);
+        return ret;
+    }
+
+    /* units start on chunk boundaries */
+    uint64_t end = unit->offset + unit->length;
+    uint64_t* src_digests = plan->digests + file->first_chunk;
+    for (uint64_t off = unit->offset; off < end;
+         off += UNIFYFS_STAGE_CHUNK_SIZE) {
+        size_t len = UNIFYFS_STAGE_CHUNK_SIZE;
+        if ((off + len) > end) {
+            len = (size_t)(end - off);
+        }
+
+        ret = stage_pread_full(fd_src, plan->buf, len, (off_t)off);
+        if (ret) {
+            break;
+        }
+        if (checksum) {
+            src_digests[off / UNIFYFS_STAGE_CHUNK_SIZE] =
+                unifyfs_stage_xxh64(plan->buf, len, 0);
+        }
+
+        ret = stage_pwrite_full(fd_dst, plan->buf, len, (off_t)off);
+        if (ret) {
+            break;
+        }
+    }
+
+    if (!ret && (fsync(fd_dst) < 0)) {
+        ret = errno;
+    }
+
+    /* read back what we wrote to hash the destination */
+    uint64_t* dst_digests = src_digests + plan->n_chunks;
+    for (uint64_t off = unit->offset; checksum && !ret && (off < end);
+         off += UNIFYFS_STAGE_CHUNK_SIZE) {
+        size_t len = UNIFYFS_STAGE_CHUNK_SIZE;
+        if ((off + len) > end) {
+            len = (size_t)(end - off);
+        }
+
+        memset(plan->buf, 0, len);
+        ret = stage_pread_full(fd_dst, plan->buf, len, (off_t)off);
+        if (!ret) {
+            dst_digests[off / UNIFYFS_STAGE_CHUNK_SIZE] =
+                unifyfs_stage_xxh64(plan->buf, len, 0);
+        }
+    }
+
     if (ret) {
-        fprintf(stderr, "failed to transfer file (src=%s, dst=%s): %s\n",
-                src, dst, strerror(ret));
+        fprintf(stderr, "[%d] failed to copy %s to %s (%s)\n",
+                rank, file->src, file->dst, strerror(ret));
+    }
+
+    close(fd_dst);
+    close(fd_src);
+    return ret;
+}
+
+/* claim the next unit from the queue of the given rank, returns 1 and
+ * sets *unit_ndx if there was one */
+static int stage_claim_unit(stage_plan_t* plan, MPI_Win win, int target,
+                            size_t* unit_ndx)
+{
+    int64_t one = 1;
+    int64_t next = 0;
+
+    if (0 == plan->queue_count[target]) {
+        return 0;
+    }
+
+    MPI_Fetch_and_op(&one, &next, MPI_INT64_T, target, 0, MPI_SUM, win);
+    MPI_Win_flush(target, win);
+    if ((size_t)next >= plan->queue_count[target]) {
+        return 0;
+    }
+    *unit_ndx = plan->sched[plan->queue_start[target] + (size_t)next];
+    return 1;
+}
+
+/* copy units from our queue, then help other ranks with theirs */
+static int stage_run(stage_plan_t* plan)
+{
+    int ret = 0;
+    int64_t* counter = NULL;
+    MPI_Win win;
+
+    MPI_Win_allocate(sizeof(int64_t), sizeof(int64_t), MPI_INFO_NULL,
+                     MPI_COMM_WORLD, &counter, &win);
+    *counter = 0;
+    MPI_Barrier(MPI_COMM_WORLD);
+    MPI_Win_lock_all(0, win);
+
+    size_t n_own = 0;
+    size_t n_stolen = 0;
+    uint64_t n_bytes = 0;
+    for (int i = 0; !ret && (i < total_ranks); i++) {
+        int target = (rank + i) % total_ranks;
+        size_t u;
+        while (!ret && stage_claim_unit(plan, win, target, &u)) {
+            ret = stage_copy_unit(plan, plan->units + u);
+            n_bytes += plan->units[u].length;
+            if (target == rank) {
+                n_own++;
+            } else {
+                n_stolen++;
+            }
+        }
     }
 
-    if (fp) {
-        fclose(fp);
-        fp = NULL;
+    MPI_Win_unlock_all(win);
+
+    if (verbose) {
+        printf("[%d] copied %zu own units, %zu stolen units, "
+               "%" PRIu64 " bytes\n", rank, n_own, n_stolen, n_bytes);
     }
 
+    /* everyone must be done before the window goes away */
+    ret = stage_agree(ret, MPI_COMM_WORLD);
+    MPI_Win_free(&win);
     return ret;
 }
 
+/* combine the chunk digests of each file and compare them */
+static int stage_verify(stage_plan_t* plan)
+{
+    int ret = 0;
+
+    MPI_Allreduce(MPI_IN_PLACE, plan->digests, (int)(2 * plan->n_chunks),
+                  MPI_UINT64_T, MPI_SUM, MPI_COMM_WORLD);
+
+    for (size_t i = 0; i < plan->n_files; i++) {
+        stage_file_t* file = plan->files + i;
+        uint64_t n_chunks = (file->size + UNIFYFS_STAGE_CHUNK_SIZE - 1) /
+                            UNIFYFS_STAGE_CHUNK_SIZE;
+        uint64_t* src_digests = plan->digests + file->first_chunk;
+        uint64_t* dst_digests = src_digests + plan->n_chunks;
+        uint64_t src_digest = unifyfs_stage_combine_digests(src_digests,
+                                                            n_chunks,
+                                                            file->size);
+        uint64_t dst_digest = unifyfs_stage_combine_digests(dst_digests,
+                                                            n_chunks,
+                                                            file->size);
+
+        if (verbose && (0 == rank)) {
+            printf("[%d] %s: src: %016" PRIx64 ", dst: %016" PRIx64 "\n",
+                   rank, file->dst, src_digest, dst_digest);
+        }
+        if (src_digest != dst_digest) {
+            if (0 == rank) {
+                fprintf(stderr, "[%d] checksum verification failed for "
+                        ">%s< and >%s<: (src=%016" PRIx64
+                        ", dst=%016" PRIx64 ")\n", rank,
+                        file->src, file->dst, src_digest, dst_digest);
+            }
+            ret = EIO;
+        }
+    }
+
+    return ret;
+}
+
+/* laminate destinations in unifyfs, as unifyfs_transfer_file() does */
+static int stage_laminate(stage_plan_t* plan)
+{
+    int ret = 0;
+    for (size_t i = rank; i < plan->n_files; i += total_ranks) {
+        stage_file_t* file = plan->files + i;
+        if (!stage_path_in_unifyfs(file->dst, plan->ctx->mountpoint)) {
+            continue;
+        }
+        mode_t mode_no_write = ((mode_t) file->mode) & ~(0222);
+        if (chmod(file->dst, mode_no_write) < 0) {
+            ret = errno;
+            fprintf(stderr, "[%d] failed to laminate %s (%s)\n",
+                    rank, file->dst, strerror(ret));
+        }
+    }
+    return stage_agree(ret, MPI_COMM_WORLD);
+}
+
+/**
+ * @brief controls the action of the stage-in or stage-out. Reads the
+ *        manifest file, schedules the transfers across all processes
+ *        by size, and runs them.
+ *
+ * @param ctx     stage context and instructions
+ *
+ * @return 0 indicates success, non-zero is error
+ */
+int unifyfs_stage_transfer(unifyfs_stage_t* ctx)
+{
+    int ret = 0;
+    stage_plan_t plan;
+
+    if (!ctx) {
+        return EINVAL;
+    }
+
+    memset(&plan, 0, sizeof(plan));
+    plan.ctx = ctx;
+
+    ret = stage_read_manifest(&plan);
+    ret = stage_agree(ret, MPI_COMM_WORLD);
+    if (ret) {
+        goto out;
+    }
+
+    ret = stage_stat_sources(&plan);
+    if (ret) {
+        goto out;
+    }
+
+    ret = stage_create_destinations(&plan);
+    if (ret) {
+        goto out;
+    }
+
+    ret = stage_schedule(&plan);
+    if (!ret) {
+        plan.buf = malloc(UNIFYFS_STAGE_CHUNK_SIZE);
+        if (NULL == plan.buf) {
+            ret = ENOMEM;
+        } else if (ctx->checksum) {
+            plan.digests = calloc((2 * plan.n_chunks) + 1, sizeof(uint64_t));
+            if (NULL == plan.digests) {
+                ret = ENOMEM;
+            }
+        }
+    }
+    ret = stage_agree(ret, MPI_COMM_WORLD);
+    if (ret) {
+        goto out;
+    }
+
+    ret = stage_run(&plan);
+    if (ret) {
+        goto out;
+    }
+
+    if (ctx->checksum) {
+        ret = stage_verify(&plan);
+        if (ret) {
+            goto out;
+        }
+    }
+
+    ret = stage_laminate(&plan);
+
+out:
+    if (ret && (0 == rank)) {
+        fprintf(stderr, "failed to transfer files in %s: %s\n",
+                ctx->manifest_file, strerror(ret));
+    }
+
+    for (size_t i = 0; i < plan.n_files; i++) {
+        free(plan.files[i].src);
+        free(plan.files[i].dst);
+    }
+    free(plan.files);
+    free(plan.units);
+    free(plan.sched);
+    free(plan.queue_start);
+    free(plan.queue_count);
+    free(plan.digests);
+    free(plan.buf);
+
+    return ret;
+}
@@ -135,7 +135,7 @@ static const char* usage_str =
     "\n"
     "Available options:\n"
     "\n"
-    "  -c, --checksum           verify md5 checksum for each transfer\n"
+    "  -c, --checksum           verify xxHash64 checksum for each transfer\n"
     "  -h, --help               print this usage\n"
     "  -m, --mountpoint=<mnt>   use <mnt> as unifyfs mountpoint\n"
     "                           (default: /unifyfs)\n"
@@ -146,8 +146,11 @@ static const char* usage_str =
     "  -N, --no-mount-unifyfs   don't mount unifyfs file system (for testing)\n"
     "\n"
     "Without the '-p, --parallel' option, a file is transferred by a single\n"
-    "process. If the '-p, --parallel' option is specified, each file will be\n"
-    "divided by multiple processes and transferred in parallel.\n"
+    "process. If the '-p, --parallel' option is specified, files larger\n"
+    "than 256 MiB will be divided by multiple processes and transferred in\n"
+    "parallel.\n"
+    "Files are assigned to processes by size, and processes that finish\n"
+    "early take over files left to others.\n"
     "\n";
 
 static char* program;
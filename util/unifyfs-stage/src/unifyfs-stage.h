@@ -3,13 +3,20 @@
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <stdint.h>
 #include <unifyfs.h>
 
-#define UNIFYFS_STAGE_MD5_BLOCKSIZE    (1048576)
+/* files are copied and checksummed in chunks of this size */
+#define UNIFYFS_STAGE_CHUNK_SIZE    (8 * 1048576)
+
+/* in parallel mode, files larger than this are split into pieces of this
+ * size (a multiple of the chunk size) that are scheduled separately */
+#define UNIFYFS_STAGE_SPLIT_SIZE    (32 * UNIFYFS_STAGE_CHUNK_SIZE)
 
 /*
  * serial: each file is tranferred by a process.
- * parallel: a file is transferred by all processes.
+ * parallel: large files are split and transferred by several processes.
+ * In both modes, work is balanced across processes by size.
  */
 enum {
     UNIFYFS_STAGE_SERIAL = 0,
@@ -60,6 +67,30 @@ static inline void unifyfs_stage_print(unifyfs_stage_t* ctx)
  */
 int unifyfs_stage_transfer(unifyfs_stage_t* ctx);
 
+/**
+ * @brief computes the 64-bit xxHash of a buffer
+ *
+ * @param data      input buffer
+ * @param len       length of input in bytes
+ * @param seed      hash seed
+ *
+ * @return 64-bit digest
+ */
+uint64_t unifyfs_stage_xxh64(const void* data, size_t len, uint64_t seed);
+
+/**
+ * @brief combines per-chunk digests into the digest of the whole file
+ *
+ * @param chunk_digests     digest of each chunk, in file order
+ * @param n_chunks          number of chunks
+ * @param file_size         size of the file in bytes
+ *
+ * @return 64-bit digest of the file
+ */
+uint64_t unifyfs_stage_combine_digests(const uint64_t* chunk_digests,
+                                       size_t n_chunks,
+                                       uint64_t file_size);
+
 extern int verbose;
 extern int rank;
 extern int total_ranks;
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2021, Lawrence Livermore National Security, LLC.
+ * Produced at the Lawrence Livermore National Laboratory.
+ *
+ * Copyright 2021, UT-Battelle, LLC.
+ *
+ * LLNL-CODE-741539
+ * All rights reserved.
+ *
+ * This is the license for UnifyFS.
+ * For details, see https://github.com/LLNL/UnifyFS.
+ * Please read https://github.com/LLNL/UnifyFS/LICENSE for full license text.
+ */
+
+#ifndef _CONFIG_H
+#define _CONFIG_H
+#include <config.h>
+#endif
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "unifyfs.h"
+#include "unifyfs_api.h"
+
+static volatile sig_atomic_t stats_stop;
+
+static void stats_sighandler(int sig)
+{
+    stats_stop = 1;
+}
+
+int unifyfs_print_server_stats(unifyfs_args_t* args)
+{
+    const char* mountpoint = args->mountpoint;
+    if (NULL == mountpoint) {
+        mountpoint = "/unifyfs";
+    }
+
+    /* the query itself should not leave a dump file behind */
+    unifyfs_cfg_option options[] = {
+        { .opt_name = "stats.dump_interval", .opt_value = "0" }
+    };
+
+    unifyfs_handle fshdl = UNIFYFS_INVALID_HANDLE;
+    unifyfs_rc urc = unifyfs_initialize(mountpoint, options, 1, &fshdl);
+    if (UNIFYFS_SUCCESS != urc) {
+        fprintf(stderr, "ERROR: failed to connect to UnifyFS server at %s"
+                " - %s\n", mountpoint, unifyfs_rc_enum_description(urc));
+        return -EIO;
+    }
+
+    if (args->stats_interval > 0) {
+        signal(SIGINT, stats_sighandler);
+        signal(SIGTERM, stats_sighandler);
+    }
+
+    int ret = 0;
+    while (!stats_stop) {
+        char* json = NULL;
+        urc = unifyfs_get_server_stats(fshdl, &json);
+        if (UNIFYFS_SUCCESS != urc) {
+            fprintf(stderr, "ERROR: failed to get server statistics - %s\n",
+                    unifyfs_rc_enum_description(urc));
+            ret = -EIO;
+            break;
+        }
+        printf("%s\n", json);
+        fflush(stdout);
+        free(json);
+
+        if (args->stats_interval <= 0) {
+            break;
+        }
+        sleep((unsigned int) args->stats_interval);
+    }
+
+    urc = unifyfs_finalize(fshdl);
+    if (UNIFYFS_SUCCESS != urc) {
+        fprintf(stderr, "ERROR: failed to disconnect from UnifyFS server"
+                " - %s\n", unifyfs_rc_enum_description(urc));
+        if (0 == ret) {
+            ret = -EIO;
+        }
+    }
+    return ret;
+}
@@ -56,10 +56,11 @@ typedef enum {
     INVALID_ACTION   = -1,
     ACT_START        = 0,
     ACT_TERMINATE    = 1,
-    N_ACT            = 2
+    ACT_STATS        = 2,
+    N_ACT            = 3
 } action_e;
 
-static char* actions[N_ACT] = { "start", "terminate" };
+static char* actions[N_ACT] = { "start", "terminate", "stats" };
 
 static action_e action = INVALID_ACTION;
 static unifyfs_args_t cli_args;
@@ -71,6 +72,7 @@ static struct option const long_opts[] = {
     { "debug", no_argument, NULL, 'd' },
     { "exe", required_argument, NULL, 'e' },
     { "help", no_argument, NULL, 'h' },
+    { "interval", required_argument, NULL, 'I' },
     { "mount", required_argument, NULL, 'm' },
     { "script", required_argument, NULL, 's' },
     { "share-dir", required_argument, NULL, 'S' },
@@ -82,7 +84,7 @@ static struct option const long_opts[] = {
 };
 
 static char* program;
-static char* short_opts = ":cC:de:hi:m:o:s:S:t:T:";
+static char* short_opts = ":cC:de:hi:I:m:o:s:S:t:T:";
 static char* usage_str =
     "\n"
     "Usage: %s <command> [options...]\n"
@@ -90,6 +92,7 @@ static char* usage_str =
     "<command> should be one of the following:\n"
     "  start       start the UnifyFS server daemons\n"
     "  terminate   terminate the UnifyFS server daemons\n"
+    "  stats       print statistics of the local UnifyFS server as JSON\n"
     "\n"
     "Common options:\n"
     "  -d, --debug               enable debug output\n"
@@ -111,6 +114,10 @@ static char* usage_str =
     "  -T, --stage-timeout=<sec>  [OPTIONAL] timeout for stage-out operation\n"
     "  -s, --script=<path>        [OPTIONAL] <path> to custom termination script\n"
     "  -S, --share-dir=<path>     [REQUIRED for --stage-out] shared file system <path> for use by servers\n"
+    "\n"
+    "Command options for \"stats\":\n"
+    "  -m, --mount=<path>         [OPTIONAL] query the server for mountpoint <path>\n"
+    "  -I, --interval=<sec>       [OPTIONAL] repeat the query every <sec> until interrupted\n"
     "\n";
 
 static int debug;
@@ -128,6 +135,7 @@ static void parse_cmd_arguments(int argc, char** argv)
     int cleanup = 0;
     int timeout = UNIFYFS_DEFAULT_INIT_TIMEOUT;
     int stage_timeout = -1;
+    int stats_interval = 0;
     unifyfs_cm_e consistency = UNIFYFS_CM_LAMINATED;
     char* mountpoint = NULL;
     char* script = NULL;
@@ -185,6 +193,10 @@ static void parse_cmd_arguments(int argc, char** argv)
             stage_in = strdup(optarg);
             break;
 
+        case 'I':
+            stats_interval = atoi(optarg);
+            break;
+
         case 'o':
             stage_out = strdup(optarg);
             break;
@@ -211,6 +223,7 @@ static void parse_cmd_arguments(int argc, char** argv)
     cli_args.stage_in = stage_in;
     cli_args.stage_out = stage_out;
     cli_args.stage_timeout = stage_timeout;
+    cli_args.stats_interval = stats_interval;
     cli_args.timeout = timeout;
 }
 
@@ -254,6 +267,12 @@ int main(int argc, char** argv)
         printf("stage_in:\t%s\n", cli_args.stage_in);
         printf("stage_out:\t%s\n", cli_args.stage_out);
         printf("stage_timeout:\t%d\n", cli_args.stage_timeout);
+        printf("stats_interval:\t%d\n", cli_args.stats_interval);
+    }
+
+    if (action == ACT_STATS) {
+        /* only talks to the server on this node */
+        return unifyfs_print_server_stats(&cli_args);
     }
 
     ret = unifyfs_detect_resources(&resource);
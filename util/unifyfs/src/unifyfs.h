@@ -67,6 +67,7 @@ struct _unifyfs_args {
     char* stage_out;           /* data path to stage-out (drain) */
     int stage_timeout;         /* timeout of (in or out) file staging*/
     char* script;              /* path to custom launch/terminate script */
+    int stats_interval;        /* seconds between statistics queries */
 };
 typedef struct _unifyfs_args unifyfs_args_t;
 
@@ -112,5 +113,15 @@ int unifyfs_start_servers(unifyfs_resource_t* resource,
 int unifyfs_stop_servers(unifyfs_resource_t* resource,
                          unifyfs_args_t* args);
 
+/**
+ * @brief Print the statistics of the local unifyfsd server as JSON,
+ *        repeatedly if a query interval was given
+ *
+ * @param args      The command-line options
+ *
+ * @return 0 on success, negative errno otherwise
+ */
+int unifyfs_print_server_stats(unifyfs_args_t* args);
+
 #endif  /* __UNIFYFS_H */
 